@@ -38,4 +38,10 @@ DEFINE_REG_WRITE_FUNC_(tpidr_el0, uint64_t, tpidr_el0)
 
 DEFINE_REG_READ_FUNC_(dczid_el0, uint64_t, dczid_el0)
 
+/*
+ * ID registers: an EL0 read traps, and only succeeds where the OP-TEE
+ * core emulates it, see CFG_TA_CRYPTO_CE_DETECT
+ */
+DEFINE_REG_READ_FUNC_(id_aa64isar0_el1, uint64_t, id_aa64isar0_el1)
+
 #endif /*ARM64_USER_SYSREG_H*/
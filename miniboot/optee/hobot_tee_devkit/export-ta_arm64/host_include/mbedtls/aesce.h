@@ -0,0 +1,374 @@
+/**
+ * \file aesce.h
+ *
+ * \brief AES and AES-GCM with the Armv8 Cryptographic Extension
+ *
+ *        The AES of libmbedtls is left to the trust engine. This module
+ *        runs AES in the TA itself: with AESE/AESD and PMULL, several
+ *        blocks interleaved, when the core implements them, and with
+ *        constant-time bitsliced code otherwise. It uses its own contexts
+ *        and keeps the calling conventions of aes.h and gcm.h.
+ */
+/*
+ *  Copyright (c) 2026, D-Robotics
+ *  SPDX-License-Identifier: BSD-2-Clause
+ */
+#ifndef MBEDTLS_AESCE_H
+#define MBEDTLS_AESCE_H
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#include "mbedtls/aes.h"
+#include "mbedtls/gcm.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief The AES-CE context-type definition.
+ *
+ *        The round keys are kept twice: as bytes for the AESE/AESD
+ *        instructions and as bit planes for the bitsliced code. A context
+ *        set up by mbedtls_aesce_setkey_dec() holds the round keys of the
+ *        equivalent inverse cipher.
+ */
+typedef struct mbedtls_aesce_context
+{
+    int nr;                     /*!< The number of rounds. */
+    unsigned char rk[15][16];   /*!< The round keys, as bytes. */
+    uint16_t bs[15][8];         /*!< The round keys, as bit planes. */
+}
+mbedtls_aesce_context;
+
+/**
+ * \brief The AES-CE XTS context-type definition.
+ */
+typedef struct mbedtls_aesce_xts_context
+{
+    mbedtls_aesce_context crypt; /*!< The context for block encryption or
+                                      decryption. */
+    mbedtls_aesce_context tweak; /*!< The context for tweak computation. */
+}
+mbedtls_aesce_xts_context;
+
+/**
+ * \brief The AES-CE GCM context-type definition.
+ */
+typedef struct mbedtls_aesce_gcm_context
+{
+    mbedtls_aesce_context aes;  /*!< The AES context of the key. */
+    uint64_t h[4][2];           /*!< H, H^2, H^3 and H^4, as big-endian
+                                     halves, for GHASH of 4 blocks at
+                                     once. */
+}
+mbedtls_aesce_gcm_context;
+
+/**
+ * \brief          This function tells which implementation the other
+ *                 functions of this module use.
+ *
+ * \return         \c 1 if they use the Armv8 Cryptographic Extension,
+ *                 \c 0 if they use the portable constant-time code.
+ */
+int mbedtls_aesce_has_support( void );
+
+/**
+ * \brief          This function initializes the specified AES-CE context.
+ *
+ * \param ctx      The AES-CE context to initialize. This must not be \c NULL.
+ */
+void mbedtls_aesce_init( mbedtls_aesce_context *ctx );
+
+/**
+ * \brief          This function releases and clears the specified AES-CE
+ *                 context.
+ *
+ * \param ctx      The AES-CE context to clear. If this is \c NULL, this
+ *                 function does nothing.
+ */
+void mbedtls_aesce_free( mbedtls_aesce_context *ctx );
+
+/**
+ * \brief          This function sets the encryption key.
+ *
+ * \param ctx      The AES-CE context to which the key should be bound.
+ * \param key      The encryption key.
+ * \param keybits  The size of \p key in bits: 128, 192 or 256.
+ *
+ * \return         \c 0 on success.
+ * \return         #MBEDTLS_ERR_AES_INVALID_KEY_LENGTH on failure.
+ */
+int mbedtls_aesce_setkey_enc( mbedtls_aesce_context *ctx,
+                              const unsigned char *key,
+                              unsigned int keybits );
+
+/**
+ * \brief          This function sets the decryption key.
+ *
+ * \param ctx      The AES-CE context to which the key should be bound.
+ * \param key      The decryption key.
+ * \param keybits  The size of \p key in bits: 128, 192 or 256.
+ *
+ * \return         \c 0 on success.
+ * \return         #MBEDTLS_ERR_AES_INVALID_KEY_LENGTH on failure.
+ */
+int mbedtls_aesce_setkey_dec( mbedtls_aesce_context *ctx,
+                              const unsigned char *key,
+                              unsigned int keybits );
+
+/**
+ * \brief          This function performs an AES-ECB encryption or
+ *                 decryption operation on several blocks.
+ *
+ * \param ctx      The AES-CE context, bound to an encryption key for
+ *                 #MBEDTLS_AES_ENCRYPT and to a decryption key for
+ *                 #MBEDTLS_AES_DECRYPT.
+ * \param mode     #MBEDTLS_AES_ENCRYPT or #MBEDTLS_AES_DECRYPT.
+ * \param length   The length of the data, a multiple of 16 Bytes.
+ * \param input    The buffer holding the input data.
+ * \param output   The buffer holding the output data. It may be
+ *                 \p input.
+ *
+ * \return         \c 0 on success.
+ * \return         #MBEDTLS_ERR_AES_INVALID_INPUT_LENGTH on failure.
+ */
+int mbedtls_aesce_crypt_ecb( mbedtls_aesce_context *ctx,
+                             int mode,
+                             size_t length,
+                             const unsigned char *input,
+                             unsigned char *output );
+
+/**
+ * \brief          This function performs an AES-CBC encryption or
+ *                 decryption operation on full blocks, as
+ *                 mbedtls_aes_crypt_cbc() does.
+ *
+ * \param ctx      The AES-CE context, bound to a key for \p mode.
+ * \param mode     #MBEDTLS_AES_ENCRYPT or #MBEDTLS_AES_DECRYPT.
+ * \param length   The length of the data, a multiple of 16 Bytes.
+ * \param iv       Initialization vector (updated after use).
+ * \param input    The buffer holding the input data.
+ * \param output   The buffer holding the output data. It may be
+ *                 \p input.
+ *
+ * \return         \c 0 on success.
+ * \return         #MBEDTLS_ERR_AES_INVALID_INPUT_LENGTH on failure.
+ */
+int mbedtls_aesce_crypt_cbc( mbedtls_aesce_context *ctx,
+                             int mode,
+                             size_t length,
+                             unsigned char iv[16],
+                             const unsigned char *input,
+                             unsigned char *output );
+
+/**
+ * \brief          This function performs an AES-CTR encryption or
+ *                 decryption operation, as mbedtls_aes_crypt_ctr() does.
+ *
+ * \param ctx      The AES-CE context, bound to an encryption key.
+ * \param length   The length of the data.
+ * \param nc_off   The offset in the current \p stream_block.
+ * \param nonce_counter The 128-bit nonce and counter.
+ * \param stream_block The saved stream block for resuming.
+ * \param input    The buffer holding the input data.
+ * \param output   The buffer holding the output data. It may be
+ *                 \p input.
+ *
+ * \return         \c 0 on success.
+ * \return         #MBEDTLS_ERR_AES_BAD_INPUT_DATA if \p nc_off is out of
+ *                 range.
+ */
+int mbedtls_aesce_crypt_ctr( mbedtls_aesce_context *ctx,
+                             size_t length,
+                             size_t *nc_off,
+                             unsigned char nonce_counter[16],
+                             unsigned char stream_block[16],
+                             const unsigned char *input,
+                             unsigned char *output );
+
+/**
+ * \brief          This function initializes the specified AES-CE XTS
+ *                 context.
+ *
+ * \param ctx      The AES-CE XTS context to initialize.
+ */
+void mbedtls_aesce_xts_init( mbedtls_aesce_xts_context *ctx );
+
+/**
+ * \brief          This function releases and clears the specified AES-CE
+ *                 XTS context.
+ *
+ * \param ctx      The AES-CE XTS context to clear. If this is \c NULL,
+ *                 this function does nothing.
+ */
+void mbedtls_aesce_xts_free( mbedtls_aesce_xts_context *ctx );
+
+/**
+ * \brief          This function sets the XTS encryption key.
+ *
+ * \param ctx      The AES-CE XTS context to which the key should be bound.
+ * \param key      The encryption key, Key1 followed by Key2.
+ * \param keybits  The size of \p key in bits: 256 or 512.
+ *
+ * \return         \c 0 on success.
+ * \return         #MBEDTLS_ERR_AES_INVALID_KEY_LENGTH on failure.
+ */
+int mbedtls_aesce_xts_setkey_enc( mbedtls_aesce_xts_context *ctx,
+                                  const unsigned char *key,
+                                  unsigned int keybits );
+
+/**
+ * \brief          This function sets the XTS decryption key.
+ *
+ * \param ctx      The AES-CE XTS context to which the key should be bound.
+ * \param key      The decryption key, Key1 followed by Key2.
+ * \param keybits  The size of \p key in bits: 256 or 512.
+ *
+ * \return         \c 0 on success.
+ * \return         #MBEDTLS_ERR_AES_INVALID_KEY_LENGTH on failure.
+ */
+int mbedtls_aesce_xts_setkey_dec( mbedtls_aesce_xts_context *ctx,
+                                  const unsigned char *key,
+                                  unsigned int keybits );
+
+/**
+ * \brief          This function performs an AES-XTS encryption or
+ *                 decryption operation for an entire data unit.
+ *
+ * \param ctx      The AES-CE XTS context, bound to a key for \p mode.
+ * \param mode     #MBEDTLS_AES_ENCRYPT or #MBEDTLS_AES_DECRYPT.
+ * \param length   The length of the data unit, between 16 Bytes and
+ *                 2^24 Bytes.
+ * \param data_unit The address of the data unit, 16 little-endian Bytes.
+ *                 Incremented after use.
+ * \param input    The buffer holding the input data.
+ * \param output   The buffer holding the output data. It may be
+ *                 \p input.
+ *
+ * \return         \c 0 on success.
+ * \return         #MBEDTLS_ERR_AES_INVALID_INPUT_LENGTH on failure.
+ */
+int mbedtls_aesce_crypt_xts( mbedtls_aesce_xts_context *ctx,
+                             int mode,
+                             size_t length,
+                             unsigned char data_unit[16],
+                             const unsigned char *input,
+                             unsigned char *output );
+
+/**
+ * \brief          This function initializes the specified AES-CE GCM
+ *                 context.
+ *
+ * \param ctx      The AES-CE GCM context to initialize.
+ */
+void mbedtls_aesce_gcm_init( mbedtls_aesce_gcm_context *ctx );
+
+/**
+ * \brief          This function releases and clears the specified AES-CE
+ *                 GCM context.
+ *
+ * \param ctx      The AES-CE GCM context to clear. If this is \c NULL,
+ *                 this function does nothing.
+ */
+void mbedtls_aesce_gcm_free( mbedtls_aesce_gcm_context *ctx );
+
+/**
+ * \brief          This function sets the GCM key.
+ *
+ * \param ctx      The AES-CE GCM context to which the key should be bound.
+ * \param key      The encryption key.
+ * \param keybits  The size of \p key in bits: 128, 192 or 256.
+ *
+ * \return         \c 0 on success.
+ * \return         #MBEDTLS_ERR_AES_INVALID_KEY_LENGTH on failure.
+ */
+int mbedtls_aesce_gcm_setkey( mbedtls_aesce_gcm_context *ctx,
+                              const unsigned char *key,
+                              unsigned int keybits );
+
+/**
+ * \brief          This function performs GCM encryption or decryption of a
+ *                 buffer, as mbedtls_gcm_crypt_and_tag() does.
+ *
+ * \param ctx      The AES-CE GCM context, bound to a key.
+ * \param mode     #MBEDTLS_GCM_ENCRYPT or #MBEDTLS_GCM_DECRYPT. The tag
+ *                 is computed over the ciphertext either way.
+ * \param length   The length of the input data.
+ * \param iv       The initialization vector.
+ * \param iv_len   The length of the IV, at least 1 Byte.
+ * \param add      The additional data.
+ * \param add_len  The length of the additional data.
+ * \param input    The buffer holding the input data.
+ * \param output   The buffer holding the output data. It may be
+ *                 \p input.
+ * \param tag_len  The length of the tag, 4 to 16 Bytes.
+ * \param tag      The buffer for the tag.
+ *
+ * \return         \c 0 on success.
+ * \return         #MBEDTLS_ERR_GCM_BAD_INPUT if a length is out of range.
+ */
+int mbedtls_aesce_gcm_crypt_and_tag( mbedtls_aesce_gcm_context *ctx,
+                                     int mode,
+                                     size_t length,
+                                     const unsigned char *iv,
+                                     size_t iv_len,
+                                     const unsigned char *add,
+                                     size_t add_len,
+                                     const unsigned char *input,
+                                     unsigned char *output,
+                                     size_t tag_len,
+                                     unsigned char *tag );
+
+/**
+ * \brief          This function performs a GCM authenticated decryption,
+ *                 as mbedtls_gcm_auth_decrypt() does.
+ *
+ * \param ctx      The AES-CE GCM context, bound to a key.
+ * \param length   The length of the ciphertext.
+ * \param iv       The initialization vector.
+ * \param iv_len   The length of the IV.
+ * \param add      The additional data.
+ * \param add_len  The length of the additional data.
+ * \param tag      The tag to verify.
+ * \param tag_len  The length of the tag, 4 to 16 Bytes.
+ * \param input    The buffer holding the ciphertext.
+ * \param output   The buffer for the plaintext, zeroed if the tag does
+ *                 not match. It may be \p input.
+ *
+ * \return         \c 0 if successful and authenticated.
+ * \return         #MBEDTLS_ERR_GCM_AUTH_FAILED if the tag does not match.
+ * \return         #MBEDTLS_ERR_GCM_BAD_INPUT if a length is out of range.
+ */
+int mbedtls_aesce_gcm_auth_decrypt( mbedtls_aesce_gcm_context *ctx,
+                                    size_t length,
+                                    const unsigned char *iv,
+                                    size_t iv_len,
+                                    const unsigned char *add,
+                                    size_t add_len,
+                                    const unsigned char *tag,
+                                    size_t tag_len,
+                                    const unsigned char *input,
+                                    unsigned char *output );
+
+#if defined(MBEDTLS_SELF_TEST)
+/**
+ * \brief          Checkup routine
+ *
+ * \return         \c 0 on success, or \c 1 on failure.
+ */
+int mbedtls_aesce_self_test( int verbose );
+#endif /* MBEDTLS_SELF_TEST */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MBEDTLS_AESCE_H */
@@ -0,0 +1,139 @@
+/**
+ * \file ecp256.h
+ *
+ * \brief ECDSA over SECP256R1 and SM2DSA over SM2P256V1, verification
+ *
+ *        The ECDSA and SM2DSA of libmbedtls work on any curve with the
+ *        generic arithmetic of ecp.h and bignum.h. This module verifies
+ *        signatures on the two 256-bit curves TAs use most with a
+ *        Montgomery field on four 64-bit limbs dedicated to them, a comb
+ *        table of the generator precomputed at build time, and, for
+ *        batches of signatures, a single inversion shared by the whole
+ *        batch at each step that needs one (Montgomery's trick).
+ *
+ *        Only public data is handled: the code is not constant time and
+ *        must not be used with secret scalars.
+ */
+/*
+ *  Copyright (c) 2026, D-Robotics
+ *  SPDX-License-Identifier: BSD-2-Clause
+ */
+#ifndef MBEDTLS_ECP256_H
+#define MBEDTLS_ECP256_H
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#include "mbedtls/ecp.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** Signatures verified with one inversion by mbedtls_ecp256_verify_batch() */
+#define MBEDTLS_ECP256_BATCH    8
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief The job of a batch verification.
+ */
+typedef struct mbedtls_ecp256_verify_job
+{
+    const unsigned char *buf;       /*!< The hash of the message. For
+                                         SM2DSA, the hash of Z and the
+                                         message. */
+    size_t blen;                    /*!< The length of \c buf in Bytes. */
+    const mbedtls_ecp_point *Q;     /*!< The public key. */
+    const mbedtls_mpi *r;           /*!< The first integer of the
+                                         signature. */
+    const mbedtls_mpi *s;           /*!< The second integer of the
+                                         signature. */
+    int ret;                        /*!< The result, set by
+                                         mbedtls_ecp256_verify_batch(). */
+}
+mbedtls_ecp256_verify_job;
+
+/**
+ * \brief           This function tells whether a curve is handled by this
+ *                  module.
+ *
+ * \param grp_id    The curve: #MBEDTLS_ECP_DP_SECP256R1 for ECDSA,
+ *                  #MBEDTLS_ECP_DP_SM2P256V1 for SM2DSA.
+ *
+ * \return          \c 1 if it is, \c 0 otherwise.
+ */
+int mbedtls_ecp256_has_curve( mbedtls_ecp_group_id grp_id );
+
+/**
+ * \brief           This function verifies an ECDSA signature over
+ *                  SECP256R1 or an SM2DSA signature over SM2P256V1 of a
+ *                  previously-hashed message.
+ *
+ * \note            A hash longer than the group order is truncated to its
+ *                  leftmost 256 bits, as in mbedtls_ecdsa_verify() and
+ *                  mbedtls_sm2dsa_verify().
+ *
+ * \param grp_id    #MBEDTLS_ECP_DP_SECP256R1 or #MBEDTLS_ECP_DP_SM2P256V1.
+ * \param buf       The hashed content. For SM2DSA, the hash of Z and the
+ *                  message.
+ * \param blen      The length of \p buf in Bytes.
+ * \param Q         The public key, in affine coordinates.
+ * \param r         The first integer of the signature.
+ * \param s         The second integer of the signature.
+ *
+ * \return          \c 0 if the signature is valid.
+ * \return          #MBEDTLS_ERR_ECP_VERIFY_FAILED if it is not.
+ * \return          #MBEDTLS_ERR_ECP_INVALID_KEY if \p Q is not a point of
+ *                  the curve.
+ * \return          #MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE if \p grp_id is
+ *                  another curve.
+ */
+int mbedtls_ecp256_verify( mbedtls_ecp_group_id grp_id,
+                           const unsigned char *buf,
+                           size_t blen,
+                           const mbedtls_ecp_point *Q,
+                           const mbedtls_mpi *r,
+                           const mbedtls_mpi *s );
+
+/**
+ * \brief           This function verifies several signatures over the same
+ *                  curve, as mbedtls_ecp256_verify() does, with one
+ *                  inversion per step for up to #MBEDTLS_ECP256_BATCH
+ *                  signatures at once.
+ *
+ * \param grp_id    #MBEDTLS_ECP_DP_SECP256R1 or #MBEDTLS_ECP_DP_SM2P256V1.
+ * \param jobs      The signatures. The \c ret field of each receives what
+ *                  mbedtls_ecp256_verify() would have returned for it.
+ * \param n         The number of jobs.
+ *
+ * \return          \c 0 if all the signatures are valid.
+ * \return          #MBEDTLS_ERR_ECP_VERIFY_FAILED if any is not; their
+ *                  \c ret field tells which.
+ * \return          #MBEDTLS_ERR_ECP_ALLOC_FAILED if the work area could not
+ *                  be allocated; no signature is verified then.
+ * \return          #MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE if \p grp_id is
+ *                  another curve.
+ */
+int mbedtls_ecp256_verify_batch( mbedtls_ecp_group_id grp_id,
+                                 mbedtls_ecp256_verify_job *jobs,
+                                 size_t n );
+
+#if defined(MBEDTLS_SELF_TEST)
+/**
+ * \brief          Checkup routine
+ *
+ * \return         \c 0 on success, or \c 1 on failure.
+ */
+int mbedtls_ecp256_self_test( int verbose );
+#endif /* MBEDTLS_SELF_TEST */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MBEDTLS_ECP256_H */
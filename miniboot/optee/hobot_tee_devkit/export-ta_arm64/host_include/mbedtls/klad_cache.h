@@ -0,0 +1,273 @@
+/**
+ * \file klad_cache.h
+ *
+ * \brief Cache of the keys unwrapped by the key ladder
+ *
+ *        A secure key, see klad.h, is unwrapped by the key ladder each time
+ *        a context is bound to it: ek1 under the selected root key gives
+ *        key1, ek2 under key1 gives key2 and ek3 under key2 gives the key.
+ *        A TA opening a context per request pays this for every request.
+ *        This module keeps the last unwrapped keys of a session in a
+ *        bounded number of slots, looked up by the root key selection and
+ *        the SHA-256 digest of ek1 || ek2 || ek3, and evicts the least
+ *        recently used slot when all are taken. Slots are cleared when they
+ *        are evicted, flushed or freed.
+ *
+ *        The ladder itself is a callback. mbedtls_klad_emul_unwrap() is a
+ *        software ladder, on AES-128, to test and benchmark the cache and
+ *        the setseckey functions of ta/lib/mbedtls_ext without the trust
+ *        engine. The keys it unwraps are in the clear in TA memory.
+ */
+/*
+ *  Copyright (c) 2026, D-Robotics
+ *  SPDX-License-Identifier: BSD-2-Clause
+ */
+#ifndef MBEDTLS_KLAD_CACHE_H
+#define MBEDTLS_KLAD_CACHE_H
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#include "mbedtls/klad.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MBEDTLS_ERR_KLAD_CACHE_ALLOC_FAILED    -0x0010 /**< Failed to allocate
+                                                         memory. */
+#define MBEDTLS_ERR_KLAD_CACHE_BAD_INPUT_DATA  -0x0021 /**< Invalid input
+                                                         data. */
+#define MBEDTLS_ERR_KLAD_CACHE_NO_LADDER       -0x0025 /**< No key ladder to
+                                                         unwrap the key. */
+
+#define MBEDTLS_KLAD_KEY_MAX       32   /**< Largest unwrapped key, Bytes */
+
+#if !defined(MBEDTLS_KLAD_CACHE_SLOTS)
+#define MBEDTLS_KLAD_CACHE_SLOTS   8    /**< Default number of slots */
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief           Key ladder callback
+ *
+ * \param p_ladder  The ladder context.
+ * \param key       The secure key to unwrap.
+ * \param out       The buffer to write the key to, \c key->ek3bits / 8
+ *                  Bytes.
+ *
+ * \return          \c 0 on success, an error code otherwise.
+ */
+typedef int (*mbedtls_klad_unwrap_t)( void *p_ladder,
+                                      const mbedtls_klad_seckey_t *key,
+                                      unsigned char *out );
+
+/**
+ * \brief          An unwrapped key slot
+ */
+typedef struct mbedtls_klad_cache_slot
+{
+    uint64_t stamp;                     /*!< Last use, 0 when empty. */
+    mbedtls_klad_key_sel_t sel;         /*!< The root key selection. */
+    int ek3bits;                        /*!< The key length in bits. */
+    unsigned char digest[32];           /*!< SHA-256 of the used eks. */
+    unsigned char key[MBEDTLS_KLAD_KEY_MAX]; /*!< The unwrapped key. */
+}
+mbedtls_klad_cache_slot;
+
+/**
+ * \brief          The key ladder cache context structure
+ */
+typedef struct mbedtls_klad_cache_context
+{
+    mbedtls_klad_unwrap_t f_unwrap;     /*!< The key ladder. */
+    void *p_ladder;                     /*!< The key ladder context. */
+    mbedtls_klad_cache_slot *slots;     /*!< The slots. */
+    size_t nslots;                      /*!< The number of slots. */
+    uint64_t clock;                     /*!< The last stamp given. */
+    uint32_t hits;                      /*!< Lookups served by a slot. */
+    uint32_t misses;                    /*!< Lookups run on the ladder. */
+    uint32_t evictions;                 /*!< Slots reused for another key. */
+}
+mbedtls_klad_cache_context;
+
+/**
+ * \brief          The software key ladder context structure
+ */
+typedef struct mbedtls_klad_emul_context
+{
+    unsigned char model_key[16];        /*!< #MBEDTLS_KL_KEY_MODEL */
+    unsigned char root_key[16];         /*!< #MBEDTLS_KL_KEY_ROOT */
+}
+mbedtls_klad_emul_context;
+
+/**
+ * \brief          This function initializes a key ladder cache context.
+ *
+ * \param ctx      The context to initialize. This must not be \c NULL.
+ */
+void mbedtls_klad_cache_init( mbedtls_klad_cache_context *ctx );
+
+/**
+ * \brief          This function clears all slots of a key ladder cache,
+ *                 typically when the session closes. The context remains
+ *                 set up.
+ *
+ * \param ctx      The context to flush. If this is \c NULL, this function
+ *                 does nothing.
+ */
+void mbedtls_klad_cache_flush( mbedtls_klad_cache_context *ctx );
+
+/**
+ * \brief          This function clears the slots of a key ladder cache and
+ *                 releases them. If the context is the default one, there
+ *                 is no default context any more.
+ *
+ * \param ctx      The context to free. If this is \c NULL, this function
+ *                 does nothing.
+ */
+void mbedtls_klad_cache_free( mbedtls_klad_cache_context *ctx );
+
+/**
+ * \brief          This function allocates the slots of a key ladder cache
+ *                 and binds it to a key ladder.
+ *
+ * \param ctx      The context to set up. It must be initialized.
+ * \param nslots   The number of slots, \c 0 for #MBEDTLS_KLAD_CACHE_SLOTS.
+ * \param f_unwrap The key ladder.
+ * \param p_ladder The key ladder context, passed to \p f_unwrap.
+ *
+ * \return         \c 0 on success.
+ * \return         #MBEDTLS_ERR_KLAD_CACHE_BAD_INPUT_DATA if \p ctx or
+ *                 \p f_unwrap is \c NULL, or \p ctx is already set up.
+ * \return         #MBEDTLS_ERR_KLAD_CACHE_ALLOC_FAILED on allocation
+ *                 failure.
+ */
+int mbedtls_klad_cache_setup( mbedtls_klad_cache_context *ctx,
+                              size_t nslots,
+                              mbedtls_klad_unwrap_t f_unwrap,
+                              void *p_ladder );
+
+/**
+ * \brief          This function sets the key ladder cache the setseckey
+ *                 functions of ta/lib/mbedtls_ext unwrap their keys with.
+ *                 A TA sets the cache of the session before it handles a
+ *                 request of this session.
+ *
+ * \param ctx      The context, or \c NULL for none. Without a context, the
+ *                 setseckey functions return their hardware accelerator
+ *                 error.
+ */
+void mbedtls_klad_cache_set_default( mbedtls_klad_cache_context *ctx );
+
+/**
+ * \brief          This function returns the key ladder cache set with
+ *                 mbedtls_klad_cache_set_default().
+ *
+ * \return         The context, or \c NULL if there is none.
+ */
+mbedtls_klad_cache_context *mbedtls_klad_cache_get_default( void );
+
+/**
+ * \brief          This function unwraps a secure key, from its slot if it
+ *                 has one and with the key ladder otherwise.
+ *
+ * \param ctx      The context, or \c NULL for the default context.
+ * \param key      The secure key. \c key->ek3bits must be \c 128 or
+ *                 \c 256.
+ * \param out      The buffer to write the key to, \c key->ek3bits / 8
+ *                 Bytes. The caller clears it after use.
+ * \param olen     The length of the key in Bytes.
+ *
+ * \return         \c 0 on success.
+ * \return         #MBEDTLS_ERR_KLAD_CACHE_BAD_INPUT_DATA if an argument is
+ *                 \c NULL or the key length is invalid.
+ * \return         #MBEDTLS_ERR_KLAD_CACHE_NO_LADDER if \p ctx is \c NULL and
+ *                 there is no default context.
+ * \return         The error of the key ladder if it failed.
+ */
+int mbedtls_klad_cache_unwrap( mbedtls_klad_cache_context *ctx,
+                               const mbedtls_klad_seckey_t *key,
+                               unsigned char *out, size_t *olen );
+
+/**
+ * \brief          This function sets the root keys of a software key
+ *                 ladder.
+ *
+ * \param ctx      The context to set up. This must not be \c NULL.
+ * \param model_key The key selected by #MBEDTLS_KL_KEY_MODEL, 16 Bytes.
+ * \param root_key The key selected by #MBEDTLS_KL_KEY_ROOT, 16 Bytes.
+ */
+void mbedtls_klad_emul_setup( mbedtls_klad_emul_context *ctx,
+                              const unsigned char model_key[16],
+                              const unsigned char root_key[16] );
+
+/**
+ * \brief          This function clears a software key ladder context.
+ *
+ * \param ctx      The context to clear. If this is \c NULL, this function
+ *                 does nothing.
+ */
+void mbedtls_klad_emul_free( mbedtls_klad_emul_context *ctx );
+
+/**
+ * \brief          This function unwraps a secure key with the software key
+ *                 ladder: each of ek1, ek2 and the blocks of ek3 is
+ *                 decrypted with AES-128-ECB under the root key, key1 and
+ *                 key2 respectively. It is a #mbedtls_klad_unwrap_t.
+ *
+ * \param p_ladder The #mbedtls_klad_emul_context.
+ * \param key      The secure key.
+ * \param out      The buffer to write the key to, \c key->ek3bits / 8
+ *                 Bytes.
+ *
+ * \return         \c 0 on success.
+ * \return         #MBEDTLS_ERR_KLAD_CACHE_BAD_INPUT_DATA if the key length
+ *                 or the root key selection is invalid.
+ */
+int mbedtls_klad_emul_unwrap( void *p_ladder,
+                              const mbedtls_klad_seckey_t *key,
+                              unsigned char *out );
+
+/**
+ * \brief          This function wraps a key for the software key ladder,
+ *                 the inverse of mbedtls_klad_emul_unwrap().
+ *
+ * \param ctx      The software key ladder context.
+ * \param sel      The root key selection.
+ * \param key1     The first ladder key, 16 Bytes.
+ * \param key2     The second ladder key, 16 Bytes.
+ * \param k        The key to wrap.
+ * \param kbits    The length of \p k in bits, \c 128 or \c 256.
+ * \param key      The secure key to write.
+ *
+ * \return         \c 0 on success.
+ * \return         #MBEDTLS_ERR_KLAD_CACHE_BAD_INPUT_DATA if the key length
+ *                 or the root key selection is invalid.
+ */
+int mbedtls_klad_emul_wrap( const mbedtls_klad_emul_context *ctx,
+                            mbedtls_klad_key_sel_t sel,
+                            const unsigned char key1[16],
+                            const unsigned char key2[16],
+                            const unsigned char *k, int kbits,
+                            mbedtls_klad_seckey_t *key );
+
+#if defined(MBEDTLS_SELF_TEST)
+/**
+ * \brief          Checkup routine
+ *
+ * \return         \c 0 on success, or \c 1 on failure.
+ */
+int mbedtls_klad_cache_self_test( int verbose );
+#endif /* MBEDTLS_SELF_TEST */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MBEDTLS_KLAD_CACHE_H */
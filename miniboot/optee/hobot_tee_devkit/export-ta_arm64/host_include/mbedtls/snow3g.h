@@ -19,12 +19,12 @@
 #include MBEDTLS_CONFIG_FILE
 #endif /* MBEDTLS_CONFIG_FILE */
 
-#if !defined(CFG_MBEDTLS_TE)
+#if !defined(CFG_MBEDTLS_TE) && defined(__KERNEL__)
 #include <linux/types.h>
-#else /* !CFG_MBEDTLS_TE */
+#else /* !CFG_MBEDTLS_TE && __KERNEL__ */
 #include <stddef.h>
 #include <stdint.h>
-#endif /* CFG_MBEDTLS_TE */
+#endif /* CFG_MBEDTLS_TE || !__KERNEL__ */
 
 #include "klad.h"
 
@@ -38,19 +38,52 @@ extern "C" {
 #define MBEDTLS_ERR_SNOW3G_BAD_INPUT_DATA     -0x0021 /**< Invalid input data. */
 #define MBEDTLS_ERR_SNOW3G_HW_ACCEL_FAILED    -0x0025 /**< hardware accelerator
                                                            failed. */
+/**
+ * Number of messages \c mbedtls_uea2_crypt_multi() generates the
+ * keystreams of in parallel
+ */
+#define MBEDTLS_SNOW3G_MAX_LANES    8
+
 #if !defined(MBEDTLS_SNOW3G_ALT)
+/**
+ *  SNOW 3G keystream generator state
+ */
+typedef struct {
+    uint32_t lfsr[16];          /*!< LFSR cells, the cell s(i) being
+                                     lfsr[(head + i) % 16] */
+    uint32_t r1;                /*!< FSM register R1 */
+    uint32_t r2;                /*!< FSM register R2 */
+    uint32_t r3;                /*!< FSM register R3 */
+    unsigned int head;          /*!< Index of s(0) in lfsr */
+} mbedtls_snow3g_state;
+
 /**
  *  uea2 context structure
  */
 typedef struct {
-    void *placeholder;  /*just a placeholder meaningless, add sw impl. here */
+    mbedtls_snow3g_state snow;  /*!< Keystream generator */
+    unsigned char key[16];      /*!< Confidentiality key */
+    unsigned char ks[4];        /*!< Current keystream word, big endian */
+    size_t ks_used;             /*!< Bytes of ks already used */
+    int state;                  /*!< Calling sequence state */
 } mbedtls_uea2_context;
 
 /**
  *  uia2 context structure
  */
 typedef struct {
-    void *placeholder;  /*just a placeholder meaningless, add sw impl. here */
+    unsigned char key[16];      /*!< Integrity key */
+    uint64_t p[4];              /*!< P, P^2, P^3 and P^4 */
+    uint64_t q;                 /*!< Q */
+    uint64_t ptab[4][16];       /*!< Multiples of p[] by the polynomials
+                                     of degree < 4, when carry-less
+                                     multiplication is not available */
+    uint32_t z5;                /*!< Keystream word 5 */
+    uint64_t eval;              /*!< Polynomial evaluation */
+    unsigned char buf[8];       /*!< Partial 64-bit block */
+    size_t buf_len;             /*!< Bytes in buf */
+    size_t bits;                /*!< Message bits processed */
+    int state;                  /*!< Calling sequence state */
 } mbedtls_uia2_context;
 #else /* !MBEDTLS_SNOW3G_ALT */
     #include "snow3g_alt.h"
@@ -272,6 +305,41 @@ int mbedtls_uea2_crypt_seckey( const mbedtls_klad_seckey_t *key,
                                size_t size, const unsigned char *input,
                                unsigned char *output );
 
+/**
+ * \brief           One message of \c mbedtls_uea2_crypt_multi()
+ */
+typedef struct {
+    const unsigned char *key;   /*!< 16 Bytes encryption/decryption key */
+    uint32_t count;             /*!< The count frame dependent input */
+    uint32_t bearer;            /*!< The bearer identity, 5 bits */
+    uint32_t dir;               /*!< The direction of transmission, 1 bit */
+    size_t size;                /*!< The length of input and output */
+    const unsigned char *input; /*!< The input data */
+    unsigned char *output;      /*!< The output data */
+} mbedtls_uea2_msg;
+
+#if !defined(MBEDTLS_SNOW3G_ALT)
+/**
+ * \brief           This function encrypts or decrypts several independent
+ *                  messages with uea2. Only the software implementation
+ *                  provides it.
+ *
+ *                  The keystreams of up to \c MBEDTLS_SNOW3G_MAX_LANES
+ *                  messages are generated in parallel. The result is the
+ *                  same as calling \c mbedtls_uea2_crypt() for each
+ *                  message.
+ *
+ * \param n         The number of messages.
+ * \param msgs      The messages. Input and output may be the same buffer
+ *                  but must not otherwise overlap.
+ *
+ * \return          \c 0 on success.
+ *                  \c MBEDTLS_ERR_SNOW3G_BAD_INPUT_DATA if a message has an
+ *                     invalid field, then no message is processed.
+ */
+int mbedtls_uea2_crypt_multi( size_t n, const mbedtls_uea2_msg *msgs );
+#endif /* !MBEDTLS_SNOW3G_ALT */
+
 /**
  * \brief          This function initializes the specified UIA2 context.
  *
@@ -59,6 +59,18 @@
 #endif
 #define MBEDTLS_SM3_C
 
+/* Software implementations from ta/lib/mbedtls_ext */
+#define MBEDTLS_ZUC_C
+#define MBEDTLS_SNOW3G_C
+#define MBEDTLS_SM4_C
+#define MBEDTLS_SM3_MB_C
+#define MBEDTLS_AESCE_C
+#define MBEDTLS_SHA2CE_C
+#define MBEDTLS_ECP256_C
+#define MBEDTLS_BN_MONT_C
+#define MBEDTLS_CHACHAPOLY_NEON_C
+#define MBEDTLS_KLAD_CACHE_C
+
 #define MBEDTLS_PK_C
 #define MBEDTLS_PK_PARSE_C
 #define MBEDTLS_PK_WRITE_C
@@ -0,0 +1,196 @@
+/**
+ * \file bn_mont.h
+ *
+ * \brief Montgomery arithmetic on 64-bit limbs, for RSA up to 4096 bits
+ *
+ *        The libmbedtls of the TA dev kit is built with
+ *        MBEDTLS_HAVE_INT32 and without MBEDTLS_HAVE_ASM: its bignum
+ *        multiplies 32-bit limbs in C. This module keeps the modulus, its
+ *        R^2 mod N and the operands as 64-bit limbs, multiplies them with
+ *        MUL/UMULH and ADCS chains unrolled four limbs at a time on
+ *        AArch64, squares with half the limb products and exponentiates
+ *        with a fixed window sized from the exponent. The operands and
+ *        results are mbedtls_mpi, so that RSA keys and TEE_BigInt values
+ *        converted with TEE_BigIntConvertToOctetString() can be used as
+ *        they are.
+ */
+/*
+ *  Copyright (c) 2026, D-Robotics
+ *  SPDX-License-Identifier: BSD-2-Clause
+ */
+#ifndef MBEDTLS_BN_MONT_H
+#define MBEDTLS_BN_MONT_H
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#include "mbedtls/bignum.h"
+#include "mbedtls/md.h"
+#include "mbedtls/rsa.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** Largest modulus, in 64-bit limbs: 4096 bits */
+#define MBEDTLS_BN_MONT_MAX_LIMBS   64
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief The Montgomery context of an odd modulus N, with R = 2^(64 * n).
+ *
+ * \note  At about 4 KiB, it is better allocated on the heap than on the
+ *        stack of a TA.
+ */
+typedef struct mbedtls_bn_mont_context
+{
+    size_t n;                                   /*!< Limbs of N. */
+    uint64_t n0;                                /*!< -N^-1 mod 2^64. */
+    uint64_t N[MBEDTLS_BN_MONT_MAX_LIMBS];      /*!< The modulus. */
+    uint64_t RR[MBEDTLS_BN_MONT_MAX_LIMBS];     /*!< R^2 mod N. */
+    uint64_t A[MBEDTLS_BN_MONT_MAX_LIMBS];      /*!< Work area. */
+    uint64_t B[MBEDTLS_BN_MONT_MAX_LIMBS];      /*!< Work area. */
+    uint64_t T[2 * MBEDTLS_BN_MONT_MAX_LIMBS + 1]; /*!< Work area. */
+}
+mbedtls_bn_mont_context;
+
+/**
+ * \brief          This function initializes a Montgomery context.
+ *
+ * \param ctx      The context to initialize. This must not be \c NULL.
+ */
+void mbedtls_bn_mont_init( mbedtls_bn_mont_context *ctx );
+
+/**
+ * \brief          This function clears a Montgomery context.
+ *
+ * \param ctx      The context to clear. If this is \c NULL, this function
+ *                 does nothing.
+ */
+void mbedtls_bn_mont_free( mbedtls_bn_mont_context *ctx );
+
+/**
+ * \brief          This function sets the modulus of a Montgomery context
+ *                 and computes R^2 mod N.
+ *
+ * \param ctx      The context to use.
+ * \param N        The modulus: odd, greater than 1 and of at most
+ *                 #MBEDTLS_BN_MONT_MAX_LIMBS * 64 bits.
+ *
+ * \return         \c 0 on success.
+ * \return         #MBEDTLS_ERR_MPI_BAD_INPUT_DATA if \p N is not such a
+ *                 modulus.
+ * \return         An \c MBEDTLS_ERR_MPI_XXX error code on failure of the
+ *                 bignum functions computing R^2 mod N.
+ */
+int mbedtls_bn_mont_setup( mbedtls_bn_mont_context *ctx,
+                           const mbedtls_mpi *N );
+
+/**
+ * \brief          This function computes X = A * B mod N.
+ *
+ * \param ctx      The context of N.
+ * \param X        The destination. It may be \p A or \p B.
+ * \param A        The first operand, in [0, N).
+ * \param B        The second operand, in [0, N).
+ *
+ * \return         \c 0 on success.
+ * \return         #MBEDTLS_ERR_MPI_BAD_INPUT_DATA if an operand is out of
+ *                 range.
+ * \return         An \c MBEDTLS_ERR_MPI_XXX error code on failure to write
+ *                 \p X.
+ */
+int mbedtls_bn_mont_mul_mod( mbedtls_bn_mont_context *ctx,
+                             mbedtls_mpi *X,
+                             const mbedtls_mpi *A,
+                             const mbedtls_mpi *B );
+
+/**
+ * \brief          This function computes X = A^E mod N.
+ *
+ * \note           The window of powers of \p A is read in full at each
+ *                 step, and the sequence of operations depends on the
+ *                 length of \p E only, so that \p E may be secret.
+ *
+ * \param ctx      The context of N.
+ * \param X        The destination. It may be \p A or \p E.
+ * \param A        The base, in [0, N).
+ * \param E        The exponent, non-negative.
+ *
+ * \return         \c 0 on success.
+ * \return         #MBEDTLS_ERR_MPI_BAD_INPUT_DATA if an operand is out of
+ *                 range.
+ * \return         #MBEDTLS_ERR_MPI_ALLOC_FAILED if the window could not be
+ *                 allocated.
+ * \return         An \c MBEDTLS_ERR_MPI_XXX error code on failure to write
+ *                 \p X.
+ */
+int mbedtls_bn_mont_exp_mod( mbedtls_bn_mont_context *ctx,
+                             mbedtls_mpi *X,
+                             const mbedtls_mpi *A,
+                             const mbedtls_mpi *E );
+
+/**
+ * \brief          This function performs the RSA public key operation, as
+ *                 mbedtls_rsa_public() does.
+ *
+ * \param ctx      The context of the modulus of \p rsa, set up with
+ *                 mbedtls_bn_mont_setup().
+ * \param rsa      The RSA public key.
+ * \param input    The input buffer, of \c rsa->len Bytes.
+ * \param output   The output buffer, of \c rsa->len Bytes.
+ *
+ * \return         \c 0 on success.
+ * \return         #MBEDTLS_ERR_RSA_BAD_INPUT_DATA if \p ctx is not set up
+ *                 for \p rsa or \p input is not below its modulus.
+ * \return         #MBEDTLS_ERR_RSA_PUBLIC_FAILED on any other failure.
+ */
+int mbedtls_bn_mont_rsa_public( mbedtls_bn_mont_context *ctx,
+                                const mbedtls_rsa_context *rsa,
+                                const unsigned char *input,
+                                unsigned char *output );
+
+/**
+ * \brief          This function verifies a PKCS#1 v1.5 signature, as
+ *                 mbedtls_rsa_rsassa_pkcs1_v15_verify() does.
+ *
+ * \param ctx      The context of the modulus of \p rsa, set up with
+ *                 mbedtls_bn_mont_setup().
+ * \param rsa      The RSA public key.
+ * \param md_alg   The message-digest algorithm used to hash the original
+ *                 data. Use #MBEDTLS_MD_NONE for signing raw data.
+ * \param hashlen  The length of \p hash. It is only used with
+ *                 #MBEDTLS_MD_NONE.
+ * \param hash     The hash of the signed data.
+ * \param sig      The signature, of \c rsa->len Bytes.
+ *
+ * \return         \c 0 if the signature is valid.
+ * \return         #MBEDTLS_ERR_RSA_VERIFY_FAILED if it is not.
+ * \return         An \c MBEDTLS_ERR_RSA_XXX error code on failure.
+ */
+int mbedtls_bn_mont_rsa_pkcs1_v15_verify( mbedtls_bn_mont_context *ctx,
+                                          const mbedtls_rsa_context *rsa,
+                                          mbedtls_md_type_t md_alg,
+                                          unsigned int hashlen,
+                                          const unsigned char *hash,
+                                          const unsigned char *sig );
+
+#if defined(MBEDTLS_SELF_TEST)
+/**
+ * \brief          Checkup routine
+ *
+ * \return         \c 0 on success, or \c 1 on failure.
+ */
+int mbedtls_bn_mont_self_test( int verbose );
+#endif /* MBEDTLS_SELF_TEST */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MBEDTLS_BN_MONT_H */
@@ -0,0 +1,193 @@
+/**
+ * \file chachapoly_neon.h
+ *
+ * \brief ChaCha20, Poly1305 and the ChaCha20-Poly1305 AEAD with NEON
+ *
+ *        The ChaCha20 of libmbedtls computes one 64-Byte block at a time
+ *        and its Poly1305 is scalar. This module computes four ChaCha20
+ *        blocks at a time, one per lane of the NEON registers, and runs
+ *        Poly1305 on four interleaved accumulators, each multiplied by
+ *        r^4, over 26-bit limbs. The AEAD encrypts and authenticates the
+ *        data in a single pass, chunk by chunk, so that the ciphertext is
+ *        hashed while it is still in the L1 data cache. The calling
+ *        conventions are those of chacha20.h, poly1305.h and
+ *        chachapoly.h; the functions are one-shot.
+ */
+/*
+ *  Copyright (c) 2026, D-Robotics
+ *  SPDX-License-Identifier: BSD-2-Clause
+ */
+#ifndef MBEDTLS_CHACHAPOLY_NEON_H
+#define MBEDTLS_CHACHAPOLY_NEON_H
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#include "mbedtls/chachapoly.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief The ChaCha20-Poly1305-NEON context structure.
+ */
+typedef struct mbedtls_chachapoly_neon_context
+{
+    uint32_t key[8];            /*!< The ChaCha20 key, as words. */
+}
+mbedtls_chachapoly_neon_context;
+
+/**
+ * \brief          This function tells which implementation the functions
+ *                 of this module use.
+ *
+ * \return         \c 1 if they use NEON, \c 0 if they use the portable
+ *                 code.
+ */
+int mbedtls_chachapoly_neon_has_support( void );
+
+/**
+ * \brief          This function encrypts or decrypts data with ChaCha20,
+ *                 as mbedtls_chacha20_crypt() does.
+ *
+ * \param key      The encryption/decryption key, 32 Bytes.
+ * \param nonce    The nonce, 12 Bytes.
+ * \param counter  The initial counter value, usually \c 0.
+ * \param size     The length of the input data in Bytes.
+ * \param input    The buffer holding the input data.
+ * \param output   The buffer holding the output data. It may be \p input.
+ *
+ * \return         \c 0 on success.
+ */
+int mbedtls_chacha20_neon_crypt( const unsigned char key[32],
+                                 const unsigned char nonce[12],
+                                 uint32_t counter,
+                                 size_t size,
+                                 const unsigned char *input,
+                                 unsigned char *output );
+
+/**
+ * \brief          This function calculates the Poly1305 MAC of the input
+ *                 buffer, as mbedtls_poly1305_mac() does.
+ *
+ * \param key      The one-time key, 32 Bytes.
+ * \param input    The buffer holding the data.
+ * \param ilen     The length of the input data in Bytes.
+ * \param mac      The buffer where the MAC is written, 16 Bytes.
+ *
+ * \return         \c 0 on success.
+ */
+int mbedtls_poly1305_neon_mac( const unsigned char key[32],
+                               const unsigned char *input,
+                               size_t ilen,
+                               unsigned char mac[16] );
+
+/**
+ * \brief          This function initializes a ChaCha20-Poly1305-NEON
+ *                 context.
+ *
+ * \param ctx      The context to initialize. This must not be \c NULL.
+ */
+void mbedtls_chachapoly_neon_init( mbedtls_chachapoly_neon_context *ctx );
+
+/**
+ * \brief          This function clears a ChaCha20-Poly1305-NEON context.
+ *
+ * \param ctx      The context to clear. If this is \c NULL, this function
+ *                 does nothing.
+ */
+void mbedtls_chachapoly_neon_free( mbedtls_chachapoly_neon_context *ctx );
+
+/**
+ * \brief          This function sets the ChaCha20-Poly1305 key.
+ *
+ * \param ctx      The context to which the key should be bound.
+ * \param key      The 256-bit key.
+ *
+ * \return         \c 0 on success.
+ */
+int mbedtls_chachapoly_neon_setkey( mbedtls_chachapoly_neon_context *ctx,
+                                    const unsigned char key[32] );
+
+/**
+ * \brief          This function performs a complete ChaCha20-Poly1305
+ *                 authenticated encryption, as
+ *                 mbedtls_chachapoly_encrypt_and_tag() does.
+ *
+ * \param ctx      The context to use, with a key set.
+ * \param length   The length of the data to encrypt in Bytes.
+ * \param nonce    The nonce, 12 Bytes. It must be unique for this key.
+ * \param aad      The buffer containing the additional authenticated
+ *                 data.
+ * \param aad_len  The length of the additional data in Bytes.
+ * \param input    The buffer containing the data to encrypt.
+ * \param output   The buffer to which the encrypted data is written. It
+ *                 may be \p input.
+ * \param tag      The buffer to which the tag is written, 16 Bytes.
+ *
+ * \return         \c 0 on success.
+ */
+int mbedtls_chachapoly_neon_encrypt_and_tag(
+                                    mbedtls_chachapoly_neon_context *ctx,
+                                    size_t length,
+                                    const unsigned char nonce[12],
+                                    const unsigned char *aad,
+                                    size_t aad_len,
+                                    const unsigned char *input,
+                                    unsigned char *output,
+                                    unsigned char tag[16] );
+
+/**
+ * \brief          This function performs a complete ChaCha20-Poly1305
+ *                 authenticated decryption, as
+ *                 mbedtls_chachapoly_auth_decrypt() does.
+ *
+ * \note           The tag is checked after the data is decrypted. On
+ *                 failure, \p output is cleared.
+ *
+ * \param ctx      The context to use, with a key set.
+ * \param length   The length of the data to decrypt in Bytes.
+ * \param nonce    The nonce, 12 Bytes.
+ * \param aad      The buffer containing the additional authenticated
+ *                 data.
+ * \param aad_len  The length of the additional data in Bytes.
+ * \param tag      The tag to check, 16 Bytes.
+ * \param input    The buffer containing the data to decrypt.
+ * \param output   The buffer to which the decrypted data is written. It
+ *                 may be \p input.
+ *
+ * \return         \c 0 on success.
+ * \return         #MBEDTLS_ERR_CHACHAPOLY_AUTH_FAILED if the data was not
+ *                 authentic.
+ */
+int mbedtls_chachapoly_neon_auth_decrypt(
+                                    mbedtls_chachapoly_neon_context *ctx,
+                                    size_t length,
+                                    const unsigned char nonce[12],
+                                    const unsigned char *aad,
+                                    size_t aad_len,
+                                    const unsigned char tag[16],
+                                    const unsigned char *input,
+                                    unsigned char *output );
+
+#if defined(MBEDTLS_SELF_TEST)
+/**
+ * \brief          Checkup routine
+ *
+ * \return         \c 0 on success, or \c 1 on failure.
+ */
+int mbedtls_chachapoly_neon_self_test( int verbose );
+#endif /* MBEDTLS_SELF_TEST */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MBEDTLS_CHACHAPOLY_NEON_H */
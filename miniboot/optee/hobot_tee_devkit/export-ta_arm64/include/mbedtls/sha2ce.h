@@ -0,0 +1,259 @@
+/**
+ * \file sha2ce.h
+ *
+ * \brief SHA-224/256 and SHA-384/512 with the Armv8 SHA2 and SHA512
+ *        instructions
+ *
+ *        The SHA-256 and SHA-512 of libmbedtls are generic C. This module
+ *        hashes in the TA with SHA256H/SHA256H2 and SHA512H/SHA512H2 when
+ *        the core implements them, with a NEON message schedule for
+ *        SHA-512 on cores without the SHA512 instructions, and with
+ *        portable C otherwise. update() hashes the whole blocks of its
+ *        input in place, without copying them through the context
+ *        buffer. The contexts are its own; the calling conventions are
+ *        those of sha256.h and sha512.h.
+ */
+/*
+ *  Copyright (c) 2026, D-Robotics
+ *  SPDX-License-Identifier: BSD-2-Clause
+ */
+#ifndef MBEDTLS_SHA2CE_H
+#define MBEDTLS_SHA2CE_H
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#include "mbedtls/sha256.h"
+#include "mbedtls/sha512.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief The SHA-256-CE context structure, for SHA-224 and SHA-256.
+ */
+typedef struct mbedtls_sha256ce_context
+{
+    uint64_t total;             /*!< The number of Bytes processed. */
+    uint32_t state[8];          /*!< The intermediate digest state. */
+    unsigned char buffer[64];   /*!< The data block being processed. */
+    int is224;                  /*!< 0 for SHA-256, 1 for SHA-224. */
+}
+mbedtls_sha256ce_context;
+
+/**
+ * \brief The SHA-512-CE context structure, for SHA-384 and SHA-512.
+ */
+typedef struct mbedtls_sha512ce_context
+{
+    uint64_t total[2];          /*!< The number of Bytes processed. */
+    uint64_t state[8];          /*!< The intermediate digest state. */
+    unsigned char buffer[128];  /*!< The data block being processed. */
+    int is384;                  /*!< 0 for SHA-512, 1 for SHA-384. */
+}
+mbedtls_sha512ce_context;
+
+/**
+ * \brief          This function tells which implementation the SHA-256-CE
+ *                 functions use.
+ *
+ * \return         \c 1 if they use the SHA256 instructions, \c 0 if they
+ *                 use the portable code.
+ */
+int mbedtls_sha256ce_has_support( void );
+
+/**
+ * \brief          This function initializes a SHA-256-CE context.
+ *
+ * \param ctx      The context to initialize. This must not be \c NULL.
+ */
+void mbedtls_sha256ce_init( mbedtls_sha256ce_context *ctx );
+
+/**
+ * \brief          This function clears a SHA-256-CE context.
+ *
+ * \param ctx      The context to clear. If this is \c NULL, this function
+ *                 does nothing.
+ */
+void mbedtls_sha256ce_free( mbedtls_sha256ce_context *ctx );
+
+/**
+ * \brief          This function clones the state of a SHA-256-CE context.
+ *
+ * \param dst      The destination context.
+ * \param src      The context to clone.
+ */
+void mbedtls_sha256ce_clone( mbedtls_sha256ce_context *dst,
+                             const mbedtls_sha256ce_context *src );
+
+/**
+ * \brief          This function starts a SHA-224 or SHA-256 checksum
+ *                 calculation.
+ *
+ * \param ctx      The context to use.
+ * \param is224    \c 0 for SHA-256, \c 1 for SHA-224.
+ *
+ * \return         \c 0 on success.
+ * \return         #MBEDTLS_ERR_SHA256_BAD_INPUT_DATA if \p is224 is
+ *                 neither.
+ */
+int mbedtls_sha256ce_starts_ret( mbedtls_sha256ce_context *ctx, int is224 );
+
+/**
+ * \brief          This function feeds an input buffer into an ongoing
+ *                 SHA-224 or SHA-256 checksum calculation.
+ *
+ * \param ctx      The context to use.
+ * \param input    The buffer holding the data.
+ * \param ilen     The length of the input data in Bytes.
+ *
+ * \return         \c 0 on success.
+ */
+int mbedtls_sha256ce_update_ret( mbedtls_sha256ce_context *ctx,
+                                 const unsigned char *input,
+                                 size_t ilen );
+
+/**
+ * \brief          This function finishes the SHA-224 or SHA-256 operation
+ *                 and writes the result to the output buffer.
+ *
+ * \param ctx      The context to use.
+ * \param output   The checksum result: 28 Bytes for SHA-224, 32 Bytes for
+ *                 SHA-256.
+ *
+ * \return         \c 0 on success.
+ */
+int mbedtls_sha256ce_finish_ret( mbedtls_sha256ce_context *ctx,
+                                 unsigned char output[32] );
+
+/**
+ * \brief          This function calculates the SHA-224 or SHA-256
+ *                 checksum of a buffer.
+ *
+ * \param input    The buffer holding the data.
+ * \param ilen     The length of the input data in Bytes.
+ * \param output   The checksum result.
+ * \param is224    \c 0 for SHA-256, \c 1 for SHA-224.
+ *
+ * \return         \c 0 on success.
+ * \return         #MBEDTLS_ERR_SHA256_BAD_INPUT_DATA if \p is224 is
+ *                 neither.
+ */
+int mbedtls_sha256ce_ret( const unsigned char *input,
+                          size_t ilen,
+                          unsigned char output[32],
+                          int is224 );
+
+/**
+ * \brief          This function tells which implementation the SHA-512-CE
+ *                 functions use.
+ *
+ * \return         \c 2 if they use the SHA512 instructions, \c 1 if they
+ *                 compute the message schedule with NEON, \c 0 if they use
+ *                 the portable code.
+ */
+int mbedtls_sha512ce_has_support( void );
+
+/**
+ * \brief          This function initializes a SHA-512-CE context.
+ *
+ * \param ctx      The context to initialize. This must not be \c NULL.
+ */
+void mbedtls_sha512ce_init( mbedtls_sha512ce_context *ctx );
+
+/**
+ * \brief          This function clears a SHA-512-CE context.
+ *
+ * \param ctx      The context to clear. If this is \c NULL, this function
+ *                 does nothing.
+ */
+void mbedtls_sha512ce_free( mbedtls_sha512ce_context *ctx );
+
+/**
+ * \brief          This function clones the state of a SHA-512-CE context.
+ *
+ * \param dst      The destination context.
+ * \param src      The context to clone.
+ */
+void mbedtls_sha512ce_clone( mbedtls_sha512ce_context *dst,
+                             const mbedtls_sha512ce_context *src );
+
+/**
+ * \brief          This function starts a SHA-384 or SHA-512 checksum
+ *                 calculation.
+ *
+ * \param ctx      The context to use.
+ * \param is384    \c 0 for SHA-512, \c 1 for SHA-384.
+ *
+ * \return         \c 0 on success.
+ * \return         #MBEDTLS_ERR_SHA512_BAD_INPUT_DATA if \p is384 is
+ *                 neither.
+ */
+int mbedtls_sha512ce_starts_ret( mbedtls_sha512ce_context *ctx, int is384 );
+
+/**
+ * \brief          This function feeds an input buffer into an ongoing
+ *                 SHA-384 or SHA-512 checksum calculation.
+ *
+ * \param ctx      The context to use.
+ * \param input    The buffer holding the data.
+ * \param ilen     The length of the input data in Bytes.
+ *
+ * \return         \c 0 on success.
+ */
+int mbedtls_sha512ce_update_ret( mbedtls_sha512ce_context *ctx,
+                                 const unsigned char *input,
+                                 size_t ilen );
+
+/**
+ * \brief          This function finishes the SHA-384 or SHA-512 operation
+ *                 and writes the result to the output buffer.
+ *
+ * \param ctx      The context to use.
+ * \param output   The checksum result: 48 Bytes for SHA-384, 64 Bytes for
+ *                 SHA-512.
+ *
+ * \return         \c 0 on success.
+ */
+int mbedtls_sha512ce_finish_ret( mbedtls_sha512ce_context *ctx,
+                                 unsigned char output[64] );
+
+/**
+ * \brief          This function calculates the SHA-384 or SHA-512
+ *                 checksum of a buffer.
+ *
+ * \param input    The buffer holding the data.
+ * \param ilen     The length of the input data in Bytes.
+ * \param output   The checksum result.
+ * \param is384    \c 0 for SHA-512, \c 1 for SHA-384.
+ *
+ * \return         \c 0 on success.
+ * \return         #MBEDTLS_ERR_SHA512_BAD_INPUT_DATA if \p is384 is
+ *                 neither.
+ */
+int mbedtls_sha512ce_ret( const unsigned char *input,
+                          size_t ilen,
+                          unsigned char output[64],
+                          int is384 );
+
+#if defined(MBEDTLS_SELF_TEST)
+/**
+ * \brief          Checkup routine
+ *
+ * \return         \c 0 on success, or \c 1 on failure.
+ */
+int mbedtls_sha2ce_self_test( int verbose );
+#endif /* MBEDTLS_SELF_TEST */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MBEDTLS_SHA2CE_H */
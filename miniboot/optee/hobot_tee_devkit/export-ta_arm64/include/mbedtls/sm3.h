@@ -207,6 +207,142 @@ int mbedtls_sm3_ret( const unsigned char *input,
                      size_t ilen,
                      unsigned char output[32] );
 
+#if defined(MBEDTLS_SM3_MB_C)
+/**
+ * Number of messages the multi-buffer functions hash in parallel
+ */
+#define MBEDTLS_SM3_MB_MAX_LANES    8
+
+/**
+ * \brief          A message of the multi-buffer functions
+ */
+typedef struct mbedtls_sm3_mb_job
+{
+    const unsigned char *input; /*!< The message */
+    size_t ilen;                /*!< The length of the message */
+    unsigned char *output;      /*!< The 32 Bytes SM3 checksum result */
+    void *user_data;            /*!< Free for the caller */
+}
+mbedtls_sm3_mb_job;
+
+/**
+ * \brief          Multi-buffer SM3 job manager
+ *
+ *                 Jobs are hashed in the lanes of the manager, in parallel.
+ *                 The messages may have different lengths: a job completes
+ *                 as soon as its message is hashed, its lane then takes the
+ *                 next job submitted.
+ */
+typedef struct mbedtls_sm3_mb_context
+{
+    uint32_t state[8][MBEDTLS_SM3_MB_MAX_LANES];    /*!< The intermediate
+                                                         digest states, lane
+                                                         by lane */
+    mbedtls_sm3_mb_job *jobs[MBEDTLS_SM3_MB_MAX_LANES]; /*!< The job of each
+                                                         lane, or NULL */
+    const unsigned char *data[MBEDTLS_SM3_MB_MAX_LANES]; /*!< The next block
+                                                         of each lane */
+    size_t blocks[MBEDTLS_SM3_MB_MAX_LANES];    /*!< The blocks left at data */
+    size_t tail_blocks[MBEDTLS_SM3_MB_MAX_LANES]; /*!< The blocks of tail
+                                                       not yet started */
+    unsigned char tail[MBEDTLS_SM3_MB_MAX_LANES][128]; /*!< The last, padded,
+                                                            blocks */
+    unsigned int lanes;         /*!< The number of lanes */
+}
+mbedtls_sm3_mb_context;
+
+/**
+ * \brief          Initialize a multi-buffer SM3 job manager
+ *
+ * \param ctx      The job manager to be initialized
+ * \param lanes    The number of messages hashed in parallel, \c 4 or
+ *                 \c MBEDTLS_SM3_MB_MAX_LANES
+ *
+ * \return         \c 0 if successful
+ * \return         #MBEDTLS_ERR_SM3_BAD_INPUT_DATA if \p lanes is invalid
+ */
+int mbedtls_sm3_mb_init( mbedtls_sm3_mb_context *ctx, unsigned int lanes );
+
+/**
+ * \brief          Clear a multi-buffer SM3 job manager, the jobs in
+ *                 progress are dropped
+ *
+ * \param ctx      The job manager to be cleared
+ */
+void mbedtls_sm3_mb_free( mbedtls_sm3_mb_context *ctx );
+
+/**
+ * \brief          Submit a job
+ *
+ *                 When all the lanes are busy, the messages are hashed until
+ *                 a job completes. The job and its message must stay valid
+ *                 until the job is returned by this function or by
+ *                 \c mbedtls_sm3_mb_flush().
+ *
+ * \param ctx      The job manager
+ * \param job      The job to submit
+ * \param done     Set to a completed job, or to NULL
+ *
+ * \return         \c 0 if successful
+ * \return         #MBEDTLS_ERR_SM3_BAD_INPUT_DATA if \p job is invalid,
+ *                 then it is not submitted
+ */
+int mbedtls_sm3_mb_submit( mbedtls_sm3_mb_context *ctx,
+                           mbedtls_sm3_mb_job *job,
+                           mbedtls_sm3_mb_job **done );
+
+/**
+ * \brief          Complete a job without submitting a new one
+ *
+ *                 To be called until \p done is set to NULL once all the
+ *                 jobs have been submitted.
+ *
+ * \param ctx      The job manager
+ * \param done     Set to a completed job, or to NULL if no job is left
+ *
+ * \return         \c 0 if successful
+ */
+int mbedtls_sm3_mb_flush( mbedtls_sm3_mb_context *ctx,
+                          mbedtls_sm3_mb_job **done );
+
+/**
+ * \brief          Hash several independent messages, in parallel
+ *
+ *                 The result is the same as calling \c mbedtls_sm3_ret()
+ *                 for each job. Messages of close lengths are best passed
+ *                 together.
+ *
+ * \param n        The number of jobs
+ * \param jobs     The jobs
+ *
+ * \return         \c 0 if successful
+ * \return         #MBEDTLS_ERR_SM3_BAD_INPUT_DATA if a job is invalid,
+ *                 then no message is hashed
+ */
+int mbedtls_sm3_mb_multi( size_t n, mbedtls_sm3_mb_job *jobs );
+
+/**
+ * \brief          Output = SM3( input buffer ), with the single stream
+ *                 software implementation of the multi-buffer functions
+ *
+ * \param input    buffer holding the data
+ * \param ilen     length of the input data
+ * \param output   SM3 checksum result
+ *
+ * \return         \c 0 if successful
+ */
+int mbedtls_sm3_mb_ret( const unsigned char *input,
+                        size_t ilen,
+                        unsigned char output[32] );
+
+/**
+ * \brief          Checkup routine of the multi-buffer functions
+ *
+ * \return         \c 0 if successful, or 1 if the test failed
+ */
+int mbedtls_sm3_mb_self_test( int verbose );
+#endif /* MBEDTLS_SM3_MB_C */
+
 /**
  * \brief          Checkup routine
  *
@@ -22,6 +22,19 @@
 #include <stddef.h>
 #include <stdint.h>
 
+/*
+ * The software SM4 of ta/lib/mbedtls_ext provides CTR and XTS whatever the
+ * modes the configuration enables for the ciphers of libmbedtls
+ */
+#if defined(MBEDTLS_CIPHER_MODE_CTR) || \
+    ( defined(MBEDTLS_SM4_C) && !defined(MBEDTLS_SM4_ALT) )
+#define MBEDTLS_SM4_MODE_CTR
+#endif
+#if defined(MBEDTLS_CIPHER_MODE_XTS) || \
+    ( defined(MBEDTLS_SM4_C) && !defined(MBEDTLS_SM4_ALT) )
+#define MBEDTLS_SM4_MODE_XTS
+#endif
+
 /* padlock.c and sm4ni.c rely on these values! */
 #define MBEDTLS_SM4_ENCRYPT     1 /**< SM4 encryption. */
 #define MBEDTLS_SM4_DECRYPT     0 /**< SM4 decryption. */
@@ -61,7 +74,7 @@ typedef struct mbedtls_sm4_context
 }
 mbedtls_sm4_context;
 
-#if defined(MBEDTLS_CIPHER_MODE_XTS)
+#if defined(MBEDTLS_SM4_MODE_XTS)
 /**
  * \brief The SM4 XTS context-type definition.
  */
@@ -72,7 +85,7 @@ typedef struct mbedtls_sm4_xts_context
     mbedtls_sm4_context tweak; /*!< The SM4 context used for tweak
                                         computation. */
 } mbedtls_sm4_xts_context;
-#endif /* MBEDTLS_CIPHER_MODE_XTS */
+#endif /* MBEDTLS_SM4_MODE_XTS */
 
 #else  /* MBEDTLS_SM4_ALT */
 #include "sm4_alt.h"
@@ -130,7 +143,7 @@ int mbedtls_sm4_clone( mbedtls_sm4_context *dst,
  */
 void mbedtls_sm4_free( mbedtls_sm4_context *ctx );
 
-#if defined(MBEDTLS_CIPHER_MODE_XTS)
+#if defined(MBEDTLS_SM4_MODE_XTS)
 /**
  * \brief          This function initializes the specified SM4 XTS context.
  *
@@ -159,7 +172,7 @@ int mbedtls_sm4_xts_clone( mbedtls_sm4_xts_context *dst,
  *                 Otherwise, the context must have been at least initialized.
  */
 void mbedtls_sm4_xts_free( mbedtls_sm4_xts_context *ctx );
-#endif /* MBEDTLS_CIPHER_MODE_XTS */
+#endif /* MBEDTLS_SM4_MODE_XTS */
 
 /**
  * \brief          This function sets the encryption key.
@@ -219,7 +232,7 @@ int mbedtls_sm4_setkey_dec( mbedtls_sm4_context *ctx, const unsigned char *key,
 
 int mbedtls_sm4_setseckey_dec( mbedtls_sm4_context *ctx,
                                mbedtls_sm4_sec_key_t *key );
-#if defined(MBEDTLS_CIPHER_MODE_XTS)
+#if defined(MBEDTLS_SM4_MODE_XTS)
 /**
  * \brief          This function prepares an XTS context for encryption and
  *                 sets the encryption key.
@@ -292,7 +305,7 @@ int mbedtls_sm4_xts_setkey_dec( mbedtls_sm4_xts_context *ctx,
 int mbedtls_sm4_xts_setseckey_dec( mbedtls_sm4_xts_context *ctx,
                                        mbedtls_sm4_sec_key_t *key1,
                                        mbedtls_sm4_sec_key_t *key2);
-#endif /* MBEDTLS_CIPHER_MODE_XTS */
+#endif /* MBEDTLS_SM4_MODE_XTS */
 
 /**
  * \brief          This function performs an SM4 single-block encryption or
@@ -322,6 +335,38 @@ int mbedtls_sm4_crypt_ecb( mbedtls_sm4_context *ctx,
                     const unsigned char input[16],
                     unsigned char output[16] );
 
+#if !defined(MBEDTLS_SM4_ALT)
+/**
+ * \brief          This function performs an SM4 encryption or decryption
+ *                 operation on several blocks. Only the software
+ *                 implementation provides it.
+ *
+ *                 The blocks are processed several at a time, which is
+ *                 faster than calling mbedtls_sm4_crypt_ecb() for each.
+ *
+ * \param ctx      The SM4 context to use for encryption or decryption.
+ *                 It must be initialized and bound to a key.
+ * \param mode     The SM4 operation: #MBEDTLS_SM4_ENCRYPT or
+ *                 #MBEDTLS_SM4_DECRYPT.
+ * \param length   The length of the input data in Bytes. This must be a
+ *                 multiple of the block size (\c 16 Bytes).
+ * \param input    The buffer holding the input data.
+ *                 It must be readable and of size \p length Bytes.
+ * \param output   The buffer holding the output data. It may be the same
+ *                 as \p input. It must be writeable and of size \p length
+ *                 Bytes.
+ *
+ * \return         \c 0 on success.
+ * \return         #MBEDTLS_ERR_SM4_INVALID_INPUT_LENGTH
+ *                 on failure.
+ */
+int mbedtls_sm4_crypt_ecb_blocks( mbedtls_sm4_context *ctx,
+                                  int mode,
+                                  size_t length,
+                                  const unsigned char *input,
+                                  unsigned char *output );
+#endif /* !MBEDTLS_SM4_ALT */
+
 #if defined(MBEDTLS_CIPHER_MODE_CBC)
 /**
  * \brief  This function performs an SM4-CBC encryption or decryption operation
@@ -372,7 +417,7 @@ int mbedtls_sm4_crypt_cbc( mbedtls_sm4_context *ctx,
                     unsigned char *output );
 #endif /* MBEDTLS_CIPHER_MODE_CBC */
 
-#if defined(MBEDTLS_CIPHER_MODE_XTS)
+#if defined(MBEDTLS_SM4_MODE_XTS)
 /**
  * \brief      This function performs an SM4-XTS encryption or decryption
  *             operation for an entire XTS data unit.
@@ -395,7 +440,8 @@ int mbedtls_sm4_crypt_cbc( mbedtls_sm4_context *ctx,
  * \param data_unit    The address of the data unit encoded as an array of 16
  *                     bytes in little-endian format. For disk encryption, this
  *                     is typically the index of the block device sector that
- *                     contains the data. Updated after used.
+ *                     contains the data. Updated after used: it is
+ *                     incremented to the address of the next data unit.
  * \param input        The buffer holding the input data (which is an entire
  *                     data unit). This function reads \p length Bytes from \p
  *                     input.
@@ -414,7 +460,7 @@ int mbedtls_sm4_crypt_xts( mbedtls_sm4_xts_context *ctx,
                            unsigned char data_unit[16],
                            const unsigned char *input,
                            unsigned char *output );
-#endif /* MBEDTLS_CIPHER_MODE_XTS */
+#endif /* MBEDTLS_SM4_MODE_XTS */
 
 #if defined(MBEDTLS_CIPHER_MODE_CFB)
 /**
@@ -563,7 +609,7 @@ int mbedtls_sm4_crypt_ofb( mbedtls_sm4_context *ctx,
 
 #endif /* MBEDTLS_CIPHER_MODE_OFB */
 
-#if defined(MBEDTLS_CIPHER_MODE_CTR)
+#if defined(MBEDTLS_SM4_MODE_CTR)
 /**
  * \brief      This function performs an SM4-CTR encryption or decryption
  *             operation.
@@ -647,7 +693,7 @@ int mbedtls_sm4_crypt_ctr( mbedtls_sm4_context *ctx,
                        unsigned char stream_block[16],
                        const unsigned char *input,
                        unsigned char *output );
-#endif /* MBEDTLS_CIPHER_MODE_CTR */
+#endif /* MBEDTLS_SM4_MODE_CTR */
 
 /**
  * \brief           Internal SM4 block encryption function. This is only
@@ -19,12 +19,12 @@
 #include MBEDTLS_CONFIG_FILE
 #endif /* MBEDTLS_CONFIG_FILE */
 
-#if !defined(CFG_MBEDTLS_TE)
+#if !defined(CFG_MBEDTLS_TE) && defined(__KERNEL__)
 #include <linux/types.h>
-#else /* !CFG_MBEDTLS_TE */
+#else /* !CFG_MBEDTLS_TE && __KERNEL__ */
 #include <stddef.h>
 #include <stdint.h>
-#endif /* CFG_MBEDTLS_TE */
+#endif /* CFG_MBEDTLS_TE || !__KERNEL__ */
 
 #include "klad.h"
 
@@ -39,19 +39,48 @@
 extern "C" {
 #endif
 
+/**
+ * Number of messages \c mbedtls_eea3_crypt_multi() generates the
+ * keystreams of in parallel
+ */
+#define MBEDTLS_ZUC_MAX_LANES   8
+
 #if !defined (MBEDTLS_ZUC_ALT)
+/**
+ *  ZUC keystream generator state
+ */
+typedef struct {
+    uint32_t lfsr[16];          /*!< LFSR cells, 31 bits each, the cell
+                                     s(i) being lfsr[(head + i) % 16] */
+    uint32_t r1;                /*!< F function memory cell R1 */
+    uint32_t r2;                /*!< F function memory cell R2 */
+    unsigned int head;          /*!< Index of s(0) in lfsr */
+} mbedtls_zuc_state;
+
 /**
  *  eea3 context structure
  */
 typedef struct {
-    void *placeholder;  /*just a placeholder meaningless, add sw impl. here */
+    mbedtls_zuc_state zuc;      /*!< Keystream generator */
+    unsigned char key[16];      /*!< Confidentiality key */
+    unsigned char ks[4];        /*!< Current keystream word, big endian */
+    size_t ks_used;             /*!< Bytes of ks already used */
+    int state;                  /*!< Calling sequence state */
 } mbedtls_eea3_context;
 
 /**
  *  eia3 context structure
  */
 typedef struct {
-    void *placeholder;  /*just a placeholder meaningless, add sw impl. here */
+    mbedtls_zuc_state zuc;      /*!< Keystream generator */
+    unsigned char key[16];      /*!< Integrity key */
+    uint64_t win;               /*!< Keystream from the current bit on,
+                                     most significant bit first */
+    unsigned int win_bits;      /*!< Valid bits in win */
+    uint32_t words;             /*!< Keystream words generated */
+    uint32_t t;                 /*!< MAC accumulator */
+    size_t bits;                /*!< Message bits processed */
+    int state;                  /*!< Calling sequence state */
 } mbedtls_eia3_context;
 #else /* !MBEDTLS_ZUC_ALT */
     #include "zuc_alt.h"
@@ -270,6 +299,43 @@ int mbedtls_eea3_crypt_seckey( const mbedtls_klad_seckey_t *key,
                                const unsigned char *input,
                                unsigned char *output );
 
+/**
+ * \brief           One message of \c mbedtls_eea3_crypt_multi()
+ */
+typedef struct {
+    const unsigned char *key;   /*!< 16 Bytes encryption/decryption key */
+    uint32_t count;             /*!< The count frame dependent input */
+    uint32_t bearer;            /*!< The bearer identity, 5 bits */
+    uint32_t dir;               /*!< The direction of transmission, 1 bit */
+    size_t size;                /*!< The length of input and output */
+    const unsigned char *input; /*!< The input data */
+    unsigned char *output;      /*!< The output data */
+} mbedtls_eea3_msg;
+
+#if !defined(MBEDTLS_ZUC_ALT)
+/**
+ * \brief           This function encrypts or decrypts several independent
+ *                  messages with eea3, typically the PDUs of different
+ *                  bearers. Only the software implementation
+ *                  provides it.
+ *
+ *                  The keystreams of up to \c MBEDTLS_ZUC_MAX_LANES
+ *                  messages are generated in parallel, each step being
+ *                  applied to all of them so that the compiler can
+ *                  vectorize it. The result is the same as calling
+ *                  \c mbedtls_eea3_crypt() for each message.
+ *
+ * \param n         The number of messages.
+ * \param msgs      The messages. Input and output may be the same buffer
+ *                  but must not otherwise overlap.
+ *
+ * \return          \c 0 on success.
+ *                  \c MBEDTLS_ERR_ZUC_BAD_INPUT_DATA if a message has an
+ *                     invalid field, then no message is processed.
+ */
+int mbedtls_eea3_crypt_multi( size_t n, const mbedtls_eea3_msg *msgs );
+#endif /* !MBEDTLS_ZUC_ALT */
+
 /**
  * \brief          This function initializes the specified EIA3 context.
  *
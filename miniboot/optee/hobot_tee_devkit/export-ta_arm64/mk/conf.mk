@@ -26,4 +26,7 @@ COMPILER ?= gcc
 COMPILER_ta_arm64 ?= $(COMPILER)
 PYTHON3 ?= python3
 CFG_TEE_TA_LOG_LEVEL ?= 1
+CFG_TA_REPRODUCIBLE_BUILD ?= n
 
+CFG_TA_CRYPTO_WITH_CE ?= n
+CFG_TA_CRYPTO_CE_DETECT ?= n
@@ -102,6 +102,9 @@ $(link-out-dir$(sm))/$(user-ta-uuid).stripped.elf: \
 	$(q)$(OBJCOPY$(sm)) --strip-unneeded $$< $$@
 
 cmd-echo$(user-ta-uuid) := SIGN   #
+ifeq ($(CFG_TA_REPRODUCIBLE_BUILD),y)
+sign-args$(user-ta-uuid) := --deterministic
+endif
 ifeq ($(CFG_ENCRYPT_TA),y)
 crypt-args$(user-ta-uuid) := --enc-key $(TA_ENC_KEY)
 cmd-echo$(user-ta-uuid) := SIGNENC
@@ -112,7 +115,7 @@ $(link-out-dir$(sm))/$(user-ta-uuid).ta: \
 			$(lastword $(SIGN_ENC))
 	@$(cmd-echo-silent) '  $$(cmd-echo$(user-ta-uuid)) $$@'
 	$(q)$(SIGN_ENC) --key $(TA_SIGN_KEY) $(TA_SUBKEY_ARGS) \
-		$$(crypt-args$(user-ta-uuid)) \
+		$$(sign-args$(user-ta-uuid)) $$(crypt-args$(user-ta-uuid)) \
 		--uuid $(user-ta-uuid) --ta-version $(user-ta-version) \
 		--in $$< --out $$@
 endef
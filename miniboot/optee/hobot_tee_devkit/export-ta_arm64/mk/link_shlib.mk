@@ -5,6 +5,9 @@ link-out-dir = $(out-dir)
 
 SIGN ?= $(TA_DEV_KIT_DIR)/scripts/sign_encrypt.py
 TA_SIGN_KEY ?= $(TA_DEV_KIT_DIR)/keys/default_ta.pem
+ifeq ($(CFG_TA_REPRODUCIBLE_BUILD),y)
+shlib-sign-args := --deterministic
+endif
 
 all: $(link-out-dir)/$(shlibname).so $(link-out-dir)/$(shlibname).dmp \
 	$(link-out-dir)/$(shlibname).stripped.so \
@@ -51,4 +54,5 @@ $(link-out-dir)/$(shlibuuid).ta: $(link-out-dir)/$(shlibname).stripped.so \
 				$(TA_SIGN_KEY) $(TA_SUBKEY_DEPS)
 	@$(cmd-echo-silent) '  SIGN    $@'
 	$(q)$(PYTHON3) $(SIGN) --key $(TA_SIGN_KEY) $(TA_SUBKEY_ARGS) \
+		$(shlib-sign-args) \
 		--uuid $(shlibuuid) --in $< --out $@
@@ -119,6 +119,25 @@ clean:
 include  $(ta-dev-kit-dir$(sm))/mk/$(COMPILER_$(sm)).mk
 include  $(ta-dev-kit-dir$(sm))/mk/cc-option.mk
 
+arflags$(sm) := rcs
+ifeq ($(CFG_TA_REPRODUCIBLE_BUILD),y)
+# The same sources give the same TA wherever and whenever they are built:
+# build paths are remapped in __FILE__ and the debug info, __DATE__ and
+# __TIME__ are pinned, archive members get no timestamps and, see
+# link.mk, the TA is signed and encrypted deterministically.
+# With several matching prefixes GCC uses the last one.
+repro-prefix-map := $(CURDIR)=. $(ta-dev-kit-dir$(sm))=ta_dev_kit \
+		    $(abspath $(out-dir))=out
+repro-cflags := $(foreach m,$(repro-prefix-map), \
+		  $(call cc-option,-ffile-prefix-map=$(m),-fdebug-prefix-map=$(m)))
+cflags$(sm) += $(repro-cflags)
+cxxflags$(sm) += $(repro-cflags)
+aflags$(sm) += $(foreach m,$(repro-prefix-map),-fdebug-prefix-map=$(m))
+arflags$(sm) := rcsD
+SOURCE_DATE_EPOCH ?= 0
+export SOURCE_DATE_EPOCH
+endif
+
 subdirs = .
 include  $(ta-dev-kit-dir$(sm))/mk/subdir.mk
 
@@ -146,7 +165,7 @@ cleanfiles += $(libname).a
 
 $(libname).a: $(objs)
 	@echo '  AR      $@'
-	$(q)rm -f $@ && $(AR$(sm)) rcs $@ $^
+	$(q)rm -f $@ && $(AR$(sm)) $(arflags$(sm)) $@ $^
 endif
 
 ifneq (,$(shlibname))
@@ -0,0 +1,489 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: BSD-2-Clause
+#
+# Copyright (c) 2026, D-Robotics
+#
+
+import argparse
+import glob
+import os
+import re
+import struct
+import subprocess
+import sys
+
+GMON_MAGIC = b'gmon'
+GMON_VERSION = 1
+GMON_HDR_SIZE = 4 + 4 + 3 * 4
+
+GMON_TAG_TIME_HIST = 0
+GMON_TAG_CG_ARC = 1
+GMON_TAG_BB_COUNT = 2
+
+UUID_RE = re.compile(r'(?P<uuid>[0-9a-f]{8}-[0-9a-f]{4}-[0-9a-f]{4}-'
+                     r'[0-9a-f]{4}-[0-9a-f]{12})')
+
+epilog = '''
+This script reads the profiling data (gmon.out format) that libutee sends to
+tee-supplicant through the gprof pseudo-TA (PTA_GPROF_SEND) when a TA is built
+with CFG_TA_GPROF_SUPPORT=y and -pg. Each file holds the PC sampling histogram
+(PTA_GPROF_START_PC_SAMPLING/PTA_GPROF_STOP_PC_SAMPLING) and the call arcs
+recorded during one TA session.
+
+Files are grouped by TA UUID, which is taken from the file name unless --uuid
+is given. Histograms and arcs of all sessions and invocations of a TA are
+rebased to link-time addresses (TAs are loaded at a random address when ASLR is
+enabled) and merged, then symbolized against <uuid>.elf, which is searched in
+the directories given with -d.
+
+The GNU binutils nm is used to read the symbol table. If the CROSS_COMPILE
+environment variable is set, it is used as a prefix, otherwise the prefix is
+derived from the ELF architecture.
+
+Sample usage:
+
+  $ scripts/gprof_report.py -d out/ta/os_test /tmp/gmon-*.out
+  $ scripts/gprof_report.py -d out/ta/os_test --folded os_test.folded \\
+        /tmp/gmon-5b9e0e40-2636-11e1-ad9e-0002a5d5c51b*.out
+  $ flamegraph.pl os_test.folded > os_test.svg
+'''
+
+
+def get_args():
+    parser = argparse.ArgumentParser(
+        formatter_class=argparse.RawDescriptionHelpFormatter,
+        description='Merges and reports OP-TEE TA gprof data',
+        epilog=epilog)
+    parser.add_argument('gmon', nargs='+',
+                        help='gmon.out files received by tee-supplicant')
+    parser.add_argument('-d', '--dir', action='append', default=[],
+                        help='Search for <uuid>.elf in DIR. ELF files may '
+                        'also be given directly.')
+    parser.add_argument('-u', '--uuid',
+                        help='TA UUID to use for all files instead of the '
+                        'one found in the file names')
+    parser.add_argument('-f', '--flat', action='store_true',
+                        help='Only print the flat profile')
+    parser.add_argument('-g', '--graph', action='store_true',
+                        help='Only print the call graph')
+    parser.add_argument('--folded',
+                        help='Write folded stacks (flamegraph.pl input) to '
+                        'FOLDED, or to stdout if FOLDED is "-"')
+    parser.add_argument('--min-percent', type=float, default=0.0,
+                        help='Hide functions below this share of the '
+                        'samples in the flat profile (default: 0)')
+
+    return parser.parse_args()
+
+
+class GmonSession(object):
+    """ Content of one gmon.out file, i.e. one TA session """
+
+    def __init__(self, path, data):
+        self.path = path
+        self.low_pc = None
+        self.high_pc = None
+        self.prof_rate = 0
+        self.hist = []
+        self.arcs = []
+        self._parse(data)
+
+    def _parse(self, data):
+        if len(data) < GMON_HDR_SIZE or data[0:4] != GMON_MAGIC:
+            raise Exception('{}: not a gmon file'.format(self.path))
+        [version] = struct.unpack('<i', data[4:8])
+        if version != GMON_VERSION:
+            raise Exception('{}: unsupported gmon version {}'
+                            .format(self.path, version))
+
+        # libutee fills in the header with its native uintptr_t. A 32-bit TA
+        # produces 4-byte addresses, try the 64-bit layout first.
+        for ptr_fmt in ('Q', 'I'):
+            try:
+                self._parse_records(data[GMON_HDR_SIZE:], ptr_fmt)
+                return
+            except (struct.error, ValueError):
+                self.hist = []
+                self.arcs = []
+        raise Exception('{}: corrupt gmon records'.format(self.path))
+
+    def _parse_records(self, data, ptr_fmt):
+        hist_fmt = '<' + ptr_fmt * 2 + 'II15sc'
+        arc_fmt = '<' + ptr_fmt * 2 + 'I'
+        hist_size = struct.calcsize(hist_fmt)
+        arc_size = struct.calcsize(arc_fmt)
+
+        offs = 0
+        while offs < len(data):
+            tag = data[offs]
+            offs += 1
+            if tag == GMON_TAG_TIME_HIST:
+                [low, high, nbins, rate, dimen,
+                 _] = struct.unpack_from(hist_fmt, data, offs)
+                offs += hist_size
+                if high < low or not dimen.startswith(b'seconds'):
+                    raise ValueError
+                bins = struct.unpack_from('<{}H'.format(nbins), data, offs)
+                offs += 2 * nbins
+                if self.low_pc is not None and (low, high) != \
+                   (self.low_pc, self.high_pc):
+                    raise ValueError
+                self.low_pc = low
+                self.high_pc = high
+                self.prof_rate = rate
+                if self.hist:
+                    self.hist = [a + b for a, b in zip(self.hist, bins)]
+                else:
+                    self.hist = list(bins)
+            elif tag == GMON_TAG_CG_ARC:
+                [frompc, selfpc, count] = struct.unpack_from(arc_fmt, data,
+                                                             offs)
+                offs += arc_size
+                self.arcs.append((frompc, selfpc, count))
+            elif tag == GMON_TAG_BB_COUNT:
+                # Basic-block counts are not produced by libutee, skip them
+                [nrec] = struct.unpack_from('<I', data, offs)
+                offs += 4 + nrec * 2 * struct.calcsize(ptr_fmt)
+            else:
+                raise ValueError
+        if self.low_pc is None:
+            raise ValueError
+
+    def bin_pcs(self):
+        """ Yields (pc, count) for each non-empty histogram bin """
+        if not self.hist:
+            return
+        bin_size = (self.high_pc - self.low_pc) / len(self.hist)
+        for n, count in enumerate(self.hist):
+            if count:
+                yield int(self.low_pc + (n + 0.5) * bin_size), count
+
+
+class ElfSymbols(object):
+    def __init__(self, elf):
+        self.elf = elf
+        self.text_start = None
+        self.funcs = []
+        self._load()
+
+    def _nm_cmd(self):
+        prefix = os.getenv('CROSS_COMPILE')
+        if prefix is None:
+            p = subprocess.run(['file', '-L', self.elf],
+                               stdout=subprocess.PIPE,
+                               universal_newlines=True)
+            if 'ARM aarch64,' in p.stdout:
+                prefix = 'aarch64-linux-gnu-'
+            elif 'ARM,' in p.stdout:
+                prefix = 'arm-linux-gnueabihf-'
+            else:
+                prefix = ''
+        return prefix + 'nm'
+
+    def _load(self):
+        cmd = self._nm_cmd()
+        try:
+            p = subprocess.run([cmd, '--numeric-sort', '--print-size',
+                                '--defined-only', self.elf],
+                               stdout=subprocess.PIPE,
+                               universal_newlines=True, check=True)
+        except OSError:
+            print('*** Error:{}: command not found'.format(cmd),
+                  file=sys.stderr)
+            sys.exit(1)
+
+        for line in p.stdout.splitlines():
+            f = line.split()
+            if len(f) == 4:
+                addr, size, typ, name = f
+            elif len(f) == 3:
+                addr, typ, name = f
+                size = '0'
+            else:
+                continue
+            if name == '__text_start':
+                self.text_start = int(addr, 16)
+            if typ not in 'tTwW':
+                continue
+            self.funcs.append([int(addr, 16), int(size, 16), name])
+
+        # Symbols without size extend up to the next symbol
+        for n, f in enumerate(self.funcs):
+            if f[1] == 0 and n + 1 < len(self.funcs):
+                f[1] = self.funcs[n + 1][0] - f[0]
+        self._addrs = [f[0] for f in self.funcs]
+        if self.text_start is None and self.funcs:
+            self.text_start = self.funcs[0][0]
+
+    def lookup(self, addr):
+        import bisect
+
+        n = bisect.bisect_right(self._addrs, addr) - 1
+        if n < 0:
+            return None
+        f = self.funcs[n]
+        if addr >= f[0] + max(f[1], 1):
+            return None
+        return f[2]
+
+
+class Profile(object):
+    """ Merged profile of all sessions of one TA """
+
+    def __init__(self, uuid, syms):
+        self.uuid = uuid
+        self.syms = syms
+        self.sessions = 0
+        self.self_time = {}
+        self.samples = 0
+        self.total_time = 0.0
+        self.arcs = {}
+        self.calls = {}
+        self.unknown_time = 0.0
+
+    def func(self, addr):
+        name = self.syms.lookup(addr)
+        if name is None:
+            return '<0x{:x}>'.format(addr)
+        return name
+
+    def add(self, sess):
+        self.sessions += 1
+        # The histogram starts at the runtime address of __text_start, which
+        # moves from one session to the next when the TA is relocated.
+        delta = self.syms.text_start - sess.low_pc
+        rate = sess.prof_rate or 1
+        for pc, count in sess.bin_pcs():
+            t = count / rate
+            self.samples += count
+            self.total_time += t
+            name = self.syms.lookup(pc + delta)
+            if name is None:
+                self.unknown_time += t
+                continue
+            self.self_time[name] = self.self_time.get(name, 0.0) + t
+
+        for frompc, selfpc, count in sess.arcs:
+            caller = self.func(frompc + delta)
+            callee = self.func(selfpc + delta)
+            key = (caller, callee)
+            self.arcs[key] = self.arcs.get(key, 0) + count
+            self.calls[callee] = self.calls.get(callee, 0) + count
+
+    def funcs(self):
+        names = set(self.self_time)
+        for caller, callee in self.arcs:
+            names.add(caller)
+            names.add(callee)
+        return names
+
+    def callers(self, name):
+        return [(c, n) for (c, e), n in self.arcs.items()
+                if e == name and c != name]
+
+    def callees(self, name):
+        return [(e, n) for (c, e), n in self.arcs.items()
+                if c == name and e != name]
+
+    def child_times(self):
+        """
+        Propagates self time from callees to callers in proportion to the
+        number of calls made by each caller, as gprof does. Recursion is
+        handled by ignoring arcs that close a cycle.
+        """
+        total = {}
+        active = set()
+
+        def visit(name):
+            if name in total:
+                return total[name]
+            if name in active:
+                return 0.0
+            active.add(name)
+            t = self.self_time.get(name, 0.0)
+            for callee, count in self.callees(name):
+                ncalls = self.calls.get(callee, 0)
+                if ncalls:
+                    t += visit(callee) * count / ncalls
+            active.discard(name)
+            total[name] = t
+            return t
+
+        for name in self.funcs():
+            visit(name)
+        return total
+
+    def print_flat(self, out, min_percent):
+        tt = self.total_time or 1.0
+        print('Flat profile of TA {} ({} session(s), {} samples):'
+              .format(self.uuid, self.sessions, self.samples), file=out)
+        print('', file=out)
+        print('  %   cumulative   self              self     total',
+              file=out)
+        print(' time   seconds   seconds    calls  ms/call  ms/call  name',
+              file=out)
+        total = self.child_times()
+        cum = 0.0
+        rows = sorted(self.funcs(),
+                      key=lambda f: (-self.self_time.get(f, 0.0), f))
+        for name in rows:
+            t = self.self_time.get(name, 0.0)
+            pct = 100.0 * t / tt
+            if pct < min_percent:
+                continue
+            cum += t
+            ncalls = self.calls.get(name, 0)
+            if ncalls:
+                print('{:6.2f} {:9.4f} {:9.4f} {:8d} {:8.4f} {:8.4f}  {}'
+                      .format(pct, cum, t, ncalls, 1000.0 * t / ncalls,
+                              1000.0 * total[name] / ncalls, name),
+                      file=out)
+            else:
+                print('{:6.2f} {:9.4f} {:9.4f} {:8s} {:8s} {:8s}  {}'
+                      .format(pct, cum, t, '', '', '', name), file=out)
+        if self.unknown_time:
+            print('{:6.2f} {:9s} {:9.4f} {:8s} {:8s} {:8s}  <outside text>'
+                  .format(100.0 * self.unknown_time / tt, '',
+                          self.unknown_time, '', '', ''), file=out)
+        print('', file=out)
+
+    def print_graph(self, out):
+        tt = self.total_time or 1.0
+        total = self.child_times()
+        rows = sorted(self.funcs(), key=lambda f: (-total[f], f))
+        index = {name: n + 1 for n, name in enumerate(rows)}
+
+        def ref(name):
+            return '{} [{}]'.format(name, index[name])
+
+        print('Call graph of TA {}:'.format(self.uuid), file=out)
+        print('', file=out)
+        print('index % time    self  children    called     name', file=out)
+        for name in rows:
+            ncalls = self.calls.get(name, 0)
+            for caller, count in sorted(self.callers(name),
+                                        key=lambda c: -c[1]):
+                share = count / ncalls if ncalls else 0.0
+                st = self.self_time.get(name, 0.0) * share
+                print('{:6s} {:6s} {:7.4f} {:9.4f} {:7d}/{:<7d}     {}'
+                      .format('', '', st, (total[name] * share) - st, count,
+                              ncalls, ref(caller)), file=out)
+            st = self.self_time.get(name, 0.0)
+            recursive = self.arcs.get((name, name), 0)
+            called = '{}'.format(ncalls - recursive) if ncalls else ''
+            if recursive:
+                called += '+{}'.format(recursive)
+            print('{:6s} {:6.1f} {:7.4f} {:9.4f} {:>15s}     {}'
+                  .format('[{}]'.format(index[name]), 100.0 * total[name] / tt,
+                          st, total[name] - st, called, ref(name)), file=out)
+            for callee, count in sorted(self.callees(name),
+                                        key=lambda c: -c[1]):
+                ecalls = self.calls.get(callee, 0)
+                share = count / ecalls if ecalls else 0.0
+                st = self.self_time.get(callee, 0.0) * share
+                print('{:6s} {:6s} {:7.4f} {:9.4f} {:7d}/{:<7d}         {}'
+                      .format('', '', st, (total[callee] * share) - st, count,
+                              ecalls, ref(callee)), file=out)
+            print('-' * 48, file=out)
+        print('', file=out)
+
+    def folded_stacks(self, max_depth=64):
+        """
+        gprof only records caller/callee pairs, so complete stacks are
+        reconstructed by splitting the self samples of each function over its
+        callers in proportion to the arc counts, up to the roots (functions
+        without caller, typically the TA entry points).
+        """
+        stacks = {}
+        tt = self.total_time or 1.0
+        samples_per_sec = self.samples / tt
+
+        def walk(name, stack, weight):
+            if weight < 0.01:
+                return
+            callers = self.callers(name)
+            ncalls = sum(n for _, n in callers)
+            if not callers or len(stack) >= max_depth:
+                key = ';'.join(reversed(stack))
+                stacks[key] = stacks.get(key, 0.0) + weight
+                return
+            for caller, count in callers:
+                if caller in stack:
+                    key = ';'.join(reversed(stack))
+                    stacks[key] = stacks.get(key, 0.0) + \
+                        weight * count / ncalls
+                    continue
+                walk(caller, stack + [caller], weight * count / ncalls)
+
+        for name, t in self.self_time.items():
+            walk(name, [name], t * samples_per_sec)
+
+        return sorted((k, int(round(v))) for k, v in stacks.items()
+                      if round(v) > 0)
+
+
+def find_elf(dirs, uuid):
+    name = uuid + '.elf'
+    for d in dirs:
+        if d.endswith(name) and os.path.isfile(d):
+            return d
+        elf = glob.glob(os.path.join(d, name))
+        if elf:
+            return elf[0]
+    return None
+
+
+def file_uuid(path):
+    m = UUID_RE.search(os.path.basename(path))
+    if m:
+        return m.group('uuid')
+    return None
+
+
+def main():
+    args = get_args()
+
+    groups = {}
+    for pattern in args.gmon:
+        for path in sorted(glob.glob(pattern)) or [pattern]:
+            uuid = args.uuid or file_uuid(path)
+            if uuid is None:
+                print('*** Error: no TA UUID in file name {}, use --uuid'
+                      .format(path), file=sys.stderr)
+                sys.exit(1)
+            with open(path, 'rb') as f:
+                sess = GmonSession(path, f.read())
+            groups.setdefault(uuid, []).append(sess)
+
+    folded = []
+    for uuid in sorted(groups):
+        elf = find_elf(args.dir, uuid)
+        if elf is None:
+            print('*** Error: cannot find {}.elf'.format(uuid),
+                  file=sys.stderr)
+            sys.exit(1)
+        prof = Profile(uuid, ElfSymbols(elf))
+        for sess in groups[uuid]:
+            prof.add(sess)
+
+        if args.folded:
+            folded += prof.folded_stacks()
+            if args.folded == '-':
+                continue
+        if not args.graph:
+            prof.print_flat(sys.stdout, args.min_percent)
+        if not args.flat:
+            prof.print_graph(sys.stdout)
+
+    if args.folded:
+        out = sys.stdout
+        if args.folded != '-':
+            out = open(args.folded, 'w')
+        for stack, count in folded:
+            print('{} {}'.format(stack, count), file=out)
+        if out is not sys.stdout:
+            out.close()
+
+
+if __name__ == '__main__':
+    main()
@@ -6,6 +6,7 @@
 
 import sys
 import math
+import secrets
 
 
 sig_tee_alg = {'TEE_ALG_RSASSA_PKCS1_PSS_MGF1_SHA256': 0x70414930,
@@ -137,6 +138,15 @@ def get_args():
         parser.add_argument(
             '--subkey', action=OnlyOne, help='Name of subkey input file')
 
+    def arg_add_deterministic(parser):
+        parser.add_argument(
+            '--deterministic', action='store_true', help='''
+                Produce the same output for the same input: the encryption
+                nonce is derived from a keyed hash of the TA and its UUID
+                instead of being random, and so is the RSASSA-PSS salt.
+                Encrypting the same TA twice then reveals that it is
+                unchanged, nothing more.''')
+
     def arg_add_name(parser):
         parser.add_argument('--name',
                             help='Input name for subspace of a subkey')
@@ -177,6 +187,8 @@ def get_args():
         return str(parsed.uuid) + '.ta'
 
     def get_inf_default(parsed):
+        if parsed.uuid is None:
+            return None
         return str(parsed.uuid) + '.stripped.elf'
 
     def get_sigf_default(parsed):
@@ -211,6 +223,7 @@ def get_args():
     arg_add_name(parser_sign_enc)
     arg_add_enc_key(parser_sign_enc)
     arg_add_enc_key_type(parser_sign_enc)
+    arg_add_deterministic(parser_sign_enc)
     arg_add_algo(parser_sign_enc)
 
     parser_digest = subparsers.add_parser(
@@ -241,6 +254,7 @@ def get_args():
     arg_add_key(parser_digest)
     arg_add_enc_key(parser_digest)
     arg_add_enc_key_type(parser_digest)
+    arg_add_deterministic(parser_digest)
     arg_add_algo(parser_digest)
     arg_add_dig(parser_digest)
 
@@ -256,16 +270,36 @@ def get_args():
     arg_add_out(parser_stitch)
     arg_add_enc_key(parser_stitch)
     arg_add_enc_key_type(parser_stitch)
+    arg_add_deterministic(parser_stitch)
     arg_add_algo(parser_stitch)
     arg_add_sig(parser_stitch)
 
     parser_verify = subparsers.add_parser(
         'verify', prog=parser.prog + ' verify',
-        help='Verify signed TA binary')
+        formatter_class=argparse.RawDescriptionHelpFormatter,
+        help='Verify signed TA binary',
+        epilog=textwrap.dedent('''\
+            Several TAs can be verified at once by listing them after the
+            options, the expected UUID of each TA is then taken from its
+            <UUID>.ta file name. Subkeys shared by several TAs are only
+            verified once and the TAs are verified in parallel, one line
+            is printed per TA:
+              %(prog)s --key root.pem [--enc-key KEY] out/*.ta
+            '''))
     parser_verify.set_defaults(func=command_verify)
-    arg_add_uuid(parser_verify)
+    parser_verify.add_argument(
+        '--uuid', required=False, type=uuid_parse, help='''
+            String UUID of the TA, required with --in''')
     arg_add_in(parser_verify)
     arg_add_key(parser_verify)
+    arg_add_enc_key(parser_verify)
+    parser_verify.add_argument(
+        '--jobs', '-j', type=int_parse, default=0, help='''
+            Number of TAs verified in parallel.
+            Defaults to the number of CPUs.''')
+    parser_verify.add_argument(
+        'tas', nargs='*', metavar='TA',
+        help='Signed TA or subkey files named <UUID>.ta')
 
     parser_display = subparsers.add_parser(
         'display', prog=parser.prog + ' display',
@@ -294,6 +328,7 @@ def get_args():
     arg_add_subkey(parser_sign_subkey)
     arg_add_subkey_version(parser_sign_subkey)
     arg_add_algo(parser_sign_subkey)
+    arg_add_deterministic(parser_sign_subkey)
 
     argv = sys.argv[1:]
     if (len(argv) > 0 and argv[0][0] == '-' and
@@ -386,15 +421,31 @@ class BinaryImage:
         h.update(self.img)
         return h.finalize()
 
-    def encrypt_ta(self, enc_key, key_type, sig_algo, uuid, ta_version):
+    def encrypt_ta(self, enc_key, key_type, sig_algo, uuid, ta_version,
+                   deterministic=False):
+        from cryptography.hazmat.primitives import hashes, hmac
         from cryptography.hazmat.primitives.ciphers.aead import AESGCM
+        from cryptography.hazmat.primitives.kdf.hkdf import HKDF
         import struct
         import os
 
         self.img = self.inf
 
         cipher = AESGCM(bytes.fromhex(enc_key))
-        self.nonce = os.urandom(NONCE_SIZE)
+        if deterministic:
+            # Distinct TAs get distinct nonces, identical ones are
+            # encrypted identically. The nonce is keyed with a key of its
+            # own, not with the encryption key itself.
+            nonce_key = HKDF(algorithm=hashes.SHA256(), length=32, salt=None,
+                             info=b'OP-TEE TA nonce').derive(
+                                 bytes.fromhex(enc_key))
+            h = hmac.HMAC(nonce_key, hashes.SHA256())
+            h.update(uuid.bytes)
+            h.update(struct.pack('<I', ta_version))
+            h.update(self.img)
+            self.nonce = h.finalize()[:NONCE_SIZE]
+        else:
+            self.nonce = os.urandom(NONCE_SIZE)
         out = cipher.encrypt(self.nonce, self.img, None)
         self.ciphertext = out[:-TAG_SIZE]
         # Authentication Tag is always the last bytes
@@ -518,8 +569,9 @@ class BinaryImage:
 
                 if tag_len != 16:
                     raise Exception("Unexpected tag len: {}".format(tag_len))
-                self.tag = self.inf[-tag_len:]
-                self.ciphertext = self.inf[offs:-tag_len]
+                self.tag = self.inf[offs:offs + tag_len]
+                offs += tag_len
+                self.ciphertext = self.inf[offs:]
                 if len(self.ciphertext) != img_size:
                     raise Exception("Unexpected ciphertext size: ",
                                     "got {}, expected {}"
@@ -725,7 +777,8 @@ class BinaryImage:
         from cryptography.hazmat.primitives.ciphers.aead import AESGCM
 
         cipher = AESGCM(bytes.fromhex(enc_key))
-        self.img = cipher.decrypt(self.nonce, self.ciphertext, None)
+        self.img = cipher.decrypt(self.nonce, self.ciphertext + self.tag,
+                                  None)
 
     def __get_padding(self):
         from cryptography.hazmat.primitives.asymmetric import padding
@@ -738,7 +791,61 @@ class BinaryImage:
 
         return pad
 
-    def sign(self):
+    def __sign_pss_deterministic(self):
+        """ RSASSA-PSS signature (RFC 8017 section 8.1.1) of the digest
+        with a salt derived from the private key and the digest """
+        from cryptography.hazmat.primitives import hashes, hmac
+
+        def hash(*data):
+            h = hashes.Hash(self.chosen_hash)
+            for d in data:
+                h.update(d)
+            return h.finalize()
+
+        def mgf1(seed, length):
+            mask = b''
+            for i in range(math.ceil(length / self.hash_size)):
+                mask += hash(seed, i.to_bytes(4, 'big'))
+            return mask[:length]
+
+        try:
+            priv = self.key.private_numbers()
+        except AttributeError:
+            logger.error('--deterministic with ' + self.sig_algo +
+                         ' needs a local private key')
+            sys.exit(1)
+        n = priv.public_numbers.n
+        d = priv.d
+
+        h = hmac.HMAC(d.to_bytes(self.sig_size, 'big'), self.chosen_hash)
+        h.update(b'OP-TEE PSS salt')
+        h.update(self.img_digest)
+        salt = h.finalize()[:self.hash_size]
+
+        em_bits = n.bit_length() - 1
+        em_len = math.ceil(em_bits / 8)
+        m_hash = hash(bytes(8), self.img_digest, salt)
+        db = bytes(em_len - 2 * self.hash_size - 2) + b'\x01' + salt
+        masked_db = bytearray(a ^ b for a, b in
+                              zip(db, mgf1(m_hash, len(db))))
+        masked_db[0] &= 0xff >> (8 * em_len - em_bits)
+        em = bytes(masked_db) + m_hash + b'\xbc'
+
+        # Blind the private key operation so that its timing does not
+        # depend on the message, then check the result before using it
+        m = int.from_bytes(em, 'big')
+        e = priv.public_numbers.e
+        while True:
+            r = secrets.randbelow(n - 2) + 2
+            if math.gcd(r, n) == 1:
+                break
+        s = pow(m * pow(r, e, n) % n, d, n) * pow(r, -1, n) % n
+        if pow(s, e, n) != m:
+            logger.error('RSASSA-PSS signature does not verify')
+            sys.exit(1)
+        return s.to_bytes(self.sig_size, 'big')
+
+    def sign(self, deterministic=False):
         from cryptography.hazmat.primitives.asymmetric import utils
         from cryptography.hazmat.primitives.asymmetric import rsa
 
@@ -746,6 +853,11 @@ class BinaryImage:
             logger.error('Provided key cannot be used for signing, ' +
                          'please use offline-signing mode.')
             sys.exit(1)
+        elif (deterministic and
+              self.sig_algo == 'TEE_ALG_RSASSA_PKCS1_PSS_MGF1_SHA256'):
+            self.sig = self.__sign_pss_deterministic()
+            # A faulty signature must never leave this script
+            self.check_signature()
         else:
             self.sig = self.key.sign(self.img_digest, self.__get_padding(),
                                      utils.Prehashed(self.chosen_hash))
@@ -766,19 +878,23 @@ class BinaryImage:
                              "the expected one: {} != {}").
                             format(len(self.sig), self.sig_size))
 
-    def verify_signature(self):
+    def check_signature(self):
         from cryptography.hazmat.primitives.asymmetric import utils
         from cryptography.hazmat.primitives.asymmetric import rsa
-        from cryptography import exceptions
 
         if isinstance(self.key, rsa.RSAPrivateKey):
             pkey = self.key.public_key()
         else:
             pkey = self.key
 
+        pkey.verify(self.sig, self.img_digest, self.__get_padding(),
+                    utils.Prehashed(self.chosen_hash))
+
+    def verify_signature(self):
+        from cryptography import exceptions
+
         try:
-            pkey.verify(self.sig, self.img_digest, self.__get_padding(),
-                        utils.Prehashed(self.chosen_hash))
+            self.check_signature()
         except exceptions.InvalidSignature:
             logger.error('Verification failed, ignoring given signature.')
             sys.exit(1)
@@ -832,7 +948,8 @@ def load_ta_image(args):
 
     if args.enc_key:
         ta_image.encrypt_ta(args.enc_key, args.enc_key_type,
-                            args.algo, args.uuid, args.ta_version)
+                            args.algo, args.uuid, args.ta_version,
+                            args.deterministic)
     else:
         ta_image.set_bootstrap_ta(args.algo, args.uuid, args.ta_version)
 
@@ -843,7 +960,7 @@ def command_sign_enc(args):
     ta_image = load_ta_image(args)
     if args.subkey:
         ta_image.add_subkey(args.subkey, args.name)
-    ta_image.sign()
+    ta_image.sign(args.deterministic)
     ta_image.write(args.outf)
     logger.info('Successfully signed application.')
 
@@ -854,7 +971,7 @@ def command_sign_subkey(args):
         image.add_subkey(args.subkey, args.name)
     image.set_subkey(args.algo, args.name, args.uuid, args.subkey_version,
                      args.max_depth, args.name_size)
-    image.sign()
+    image.sign(args.deterministic)
     image.write(args.outf)
     logger.info('Successfully signed subkey.')
 
@@ -875,54 +992,231 @@ def command_stitch(args):
     logger.info('Successfully applied signature.')
 
 
-def command_verify(args):
+class SubkeyCache:
+    """ Subkeys already verified, shared by all the TAs of a verify command
+
+    A subkey is identified by the digest of its image and of everything its
+    verification depends on: the key it is signed with, the UUID and the max
+    depth imposed by the previous subkey. Verifying a release signed under a
+    few subkey chains then costs one RSA verification per distinct subkey.
+    """
+
+    def __init__(self):
+        self.verified = {}
+
+    @staticmethod
+    def __key_id(key):
+        from cryptography.hazmat.primitives.asymmetric import rsa
+        from cryptography.hazmat.primitives import serialization
+
+        if isinstance(key, rsa.RSAPrivateKey):
+            key = key.public_key()
+        return key.public_bytes(serialization.Encoding.DER,
+                                serialization.PublicFormat.PKCS1)
+
+    def verify(self, link, key, next_uuid, max_depth):
+        """ Verifies the subkey at the start of link, returns its image and
+        True if it was found in the cache """
+        from cryptography.hazmat.primitives import hashes
+        import uuid
+
+        h = hashes.Hash(hashes.SHA256())
+        h.update(self.__key_id(key))
+        h.update(str((next_uuid, max_depth)).encode())
+        h.update(link)
+        digest = h.finalize()
+
+        if digest in self.verified:
+            return self.verified[digest], True
+
+        image = BinaryImage(link, key)
+        image.parse()
+        image.check_signature()
+        image.verify_digest()
+        if next_uuid and uuid.UUID(bytes=image.uuid) != next_uuid:
+            raise Exception('UUID {} does not match {}'
+                            .format(uuid.UUID(bytes=image.uuid), next_uuid))
+        if max_depth >= 0:
+            if image.max_depth < 0 or image.max_depth >= max_depth:
+                raise Exception('Invalid max_depth {} not less than {}'
+                                .format(image.max_depth, max_depth))
+
+        # Only what the next link needs is kept
+        del image.inf, image.next_inf, image.img
+        self.verified[digest] = image
+        return image, False
+
+
+def verify_subkey_chain(inf, key, cache):
+    """ Walks the subkeys in front of a TA or ending a subkey file
+
+    Returns the remaining TA image (empty for a subkey file), the key and
+    UUID the TA must match and a list of (subkey UUID, cached) tuples.
+    """
     import uuid
 
-    image = BinaryImage(args.inf, args.key)
     next_uuid = None
     max_depth = -1
-    while True:
+    chain = []
+    while len(inf) > 0:
+        image = BinaryImage(inf, None)
         image.parse()
-        if hasattr(image, 'subkey_hdr'):  # Subkey
-            print('Subkey UUID: {}'.format(uuid.UUID(bytes=image.uuid)))
-            image.verify_signature()
-            image.verify_digest()
-            if next_uuid:
-                if uuid.UUID(bytes=image.uuid) != next_uuid:
-                    raise Exception('UUID {} does not match {}'
-                                    .format(uuid.UUID(bytes=image.uuid),
-                                            next_uuid))
-            if max_depth >= 0:
-                if image.max_depth < 0 or image.max_depth >= max_depth:
-                    raise Exception('Invalid max_depth {} not less than {}'
-                                    .format(image.max_depth, max_depth))
-            max_depth = image.max_depth
-            if len(image.next_inf) == 0:
-                logger.info('Subkey is correctly verified.')
-                return
-            if image.name_size > 0:
-                next_uuid = uuid_v5_sha512(image.uuid,
-                                           name_img_to_str(image.name_img))
-            else:
-                next_uuid = image.uuid
-            image = BinaryImage(image.next_inf, image.subkey_key)
-        else:  # TA
-            print('TA UUID: {}'.format(uuid.UUID(bytes=image.ta_uuid)))
-            if next_uuid:
-                if uuid.UUID(bytes=image.ta_uuid) != next_uuid:
-                    raise Exception('UUID {} does not match {}'
-                                    .format(uuid.UUID(bytes=image.ta_uuid),
-                                            next_uuid))
-            if hasattr(image, 'ciphertext'):
-                if args.enc_key is None:
-                    logger.error('--enc_key needed to decrypt TA')
-                    sys.exit(1)
-                image.decrypt_ta(args.enc_key)
-            image.verify_signature()
-            image.verify_digest()
-            image.verify_uuid(args.uuid)
-            logger.info('Trusted application is correctly verified.')
-            return
+        if not hasattr(image, 'subkey_hdr'):
+            break
+        # The name following a subkey isn't covered by its signature, it
+        # belongs to the next link
+        link = inf[:len(inf) - len(image.next_inf) - len(image.name_img)]
+        sk, cached = cache.verify(link, key, next_uuid, max_depth)
+        chain.append((uuid.UUID(bytes=sk.uuid), cached))
+
+        max_depth = sk.max_depth
+        if sk.name_size > 0:
+            next_uuid = uuid_v5_sha512(sk.uuid,
+                                       name_img_to_str(image.name_img))
+        else:
+            next_uuid = uuid.UUID(bytes=sk.uuid)
+        key = sk.subkey_key
+        inf = image.next_inf
+
+    return inf, key, next_uuid, chain
+
+
+def verify_ta(inf, key, next_uuid, expected_uuid, enc_key):
+    """ Verifies a TA image once its subkey chain, if any, is verified """
+    import uuid
+
+    # Checked first, there is no point in decrypting and verifying a TA
+    # that can't be matched against anything
+    if expected_uuid is None:
+        raise Exception('No expected UUID, use --uuid or a <UUID>.ta name')
+
+    if isinstance(key, tuple):
+        from cryptography.hazmat.primitives.asymmetric import rsa
+
+        key = rsa.RSAPublicNumbers(*key).public_key()
+
+    image = BinaryImage(inf, key)
+    image.parse()
+    ta_uuid = uuid.UUID(bytes=image.ta_uuid)
+    if next_uuid and ta_uuid != next_uuid:
+        raise Exception('UUID {} does not match {}'
+                        .format(ta_uuid, next_uuid))
+    if hasattr(image, 'ciphertext'):
+        if enc_key is None:
+            raise Exception('--enc-key needed to decrypt TA')
+        image.decrypt_ta(enc_key)
+    image.check_signature()
+    image.verify_digest()
+    image.verify_uuid(expected_uuid)
+    return ta_uuid
+
+
+def verify_ta_job(inf, key, next_uuid, expected_uuid, enc_key):
+    """ Runs verify_ta() in a worker, returns (ta_uuid, error, seconds) """
+    from cryptography import exceptions
+    import time
+
+    t = time.monotonic()
+    try:
+        ta_uuid = verify_ta(inf, key, next_uuid, expected_uuid, enc_key)
+        err = None
+    except exceptions.InvalidSignature:
+        ta_uuid, err = None, 'signature verification failed'
+    except Exception as e:
+        ta_uuid, err = None, str(e) or type(e).__name__
+    return ta_uuid, err, time.monotonic() - t
+
+
+def command_verify(args):
+    from concurrent.futures import ProcessPoolExecutor
+    from cryptography import exceptions
+    from cryptography.hazmat.primitives.asymmetric import rsa
+    import os
+    import re
+    import time
+    import uuid
+
+    if args.tas:
+        if args.uuid and len(args.tas) > 1:
+            logger.error('--uuid cannot be used with several TAs')
+            sys.exit(1)
+        inputs = args.tas
+    elif args.inf:
+        inputs = [args.inf]
+    else:
+        logger.error('--uuid and --in, or a list of TAs, are needed')
+        sys.exit(1)
+
+    key = load_asymmetric_key(args.key)
+    cache = SubkeyCache()
+    report = {}
+    jobs = []
+
+    for path in inputs:
+        t = time.monotonic()
+        expected_uuid = args.uuid
+        if expected_uuid is None:
+            m = re.match(r'([0-9a-fA-F-]{36})\.ta$', os.path.basename(path))
+            if m:
+                expected_uuid = uuid.UUID(m.group(1))
+        try:
+            with open(path, 'rb') as f:
+                inf = f.read()
+            inf, ta_key, next_uuid, chain = verify_subkey_chain(inf, key,
+                                                                cache)
+        except exceptions.InvalidSignature:
+            report[path] = (None, [], 'subkey signature verification failed',
+                            time.monotonic() - t)
+            continue
+        except Exception as e:
+            report[path] = (None, [], str(e) or type(e).__name__,
+                            time.monotonic() - t)
+            continue
+
+        if len(inf) == 0:
+            report[path] = ('subkey', chain, None, time.monotonic() - t)
+            continue
+
+        # Keys can't be pickled, they are passed by their public numbers
+        if isinstance(ta_key, rsa.RSAPrivateKey):
+            ta_key = ta_key.public_key()
+        n = ta_key.public_numbers()
+        jobs.append((path, chain, time.monotonic() - t,
+                     (inf, (n.e, n.n), next_uuid, expected_uuid,
+                      args.enc_key)))
+
+    nproc = min(args.jobs or os.cpu_count() or 1, len(jobs))
+    if nproc > 1:
+        with ProcessPoolExecutor(max_workers=nproc) as ex:
+            futures = [ex.submit(verify_ta_job, *j[3]) for j in jobs]
+            results = [f.result() for f in futures]
+    else:
+        results = [verify_ta_job(*j[3]) for j in jobs]
+    for (path, chain, t, job), (ta_uuid, err, dt) in zip(jobs, results):
+        report[path] = (ta_uuid, chain, err, t + dt)
+
+    failed = 0
+    for path in inputs:
+        what, chain, err, t = report[path]
+        if err:
+            failed += 1
+        subkeys = ', '.join('{}{}'.format(u, ' (cached)' if c else '')
+                            for u, c in chain)
+        if isinstance(what, uuid.UUID):
+            what = ' TA {}'.format(what)
+        else:
+            what = ' subkey file' if what else ''
+        print('{:4} {} ({:.1f} ms){}{}{}'.format(
+              'FAIL' if err else 'OK', path, t * 1000, what,
+              ', subkeys ' + subkeys if subkeys else '',
+              ': ' + err if err else ''))
+
+    if len(inputs) > 1:
+        print('{} verified, {} failed, {} distinct subkeys'
+              .format(len(inputs) - failed, failed, len(cache.verified)))
+    if failed:
+        sys.exit(1)
+    logger.info('Trusted application is correctly verified.')
 
 
 def command_display(args):
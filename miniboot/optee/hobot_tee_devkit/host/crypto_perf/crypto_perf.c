@@ -0,0 +1,499 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2026, D-Robotics
+ */
+
+/*
+ * Host side of the crypto_perf TA: runs the known answer tests and the
+ * self tests of ta/lib/mbedtls_ext, then reports the throughput of each
+ * algorithm and key size, the signature verification rate of each
+ * implementation and the rate of the RSA and modular arithmetic of each
+ * bignum implementation.
+ */
+
+#include <err.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tee_api_defines.h>
+#include <tee_client_api.h>
+#include <ta_crypto_perf.h>
+#include <unistd.h>
+
+#define DEFAULT_SIZE	(64 * 1024)
+#define DEFAULT_ITERS	200
+/* Signatures and rounds over them per verification measurement */
+#define VERIFY_SIGS	32
+#define VERIFY_ITERS	4
+
+struct bench_alg {
+	const char *name;
+	uint32_t algo;
+	uint32_t key_bits[3];
+};
+
+static const struct bench_alg bench_algs[] = {
+	{ "aes-cbc", TEE_ALG_AES_CBC_NOPAD, { 128, 192, 256 } },
+	{ "aes-ctr", TEE_ALG_AES_CTR, { 128, 192, 256 } },
+	{ "aes-xts", TEE_ALG_AES_XTS, { 128, 256 } },
+	{ "aes-gcm", TEE_ALG_AES_GCM, { 128, 256 } },
+	{ "aes-ce-ecb", TA_CRYPTO_PERF_ALG_AES_CE_ECB, { 128, 256 } },
+	{ "aes-ce-cbc", TA_CRYPTO_PERF_ALG_AES_CE_CBC, { 128, 256 } },
+	{ "aes-ce-ctr", TA_CRYPTO_PERF_ALG_AES_CE_CTR, { 128, 256 } },
+	{ "aes-ce-xts", TA_CRYPTO_PERF_ALG_AES_CE_XTS, { 128, 256 } },
+	{ "aes-ce-gcm", TA_CRYPTO_PERF_ALG_AES_CE_GCM, { 128, 256 } },
+	{ "sm4-cbc", TEE_ALG_SM4_CBC_NOPAD, { 128 } },
+	{ "sm4-ctr", TEE_ALG_SM4_CTR, { 128 } },
+	{ "sm4-xts", TEE_ALG_SM4_XTS, { 128 } },
+	{ "sm4-sw-ecb", TA_CRYPTO_PERF_ALG_SM4_SW_ECB, { 128 } },
+	{ "sm4-sw-cbc", TA_CRYPTO_PERF_ALG_SM4_SW_CBC, { 128 } },
+	{ "sm4-sw-ctr", TA_CRYPTO_PERF_ALG_SM4_SW_CTR, { 128 } },
+	{ "sm4-sw-xts", TA_CRYPTO_PERF_ALG_SM4_SW_XTS, { 128 } },
+	{ "sha1", TEE_ALG_SHA1, { 0 } },
+	{ "sha256", TEE_ALG_SHA256, { 0 } },
+	{ "sha512", TEE_ALG_SHA512, { 0 } },
+	{ "sha256-ce", TA_CRYPTO_PERF_ALG_SHA256_CE, { 0 } },
+	{ "sha512-ce", TA_CRYPTO_PERF_ALG_SHA512_CE, { 0 } },
+	{ "sm3", TEE_ALG_SM3, { 0 } },
+	{ "sm3-mbedtls", TA_CRYPTO_PERF_ALG_SM3_MBEDTLS, { 0 } },
+	{ "sm3-mb", TA_CRYPTO_PERF_ALG_SM3_MB, { 0 } },
+	{ "sm3-mb-x4", TA_CRYPTO_PERF_ALG_SM3_MB_X4, { 0 } },
+	{ "sm3-mb-x8", TA_CRYPTO_PERF_ALG_SM3_MB_X8, { 0 } },
+	{ "hmac-sha256", TEE_ALG_HMAC_SHA256, { 256 } },
+	{ "hmac-sm3", TEE_ALG_HMAC_SM3, { 256 } },
+	{ "chacha20-poly1305", TA_CRYPTO_PERF_ALG_CHACHA20_POLY1305, { 256 } },
+	{ "chacha20-poly1305-neon", TA_CRYPTO_PERF_ALG_CHACHA20_POLY1305_NEON,
+	  { 256 } },
+	{ "zuc-eea3", TA_CRYPTO_PERF_ALG_ZUC_EEA3, { 128 } },
+	{ "zuc-eea3-x4", TA_CRYPTO_PERF_ALG_ZUC_EEA3_X4, { 128 } },
+	{ "zuc-eea3-x8", TA_CRYPTO_PERF_ALG_ZUC_EEA3_X8, { 128 } },
+	{ "zuc-eia3", TA_CRYPTO_PERF_ALG_ZUC_EIA3, { 128 } },
+	{ "snow3g-uea2", TA_CRYPTO_PERF_ALG_SNOW3G_UEA2, { 128 } },
+	{ "snow3g-uea2-x4", TA_CRYPTO_PERF_ALG_SNOW3G_UEA2_X4, { 128 } },
+	{ "snow3g-uea2-x8", TA_CRYPTO_PERF_ALG_SNOW3G_UEA2_X8, { 128 } },
+	{ "snow3g-uia2", TA_CRYPTO_PERF_ALG_SNOW3G_UIA2, { 128 } },
+};
+
+struct verify_alg {
+	const char *name;
+	uint32_t curve;
+};
+
+static const struct verify_alg verify_algs[] = {
+	{ "ecdsa-p256", TEE_ECC_CURVE_NIST_P256 },
+	{ "sm2dsa", TEE_ECC_CURVE_SM2 },
+};
+
+static const char *const verify_impls[] = {
+	[TA_CRYPTO_PERF_VERIFY_MBEDTLS] = "mbedtls",
+	[TA_CRYPTO_PERF_VERIFY_ECP256] = "ecp256",
+	[TA_CRYPTO_PERF_VERIFY_ECP256_BATCH] = "ecp256-batch",
+};
+
+struct bignum_alg {
+	const char *name;
+	uint32_t op;
+	uint32_t iters;
+	uint32_t bits[2];
+};
+
+static const struct bignum_alg bignum_algs[] = {
+	{ "rsa-verify", TA_CRYPTO_PERF_BIGNUM_RSA_VERIFY, 64, { 2048, 4096 } },
+	{ "mulmod", TA_CRYPTO_PERF_BIGNUM_MULMOD, 2000, { 2048, 4096 } },
+};
+
+static const char *const bignum_impls[] = {
+	[TA_CRYPTO_PERF_BIGNUM_IMPL_TEE] = "tee",
+	[TA_CRYPTO_PERF_BIGNUM_IMPL_MBEDTLS] = "mbedtls",
+	[TA_CRYPTO_PERF_BIGNUM_IMPL_MONT] = "bn-mont",
+};
+
+static void usage(const char *progname)
+{
+	fprintf(stderr, "Usage: %s [-h] [-v FILE] [-s SIZE] [-n ITERS] "
+		"[-f MHZ] [-a ALG] [-k]\n", progname);
+	fprintf(stderr, "  -v FILE  Vector table from cavp_to_bin.py "
+		"[built-in vectors]\n");
+	fprintf(stderr, "  -s SIZE  Bytes processed per iteration [%d]\n",
+		DEFAULT_SIZE);
+	fprintf(stderr, "  -n ITERS Iterations per measurement [%d]\n",
+		DEFAULT_ITERS);
+	fprintf(stderr, "  -f MHZ   CPU clock used to convert time to cycles "
+		"[cpufreq maximum]\n");
+	fprintf(stderr, "  -a ALG   Only benchmark ALG (may be repeated)\n");
+	fprintf(stderr, "  -k       Only run the known answer and self tests\n");
+}
+
+static void *read_file(const char *name, size_t *size)
+{
+	FILE *f = fopen(name, "rb");
+	void *buf = NULL;
+	long len = 0;
+
+	if (!f)
+		err(1, "%s", name);
+	if (fseek(f, 0, SEEK_END) || (len = ftell(f)) < 0 ||
+	    fseek(f, 0, SEEK_SET))
+		err(1, "%s", name);
+	buf = malloc(len ? len : 1);
+	if (!buf)
+		err(1, "malloc");
+	if (fread(buf, 1, len, f) != (size_t)len)
+		errx(1, "%s: short read", name);
+	fclose(f);
+	*size = len;
+	return buf;
+}
+
+/* Returns the maximum CPU clock in MHz as reported by cpufreq, or 0 */
+static double cpufreq_mhz(void)
+{
+	FILE *f = fopen("/sys/devices/system/cpu/cpu0/cpufreq/cpuinfo_max_freq",
+			"r");
+	unsigned long khz = 0;
+
+	if (!f)
+		return 0;
+	if (fscanf(f, "%lu", &khz) != 1)
+		khz = 0;
+	fclose(f);
+	return khz / 1000.0;
+}
+
+static int run_kat(TEEC_Session *sess, const char *vec_file)
+{
+	TEEC_Operation op = { };
+	uint32_t ret_orig = 0;
+	TEEC_Result res = TEEC_SUCCESS;
+	size_t size = 0;
+	void *buf = NULL;
+
+	if (vec_file)
+		buf = read_file(vec_file, &size);
+
+	op.paramTypes = TEEC_PARAM_TYPES(TEEC_MEMREF_TEMP_INPUT,
+					 TEEC_VALUE_OUTPUT, TEEC_VALUE_OUTPUT,
+					 TEEC_VALUE_OUTPUT);
+	op.params[0].tmpref.buffer = buf;
+	op.params[0].tmpref.size = size;
+
+	res = TEEC_InvokeCommand(sess, TA_CRYPTO_PERF_CMD_KAT, &op, &ret_orig);
+	free(buf);
+	if (res != TEEC_SUCCESS)
+		errx(1, "KAT: TEEC_InvokeCommand: %#" PRIx32 " origin %#" PRIx32,
+		     res, ret_orig);
+
+	printf("KAT %s: %" PRIu32 " passed, %" PRIu32 " failed, %" PRIu32
+	       " skipped\n", vec_file ? vec_file : "built-in",
+	       op.params[1].value.a, op.params[1].value.b,
+	       op.params[2].value.a);
+	if (op.params[1].value.b) {
+		printf("First failure at line %" PRIu32 " of its .rsp file\n",
+		       op.params[2].value.b);
+		return -1;
+	}
+	/* The TA implements these itself, a skip means a broken vector */
+	if (op.params[3].value.a) {
+		printf("%" PRIu32 " of the skipped vectors are for algorithms "
+		       "of the TA\n", op.params[3].value.a);
+		return -1;
+	}
+
+	return 0;
+}
+
+static int run_self_test(TEEC_Session *sess)
+{
+	TEEC_Operation op = { };
+	uint32_t ret_orig = 0;
+	TEEC_Result res = TEEC_SUCCESS;
+	char report[1024] = { };
+
+	op.paramTypes = TEEC_PARAM_TYPES(TEEC_MEMREF_TEMP_OUTPUT,
+					 TEEC_VALUE_OUTPUT, TEEC_NONE,
+					 TEEC_NONE);
+	op.params[0].tmpref.buffer = report;
+	op.params[0].tmpref.size = sizeof(report);
+
+	res = TEEC_InvokeCommand(sess, TA_CRYPTO_PERF_CMD_SELF_TEST, &op,
+				 &ret_orig);
+	if (res != TEEC_SUCCESS)
+		errx(1, "Self test: TEEC_InvokeCommand: %#" PRIx32
+		     " origin %#" PRIx32, res, ret_orig);
+
+	printf("%sSelf tests: %" PRIu32 " passed, %" PRIu32 " failed\n",
+	       report, op.params[1].value.a, op.params[1].value.b);
+
+	return op.params[1].value.b ? -1 : 0;
+}
+
+static void run_bench(TEEC_Session *sess, const struct bench_alg *alg,
+		      uint32_t key_bits, uint32_t size, uint32_t iters,
+		      double mhz)
+{
+	TEEC_Operation op = { };
+	uint32_t ret_orig = 0;
+	TEEC_Result res = TEEC_SUCCESS;
+	uint64_t ticks = 0;
+	double secs = 0;
+	double bytes = (double)size * iters;
+
+	op.paramTypes = TEEC_PARAM_TYPES(TEEC_VALUE_INPUT, TEEC_VALUE_INPUT,
+					 TEEC_VALUE_OUTPUT, TEEC_VALUE_OUTPUT);
+	op.params[0].value.a = alg->algo;
+	op.params[0].value.b = key_bits;
+	op.params[1].value.a = size;
+	op.params[1].value.b = iters;
+
+	res = TEEC_InvokeCommand(sess, TA_CRYPTO_PERF_CMD_BENCH, &op,
+				 &ret_orig);
+	if (res == TEEC_ERROR_NOT_SUPPORTED) {
+		printf("%-22s %4" PRIu32 "  not supported\n", alg->name,
+		       key_bits);
+		return;
+	}
+	if (res != TEEC_SUCCESS)
+		errx(1, "%s: TEEC_InvokeCommand: %#" PRIx32 " origin %#" PRIx32,
+		     alg->name, res, ret_orig);
+
+	ticks = (uint64_t)op.params[2].value.a << 32 | op.params[2].value.b;
+	secs = (double)ticks / op.params[3].value.a;
+
+	printf("%-22s %4" PRIu32 "  %9.2f MiB/s", alg->name, key_bits,
+	       bytes / secs / (1024 * 1024));
+	if (mhz > 0)
+		printf("  %7.2f cycles/byte", secs * mhz * 1e6 / bytes);
+	printf("\n");
+}
+
+/* Returns the verifications per second, 0 if not supported */
+static double run_bench_verify(TEEC_Session *sess,
+			       const struct verify_alg *alg, uint32_t impl)
+{
+	TEEC_Operation op = { };
+	uint32_t ret_orig = 0;
+	TEEC_Result res = TEEC_SUCCESS;
+	uint64_t ticks = 0;
+	double rate = 0;
+
+	op.paramTypes = TEEC_PARAM_TYPES(TEEC_VALUE_INPUT, TEEC_VALUE_INPUT,
+					 TEEC_VALUE_OUTPUT, TEEC_VALUE_OUTPUT);
+	op.params[0].value.a = alg->curve;
+	op.params[0].value.b = impl;
+	op.params[1].value.a = VERIFY_SIGS;
+	op.params[1].value.b = VERIFY_ITERS;
+
+	res = TEEC_InvokeCommand(sess, TA_CRYPTO_PERF_CMD_BENCH_VERIFY, &op,
+				 &ret_orig);
+	if (res == TEEC_ERROR_NOT_SUPPORTED) {
+		printf("%-18s %-13s not supported\n", alg->name,
+		       verify_impls[impl]);
+		return 0;
+	}
+	if (res != TEEC_SUCCESS)
+		errx(1, "%s %s: TEEC_InvokeCommand: %#" PRIx32
+		     " origin %#" PRIx32, alg->name, verify_impls[impl], res,
+		     ret_orig);
+
+	ticks = (uint64_t)op.params[2].value.a << 32 | op.params[2].value.b;
+	rate = (double)VERIFY_SIGS * VERIFY_ITERS * op.params[3].value.a /
+	       ticks;
+
+	printf("%-18s %-13s %9.1f verify/s", alg->name, verify_impls[impl],
+	       rate);
+	return rate;
+}
+
+/* Returns the operations per second, 0 if not supported */
+static double run_bench_bignum(TEEC_Session *sess,
+			       const struct bignum_alg *alg, uint32_t bits,
+			       uint32_t impl)
+{
+	TEEC_Operation op = { };
+	uint32_t ret_orig = 0;
+	TEEC_Result res = TEEC_SUCCESS;
+	uint64_t ticks = 0;
+	double rate = 0;
+
+	op.paramTypes = TEEC_PARAM_TYPES(TEEC_VALUE_INPUT, TEEC_VALUE_INPUT,
+					 TEEC_VALUE_OUTPUT, TEEC_VALUE_OUTPUT);
+	op.params[0].value.a = alg->op;
+	op.params[0].value.b = impl;
+	op.params[1].value.a = bits;
+	op.params[1].value.b = alg->iters;
+
+	res = TEEC_InvokeCommand(sess, TA_CRYPTO_PERF_CMD_BENCH_BIGNUM, &op,
+				 &ret_orig);
+	if (res == TEEC_ERROR_NOT_SUPPORTED) {
+		printf("%-18s %4" PRIu32 "  %-13s not supported\n", alg->name,
+		       bits, bignum_impls[impl]);
+		return 0;
+	}
+	if (res != TEEC_SUCCESS)
+		errx(1, "%s %" PRIu32 " %s: TEEC_InvokeCommand: %#" PRIx32
+		     " origin %#" PRIx32, alg->name, bits, bignum_impls[impl],
+		     res, ret_orig);
+
+	ticks = (uint64_t)op.params[2].value.a << 32 | op.params[2].value.b;
+	rate = (double)alg->iters * op.params[3].value.a / ticks;
+
+	printf("%-18s %4" PRIu32 "  %-13s %9.1f op/s", alg->name, bits,
+	       bignum_impls[impl], rate);
+	return rate;
+}
+
+static bool selected(const char *const *only, size_t nonly, const char *name)
+{
+	size_t n = 0;
+
+	for (n = 0; n < nonly; n++)
+		if (!strcmp(only[n], name))
+			return true;
+	return !nonly;
+}
+
+int main(int argc, char *argv[])
+{
+	TEEC_UUID uuid = TA_CRYPTO_PERF_UUID;
+	TEEC_Context ctx = { };
+	TEEC_Session sess = { };
+	uint32_t ret_orig = 0;
+	TEEC_Result res = TEEC_SUCCESS;
+	const char *vec_file = NULL;
+	const char *only[16] = { };
+	size_t nonly = 0;
+	uint32_t size = DEFAULT_SIZE;
+	uint32_t iters = DEFAULT_ITERS;
+	double mhz = 0;
+	int kat_only = 0;
+	int rc = 0;
+	size_t n = 0;
+	size_t m = 0;
+	int opt = 0;
+
+	while ((opt = getopt(argc, argv, "hv:s:n:f:a:k")) != -1) {
+		switch (opt) {
+		case 'v':
+			vec_file = optarg;
+			break;
+		case 's':
+			size = strtoul(optarg, NULL, 0);
+			break;
+		case 'n':
+			iters = strtoul(optarg, NULL, 0);
+			break;
+		case 'f':
+			mhz = strtod(optarg, NULL);
+			break;
+		case 'a':
+			if (nonly == sizeof(only) / sizeof(only[0]))
+				errx(1, "Too many -a options");
+			only[nonly++] = optarg;
+			break;
+		case 'k':
+			kat_only = 1;
+			break;
+		case 'h':
+		default:
+			usage(argv[0]);
+			return opt == 'h' ? 0 : 1;
+		}
+	}
+
+	if (!mhz)
+		mhz = cpufreq_mhz();
+
+	res = TEEC_InitializeContext(NULL, &ctx);
+	if (res != TEEC_SUCCESS)
+		errx(1, "TEEC_InitializeContext: %#" PRIx32, res);
+
+	res = TEEC_OpenSession(&ctx, &sess, &uuid, TEEC_LOGIN_PUBLIC, NULL,
+			       NULL, &ret_orig);
+	if (res != TEEC_SUCCESS)
+		errx(1, "TEEC_OpenSession: %#" PRIx32 " origin %#" PRIx32,
+		     res, ret_orig);
+
+	/* No point in timing an implementation that gives wrong results */
+	rc = run_kat(&sess, vec_file);
+	if (!rc)
+		rc = run_self_test(&sess);
+	if (rc || kat_only)
+		goto out;
+
+	printf("\n%-22s %4s  %15s", "algorithm", "key", "throughput");
+	if (mhz > 0)
+		printf("  cycles/byte @ %.0f MHz", mhz);
+	printf("\n");
+
+	for (n = 0; n < sizeof(bench_algs) / sizeof(bench_algs[0]); n++) {
+		const struct bench_alg *alg = bench_algs + n;
+
+		if (!selected(only, nonly, alg->name))
+			continue;
+
+		for (m = 0; m < sizeof(alg->key_bits) /
+				sizeof(alg->key_bits[0]); m++) {
+			if (m && !alg->key_bits[m])
+				break;
+			run_bench(&sess, alg, alg->key_bits[m], size, iters,
+				  mhz);
+		}
+	}
+
+	printf("\n%-18s %-13s %14s\n", "signature", "implementation",
+	       "rate");
+	for (n = 0; n < sizeof(verify_algs) / sizeof(verify_algs[0]); n++) {
+		const struct verify_alg *alg = verify_algs + n;
+		double base = 0;
+		double rate = 0;
+
+		if (!selected(only, nonly, alg->name))
+			continue;
+
+		for (m = 0; m < sizeof(verify_impls) / sizeof(verify_impls[0]);
+		     m++) {
+			rate = run_bench_verify(&sess, alg, m);
+			if (!rate)
+				continue;
+			if (m == TA_CRYPTO_PERF_VERIFY_MBEDTLS)
+				base = rate;
+			else if (base > 0)
+				printf("  x%.2f", rate / base);
+			printf("\n");
+		}
+	}
+
+	printf("\n%-18s %4s  %-13s %14s\n", "operation", "bits",
+	       "implementation", "rate");
+	for (n = 0; n < sizeof(bignum_algs) / sizeof(bignum_algs[0]); n++) {
+		const struct bignum_alg *alg = bignum_algs + n;
+		size_t k = 0;
+		double base = 0;
+		double rate = 0;
+
+		if (!selected(only, nonly, alg->name))
+			continue;
+
+		for (k = 0; k < sizeof(alg->bits) / sizeof(alg->bits[0]); k++) {
+			base = 0;
+			for (m = 0; m < sizeof(bignum_impls) /
+					sizeof(bignum_impls[0]); m++) {
+				rate = run_bench_bignum(&sess, alg, alg->bits[k],
+							m);
+				if (!rate)
+					continue;
+				if (m == TA_CRYPTO_PERF_BIGNUM_IMPL_TEE)
+					base = rate;
+				else if (base > 0)
+					printf("  x%.2f", rate / base);
+				printf("\n");
+			}
+		}
+	}
+out:
+	TEEC_CloseSession(&sess);
+	TEEC_FinalizeContext(&ctx);
+	return rc ? 1 : 0;
+}
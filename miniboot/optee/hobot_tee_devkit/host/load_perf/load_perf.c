@@ -0,0 +1,263 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2026, D-Robotics
+ */
+
+/*
+ * Host side of the load_perf TA: for each installed variant of
+ * ta/demo/load_perf_variant, has the TA open sessions to it with and
+ * without another session keeping the instance, and prints percentiles
+ * of the open, first invoke, next invoke and close latencies. With -c the
+ * same numbers come as CSV, to compare runs against a baseline.
+ */
+
+#include <err.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tee_client_api.h>
+#include <ta_load_perf.h>
+#include <unistd.h>
+
+#define DEFAULT_COUNT	32
+
+struct run {
+	struct load_perf_sample *samples;
+	uint32_t image_kib;
+	uint32_t flags;
+	uint32_t cxx_objs;
+	double freq;
+};
+
+struct metric {
+	const char *name;
+	unsigned int mode;
+	size_t offs;		/* In struct load_perf_sample */
+};
+
+static const struct metric metrics[] = {
+	{ "cold open", TA_LOAD_PERF_MODE_COLD,
+	  offsetof(struct load_perf_sample, open) },
+	{ "cold first invoke", TA_LOAD_PERF_MODE_COLD,
+	  offsetof(struct load_perf_sample, first_invoke) },
+	{ "cold close", TA_LOAD_PERF_MODE_COLD,
+	  offsetof(struct load_perf_sample, close) },
+	{ "warm open", TA_LOAD_PERF_MODE_WARM,
+	  offsetof(struct load_perf_sample, open) },
+	{ "warm first invoke", TA_LOAD_PERF_MODE_WARM,
+	  offsetof(struct load_perf_sample, first_invoke) },
+	{ "invoke", TA_LOAD_PERF_MODE_WARM,
+	  offsetof(struct load_perf_sample, invoke) },
+};
+
+static const unsigned int percentiles[] = { 50, 90, 99 };
+
+static void usage(const char *progname)
+{
+	fprintf(stderr, "Usage: %s [-h] [-n COUNT] [-v INDEX] [-c]\n",
+		progname);
+	fprintf(stderr, "  -n COUNT Sessions opened per variant and mode "
+		"[%d]\n", DEFAULT_COUNT);
+	fprintf(stderr, "  -v INDEX Only measure the variant of INDEX, in hex "
+		"as in variants.mk\n");
+	fprintf(stderr, "  -c       Print CSV: variant,metric,count,min,"
+		"p50,p90,p99,max in us\n");
+}
+
+/* Returns TEEC_ERROR_ITEM_NOT_FOUND if the variant is not installed */
+static TEEC_Result run(TEEC_Session *sess, uint32_t index, uint32_t mode,
+		       size_t count, struct run *r)
+{
+	TEEC_Operation op = { };
+	uint32_t ret_orig = 0;
+	TEEC_Result res = TEEC_SUCCESS;
+
+	op.paramTypes = TEEC_PARAM_TYPES(TEEC_VALUE_INPUT,
+					 TEEC_MEMREF_TEMP_OUTPUT,
+					 TEEC_VALUE_OUTPUT, TEEC_VALUE_OUTPUT);
+	op.params[0].value.a = index;
+	op.params[0].value.b = mode;
+	op.params[1].tmpref.buffer = r->samples;
+	op.params[1].tmpref.size = count * sizeof(*r->samples);
+
+	res = TEEC_InvokeCommand(sess, TA_LOAD_PERF_CMD_RUN, &op, &ret_orig);
+	if (res != TEEC_SUCCESS) {
+		if (res != TEEC_ERROR_ITEM_NOT_FOUND)
+			warnx("Variant %02" PRIx32 ": %#" PRIx32 " origin %#"
+			      PRIx32 ", see the secure console", index, res,
+			      ret_orig);
+		return res;
+	}
+
+	r->image_kib = op.params[2].value.a;
+	r->flags = op.params[2].value.b;
+	r->freq = op.params[3].value.a;
+	r->cxx_objs = op.params[3].value.b;
+
+	return TEEC_SUCCESS;
+}
+
+static int cmp_u32(const void *a, const void *b)
+{
+	uint32_t x = *(const uint32_t *)a;
+	uint32_t y = *(const uint32_t *)b;
+
+	return (x > y) - (x < y);
+}
+
+/* Nearest rank */
+static uint32_t percentile(const uint32_t *sorted, size_t count,
+			   unsigned int p)
+{
+	size_t rank = (count * p + 99) / 100;
+
+	return sorted[rank ? rank - 1 : 0];
+}
+
+static void describe(uint32_t index, const struct run *r)
+{
+	printf("variant %02" PRIx32 ": image +%" PRIu32 "K", index,
+	       r->image_kib);
+	if (r->flags & TA_LOAD_PERF_F_ENCRYPTED)
+		printf(", encrypted");
+	if (r->flags & TA_LOAD_PERF_F_SHLIB)
+		printf(", libos_test");
+	if (r->flags & TA_LOAD_PERF_F_DLOPEN)
+		printf(", dlopen os_test_lib_dl");
+	if (r->cxx_objs)
+		printf(", %" PRIu32 " C++ objects", r->cxx_objs);
+	printf("\n");
+}
+
+static void report(uint32_t index, const struct run *runs, size_t count,
+		   uint32_t *vals, bool csv)
+{
+	const struct metric *m = NULL;
+	const struct run *r = NULL;
+	double us = 0;
+	size_t n = 0;
+	size_t p = 0;
+
+	if (!csv) {
+		describe(index, runs);
+		printf("  %-18s %9s", "us", "min");
+		for (p = 0; p < sizeof(percentiles) / sizeof(percentiles[0]);
+		     p++)
+			printf("  %7s%u", "p", percentiles[p]);
+		printf("  %9s\n", "max");
+	}
+
+	for (m = metrics; m < metrics + sizeof(metrics) / sizeof(metrics[0]);
+	     m++) {
+		r = runs + m->mode;
+		us = 1e6 / r->freq;
+		for (n = 0; n < count; n++)
+			memcpy(vals + n, (uint8_t *)(r->samples + n) + m->offs,
+			       sizeof(*vals));
+		qsort(vals, count, sizeof(*vals), cmp_u32);
+
+		if (csv)
+			printf("%02" PRIx32 ",%s,%zu,%.1f", index, m->name,
+			       count, vals[0] * us);
+		else
+			printf("  %-18s %9.1f", m->name, vals[0] * us);
+		for (p = 0; p < sizeof(percentiles) / sizeof(percentiles[0]);
+		     p++)
+			printf(csv ? ",%.1f" : "  %9.1f",
+			       percentile(vals, count, percentiles[p]) * us);
+		printf(csv ? ",%.1f\n" : "  %9.1f\n", vals[count - 1] * us);
+	}
+
+	if (!csv)
+		printf("\n");
+}
+
+int main(int argc, char *argv[])
+{
+	TEEC_UUID uuid = TA_LOAD_PERF_UUID;
+	TEEC_Context ctx = { };
+	TEEC_Session sess = { };
+	uint32_t ret_orig = 0;
+	TEEC_Result res = TEEC_SUCCESS;
+	struct run runs[2] = { };
+	size_t count = DEFAULT_COUNT;
+	uint32_t first = 0;
+	uint32_t last = TA_LOAD_PERF_MAX_VARIANTS - 1;
+	uint32_t index = 0;
+	uint32_t *vals = NULL;
+	unsigned int found = 0;
+	unsigned int failed = 0;
+	bool csv = false;
+	int opt = 0;
+
+	while ((opt = getopt(argc, argv, "hn:v:c")) != -1) {
+		switch (opt) {
+		case 'n':
+			count = strtoul(optarg, NULL, 0);
+			break;
+		case 'v':
+			first = strtoul(optarg, NULL, 16);
+			last = first;
+			break;
+		case 'c':
+			csv = true;
+			break;
+		case 'h':
+		default:
+			usage(argv[0]);
+			return opt == 'h' ? 0 : 1;
+		}
+	}
+
+	if (!count || last >= TA_LOAD_PERF_MAX_VARIANTS)
+		errx(1, "Bad count or variant");
+
+	runs[0].samples = calloc(count, sizeof(*runs[0].samples));
+	runs[1].samples = calloc(count, sizeof(*runs[1].samples));
+	vals = calloc(count, sizeof(*vals));
+	if (!runs[0].samples || !runs[1].samples || !vals)
+		errx(1, "Out of memory");
+
+	res = TEEC_InitializeContext(NULL, &ctx);
+	if (res != TEEC_SUCCESS)
+		errx(1, "TEEC_InitializeContext: %#" PRIx32, res);
+
+	res = TEEC_OpenSession(&ctx, &sess, &uuid, TEEC_LOGIN_PUBLIC, NULL,
+			       NULL, &ret_orig);
+	if (res != TEEC_SUCCESS)
+		errx(1, "TEEC_OpenSession: %#" PRIx32 " origin %#" PRIx32,
+		     res, ret_orig);
+
+	if (csv)
+		printf("variant,metric,count,min,p50,p90,p99,max\n");
+
+	for (index = first; index <= last; index++) {
+		res = run(&sess, index, TA_LOAD_PERF_MODE_COLD, count,
+			  runs + TA_LOAD_PERF_MODE_COLD);
+		if (res == TEEC_ERROR_ITEM_NOT_FOUND)
+			continue;
+		found++;
+		if (res == TEEC_SUCCESS)
+			res = run(&sess, index, TA_LOAD_PERF_MODE_WARM, count,
+				  runs + TA_LOAD_PERF_MODE_WARM);
+		if (res != TEEC_SUCCESS) {
+			failed++;
+			continue;
+		}
+		report(index, runs, count, vals, csv);
+	}
+
+	TEEC_CloseSession(&sess);
+	TEEC_FinalizeContext(&ctx);
+	free(runs[0].samples);
+	free(runs[1].samples);
+	free(vals);
+
+	if (!found)
+		errx(1, "No load_perf_variant TA installed");
+
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,627 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2026, D-Robotics
+ */
+
+/*
+ * Benchmark of the slab heap of ta/lib/ta_ext, see slab_malloc.h
+ *
+ * The TA heap is bget, which is only available as part of libutils. The
+ * pool below models it: first fit over a free list in release order,
+ * blocks carved from the end of the free block found, a 16-byte header per
+ * block, neighbours merged on release and memalign() done by carving the
+ * aligned block out of a larger one and releasing the rest. The same
+ * workloads run on the model alone and on a slab heap over the model:
+ *
+ * x509:   a certificate chain parsed and verified per request, as
+ *         mbedtls_x509_crt_parse() and mbedtls_rsa_pkcs1_verify() allocate
+ *         it: named data and sequence lists, the DER copy, the RSA context
+ *         and growing bignum limbs.
+ * bignum: mbedtls_mpi_grow() churn of the temporaries of RSA-2048 modular
+ *         exponentiation, 32-bit limbs as in mbedtls_config_uta.h.
+ * asn1:   small ASN.1 nodes with random lifetimes.
+ * mixed:  sizes from 8 bytes to 4 KiB with random lifetimes.
+ */
+
+#include <err.h>
+#include <inttypes.h>
+#include <slab_malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define ARRAY_SIZE(x)		(sizeof(x) / sizeof((x)[0]))
+
+#define POOL_SIZE		(1024 * 1024)
+#define POOL_QUANT		16
+
+/* Header of every block, as struct bhead of bget */
+struct bhead {
+	size_t prevfree;	/* Size of the previous block if it is free */
+	ssize_t bsize;		/* Size of the block, negative if allocated */
+};
+
+/* Header of a free block */
+struct bfhead {
+	struct bhead bh;
+	struct bfhead *flink;
+	struct bfhead *blink;
+};
+
+static uint8_t pool_mem[POOL_SIZE] __attribute__((aligned(SLAB_PAGE_SIZE)));
+static struct bfhead freelist;
+static size_t pool_allocated;
+static size_t pool_max_allocated;
+
+static struct bhead *bh_at(void *p, ssize_t offs)
+{
+	return (struct bhead *)((uint8_t *)p + offs);
+}
+
+static void pool_init(void)
+{
+	struct bfhead *b = (struct bfhead *)pool_mem;
+	size_t len = POOL_SIZE - sizeof(struct bhead);
+
+	freelist.flink = b;
+	freelist.blink = b;
+	b->flink = &freelist;
+	b->blink = &freelist;
+	b->bh.prevfree = 0;
+	b->bh.bsize = len;
+
+	/* Allocated sentinel at the end */
+	bh_at(b, len)->prevfree = len;
+	bh_at(b, len)->bsize = -(ssize_t)sizeof(struct bhead);
+
+	pool_allocated = 0;
+	pool_max_allocated = 0;
+}
+
+static void pool_unlink(struct bfhead *b)
+{
+	b->blink->flink = b->flink;
+	b->flink->blink = b->blink;
+}
+
+static void *pool_malloc(size_t size)
+{
+	struct bfhead *b = NULL;
+	struct bhead *ba = NULL;
+	size_t bsize = 0;
+
+	size = (size + POOL_QUANT - 1) & ~(size_t)(POOL_QUANT - 1);
+	bsize = size + sizeof(struct bhead);
+	if (bsize < sizeof(struct bfhead))
+		bsize = sizeof(struct bfhead);
+
+	for (b = freelist.flink; b != &freelist; b = b->flink) {
+		if ((size_t)b->bh.bsize < bsize)
+			continue;
+
+		if ((size_t)b->bh.bsize - bsize > sizeof(struct bfhead)) {
+			/* Carve the block from the end of the free one */
+			b->bh.bsize -= bsize;
+			ba = bh_at(b, b->bh.bsize);
+			ba->prevfree = b->bh.bsize;
+			ba->bsize = -(ssize_t)bsize;
+			bh_at(ba, bsize)->prevfree = 0;
+		} else {
+			pool_unlink(b);
+			ba = &b->bh;
+			bsize = ba->bsize;
+			ba->bsize = -ba->bsize;
+			bh_at(ba, bsize)->prevfree = 0;
+		}
+
+		pool_allocated += bsize;
+		if (pool_allocated > pool_max_allocated)
+			pool_max_allocated = pool_allocated;
+
+		return ba + 1;
+	}
+
+	return NULL;
+}
+
+static void pool_free(void *ptr)
+{
+	struct bfhead *b = NULL;
+	struct bfhead *bn = NULL;
+
+	if (!ptr)
+		return;
+
+	b = (struct bfhead *)((struct bhead *)ptr - 1);
+	b->bh.bsize = -b->bh.bsize;
+	pool_allocated -= b->bh.bsize;
+
+	if (b->bh.prevfree) {
+		/* Merged into the previous block, already in the list */
+		size_t size = b->bh.bsize;
+
+		b = (struct bfhead *)bh_at(b, -(ssize_t)b->bh.prevfree);
+		b->bh.bsize += size;
+	} else {
+		b->flink = &freelist;
+		b->blink = freelist.blink;
+		freelist.blink->flink = b;
+		freelist.blink = b;
+	}
+
+	bn = (struct bfhead *)bh_at(b, b->bh.bsize);
+	if (bn->bh.bsize > 0) {
+		pool_unlink(bn);
+		b->bh.bsize += bn->bh.bsize;
+		bn = (struct bfhead *)bh_at(b, b->bh.bsize);
+	}
+	bn->bh.prevfree = b->bh.bsize;
+}
+
+static void *pool_calloc(size_t nmemb, size_t size)
+{
+	void *p = NULL;
+
+	if (nmemb && size > SIZE_MAX / nmemb)
+		return NULL;
+
+	p = pool_malloc(nmemb * size);
+	if (p)
+		memset(p, 0, nmemb * size);
+
+	return p;
+}
+
+static size_t pool_payload(void *ptr)
+{
+	return -((struct bhead *)ptr - 1)->bsize - sizeof(struct bhead);
+}
+
+static void *pool_realloc(void *ptr, size_t size)
+{
+	void *p = pool_malloc(size);
+
+	if (p && ptr) {
+		memcpy(p, ptr, size < pool_payload(ptr) ? size :
+						     pool_payload(ptr));
+		pool_free(ptr);
+	}
+
+	return p;
+}
+
+/* Releases what follows the first @size bytes of the allocated block @b */
+static void pool_release_tail(struct bhead *b, size_t size)
+{
+	size_t bsize = -b->bsize;
+	size_t keep = ((size + POOL_QUANT - 1) & ~(size_t)(POOL_QUANT - 1)) +
+		      sizeof(struct bhead);
+	struct bhead *t = NULL;
+
+	if (bsize < keep || bsize - keep <= sizeof(struct bfhead))
+		return;
+
+	b->bsize = -(ssize_t)keep;
+	t = bh_at(b, keep);
+	t->bsize = -(ssize_t)(bsize - keep);
+	t->prevfree = 0;
+	pool_free(t + 1);
+}
+
+static void *pool_memalign(size_t alignment, size_t size)
+{
+	struct bhead *b = NULL;
+	struct bhead *ba = NULL;
+	uintptr_t p = 0;
+	uintptr_t a = 0;
+	ssize_t head = 0;
+
+	p = (uintptr_t)pool_malloc(size + alignment + sizeof(struct bfhead));
+	if (!p)
+		return NULL;
+
+	a = p;
+	if (p & (alignment - 1)) {
+		/* Leave room for a free block in front of the aligned one */
+		a = (p + sizeof(struct bfhead) + alignment - 1) &
+		    ~(alignment - 1);
+		head = a - p;
+		b = (struct bhead *)p - 1;
+		ba = (struct bhead *)a - 1;
+		ba->bsize = b->bsize + head;
+		ba->prevfree = 0;
+		b->bsize = -head;
+		pool_free((void *)p);
+	}
+	/* As raw_memalign() of libutils, the unused end goes back too */
+	pool_release_tail((struct bhead *)a - 1, size);
+
+	return (void *)a;
+}
+
+static const struct slab_pool_ops pool_ops = {
+	.malloc = pool_malloc,
+	.calloc = pool_calloc,
+	.realloc = pool_realloc,
+	.memalign = pool_memalign,
+	.free = pool_free,
+};
+
+static struct slab_heap slab;
+
+static void *slab_malloc(size_t size)
+{
+	return slab_heap_malloc(&slab, size);
+}
+
+static void *slab_calloc(size_t nmemb, size_t size)
+{
+	return slab_heap_calloc(&slab, nmemb, size);
+}
+
+static void slab_free(void *ptr)
+{
+	slab_heap_free(&slab, ptr);
+}
+
+struct allocator {
+	const char *name;
+	void *(*malloc)(size_t size);
+	void *(*calloc)(size_t nmemb, size_t size);
+	void (*free)(void *ptr);
+	bool slab;
+};
+
+static const struct allocator allocators[] = {
+	{ "bget", pool_malloc, pool_calloc, pool_free, false },
+	{ "slab+bget", slab_malloc, slab_calloc, slab_free, true },
+};
+
+static uint64_t rng_state;
+
+static uint32_t rng(void)
+{
+	/* xorshift64* */
+	rng_state ^= rng_state >> 12;
+	rng_state ^= rng_state << 25;
+	rng_state ^= rng_state >> 27;
+	return (rng_state * 0x2545F4914F6CDD1DULL) >> 32;
+}
+
+static uint32_t rng_range(uint32_t lo, uint32_t hi)
+{
+	return lo + rng() % (hi - lo + 1);
+}
+
+static unsigned long nops;
+
+static void *xmalloc(const struct allocator *a, size_t size)
+{
+	void *p = a->malloc(size);
+
+	if (!p)
+		errx(1, "%s: out of memory allocating %zu bytes", a->name,
+		     size);
+	nops++;
+	return p;
+}
+
+static void *xcalloc(const struct allocator *a, size_t size)
+{
+	void *p = a->calloc(1, size);
+
+	if (!p)
+		errx(1, "%s: out of memory allocating %zu bytes", a->name,
+		     size);
+	nops++;
+	return p;
+}
+
+static void xfree(const struct allocator *a, void *ptr)
+{
+	a->free(ptr);
+	nops++;
+}
+
+/*
+ * A bignum grown to @limbs 32-bit limbs the way mbedtls_mpi_grow() does:
+ * a new zeroed array, the old limbs copied, the old array freed
+ */
+struct mpi {
+	void *p;
+	size_t n;
+};
+
+static void mpi_grow(const struct allocator *a, struct mpi *x, size_t limbs)
+{
+	void *p = NULL;
+
+	if (limbs <= x->n)
+		return;
+
+	p = xcalloc(a, limbs * 4);
+	if (x->p) {
+		memcpy(p, x->p, x->n * 4);
+		xfree(a, x->p);
+	}
+	x->p = p;
+	x->n = limbs;
+}
+
+static void mpi_free(const struct allocator *a, struct mpi *x)
+{
+	if (x->p)
+		xfree(a, x->p);
+	x->p = NULL;
+	x->n = 0;
+}
+
+/* Temporaries of one RSA-2048 public or private operation */
+static void rsa_op(const struct allocator *a, unsigned int window)
+{
+	struct mpi t[8] = { };
+	struct mpi w[32] = { };
+	unsigned int i = 0;
+	unsigned int j = 0;
+
+	for (i = 0; i < ARRAY_SIZE(t); i++)
+		mpi_grow(a, t + i, rng_range(1, 8));
+	for (i = 0; i < (1U << (window - 1)); i++) {
+		mpi_grow(a, w + i, 64);
+		mpi_grow(a, w + i, 129);
+	}
+	for (j = 0; j < 48; j++) {
+		i = rng_range(0, ARRAY_SIZE(t) - 1);
+		if (t[i].n > 64 && !(rng() & 3))
+			mpi_free(a, t + i);
+		mpi_grow(a, t + i, t[i].n + rng_range(1, 66));
+		if (t[i].n > 129)
+			mpi_free(a, t + i);
+	}
+	for (i = 0; i < ARRAY_SIZE(w); i++)
+		mpi_free(a, w + i);
+	for (i = 0; i < ARRAY_SIZE(t); i++)
+		mpi_free(a, t + i);
+}
+
+static void run_bignum(const struct allocator *a, unsigned int reqs)
+{
+	while (reqs--)
+		rsa_op(a, rng_range(1, 6));
+}
+
+/* What mbedtls_x509_crt_parse() keeps of one certificate */
+#define CRT_ALLOCS	40
+
+static void parse_crt(const struct allocator *a, void **live, size_t *n)
+{
+	struct mpi rsa_n = { };
+	struct mpi rsa_e = { };
+	unsigned int i = 0;
+
+	live[(*n)++] = xcalloc(a, 584);			/* mbedtls_x509_crt */
+	live[(*n)++] = xmalloc(a, rng_range(700, 1600));	/* DER copy */
+	for (i = rng_range(6, 14); i; i--)
+		live[(*n)++] = xcalloc(a, 64);		/* Issuer, subject */
+	for (i = rng_range(1, 5); i; i--)
+		live[(*n)++] = xcalloc(a, 32);		/* SAN, key usage */
+	live[(*n)++] = xcalloc(a, 352);			/* RSA context */
+	mpi_grow(a, &rsa_n, 64);
+	mpi_grow(a, &rsa_e, 1);
+	live[(*n)++] = rsa_n.p;
+	live[(*n)++] = rsa_e.p;
+}
+
+static void run_x509(const struct allocator *a, unsigned int reqs)
+{
+	void *live[3 * CRT_ALLOCS] = { };
+	size_t n = 0;
+	size_t i = 0;
+
+	while (reqs--) {
+		n = 0;
+		for (i = 0; i < 3; i++)
+			parse_crt(a, live, &n);
+		/* Verify the two signatures of the chain */
+		rsa_op(a, 1);
+		rsa_op(a, 1);
+		for (i = 0; i < n; i++)
+			xfree(a, live[i]);
+	}
+}
+
+/* Random lifetimes over a live set of @slots allocations */
+static void run_random(const struct allocator *a, unsigned int reqs,
+		       size_t slots, uint32_t min_size, uint32_t max_size)
+{
+	void **live = calloc(slots, sizeof(*live));
+	unsigned int r = 0;
+	size_t i = 0;
+	uint32_t size = 0;
+
+	if (!live)
+		err(1, "calloc");
+
+	for (r = 0; r < reqs * 100; r++) {
+		i = rng_range(0, slots - 1);
+		if (live[i]) {
+			xfree(a, live[i]);
+			live[i] = NULL;
+			continue;
+		}
+		/* Log-uniform sizes, small ones are the most frequent */
+		size = min_size << rng_range(0, 9);
+		size = rng_range(min_size, size < max_size ? size : max_size);
+		live[i] = xmalloc(a, size);
+	}
+
+	for (i = 0; i < slots; i++)
+		if (live[i])
+			xfree(a, live[i]);
+	free(live);
+}
+
+static void run_asn1(const struct allocator *a, unsigned int reqs)
+{
+	run_random(a, reqs, 512, 16, 80);
+}
+
+static void run_mixed(const struct allocator *a, unsigned int reqs)
+{
+	run_random(a, reqs, 256, 8, 4096);
+}
+
+static const struct {
+	const char *name;
+	void (*run)(const struct allocator *a, unsigned int reqs);
+} workloads[] = {
+	{ "x509", run_x509 },
+	{ "bignum", run_bignum },
+	{ "asn1", run_asn1 },
+	{ "mixed", run_mixed },
+};
+
+static double now(void)
+{
+	struct timespec ts = { };
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void usage(const char *prog)
+{
+	size_t i = 0;
+
+	fprintf(stderr, "Usage: %s [-n requests] [-r runs] [-v] [workload...]\n",
+		prog);
+	fprintf(stderr, "Workloads:");
+	for (i = 0; i < ARRAY_SIZE(workloads); i++)
+		fprintf(stderr, " %s", workloads[i].name);
+	fprintf(stderr, "\n");
+	exit(1);
+}
+
+static bool selected(int argc, char *argv[], const char *name)
+{
+	int i = 0;
+
+	if (!argc)
+		return true;
+	for (i = 0; i < argc; i++)
+		if (!strcmp(argv[i], name))
+			return true;
+	return false;
+}
+
+static bool known(const char *name)
+{
+	size_t i = 0;
+
+	for (i = 0; i < ARRAY_SIZE(workloads); i++)
+		if (!strcmp(workloads[i].name, name))
+			return true;
+	return false;
+}
+
+/* Runs a workload on a fresh pool, returns the time it took */
+static double run_once(const struct allocator *a,
+		       void (*run)(const struct allocator *a,
+				   unsigned int reqs),
+		       unsigned int reqs)
+{
+	double t = 0;
+
+	pool_init();
+	if (a->slab && slab_heap_init(&slab, &pool_ops, pool_mem, POOL_SIZE))
+		errx(1, "slab_heap_init");
+
+	rng_state = 0x9E3779B97F4A7C15ULL;
+	nops = 0;
+	t = now();
+	run(a, reqs);
+
+	return now() - t;
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned int reqs = 2000;
+	unsigned int runs = 5;
+	unsigned int run = 0;
+	struct slab_stats st = { };
+	const struct allocator *a = NULL;
+	double best[ARRAY_SIZE(allocators)] = { };
+	size_t peak[ARRAY_SIZE(allocators)] = { };
+	double t = 0;
+	bool verbose = false;
+	size_t w = 0;
+	size_t i = 0;
+	int opt = 0;
+
+	while ((opt = getopt(argc, argv, "n:r:v")) != -1) {
+		switch (opt) {
+		case 'n':
+			reqs = strtoul(optarg, NULL, 0);
+			break;
+		case 'r':
+			runs = strtoul(optarg, NULL, 0);
+			if (!runs)
+				usage(argv[0]);
+			break;
+		case 'v':
+			verbose = true;
+			break;
+		default:
+			usage(argv[0]);
+		}
+	}
+	for (i = optind; i < (size_t)argc; i++)
+		if (!known(argv[i]))
+			usage(argv[0]);
+
+	printf("%-8s %-10s %10s %9s %10s %7s %7s\n", "workload", "allocator",
+	       "ops", "ns/op", "peak", "refill", "thru");
+
+	for (w = 0; w < ARRAY_SIZE(workloads); w++) {
+		if (!selected(argc - optind, argv + optind, workloads[w].name))
+			continue;
+
+		/*
+		 * The allocators take turns and each keeps its best run, so
+		 * that interference hits both alike
+		 */
+		for (run = 0; run < runs; run++) {
+			for (i = 0; i < ARRAY_SIZE(allocators); i++) {
+				t = run_once(allocators + i, workloads[w].run,
+					     reqs);
+				if (!run || t < best[i])
+					best[i] = t;
+				peak[i] = pool_max_allocated;
+			}
+		}
+
+		/* The slab heap ran last, its pool is still there */
+		slab_heap_get_stats(&slab, &st);
+		if (slab_heap_check(&slab, verbose))
+			errx(1, "slab_heap_check failed");
+		if (st.allocated)
+			errx(1, "%"PRIu32" bytes leaked", st.allocated);
+
+		for (i = 0; i < ARRAY_SIZE(allocators); i++) {
+			a = allocators + i;
+			printf("%-8s %-10s %10lu %9.1f %10zu %7"PRIu32
+			       " %7"PRIu32, workloads[w].name, a->name, nops,
+			       best[i] * 1e9 / nops, peak[i],
+			       a->slab ? st.refills : 0,
+			       a->slab ? st.passthrough : 0);
+			if (a->slab)
+				printf("  x%.2f", best[0] / best[i]);
+			printf("\n");
+		}
+	}
+
+	return 0;
+}
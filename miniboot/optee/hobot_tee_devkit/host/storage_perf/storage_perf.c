@@ -0,0 +1,235 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2026, D-Robotics
+ */
+
+/*
+ * Host side of the storage_perf TA: runs the hash tree tests of the core,
+ * then reports the rate of small writes to a persistent object, each
+ * with TEE_WriteObjectData() and through ta/lib/ta_ext/pobj_cache.c, for
+ * each order of the writes and a range of write sizes, the throughput of
+ * reads done the same ways for a range of object sizes, and that of
+ * loading whole objects with pobj_map_read().
+ */
+
+#include <err.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tee_client_api.h>
+#include <ta_storage_perf.h>
+#include <unistd.h>
+
+#define DEFAULT_SIZE	(256 * 1024)
+#define DEFAULT_COUNT	256
+/* Loads of each whole object */
+#define LOAD_COUNT	8
+
+static const uint32_t write_sizes[] = { 16, 64, 256, 1024, 4096 };
+static const uint32_t read_sizes[] = { 256, 4096, 32768 };
+static const uint32_t obj_sizes[] = { 64 * 1024, 256 * 1024, 1024 * 1024 };
+
+static const char *const patterns[] = {
+	[TA_STORAGE_PERF_PATTERN_SEQ] = "seq",
+	[TA_STORAGE_PERF_PATTERN_STRIDE] = "stride",
+	[TA_STORAGE_PERF_PATTERN_RANDOM] = "random",
+};
+
+struct result {
+	uint64_t ticks;
+	uint32_t calls;		/* TEE_{Read,Write}ObjectData() calls */
+};
+
+static void usage(const char *progname)
+{
+	fprintf(stderr, "Usage: %s [-h] [-s SIZE] [-n COUNT] [-w WSIZE]\n",
+		progname);
+	fprintf(stderr, "  -s SIZE  Size of the object, at most %d [%d]\n",
+		TA_STORAGE_PERF_MAX_SIZE, DEFAULT_SIZE);
+	fprintf(stderr, "  -n COUNT Writes per measurement [%d]\n",
+		DEFAULT_COUNT);
+	fprintf(stderr, "  -w WSIZE Only measure writes and reads of WSIZE "
+		"bytes\n");
+}
+
+static void run(TEEC_Session *sess, uint32_t cmd, uint32_t pattern,
+		uint32_t size, uint32_t chunk, uint32_t count, uint32_t flags,
+		struct result *r)
+{
+	TEEC_Operation op = { };
+	uint32_t ret_orig = 0;
+	TEEC_Result res = TEEC_SUCCESS;
+
+	op.paramTypes = TEEC_PARAM_TYPES(TEEC_VALUE_INPUT, TEEC_VALUE_INPUT,
+					 TEEC_VALUE_INOUT, TEEC_VALUE_OUTPUT);
+	op.params[0].value.a = pattern;
+	op.params[0].value.b = size;
+	op.params[1].value.a = chunk;
+	op.params[1].value.b = count;
+	op.params[2].value.a = flags;
+
+	res = TEEC_InvokeCommand(sess, cmd, &op, &ret_orig);
+	if (res != TEEC_SUCCESS)
+		errx(1, "%s %s of %" PRIu32 " bytes: %#" PRIx32
+		     " origin %#" PRIx32, patterns[pattern],
+		     cmd == TA_STORAGE_PERF_CMD_WRITE ? "writes" : "reads",
+		     chunk, res, ret_orig);
+
+	r->ticks = (uint64_t)op.params[3].value.a << 32 |
+		   op.params[3].value.b;
+	r->calls = op.params[2].value.b;
+}
+
+int main(int argc, char *argv[])
+{
+	TEEC_UUID uuid = TA_STORAGE_PERF_UUID;
+	TEEC_Context ctx = { };
+	TEEC_Session sess = { };
+	TEEC_Operation op = { };
+	uint32_t ret_orig = 0;
+	TEEC_Result res = TEEC_SUCCESS;
+	struct result direct = { };
+	struct result cached = { };
+	uint32_t size = DEFAULT_SIZE;
+	uint32_t count = DEFAULT_COUNT;
+	uint32_t only = 0;
+	uint32_t wsize = 0;
+	double freq = 0;
+	size_t o = 0;
+	size_t p = 0;
+	size_t n = 0;
+	int opt = 0;
+
+	while ((opt = getopt(argc, argv, "hs:n:w:")) != -1) {
+		switch (opt) {
+		case 's':
+			size = strtoul(optarg, NULL, 0);
+			break;
+		case 'n':
+			count = strtoul(optarg, NULL, 0);
+			break;
+		case 'w':
+			only = strtoul(optarg, NULL, 0);
+			break;
+		case 'h':
+		default:
+			usage(argv[0]);
+			return opt == 'h' ? 0 : 1;
+		}
+	}
+
+	if (!size || size > TA_STORAGE_PERF_MAX_SIZE || !count)
+		errx(1, "Bad object size or write count");
+
+	res = TEEC_InitializeContext(NULL, &ctx);
+	if (res != TEEC_SUCCESS)
+		errx(1, "TEEC_InitializeContext: %#" PRIx32, res);
+
+	res = TEEC_OpenSession(&ctx, &sess, &uuid, TEEC_LOGIN_PUBLIC, NULL,
+			       NULL, &ret_orig);
+	if (res != TEEC_SUCCESS)
+		errx(1, "TEEC_OpenSession: %#" PRIx32 " origin %#" PRIx32,
+		     res, ret_orig);
+
+	op.paramTypes = TEEC_PARAM_TYPES(TEEC_NONE, TEEC_NONE, TEEC_NONE,
+					 TEEC_NONE);
+	res = TEEC_InvokeCommand(&sess, TA_STORAGE_PERF_CMD_FS_HTREE, &op,
+				 &ret_orig);
+	if (res == TEEC_ERROR_NOT_SUPPORTED)
+		printf("fs htree tests: not in this core\n");
+	else if (res != TEEC_SUCCESS)
+		errx(1, "fs htree tests: %#" PRIx32 " origin %#" PRIx32,
+		     res, ret_orig);
+	else
+		printf("fs htree tests: passed\n");
+
+	op.paramTypes = TEEC_PARAM_TYPES(TEEC_VALUE_OUTPUT, TEEC_NONE,
+					 TEEC_NONE, TEEC_NONE);
+	res = TEEC_InvokeCommand(&sess, TA_STORAGE_PERF_CMD_GET_FREQ, &op,
+				 &ret_orig);
+	if (res != TEEC_SUCCESS || !op.params[0].value.a)
+		errx(1, "Counter frequency: %#" PRIx32, res);
+	freq = op.params[0].value.a;
+
+	printf("%-7s %6s  %12s %8s  %12s %8s  %7s\n", "order", "write",
+	       "direct op/s", "writes", "cached op/s", "writes", "speedup");
+
+	for (p = 0; p < sizeof(patterns) / sizeof(patterns[0]); p++) {
+		for (n = 0; n < sizeof(write_sizes) / sizeof(write_sizes[0]);
+		     n++) {
+			wsize = write_sizes[n];
+			if ((only && wsize != only) || wsize > size)
+				continue;
+
+			run(&sess, TA_STORAGE_PERF_CMD_WRITE, p, size, wsize,
+			    count, 0, &direct);
+			run(&sess, TA_STORAGE_PERF_CMD_WRITE, p, size, wsize,
+			    count, TA_STORAGE_PERF_FLAG_CACHED, &cached);
+
+			printf("%-7s %6" PRIu32 "  %12.1f %8" PRIu32
+			       "  %12.1f %8" PRIu32 "  %6.1fx\n",
+			       patterns[p], wsize,
+			       count * freq / direct.ticks, direct.calls,
+			       count * freq / cached.ticks, cached.calls,
+			       (double)direct.ticks / cached.ticks);
+		}
+	}
+
+	printf("\n%-7s %7s %6s  %12s %8s  %12s %8s  %7s\n", "order",
+	       "object", "read", "direct MB/s", "reads", "cached MB/s",
+	       "reads", "speedup");
+
+	for (o = 0; o < sizeof(obj_sizes) / sizeof(obj_sizes[0]); o++) {
+		for (p = 0; p < sizeof(patterns) / sizeof(patterns[0]); p++) {
+			for (n = 0;
+			     n < sizeof(read_sizes) / sizeof(read_sizes[0]);
+			     n++) {
+				wsize = read_sizes[n];
+				if ((only && wsize != only) ||
+				    wsize > obj_sizes[o])
+					continue;
+
+				run(&sess, TA_STORAGE_PERF_CMD_READ, p,
+				    obj_sizes[o], wsize, count, 0, &direct);
+				run(&sess, TA_STORAGE_PERF_CMD_READ, p,
+				    obj_sizes[o], wsize, count,
+				    TA_STORAGE_PERF_FLAG_CACHED, &cached);
+
+				printf("%-7s %6" PRIu32 "K %6" PRIu32
+				       "  %12.1f %8" PRIu32 "  %12.1f %8"
+				       PRIu32 "  %6.1fx\n", patterns[p],
+				       obj_sizes[o] / 1024, wsize,
+				       count * wsize * freq / direct.ticks /
+				       1e6, direct.calls,
+				       count * wsize * freq / cached.ticks /
+				       1e6, cached.calls,
+				       (double)direct.ticks / cached.ticks);
+			}
+		}
+	}
+
+	/* Whole objects, in 4 KiB reads and with a single one */
+	printf("\n%7s  %12s  %12s  %7s\n", "object", "4K-read MB/s",
+	       "mapped MB/s", "speedup");
+
+	for (o = 0; o < sizeof(obj_sizes) / sizeof(obj_sizes[0]); o++) {
+		run(&sess, TA_STORAGE_PERF_CMD_READ,
+		    TA_STORAGE_PERF_PATTERN_SEQ, obj_sizes[o], 4096,
+		    LOAD_COUNT * obj_sizes[o] / 4096, 0, &direct);
+		run(&sess, TA_STORAGE_PERF_CMD_READ,
+		    TA_STORAGE_PERF_PATTERN_SEQ, obj_sizes[o], 4096,
+		    LOAD_COUNT, TA_STORAGE_PERF_FLAG_MAP, &cached);
+
+		printf("%6" PRIu32 "K  %12.1f  %12.1f  %6.1fx\n",
+		       obj_sizes[o] / 1024,
+		       LOAD_COUNT * obj_sizes[o] * freq / direct.ticks / 1e6,
+		       LOAD_COUNT * obj_sizes[o] * freq / cached.ticks / 1e6,
+		       (double)direct.ticks / cached.ticks);
+	}
+
+	TEEC_CloseSession(&sess);
+	TEEC_FinalizeContext(&ctx);
+
+	return 0;
+}
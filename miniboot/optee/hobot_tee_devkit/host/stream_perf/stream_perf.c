@@ -0,0 +1,475 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2026, D-Robotics
+ */
+
+/*
+ * Host side of the stream_perf TA: streams the same data to the TA once
+ * as one invoke per chunk and once through a shared memory ring, see
+ * ta/lib/ta_ext/include/shm_ring.h, for a range of chunk sizes, checks
+ * what the TA received and reports the throughput of both and the number
+ * of invokes each needed.
+ *
+ * With -T the tracepoints of a TA built with CFG_TA_TRACEPOINT=y are saved
+ * after each measurement, for scripts/tp_trace.py.
+ */
+
+#include <err.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <shm_ring_abi.h>
+#include <tee_client_api.h>
+#include <ta_stream_perf.h>
+#include <time.h>
+#include <tracepoint_abi.h>
+#include <unistd.h>
+
+#define DEFAULT_TOTAL	(16 * 1024 * 1024)
+#define DEFAULT_RING	(256 * 1024)
+#define TRACE_BUF	(64 * 1024)
+
+static const size_t chunk_sizes[] = { 64, 256, 1024, 4096, 16384, 65536 };
+
+struct result {
+	uint64_t sum;
+	uint32_t chunks;
+	uint32_t doorbells;
+};
+
+/* Producer side of the ring, the TA is the consumer */
+struct ring {
+	struct shm_ring_hdr *hdr;
+	uint8_t *data;
+	uint32_t size;
+	uint32_t head;
+	uint32_t tail;
+	uint32_t next;
+};
+
+/* The thread that rings the doorbells, so that the producer never waits */
+struct bell {
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	TEEC_Session *sess;
+	TEEC_SharedMemory *shm;
+	unsigned int pending;
+	bool busy;
+	bool stop;
+	TEEC_Result res;
+	uint32_t ret_orig;
+};
+
+static void usage(const char *progname)
+{
+	fprintf(stderr, "Usage: %s [-h] [-t TOTAL] [-r RING] [-s SIZE] [-c] "
+		"[-T FILE]\n", progname);
+	fprintf(stderr, "  -t TOTAL Bytes streamed per measurement [%d]\n",
+		DEFAULT_TOTAL);
+	fprintf(stderr, "  -r RING  Size of the ring data, a power of 2 [%d]\n",
+		DEFAULT_RING);
+	fprintf(stderr, "  -s SIZE  Only measure chunks of SIZE bytes\n");
+	fprintf(stderr, "  -c       Have the TA invalidate the records, as "
+		"for a non-coherent producer\n");
+	fprintf(stderr, "  -T FILE  Save the tracepoints of the TA to FILE after "
+		"each measurement\n");
+}
+
+static double now(void)
+{
+	struct timespec ts = { };
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void get_result(TEEC_Session *sess, struct result *r)
+{
+	TEEC_Operation op = { };
+	uint32_t ret_orig = 0;
+	TEEC_Result res = TEEC_SUCCESS;
+
+	op.paramTypes = TEEC_PARAM_TYPES(TEEC_VALUE_OUTPUT, TEEC_VALUE_OUTPUT,
+					 TEEC_NONE, TEEC_NONE);
+	res = TEEC_InvokeCommand(sess, TA_STREAM_PERF_CMD_RESULT, &op,
+				 &ret_orig);
+	if (res != TEEC_SUCCESS)
+		errx(1, "Result: TEEC_InvokeCommand: %#" PRIx32
+		     " origin %#" PRIx32, res, ret_orig);
+
+	r->sum = (uint64_t)op.params[0].value.a << 32 | op.params[0].value.b;
+	r->chunks = op.params[1].value.a;
+	r->doorbells = op.params[1].value.b;
+}
+
+/* The TA ring holds the first STREAM_PERF_TRACE_RECS records of a run */
+static void save_trace(TEEC_Session *sess, FILE *f)
+{
+	static uint8_t buf[TRACE_BUF];
+	TEEC_Operation op = { };
+	uint32_t ret_orig = 0;
+	TEEC_Result res = TEEC_SUCCESS;
+	struct tp_hdr hdr = { };
+	size_t len = 0;
+
+	do {
+		op.paramTypes = TEEC_PARAM_TYPES(TEEC_MEMREF_TEMP_OUTPUT,
+						 TEEC_NONE, TEEC_NONE,
+						 TEEC_NONE);
+		op.params[0].tmpref.buffer = buf;
+		op.params[0].tmpref.size = sizeof(buf);
+		res = TEEC_InvokeCommand(sess, TA_STREAM_PERF_CMD_TRACE, &op,
+					 &ret_orig);
+		if (res == TEEC_ERROR_NOT_SUPPORTED)
+			errx(1, "The TA is built without CFG_TA_TRACEPOINT=y");
+		if (res != TEEC_SUCCESS)
+			errx(1, "Trace: TEEC_InvokeCommand: %#" PRIx32
+			     " origin %#" PRIx32, res, ret_orig);
+
+		len = op.params[0].tmpref.size;
+		memcpy(&hdr, buf, sizeof(hdr));
+		if (fwrite(buf, len, 1, f) != 1)
+			err(1, "Trace: fwrite");
+		if (hdr.lost)
+			warnx("%" PRIu32 " tracepoints did not fit in the ring",
+			      hdr.lost);
+		/* A full buffer, there may be more */
+	} while (len + sizeof(struct tp_rec) > sizeof(buf));
+}
+
+static void check_result(const char *what, const struct result *r,
+			 uint64_t sum, uint32_t chunks)
+{
+	if (r->sum != sum || r->chunks != chunks)
+		errx(1, "%s: TA got %" PRIu32 " chunks summing to %#" PRIx64
+		     ", sent %" PRIu32 " summing to %#" PRIx64, what,
+		     r->chunks, r->sum, chunks, sum);
+}
+
+static double run_chunks(TEEC_Context *ctx, TEEC_Session *sess,
+			 const uint8_t *src, size_t total, size_t chunk,
+			 struct result *r)
+{
+	TEEC_SharedMemory shm = { };
+	TEEC_Operation op = { };
+	uint32_t ret_orig = 0;
+	TEEC_Result res = TEEC_SUCCESS;
+	uint32_t chunks = 0;
+	uint64_t sum = 0;
+	double t = 0;
+	size_t n = 0;
+
+	shm.size = chunk;
+	shm.flags = TEEC_MEM_INPUT;
+	res = TEEC_AllocateSharedMemory(ctx, &shm);
+	if (res != TEEC_SUCCESS)
+		errx(1, "TEEC_AllocateSharedMemory: %#" PRIx32, res);
+
+	op.paramTypes = TEEC_PARAM_TYPES(TEEC_MEMREF_WHOLE, TEEC_NONE,
+					 TEEC_NONE, TEEC_NONE);
+	op.params[0].memref.parent = &shm;
+
+	t = now();
+	for (n = 0; n + chunk <= total; n += chunk) {
+		memcpy(shm.buffer, src + n, chunk);
+		res = TEEC_InvokeCommand(sess, TA_STREAM_PERF_CMD_CHUNK, &op,
+					 &ret_orig);
+		if (res != TEEC_SUCCESS)
+			errx(1, "Chunk: TEEC_InvokeCommand: %#" PRIx32
+			     " origin %#" PRIx32, res, ret_orig);
+	}
+	t = now() - t;
+
+	TEEC_ReleaseSharedMemory(&shm);
+
+	for (n = 0; n + chunk <= total; n += chunk) {
+		sum += stream_perf_sum(src + n, chunk);
+		chunks++;
+	}
+	get_result(sess, r);
+	check_result("chunks", r, sum, chunks);
+
+	return t;
+}
+
+static void *bell_thread(void *arg)
+{
+	struct bell *bell = arg;
+	TEEC_Operation op = { };
+	TEEC_Result res = TEEC_SUCCESS;
+	uint32_t ret_orig = 0;
+
+	op.paramTypes = TEEC_PARAM_TYPES(TEEC_MEMREF_WHOLE, TEEC_NONE,
+					 TEEC_NONE, TEEC_NONE);
+	op.params[0].memref.parent = bell->shm;
+
+	pthread_mutex_lock(&bell->lock);
+	while (true) {
+		while (!bell->pending && !bell->stop)
+			pthread_cond_wait(&bell->cond, &bell->lock);
+		if (!bell->pending)
+			break;
+		bell->pending--;
+		bell->busy = true;
+		pthread_mutex_unlock(&bell->lock);
+
+		res = TEEC_InvokeCommand(bell->sess,
+					 TA_STREAM_PERF_CMD_DOORBELL, &op,
+					 &ret_orig);
+
+		pthread_mutex_lock(&bell->lock);
+		bell->busy = false;
+		if (res != TEEC_SUCCESS && bell->res == TEEC_SUCCESS) {
+			bell->res = res;
+			bell->ret_orig = ret_orig;
+		}
+		pthread_cond_broadcast(&bell->cond);
+	}
+	pthread_mutex_unlock(&bell->lock);
+
+	return NULL;
+}
+
+static void ring_doorbell(struct bell *bell)
+{
+	pthread_mutex_lock(&bell->lock);
+	if (bell->res != TEEC_SUCCESS)
+		errx(1, "Doorbell: TEEC_InvokeCommand: %#" PRIx32
+		     " origin %#" PRIx32, bell->res, bell->ret_orig);
+	bell->pending++;
+	pthread_cond_broadcast(&bell->cond);
+	pthread_mutex_unlock(&bell->lock);
+}
+
+static void *ring_reserve(struct ring *ring, size_t len)
+{
+	struct shm_ring_rec rec = { .len = len };
+	uint32_t pos = ring->head & (ring->size - 1);
+	uint32_t room = ring->size - pos;
+	uint32_t need = (sizeof(rec) + len + SHM_RING_ALIGN - 1) &
+			~(uint32_t)(SHM_RING_ALIGN - 1);
+	uint32_t total = need > room ? room + need : need;
+
+	if (total > ring->size - (ring->head - ring->tail)) {
+		ring->tail = __atomic_load_n(&ring->hdr->tail,
+					     __ATOMIC_ACQUIRE);
+		if (total > ring->size - (ring->head - ring->tail))
+			return NULL;
+	}
+
+	if (need > room) {
+		struct shm_ring_rec wrap = { .len = SHM_RING_REC_WRAP };
+
+		memcpy(ring->data + pos, &wrap, sizeof(wrap));
+		ring->head += room;
+		pos = 0;
+	}
+
+	memcpy(ring->data + pos, &rec, sizeof(rec));
+	ring->next = ring->head + need;
+
+	return ring->data + pos + sizeof(rec);
+}
+
+/* Returns true if the TA has to be woken up */
+static bool ring_commit(struct ring *ring)
+{
+	uint32_t state = SHM_RING_CONSUMER_IDLE;
+
+	__atomic_store_n(&ring->hdr->head, ring->head, __ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&ring->hdr->consumer, __ATOMIC_SEQ_CST) !=
+	    SHM_RING_CONSUMER_IDLE)
+		return false;
+
+	return __atomic_compare_exchange_n(&ring->hdr->consumer, &state,
+					   SHM_RING_CONSUMER_RUNNING, false,
+					   __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+static double run_ring(TEEC_Context *ctx, TEEC_Session *sess,
+		       const uint8_t *src, size_t total, size_t chunk,
+		       size_t ring_size, uint32_t flags, struct result *r)
+{
+	struct bell bell = {
+		.lock = PTHREAD_MUTEX_INITIALIZER,
+		.cond = PTHREAD_COND_INITIALIZER,
+		.sess = sess,
+	};
+	TEEC_SharedMemory shm = { };
+	TEEC_Result res = TEEC_SUCCESS;
+	struct ring ring = { };
+	pthread_t thread;
+	uint32_t chunks = 0;
+	uint64_t sum = 0;
+	uint8_t *p = NULL;
+	double t = 0;
+	size_t n = 0;
+
+	shm.size = sizeof(struct shm_ring_hdr) + ring_size;
+	shm.flags = TEEC_MEM_INPUT | TEEC_MEM_OUTPUT;
+	res = TEEC_AllocateSharedMemory(ctx, &shm);
+	if (res != TEEC_SUCCESS)
+		errx(1, "TEEC_AllocateSharedMemory: %#" PRIx32, res);
+
+	ring.hdr = shm.buffer;
+	ring.data = (uint8_t *)shm.buffer + sizeof(struct shm_ring_hdr);
+	ring.size = ring_size;
+	memset(ring.hdr, 0, sizeof(*ring.hdr));
+	ring.hdr->magic = SHM_RING_MAGIC;
+	ring.hdr->flags = flags;
+	ring.hdr->data_offs = sizeof(struct shm_ring_hdr);
+	ring.hdr->size = ring_size;
+	ring.hdr->consumer = SHM_RING_CONSUMER_IDLE;
+
+	bell.shm = &shm;
+	if (pthread_create(&thread, NULL, bell_thread, &bell))
+		errx(1, "pthread_create");
+
+	t = now();
+	for (n = 0; n + chunk <= total; n += chunk) {
+		while (!(p = ring_reserve(&ring, chunk))) {
+			/* Full, make sure the TA drains it */
+			if (ring_commit(&ring))
+				ring_doorbell(&bell);
+			sched_yield();
+		}
+		memcpy(p, src + n, chunk);
+		ring.head = ring.next;
+		if (ring_commit(&ring))
+			ring_doorbell(&bell);
+	}
+
+	/* Wait for the TA to empty the ring and return */
+	while (__atomic_load_n(&ring.hdr->tail, __ATOMIC_ACQUIRE) !=
+	       ring.head ||
+	       __atomic_load_n(&ring.hdr->consumer, __ATOMIC_ACQUIRE) !=
+	       SHM_RING_CONSUMER_IDLE)
+		sched_yield();
+	pthread_mutex_lock(&bell.lock);
+	while (bell.pending || bell.busy)
+		pthread_cond_wait(&bell.cond, &bell.lock);
+	bell.stop = true;
+	pthread_cond_broadcast(&bell.cond);
+	pthread_mutex_unlock(&bell.lock);
+	t = now() - t;
+
+	pthread_join(thread, NULL);
+	TEEC_ReleaseSharedMemory(&shm);
+	if (bell.res != TEEC_SUCCESS)
+		errx(1, "Doorbell: TEEC_InvokeCommand: %#" PRIx32
+		     " origin %#" PRIx32, bell.res, bell.ret_orig);
+
+	for (n = 0; n + chunk <= total; n += chunk) {
+		sum += stream_perf_sum(src + n, chunk);
+		chunks++;
+	}
+	get_result(sess, r);
+	check_result("ring", r, sum, chunks);
+
+	return t;
+}
+
+int main(int argc, char *argv[])
+{
+	TEEC_UUID uuid = TA_STREAM_PERF_UUID;
+	TEEC_Context ctx = { };
+	TEEC_Session sess = { };
+	uint32_t ret_orig = 0;
+	TEEC_Result res = TEEC_SUCCESS;
+	struct result chunk_res = { };
+	struct result ring_res = { };
+	size_t total = DEFAULT_TOTAL;
+	size_t ring_size = DEFAULT_RING;
+	size_t only = 0;
+	uint32_t flags = 0;
+	uint8_t *src = NULL;
+	FILE *trace = NULL;
+	double t_chunk = 0;
+	double t_ring = 0;
+	size_t chunk = 0;
+	size_t n = 0;
+	int opt = 0;
+
+	while ((opt = getopt(argc, argv, "ht:r:s:cT:")) != -1) {
+		switch (opt) {
+		case 't':
+			total = strtoul(optarg, NULL, 0);
+			break;
+		case 'r':
+			ring_size = strtoul(optarg, NULL, 0);
+			break;
+		case 's':
+			only = strtoul(optarg, NULL, 0);
+			break;
+		case 'c':
+			flags |= SHM_RING_F_NONCOHERENT;
+			break;
+		case 'T':
+			trace = fopen(optarg, "wb");
+			if (!trace)
+				err(1, "%s", optarg);
+			break;
+		case 'h':
+		default:
+			usage(argv[0]);
+			return opt == 'h' ? 0 : 1;
+		}
+	}
+
+	if (ring_size < 64 || ring_size & (ring_size - 1))
+		errx(1, "Ring size %zu is not a power of 2", ring_size);
+
+	src = malloc(total);
+	if (!src)
+		errx(1, "Out of memory");
+	for (n = 0; n < total; n++)
+		src[n] = rand();
+
+	res = TEEC_InitializeContext(NULL, &ctx);
+	if (res != TEEC_SUCCESS)
+		errx(1, "TEEC_InitializeContext: %#" PRIx32, res);
+
+	res = TEEC_OpenSession(&ctx, &sess, &uuid, TEEC_LOGIN_PUBLIC, NULL,
+			       NULL, &ret_orig);
+	if (res != TEEC_SUCCESS)
+		errx(1, "TEEC_OpenSession: %#" PRIx32 " origin %#" PRIx32,
+		     res, ret_orig);
+
+	printf("%8s  %12s %10s  %12s %10s  %7s\n", "chunk", "invoke MB/s",
+	       "invokes", "ring MB/s", "doorbells", "speedup");
+
+	for (n = 0; n < sizeof(chunk_sizes) / sizeof(chunk_sizes[0]); n++) {
+		chunk = chunk_sizes[n];
+		if ((only && chunk != only) || chunk > total ||
+		    chunk + 2 * sizeof(struct shm_ring_rec) > ring_size)
+			continue;
+
+		t_chunk = run_chunks(&ctx, &sess, src, total, chunk,
+				     &chunk_res);
+		if (trace)
+			save_trace(&sess, trace);
+		t_ring = run_ring(&ctx, &sess, src, total, chunk, ring_size,
+				  flags, &ring_res);
+		if (trace)
+			save_trace(&sess, trace);
+
+		printf("%8zu  %12.1f %10" PRIu32 "  %12.1f %10" PRIu32
+		       "  %6.1fx\n", chunk,
+		       chunk_res.chunks * chunk / t_chunk / 1e6,
+		       chunk_res.chunks,
+		       ring_res.chunks * chunk / t_ring / 1e6,
+		       ring_res.doorbells, t_chunk / t_ring);
+	}
+
+	TEEC_CloseSession(&sess);
+	TEEC_FinalizeContext(&ctx);
+	free(src);
+	if (trace && fclose(trace))
+		err(1, "Trace: fclose");
+
+	return 0;
+}
@@ -0,0 +1,265 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: BSD-2-Clause
+#
+# Copyright (c) 2026, D-Robotics
+#
+# Turns the records of a TA built with CFG_TA_BINLOG=y back into the
+# messages of its MSG(), EMSG(), IMSG(), DMSG(), FMSG() and DHEXDUMP(),
+# see ta/lib/ta_ext/include/binlog.h. The records come either from a
+# capture of the secure console, the lines binlog_flush() wrote, or from
+# buffers the TA returned with binlog_drain(). The formats are read from
+# the TA ELF, which has to be the one of the run.
+
+import argparse
+import base64
+import os
+import re
+import struct
+import sys
+
+MAGIC = 0x474c4e42
+HDR = struct.Struct('<IHHIIII')
+REC = struct.Struct('<QIHBB')
+
+LEVELS = {0: ' ', 1: 'E', 2: 'I', 3: 'D', 4: 'F'}
+
+CONSOLE_RE = re.compile(r'binlog ([0-9a-f]{8}-[0-9a-f]{4}-[0-9a-f]{4}-'
+                        r'[0-9a-f]{4}-[0-9a-f]{12}) ([A-Za-z0-9+/=]+)')
+UUID_RE = re.compile(r'[0-9a-f]{8}-[0-9a-f]{4}-[0-9a-f]{4}-[0-9a-f]{4}-'
+                     r'[0-9a-f]{12}')
+CONV_RE = re.compile(r'%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d*))?'
+                     r'(hh|h|ll|l|z|j|t|L)?([diouxXcsp%])')
+
+
+class Elf:
+    """ The loadable segments and the ta_head symbol of an ELF64 file """
+
+    def __init__(self, path):
+        with open(path, 'rb') as f:
+            self.data = f.read()
+        d = self.data
+        if d[:4] != b'\x7fELF' or d[4] != 2 or d[5] != 1:
+            sys.exit('{}: not a little endian ELF64 file'.format(path))
+        phoff, shoff = struct.unpack_from('<QQ', d, 0x20)
+        phentsize, phnum, shentsize, shnum = struct.unpack_from('<HHHH', d,
+                                                                0x36)
+
+        self.segs = []
+        for i in range(phnum):
+            (p_type, _, p_offset, p_vaddr, _, p_filesz,
+             _, _) = struct.unpack_from('<IIQQQQQQ', d, phoff + i * phentsize)
+            if p_type == 1:
+                self.segs.append((p_vaddr, p_filesz, p_offset))
+
+        # Records are relative to ta_head, at 0 unless the symbol says
+        # otherwise
+        self.base = 0
+        shdrs = [struct.unpack_from('<IIQQQQIIQQ', d, shoff + i * shentsize)
+                 for i in range(shnum)]
+        for sh in shdrs:
+            if sh[1] != 2:
+                continue
+            strtab = shdrs[sh[6]]
+            for offs in range(sh[4], sh[4] + sh[5], 24):
+                name, _, _, _, value, _ = struct.unpack_from('<IBBHQQ', d,
+                                                             offs)
+                if self.cstr(strtab[4] + name) == b'ta_head':
+                    self.base = value
+
+    def cstr(self, offs):
+        end = self.data.index(b'\0', offs)
+        return self.data[offs:end]
+
+    def file_offset(self, vaddr):
+        for start, size, offs in self.segs:
+            if start <= vaddr < start + size:
+                return offs + vaddr - start
+        return None
+
+
+class Sites:
+    def __init__(self, elf):
+        self.elf = elf
+        self.cache = {}
+
+    def get(self, site):
+        if site not in self.cache:
+            self.cache[site] = self.parse(site)
+        return self.cache[site]
+
+    def parse(self, site):
+        offs = self.elf.file_offset(self.elf.base + site)
+        if offs is None:
+            return None
+        fields = []
+        for _ in range(4):
+            s = self.elf.cstr(offs)
+            fields.append(s.decode(errors='replace'))
+            offs += len(s) + 1
+        kind_level, fname, line, fmt = fields
+        if not kind_level or kind_level[0] not in 'mrx':
+            return None
+        return (kind_level[0], int(kind_level[1:] or 0),
+                os.path.basename(fname), line, fmt)
+
+
+def to_signed(v, bits):
+    v &= (1 << bits) - 1
+    return v - (1 << bits) if v >> (bits - 1) else v
+
+
+# Formats already warned about
+warned = set()
+
+
+def format_msg(fmt, args):
+    """ printf() of the format of the TA with the values recorded """
+    out = []
+    pos = 0
+    it = iter(args)
+
+    def next_arg():
+        return next(it, (0, False))
+
+    for m in CONV_RE.finditer(fmt):
+        out.append(fmt[pos:m.start()])
+        pos = m.end()
+        flags, width, prec, length, conv = m.groups()
+        if conv == '%':
+            out.append('%')
+            continue
+        if width == '*':
+            width = str(to_signed(next_arg()[0], 32))
+        if prec == '*':
+            prec = str(to_signed(next_arg()[0], 32))
+        spec = '%' + flags + (width or '') + \
+            ('.' + prec if prec is not None else '')
+        v, is_str = next_arg()
+        bits = {'hh': 8, 'h': 16, None: 32}.get(length, 64)
+        if conv == 's':
+            s = v.decode(errors='replace') if is_str else \
+                '<0x{:x}>'.format(v)
+            out.append((spec + 's') % s)
+        elif is_str:
+            # A char * for %p or an integer conversion: the TA recorded
+            # the string, not the value
+            if fmt not in warned:
+                warned.add(fmt)
+                print('warning: string recorded for %{} in "{}", cast the '
+                      'argument to void *'.format(conv, fmt.rstrip('\n')),
+                      file=sys.stderr)
+            out.append('<str "{}">'.format(v.decode(errors='replace')))
+        elif conv in 'di':
+            out.append((spec + 'd') % to_signed(v, bits))
+        elif conv in 'ouxX':
+            out.append((spec + conv.replace('u', 'd')) %
+                       (v & ((1 << bits) - 1)))
+        elif conv == 'c':
+            out.append((spec + 'c') % chr(v & 0xff))
+        elif conv == 'p':
+            out.append((spec + 's') % '0x{:x}'.format(v))
+    out.append(fmt[pos:])
+    return ''.join(out)
+
+
+def hexdump(data):
+    return ['{:04x}: {}'.format(i, ' '.join('{:02x}'.format(b)
+                                              for b in data[i:i + 16]))
+            for i in range(0, len(data), 16)]
+
+
+def batches(data, name):
+    """ Yields the header and records of each batch in @data """
+    offs = 0
+    while offs + HDR.size <= len(data):
+        (magic, version, hdr_size, freq, size, lost,
+         _) = HDR.unpack_from(data, offs)
+        if magic != MAGIC:
+            sys.exit('{}: no batch at offset {}'.format(name, offs))
+        if version != 1:
+            sys.exit('{}: batch version {}'.format(name, version))
+        offs += hdr_size
+        end = offs + size
+        recs = []
+        while offs < end:
+            time, site, rsize, nargs, strs = REC.unpack_from(data, offs)
+            if rsize < REC.size or offs + rsize > end:
+                sys.exit('{}: corrupt record at offset {}'.format(name,
+                                                                  offs))
+            vals = struct.unpack_from('<{}Q'.format(nargs), data,
+                                      offs + REC.size)
+            p = offs + REC.size + 8 * nargs
+            args = []
+            for n, v in enumerate(vals):
+                if strs & (1 << n):
+                    args.append((data[p:p + v], True))
+                    p += v
+                else:
+                    args.append((v, False))
+            recs.append((time, site, args))
+            offs += rsize
+        yield freq, lost, recs
+
+
+def console_bytes(text, uuid, name):
+    streams = {}
+    for m in CONSOLE_RE.finditer(text):
+        streams.setdefault(m.group(1), []).append(m.group(2))
+    if uuid:
+        lines = streams.get(uuid, [])
+    elif len(streams) > 1:
+        sys.exit('{}: records of {}, pick one with --uuid'.format(
+            name, ', '.join(sorted(streams))))
+    else:
+        lines = next(iter(streams.values()), [])
+    return b''.join(base64.b64decode(s) for s in lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Messages of a TA built with CFG_TA_BINLOG=y')
+    parser.add_argument('inputs', nargs='+',
+                        help='console captures or drained buffers, in order')
+    parser.add_argument('--elf', required=True,
+                        help='TA ELF, <uuid>.elf of the TA build')
+    parser.add_argument('--uuid', help='TA of the console lines to decode '
+                        '(default: from the ELF file name)')
+    args = parser.parse_args()
+
+    uuid = args.uuid
+    if not uuid:
+        m = UUID_RE.match(os.path.basename(args.elf))
+        uuid = m.group(0) if m else None
+
+    sites = Sites(Elf(args.elf))
+    t0 = None
+    for name in args.inputs:
+        with open(name, 'rb') as f:
+            data = f.read()
+        if len(data) < 4 or struct.unpack_from('<I', data)[0] != MAGIC:
+            data = console_bytes(data.decode(errors='replace'), uuid, name)
+
+        for freq, lost, recs in batches(data, name):
+            if lost:
+                print('-- {} records lost --'.format(lost))
+            for time, site, rargs in recs:
+                if t0 is None:
+                    t0 = time
+                s = sites.get(site)
+                stamp = '[{:12.6f}]'.format((time - t0) / freq)
+                if not s:
+                    print('{} ?/TA: unknown site 0x{:x}'.format(stamp, site))
+                    continue
+                kind, level, fname, line, fmt = s
+                prefix = '{} {}/TA: '.format(stamp, LEVELS.get(level, '?'))
+                if kind == 'x':
+                    for ln in hexdump(rargs[0][0] if rargs else b''):
+                        print(prefix + ln)
+                    continue
+                if kind == 'm':
+                    prefix += '{}:{} '.format(fname, line)
+                print(prefix + format_msg(fmt, rargs).rstrip('\n'))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,263 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: BSD-2-Clause
+#
+# Copyright (c) 2026, D-Robotics
+#
+# Compiles NIST CAVP .rsp files into the binary vector table consumed by
+# TA_CRYPTO_PERF_CMD_KAT, see ta/demo/crypto_perf/include/ta_crypto_perf.h
+# for the layout.
+
+import os
+import re
+import struct
+import sys
+
+TABLE_MAGIC = 0x42564143        # "CAVB"
+TABLE_VERSION = 1
+
+# struct crypto_perf_vec_hdr: size, algo, mode, flags, line and the
+# lengths of the key, iv, aad, in, out and tag fields
+REC_FMT = '<11I'
+FIELDS = ('key', 'iv', 'aad', 'in', 'out', 'tag')
+
+VEC_FLAG_FAIL = 0x1
+
+# TEE_OperationMode
+TEE_MODE_ENCRYPT = 0
+TEE_MODE_DECRYPT = 1
+TEE_MODE_MAC = 4
+TEE_MODE_DIGEST = 5
+
+# Not a GP algorithm, must match TA_CRYPTO_PERF_ALG_CHACHA20_POLY1305
+ALG_CHACHA20_POLY1305 = 0xf0000001
+# The software SM4 of ta/lib/mbedtls_ext, TA_CRYPTO_PERF_ALG_SM4_SW_*
+ALG_SM4_SW_ECB = 0xf000000a
+ALG_SM4_SW_CBC = 0xf000000b
+ALG_SM4_SW_CTR = 0xf000000c
+ALG_SM4_SW_XTS = 0xf000000d
+# SM3 of libmbedtls and of ta/lib/mbedtls_ext, TA_CRYPTO_PERF_ALG_SM3_*
+ALG_SM3_MBEDTLS = 0xf000000e
+ALG_SM3_MB = 0xf000000f
+# AES of ta/lib/mbedtls_ext, TA_CRYPTO_PERF_ALG_AES_CE_*
+ALG_AES_CE_ECB = 0xf0000012
+ALG_AES_CE_CBC = 0xf0000013
+ALG_AES_CE_CTR = 0xf0000014
+ALG_AES_CE_XTS = 0xf0000015
+ALG_AES_CE_GCM = 0xf0000016
+# SHA-2 of ta/lib/mbedtls_ext, TA_CRYPTO_PERF_ALG_SHA*_CE
+ALG_SHA256_CE = 0xf0000017
+ALG_SHA512_CE = 0xf0000018
+# ChaCha20-Poly1305 of ta/lib/mbedtls_ext, TA_CRYPTO_PERF_ALG_*_NEON
+ALG_CHACHA20_POLY1305_NEON = 0xf0000019
+
+algs = {
+    'aes-ecb': 0x10000010,
+    'aes-cbc': 0x10000110,
+    'aes-ctr': 0x10000210,
+    'aes-xts': 0x10000410,
+    'aes-gcm': 0x40000810,
+    'aes-ce-ecb': ALG_AES_CE_ECB,
+    'aes-ce-cbc': ALG_AES_CE_CBC,
+    'aes-ce-ctr': ALG_AES_CE_CTR,
+    'aes-ce-xts': ALG_AES_CE_XTS,
+    'aes-ce-gcm': ALG_AES_CE_GCM,
+    'sm4-ecb': 0x10000014,
+    'sm4-cbc': 0x10000114,
+    'sm4-ctr': 0x10000214,
+    'sm4-xts': 0x10000414,
+    'sm4-sw-ecb': ALG_SM4_SW_ECB,
+    'sm4-sw-cbc': ALG_SM4_SW_CBC,
+    'sm4-sw-ctr': ALG_SM4_SW_CTR,
+    'sm4-sw-xts': ALG_SM4_SW_XTS,
+    'sha1': 0x50000002,
+    'sha224': 0x50000003,
+    'sha256': 0x50000004,
+    'sha384': 0x50000005,
+    'sha512': 0x50000006,
+    'sha256-ce': ALG_SHA256_CE,
+    'sha512-ce': ALG_SHA512_CE,
+    'sm3': 0x50000007,
+    'sm3-mbedtls': ALG_SM3_MBEDTLS,
+    'sm3-mb': ALG_SM3_MB,
+    'hmac-sha1': 0x30000002,
+    'hmac-sha224': 0x30000003,
+    'hmac-sha256': 0x30000004,
+    'hmac-sha384': 0x30000005,
+    'hmac-sha512': 0x30000006,
+    'hmac-sm3': 0x30000007,
+    'chacha20-poly1305': ALG_CHACHA20_POLY1305,
+    'chacha20-poly1305-neon': ALG_CHACHA20_POLY1305_NEON,
+}
+
+# HMAC.rsp holds all hashes, selected by the [L=<digest size>] sections
+hmac_by_len = {
+    20: 'hmac-sha1',
+    28: 'hmac-sha224',
+    32: 'hmac-sha256',
+    48: 'hmac-sha384',
+    64: 'hmac-sha512',
+}
+
+# Spellings used by the different CAVP suites (and by the hand written
+# files for algorithms that have no CAVP suite)
+field_names = {
+    'KEY': 'key', 'Key': 'key',
+    'IV': 'iv', 'i': 'iv', 'Nonce': 'iv',
+    'AAD': 'aad', 'Adata': 'aad',
+    'PLAINTEXT': 'pt', 'PT': 'pt', 'Msg': 'pt',
+    'CIPHERTEXT': 'ct', 'CT': 'ct',
+    'MD': 'md', 'Mac': 'md',
+    'Tag': 'tag',
+}
+
+
+def alg_class(name):
+    if name.startswith(('sha', 'sm3')):
+        return 'digest'
+    if name.startswith('hmac'):
+        return 'mac'
+    if name.endswith('-gcm') or name.startswith('chacha20-poly1305'):
+        return 'ae'
+    return 'cipher'
+
+
+def parse_rsp(name, path, limited):
+    """ Yields (alg name, mode, flags, line, fields) for each vector """
+
+    mode = TEE_MODE_ENCRYPT
+    sect_len = None
+    rec = {}
+
+    def vector():
+        alg = name
+        if alg == 'hmac':
+            alg = hmac_by_len.get(sect_len)
+            if not alg:
+                return None
+        if limited and rec.get('COUNT', rec.get('Count', '0')) != '0':
+            return None
+
+        cls = alg_class(alg)
+        v = {f: b'' for f in FIELDS + ('_pt', '_ct', '_md')}
+        for k, f in field_names.items():
+            if k in rec:
+                v[f if f in FIELDS else '_' + f] = bytes.fromhex(rec[k])
+
+        if cls == 'digest':
+            # Len is in bits, Msg is 00 for the empty message
+            bits = int(rec.get('Len', len(v['_pt']) * 8))
+            if bits % 8:
+                return None
+            v['in'] = v['_pt'][:bits // 8]
+            v['out'] = v['_md']
+            vmode = TEE_MODE_DIGEST
+        elif cls == 'mac':
+            v['in'] = v['_pt']
+            v['out'] = v['_md']
+            vmode = TEE_MODE_MAC
+        else:
+            if 'DataUnitLen' in rec and int(rec['DataUnitLen']) % 8:
+                return None
+            if mode == TEE_MODE_ENCRYPT:
+                v['in'], v['out'] = v['_pt'], v['_ct']
+            else:
+                v['in'], v['out'] = v['_ct'], v['_pt']
+            vmode = mode
+
+        flags = VEC_FLAG_FAIL if 'FAIL' in rec else 0
+        return (alg, vmode, flags, rec['_line'], v)
+
+    with open(path, 'r') as f:
+        for line_num, line in enumerate(f, 1):
+            line = line.strip()
+            if line.startswith('#'):
+                continue
+
+            if not line:
+                if rec:
+                    v = vector()
+                    if v:
+                        yield v
+                rec = {}
+                continue
+
+            m = re.match(r'^\[(.*)\]$', line)
+            if m:
+                s = m.group(1).replace(' ', '')
+                if s == 'ENCRYPT':
+                    mode = TEE_MODE_ENCRYPT
+                elif s == 'DECRYPT':
+                    mode = TEE_MODE_DECRYPT
+                elif s.startswith('L='):
+                    sect_len = int(s[2:])
+                continue
+
+            if not rec:
+                rec['_line'] = line_num
+            m = re.match(r'^(\w+)\s*=\s*(\w*)$', line)
+            if m:
+                rec[m.group(1)] = m.group(2)
+            elif line == 'FAIL':
+                rec['FAIL'] = True
+            else:
+                raise Exception('{}:{}: cannot parse "{}"'.format(
+                                path, line_num, line))
+
+    if rec:
+        v = vector()
+        if v:
+            yield v
+
+
+def pack_vector(alg, mode, flags, line, v):
+    data = b''.join(v[f] for f in FIELDS)
+    size = struct.calcsize(REC_FMT) + len(data)
+    pad = -size % 4
+    hdr = struct.pack(REC_FMT, size + pad, algs[alg], mode, flags, line,
+                      *[len(v[f]) for f in FIELDS])
+    return hdr + data + bytes(pad)
+
+
+def get_args():
+    import argparse
+
+    parser = argparse.ArgumentParser(
+        formatter_class=argparse.RawDescriptionHelpFormatter,
+        epilog='Algorithms: hmac (selects the hash from the [L=n] '
+        'sections of HMAC.rsp), ' + ', '.join(sorted(algs.keys())) + '\n\n'
+        'Example:\n'
+        '  cavp_to_bin.py --out kat.bin aes-cbc:CBCMMT128.rsp \\\n'
+        '      sha256:SHA256ShortMsg.rsp hmac:HMAC.rsp')
+
+    parser.add_argument('--out', required=True,
+                        help='Name of output binary vector table')
+    parser.add_argument('--limited', action='store_true',
+                        help='Only keep one test case from each group')
+    parser.add_argument('inf', nargs='+', metavar='ALG:RSP',
+                        help='Algorithm and name of input RSP file')
+
+    return parser.parse_args()
+
+
+def main():
+    args = get_args()
+    recs = []
+
+    for spec in args.inf:
+        name, sep, path = spec.partition(':')
+        if not sep or (name != 'hmac' and name not in algs):
+            sys.exit('Bad input "{}", expected ALG:RSP'.format(spec))
+        if re.search('MCT|Monte', os.path.basename(path)):
+            sys.exit('{}: Monte Carlo tests are not supported'.format(path))
+        for alg, mode, flags, line, v in parse_rsp(name, path,
+                                                   args.limited):
+            recs.append(pack_vector(alg, mode, flags, line, v))
+
+    with open(args.out, 'wb') as f:
+        f.write(struct.pack('<4I', TABLE_MAGIC, TABLE_VERSION, len(recs), 0))
+        for r in recs:
+            f.write(r)
+
+
+if __name__ == "__main__":
+    main()
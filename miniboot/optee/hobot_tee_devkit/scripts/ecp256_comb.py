@@ -0,0 +1,148 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: BSD-2-Clause
+#
+# Copyright (c) 2026, D-Robotics
+#
+# Generates ta/lib/mbedtls_ext/ecp256_tables.inc: the Montgomery constants
+# of SECP256R1 and SM2P256V1 and the fixed-base comb tables of their
+# generators used by ta/lib/mbedtls_ext/ecp256.c.
+#
+# The comb has ECP256_COMB_TEETH teeth spaced ECP256_COMB_SPACING bits
+# apart: entry i - 1 of the table is the sum of 2^(SPACING * j) * G over
+# the bits j set in i, as an affine point in the Montgomery domain.
+
+import argparse
+
+COMB_TEETH = 8
+COMB_SPACING = 32
+
+curves = {
+    'secp256r1': {
+        'p': 0xFFFFFFFF00000001000000000000000000000000FFFFFFFFFFFFFFFFFFFFFFFF,
+        'b': 0x5AC635D8AA3A93E7B3EBBD55769886BC651D06B0CC53B0F63BCE3C3E27D2604B,
+        'n': 0xFFFFFFFF00000000FFFFFFFFFFFFFFFFBCE6FAADA7179E84F3B9CAC2FC632551,
+        'gx': 0x6B17D1F2E12C4247F8BCE6E563A440F277037D812DEB33A0F4A13945D898C296,
+        'gy': 0x4FE342E2FE1A7F9B8EE7EB4A7C0F9E162BCE33576B315ECECBB6406837BF51F5,
+    },
+    'sm2p256v1': {
+        'p': 0xFFFFFFFEFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF00000000FFFFFFFFFFFFFFFF,
+        'b': 0x28E9FA9E9D9F5E344D5A9E4BCF6509A7F39789F515AB8F92DDBCBD414D940E93,
+        'n': 0xFFFFFFFEFFFFFFFFFFFFFFFFFFFFFFFF7203DF6B21C6052B53BBF40939D54123,
+        'gx': 0x32C4AE2C1F1981195F9904466A39C9948FE30BBFF2660BE1715A4589334C74C7,
+        'gy': 0xBC3736A2F4F6779C59BDCEE36B692153D0A9877CC62A474002DF32E52139F0A0,
+    },
+}
+
+R = 1 << 256
+
+
+def get_args():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('--out', required=True, help='Name of the .inc file')
+    return parser.parse_args()
+
+
+def add(c, P, Q):
+    """ Affine addition on y^2 = x^3 - 3x + b, None being the infinity """
+    p = c['p']
+    if P is None:
+        return Q
+    if Q is None:
+        return P
+    if P[0] == Q[0]:
+        if (P[1] + Q[1]) % p == 0:
+            return None
+        lam = (3 * P[0] * P[0] - 3) * pow(2 * P[1], -1, p) % p
+    else:
+        lam = (Q[1] - P[1]) * pow(Q[0] - P[0], -1, p) % p
+    x = (lam * lam - P[0] - Q[0]) % p
+    return (x, (lam * (P[0] - x) - P[1]) % p)
+
+
+def mul(c, k, P):
+    Q = None
+    for bit in bin(k)[2:]:
+        Q = add(c, Q, Q)
+        if bit == '1':
+            Q = add(c, Q, P)
+    return Q
+
+
+def check_curve(name, c):
+    p, G = c['p'], (c['gx'], c['gy'])
+    assert (G[1] ** 2 - G[0] ** 3 + 3 * G[0] - c['b']) % p == 0, name
+    assert mul(c, c['n'], G) is None, name
+
+
+def limbs(x):
+    return ['0x%016XULL' % ((x >> (64 * i)) & (2 ** 64 - 1))
+            for i in range(4)]
+
+
+def c_array(name, x):
+    xl = limbs(x)
+    return ['static const uint64_t %s[4] =' % name, '{',
+            '    ' + ', '.join(xl[:2]) + ',',
+            '    ' + ', '.join(xl[2:]) + ',',
+            '};']
+
+
+def comb_table(c):
+    G = (c['gx'], c['gy'])
+    teeth = [mul(c, 1 << (COMB_SPACING * j), G) for j in range(COMB_TEETH)]
+    table = []
+    for i in range(1, 1 << COMB_TEETH):
+        P = None
+        for j in range(COMB_TEETH):
+            if i >> j & 1:
+                P = add(c, P, teeth[j])
+        table.append(P)
+    return table
+
+
+def main():
+    args = get_args()
+    out = [
+        '/*',
+        ' * Generated by scripts/ecp256_comb.py, do not edit',
+        ' *',
+        ' * Copyright (c) 2026, D-Robotics',
+        ' * SPDX-License-Identifier: BSD-2-Clause',
+        ' */',
+        '',
+        '#define ECP256_COMB_TEETH       %d' % COMB_TEETH,
+        '#define ECP256_COMB_SPACING     %d' % COMB_SPACING,
+    ]
+
+    for name, c in curves.items():
+        check_curve(name, c)
+        p, n = c['p'], c['n']
+        pre = 'ecp256_' + name
+        out += ['', '/*', ' * %s' % name.upper(), ' */']
+        out += c_array(pre + '_p', p)
+        out += c_array(pre + '_p_rr', R * R % p)
+        out += c_array(pre + '_p_one', R % p)
+        out += c_array(pre + '_b', c['b'] * R % p)
+        out += c_array(pre + '_n', n)
+        out += c_array(pre + '_n_rr', R * R % n)
+        out.append('#define ECP256_%s_P_N0    0x%016XULL' %
+                   (name.upper(), -pow(p, -1, 2 ** 64) % 2 ** 64))
+        out.append('#define ECP256_%s_N_N0    0x%016XULL' %
+                   (name.upper(), -pow(n, -1, 2 ** 64) % 2 ** 64))
+        out += ['', '/* Comb table of the generator, x and y */',
+                'static const uint64_t %s_comb[%d][8] =' %
+                (pre, (1 << COMB_TEETH) - 1), '{']
+        for x, y in comb_table(c):
+            xl, yl = limbs(x * R % p), limbs(y * R % p)
+            out.append('    { ' + ', '.join(xl[:2]) + ',')
+            out.append('      ' + ', '.join(xl[2:]) + ',')
+            out.append('      ' + ', '.join(yl[:2]) + ',')
+            out.append('      ' + ', '.join(yl[2:]) + ' },')
+        out.append('};')
+
+    with open(args.out, 'w') as f:
+        f.write('\n'.join(out) + '\n')
+
+
+if __name__ == '__main__':
+    main()
@@ -4,6 +4,18 @@
 # Copyright (c) 2018, Linaro Limited
 #
 
+import os
+
+# LZ4 block format constants
+LZ4_MIN_MATCH = 4
+LZ4_LAST_LITERALS = 5
+LZ4_MF_LIMIT = 12
+LZ4_MAX_OFFSET = 65535
+
+# Must match TA_ASSET_COMPRESS_* in ta/lib/ta_ext/include/ta_asset.h
+compress_types = {'none': 0, 'lz4': 1}
+
+
 def get_args():
     import argparse
 
@@ -12,38 +24,144 @@ def get_args():
                         help='Name of variable in C file')
     parser.add_argument('--out', required=True, help='Name of C file')
     parser.add_argument('--inf', required=True, help='Name of in file')
+    parser.add_argument('--format', default='c', choices=['c', 'incbin'],
+                        help='c: a const uint8_t array, NUL terminated, '
+                        'and its size. incbin: an assembly file defining a '
+                        'struct ta_asset, the payload being included with '
+                        '.incbin. Defaults to c.')
+    parser.add_argument('--compress', default='none',
+                        choices=list(compress_types.keys()),
+                        help='Compress the payload, only with --format '
+                        'incbin. Defaults to none.')
 
     return parser.parse_args()
 
 
-def main():
-    import array
+def lz4_compress(data):
+    """ Greedy LZ4 block compressor, see ta/lib/ta_ext/lz4.c """
+
+    def put_length(out, n):
+        while n >= 255:
+            out.append(255)
+            n -= 255
+        out.append(n)
+
+    def put_sequence(out, lit, match_len, offs):
+        lit_len = len(lit)
+        token = min(lit_len, 15) << 4
+        if match_len:
+            token |= min(match_len - LZ4_MIN_MATCH, 15)
+        out.append(token)
+        if lit_len >= 15:
+            put_length(out, lit_len - 15)
+        out += lit
+        if match_len:
+            out.append(offs & 0xff)
+            out.append(offs >> 8)
+            if match_len - LZ4_MIN_MATCH >= 15:
+                put_length(out, match_len - LZ4_MIN_MATCH - 15)
+
+    out = bytearray()
+    n = len(data)
+    table = {}
+    anchor = 0
+    pos = 0
+    # The format requires the last match to start at least LZ4_MF_LIMIT
+    # bytes before the end and the last LZ4_LAST_LITERALS bytes to be
+    # literals.
+    limit = n - LZ4_MF_LIMIT
+    while pos < limit:
+        key = data[pos:pos + LZ4_MIN_MATCH]
+        cand = table.get(key)
+        table[key] = pos
+        if cand is None or pos - cand > LZ4_MAX_OFFSET:
+            pos += 1
+            continue
+        match_end = pos + LZ4_MIN_MATCH
+        max_end = n - LZ4_LAST_LITERALS
+        while (match_end < max_end and
+               data[match_end] == data[cand + match_end - pos]):
+            match_end += 1
+        # Extend the match backwards over pending literals
+        while (pos > anchor and cand > 0 and
+               data[pos - 1] == data[cand - 1]):
+            pos -= 1
+            cand -= 1
+        put_sequence(out, data[anchor:pos], match_end - pos, pos - cand)
+        for p in range(pos + 1, min(match_end, limit)):
+            table[data[p:p + LZ4_MIN_MATCH]] = p
+        pos = match_end
+        anchor = pos
+    put_sequence(out, data[anchor:], 0, 0)
+
+    return bytes(out)
+
 
+def write_c(args, data):
+    with open(args.out, 'w') as f:
+        f.write("/* automatically generated */\n")
+        f.write("#include <stdint.h>\n")
+        f.write("#include <stddef.h>\n\n")
+
+        f.write("const uint8_t " + args.name + "[] = {\n")
+        for i in range(0, len(data), 8):
+            f.write(", ".join("0x{:02x}".format(x)
+                              for x in data[i:i + 8]) + ",\n")
+        f.write("'\\0'};\n")
+        f.write("const size_t " + args.name + "_size = sizeof(" +
+                args.name + ") - 1;\n")
+
+
+def write_incbin(args, data):
+    compress = compress_types[args.compress]
+    if args.compress == 'lz4':
+        payload = lz4_compress(data)
+    else:
+        payload = data
+
+    # .incbin needs a file holding exactly the payload. The input file is
+    # used as is when it isn't compressed, which keeps the output small.
+    if payload is data:
+        bin_path = os.path.abspath(args.inf)
+    else:
+        bin_path = os.path.abspath(args.out) + '.bin'
+        with open(bin_path, 'wb') as f:
+            f.write(payload)
+
+    name = args.name
+    with open(args.out, 'w') as f:
+        f.write("/* automatically generated */\n")
+        f.write("\t.section .rodata.ta_asset.{}, \"a\"\n".format(name))
+        f.write("\t.balign 16\n")
+        f.write("{}_data:\n".format(name))
+        f.write("\t.incbin \"{}\"\n".format(bin_path))
+        f.write("{}_data_end:\n\n".format(name))
+        f.write("\t.section .data.ta_asset.{}, \"aw\"\n".format(name))
+        f.write("\t.balign 8\n")
+        f.write("\t.global {}\n".format(name))
+        f.write("\t.type {}, %object\n".format(name))
+        f.write("{}:\n".format(name))
+        f.write("\t.dc.a {}_data\n".format(name))
+        f.write("\t.dc.a {0}_data_end - {0}_data\n".format(name))
+        f.write("\t.dc.a {}\n".format(len(data)))
+        f.write("\t.long {}\n".format(compress))
+        f.write("\t.long 0\n")
+        f.write("\t.dc.a 0\n")
+        f.write("\t.size {0}, . - {0}\n".format(name))
+
+
+def main():
     args = get_args()
 
-    inf = open(args.inf, 'r')
-    f = open(args.out, 'w')
-
-    f.write("/* automatically generated */\n")
-    f.write("#include <stdint.h>\n")
-    f.write("#include <stddef.h>\n\n")
-
-    f.write("const uint8_t " + args.name + "[] = {\n")
-    i = 0
-    for x in array.array("B", map(ord, (inf.read()))):
-        f.write("0x" + '{0:02x}'.format(x) + ",")
-        i = i + 1
-        if i % 8 == 0:
-            f.write("\n")
-        else:
-            f.write(" ")
-
-    f.write("'\\0'};\n")
-    f.write("const size_t " + args.name + "_size = sizeof(" + 
-            args.name + ") - 1;\n")
-
-    f.close()
-    inf.close()
+    with open(args.inf, 'rb') as inf:
+        data = inf.read()
+
+    if args.format == 'c':
+        if args.compress != 'none':
+            raise Exception('--compress needs --format incbin')
+        write_c(args, data)
+    else:
+        write_incbin(args, data)
 
 
 if __name__ == "__main__":
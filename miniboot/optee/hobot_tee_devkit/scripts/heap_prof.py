@@ -0,0 +1,321 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: BSD-2-Clause
+#
+# Copyright (c) 2026, D-Robotics
+#
+# Reads the buffers a TA built with CFG_TA_HEAP_PROF=y drained with
+# heap_prof_drain(), see ta/lib/ta_ext/include/heap_prof.h, and reports
+# the heap usage over time, the peak usage per allocation site and the
+# fragmentation of ta_heap. Pass the buffers of a run in the order they
+# were drained, typically one per command so that the per-buffer table
+# tells which command grows or fragments the heap.
+
+import argparse
+import os
+import struct
+import subprocess
+import sys
+
+MAGIC = 0x46525048
+HDR = struct.Struct('<IHHIIIIIIQ')
+SITE = struct.Struct('<HHIQ')
+EVENT = struct.Struct('<IIIHBB')
+
+EV_ALLOC = 1
+EV_FREE = 2
+EV_REALLOC_FREE = 3
+EV_REALLOC_ALLOC = 4
+EV_TIME = 5
+EV_LOST = 6
+OFFSET_NONE = 0xffffffff
+
+MAP_CHARS = ' .:+#'
+
+
+class Drain:
+    def __init__(self, name, hdr, sites, events):
+        self.name = name
+        (self.magic, self.version, self.hdr_size, self.freq, self.heap_size,
+         self.nsites, self.nevents, self.lost, _, self.time) = hdr
+        self.sites = sites
+        self.events = events
+
+
+def read_drain(path):
+    with open(path, 'rb') as f:
+        data = f.read()
+    if len(data) < HDR.size:
+        sys.exit('{}: too short'.format(path))
+    hdr = HDR.unpack_from(data)
+    if hdr[0] != MAGIC:
+        sys.exit('{}: not a heap profile'.format(path))
+    offs = hdr[2]
+
+    sites = {}
+    for _ in range(hdr[5]):
+        sid, name_len, line, addr = SITE.unpack_from(data, offs)
+        name = data[offs + SITE.size:offs + SITE.size + name_len]
+        sites[sid] = (name.decode(errors='replace'), line, addr)
+        offs += (SITE.size + name_len + 7) & ~7
+
+    events = [EVENT.unpack_from(data, offs + i * EVENT.size)
+              for i in range(hdr[6])]
+    return Drain(os.path.basename(path), hdr, sites, events)
+
+
+def resolve(sites, elf, cross_compile):
+    """ Names the sites, file:line for the mdbg hooks and the function and
+    line addr2line finds in the TA ELF for return addresses """
+
+    names = {0: '(sites table full)'}
+    addrs = sorted({a for n, _, a in sites.values() if not n})
+    lines = {}
+    if elf and addrs:
+        cmd = [cross_compile + 'addr2line', '-e', elf, '-f', '-C', '-s']
+        try:
+            out = subprocess.run(cmd + ['0x{:x}'.format(a) for a in addrs],
+                                 stdout=subprocess.PIPE, check=True,
+                                 universal_newlines=True).stdout.splitlines()
+        except (OSError, subprocess.CalledProcessError) as e:
+            print('warning: {} failed, sites are left as addresses ({})'
+                  .format(cmd[0], getattr(e, 'strerror', None) or
+                          'exit status {}'.format(e.returncode)),
+                  file=sys.stderr)
+            out = []
+        for i, a in enumerate(addrs[:len(out) // 2]):
+            lines[a] = '{} {}'.format(out[2 * i], out[2 * i + 1])
+
+    for sid, (name, line, addr) in sites.items():
+        if name:
+            names[sid] = '{}:{}'.format(name, line)
+        else:
+            names[sid] = lines.get(addr, '0x{:x}'.format(addr))
+    return names
+
+
+class Heap:
+    def __init__(self, size):
+        self.size = size
+        self.live = {}          # offset: (size, site)
+        self.bytes = 0
+        self.extent = 0
+        self.stale = 0          # Blocks allocated over a live one
+        self.unknown = 0        # Frees of blocks never seen allocated
+        self.outside = 0        # Blocks outside of ta_heap
+        self.lost = []          # [start, end, events] of the dropped spans
+
+    def alloc(self, offset, size, site):
+        if offset == OFFSET_NONE:
+            self.outside += 1
+            return
+        if offset in self.live:
+            self.stale += 1
+            self.free(offset)
+        self.live[offset] = (size, site)
+        self.bytes += size
+        self.extent = max(self.extent, offset + size)
+
+    def free(self, offset):
+        if offset == OFFSET_NONE:
+            return None
+        blk = self.live.pop(offset, None)
+        if blk is None:
+            self.unknown += 1
+            return None
+        self.bytes -= blk[0]
+        return blk
+
+    def gaps(self):
+        """ Free ranges below the highest block in use """
+
+        gaps = []
+        pos = 0
+        for offset in sorted(self.live):
+            if offset > pos:
+                gaps.append(offset - pos)
+            pos = max(pos, offset + self.live[offset][0])
+        return gaps
+
+    def fragmentation(self):
+        gaps = self.gaps()
+        total = sum(gaps)
+        largest = max(gaps, default=0)
+        return total, largest, 1 - largest / total if total else 0.0
+
+    def map(self, width):
+        cells = [0] * width
+        scale = self.size / width
+        for offset, (size, _) in self.live.items():
+            end = offset + size
+            while offset < end:
+                cell = min(int(offset / scale), width - 1)
+                cell_end = (cell + 1) * scale
+                n = min(end, cell_end) - offset
+                cells[cell] += n
+                offset += max(n, 1)
+        return ''.join(MAP_CHARS[min(int(c / scale * 4 + 0.999), 4)]
+                       for c in cells)
+
+
+def replay(drains, heap_size, on_event=None):
+    """ Applies the events of all drains, calls on_event after each one
+    but the markers """
+
+    heap = Heap(heap_size)
+    t64 = None
+    n = 0
+    for d in drains:
+        t64 = d.time if t64 is None else t64
+        for ev_time, offset, size, site, typ, _ in d.events:
+            if typ in (EV_TIME, EV_LOST):
+                t64 = size << 32 | ev_time
+                if typ == EV_LOST:
+                    heap.lost.append([t64, None, offset])
+                continue
+            t64 += (ev_time - t64) & 0xffffffff
+            if heap.lost and heap.lost[-1][1] is None:
+                heap.lost[-1][1] = t64
+            if typ in (EV_ALLOC, EV_REALLOC_ALLOC):
+                heap.alloc(offset, size, site)
+            else:
+                blk = heap.free(offset)
+                if blk:
+                    size, site = blk
+            if on_event and on_event(n, t64, typ, size, site, heap, d):
+                return heap
+            n += 1
+    return heap
+
+
+def human(n):
+    for unit in ('B', 'KiB', 'MiB'):
+        if n < 1024 or unit == 'MiB':
+            return '{:.1f} {}'.format(n, unit) if unit != 'B' else \
+                '{} B'.format(n)
+        n /= 1024
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Heap profile of a TA built with CFG_TA_HEAP_PROF=y')
+    parser.add_argument('drains', nargs='+',
+                        help='drained buffers, in drain order')
+    parser.add_argument('--elf', help='TA ELF to resolve return addresses')
+    parser.add_argument('--timeline', help='write a CSV heap timeline')
+    parser.add_argument('--top', type=int, default=20,
+                        help='sites in the peak table (default 20)')
+    parser.add_argument('--width', type=int, default=64,
+                        help='cells of the fragmentation map (default 64)')
+    args = parser.parse_args()
+
+    drains = [read_drain(p) for p in args.drains]
+    d0 = drains[0]
+    sites = {}
+    for d in drains:
+        sites.update(d.sites)
+    names = resolve(sites, args.elf, os.environ.get('CROSS_COMPILE', ''))
+
+    # First pass: timeline, peaks, per-site and per-drain figures
+    peak = {'bytes': -1, 'n': 0, 't': 0}
+    site_stats = {}
+    site_cur = {}
+    seg = {}
+    t0 = [None]
+    csv = open(args.timeline, 'w') if args.timeline else None
+    if csv:
+        csv.write('time_s,live_bytes,live_blocks,extent,lost_events\n')
+
+    def on_event(n, t, typ, size, site, heap, d):
+        if t0[0] is None:
+            t0[0] = t
+        s = site_stats.setdefault(site, [0, 0, 0, 0])
+        if typ in (EV_ALLOC, EV_REALLOC_ALLOC):
+            s[0] += 1
+            s[3] = max(s[3], size)
+            site_cur[site] = site_cur.get(site, 0) + size
+            s[1] = max(s[1], site_cur[site])
+        elif site in site_cur:
+            site_cur[site] -= size
+        if heap.bytes > peak['bytes']:
+            peak.update(bytes=heap.bytes, n=n, t=t)
+        g = seg.setdefault(d.name, {'start': None, 'peak': 0})
+        if g['start'] is None:
+            g['start'] = heap.bytes - (size if typ in (EV_ALLOC,
+                                                       EV_REALLOC_ALLOC)
+                                       else -size)
+        g['peak'] = max(g['peak'], heap.bytes)
+        g['end'] = heap.bytes
+        if csv:
+            csv.write('{:.6f},{},{},{},{}\n'.format(
+                (t - t0[0]) / d.freq, heap.bytes, len(heap.live),
+                heap.extent, sum(span[2] for span in heap.lost)))
+        return False
+
+    final = replay(drains, d0.heap_size, on_event)
+    if csv:
+        csv.close()
+
+    nevents = sum(len(d.events) for d in drains)
+    lost = sum(d.lost for d in drains)
+    print('{} events in {} buffers, {} lost'.format(nevents, len(drains),
+                                                   lost))
+    if lost:
+        print('warning: events were lost, drain more often or raise '
+              'CFG_TA_HEAP_PROF_EVENTS')
+    t_first = t0[0] if t0[0] is not None else d0.time
+    for start, end, count in final.lost:
+        print('  {} events lost from {:.3f} s to {}'.format(
+            count, (start - t_first) / d0.freq,
+            'the end' if end is None else
+            '{:.3f} s'.format((end - t_first) / d0.freq)))
+    if final.lost and final.lost[0][0] <= peak['t']:
+        print('warning: the peak follows lost events, the frees among '
+              'them leave blocks live so it may be overstated')
+    if final.unknown or final.stale or final.outside:
+        print('{} frees of unknown blocks, {} blocks replaced, {} blocks '
+              'outside of ta_heap'.format(final.unknown, final.stale,
+                                          final.outside))
+    if not nevents:
+        return
+
+    extent = final.extent
+    suggest = (extent + extent // 8 + 4095) & ~4095
+    print('ta_heap {}, peak in use {} at {:.3f} s, highest block end {}'
+          .format(human(d0.heap_size), human(peak['bytes']),
+                  (peak['t'] - t0[0]) / d0.freq, human(extent)))
+    print('TA_DATA_SIZE of {} ({} KiB) leaves 1/8 above the highest block'
+          .format(human(suggest), suggest // 1024))
+
+    # Second pass: the heap at the peak
+    at_peak = replay(drains, d0.heap_size,
+                     lambda n, *_: n == peak['n'])
+    peak_site = {}
+    for size, site in at_peak.live.values():
+        peak_site[site] = peak_site.get(site, 0) + size
+
+    print('\n{:<48} {:>8} {:>10} {:>10} {:>8}'.format(
+        'site', 'allocs', 'site peak', 'at peak', 'largest'))
+    rows = sorted(site_stats.items(), key=lambda kv: -kv[1][1])
+    for site, (allocs, speak, _, largest) in rows[:args.top]:
+        print('{:<48} {:>8} {:>10} {:>10} {:>8}'.format(
+            names.get(site, '#{}'.format(site))[-48:], allocs, speak,
+            peak_site.get(site, 0), largest))
+
+    print('\n{:<24} {:>10} {:>10} {:>10}'.format('buffer', 'start', 'peak',
+                                                 'end'))
+    for d in drains:
+        g = seg.get(d.name)
+        if g:
+            print('{:<24} {:>10} {:>10} {:>10}'.format(
+                d.name[-24:], g['start'], g['peak'], g['end']))
+
+    for title, heap in (('at the peak', at_peak), ('at the end', final)):
+        total, largest, frag = heap.fragmentation()
+        print('\nta_heap {}: {} free below the highest block, largest '
+              'gap {}, fragmentation {:.0%}'.format(title, human(total),
+                                                    human(largest), frag))
+        print('|{}|'.format(heap.map(args.width)))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,128 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: BSD-2-Clause
+#
+# Copyright (c) 2026, D-Robotics
+#
+# Compares the TAs, ELF files and libraries of two build output trees,
+# typically two CFG_TA_REPRODUCIBLE_BUILD=y builds of the same sources,
+# and tells which part of each differing file differs.
+
+import hashlib
+import os
+import struct
+import sys
+
+EXTS = ('.ta', '.elf', '.so', '.a')
+
+SHDR_MAGIC = 0x4f545348
+SHDR_BOOTSTRAP_TA = 1
+SHDR_ENCRYPTED_TA = 2
+
+
+def ta_fields(data):
+    """ Splits a signed TA image into its named fields, see
+    export-ta_arm64/scripts/sign_encrypt.py for the layout """
+
+    fields = []
+    offs = 0
+
+    def take(name, size):
+        nonlocal offs
+        fields.append((name, offs, offs + size))
+        offs += size
+
+    if len(data) < 20:
+        return [('file', 0, len(data))]
+    magic, img_type, img_size, algo, hash_size, sig_size = \
+        struct.unpack_from('<IIIIHH', data)
+    if magic != SHDR_MAGIC or img_type not in (SHDR_BOOTSTRAP_TA,
+                                               SHDR_ENCRYPTED_TA):
+        # TAs signed with a subkey start with the subkey chain
+        return [('file', 0, len(data))]
+    take('header', 20)
+    take('digest', hash_size)
+    take('signature', sig_size)
+    take('uuid and version', 20)
+    if img_type == SHDR_ENCRYPTED_TA:
+        _, _, nonce_len, tag_len = struct.unpack_from('<IIHH', data, offs)
+        take('encryption header', 12)
+        take('nonce', nonce_len)
+        take('tag', tag_len)
+        take('ciphertext', len(data) - offs)
+    else:
+        take('ELF image', len(data) - offs)
+    return fields
+
+
+def describe(path, a, b):
+    if len(a) != len(b):
+        return 'size {} != {}'.format(len(a), len(b))
+    if path.endswith('.ta'):
+        fields = ta_fields(a)
+    else:
+        fields = [('file', 0, len(a))]
+    diffs = []
+    for name, start, end in fields:
+        if a[start:end] != b[start:end]:
+            first = next(i for i in range(start, end) if a[i] != b[i])
+            diffs.append('{} (first at {:#x})'.format(name, first))
+    return ', '.join(diffs)
+
+
+def collect(top):
+    files = {}
+    for root, dirs, names in os.walk(top):
+        dirs.sort()
+        for n in sorted(names):
+            if n.endswith(EXTS):
+                path = os.path.join(root, n)
+                files[os.path.relpath(path, top)] = path
+    return files
+
+
+def get_args():
+    import argparse
+
+    parser = argparse.ArgumentParser(
+        description='Checks that two build output trees are identical')
+    parser.add_argument('a', help='First output directory')
+    parser.add_argument('b', help='Second output directory')
+    parser.add_argument('--manifest',
+                        help='Write the SHA-256 of every identical file to '
+                        'MANIFEST, usable as a cache key')
+    return parser.parse_args()
+
+
+def main():
+    args = get_args()
+    fa = collect(args.a)
+    fb = collect(args.b)
+    bad = 0
+    manifest = []
+
+    for rel in sorted(set(fa) | set(fb)):
+        if rel not in fa or rel not in fb:
+            print('ONLY {} {}'.format(args.a if rel in fa else args.b, rel))
+            bad += 1
+            continue
+        with open(fa[rel], 'rb') as f:
+            a = f.read()
+        with open(fb[rel], 'rb') as f:
+            b = f.read()
+        if a != b:
+            print('DIFF {}: {}'.format(rel, describe(rel, a, b)))
+            bad += 1
+        else:
+            manifest.append('{}  {}'.format(hashlib.sha256(a).hexdigest(),
+                                            rel))
+
+    if args.manifest:
+        with open(args.manifest, 'w') as f:
+            f.write('\n'.join(manifest) + '\n')
+
+    print('{} identical, {} different'.format(len(manifest), bad))
+    sys.exit(1 if bad else 0)
+
+
+if __name__ == "__main__":
+    main()
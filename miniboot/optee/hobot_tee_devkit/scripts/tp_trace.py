@@ -0,0 +1,167 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: BSD-2-Clause
+#
+# Copyright (c) 2026, D-Robotics
+#
+# Reads the buffers a TA built with CFG_TA_TRACEPOINT=y drained with
+# tp_ring_drain(), see ta/lib/ta_ext/include/tracepoint.h, one or more per
+# file, and prints the latency histogram of each span, a TRACE_END() and
+# the innermost TRACE_BEGIN() of the same ID still open in the same
+# session: nested spans of one ID pair last in, first out. With --json it
+# also writes a Chrome trace JSON file, which Perfetto (ui.perfetto.dev)
+# and chrome://tracing open, with a track per session.
+
+import argparse
+import json
+import re
+import struct
+import sys
+
+MAGIC = 0x45434154
+HDR = struct.Struct('<IHHIIII')
+REC = struct.Struct('<QHHIQ')
+
+TP_INSTANT = 0
+TP_BEGIN = 1
+TP_END = 2
+
+DEFINE_RE = re.compile(r'^\s*#\s*define\s+\w*TP_(\w+)\s+(\d+|0x[0-9a-fA-F]+)'
+                       r'\b', re.M)
+BAR = 40
+
+
+def read_names(paths):
+    names = {}
+    for path in paths:
+        with open(path) as f:
+            for m in DEFINE_RE.finditer(f.read()):
+                names.setdefault(int(m.group(2), 0), m.group(1).lower())
+    return names
+
+
+def read_recs(path):
+    """ Yields (freq, session, lost, records) for each buffer in @path """
+    with open(path, 'rb') as f:
+        data = f.read()
+    offs = 0
+    while offs + HDR.size <= len(data):
+        (magic, version, hdr_size, freq, session, nrecs,
+         lost) = HDR.unpack_from(data, offs)
+        if magic != MAGIC:
+            sys.exit('{}: no tracepoints at offset {}'.format(path, offs))
+        if version != 1:
+            sys.exit('{}: version {}'.format(path, version))
+        offs += hdr_size
+        if offs + nrecs * REC.size > len(data):
+            sys.exit('{}: truncated at offset {}'.format(path, offs))
+        recs = [REC.unpack_from(data, offs + n * REC.size)
+                for n in range(nrecs)]
+        offs += nrecs * REC.size
+        yield freq, session, lost, recs
+
+
+def human_ns(ns):
+    for unit, div in (('s', 1e9), ('ms', 1e6), ('us', 1e3)):
+        if ns >= div:
+            return '{:.3g}{}'.format(ns / div, unit)
+    return '{:.3g}ns'.format(ns)
+
+
+def percentile(sorted_vals, p):
+    return sorted_vals[min(len(sorted_vals) - 1,
+                           int(len(sorted_vals) * p / 100))]
+
+
+def print_histogram(name, durs):
+    durs.sort()
+    print('{}: {} spans, min {} p50 {} p90 {} p99 {} max {}'.format(
+        name, len(durs), human_ns(durs[0]), human_ns(percentile(durs, 50)),
+        human_ns(percentile(durs, 90)), human_ns(percentile(durs, 99)),
+        human_ns(durs[-1])))
+
+    # Buckets of [2^k, 2^(k+1)) ns
+    buckets = {}
+    for d in durs:
+        k = max(int(d), 1).bit_length() - 1
+        buckets[k] = buckets.get(k, 0) + 1
+    top = max(buckets.values())
+    for k in range(min(buckets), max(buckets) + 1):
+        n = buckets.get(k, 0)
+        print('  {:>8} - {:<8} {:8} {}'.format(
+            human_ns(1 << k), human_ns(2 << k), n,
+            '#' * ((n * BAR + top - 1) // top)))
+    print()
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Latency histograms and Chrome trace of tracepoints')
+    parser.add_argument('inputs', nargs='+',
+                        help='files of drained buffers, in order')
+    parser.add_argument('--names', action='append', default=[],
+                        help='header with "#define <prefix>TP_<name> <id>" '
+                        'lines naming the IDs, may be repeated')
+    parser.add_argument('--json', help='write a Chrome trace JSON file')
+    args = parser.parse_args()
+
+    names = read_names(args.names)
+    bufs = [b for path in args.inputs for b in read_recs(path)]
+    times = [r[0] for b in bufs for r in b[3]]
+    if not times:
+        sys.exit('No tracepoints')
+    t0 = min(times)
+
+    events = []
+    sessions = set()
+    open_spans = {}
+    durs = {}
+    lost = 0
+    unmatched = 0
+    for freq, session, nlost, recs in bufs:
+        lost += nlost
+        sessions.add(session)
+        for time, tid, typ, a, b in recs:
+            name = names.get(tid, 'tp{}'.format(tid))
+            ns = (time - t0) * 1e9 / freq
+            key = (session, tid)
+            if typ == TP_BEGIN:
+                open_spans.setdefault(key, []).append((ns, a, b))
+            elif typ == TP_END:
+                if not open_spans.get(key):
+                    unmatched += 1
+                    continue
+                start, ba, bb = open_spans[key].pop()
+                durs.setdefault(name, []).append(ns - start)
+                events.append({'name': name, 'ph': 'X', 'pid': 1,
+                               'tid': session, 'ts': start / 1e3,
+                               'dur': (ns - start) / 1e3,
+                               'args': {'a': ba, 'b': bb,
+                                        'end_a': a, 'end_b': b}})
+            else:
+                events.append({'name': name, 'ph': 'i', 's': 't',
+                               'pid': 1, 'tid': session, 'ts': ns / 1e3,
+                               'args': {'a': a, 'b': b}})
+    unmatched += sum(len(v) for v in open_spans.values())
+
+    for name in sorted(durs):
+        print_histogram(name, durs[name])
+    if lost:
+        print('{} tracepoints lost, the ring was full'.format(lost))
+    if unmatched:
+        print('{} TRACE_BEGIN() or TRACE_END() without the other'.format(
+            unmatched))
+
+    if args.json:
+        meta = [{'name': 'process_name', 'ph': 'M', 'pid': 1,
+                 'args': {'name': 'TA'}}]
+        meta += [{'name': 'thread_name', 'ph': 'M', 'pid': 1, 'tid': s,
+                  'args': {'name': 'session {:08x}'.format(s)}}
+                 for s in sorted(sessions)]
+        events.sort(key=lambda e: e['ts'])
+        with open(args.json, 'w') as f:
+            json.dump({'traceEvents': meta + events,
+                       'displayTimeUnit': 'ns'}, f)
+
+
+if __name__ == '__main__':
+    main()
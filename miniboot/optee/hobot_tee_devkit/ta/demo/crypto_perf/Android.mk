@@ -0,0 +1,4 @@
+LOCAL_PATH := $(call my-dir)
+
+local_module := 4ff311e0-1087-464e-9f31-3cd37c4b0576.ta
+include $(BUILD_OPTEE_MK)
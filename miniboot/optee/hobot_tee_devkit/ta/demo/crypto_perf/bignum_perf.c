@@ -0,0 +1,346 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2026, D-Robotics
+ */
+
+/*
+ * TA_CRYPTO_PERF_CMD_BENCH_BIGNUM: RSA PKCS#1 v1.5 verification and modular
+ * multiplication with the TEE Internal Core API, with the 32-bit limb
+ * bignum of libmbedtls and with ta/lib/mbedtls_ext/bn_mont.c, on the
+ * modulus of an RSA key generated here.
+ */
+
+#include <arm_user_sysreg.h>
+#include <crypto_perf.h>
+#include <mbedtls/bn_mont.h>
+#include <mbedtls/rsa.h>
+#include <string.h>
+#include <ta_crypto_perf.h>
+#include <tee_internal_api.h>
+#include <tee_internal_api_extensions.h>
+#include <util.h>
+
+#define BIGNUM_MAX_BITS		4096
+#define BIGNUM_HASH_SIZE	32
+
+/*
+ * Generating a 4096-bit key takes seconds, the last one is kept for the
+ * next invocations. It goes with the TA instance.
+ */
+static TEE_ObjectHandle bignum_key = TEE_HANDLE_NULL;
+static uint32_t bignum_key_bits;
+
+struct bignum_bench {
+	uint32_t op;
+	uint32_t impl;
+	uint32_t bits;
+	uint8_t hash[BIGNUM_HASH_SIZE];
+	uint8_t n[BIGNUM_MAX_BITS / 8];
+	uint32_t n_len;
+	uint8_t e[8];
+	uint32_t e_len;
+	uint8_t sig[BIGNUM_MAX_BITS / 8];
+	uint32_t sig_len;
+	TEE_OperationHandle verify_op;
+	mbedtls_rsa_context rsa;
+	mbedtls_bn_mont_context *mont;
+	mbedtls_mpi a;
+	mbedtls_mpi b;
+	mbedtls_mpi x;
+	TEE_BigInt *tee_n;
+	TEE_BigInt *tee_a;
+	TEE_BigInt *tee_b;
+	TEE_BigInt *tee_x;
+};
+
+static TEE_Result bignum_gen_key(uint32_t bits)
+{
+	TEE_Result res = TEE_SUCCESS;
+
+	if (bignum_key != TEE_HANDLE_NULL && bignum_key_bits == bits)
+		return TEE_SUCCESS;
+
+	TEE_FreeTransientObject(bignum_key);
+	bignum_key = TEE_HANDLE_NULL;
+
+	res = TEE_AllocateTransientObject(TEE_TYPE_RSA_KEYPAIR, bits,
+					  &bignum_key);
+	if (res)
+		return res;
+	res = TEE_GenerateKey(bignum_key, bits, NULL, 0);
+	if (res) {
+		TEE_FreeTransientObject(bignum_key);
+		bignum_key = TEE_HANDLE_NULL;
+		return res;
+	}
+	bignum_key_bits = bits;
+	return TEE_SUCCESS;
+}
+
+/* Signs a random hash and exports the public key of bignum_key */
+static TEE_Result bignum_sign(struct bignum_bench *bb)
+{
+	TEE_OperationHandle op = TEE_HANDLE_NULL;
+	TEE_Result res = TEE_SUCCESS;
+
+	bb->n_len = sizeof(bb->n);
+	res = TEE_GetObjectBufferAttribute(bignum_key, TEE_ATTR_RSA_MODULUS,
+					   bb->n, &bb->n_len);
+	if (res)
+		return res;
+	bb->e_len = sizeof(bb->e);
+	res = TEE_GetObjectBufferAttribute(bignum_key,
+					   TEE_ATTR_RSA_PUBLIC_EXPONENT,
+					   bb->e, &bb->e_len);
+	if (res)
+		return res;
+
+	res = TEE_AllocateOperation(&op, TEE_ALG_RSASSA_PKCS1_V1_5_SHA256,
+				    TEE_MODE_SIGN, bb->bits);
+	if (res)
+		return res;
+	res = TEE_SetOperationKey(op, bignum_key);
+	if (!res) {
+		TEE_GenerateRandom(bb->hash, sizeof(bb->hash));
+		bb->sig_len = sizeof(bb->sig);
+		res = TEE_AsymmetricSignDigest(op, NULL, 0, bb->hash,
+					       sizeof(bb->hash), bb->sig,
+					       &bb->sig_len);
+	}
+	TEE_FreeOperation(op);
+	return res;
+}
+
+static TEE_Result bignum_from_mbedtls(int ret)
+{
+	if (ret == MBEDTLS_ERR_MPI_ALLOC_FAILED)
+		return TEE_ERROR_OUT_OF_MEMORY;
+	if (ret)
+		return TEE_ERROR_GENERIC;
+	return TEE_SUCCESS;
+}
+
+/* Random operands below the modulus, for the multiplications */
+static TEE_Result bignum_operands(struct bignum_bench *bb)
+{
+	uint32_t words = TEE_BigIntSizeInU32(bb->bits);
+	TEE_BigInt **tee[] = { &bb->tee_n, &bb->tee_a, &bb->tee_b,
+			       &bb->tee_x };
+	uint8_t buf[BIGNUM_MAX_BITS / 8] = { };
+	TEE_Result res = TEE_SUCCESS;
+	size_t n = 0;
+	int ret = 0;
+
+	TEE_GenerateRandom(buf, bb->n_len);
+	buf[0] = 0;
+	ret = mbedtls_mpi_read_binary(&bb->a, buf, bb->n_len);
+	TEE_GenerateRandom(buf, bb->n_len);
+	buf[0] = 0;
+	if (!ret)
+		ret = mbedtls_mpi_read_binary(&bb->b, buf, bb->n_len);
+	if (ret)
+		return bignum_from_mbedtls(ret);
+
+	if (bb->impl != TA_CRYPTO_PERF_BIGNUM_IMPL_TEE)
+		return TEE_SUCCESS;
+
+	for (n = 0; n < ARRAY_SIZE(tee); n++) {
+		*tee[n] = TEE_Malloc(words * sizeof(uint32_t),
+				     TEE_MALLOC_FILL_ZERO);
+		if (!*tee[n])
+			return TEE_ERROR_OUT_OF_MEMORY;
+		TEE_BigIntInit(*tee[n], words);
+	}
+
+	res = TEE_BigIntConvertFromOctetString(bb->tee_n, bb->n, bb->n_len,
+					       0);
+	if (!res && !mbedtls_mpi_write_binary(&bb->a, buf, bb->n_len))
+		res = TEE_BigIntConvertFromOctetString(bb->tee_a, buf,
+						       bb->n_len, 0);
+	if (!res && !mbedtls_mpi_write_binary(&bb->b, buf, bb->n_len))
+		res = TEE_BigIntConvertFromOctetString(bb->tee_b, buf,
+						       bb->n_len, 0);
+	return res;
+}
+
+static TEE_Result bignum_setup(struct bignum_bench *bb)
+{
+	TEE_Result res = TEE_SUCCESS;
+	int ret = 0;
+
+	res = bignum_sign(bb);
+	if (res)
+		return res;
+
+	ret = mbedtls_rsa_import_raw(&bb->rsa, bb->n, bb->n_len, NULL, 0,
+				     NULL, 0, NULL, 0, bb->e, bb->e_len);
+	if (!ret)
+		ret = mbedtls_rsa_complete(&bb->rsa);
+	if (ret)
+		return TEE_ERROR_GENERIC;
+
+	switch (bb->impl) {
+	case TA_CRYPTO_PERF_BIGNUM_IMPL_TEE:
+		if (bb->op != TA_CRYPTO_PERF_BIGNUM_RSA_VERIFY)
+			break;
+		res = TEE_AllocateOperation(&bb->verify_op,
+					    TEE_ALG_RSASSA_PKCS1_V1_5_SHA256,
+					    TEE_MODE_VERIFY, bb->bits);
+		if (!res)
+			res = TEE_SetOperationKey(bb->verify_op, bignum_key);
+		if (res)
+			return res;
+		break;
+	case TA_CRYPTO_PERF_BIGNUM_IMPL_MONT:
+		bb->mont = TEE_Malloc(sizeof(*bb->mont), TEE_MALLOC_FILL_ZERO);
+		if (!bb->mont)
+			return TEE_ERROR_OUT_OF_MEMORY;
+		mbedtls_bn_mont_init(bb->mont);
+		res = bignum_from_mbedtls(mbedtls_bn_mont_setup(bb->mont,
+								&bb->rsa.N));
+		if (res)
+			return res;
+		break;
+	default:
+		break;
+	}
+
+	if (bb->op == TA_CRYPTO_PERF_BIGNUM_MULMOD)
+		return bignum_operands(bb);
+	return TEE_SUCCESS;
+}
+
+static TEE_Result bignum_verify(struct bignum_bench *bb)
+{
+	int ret = 0;
+
+	switch (bb->impl) {
+	case TA_CRYPTO_PERF_BIGNUM_IMPL_TEE:
+		return TEE_AsymmetricVerifyDigest(bb->verify_op, NULL, 0,
+						  bb->hash, sizeof(bb->hash),
+						  bb->sig, bb->sig_len);
+	case TA_CRYPTO_PERF_BIGNUM_IMPL_MBEDTLS:
+		ret = mbedtls_rsa_pkcs1_verify(&bb->rsa, NULL, NULL,
+					       MBEDTLS_RSA_PUBLIC,
+					       MBEDTLS_MD_SHA256, 0, bb->hash,
+					       bb->sig);
+		break;
+	case TA_CRYPTO_PERF_BIGNUM_IMPL_MONT:
+		ret = mbedtls_bn_mont_rsa_pkcs1_v15_verify(bb->mont, &bb->rsa,
+							   MBEDTLS_MD_SHA256,
+							   0, bb->hash,
+							   bb->sig);
+		break;
+	default:
+		return TEE_ERROR_NOT_SUPPORTED;
+	}
+
+	if (ret == MBEDTLS_ERR_RSA_VERIFY_FAILED)
+		return TEE_ERROR_SIGNATURE_INVALID;
+	return bignum_from_mbedtls(ret);
+}
+
+static TEE_Result bignum_mul_mod(struct bignum_bench *bb)
+{
+	int ret = 0;
+
+	switch (bb->impl) {
+	case TA_CRYPTO_PERF_BIGNUM_IMPL_TEE:
+		TEE_BigIntMulMod(bb->tee_x, bb->tee_a, bb->tee_b, bb->tee_n);
+		return TEE_SUCCESS;
+	case TA_CRYPTO_PERF_BIGNUM_IMPL_MBEDTLS:
+		ret = mbedtls_mpi_mul_mpi(&bb->x, &bb->a, &bb->b);
+		if (!ret)
+			ret = mbedtls_mpi_mod_mpi(&bb->x, &bb->x, &bb->rsa.N);
+		break;
+	case TA_CRYPTO_PERF_BIGNUM_IMPL_MONT:
+		ret = mbedtls_bn_mont_mul_mod(bb->mont, &bb->x, &bb->a,
+					      &bb->b);
+		break;
+	default:
+		return TEE_ERROR_NOT_SUPPORTED;
+	}
+
+	return bignum_from_mbedtls(ret);
+}
+
+static TEE_Result bignum_run(struct bignum_bench *bb)
+{
+	if (bb->op == TA_CRYPTO_PERF_BIGNUM_RSA_VERIFY)
+		return bignum_verify(bb);
+	return bignum_mul_mod(bb);
+}
+
+TEE_Result ta_entry_bench_bignum(uint32_t param_types, TEE_Param params[4])
+{
+	struct bignum_bench *bb = NULL;
+	uint32_t iters = params[1].value.b;
+	TEE_Result res = TEE_SUCCESS;
+	uint64_t t = 0;
+	uint32_t n = 0;
+
+	if (param_types != TEE_PARAM_TYPES(TEE_PARAM_TYPE_VALUE_INPUT,
+					   TEE_PARAM_TYPE_VALUE_INPUT,
+					   TEE_PARAM_TYPE_VALUE_OUTPUT,
+					   TEE_PARAM_TYPE_VALUE_OUTPUT))
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	if (params[0].value.a > TA_CRYPTO_PERF_BIGNUM_MULMOD ||
+	    params[0].value.b > TA_CRYPTO_PERF_BIGNUM_IMPL_MONT)
+		return TEE_ERROR_NOT_SUPPORTED;
+	if (!params[1].value.a || params[1].value.a > BIGNUM_MAX_BITS ||
+	    !iters)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	/* Over 8 KiB of buffers, more than the stack of the TA */
+	bb = TEE_Malloc(sizeof(*bb), TEE_MALLOC_FILL_ZERO);
+	if (!bb)
+		return TEE_ERROR_OUT_OF_MEMORY;
+	bb->op = params[0].value.a;
+	bb->impl = params[0].value.b;
+	bb->bits = params[1].value.a;
+	mbedtls_rsa_init(&bb->rsa, MBEDTLS_RSA_PKCS_V15, 0);
+	mbedtls_mpi_init(&bb->a);
+	mbedtls_mpi_init(&bb->b);
+	mbedtls_mpi_init(&bb->x);
+
+	res = bignum_gen_key(bb->bits);
+	if (res)
+		goto out;
+
+	res = bignum_setup(bb);
+	if (res)
+		goto out;
+
+	/* Checks the signature and warms up the caches outside the timing */
+	res = bignum_run(bb);
+	if (res)
+		goto out;
+
+	t = barrier_read_counter_timer();
+	for (n = 0; n < iters; n++) {
+		res = bignum_run(bb);
+		if (res)
+			goto out;
+	}
+	t = barrier_read_counter_timer() - t;
+
+	reg_pair_from_64(t, &params[2].value.a, &params[2].value.b);
+	params[3].value.a = read_cntfrq();
+	params[3].value.b = 0;
+out:
+	if (bb->verify_op)
+		TEE_FreeOperation(bb->verify_op);
+	mbedtls_bn_mont_free(bb->mont);
+	TEE_Free(bb->mont);
+	TEE_Free(bb->tee_n);
+	TEE_Free(bb->tee_a);
+	TEE_Free(bb->tee_b);
+	TEE_Free(bb->tee_x);
+	mbedtls_mpi_free(&bb->a);
+	mbedtls_mpi_free(&bb->b);
+	mbedtls_mpi_free(&bb->x);
+	mbedtls_rsa_free(&bb->rsa);
+	TEE_Free(bb);
+	return res;
+}
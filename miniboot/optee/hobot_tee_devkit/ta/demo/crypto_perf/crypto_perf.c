@@ -0,0 +1,1030 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2026, D-Robotics
+ */
+
+#include <arm_user_sysreg.h>
+#include <crypto_perf.h>
+#include <mbedtls/aesce.h>
+#include <mbedtls/bn_mont.h>
+#include <mbedtls/chachapoly.h>
+#include <mbedtls/chachapoly_neon.h>
+#include <mbedtls/ecp256.h>
+#include <mbedtls/klad_cache.h>
+#include <mbedtls/sha2ce.h>
+#include <mbedtls/snow3g.h>
+#include <mbedtls/sm3.h>
+#include <mbedtls/sm4.h>
+#include <mbedtls/zuc.h>
+#include <stdio.h>
+#include <string.h>
+#include <ta_asset.h>
+#include <ta_crypto_perf.h>
+#include <tee_internal_api.h>
+#include <tee_internal_api_extensions.h>
+#include <utee_defines.h>
+#include <util.h>
+
+#define BENCH_MAX_SIZE		(256 * 1024)
+#define MAX_TAG_SIZE		16
+/* IV of the 3GPP algorithms, see ta_crypto_perf.h */
+#define IV_3GPP_SIZE		8
+
+/* Vector table built from vectors/ *.rsp, see sub.mk */
+extern struct ta_asset kat_vectors;
+
+struct vec {
+	uint32_t algo;
+	uint32_t mode;
+	uint32_t flags;
+	uint32_t line;
+	const uint8_t *key;
+	size_t key_len;
+	const uint8_t *iv;
+	size_t iv_len;
+	const uint8_t *aad;
+	size_t aad_len;
+	const uint8_t *in;
+	size_t in_len;
+	const uint8_t *out;
+	size_t out_len;
+	const uint8_t *tag;
+	size_t tag_len;
+};
+
+struct crypto_op {
+	uint32_t algo;
+	uint32_t mode;
+	TEE_OperationHandle op;
+	mbedtls_chachapoly_context chachapoly;
+	mbedtls_chachapoly_neon_context chachapoly_neon;
+	uint8_t key_3gpp[16];
+	mbedtls_sm4_context sm4;
+	mbedtls_sm4_xts_context sm4_xts;
+	union {
+		mbedtls_aesce_context aesce;
+		mbedtls_aesce_xts_context aesce_xts;
+		mbedtls_aesce_gcm_context aesce_gcm;
+	};
+};
+
+/* Self tests of ta/lib/mbedtls_ext, run by TA_CRYPTO_PERF_CMD_SELF_TEST */
+static const struct {
+	const char *name;
+	int (*func)(int verbose);
+} self_tests[] = {
+	{ "zuc", mbedtls_zuc_self_test },
+	{ "snow3g", mbedtls_snow3g_self_test },
+	{ "sm4", mbedtls_sm4_self_test },
+	{ "sm3_mb", mbedtls_sm3_mb_self_test },
+	{ "aesce", mbedtls_aesce_self_test },
+	{ "sha2ce", mbedtls_sha2ce_self_test },
+	{ "ecp256", mbedtls_ecp256_self_test },
+	{ "bn_mont", mbedtls_bn_mont_self_test },
+	{ "chachapoly_neon", mbedtls_chachapoly_neon_self_test },
+	{ "klad_cache", mbedtls_klad_cache_self_test },
+};
+
+static bool is_chachapoly(uint32_t algo)
+{
+	return algo == TA_CRYPTO_PERF_ALG_CHACHA20_POLY1305 ||
+	       algo == TA_CRYPTO_PERF_ALG_CHACHA20_POLY1305_NEON;
+}
+
+static bool is_zuc(uint32_t algo)
+{
+	return algo >= TA_CRYPTO_PERF_ALG_ZUC_EEA3 &&
+	       algo <= TA_CRYPTO_PERF_ALG_ZUC_EEA3_X8;
+}
+
+static bool is_snow3g(uint32_t algo)
+{
+	return algo >= TA_CRYPTO_PERF_ALG_SNOW3G_UEA2 &&
+	       algo <= TA_CRYPTO_PERF_ALG_SNOW3G_UEA2_X8;
+}
+
+/* The 3GPP algorithms share the key, IV and lane handling */
+static bool is_3gpp(uint32_t algo)
+{
+	return is_zuc(algo) || is_snow3g(algo);
+}
+
+static bool is_sm4_sw(uint32_t algo)
+{
+	return algo >= TA_CRYPTO_PERF_ALG_SM4_SW_ECB &&
+	       algo <= TA_CRYPTO_PERF_ALG_SM4_SW_XTS;
+}
+
+static bool is_sm3_sw(uint32_t algo)
+{
+	return algo >= TA_CRYPTO_PERF_ALG_SM3_MBEDTLS &&
+	       algo <= TA_CRYPTO_PERF_ALG_SM3_MB_X8;
+}
+
+static bool is_aes_ce(uint32_t algo)
+{
+	return algo >= TA_CRYPTO_PERF_ALG_AES_CE_ECB &&
+	       algo <= TA_CRYPTO_PERF_ALG_AES_CE_GCM;
+}
+
+static bool is_sha2_ce(uint32_t algo)
+{
+	return algo == TA_CRYPTO_PERF_ALG_SHA256_CE ||
+	       algo == TA_CRYPTO_PERF_ALG_SHA512_CE;
+}
+
+/* Implemented by the TA itself, so never missing from the TEE core */
+static bool is_ta_alg(uint32_t algo)
+{
+	return is_chachapoly(algo) || is_3gpp(algo) || is_sm4_sw(algo) ||
+	       is_sm3_sw(algo) || is_aes_ce(algo) || is_sha2_ce(algo);
+}
+
+static uint32_t chain_mode(uint32_t algo)
+{
+	switch (algo) {
+	case TA_CRYPTO_PERF_ALG_SM4_SW_ECB:
+	case TA_CRYPTO_PERF_ALG_AES_CE_ECB:
+		return TEE_CHAIN_MODE_ECB_NOPAD;
+	case TA_CRYPTO_PERF_ALG_SM4_SW_CBC:
+	case TA_CRYPTO_PERF_ALG_AES_CE_CBC:
+		return TEE_CHAIN_MODE_CBC_NOPAD;
+	case TA_CRYPTO_PERF_ALG_SM4_SW_CTR:
+	case TA_CRYPTO_PERF_ALG_AES_CE_CTR:
+		return TEE_CHAIN_MODE_CTR;
+	case TA_CRYPTO_PERF_ALG_SM4_SW_XTS:
+	case TA_CRYPTO_PERF_ALG_AES_CE_XTS:
+		return TEE_CHAIN_MODE_XTS;
+	case TA_CRYPTO_PERF_ALG_AES_CE_GCM:
+		return TEE_CHAIN_MODE_GCM;
+	default:
+		return TEE_ALG_GET_CHAIN_MODE(algo);
+	}
+}
+
+static uint32_t op_class(uint32_t algo)
+{
+	if (is_chachapoly(algo) || algo == TA_CRYPTO_PERF_ALG_AES_CE_GCM)
+		return TEE_OPERATION_AE;
+	if (algo == TA_CRYPTO_PERF_ALG_ZUC_EIA3 ||
+	    algo == TA_CRYPTO_PERF_ALG_SNOW3G_UIA2)
+		return TEE_OPERATION_MAC;
+	if (is_3gpp(algo) || is_sm4_sw(algo) || is_aes_ce(algo))
+		return TEE_OPERATION_CIPHER;
+	if (is_sm3_sw(algo) || is_sha2_ce(algo))
+		return TEE_OPERATION_DIGEST;
+
+	return TEE_ALG_GET_CLASS(algo);
+}
+
+static TEE_Result set_key(struct crypto_op *cop, const uint8_t *key,
+			  size_t key_len)
+{
+	TEE_ObjectHandle obj[2] = { TEE_HANDLE_NULL, TEE_HANDLE_NULL };
+	uint32_t type = TEE_ALG_GET_KEY_TYPE(cop->algo, false);
+	size_t nkeys = 1;
+	TEE_Attribute attr = { };
+	TEE_Result res = TEE_SUCCESS;
+	size_t n = 0;
+
+	/* XTS takes the concatenation of the data and the tweak keys */
+	if (TEE_ALG_GET_CHAIN_MODE(cop->algo) == TEE_CHAIN_MODE_XTS) {
+		if (key_len % 2)
+			return TEE_ERROR_NOT_SUPPORTED;
+		nkeys = 2;
+		key_len /= 2;
+	}
+
+	for (n = 0; n < nkeys; n++) {
+		res = TEE_AllocateTransientObject(type, key_len * 8, obj + n);
+		if (res)
+			goto out;
+		TEE_InitRefAttribute(&attr, TEE_ATTR_SECRET_VALUE,
+				     key + n * key_len, key_len);
+		res = TEE_PopulateTransientObject(obj[n], &attr, 1);
+		if (res)
+			goto out;
+	}
+
+	if (nkeys == 2)
+		res = TEE_SetOperationKey2(cop->op, obj[0], obj[1]);
+	else
+		res = TEE_SetOperationKey(cop->op, obj[0]);
+out:
+	TEE_FreeTransientObject(obj[0]);
+	TEE_FreeTransientObject(obj[1]);
+	return res;
+}
+
+static TEE_Result sm4_sw_init(struct crypto_op *cop, const uint8_t *key,
+			      size_t key_len)
+{
+	bool dec = cop->mode == TEE_MODE_DECRYPT;
+	int ret = 0;
+
+	mbedtls_sm4_init(&cop->sm4);
+	mbedtls_sm4_xts_init(&cop->sm4_xts);
+
+	switch (cop->algo) {
+	case TA_CRYPTO_PERF_ALG_SM4_SW_XTS:
+		if (dec)
+			ret = mbedtls_sm4_xts_setkey_dec(&cop->sm4_xts, key,
+							 key_len * 8);
+		else
+			ret = mbedtls_sm4_xts_setkey_enc(&cop->sm4_xts, key,
+							 key_len * 8);
+		break;
+	case TA_CRYPTO_PERF_ALG_SM4_SW_CTR:
+		ret = mbedtls_sm4_setkey_enc(&cop->sm4, key, key_len * 8);
+		break;
+	default:
+		if (dec)
+			ret = mbedtls_sm4_setkey_dec(&cop->sm4, key,
+						     key_len * 8);
+		else
+			ret = mbedtls_sm4_setkey_enc(&cop->sm4, key,
+						     key_len * 8);
+		break;
+	}
+
+	if (ret == MBEDTLS_ERR_SM4_INVALID_KEY_LENGTH)
+		return TEE_ERROR_NOT_SUPPORTED;
+	return ret ? TEE_ERROR_GENERIC : TEE_SUCCESS;
+}
+
+static TEE_Result aes_ce_init(struct crypto_op *cop, const uint8_t *key,
+			      size_t key_len)
+{
+	bool dec = cop->mode == TEE_MODE_DECRYPT;
+	int ret = 0;
+
+	switch (cop->algo) {
+	case TA_CRYPTO_PERF_ALG_AES_CE_GCM:
+		mbedtls_aesce_gcm_init(&cop->aesce_gcm);
+		ret = mbedtls_aesce_gcm_setkey(&cop->aesce_gcm, key,
+					       key_len * 8);
+		break;
+	case TA_CRYPTO_PERF_ALG_AES_CE_XTS:
+		mbedtls_aesce_xts_init(&cop->aesce_xts);
+		if (dec)
+			ret = mbedtls_aesce_xts_setkey_dec(&cop->aesce_xts, key,
+							   key_len * 8);
+		else
+			ret = mbedtls_aesce_xts_setkey_enc(&cop->aesce_xts, key,
+							   key_len * 8);
+		break;
+	case TA_CRYPTO_PERF_ALG_AES_CE_CTR:
+		mbedtls_aesce_init(&cop->aesce);
+		ret = mbedtls_aesce_setkey_enc(&cop->aesce, key, key_len * 8);
+		break;
+	default:
+		mbedtls_aesce_init(&cop->aesce);
+		if (dec)
+			ret = mbedtls_aesce_setkey_dec(&cop->aesce, key,
+						       key_len * 8);
+		else
+			ret = mbedtls_aesce_setkey_enc(&cop->aesce, key,
+						       key_len * 8);
+		break;
+	}
+
+	if (ret == MBEDTLS_ERR_AES_INVALID_KEY_LENGTH)
+		return TEE_ERROR_NOT_SUPPORTED;
+	return ret ? TEE_ERROR_GENERIC : TEE_SUCCESS;
+}
+
+/* Returns TEE_ERROR_NOT_SUPPORTED if the algorithm or key is unsupported */
+static TEE_Result op_init(struct crypto_op *cop, uint32_t algo,
+			  uint32_t mode, const uint8_t *key, size_t key_len)
+{
+	TEE_Result res = TEE_SUCCESS;
+	size_t max_key_bits = key_len * 8;
+
+	cop->algo = algo;
+	cop->mode = mode;
+	cop->op = TEE_HANDLE_NULL;
+
+	if (is_chachapoly(algo)) {
+		mbedtls_chachapoly_init(&cop->chachapoly);
+		mbedtls_chachapoly_neon_init(&cop->chachapoly_neon);
+		if (key_len != 32)
+			return TEE_ERROR_NOT_SUPPORTED;
+		if (algo == TA_CRYPTO_PERF_ALG_CHACHA20_POLY1305_NEON) {
+			if (mbedtls_chachapoly_neon_setkey(&cop->chachapoly_neon,
+							   key))
+				return TEE_ERROR_GENERIC;
+		} else if (mbedtls_chachapoly_setkey(&cop->chachapoly, key)) {
+			return TEE_ERROR_GENERIC;
+		}
+		return TEE_SUCCESS;
+	}
+
+	if (is_3gpp(algo)) {
+		if (key_len != sizeof(cop->key_3gpp))
+			return TEE_ERROR_NOT_SUPPORTED;
+		memcpy(cop->key_3gpp, key, key_len);
+		return TEE_SUCCESS;
+	}
+
+	if (is_sm4_sw(algo))
+		return sm4_sw_init(cop, key, key_len);
+
+	if (is_aes_ce(algo))
+		return aes_ce_init(cop, key, key_len);
+
+	if (is_sm3_sw(algo) || is_sha2_ce(algo))
+		return TEE_SUCCESS;
+
+	if (TEE_ALG_GET_CLASS(algo) == TEE_OPERATION_DIGEST)
+		max_key_bits = 0;
+	else if (TEE_ALG_GET_CHAIN_MODE(algo) == TEE_CHAIN_MODE_XTS)
+		max_key_bits /= 2;
+
+	res = TEE_AllocateOperation(&cop->op, algo, mode, max_key_bits);
+	if (res)
+		return res;
+
+	if (max_key_bits)
+		return set_key(cop, key, key_len);
+
+	return TEE_SUCCESS;
+}
+
+static void op_free(struct crypto_op *cop)
+{
+	if (is_chachapoly(cop->algo)) {
+		mbedtls_chachapoly_free(&cop->chachapoly);
+		mbedtls_chachapoly_neon_free(&cop->chachapoly_neon);
+	} else if (is_sm4_sw(cop->algo)) {
+		mbedtls_sm4_free(&cop->sm4);
+		mbedtls_sm4_xts_free(&cop->sm4_xts);
+	} else if (cop->algo == TA_CRYPTO_PERF_ALG_AES_CE_GCM) {
+		mbedtls_aesce_gcm_free(&cop->aesce_gcm);
+	} else if (cop->algo == TA_CRYPTO_PERF_ALG_AES_CE_XTS) {
+		mbedtls_aesce_xts_free(&cop->aesce_xts);
+	} else if (is_aes_ce(cop->algo)) {
+		mbedtls_aesce_free(&cop->aesce);
+	} else if (cop->op != TEE_HANDLE_NULL) {
+		TEE_FreeOperation(cop->op);
+	}
+}
+
+static TEE_Result run_chachapoly(struct crypto_op *cop, const struct vec *v,
+				 uint8_t *out, uint8_t *tag)
+{
+	int ret = 0;
+
+	if (v->iv_len != 12)
+		return TEE_ERROR_NOT_SUPPORTED;
+
+	if (cop->mode != TEE_MODE_ENCRYPT && v->tag_len != 16)
+		return TEE_ERROR_NOT_SUPPORTED;
+
+	if (cop->algo == TA_CRYPTO_PERF_ALG_CHACHA20_POLY1305_NEON) {
+		if (cop->mode == TEE_MODE_ENCRYPT)
+			ret = mbedtls_chachapoly_neon_encrypt_and_tag(
+					&cop->chachapoly_neon, v->in_len, v->iv,
+					v->aad, v->aad_len, v->in, out, tag);
+		else
+			ret = mbedtls_chachapoly_neon_auth_decrypt(
+					&cop->chachapoly_neon, v->in_len, v->iv,
+					v->aad, v->aad_len, v->tag, v->in, out);
+	} else if (cop->mode == TEE_MODE_ENCRYPT) {
+		ret = mbedtls_chachapoly_encrypt_and_tag(&cop->chachapoly,
+							 v->in_len, v->iv,
+							 v->aad, v->aad_len,
+							 v->in, out, tag);
+	} else {
+		ret = mbedtls_chachapoly_auth_decrypt(&cop->chachapoly,
+						      v->in_len, v->iv,
+						      v->aad, v->aad_len,
+						      v->tag, v->in, out);
+	}
+
+	if (ret == MBEDTLS_ERR_CHACHAPOLY_AUTH_FAILED)
+		return TEE_ERROR_MAC_INVALID;
+	if (ret)
+		return TEE_ERROR_GENERIC;
+	return TEE_SUCCESS;
+}
+
+/*
+ * The multi-lane variants give each lane a slice of v->in and its own
+ * bearer, the last lane also takes the rest of the division.
+ */
+static TEE_Result run_3gpp(struct crypto_op *cop, const struct vec *v,
+			   uint8_t *out, uint32_t *out_len)
+{
+	mbedtls_eea3_msg msgs[MBEDTLS_ZUC_MAX_LANES] = { };
+	mbedtls_uea2_msg umsgs[MBEDTLS_SNOW3G_MAX_LANES] = { };
+	uint32_t count = 0;
+	uint32_t fresh = 0;
+	uint32_t bearer = 0;
+	uint32_t dir = 0;
+	size_t lanes = 1;
+	size_t slice = 0;
+	size_t n = 0;
+	int ret = 0;
+
+	if (v->iv_len != IV_3GPP_SIZE)
+		return TEE_ERROR_NOT_SUPPORTED;
+	memcpy(&count, v->iv, sizeof(count));
+	count = TEE_U32_FROM_BIG_ENDIAN(count);
+	memcpy(&fresh, v->iv + 4, sizeof(fresh));
+	fresh = TEE_U32_FROM_BIG_ENDIAN(fresh);
+	bearer = v->iv[4];
+	dir = v->iv[5];
+
+	switch (cop->algo) {
+	case TA_CRYPTO_PERF_ALG_ZUC_EIA3:
+		*out_len = 4;
+		ret = mbedtls_eia3_mac(cop->key_3gpp, count, bearer, dir,
+				       v->in_len, v->in, out);
+		return ret ? TEE_ERROR_BAD_PARAMETERS : TEE_SUCCESS;
+	case TA_CRYPTO_PERF_ALG_SNOW3G_UIA2:
+		*out_len = 4;
+		ret = mbedtls_uia2_mac(cop->key_3gpp, count, fresh, 0,
+				       v->in_len, v->in, out);
+		return ret ? TEE_ERROR_BAD_PARAMETERS : TEE_SUCCESS;
+	case TA_CRYPTO_PERF_ALG_ZUC_EEA3_X4:
+	case TA_CRYPTO_PERF_ALG_SNOW3G_UEA2_X4:
+		lanes = 4;
+		break;
+	case TA_CRYPTO_PERF_ALG_ZUC_EEA3_X8:
+	case TA_CRYPTO_PERF_ALG_SNOW3G_UEA2_X8:
+		lanes = 8;
+		break;
+	default:
+		break;
+	}
+	slice = v->in_len / lanes;
+
+	for (n = 0; n < lanes; n++) {
+		msgs[n].key = cop->key_3gpp;
+		msgs[n].count = count;
+		msgs[n].bearer = (bearer + n) & 0x1f;
+		msgs[n].dir = dir;
+		msgs[n].size = slice;
+		msgs[n].input = v->in + n * slice;
+		msgs[n].output = out + n * slice;
+	}
+	msgs[lanes - 1].size += v->in_len % lanes;
+
+	*out_len = v->in_len;
+	if (is_snow3g(cop->algo)) {
+		for (n = 0; n < lanes; n++) {
+			umsgs[n].key = msgs[n].key;
+			umsgs[n].count = msgs[n].count;
+			umsgs[n].bearer = msgs[n].bearer;
+			umsgs[n].dir = msgs[n].dir;
+			umsgs[n].size = msgs[n].size;
+			umsgs[n].input = msgs[n].input;
+			umsgs[n].output = msgs[n].output;
+		}
+		ret = mbedtls_uea2_crypt_multi(lanes, umsgs);
+	} else {
+		ret = mbedtls_eea3_crypt_multi(lanes, msgs);
+	}
+	return ret ? TEE_ERROR_BAD_PARAMETERS : TEE_SUCCESS;
+}
+
+/* Like TEE_CipherInit() and TEE_CipherDoFinal(), the IV is not chained */
+static TEE_Result run_sm4_sw(struct crypto_op *cop, const struct vec *v,
+			     uint8_t *out, uint32_t *out_len)
+{
+	int mode = cop->mode == TEE_MODE_DECRYPT ? MBEDTLS_SM4_DECRYPT :
+						   MBEDTLS_SM4_ENCRYPT;
+	uint8_t stream_block[16] = { };
+	uint8_t iv[16] = { };
+	size_t nc_off = 0;
+	int ret = 0;
+
+	if (cop->algo != TA_CRYPTO_PERF_ALG_SM4_SW_ECB) {
+		if (v->iv_len != sizeof(iv))
+			return TEE_ERROR_NOT_SUPPORTED;
+		memcpy(iv, v->iv, sizeof(iv));
+	}
+
+	*out_len = v->in_len;
+	switch (cop->algo) {
+	case TA_CRYPTO_PERF_ALG_SM4_SW_ECB:
+		ret = mbedtls_sm4_crypt_ecb_blocks(&cop->sm4, mode, v->in_len,
+						   v->in, out);
+		break;
+	case TA_CRYPTO_PERF_ALG_SM4_SW_CBC:
+		ret = mbedtls_sm4_crypt_cbc(&cop->sm4, mode, v->in_len, iv,
+					    v->in, out);
+		break;
+	case TA_CRYPTO_PERF_ALG_SM4_SW_CTR:
+		ret = mbedtls_sm4_crypt_ctr(&cop->sm4, v->in_len, &nc_off, iv,
+					    stream_block, v->in, out);
+		break;
+	default:
+		ret = mbedtls_sm4_crypt_xts(&cop->sm4_xts, mode, v->in_len, iv,
+					    v->in, out);
+		break;
+	}
+
+	return ret ? TEE_ERROR_BAD_PARAMETERS : TEE_SUCCESS;
+}
+
+static TEE_Result run_aes_ce_gcm(struct crypto_op *cop, const struct vec *v,
+				 uint8_t *out, uint8_t *tag)
+{
+	int ret = 0;
+
+	if (!v->iv_len || v->tag_len < 4)
+		return TEE_ERROR_NOT_SUPPORTED;
+
+	if (cop->mode == TEE_MODE_ENCRYPT)
+		ret = mbedtls_aesce_gcm_crypt_and_tag(&cop->aesce_gcm,
+						      MBEDTLS_GCM_ENCRYPT,
+						      v->in_len, v->iv,
+						      v->iv_len, v->aad,
+						      v->aad_len, v->in, out,
+						      v->tag_len, tag);
+	else
+		ret = mbedtls_aesce_gcm_auth_decrypt(&cop->aesce_gcm,
+						     v->in_len, v->iv,
+						     v->iv_len, v->aad,
+						     v->aad_len, v->tag,
+						     v->tag_len, v->in, out);
+
+	if (ret == MBEDTLS_ERR_GCM_AUTH_FAILED)
+		return TEE_ERROR_MAC_INVALID;
+	return ret ? TEE_ERROR_GENERIC : TEE_SUCCESS;
+}
+
+/* Like TEE_CipherInit() and TEE_CipherDoFinal(), the IV is not chained */
+static TEE_Result run_aes_ce(struct crypto_op *cop, const struct vec *v,
+			     uint8_t *out, uint32_t *out_len)
+{
+	int mode = cop->mode == TEE_MODE_DECRYPT ? MBEDTLS_AES_DECRYPT :
+						   MBEDTLS_AES_ENCRYPT;
+	uint8_t stream_block[16] = { };
+	uint8_t iv[16] = { };
+	size_t nc_off = 0;
+	int ret = 0;
+
+	if (cop->algo != TA_CRYPTO_PERF_ALG_AES_CE_ECB) {
+		if (v->iv_len != sizeof(iv))
+			return TEE_ERROR_NOT_SUPPORTED;
+		memcpy(iv, v->iv, sizeof(iv));
+	}
+
+	*out_len = v->in_len;
+	switch (cop->algo) {
+	case TA_CRYPTO_PERF_ALG_AES_CE_ECB:
+		ret = mbedtls_aesce_crypt_ecb(&cop->aesce, mode, v->in_len,
+					      v->in, out);
+		break;
+	case TA_CRYPTO_PERF_ALG_AES_CE_CBC:
+		ret = mbedtls_aesce_crypt_cbc(&cop->aesce, mode, v->in_len, iv,
+					      v->in, out);
+		break;
+	case TA_CRYPTO_PERF_ALG_AES_CE_CTR:
+		ret = mbedtls_aesce_crypt_ctr(&cop->aesce, v->in_len, &nc_off,
+					      iv, stream_block, v->in, out);
+		break;
+	default:
+		ret = mbedtls_aesce_crypt_xts(&cop->aesce_xts, mode, v->in_len,
+					      iv, v->in, out);
+		break;
+	}
+
+	return ret ? TEE_ERROR_BAD_PARAMETERS : TEE_SUCCESS;
+}
+
+/*
+ * The multi-buffer variants hash each slice of v->in in a lane, the last
+ * lane also takes the rest of the division, then hash the digests
+ */
+static TEE_Result run_sm3_sw(struct crypto_op *cop, const struct vec *v,
+			     uint8_t *out, uint32_t *out_len)
+{
+	mbedtls_sm3_mb_job jobs[MBEDTLS_SM3_MB_MAX_LANES] = { };
+	uint8_t sums[MBEDTLS_SM3_MB_MAX_LANES][32] = { };
+	size_t lanes = 4;
+	size_t slice = 0;
+	size_t n = 0;
+	int ret = 0;
+
+	*out_len = 32;
+	switch (cop->algo) {
+	case TA_CRYPTO_PERF_ALG_SM3_MBEDTLS:
+		ret = mbedtls_sm3_ret(v->in, v->in_len, out);
+		return ret ? TEE_ERROR_BAD_PARAMETERS : TEE_SUCCESS;
+	case TA_CRYPTO_PERF_ALG_SM3_MB:
+		ret = mbedtls_sm3_mb_ret(v->in, v->in_len, out);
+		return ret ? TEE_ERROR_BAD_PARAMETERS : TEE_SUCCESS;
+	case TA_CRYPTO_PERF_ALG_SM3_MB_X8:
+		lanes = 8;
+		break;
+	default:
+		break;
+	}
+	slice = v->in_len / lanes;
+
+	for (n = 0; n < lanes; n++) {
+		jobs[n].input = v->in + n * slice;
+		jobs[n].ilen = slice;
+		jobs[n].output = sums[n];
+	}
+	jobs[lanes - 1].ilen += v->in_len % lanes;
+
+	ret = mbedtls_sm3_mb_multi(lanes, jobs);
+	if (!ret)
+		ret = mbedtls_sm3_mb_ret(sums[0], lanes * sizeof(sums[0]), out);
+	return ret ? TEE_ERROR_BAD_PARAMETERS : TEE_SUCCESS;
+}
+
+static TEE_Result run_sha2_ce(struct crypto_op *cop, const struct vec *v,
+			      uint8_t *out, uint32_t *out_len)
+{
+	int ret = 0;
+
+	if (cop->algo == TA_CRYPTO_PERF_ALG_SHA256_CE) {
+		*out_len = 32;
+		ret = mbedtls_sha256ce_ret(v->in, v->in_len, out, 0);
+	} else {
+		*out_len = 64;
+		ret = mbedtls_sha512ce_ret(v->in, v->in_len, out, 0);
+	}
+	return ret ? TEE_ERROR_BAD_PARAMETERS : TEE_SUCCESS;
+}
+
+/*
+ * Processes v->in into @out, of at least v->in_len or 64 bytes. For AEADs
+ * the tag is written to @tag when encrypting, v->tag is verified when
+ * decrypting.
+ */
+static TEE_Result op_run(struct crypto_op *cop, const struct vec *v,
+			 uint8_t *out, uint32_t *out_len, uint8_t *tag)
+{
+	TEE_Result res = TEE_SUCCESS;
+	uint32_t tag_len = MAX_TAG_SIZE;
+
+	if (is_chachapoly(cop->algo)) {
+		*out_len = v->in_len;
+		return run_chachapoly(cop, v, out, tag);
+	}
+	if (is_3gpp(cop->algo))
+		return run_3gpp(cop, v, out, out_len);
+	if (is_sm4_sw(cop->algo))
+		return run_sm4_sw(cop, v, out, out_len);
+	if (cop->algo == TA_CRYPTO_PERF_ALG_AES_CE_GCM) {
+		*out_len = v->in_len;
+		return run_aes_ce_gcm(cop, v, out, tag);
+	}
+	if (is_aes_ce(cop->algo))
+		return run_aes_ce(cop, v, out, out_len);
+	if (is_sm3_sw(cop->algo))
+		return run_sm3_sw(cop, v, out, out_len);
+	if (is_sha2_ce(cop->algo))
+		return run_sha2_ce(cop, v, out, out_len);
+
+	switch (TEE_ALG_GET_CLASS(cop->algo)) {
+	case TEE_OPERATION_DIGEST:
+		return TEE_DigestDoFinal(cop->op, v->in, v->in_len, out,
+					 out_len);
+	case TEE_OPERATION_MAC:
+		TEE_MACInit(cop->op, NULL, 0);
+		return TEE_MACComputeFinal(cop->op, v->in, v->in_len, out,
+					   out_len);
+	case TEE_OPERATION_CIPHER:
+		TEE_CipherInit(cop->op, v->iv, v->iv_len);
+		return TEE_CipherDoFinal(cop->op, v->in, v->in_len, out,
+					 out_len);
+	case TEE_OPERATION_AE:
+		res = TEE_AEInit(cop->op, v->iv, v->iv_len, v->tag_len * 8,
+				 v->aad_len, v->in_len);
+		if (res)
+			return res;
+		if (v->aad_len)
+			TEE_AEUpdateAAD(cop->op, v->aad, v->aad_len);
+		if (cop->mode == TEE_MODE_ENCRYPT)
+			return TEE_AEEncryptFinal(cop->op, v->in, v->in_len,
+						  out, out_len, tag, &tag_len);
+		return TEE_AEDecryptFinal(cop->op, v->in, v->in_len, out,
+					  out_len, (void *)v->tag, v->tag_len);
+	default:
+		return TEE_ERROR_NOT_SUPPORTED;
+	}
+}
+
+static TEE_Result check_vec(const struct vec *v)
+{
+	struct crypto_op cop = { };
+	uint8_t tag[MAX_TAG_SIZE] = { };
+	uint8_t *out = NULL;
+	uint32_t out_len = MAX(v->in_len, (size_t)64);
+	TEE_Result res = TEE_SUCCESS;
+
+	if (v->tag_len > sizeof(tag))
+		return TEE_ERROR_NOT_SUPPORTED;
+
+	res = op_init(&cop, v->algo, v->mode, v->key, v->key_len);
+	if (res)
+		goto out;
+
+	out = TEE_Malloc(out_len, TEE_MALLOC_FILL_ZERO);
+	if (!out) {
+		res = TEE_ERROR_OUT_OF_MEMORY;
+		goto out;
+	}
+
+	res = op_run(&cop, v, out, &out_len, tag);
+	if (v->flags & CRYPTO_PERF_VEC_FLAG_FAIL) {
+		if (res == TEE_ERROR_MAC_INVALID)
+			res = TEE_SUCCESS;
+		else if (res != TEE_ERROR_NOT_SUPPORTED)
+			res = TEE_ERROR_GENERIC;
+		goto out;
+	}
+	if (res)
+		goto out;
+
+	/* MACs may be truncated */
+	if (out_len < v->out_len ||
+	    (op_class(v->algo) != TEE_OPERATION_MAC && out_len != v->out_len) ||
+	    memcmp(out, v->out, v->out_len))
+		res = TEE_ERROR_GENERIC;
+
+	if (op_class(v->algo) == TEE_OPERATION_AE &&
+	    v->mode == TEE_MODE_ENCRYPT && memcmp(tag, v->tag, v->tag_len))
+		res = TEE_ERROR_GENERIC;
+out:
+	TEE_Free(out);
+	op_free(&cop);
+	return res;
+}
+
+static TEE_Result get_vec(const uint8_t *rec, size_t size, struct vec *v,
+			  size_t *rec_size)
+{
+	struct crypto_perf_vec hdr = { };
+	const uint8_t *p = rec + sizeof(hdr);
+	size_t len = sizeof(hdr);
+
+	if (size < sizeof(hdr))
+		return TEE_ERROR_BAD_FORMAT;
+	memcpy(&hdr, rec, sizeof(hdr));
+
+	if (hdr.size > size ||
+	    ADD_OVERFLOW(len, hdr.key_len, &len) ||
+	    ADD_OVERFLOW(len, hdr.iv_len, &len) ||
+	    ADD_OVERFLOW(len, hdr.aad_len, &len) ||
+	    ADD_OVERFLOW(len, hdr.in_len, &len) ||
+	    ADD_OVERFLOW(len, hdr.out_len, &len) ||
+	    ADD_OVERFLOW(len, hdr.tag_len, &len) ||
+	    len > hdr.size)
+		return TEE_ERROR_BAD_FORMAT;
+
+	v->algo = hdr.algo;
+	v->mode = hdr.mode;
+	v->flags = hdr.flags;
+	v->line = hdr.line;
+	v->key = p;
+	v->key_len = hdr.key_len;
+	p += hdr.key_len;
+	v->iv = p;
+	v->iv_len = hdr.iv_len;
+	p += hdr.iv_len;
+	v->aad = p;
+	v->aad_len = hdr.aad_len;
+	p += hdr.aad_len;
+	v->in = p;
+	v->in_len = hdr.in_len;
+	p += hdr.in_len;
+	v->out = p;
+	v->out_len = hdr.out_len;
+	p += hdr.out_len;
+	v->tag = p;
+	v->tag_len = hdr.tag_len;
+	*rec_size = hdr.size;
+
+	return TEE_SUCCESS;
+}
+
+TEE_Result ta_entry_kat(uint32_t param_types, TEE_Param params[4])
+{
+	struct crypto_perf_vec_tbl tbl = { };
+	const uint8_t *buf = NULL;
+	size_t size = 0;
+	size_t pos = sizeof(tbl);
+	size_t rec_size = 0;
+	uint32_t passed = 0;
+	uint32_t failed = 0;
+	uint32_t skipped = 0;
+	uint32_t ta_skipped = 0;
+	uint32_t first_fail = 0;
+	struct vec v = { };
+	TEE_Result res = TEE_SUCCESS;
+	uint32_t n = 0;
+
+	if (param_types != TEE_PARAM_TYPES(TEE_PARAM_TYPE_MEMREF_INPUT,
+					   TEE_PARAM_TYPE_VALUE_OUTPUT,
+					   TEE_PARAM_TYPE_VALUE_OUTPUT,
+					   TEE_PARAM_TYPE_VALUE_OUTPUT))
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	if (params[0].memref.buffer) {
+		buf = params[0].memref.buffer;
+		size = params[0].memref.size;
+	} else {
+		buf = ta_asset_get(&kat_vectors, &size);
+		if (!buf)
+			return TEE_ERROR_OUT_OF_MEMORY;
+	}
+
+	if (size < sizeof(tbl))
+		return TEE_ERROR_BAD_FORMAT;
+	memcpy(&tbl, buf, sizeof(tbl));
+	if (tbl.magic != CRYPTO_PERF_VEC_MAGIC ||
+	    tbl.version != CRYPTO_PERF_VEC_VERSION) {
+		EMSG("Bad vector table magic %#"PRIx32" version %"PRIu32,
+		     tbl.magic, tbl.version);
+		return TEE_ERROR_BAD_FORMAT;
+	}
+
+	for (n = 0; n < tbl.count; n++) {
+		res = get_vec(buf + pos, size - pos, &v, &rec_size);
+		if (res) {
+			EMSG("Bad vector %"PRIu32" at offset %zu", n, pos);
+			return res;
+		}
+		pos += rec_size;
+
+		res = check_vec(&v);
+		if (res == TEE_ERROR_NOT_SUPPORTED) {
+			DMSG("Skipped algo %#"PRIx32" line %"PRIu32,
+			     v.algo, v.line);
+			skipped++;
+			if (is_ta_alg(v.algo))
+				ta_skipped++;
+		} else if (res) {
+			EMSG("Failed algo %#"PRIx32" line %"PRIu32": %#"PRIx32,
+			     v.algo, v.line, res);
+			if (!failed)
+				first_fail = v.line;
+			failed++;
+		} else {
+			passed++;
+		}
+	}
+
+	params[1].value.a = passed;
+	params[1].value.b = failed;
+	params[2].value.a = skipped;
+	params[2].value.b = first_fail;
+	params[3].value.a = ta_skipped;
+
+	return TEE_SUCCESS;
+}
+
+TEE_Result ta_entry_bench(uint32_t param_types, TEE_Param params[4])
+{
+	uint32_t algo = params[0].value.a;
+	size_t key_len = params[0].value.b / 8;
+	size_t size = params[1].value.a;
+	uint32_t iters = params[1].value.b;
+	uint8_t key[64] = { };
+	uint8_t iv[16] = { };
+	uint8_t tag[MAX_TAG_SIZE] = { };
+	struct crypto_op cop = { };
+	struct vec v = { };
+	uint8_t *in = NULL;
+	uint8_t *out = NULL;
+	uint32_t out_len = 0;
+	uint64_t t = 0;
+	TEE_Result res = TEE_SUCCESS;
+	uint32_t n = 0;
+
+	if (param_types != TEE_PARAM_TYPES(TEE_PARAM_TYPE_VALUE_INPUT,
+					   TEE_PARAM_TYPE_VALUE_INPUT,
+					   TEE_PARAM_TYPE_VALUE_OUTPUT,
+					   TEE_PARAM_TYPE_VALUE_OUTPUT))
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	if (!size || size > BENCH_MAX_SIZE || !iters)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	v.algo = algo;
+	v.mode = TEE_MODE_ENCRYPT;
+	switch (op_class(algo)) {
+	case TEE_OPERATION_DIGEST:
+		v.mode = TEE_MODE_DIGEST;
+		key_len = 0;
+		break;
+	case TEE_OPERATION_MAC:
+		v.mode = TEE_MODE_MAC;
+		break;
+	case TEE_OPERATION_CIPHER:
+		if (is_3gpp(algo))
+			v.iv_len = IV_3GPP_SIZE;
+		else if (chain_mode(algo) != TEE_CHAIN_MODE_ECB_NOPAD)
+			v.iv_len = sizeof(iv);
+		if (!is_3gpp(algo) && chain_mode(algo) == TEE_CHAIN_MODE_XTS)
+			key_len *= 2;
+		break;
+	case TEE_OPERATION_AE:
+		v.iv_len = 12;
+		v.tag_len = MAX_TAG_SIZE;
+		break;
+	default:
+		return TEE_ERROR_NOT_SUPPORTED;
+	}
+	if (key_len > sizeof(key))
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	TEE_GenerateRandom(key, key_len);
+	TEE_GenerateRandom(iv, sizeof(iv));
+	if (is_3gpp(algo)) {
+		/* Valid BEARER and DIRECTION */
+		iv[4] &= 0x1f;
+		iv[5] &= 0x1;
+	}
+	v.key = key;
+	v.key_len = key_len;
+	v.iv = iv;
+
+	in = TEE_Malloc(size, TEE_MALLOC_FILL_ZERO);
+	out = TEE_Malloc(MAX(size, (size_t)64), TEE_MALLOC_FILL_ZERO);
+	if (!in || !out) {
+		res = TEE_ERROR_OUT_OF_MEMORY;
+		goto out;
+	}
+	TEE_GenerateRandom(in, size);
+	v.in = in;
+	v.in_len = size;
+
+	res = op_init(&cop, algo, v.mode, key, key_len);
+	if (res)
+		goto out;
+
+	/* Warm up caches and lazily allocated state outside the timing */
+	out_len = MAX(size, (size_t)64);
+	res = op_run(&cop, &v, out, &out_len, tag);
+	if (res)
+		goto out;
+
+	t = barrier_read_counter_timer();
+	for (n = 0; n < iters; n++) {
+		out_len = MAX(size, (size_t)64);
+		res = op_run(&cop, &v, out, &out_len, tag);
+		if (res)
+			goto out;
+	}
+	t = barrier_read_counter_timer() - t;
+
+	reg_pair_from_64(t, &params[2].value.a, &params[2].value.b);
+	params[3].value.a = read_cntfrq();
+	params[3].value.b = 0;
+out:
+	op_free(&cop);
+	TEE_Free(in);
+	TEE_Free(out);
+	return res;
+}
+
+TEE_Result ta_entry_self_test(uint32_t param_types, TEE_Param params[4])
+{
+	char *buf = params[0].memref.buffer;
+	size_t size = params[0].memref.size;
+	size_t pos = 0;
+	uint32_t passed = 0;
+	uint32_t failed = 0;
+	bool ok = false;
+	size_t n = 0;
+	int len = 0;
+
+	if (param_types != TEE_PARAM_TYPES(TEE_PARAM_TYPE_MEMREF_OUTPUT,
+					   TEE_PARAM_TYPE_VALUE_OUTPUT,
+					   TEE_PARAM_TYPE_NONE,
+					   TEE_PARAM_TYPE_NONE))
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	for (n = 0; n < ARRAY_SIZE(self_tests); n++) {
+		ok = !self_tests[n].func(0);
+		if (ok)
+			passed++;
+		else
+			failed++;
+
+		/* Keeps counting past the end to report the size needed */
+		len = snprintf(pos < size ? buf + pos : NULL,
+			       pos < size ? size - pos : 0, "%s: %s\n",
+			       self_tests[n].name, ok ? "passed" : "failed");
+		if (len < 0)
+			return TEE_ERROR_GENERIC;
+		pos += len;
+	}
+
+	params[0].memref.size = pos + 1;
+	if (pos >= size)
+		return TEE_ERROR_SHORT_BUFFER;
+	params[1].value.a = passed;
+	params[1].value.b = failed;
+
+	return TEE_SUCCESS;
+}
@@ -0,0 +1,17 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Copyright (c) 2026, D-Robotics
+ */
+
+#ifndef CRYPTO_PERF_H
+#define CRYPTO_PERF_H
+
+#include <tee_api.h>
+
+TEE_Result ta_entry_kat(uint32_t param_types, TEE_Param params[4]);
+TEE_Result ta_entry_bench(uint32_t param_types, TEE_Param params[4]);
+TEE_Result ta_entry_self_test(uint32_t param_types, TEE_Param params[4]);
+TEE_Result ta_entry_bench_verify(uint32_t param_types, TEE_Param params[4]);
+TEE_Result ta_entry_bench_bignum(uint32_t param_types, TEE_Param params[4]);
+
+#endif /*CRYPTO_PERF_H*/
@@ -0,0 +1,200 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Copyright (c) 2026, D-Robotics
+ */
+
+#ifndef TA_CRYPTO_PERF_H
+#define TA_CRYPTO_PERF_H
+
+#include <stdint.h>
+
+#define TA_CRYPTO_PERF_UUID { 0x4ff311e0, 0x1087, 0x464e, \
+	{ 0x9f, 0x31, 0x3c, 0xd3, 0x7c, 0x4b, 0x05, 0x76 } }
+
+/*
+ * Run known answer tests
+ *
+ * [in]		memref[0]	Vector table from scripts/cavp_to_bin.py, or
+ *				a NULL memref for the table built into the TA
+ * [out]	value[1].a	Number of vectors passed
+ * [out]	value[1].b	Number of vectors failed
+ * [out]	value[2].a	Number of vectors skipped, the algorithm or key
+ *				size is not supported
+ * [out]	value[2].b	Line in its .rsp file of the first failed
+ *				vector, 0 if none failed
+ * [out]	value[3].a	Number of the skipped vectors that are for a
+ *				TA_CRYPTO_PERF_ALG_* algorithm, which the TA
+ *				always implements
+ */
+#define TA_CRYPTO_PERF_CMD_KAT		0
+
+/*
+ * Measure the throughput of an algorithm
+ *
+ * [in]		value[0].a	Algorithm, TEE_ALG_* or TA_CRYPTO_PERF_ALG_*
+ * [in]		value[0].b	Key size in bits, ignored for digests
+ * [in]		value[1].a	Size of the data processed per iteration
+ * [in]		value[1].b	Number of iterations
+ * [out]	value[2].a	Elapsed counter ticks, high 32 bits
+ * [out]	value[2].b	Elapsed counter ticks, low 32 bits
+ * [out]	value[3].a	Counter frequency in Hz
+ */
+#define TA_CRYPTO_PERF_CMD_BENCH	1
+
+/*
+ * Run the self tests of the software implementations in ta/lib/mbedtls_ext
+ *
+ * [out]	memref[0]	One "<name>: passed" or "<name>: failed" line
+ *				per self test, NUL terminated
+ * [out]	value[1].a	Number of self tests passed
+ * [out]	value[1].b	Number of self tests failed
+ */
+#define TA_CRYPTO_PERF_CMD_SELF_TEST	2
+
+/*
+ * Measure the rate of signature verification
+ *
+ * [in]		value[0].a	Curve, TEE_ECC_CURVE_NIST_P256 for ECDSA or
+ *				TEE_ECC_CURVE_SM2 for SM2DSA
+ * [in]		value[0].b	Implementation, TA_CRYPTO_PERF_VERIFY_*
+ * [in]		value[1].a	Number of signatures, each by its own key, at
+ *				most TA_CRYPTO_PERF_VERIFY_MAX_SIGS
+ * [in]		value[1].b	Number of iterations, each verifies all the
+ *				signatures
+ * [out]	value[2].a	Elapsed counter ticks, high 32 bits
+ * [out]	value[2].b	Elapsed counter ticks, low 32 bits
+ * [out]	value[3].a	Counter frequency in Hz
+ */
+#define TA_CRYPTO_PERF_CMD_BENCH_VERIFY	3
+
+/* Implementations measured by TA_CRYPTO_PERF_CMD_BENCH_VERIFY */
+#define TA_CRYPTO_PERF_VERIFY_MBEDTLS		0 /* ecdsa.h, sm2dsa.h */
+#define TA_CRYPTO_PERF_VERIFY_ECP256		1 /* mbedtls_ecp256_verify() */
+#define TA_CRYPTO_PERF_VERIFY_ECP256_BATCH	2 /* ..._verify_batch() */
+
+#define TA_CRYPTO_PERF_VERIFY_MAX_SIGS		64
+
+/*
+ * Measure the rate of RSA public key operations and modular multiplications
+ * on the modulus of an RSA key generated by the TA, the key is kept for the
+ * following invocations with the same size
+ *
+ * [in]		value[0].a	Operation, TA_CRYPTO_PERF_BIGNUM_*
+ * [in]		value[0].b	Implementation, TA_CRYPTO_PERF_BIGNUM_IMPL_*
+ * [in]		value[1].a	Modulus size in bits, at most 4096
+ * [in]		value[1].b	Number of operations
+ * [out]	value[2].a	Elapsed counter ticks, high 32 bits
+ * [out]	value[2].b	Elapsed counter ticks, low 32 bits
+ * [out]	value[3].a	Counter frequency in Hz
+ */
+#define TA_CRYPTO_PERF_CMD_BENCH_BIGNUM	4
+
+/* Operations measured by TA_CRYPTO_PERF_CMD_BENCH_BIGNUM */
+#define TA_CRYPTO_PERF_BIGNUM_RSA_VERIFY	0 /* PKCS#1 v1.5 SHA-256 */
+#define TA_CRYPTO_PERF_BIGNUM_MULMOD		1
+
+/* Implementations measured by TA_CRYPTO_PERF_CMD_BENCH_BIGNUM */
+#define TA_CRYPTO_PERF_BIGNUM_IMPL_TEE		0 /* tee_internal_api.h */
+#define TA_CRYPTO_PERF_BIGNUM_IMPL_MBEDTLS	1 /* rsa.h, bignum.h */
+#define TA_CRYPTO_PERF_BIGNUM_IMPL_MONT		2 /* bn_mont.h */
+
+/* Algorithms without a TEE_ALG_* identifier, served by mbedtls */
+#define TA_CRYPTO_PERF_ALG_CHACHA20_POLY1305	0xf0000001
+/*
+ * ZUC takes an 8 byte IV: the 32-bit COUNT big endian, BEARER, DIRECTION
+ * and two zero bytes. The multi-lane variants split the data into 4 or 8
+ * messages of consecutive bearers that are processed in parallel.
+ */
+#define TA_CRYPTO_PERF_ALG_ZUC_EEA3		0xf0000002
+#define TA_CRYPTO_PERF_ALG_ZUC_EIA3		0xf0000003
+#define TA_CRYPTO_PERF_ALG_ZUC_EEA3_X4		0xf0000004
+#define TA_CRYPTO_PERF_ALG_ZUC_EEA3_X8		0xf0000005
+/*
+ * SNOW 3G UEA2 takes the same IV as ZUC. UIA2 reads FRESH from bytes 4 to
+ * 7, big endian, with DIRECTION 0.
+ */
+#define TA_CRYPTO_PERF_ALG_SNOW3G_UEA2		0xf0000006
+#define TA_CRYPTO_PERF_ALG_SNOW3G_UIA2		0xf0000007
+#define TA_CRYPTO_PERF_ALG_SNOW3G_UEA2_X4	0xf0000008
+#define TA_CRYPTO_PERF_ALG_SNOW3G_UEA2_X8	0xf0000009
+/*
+ * The software SM4 of ta/lib/mbedtls_ext, with the keys and IVs of the
+ * matching TEE_ALG_SM4_* algorithm
+ */
+#define TA_CRYPTO_PERF_ALG_SM4_SW_ECB		0xf000000a
+#define TA_CRYPTO_PERF_ALG_SM4_SW_CBC		0xf000000b
+#define TA_CRYPTO_PERF_ALG_SM4_SW_CTR		0xf000000c
+#define TA_CRYPTO_PERF_ALG_SM4_SW_XTS		0xf000000d
+/*
+ * SM3 of libmbedtls, and of the multi-buffer code of ta/lib/mbedtls_ext,
+ * single stream. The multi-buffer variants hash 4 or 8 slices of the data
+ * in parallel, the result is the SM3 of the digests of the slices.
+ */
+#define TA_CRYPTO_PERF_ALG_SM3_MBEDTLS		0xf000000e
+#define TA_CRYPTO_PERF_ALG_SM3_MB		0xf000000f
+#define TA_CRYPTO_PERF_ALG_SM3_MB_X4		0xf0000010
+#define TA_CRYPTO_PERF_ALG_SM3_MB_X8		0xf0000011
+/*
+ * AES and AES-GCM of ta/lib/mbedtls_ext, with the Cryptographic Extension
+ * or bitsliced, with the keys and IVs of the matching TEE_ALG_AES_*
+ * algorithm
+ */
+#define TA_CRYPTO_PERF_ALG_AES_CE_ECB		0xf0000012
+#define TA_CRYPTO_PERF_ALG_AES_CE_CBC		0xf0000013
+#define TA_CRYPTO_PERF_ALG_AES_CE_CTR		0xf0000014
+#define TA_CRYPTO_PERF_ALG_AES_CE_XTS		0xf0000015
+#define TA_CRYPTO_PERF_ALG_AES_CE_GCM		0xf0000016
+/*
+ * SHA-256 and SHA-512 of ta/lib/mbedtls_ext, with the SHA2 and SHA512
+ * instructions, a NEON message schedule or portable C
+ */
+#define TA_CRYPTO_PERF_ALG_SHA256_CE		0xf0000017
+#define TA_CRYPTO_PERF_ALG_SHA512_CE		0xf0000018
+/*
+ * ChaCha20-Poly1305 of ta/lib/mbedtls_ext, four blocks at a time with NEON,
+ * with the key and nonce of TA_CRYPTO_PERF_ALG_CHACHA20_POLY1305
+ */
+#define TA_CRYPTO_PERF_ALG_CHACHA20_POLY1305_NEON	0xf0000019
+
+/*
+ * Vector table layout, all fields little endian:
+ *
+ * struct crypto_perf_vec_tbl followed by @count records, each made of a
+ * struct crypto_perf_vec followed by the key, iv, aad, in, out and tag
+ * fields in this order and padded to a multiple of 4 bytes. @size covers
+ * the whole record including the header and the padding.
+ *
+ * @mode is TEE_MODE_ENCRYPT or TEE_MODE_DECRYPT for ciphers and AEADs,
+ * TEE_MODE_DIGEST for digests and TEE_MODE_MAC for MACs. @out holds the
+ * expected output, a MAC may be truncated. For AEADs the tag is the
+ * expected one when encrypting and the one to verify when decrypting.
+ * XTS keys are the concatenation of the two keys.
+ */
+#define CRYPTO_PERF_VEC_MAGIC		0x42564143	/* "CAVB" */
+#define CRYPTO_PERF_VEC_VERSION		1
+
+/* The vector must fail, e.g. the tag does not match */
+#define CRYPTO_PERF_VEC_FLAG_FAIL	0x1
+
+struct crypto_perf_vec_tbl {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t count;
+	uint32_t reserved;
+};
+
+struct crypto_perf_vec {
+	uint32_t size;
+	uint32_t algo;
+	uint32_t mode;
+	uint32_t flags;
+	uint32_t line;
+	uint32_t key_len;
+	uint32_t iv_len;
+	uint32_t aad_len;
+	uint32_t in_len;
+	uint32_t out_len;
+	uint32_t tag_len;
+};
+
+#endif /*TA_CRYPTO_PERF_H*/
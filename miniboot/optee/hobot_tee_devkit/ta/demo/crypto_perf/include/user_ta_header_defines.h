@@ -0,0 +1,18 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Copyright (c) 2026, D-Robotics
+ */
+
+#ifndef USER_TA_HEADER_DEFINES_H
+#define USER_TA_HEADER_DEFINES_H
+
+#include <ta_crypto_perf.h>
+#include <user_ta_header.h>
+
+#define TA_UUID		TA_CRYPTO_PERF_UUID
+
+#define TA_FLAGS	(TA_FLAG_USER_MODE | TA_FLAG_EXEC_DDR)
+#define TA_STACK_SIZE	(8 * 1024)
+#define TA_DATA_SIZE	(1024 * 1024)
+
+#endif /*USER_TA_HEADER_DEFINES_H*/
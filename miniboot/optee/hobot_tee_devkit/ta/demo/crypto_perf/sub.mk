@@ -0,0 +1,34 @@
+global-incdirs-y += include
+srcs-y += ta_entry.c
+srcs-y += crypto_perf.c
+srcs-y += verify_perf.c
+srcs-y += bignum_perf.c
+
+# Built-in known answer tests, TA_CRYPTO_PERF_CMD_KAT runs them when no
+# vector table is passed. Larger CAVP suites are compiled on the host with
+# the same script and passed as a memref.
+kat-rsp := aes-cbc:aes_cbc.rsp aes-ctr:aes_ctr.rsp aes-xts:aes_xts.rsp \
+	   aes-gcm:aes_gcm.rsp aes-ce-cbc:aes_cbc.rsp aes-ce-ctr:aes_ctr.rsp \
+	   aes-ce-xts:aes_xts.rsp aes-ce-gcm:aes_gcm.rsp sm4-ecb:sm4_ecb.rsp sm4-cbc:sm4_cbc.rsp \
+	   sm4-ctr:sm4_ctr.rsp sm4-sw-ecb:sm4_ecb.rsp sm4-sw-cbc:sm4_cbc.rsp \
+	   sm4-sw-ctr:sm4_ctr.rsp sha1:sha1.rsp sha256:sha256.rsp \
+	   sha512:sha512.rsp sha256-ce:sha256.rsp sha512-ce:sha512.rsp \
+	   sm3:sm3.rsp sm3-mbedtls:sm3.rsp \
+	   sm3-mb:sm3.rsp hmac:hmac.rsp \
+	   hmac-sm3:hmac_sm3.rsp chacha20-poly1305:chacha20_poly1305.rsp \
+	   chacha20-poly1305-neon:chacha20_poly1305.rsp
+kat-rsp-args := $(foreach r,$(kat-rsp),$(subst :,:$(sub-dir)/vectors/,$(r)))
+kat-rsp-files := $(foreach r,$(kat-rsp-args),$(lastword $(subst :, ,$(r))))
+devkit-scripts := $(TA_DEV_KIT_DIR)/../scripts
+
+gensrcs-y += kat_vectors
+produce-kat_vectors = kat_vectors.S
+depends-kat_vectors = $(kat-rsp-files) $(devkit-scripts)/cavp_to_bin.py \
+		      $(devkit-scripts)/file_to_c.py
+recipe-kat_vectors = $(PYTHON3) $(devkit-scripts)/cavp_to_bin.py \
+		     --out $(sub-dir-out)/kat_vectors.bin $(kat-rsp-args) && \
+		     $(PYTHON3) $(devkit-scripts)/file_to_c.py --format incbin \
+		     --compress lz4 --name kat_vectors \
+		     --inf $(sub-dir-out)/kat_vectors.bin \
+		     --out $(sub-dir-out)/kat_vectors.S
+cleanfiles += $(sub-dir-out)/kat_vectors.bin $(sub-dir-out)/kat_vectors.S.bin
@@ -0,0 +1,90 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2026, D-Robotics
+ */
+
+#include <crypto_perf.h>
+#include <mbedtls/klad_cache.h>
+#include <ta_crypto_perf.h>
+#include <tee_internal_api.h>
+#include <tee_internal_api_extensions.h>
+#include <tee_ta_api.h>
+
+/*
+ * Secure keys of a session are unwrapped once, into the key ladder cache of
+ * the session. The software ladder, with random root keys, stands in for
+ * the trust engine.
+ */
+struct session {
+	mbedtls_klad_emul_context ladder;
+	mbedtls_klad_cache_context klad;
+};
+
+TEE_Result TA_CreateEntryPoint(void)
+{
+	return TEE_SUCCESS;
+}
+
+void TA_DestroyEntryPoint(void)
+{
+}
+
+TEE_Result TA_OpenSessionEntryPoint(uint32_t param_types __unused,
+				    TEE_Param params[4] __unused,
+				    void **session_ctx)
+{
+	uint8_t root_keys[2][16] = { };
+	struct session *sess = NULL;
+
+	sess = TEE_Malloc(sizeof(*sess), TEE_MALLOC_FILL_ZERO);
+	if (!sess)
+		return TEE_ERROR_OUT_OF_MEMORY;
+
+	TEE_GenerateRandom(root_keys, sizeof(root_keys));
+	mbedtls_klad_emul_setup(&sess->ladder, root_keys[0], root_keys[1]);
+	TEE_MemFill(root_keys, 0, sizeof(root_keys));
+
+	mbedtls_klad_cache_init(&sess->klad);
+	if (mbedtls_klad_cache_setup(&sess->klad, 0, mbedtls_klad_emul_unwrap,
+				     &sess->ladder)) {
+		mbedtls_klad_emul_free(&sess->ladder);
+		TEE_Free(sess);
+		return TEE_ERROR_OUT_OF_MEMORY;
+	}
+
+	*session_ctx = sess;
+	return TEE_SUCCESS;
+}
+
+void TA_CloseSessionEntryPoint(void *session_ctx)
+{
+	struct session *sess = session_ctx;
+
+	mbedtls_klad_cache_free(&sess->klad);
+	mbedtls_klad_emul_free(&sess->ladder);
+	TEE_Free(sess);
+}
+
+TEE_Result TA_InvokeCommandEntryPoint(void *session_ctx,
+				      uint32_t cmd_id, uint32_t param_types,
+				      TEE_Param params[4])
+{
+	struct session *sess = session_ctx;
+
+	mbedtls_klad_cache_set_default(&sess->klad);
+
+	switch (cmd_id) {
+	case TA_CRYPTO_PERF_CMD_KAT:
+		return ta_entry_kat(param_types, params);
+	case TA_CRYPTO_PERF_CMD_BENCH:
+		return ta_entry_bench(param_types, params);
+	case TA_CRYPTO_PERF_CMD_SELF_TEST:
+		return ta_entry_self_test(param_types, params);
+	case TA_CRYPTO_PERF_CMD_BENCH_VERIFY:
+		return ta_entry_bench_verify(param_types, params);
+	case TA_CRYPTO_PERF_CMD_BENCH_BIGNUM:
+		return ta_entry_bench_bignum(param_types, params);
+	default:
+		return TEE_ERROR_BAD_PARAMETERS;
+	}
+}
@@ -0,0 +1,218 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2026, D-Robotics
+ */
+
+/*
+ * TA_CRYPTO_PERF_CMD_BENCH_VERIFY: ECDSA P-256 and SM2DSA verification with
+ * the generic code of libmbedtls and with ta/lib/mbedtls_ext/ecp256.c, on
+ * signatures made here by libmbedtls with random keys.
+ */
+
+#include <arm_user_sysreg.h>
+#include <crypto_perf.h>
+#include <mbedtls/ecdsa.h>
+#include <mbedtls/ecp256.h>
+#include <mbedtls/sm2dsa.h>
+#include <ta_crypto_perf.h>
+#include <tee_internal_api.h>
+#include <tee_internal_api_extensions.h>
+#include <util.h>
+
+/* Size of the hashes signed, SHA-256 or SM3 */
+#define VERIFY_HASH_SIZE	32
+
+struct verify_sig {
+	uint8_t hash[VERIFY_HASH_SIZE];
+	mbedtls_ecp_point Q;
+	mbedtls_mpi r;
+	mbedtls_mpi s;
+};
+
+struct verify_bench {
+	mbedtls_ecp_group grp;
+	uint32_t impl;
+	struct verify_sig *sigs;
+	mbedtls_ecp256_verify_job *jobs;
+	uint32_t count;
+};
+
+static int verify_rng(void *ctx __unused, unsigned char *buf, size_t len)
+{
+	TEE_GenerateRandom(buf, len);
+	return 0;
+}
+
+static TEE_Result verify_sign(struct verify_bench *vb)
+{
+	mbedtls_mpi d = { };
+	struct verify_sig *sig = NULL;
+	uint32_t n = 0;
+	int ret = 0;
+
+	mbedtls_mpi_init(&d);
+	for (n = 0; n < vb->count; n++) {
+		sig = vb->sigs + n;
+		TEE_GenerateRandom(sig->hash, sizeof(sig->hash));
+		ret = mbedtls_ecp_gen_keypair(&vb->grp, &d, &sig->Q,
+					      verify_rng, NULL);
+		if (ret)
+			break;
+		if (vb->grp.id == MBEDTLS_ECP_DP_SM2P256V1)
+			ret = mbedtls_sm2dsa_sign(&sig->r, &sig->s, &d,
+						  sig->hash, sizeof(sig->hash),
+						  verify_rng, NULL);
+		else
+			ret = mbedtls_ecdsa_sign(&vb->grp, &sig->r, &sig->s, &d,
+						 sig->hash, sizeof(sig->hash),
+						 verify_rng, NULL);
+		if (ret)
+			break;
+
+		vb->jobs[n].buf = sig->hash;
+		vb->jobs[n].blen = sizeof(sig->hash);
+		vb->jobs[n].Q = &sig->Q;
+		vb->jobs[n].r = &sig->r;
+		vb->jobs[n].s = &sig->s;
+	}
+	mbedtls_mpi_free(&d);
+
+	if (ret == MBEDTLS_ERR_ECP_ALLOC_FAILED ||
+	    ret == MBEDTLS_ERR_MPI_ALLOC_FAILED)
+		return TEE_ERROR_OUT_OF_MEMORY;
+	if (ret)
+		return TEE_ERROR_GENERIC;
+	return TEE_SUCCESS;
+}
+
+/* Verifies all the signatures once, they must all be valid */
+static TEE_Result verify_run(struct verify_bench *vb)
+{
+	struct verify_sig *sig = NULL;
+	uint32_t n = 0;
+	int ret = 0;
+
+	switch (vb->impl) {
+	case TA_CRYPTO_PERF_VERIFY_MBEDTLS:
+		for (n = 0; n < vb->count && !ret; n++) {
+			sig = vb->sigs + n;
+			if (vb->grp.id == MBEDTLS_ECP_DP_SM2P256V1)
+				ret = mbedtls_sm2dsa_verify(sig->hash,
+							    sizeof(sig->hash),
+							    &sig->Q, &sig->r,
+							    &sig->s);
+			else
+				ret = mbedtls_ecdsa_verify(&vb->grp, sig->hash,
+							   sizeof(sig->hash),
+							   &sig->Q, &sig->r,
+							   &sig->s);
+		}
+		break;
+	case TA_CRYPTO_PERF_VERIFY_ECP256:
+		for (n = 0; n < vb->count && !ret; n++) {
+			sig = vb->sigs + n;
+			ret = mbedtls_ecp256_verify(vb->grp.id, sig->hash,
+						    sizeof(sig->hash), &sig->Q,
+						    &sig->r, &sig->s);
+		}
+		break;
+	case TA_CRYPTO_PERF_VERIFY_ECP256_BATCH:
+		ret = mbedtls_ecp256_verify_batch(vb->grp.id, vb->jobs,
+						  vb->count);
+		break;
+	default:
+		return TEE_ERROR_NOT_SUPPORTED;
+	}
+
+	if (ret == MBEDTLS_ERR_ECP_ALLOC_FAILED ||
+	    ret == MBEDTLS_ERR_MPI_ALLOC_FAILED)
+		return TEE_ERROR_OUT_OF_MEMORY;
+	if (ret)
+		return TEE_ERROR_GENERIC;
+	return TEE_SUCCESS;
+}
+
+TEE_Result ta_entry_bench_verify(uint32_t param_types, TEE_Param params[4])
+{
+	struct verify_bench vb = { };
+	mbedtls_ecp_group_id grp_id = MBEDTLS_ECP_DP_NONE;
+	uint32_t iters = params[1].value.b;
+	TEE_Result res = TEE_SUCCESS;
+	uint64_t t = 0;
+	uint32_t n = 0;
+
+	if (param_types != TEE_PARAM_TYPES(TEE_PARAM_TYPE_VALUE_INPUT,
+					   TEE_PARAM_TYPE_VALUE_INPUT,
+					   TEE_PARAM_TYPE_VALUE_OUTPUT,
+					   TEE_PARAM_TYPE_VALUE_OUTPUT))
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	switch (params[0].value.a) {
+	case TEE_ECC_CURVE_NIST_P256:
+		grp_id = MBEDTLS_ECP_DP_SECP256R1;
+		break;
+	case TEE_ECC_CURVE_SM2:
+		grp_id = MBEDTLS_ECP_DP_SM2P256V1;
+		break;
+	default:
+		return TEE_ERROR_NOT_SUPPORTED;
+	}
+
+	vb.impl = params[0].value.b;
+	vb.count = params[1].value.a;
+	if (vb.impl > TA_CRYPTO_PERF_VERIFY_ECP256_BATCH)
+		return TEE_ERROR_NOT_SUPPORTED;
+	if (!vb.count || vb.count > TA_CRYPTO_PERF_VERIFY_MAX_SIGS || !iters)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	mbedtls_ecp_group_init(&vb.grp);
+	vb.sigs = TEE_Malloc(vb.count * sizeof(*vb.sigs), TEE_MALLOC_FILL_ZERO);
+	vb.jobs = TEE_Malloc(vb.count * sizeof(*vb.jobs), TEE_MALLOC_FILL_ZERO);
+	if (!vb.sigs || !vb.jobs) {
+		res = TEE_ERROR_OUT_OF_MEMORY;
+		goto out;
+	}
+	for (n = 0; n < vb.count; n++) {
+		mbedtls_ecp_point_init(&vb.sigs[n].Q);
+		mbedtls_mpi_init(&vb.sigs[n].r);
+		mbedtls_mpi_init(&vb.sigs[n].s);
+	}
+
+	if (mbedtls_ecp_group_load(&vb.grp, grp_id)) {
+		res = TEE_ERROR_NOT_SUPPORTED;
+		goto out;
+	}
+
+	res = verify_sign(&vb);
+	if (res)
+		goto out;
+
+	/* Checks the signatures and warms up the caches outside the timing */
+	res = verify_run(&vb);
+	if (res)
+		goto out;
+
+	t = barrier_read_counter_timer();
+	for (n = 0; n < iters; n++) {
+		res = verify_run(&vb);
+		if (res)
+			goto out;
+	}
+	t = barrier_read_counter_timer() - t;
+
+	reg_pair_from_64(t, &params[2].value.a, &params[2].value.b);
+	params[3].value.a = read_cntfrq();
+	params[3].value.b = 0;
+out:
+	if (vb.sigs) {
+		for (n = 0; n < vb.count; n++) {
+			mbedtls_ecp_point_free(&vb.sigs[n].Q);
+			mbedtls_mpi_free(&vb.sigs[n].r);
+			mbedtls_mpi_free(&vb.sigs[n].s);
+		}
+	}
+	TEE_Free(vb.sigs);
+	TEE_Free(vb.jobs);
+	mbedtls_ecp_group_free(&vb.grp);
+	return res;
+}
@@ -0,0 +1,4 @@
+LOCAL_PATH := $(call my-dir)
+
+local_module := c5e0d1a4-8f27-4b6e-a3d9-5e71b04c2f18.ta
+include $(BUILD_OPTEE_MK)
@@ -0,0 +1,71 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Copyright (c) 2026, D-Robotics
+ */
+
+#ifndef TA_LOAD_PERF_H
+#define TA_LOAD_PERF_H
+
+#include <stdint.h>
+
+#define TA_LOAD_PERF_UUID { 0xc5e0d1a4, 0x8f27, 0x4b6e, \
+	{ 0xa3, 0xd9, 0x5e, 0x71, 0xb0, 0x4c, 0x2f, 0x18 } }
+
+/*
+ * The variants of ta/demo/load_perf_variant, built from the matrix of
+ * variants.mk, differ only in the last byte of their UUID, their index
+ */
+#define TA_LOAD_PERF_VARIANT_UUID(index) { 0x6e1f0c2a, 0x5d3b, 0x4a7e, \
+	{ 0x9c, 0x41, 0x0b, 0x8f, 0x2d, 0x7a, 0x31, (index) } }
+#define TA_LOAD_PERF_MAX_VARIANTS	256
+
+/*
+ * Open a session to a variant, invoke it twice and close the session, as
+ * many times as there is room for samples
+ *
+ * [in]		value[0].a	Index of the variant
+ * [in]		value[0].b	TA_LOAD_PERF_MODE_*
+ * [out]	memref[1]	struct load_perf_sample of each iteration
+ * [out]	value[2].a	Image padding of the variant in KiB
+ * [out]	value[2].b	TA_LOAD_PERF_F_* of the variant
+ * [out]	value[3].a	Counter frequency in Hz
+ * [out]	value[3].b	Global C++ objects of the variant
+ *
+ * Returns TEE_ERROR_ITEM_NOT_FOUND if the variant is not installed.
+ */
+#define TA_LOAD_PERF_CMD_RUN		0
+
+/* No other session to the variant, each open loads the TA */
+#define TA_LOAD_PERF_MODE_COLD		0
+/*
+ * A session opened and invoked before the iterations keeps the instance
+ * and what it loaded on the first invoke
+ */
+#define TA_LOAD_PERF_MODE_WARM		1
+
+/* Counter ticks of each step of an iteration */
+struct load_perf_sample {
+	uint32_t open;		/* TEE_OpenTASession() */
+	uint32_t first_invoke;	/* TA_LOAD_PERF_VARIANT_CMD_INFO */
+	uint32_t invoke;	/* TA_LOAD_PERF_VARIANT_CMD_NOP */
+	uint32_t close;		/* TEE_CloseTASession() */
+};
+
+/*
+ * Commands of the variants
+ *
+ * The first TA_LOAD_PERF_VARIANT_CMD_INFO of an instance does what the
+ * variant defers to its first use, such as dlopen().
+ *
+ * [out]	value[0].a	Image padding in KiB
+ * [out]	value[0].b	TA_LOAD_PERF_F_*
+ * [out]	value[1].a	Global C++ objects
+ */
+#define TA_LOAD_PERF_VARIANT_CMD_INFO	0
+#define TA_LOAD_PERF_VARIANT_CMD_NOP	1
+
+#define TA_LOAD_PERF_F_ENCRYPTED	0x1	/* CFG_ENCRYPT_TA=y */
+#define TA_LOAD_PERF_F_SHLIB		0x2	/* Linked with libos_test */
+#define TA_LOAD_PERF_F_DLOPEN		0x4	/* dlopen()s os_test_lib_dl */
+
+#endif /*TA_LOAD_PERF_H*/
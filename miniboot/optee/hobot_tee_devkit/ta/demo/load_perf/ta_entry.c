@@ -0,0 +1,184 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2026, D-Robotics
+ */
+
+#include <arm_user_sysreg.h>
+#include <string.h>
+#include <ta_load_perf.h>
+#include <tee_internal_api.h>
+#include <tee_internal_api_extensions.h>
+#include <tee_ta_api.h>
+
+struct variant_info {
+	uint32_t image_kib;
+	uint32_t flags;
+	uint32_t cxx_objs;
+};
+
+TEE_Result TA_CreateEntryPoint(void)
+{
+	return TEE_SUCCESS;
+}
+
+void TA_DestroyEntryPoint(void)
+{
+}
+
+TEE_Result TA_OpenSessionEntryPoint(uint32_t param_types __unused,
+				    TEE_Param params[4] __unused,
+				    void **session_ctx __unused)
+{
+	return TEE_SUCCESS;
+}
+
+void TA_CloseSessionEntryPoint(void *session_ctx __unused)
+{
+}
+
+static TEE_Result open_variant(uint32_t index, TEE_TASessionHandle *sess,
+			       uint32_t *ticks)
+{
+	TEE_UUID uuid = TA_LOAD_PERF_VARIANT_UUID(index);
+	TEE_Result res = TEE_ERROR_GENERIC;
+	uint32_t ret_orig = 0;
+	uint64_t t = 0;
+
+	t = barrier_read_counter_timer();
+	res = TEE_OpenTASession(&uuid, TEE_TIMEOUT_INFINITE, 0, NULL, sess,
+				&ret_orig);
+	*ticks = barrier_read_counter_timer() - t;
+	if (res && res != TEE_ERROR_ITEM_NOT_FOUND)
+		EMSG("Variant %#"PRIx32": TEE_OpenTASession: %#"PRIx32
+		     " origin %#"PRIx32, index, res, ret_orig);
+
+	return res;
+}
+
+static TEE_Result invoke_variant(TEE_TASessionHandle sess, uint32_t cmd,
+				 struct variant_info *info, uint32_t *ticks)
+{
+	TEE_Param params[TEE_NUM_PARAMS] = { };
+	TEE_Result res = TEE_ERROR_GENERIC;
+	uint32_t ret_orig = 0;
+	uint32_t types = TEE_PARAM_TYPES(TEE_PARAM_TYPE_VALUE_OUTPUT,
+					 TEE_PARAM_TYPE_VALUE_OUTPUT,
+					 TEE_PARAM_TYPE_NONE,
+					 TEE_PARAM_TYPE_NONE);
+	uint64_t t = 0;
+
+	if (cmd != TA_LOAD_PERF_VARIANT_CMD_INFO)
+		types = TEE_PARAM_TYPE_NONE;
+
+	t = barrier_read_counter_timer();
+	res = TEE_InvokeTACommand(sess, TEE_TIMEOUT_INFINITE, cmd, types,
+				  params, &ret_orig);
+	*ticks = barrier_read_counter_timer() - t;
+	if (res) {
+		EMSG("Variant command %"PRIu32": %#"PRIx32" origin %#"PRIx32,
+		     cmd, res, ret_orig);
+		return res;
+	}
+
+	if (info) {
+		info->image_kib = params[0].value.a;
+		info->flags = params[0].value.b;
+		info->cxx_objs = params[1].value.a;
+	}
+
+	return TEE_SUCCESS;
+}
+
+static TEE_Result run_once(uint32_t index, struct load_perf_sample *s,
+			   struct variant_info *info)
+{
+	TEE_TASessionHandle sess = TEE_HANDLE_NULL;
+	TEE_Result res = TEE_ERROR_GENERIC;
+	uint64_t t = 0;
+
+	res = open_variant(index, &sess, &s->open);
+	if (res)
+		return res;
+
+	res = invoke_variant(sess, TA_LOAD_PERF_VARIANT_CMD_INFO, info,
+			     &s->first_invoke);
+	if (!res)
+		res = invoke_variant(sess, TA_LOAD_PERF_VARIANT_CMD_NOP, NULL,
+				     &s->invoke);
+
+	t = barrier_read_counter_timer();
+	TEE_CloseTASession(sess);
+	s->close = barrier_read_counter_timer() - t;
+
+	return res;
+}
+
+static TEE_Result ta_entry_run(uint32_t param_types, TEE_Param params[4])
+{
+	TEE_TASessionHandle holder = TEE_HANDLE_NULL;
+	TEE_Result res = TEE_ERROR_GENERIC;
+	struct load_perf_sample s = { };
+	struct variant_info info = { };
+	uint32_t index = 0;
+	uint32_t ticks = 0;
+	uint8_t *out = NULL;
+	size_t count = 0;
+	size_t n = 0;
+
+	if (param_types != TEE_PARAM_TYPES(TEE_PARAM_TYPE_VALUE_INPUT,
+					   TEE_PARAM_TYPE_MEMREF_OUTPUT,
+					   TEE_PARAM_TYPE_VALUE_OUTPUT,
+					   TEE_PARAM_TYPE_VALUE_OUTPUT))
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	index = params[0].value.a;
+	if (index >= TA_LOAD_PERF_MAX_VARIANTS ||
+	    params[0].value.b > TA_LOAD_PERF_MODE_WARM)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	out = params[1].memref.buffer;
+	count = params[1].memref.size / sizeof(s);
+	if (!count)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	if (params[0].value.b == TA_LOAD_PERF_MODE_WARM) {
+		res = open_variant(index, &holder, &ticks);
+		if (res)
+			return res;
+		res = invoke_variant(holder, TA_LOAD_PERF_VARIANT_CMD_INFO,
+				     &info, &ticks);
+		if (res)
+			goto out;
+	}
+
+	for (n = 0; n < count; n++) {
+		res = run_once(index, &s, &info);
+		if (res)
+			goto out;
+		/* The memref is not aligned for the samples */
+		memcpy(out + n * sizeof(s), &s, sizeof(s));
+	}
+
+	params[1].memref.size = count * sizeof(s);
+	params[2].value.a = info.image_kib;
+	params[2].value.b = info.flags;
+	params[3].value.a = read_cntfrq();
+	params[3].value.b = info.cxx_objs;
+out:
+	if (holder != TEE_HANDLE_NULL)
+		TEE_CloseTASession(holder);
+
+	return res;
+}
+
+TEE_Result TA_InvokeCommandEntryPoint(void *session_ctx __unused,
+				      uint32_t cmd_id, uint32_t param_types,
+				      TEE_Param params[4])
+{
+	switch (cmd_id) {
+	case TA_LOAD_PERF_CMD_RUN:
+		return ta_entry_run(param_types, params);
+	default:
+		return TEE_ERROR_BAD_PARAMETERS;
+	}
+}
@@ -0,0 +1,9 @@
+global-incdirs-y += include
+global-incdirs-y += ../load_perf/include
+global-incdirs-y += ../os_test_lib/include
+srcs-y += variant.c
+ifneq ($(lp-cxx-objs),0)
+# No -pg, as for the C++ tests of os_test
+srcs-y += variant_cxx.cpp
+cxxflags-remove-variant_cxx.cpp-y += -pg
+endif
@@ -0,0 +1,137 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2026, D-Robotics
+ */
+
+#include <ta_load_perf.h>
+#include <tee_internal_api.h>
+#include <tee_internal_api_extensions.h>
+#include <tee_ta_api.h>
+
+#if defined(LOAD_PERF_SHLIB)
+#include <os_test_lib.h>
+#endif
+#if defined(LOAD_PERF_DLOPEN)
+#include <dlfcn.h>
+#endif
+
+#if LOAD_PERF_IMAGE_KIB
+/* Part of the image the loader hashes, and decrypts if encrypted */
+static const uint8_t image_pad[LOAD_PERF_IMAGE_KIB * 1024] = { 1 };
+#endif
+
+#if LOAD_PERF_CXX_OBJS
+/* See variant_cxx.cpp */
+uint32_t load_perf_cxx_constructed(void);
+#endif
+
+static bool first_done;
+
+static uint32_t variant_flags(void)
+{
+	uint32_t flags = 0;
+
+#if defined(LOAD_PERF_ENCRYPTED)
+	flags |= TA_LOAD_PERF_F_ENCRYPTED;
+#endif
+#if defined(LOAD_PERF_SHLIB)
+	flags |= TA_LOAD_PERF_F_SHLIB;
+#endif
+#if defined(LOAD_PERF_DLOPEN)
+	flags |= TA_LOAD_PERF_F_DLOPEN;
+#endif
+
+	return flags;
+}
+
+/* What the variant defers to the first invoke of an instance */
+static TEE_Result first_invoke(void)
+{
+#if defined(LOAD_PERF_DLOPEN)
+	int (*add_func)(int a, int b) = NULL;
+	void *handle = NULL;
+
+	handle = dlopen("b3091a65-9751-4784-abf7-0298a7cc35ba",
+			RTLD_NOW | RTLD_GLOBAL | RTLD_NODELETE);
+	if (!handle)
+		return TEE_ERROR_GENERIC;
+
+	add_func = dlsym(handle, "os_test_shlib_dl_add");
+	if (!add_func || add_func(3, 4) != 7)
+		return TEE_ERROR_GENERIC;
+#endif
+
+	return TEE_SUCCESS;
+}
+
+static TEE_Result ta_entry_info(uint32_t param_types, TEE_Param params[4])
+{
+	TEE_Result res = TEE_ERROR_GENERIC;
+
+	if (param_types != TEE_PARAM_TYPES(TEE_PARAM_TYPE_VALUE_OUTPUT,
+					   TEE_PARAM_TYPE_VALUE_OUTPUT,
+					   TEE_PARAM_TYPE_NONE,
+					   TEE_PARAM_TYPE_NONE))
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	if (!first_done) {
+		res = first_invoke();
+		if (res)
+			return res;
+		first_done = true;
+	}
+
+#if LOAD_PERF_IMAGE_KIB
+	/* Keep the padding from being garbage collected */
+	if (*(const volatile uint8_t *)image_pad != 1)
+		return TEE_ERROR_GENERIC;
+#endif
+#if defined(LOAD_PERF_SHLIB)
+	if (os_test_shlib_add(1, 2) != 3)
+		return TEE_ERROR_GENERIC;
+#endif
+#if LOAD_PERF_CXX_OBJS
+	if (load_perf_cxx_constructed() != LOAD_PERF_CXX_OBJS)
+		return TEE_ERROR_GENERIC;
+#endif
+
+	params[0].value.a = LOAD_PERF_IMAGE_KIB;
+	params[0].value.b = variant_flags();
+	params[1].value.a = LOAD_PERF_CXX_OBJS;
+
+	return TEE_SUCCESS;
+}
+
+TEE_Result TA_CreateEntryPoint(void)
+{
+	return TEE_SUCCESS;
+}
+
+void TA_DestroyEntryPoint(void)
+{
+}
+
+TEE_Result TA_OpenSessionEntryPoint(uint32_t param_types __unused,
+				    TEE_Param params[4] __unused,
+				    void **session_ctx __unused)
+{
+	return TEE_SUCCESS;
+}
+
+void TA_CloseSessionEntryPoint(void *session_ctx __unused)
+{
+}
+
+TEE_Result TA_InvokeCommandEntryPoint(void *session_ctx __unused,
+				      uint32_t cmd_id, uint32_t param_types,
+				      TEE_Param params[4])
+{
+	switch (cmd_id) {
+	case TA_LOAD_PERF_VARIANT_CMD_INFO:
+		return ta_entry_info(param_types, params);
+	case TA_LOAD_PERF_VARIANT_CMD_NOP:
+		return TEE_SUCCESS;
+	default:
+		return TEE_ERROR_BAD_PARAMETERS;
+	}
+}
@@ -0,0 +1,34 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2026, D-Robotics
+ */
+
+extern "C" {
+
+#include <stdint.h>
+
+uint32_t load_perf_cxx_constructed(void);
+
+};
+
+static uint32_t constructed;
+
+/* Global objects whose constructors run when the TA is loaded */
+class Table {
+public:
+	Table()
+	{
+		for (unsigned int n = 0; n < sizeof(vals) / sizeof(vals[0]); n++)
+			vals[n] = n * 0x9E3779B1U;
+		constructed++;
+	}
+
+	uint32_t vals[16];
+};
+
+static Table tables[LOAD_PERF_CXX_OBJS];
+
+uint32_t load_perf_cxx_constructed(void)
+{
+	return constructed + tables[0].vals[0];
+}
@@ -0,0 +1,24 @@
+# Matrix of the load_perf_variant TAs that ta/demo/Makefile builds, one
+# entry <index>:<image KiB>:<encrypted>:<libs>:<C++ objects> per TA:
+#
+#   index        Last byte of the UUID, two hex digits, see ta_load_perf.h
+#   image KiB    Read-only data added to the image, which the loader hashes
+#                and, if encrypted, decrypts
+#   encrypted    y to encrypt the TA with TA_ENC_KEY, as CFG_ENCRYPT_TA=y
+#                does, the core has to support it
+#   libs         none, shlib to link with libos_test, which ldelf loads
+#                with the TA, or dl to dlopen() os_test_lib_dl on the first
+#                invoke
+#   C++ objects  Global objects with a constructor, 0 for a C only TA.
+#                Entries with C++ are only built with WITH_CXX_TESTS=y.
+#
+# Add an entry with a new index to measure another combination.
+LOAD_PERF_VARIANTS := \
+	00:0:n:none:0 \
+	01:256:n:none:0 \
+	02:1024:n:none:0 \
+	03:0:y:none:0 \
+	04:1024:y:none:0 \
+	05:0:n:shlib:0 \
+	06:0:n:dl:0 \
+	07:0:n:none:256
@@ -44,5 +44,8 @@ TEE_Result ta_entry_memtag_use_after_free(void);
 TEE_Result ta_entry_memtag_invalid_tag(void);
 TEE_Result ta_entry_memtag_double_free(void);
 TEE_Result ta_entry_memtag_buffer_overrun(void);
+TEE_Result ta_entry_heap_prof(uint32_t param_types, TEE_Param params[4]);
+TEE_Result ta_entry_ta2ta_batch(uint32_t param_types, TEE_Param params[4]);
+TEE_Result ta_entry_binlog(uint32_t param_types, TEE_Param params[4]);
 
 #endif /*OS_TEST_H */
@@ -46,5 +46,8 @@
 #define TA_OS_TEST_CMD_MEMTAG_INVALID_TAG   34
 #define TA_OS_TEST_CMD_MEMTAG_DOUBLE_FREE   35
 #define TA_OS_TEST_CMD_MEMTAG_BUFFER_OVERRUN 36
+#define TA_OS_TEST_CMD_HEAP_PROF            37
+#define TA_OS_TEST_CMD_TA2TA_BATCH          38
+#define TA_OS_TEST_CMD_BINLOG               39
 
 #endif /*TA_OS_TEST_H */
@@ -4,6 +4,7 @@
  * All rights reserved.
  * Copyright (c) 2022, Linaro Limited.
  */
+#include <arm_user_sysreg.h>
 #include <compiler.h>
 #include <dlfcn.h>
 #include <link.h>
@@ -11,6 +12,7 @@
 #include <setjmp.h>
 #include <stdint.h>
 #include <string.h>
+#include <ta_batch.h>
 #include <ta_crypt.h>
 #include <ta_os_test.h>
 #include <tee_internal_api_extensions.h>
@@ -19,6 +21,14 @@
 #include "test_float_subj.h"
 #include "os_test_lib.h"
 
+#if defined(CFG_TA_HEAP_PROF)
+#include <heap_prof.h>
+#endif
+
+#if defined(CFG_TA_BINLOG)
+#include <binlog.h>
+#endif
+
 enum p_type {
 	P_TYPE_BOOL,
 	P_TYPE_INT,
@@ -1159,6 +1169,167 @@ TEE_Result ta_entry_ta2ta_memref_mix(uint32_t param_types, TEE_Param params[4])
 	return TEE_SUCCESS;
 }
 
+static void ta2ta_batch_fill(size_t n, size_t bufsize, uint8_t *in,
+			     uint8_t *inout, uint8_t *out)
+{
+	size_t i = 0;
+
+	for (i = 0; i < n * bufsize; i++) {
+		in[i] = i / bufsize;
+		inout[i] = 10;
+		out[i] = 0;
+	}
+}
+
+static TEE_Result ta2ta_batch_check(size_t n, size_t bufsize, uint8_t *in,
+				    uint8_t *inout, uint8_t *out)
+{
+	size_t i = 0;
+
+	for (i = 0; i < n * bufsize; i++) {
+		if (in[i] != (uint8_t)(i / bufsize) || inout[i] != 11 ||
+		    out[i] != (uint8_t)(in[i] + 11)) {
+			EMSG("Unexpected value at %zu of invoke %zu",
+			     i % bufsize, i / bufsize);
+			return TEE_ERROR_GENERIC;
+		}
+	}
+
+	return TEE_SUCCESS;
+}
+
+static uint32_t ticks_to_us(uint64_t ticks)
+{
+	return ticks * 1000000 / read_cntfrq();
+}
+
+/*
+ * Invokes TA_OS_TEST_CMD_TA2TA_MEMREF_MIX params[0].value.a times on
+ * buffers of params[0].value.b bytes, once with TEE_InvokeTACommand()
+ * each and once as a batch of ta_batch_invoke(). params[1] returns the
+ * time both took, in microseconds.
+ */
+TEE_Result ta_entry_ta2ta_batch(uint32_t param_types, TEE_Param params[4])
+{
+	static const TEE_UUID test_uuid = TA_OS_TEST_UUID;
+	TEE_TASessionHandle sess = TEE_HANDLE_NULL;
+	struct ta_batch_entry *entries = NULL;
+	TEE_Param l_params[4] = { };
+	TEE_Result res = TEE_ERROR_GENERIC;
+	uint32_t ret_orig = 0;
+	uint32_t l_pts = 0;
+	uint8_t *in = NULL;
+	uint8_t *inout = NULL;
+	uint8_t *out = NULL;
+	uint64_t t = 0;
+	size_t bufsize = 0;
+	size_t done = 0;
+	size_t n = 0;
+	size_t i = 0;
+
+	if (param_types != TEE_PARAM_TYPES(TEE_PARAM_TYPE_VALUE_INPUT,
+					   TEE_PARAM_TYPE_VALUE_OUTPUT,
+					   TEE_PARAM_TYPE_NONE,
+					   TEE_PARAM_TYPE_NONE))
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	n = params[0].value.a;
+	bufsize = params[0].value.b;
+	if (!n || n > TA_BATCH_MAX_ENTRIES || !bufsize ||
+	    bufsize > TA2TA_BUF_SIZE)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	in = TEE_Malloc(n * bufsize, 0);
+	inout = TEE_Malloc(n * bufsize, 0);
+	out = TEE_Malloc(n * bufsize, 0);
+	entries = TEE_Malloc(n * sizeof(*entries), 0);
+	if (!in || !inout || !out || !entries) {
+		res = TEE_ERROR_OUT_OF_MEMORY;
+		goto out;
+	}
+
+	res = TEE_OpenTASession(&test_uuid, TEE_TIMEOUT_INFINITE, 0, NULL,
+				&sess, &ret_orig);
+	if (res != TEE_SUCCESS) {
+		EMSG("TEE_OpenTASession failed");
+		goto out;
+	}
+
+	l_pts = TEE_PARAM_TYPES(TEE_PARAM_TYPE_MEMREF_INPUT,
+				TEE_PARAM_TYPE_MEMREF_INOUT,
+				TEE_PARAM_TYPE_MEMREF_OUTPUT, 0);
+
+	ta2ta_batch_fill(n, bufsize, in, inout, out);
+	t = read_cntvct();
+	for (i = 0; i < n; i++) {
+		l_params[0].memref.buffer = in + i * bufsize;
+		l_params[0].memref.size = bufsize;
+		l_params[1].memref.buffer = inout + i * bufsize;
+		l_params[1].memref.size = bufsize;
+		l_params[2].memref.buffer = out + i * bufsize;
+		l_params[2].memref.size = bufsize;
+		res = TEE_InvokeTACommand(sess, TEE_TIMEOUT_INFINITE,
+					  TA_OS_TEST_CMD_TA2TA_MEMREF_MIX,
+					  l_pts, l_params, &ret_orig);
+		if (res != TEE_SUCCESS) {
+			EMSG("TEE_InvokeTACommand failed");
+			goto out;
+		}
+	}
+	params[1].value.a = ticks_to_us(read_cntvct() - t);
+
+	res = ta2ta_batch_check(n, bufsize, in, inout, out);
+	if (res != TEE_SUCCESS)
+		goto out;
+
+	ta2ta_batch_fill(n, bufsize, in, inout, out);
+	t = read_cntvct();
+	for (i = 0; i < n; i++) {
+		entries[i].cmd = TA_OS_TEST_CMD_TA2TA_MEMREF_MIX;
+		entries[i].param_types = l_pts;
+		entries[i].params[0].memref.buffer = in + i * bufsize;
+		entries[i].params[0].memref.size = bufsize;
+		entries[i].params[1].memref.buffer = inout + i * bufsize;
+		entries[i].params[1].memref.size = bufsize;
+		entries[i].params[2].memref.buffer = out + i * bufsize;
+		entries[i].params[2].memref.size = bufsize;
+	}
+	res = ta_batch_invoke(sess, TEE_TIMEOUT_INFINITE, entries, n, 0,
+			      &done, &ret_orig);
+	params[1].value.b = ticks_to_us(read_cntvct() - t);
+	if (res != TEE_SUCCESS) {
+		EMSG("ta_batch_invoke failed at entry %zu", done);
+		goto out;
+	}
+
+	res = ta2ta_batch_check(n, bufsize, in, inout, out);
+	if (res != TEE_SUCCESS)
+		goto out;
+
+	/* A failing entry stops the batch, the entries after it do not run */
+	entries[0].param_types = TEE_PARAM_TYPES(0, 0, 0, 0);
+	res = ta_batch_invoke(sess, TEE_TIMEOUT_INFINITE, entries, n, 0,
+			      &done, &ret_orig);
+	if (res != TEE_ERROR_GENERIC || ret_orig != TEE_ORIGIN_TRUSTED_APP ||
+	    done != 1) {
+		EMSG("Unexpected result %#"PRIx32" of a failing batch", res);
+		res = TEE_ERROR_GENERIC;
+		goto out;
+	}
+	res = TEE_SUCCESS;
+
+	DMSG("%zu invokes of %zu bytes: %"PRIu32" us, batched: %"PRIu32" us",
+	     n, bufsize, params[1].value.a, params[1].value.b);
+
+out:
+	TEE_CloseTASession(sess);
+	TEE_Free(entries);
+	TEE_Free(in);
+	TEE_Free(inout);
+	TEE_Free(out);
+	return res;
+}
+
 TEE_Result ta_entry_params(uint32_t param_types, TEE_Param params[4])
 {
 	size_t n = 0;
@@ -1529,4 +1700,42 @@ TEE_Result ta_entry_memtag_buffer_overrun(void)
 	return TEE_ERROR_GENERIC;
 }
 
+#if defined(CFG_TA_HEAP_PROF)
+TEE_Result ta_entry_heap_prof(uint32_t param_types, TEE_Param params[4])
+{
+	TEE_Result res = TEE_ERROR_GENERIC;
+	size_t len = 0;
+
+	if (param_types != TEE_PARAM_TYPES(TEE_PARAM_TYPE_MEMREF_OUTPUT,
+					   TEE_PARAM_TYPE_NONE,
+					   TEE_PARAM_TYPE_NONE,
+					   TEE_PARAM_TYPE_NONE))
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	len = params[0].memref.size;
+	res = heap_prof_drain(params[0].memref.buffer, &len);
+	params[0].memref.size = len;
+
+	return res;
+}
+#endif
 
+#if defined(CFG_TA_BINLOG)
+TEE_Result ta_entry_binlog(uint32_t param_types, TEE_Param params[4])
+{
+	TEE_Result res = TEE_ERROR_GENERIC;
+	size_t len = 0;
+
+	if (param_types != TEE_PARAM_TYPES(TEE_PARAM_TYPE_MEMREF_OUTPUT,
+					   TEE_PARAM_TYPE_NONE,
+					   TEE_PARAM_TYPE_NONE,
+					   TEE_PARAM_TYPE_NONE))
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	len = params[0].memref.size;
+	res = binlog_drain(params[0].memref.buffer, &len);
+	params[0].memref.size = len;
+
+	return res;
+}
+#endif
@@ -6,6 +6,7 @@
 #include <stdint.h>
 #include <init.h>
 #include <os_test.h>
+#include <ta_batch.h>
 #include <ta_os_test.h>
 #include <tee_internal_api_extensions.h>
 #include <tee_ta_api.h>
@@ -178,6 +179,29 @@ TEE_Result TA_InvokeCommandEntryPoint(void *pSessionContext,
 	case TA_OS_TEST_CMD_ATTESTATION:
 		return ta_entry_attestation(nParamTypes, pParams);
 
+#if defined(CFG_TA_HEAP_PROF)
+	case TA_OS_TEST_CMD_HEAP_PROF:
+		return ta_entry_heap_prof(nParamTypes, pParams);
+#else
+	case TA_OS_TEST_CMD_HEAP_PROF:
+		return TEE_ERROR_NOT_SUPPORTED;
+#endif
+
+	case TA_OS_TEST_CMD_TA2TA_BATCH:
+		return ta_entry_ta2ta_batch(nParamTypes, pParams);
+
+#if defined(CFG_TA_BINLOG)
+	case TA_OS_TEST_CMD_BINLOG:
+		return ta_entry_binlog(nParamTypes, pParams);
+#else
+	case TA_OS_TEST_CMD_BINLOG:
+		return TEE_ERROR_NOT_SUPPORTED;
+#endif
+
+	case TA_BATCH_CMD_INVOKE:
+		return ta_batch_dispatch(pSessionContext, nParamTypes, pParams,
+					 TA_InvokeCommandEntryPoint);
+
 	default:
 		return TEE_ERROR_BAD_PARAMETERS;
 	}
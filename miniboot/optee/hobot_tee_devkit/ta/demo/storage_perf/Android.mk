@@ -0,0 +1,4 @@
+LOCAL_PATH := $(call my-dir)
+
+local_module := b4bb216a-15ee-4795-b1de-3682cb57642c.ta
+include $(BUILD_OPTEE_MK)
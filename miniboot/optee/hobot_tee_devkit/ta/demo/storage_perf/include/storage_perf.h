@@ -0,0 +1,16 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Copyright (c) 2026, D-Robotics
+ */
+
+#ifndef STORAGE_PERF_H
+#define STORAGE_PERF_H
+
+#include <tee_api.h>
+
+TEE_Result ta_entry_fs_htree(uint32_t param_types, TEE_Param params[4]);
+TEE_Result ta_entry_write(uint32_t param_types, TEE_Param params[4]);
+TEE_Result ta_entry_read(uint32_t param_types, TEE_Param params[4]);
+TEE_Result ta_entry_get_freq(uint32_t param_types, TEE_Param params[4]);
+
+#endif /*STORAGE_PERF_H*/
@@ -0,0 +1,73 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Copyright (c) 2026, D-Robotics
+ */
+
+#ifndef TA_STORAGE_PERF_H
+#define TA_STORAGE_PERF_H
+
+#include <stdint.h>
+
+#define TA_STORAGE_PERF_UUID { 0xb4bb216a, 0x15ee, 0x4795, \
+	{ 0xb1, 0xde, 0x36, 0x82, 0xcb, 0x57, 0x64, 0x2c } }
+
+/*
+ * Run the hash tree tests of the core, PTA_INVOKE_TESTS_CMD_FS_HTREE,
+ * before the storage is measured. Returns TEE_ERROR_NOT_SUPPORTED if the
+ * core is built without the invoke tests PTA.
+ */
+#define TA_STORAGE_PERF_CMD_FS_HTREE	0
+
+/*
+ * Measure writes to a persistent object created with random data, then
+ * check what the object holds
+ *
+ * [in]		value[0].a	Order of the writes, TA_STORAGE_PERF_PATTERN_*
+ * [in]		value[0].b	Size of the object, at most
+ *				TA_STORAGE_PERF_MAX_SIZE
+ * [in]		value[1].a	Size of each write
+ * [in]		value[1].b	Number of writes
+ * [in]		value[2].a	TA_STORAGE_PERF_FLAG_*
+ * [out]	value[2].b	Number of TEE_WriteObjectData() calls
+ * [out]	value[3].a	Elapsed counter ticks, high 32 bits
+ * [out]	value[3].b	Elapsed counter ticks, low 32 bits
+ *
+ * The time of TA_STORAGE_PERF_FLAG_CACHED includes pobj_cache_fini(),
+ * which writes the dirty blocks.
+ */
+#define TA_STORAGE_PERF_CMD_WRITE	1
+
+/* Get the counter frequency in Hz in value[0].a */
+#define TA_STORAGE_PERF_CMD_GET_FREQ	2
+
+/*
+ * Measure reads of a persistent object created with random data, each
+ * checked outside of the timing
+ *
+ * [in]		value[0].a	Order of the reads, TA_STORAGE_PERF_PATTERN_*
+ * [in]		value[0].b	Size of the object, at most
+ *				TA_STORAGE_PERF_MAX_SIZE
+ * [in]		value[1].a	Size of each read
+ * [in]		value[1].b	Number of reads
+ * [in]		value[2].a	TA_STORAGE_PERF_FLAG_*
+ * [out]	value[2].b	Number of TEE_ReadObjectData() calls
+ * [out]	value[3].a	Elapsed counter ticks, high 32 bits
+ * [out]	value[3].b	Elapsed counter ticks, low 32 bits
+ *
+ * With TA_STORAGE_PERF_FLAG_MAP, each read is of the whole object with
+ * pobj_map_read(), the order and the size of the reads are ignored.
+ */
+#define TA_STORAGE_PERF_CMD_READ	3
+
+#define TA_STORAGE_PERF_PATTERN_SEQ	0
+#define TA_STORAGE_PERF_PATTERN_STRIDE	1 /* Every 7th write-sized slot */
+#define TA_STORAGE_PERF_PATTERN_RANDOM	2
+
+/* Go through pobj_cache instead of writing the object directly */
+#define TA_STORAGE_PERF_FLAG_CACHED	0x1
+/* Read into memory mapped by pobj_map_read(), reads only */
+#define TA_STORAGE_PERF_FLAG_MAP	0x2
+
+#define TA_STORAGE_PERF_MAX_SIZE	(1024 * 1024)
+
+#endif /*TA_STORAGE_PERF_H*/
@@ -0,0 +1,426 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2026, D-Robotics
+ */
+
+/*
+ * TA_STORAGE_PERF_CMD_WRITE and TA_STORAGE_PERF_CMD_READ: small writes and
+ * reads of a persistent object of the REE FS, each with
+ * TEE_WriteObjectData() or TEE_ReadObjectData() or through
+ * ta/lib/ta_ext/pobj_cache.c, and loads of the whole object with
+ * pobj_map_read().
+ */
+
+#include <arm_user_sysreg.h>
+#include <pobj_cache.h>
+#include <pta_invoke_tests.h>
+#include <storage_perf.h>
+#include <string.h>
+#include <ta_storage_perf.h>
+#include <tee_internal_api.h>
+#include <tee_internal_api_extensions.h>
+#include <util.h>
+
+#define STORAGE_PERF_STRIDE		7
+#define STORAGE_PERF_CACHE_BLOCKS	64
+#define STORAGE_PERF_IO_BLOCKS		16
+
+static const char storage_perf_id[] = "storage_perf.obj";
+
+struct bench {
+	uint32_t pattern;
+	uint32_t size;
+	uint32_t chunk;		/* Size of each read or write */
+	uint32_t count;
+	uint32_t slots;
+	uint32_t seed;
+	uint8_t *ref;		/* What the object is expected to hold */
+	uint8_t *buf;		/* @chunk bytes to write or read */
+};
+
+/* xorshift32, cheap enough to not weigh in the timing */
+static uint32_t bench_rand(struct bench *b)
+{
+	uint32_t x = b->seed;
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	b->seed = x;
+
+	return x;
+}
+
+static uint32_t bench_offset(struct bench *b, uint32_t n)
+{
+	switch (b->pattern) {
+	case TA_STORAGE_PERF_PATTERN_STRIDE:
+		return (uint32_t)(((uint64_t)n * STORAGE_PERF_STRIDE) %
+				  b->slots) * b->chunk;
+	case TA_STORAGE_PERF_PATTERN_RANDOM:
+		return (bench_rand(b) % b->slots) * b->chunk;
+	default:
+		return (n % b->slots) * b->chunk;
+	}
+}
+
+/*
+ * Checks the parameters common to TA_STORAGE_PERF_CMD_WRITE and
+ * TA_STORAGE_PERF_CMD_READ, then creates the object with random data
+ */
+static TEE_Result bench_setup(struct bench *b, uint32_t param_types,
+			      TEE_Param params[4], TEE_ObjectHandle *obj)
+{
+	const uint32_t flags = TEE_DATA_FLAG_ACCESS_READ |
+			       TEE_DATA_FLAG_ACCESS_WRITE |
+			       TEE_DATA_FLAG_ACCESS_WRITE_META |
+			       TEE_DATA_FLAG_OVERWRITE;
+	TEE_Result res = TEE_ERROR_GENERIC;
+
+	if (param_types != TEE_PARAM_TYPES(TEE_PARAM_TYPE_VALUE_INPUT,
+					   TEE_PARAM_TYPE_VALUE_INPUT,
+					   TEE_PARAM_TYPE_VALUE_INOUT,
+					   TEE_PARAM_TYPE_VALUE_OUTPUT))
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	b->pattern = params[0].value.a;
+	b->size = params[0].value.b;
+	b->chunk = params[1].value.a;
+	b->count = params[1].value.b;
+	if (b->pattern > TA_STORAGE_PERF_PATTERN_RANDOM ||
+	    b->size > TA_STORAGE_PERF_MAX_SIZE || !b->chunk ||
+	    b->chunk > b->size || !b->count)
+		return TEE_ERROR_BAD_PARAMETERS;
+	b->slots = b->size / b->chunk;
+
+	b->ref = TEE_Malloc(b->size, TEE_MALLOC_FILL_ZERO);
+	b->buf = TEE_Malloc(b->chunk, TEE_MALLOC_FILL_ZERO);
+	if (!b->ref || !b->buf)
+		return TEE_ERROR_OUT_OF_MEMORY;
+
+	TEE_GenerateRandom(b->ref, b->size);
+	TEE_GenerateRandom(&b->seed, sizeof(b->seed));
+	b->seed |= 1;
+
+	res = TEE_CreatePersistentObject(TEE_STORAGE_PRIVATE, storage_perf_id,
+					 sizeof(storage_perf_id), flags,
+					 TEE_HANDLE_NULL, b->ref, b->size,
+					 obj);
+	if (res)
+		EMSG("TEE_CreatePersistentObject: %#"PRIx32, res);
+
+	return res;
+}
+
+static void bench_cleanup(struct bench *b, TEE_ObjectHandle obj)
+{
+	if (obj != TEE_HANDLE_NULL)
+		TEE_CloseAndDeletePersistentObject1(obj);
+	TEE_Free(b->ref);
+	TEE_Free(b->buf);
+}
+
+/* Next write, already applied to the reference copy */
+static uint32_t write_next(struct bench *b, uint32_t n)
+{
+	uint32_t offs = bench_offset(b, n);
+	uint32_t i = 0;
+
+	for (i = 0; i < b->chunk; i++)
+		b->buf[i] = bench_rand(b);
+	memcpy(b->ref + offs, b->buf, b->chunk);
+
+	return offs;
+}
+
+static TEE_Result write_direct(struct bench *b, TEE_ObjectHandle obj,
+			       uint32_t *writes)
+{
+	TEE_Result res = TEE_ERROR_GENERIC;
+	uint32_t offs = 0;
+	uint32_t n = 0;
+
+	for (n = 0; n < b->count; n++) {
+		offs = write_next(b, n);
+		res = TEE_SeekObjectData(obj, offs, TEE_DATA_SEEK_SET);
+		if (res)
+			return res;
+		res = TEE_WriteObjectData(obj, b->buf, b->chunk);
+		if (res)
+			return res;
+	}
+	*writes = b->count;
+
+	return TEE_SUCCESS;
+}
+
+static TEE_Result write_cached(struct bench *b, TEE_ObjectHandle obj,
+			       uint32_t *writes)
+{
+	TEE_Result res = TEE_ERROR_GENERIC;
+	struct pobj_cache cache = { };
+	uint32_t offs = 0;
+	uint32_t n = 0;
+
+	res = pobj_cache_init(&cache, obj, 0, STORAGE_PERF_CACHE_BLOCKS,
+			      STORAGE_PERF_IO_BLOCKS);
+	if (res)
+		return res;
+
+	for (n = 0; n < b->count; n++) {
+		offs = write_next(b, n);
+		res = pobj_cache_seek(&cache, offs, TEE_DATA_SEEK_SET);
+		if (res)
+			goto out;
+		res = pobj_cache_write(&cache, b->buf, b->chunk);
+		if (res)
+			goto out;
+	}
+
+	res = pobj_cache_sync(&cache);
+out:
+	*writes = cache.stats.writes;
+	if (res)
+		pobj_cache_fini(&cache);
+	else
+		res = pobj_cache_fini(&cache);
+
+	return res;
+}
+
+static TEE_Result write_check(struct bench *b, TEE_ObjectHandle obj)
+{
+	TEE_Result res = TEE_ERROR_GENERIC;
+	TEE_ObjectInfo info = { };
+	uint8_t *check = NULL;
+	uint32_t count = 0;
+
+	res = TEE_GetObjectInfo1(obj, &info);
+	if (res)
+		return res;
+	if (info.dataSize != b->size) {
+		EMSG("Object of %"PRIu32" bytes, expected %"PRIu32,
+		     info.dataSize, b->size);
+		return TEE_ERROR_CORRUPT_OBJECT;
+	}
+
+	check = TEE_Malloc(b->size, TEE_MALLOC_FILL_ZERO);
+	if (!check)
+		return TEE_ERROR_OUT_OF_MEMORY;
+
+	res = TEE_SeekObjectData(obj, 0, TEE_DATA_SEEK_SET);
+	if (!res)
+		res = TEE_ReadObjectData(obj, check, b->size, &count);
+	if (!res && (count != b->size || memcmp(check, b->ref, b->size))) {
+		EMSG("Object does not hold what was written");
+		res = TEE_ERROR_CORRUPT_OBJECT;
+	}
+
+	TEE_Free(check);
+	return res;
+}
+
+TEE_Result ta_entry_write(uint32_t param_types, TEE_Param params[4])
+{
+	TEE_ObjectHandle obj = TEE_HANDLE_NULL;
+	TEE_Result res = TEE_ERROR_GENERIC;
+	struct bench b = { };
+	uint32_t writes = 0;
+	uint64_t t = 0;
+
+	res = bench_setup(&b, param_types, params, &obj);
+	if (res)
+		goto out;
+
+	t = barrier_read_counter_timer();
+	if (params[2].value.a & TA_STORAGE_PERF_FLAG_CACHED)
+		res = write_cached(&b, obj, &writes);
+	else
+		res = write_direct(&b, obj, &writes);
+	t = barrier_read_counter_timer() - t;
+	if (res)
+		goto out;
+
+	res = write_check(&b, obj);
+	if (res)
+		goto out;
+
+	params[2].value.b = writes;
+	reg_pair_from_64(t, &params[3].value.a, &params[3].value.b);
+out:
+	bench_cleanup(&b, obj);
+
+	return res;
+}
+
+static TEE_Result read_check(struct bench *b, uint32_t offs,
+			     const void *data, uint32_t count, uint32_t size)
+{
+	if (count != size || memcmp(data, b->ref + offs, size)) {
+		EMSG("Read %"PRIu32" bytes at %"PRIu32" that were not written",
+		     count, offs);
+		return TEE_ERROR_CORRUPT_OBJECT;
+	}
+
+	return TEE_SUCCESS;
+}
+
+static TEE_Result read_direct(struct bench *b, TEE_ObjectHandle obj,
+			      uint64_t *ticks, uint32_t *reads)
+{
+	TEE_Result res = TEE_ERROR_GENERIC;
+	uint32_t count = 0;
+	uint32_t offs = 0;
+	uint32_t n = 0;
+	uint64_t t = 0;
+
+	for (n = 0; n < b->count; n++) {
+		offs = bench_offset(b, n);
+		t = barrier_read_counter_timer();
+		res = TEE_SeekObjectData(obj, offs, TEE_DATA_SEEK_SET);
+		if (!res)
+			res = TEE_ReadObjectData(obj, b->buf, b->chunk, &count);
+		*ticks += barrier_read_counter_timer() - t;
+		if (res)
+			return res;
+
+		res = read_check(b, offs, b->buf, count, b->chunk);
+		if (res)
+			return res;
+	}
+	*reads = b->count;
+
+	return TEE_SUCCESS;
+}
+
+static TEE_Result read_cached(struct bench *b, TEE_ObjectHandle obj,
+			      uint64_t *ticks, uint32_t *reads)
+{
+	TEE_Result res = TEE_ERROR_GENERIC;
+	struct pobj_cache cache = { };
+	uint32_t count = 0;
+	uint32_t offs = 0;
+	uint32_t n = 0;
+	uint64_t t = 0;
+
+	res = pobj_cache_init(&cache, obj, 0, STORAGE_PERF_CACHE_BLOCKS,
+			      STORAGE_PERF_IO_BLOCKS);
+	if (res)
+		return res;
+
+	for (n = 0; n < b->count; n++) {
+		offs = bench_offset(b, n);
+		t = barrier_read_counter_timer();
+		res = pobj_cache_seek(&cache, offs, TEE_DATA_SEEK_SET);
+		if (!res)
+			res = pobj_cache_read(&cache, b->buf, b->chunk, &count);
+		*ticks += barrier_read_counter_timer() - t;
+		if (res)
+			break;
+
+		res = read_check(b, offs, b->buf, count, b->chunk);
+		if (res)
+			break;
+	}
+
+	*reads = cache.stats.reads;
+	pobj_cache_fini(&cache);
+
+	return res;
+}
+
+static TEE_Result read_map(struct bench *b, TEE_ObjectHandle obj,
+			   uint64_t *ticks, uint32_t *reads)
+{
+	TEE_Result res = TEE_ERROR_GENERIC;
+	uint32_t count = 0;
+	void *data = NULL;
+	uint32_t n = 0;
+	uint64_t t = 0;
+
+	for (n = 0; n < b->count; n++) {
+		t = barrier_read_counter_timer();
+		res = pobj_map_read(obj, 0, b->size, &data, &count);
+		*ticks += barrier_read_counter_timer() - t;
+		if (!res)
+			res = read_check(b, 0, data, count, b->size);
+		pobj_unmap(data, b->size);
+		if (res)
+			return res;
+	}
+	*reads = b->count;
+
+	return TEE_SUCCESS;
+}
+
+TEE_Result ta_entry_read(uint32_t param_types, TEE_Param params[4])
+{
+	TEE_ObjectHandle obj = TEE_HANDLE_NULL;
+	TEE_Result res = TEE_ERROR_GENERIC;
+	struct bench b = { };
+	uint32_t reads = 0;
+	uint64_t t = 0;
+
+	res = bench_setup(&b, param_types, params, &obj);
+	if (res)
+		goto out;
+
+	if (params[2].value.a & TA_STORAGE_PERF_FLAG_MAP)
+		res = read_map(&b, obj, &t, &reads);
+	else if (params[2].value.a & TA_STORAGE_PERF_FLAG_CACHED)
+		res = read_cached(&b, obj, &t, &reads);
+	else
+		res = read_direct(&b, obj, &t, &reads);
+	if (res)
+		goto out;
+
+	params[2].value.b = reads;
+	reg_pair_from_64(t, &params[3].value.a, &params[3].value.b);
+out:
+	bench_cleanup(&b, obj);
+
+	return res;
+}
+
+TEE_Result ta_entry_get_freq(uint32_t param_types, TEE_Param params[4])
+{
+	if (param_types != TEE_PARAM_TYPES(TEE_PARAM_TYPE_VALUE_OUTPUT,
+					   TEE_PARAM_TYPE_NONE,
+					   TEE_PARAM_TYPE_NONE,
+					   TEE_PARAM_TYPE_NONE))
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	params[0].value.a = read_cntfrq();
+	params[0].value.b = 0;
+
+	return TEE_SUCCESS;
+}
+
+TEE_Result ta_entry_fs_htree(uint32_t param_types, TEE_Param params[4] __unused)
+{
+	const TEE_UUID uuid = PTA_INVOKE_TESTS_UUID;
+	TEE_TASessionHandle sess = TEE_HANDLE_NULL;
+	TEE_Result res = TEE_ERROR_GENERIC;
+	uint32_t ret_orig = 0;
+
+	if (param_types != TEE_PARAM_TYPES(TEE_PARAM_TYPE_NONE,
+					   TEE_PARAM_TYPE_NONE,
+					   TEE_PARAM_TYPE_NONE,
+					   TEE_PARAM_TYPE_NONE))
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	res = TEE_OpenTASession(&uuid, TEE_TIMEOUT_INFINITE, 0, NULL, &sess,
+				&ret_orig);
+	if (res) {
+		if (res == TEE_ERROR_ITEM_NOT_FOUND)
+			return TEE_ERROR_NOT_SUPPORTED;
+		return res;
+	}
+
+	res = TEE_InvokeTACommand(sess, TEE_TIMEOUT_INFINITE,
+				  PTA_INVOKE_TESTS_CMD_FS_HTREE, 0, NULL,
+				  &ret_orig);
+	TEE_CloseTASession(sess);
+
+	return res;
+}
@@ -0,0 +1,48 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2026, D-Robotics
+ */
+
+#include <storage_perf.h>
+#include <ta_storage_perf.h>
+#include <tee_internal_api.h>
+#include <tee_internal_api_extensions.h>
+#include <tee_ta_api.h>
+
+TEE_Result TA_CreateEntryPoint(void)
+{
+	return TEE_SUCCESS;
+}
+
+void TA_DestroyEntryPoint(void)
+{
+}
+
+TEE_Result TA_OpenSessionEntryPoint(uint32_t param_types __unused,
+				    TEE_Param params[4] __unused,
+				    void **session_ctx __unused)
+{
+	return TEE_SUCCESS;
+}
+
+void TA_CloseSessionEntryPoint(void *session_ctx __unused)
+{
+}
+
+TEE_Result TA_InvokeCommandEntryPoint(void *session_ctx __unused,
+				      uint32_t cmd_id, uint32_t param_types,
+				      TEE_Param params[4])
+{
+	switch (cmd_id) {
+	case TA_STORAGE_PERF_CMD_FS_HTREE:
+		return ta_entry_fs_htree(param_types, params);
+	case TA_STORAGE_PERF_CMD_WRITE:
+		return ta_entry_write(param_types, params);
+	case TA_STORAGE_PERF_CMD_READ:
+		return ta_entry_read(param_types, params);
+	case TA_STORAGE_PERF_CMD_GET_FREQ:
+		return ta_entry_get_freq(param_types, params);
+	default:
+		return TEE_ERROR_BAD_PARAMETERS;
+	}
+}
@@ -0,0 +1,4 @@
+LOCAL_PATH := $(call my-dir)
+
+local_module := a3f85a3b-03ee-4f4b-964b-94bb3db73e60.ta
+include $(BUILD_OPTEE_MK)
@@ -0,0 +1,78 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Copyright (c) 2026, D-Robotics
+ */
+
+#ifndef TA_STREAM_PERF_H
+#define TA_STREAM_PERF_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define TA_STREAM_PERF_UUID { 0xa3f85a3b, 0x03ee, 0x4f4b, \
+	{ 0x96, 0x4b, 0x94, 0xbb, 0x3d, 0xb7, 0x3e, 0x60 } }
+
+/*
+ * Process one chunk
+ *
+ * [in]		memref[0]	Chunk
+ */
+#define TA_STREAM_PERF_CMD_CHUNK	0
+
+/*
+ * Process the records of a ring until it is empty, see shm_ring.h
+ *
+ * [inout]	memref[0]	Ring, a struct shm_ring_hdr then its data
+ */
+#define TA_STREAM_PERF_CMD_DOORBELL	1
+
+/*
+ * Get and reset the totals of the session
+ *
+ * [out]	value[0].a	Sum of the chunks, high 32 bits
+ * [out]	value[0].b	Sum of the chunks, low 32 bits
+ * [out]	value[1].a	Number of chunks
+ * [out]	value[1].b	Number of TA_STREAM_PERF_CMD_DOORBELL
+ */
+#define TA_STREAM_PERF_CMD_RESULT	2
+
+/*
+ * Drain the tracepoints of the session, see tracepoint.h. Returns
+ * TEE_ERROR_NOT_SUPPORTED unless the TA is built with CFG_TA_TRACEPOINT=y.
+ *
+ * [out]	memref[0]	A struct tp_hdr then the records
+ */
+#define TA_STREAM_PERF_CMD_TRACE	3
+
+/* Records in the tracepoint ring of each session */
+#define STREAM_PERF_TRACE_RECS		2048
+
+/* Span of a TA_STREAM_PERF_CMD_CHUNK, a: size of the chunk */
+#define STREAM_PERF_TP_CHUNK		1
+/* Span of a TA_STREAM_PERF_CMD_DOORBELL, a: records processed at the end */
+#define STREAM_PERF_TP_DOORBELL		2
+/* Span of the processing of a ring record, a: size of the record */
+#define STREAM_PERF_TP_RECORD		3
+/* The ring was empty but the producer had not let the TA go idle yet */
+#define STREAM_PERF_TP_RETRY		4
+
+/* What the TA computes over each chunk, the client checks it */
+static inline uint64_t stream_perf_sum(const void *data, size_t len)
+{
+	const uint8_t *p = data;
+	uint64_t sum = len;
+	uint64_t w = 0;
+	size_t n = 0;
+
+	for (n = 0; n + sizeof(w) <= len; n += sizeof(w)) {
+		memcpy(&w, p + n, sizeof(w));
+		sum += w;
+	}
+	for (; n < len; n++)
+		sum += p[n];
+
+	return sum;
+}
+
+#endif /*TA_STREAM_PERF_H*/
@@ -0,0 +1,26 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Copyright (c) 2026, D-Robotics
+ */
+
+#ifndef USER_TA_HEADER_DEFINES_H
+#define USER_TA_HEADER_DEFINES_H
+
+#include <ta_stream_perf.h>
+#include <user_ta_header.h>
+
+#define TA_UUID		TA_STREAM_PERF_UUID
+
+#define TA_FLAGS	(TA_FLAG_USER_MODE | TA_FLAG_EXEC_DDR)
+#define TA_STACK_SIZE	(4 * 1024)
+#ifdef CFG_TA_TRACEPOINT
+/*
+ * An instance serves a single session, which allocates a tracepoint ring
+ * of STREAM_PERF_TRACE_RECS struct tp_rec of 24 bytes
+ */
+#define TA_DATA_SIZE	(32 * 1024 + STREAM_PERF_TRACE_RECS * 24 + 256)
+#else
+#define TA_DATA_SIZE	(32 * 1024)
+#endif
+
+#endif /*USER_TA_HEADER_DEFINES_H*/
@@ -0,0 +1,2 @@
+global-incdirs-y += include
+srcs-y += ta_entry.c
@@ -0,0 +1,176 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2026, D-Robotics
+ */
+
+#include <shm_ring.h>
+#include <ta_stream_perf.h>
+#include <tee_internal_api.h>
+#include <tee_internal_api_extensions.h>
+#include <tee_ta_api.h>
+#include <tracepoint.h>
+
+struct session {
+	uint64_t sum;
+	uint32_t chunks;
+	uint32_t doorbells;
+	struct tp_ring *tp;
+};
+
+TEE_Result TA_CreateEntryPoint(void)
+{
+	return TEE_SUCCESS;
+}
+
+void TA_DestroyEntryPoint(void)
+{
+}
+
+TEE_Result TA_OpenSessionEntryPoint(uint32_t param_types __unused,
+				    TEE_Param params[4] __unused,
+				    void **session_ctx)
+{
+	struct session *sess = NULL;
+
+	sess = TEE_Malloc(sizeof(*sess), TEE_MALLOC_FILL_ZERO);
+	if (!sess)
+		return TEE_ERROR_OUT_OF_MEMORY;
+
+	sess->tp = tp_ring_alloc(STREAM_PERF_TRACE_RECS);
+	*session_ctx = sess;
+	return TEE_SUCCESS;
+}
+
+void TA_CloseSessionEntryPoint(void *session_ctx)
+{
+	struct session *sess = session_ctx;
+
+	tp_ring_free(sess->tp);
+	TEE_Free(sess);
+}
+
+static TEE_Result ta_entry_chunk(struct session *sess, uint32_t param_types,
+				 TEE_Param params[4])
+{
+	if (param_types != TEE_PARAM_TYPES(TEE_PARAM_TYPE_MEMREF_INPUT,
+					   TEE_PARAM_TYPE_NONE,
+					   TEE_PARAM_TYPE_NONE,
+					   TEE_PARAM_TYPE_NONE))
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	TRACE_BEGIN(STREAM_PERF_TP_CHUNK, params[0].memref.size, 0);
+	sess->sum += stream_perf_sum(params[0].memref.buffer,
+				     params[0].memref.size);
+	sess->chunks++;
+	TRACE_END(STREAM_PERF_TP_CHUNK, params[0].memref.size, 0);
+
+	return TEE_SUCCESS;
+}
+
+static TEE_Result ta_entry_doorbell(struct session *sess,
+				    uint32_t param_types, TEE_Param params[4])
+{
+	TEE_Result res = TEE_ERROR_GENERIC;
+	struct shm_ring ring = { };
+	const void *data = NULL;
+	uint32_t records = 0;
+	size_t len = 0;
+
+	if (param_types != TEE_PARAM_TYPES(TEE_PARAM_TYPE_MEMREF_INOUT,
+					   TEE_PARAM_TYPE_NONE,
+					   TEE_PARAM_TYPE_NONE,
+					   TEE_PARAM_TYPE_NONE))
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	res = shm_ring_attach(&ring, params[0].memref.buffer,
+			      params[0].memref.size);
+	if (res)
+		return res;
+
+	sess->doorbells++;
+	TRACE_BEGIN(STREAM_PERF_TP_DOORBELL, 0, 0);
+
+	while (true) {
+		while (!(res = shm_ring_peek(&ring, &data, &len, NULL))) {
+			TRACE_BEGIN(STREAM_PERF_TP_RECORD, len, 0);
+			sess->sum += stream_perf_sum(data, len);
+			sess->chunks++;
+			shm_ring_consume(&ring);
+			TRACE_END(STREAM_PERF_TP_RECORD, len, 0);
+			records++;
+		}
+		if (res != TEE_ERROR_NO_DATA || shm_ring_idle(&ring))
+			break;
+		TRACEPOINT(STREAM_PERF_TP_RETRY, records, 0);
+	}
+
+	TRACE_END(STREAM_PERF_TP_DOORBELL, records, 0);
+
+	if (res != TEE_ERROR_NO_DATA) {
+		EMSG("Corrupt ring at %"PRIu32, ring.tail);
+		return res;
+	}
+
+	return TEE_SUCCESS;
+}
+
+static TEE_Result ta_entry_trace(struct session *sess, uint32_t param_types,
+				 TEE_Param params[4])
+{
+	TEE_Result res = TEE_ERROR_GENERIC;
+	size_t len = 0;
+
+	if (param_types != TEE_PARAM_TYPES(TEE_PARAM_TYPE_MEMREF_OUTPUT,
+					   TEE_PARAM_TYPE_NONE,
+					   TEE_PARAM_TYPE_NONE,
+					   TEE_PARAM_TYPE_NONE))
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	len = params[0].memref.size;
+	res = tp_ring_drain(sess->tp, params[0].memref.buffer, &len);
+	params[0].memref.size = len;
+
+	return res;
+}
+
+static TEE_Result ta_entry_result(struct session *sess, uint32_t param_types,
+				  TEE_Param params[4])
+{
+	if (param_types != TEE_PARAM_TYPES(TEE_PARAM_TYPE_VALUE_OUTPUT,
+					   TEE_PARAM_TYPE_VALUE_OUTPUT,
+					   TEE_PARAM_TYPE_NONE,
+					   TEE_PARAM_TYPE_NONE))
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	params[0].value.a = sess->sum >> 32;
+	params[0].value.b = sess->sum;
+	params[1].value.a = sess->chunks;
+	params[1].value.b = sess->doorbells;
+	sess->sum = 0;
+	sess->chunks = 0;
+	sess->doorbells = 0;
+
+	return TEE_SUCCESS;
+}
+
+TEE_Result TA_InvokeCommandEntryPoint(void *session_ctx,
+				      uint32_t cmd_id, uint32_t param_types,
+				      TEE_Param params[4])
+{
+	struct session *sess = session_ctx;
+
+	tp_ring_select(sess->tp);
+
+	switch (cmd_id) {
+	case TA_STREAM_PERF_CMD_CHUNK:
+		return ta_entry_chunk(sess, param_types, params);
+	case TA_STREAM_PERF_CMD_DOORBELL:
+		return ta_entry_doorbell(sess, param_types, params);
+	case TA_STREAM_PERF_CMD_RESULT:
+		return ta_entry_result(sess, param_types, params);
+	case TA_STREAM_PERF_CMD_TRACE:
+		return ta_entry_trace(sess, param_types, params);
+	default:
+		return TEE_ERROR_BAD_PARAMETERS;
+	}
+}
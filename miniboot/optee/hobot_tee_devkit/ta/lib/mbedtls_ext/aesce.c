@@ -0,0 +1,2048 @@
+/*
+ *  AES and AES-GCM with the Armv8 Cryptographic Extension
+ *
+ *  Copyright (c) 2026, D-Robotics
+ *  SPDX-License-Identifier: BSD-2-Clause
+ */
+/*
+ *  FIPS-197 Advanced Encryption Standard (AES)
+ *  NIST SP 800-38A, SP 800-38D and SP 800-38E for the modes of operation
+ *
+ *  Two implementations stand behind the same contexts:
+ *
+ *  - AESE/AESMC and AESD/AESIMC on 8 blocks at once and GHASH with PMULL
+ *    on 4 blocks at once, when the core implements the Cryptographic
+ *    Extension;
+ *  - a bitsliced AES on 4 blocks at once and GHASH with integer
+ *    multiplications, neither of which indexes memory or branches on
+ *    secret data, otherwise.
+ *
+ *  The choice is made at compile time when the TA targets the extension,
+ *  see CFG_TA_CRYPTO_WITH_CE, and at run time from ID_AA64ISAR0_EL1 when
+ *  the OP-TEE core lets TAs read it, see CFG_TA_CRYPTO_CE_DETECT.
+ */
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#if defined(MBEDTLS_AESCE_C)
+
+#include "mbedtls/aesce.h"
+#include "mbedtls/platform_util.h"
+
+#include <string.h>
+
+#if defined(MBEDTLS_SELF_TEST)
+#if defined(MBEDTLS_PLATFORM_C)
+#include "mbedtls/platform.h"
+#else
+#include <stdio.h>
+#define mbedtls_printf printf
+#endif /* MBEDTLS_PLATFORM_C */
+#endif /* MBEDTLS_SELF_TEST */
+
+/*
+ * The Cryptographic Extension code is built when the compiler targets it
+ * or when its presence is probed at run time. In the latter case only the
+ * functions using it are compiled for it.
+ */
+#if defined(__aarch64__) && defined(CFG_TA_FLOAT_SUPPORT)
+#if defined(__ARM_FEATURE_AES) || defined(__ARM_FEATURE_CRYPTO)
+#define AESCE_NEON
+#define AESCE_TARGET
+#elif defined(CFG_TA_CRYPTO_CE_DETECT)
+#define AESCE_NEON
+#define AESCE_DETECT
+#define AESCE_TARGET    __attribute__(( target( "+crypto" ) ))
+#include <arm64_user_sysreg.h>
+#endif
+#endif
+
+#if defined(AESCE_NEON)
+#include <arm_neon.h>
+#endif
+
+/*
+ * 64-bit integer manipulation macros
+ */
+#ifndef GET_UINT64_BE
+#define GET_UINT64_BE(n,b,i)                            \
+do {                                                    \
+    (n) = ( (uint64_t) (b)[(i)    ] << 56 )             \
+        | ( (uint64_t) (b)[(i) + 1] << 48 )             \
+        | ( (uint64_t) (b)[(i) + 2] << 40 )             \
+        | ( (uint64_t) (b)[(i) + 3] << 32 )             \
+        | ( (uint64_t) (b)[(i) + 4] << 24 )             \
+        | ( (uint64_t) (b)[(i) + 5] << 16 )             \
+        | ( (uint64_t) (b)[(i) + 6] <<  8 )             \
+        | ( (uint64_t) (b)[(i) + 7]       );            \
+} while( 0 )
+#endif
+
+#ifndef PUT_UINT64_BE
+#define PUT_UINT64_BE(n,b,i)                            \
+do {                                                    \
+    (b)[(i)    ] = (unsigned char) ( (n) >> 56 );       \
+    (b)[(i) + 1] = (unsigned char) ( (n) >> 48 );       \
+    (b)[(i) + 2] = (unsigned char) ( (n) >> 40 );       \
+    (b)[(i) + 3] = (unsigned char) ( (n) >> 32 );       \
+    (b)[(i) + 4] = (unsigned char) ( (n) >> 24 );       \
+    (b)[(i) + 5] = (unsigned char) ( (n) >> 16 );       \
+    (b)[(i) + 6] = (unsigned char) ( (n) >>  8 );       \
+    (b)[(i) + 7] = (unsigned char) ( (n)       );       \
+} while( 0 )
+#endif
+
+#ifndef GET_UINT64_LE
+#define GET_UINT64_LE(n,b,i)                            \
+do {                                                    \
+    (n) = ( (uint64_t) (b)[(i)    ]       )             \
+        | ( (uint64_t) (b)[(i) + 1] <<  8 )             \
+        | ( (uint64_t) (b)[(i) + 2] << 16 )             \
+        | ( (uint64_t) (b)[(i) + 3] << 24 )             \
+        | ( (uint64_t) (b)[(i) + 4] << 32 )             \
+        | ( (uint64_t) (b)[(i) + 5] << 40 )             \
+        | ( (uint64_t) (b)[(i) + 6] << 48 )             \
+        | ( (uint64_t) (b)[(i) + 7] << 56 );            \
+} while( 0 )
+#endif
+
+#ifndef PUT_UINT64_LE
+#define PUT_UINT64_LE(n,b,i)                            \
+do {                                                    \
+    (b)[(i)    ] = (unsigned char) ( (n)       );       \
+    (b)[(i) + 1] = (unsigned char) ( (n) >>  8 );       \
+    (b)[(i) + 2] = (unsigned char) ( (n) >> 16 );       \
+    (b)[(i) + 3] = (unsigned char) ( (n) >> 24 );       \
+    (b)[(i) + 4] = (unsigned char) ( (n) >> 32 );       \
+    (b)[(i) + 5] = (unsigned char) ( (n) >> 40 );       \
+    (b)[(i) + 6] = (unsigned char) ( (n) >> 48 );       \
+    (b)[(i) + 7] = (unsigned char) ( (n) >> 56 );       \
+} while( 0 )
+#endif
+
+/* Blocks processed at once by the bulk loops and by AESE/AESD */
+#define AESCE_BULK_BLOCKS   8
+
+/* Blocks processed at once by the bitsliced code */
+#define AES_CT_BLOCKS       4
+
+/*
+ * Whether the Cryptographic Extension is used. ID_AA64ISAR0_EL1.AES is 2
+ * when both AESE/AESD and PMULL are implemented.
+ */
+static int aesce_use_ce( void )
+{
+#if defined(AESCE_DETECT)
+    static int ce = -1;
+
+    if( ce < 0 )
+        ce = ( ( read_id_aa64isar0_el1() >> 4 ) & 0xf ) >= 2;
+
+    return( ce );
+#elif defined(AESCE_NEON)
+    return( 1 );
+#else
+    return( 0 );
+#endif
+}
+
+int mbedtls_aesce_has_support( void )
+{
+    return( aesce_use_ce() );
+}
+
+/*
+ * Bitsliced AES
+ *
+ * Four blocks are held in eight 64-bit words, one per bit of the bytes:
+ * bit 16 * j + i of q[b] is bit b of byte i of block j. Byte i of a block
+ * being the byte in row i % 4 and column i / 4 of the state, each column
+ * is a group of 4 bits and each block a group of 16 bits.
+ */
+
+/* Transposition of the 8x8 bit matrix whose rows are the bytes of x */
+static inline uint64_t aes_ct_transpose8( uint64_t x )
+{
+    uint64_t t;
+
+    t = ( x ^ ( x >>  7 ) ) & 0x00AA00AA00AA00AAULL;
+    x ^= t ^ ( t <<  7 );
+    t = ( x ^ ( x >> 14 ) ) & 0x0000CCCC0000CCCCULL;
+    x ^= t ^ ( t << 14 );
+    t = ( x ^ ( x >> 28 ) ) & 0x00000000F0F0F0F0ULL;
+    x ^= t ^ ( t << 28 );
+
+    return( x );
+}
+
+/* Transposition of the 8x8 byte matrix whose rows are the words of q */
+static inline void aes_ct_transpose_bytes( uint64_t q[8] )
+{
+    uint64_t t;
+    int i;
+
+    for( i = 0; i < 4; i++ )
+    {
+        t = ( ( q[i] >> 32 ) ^ q[i + 4] ) & 0x00000000FFFFFFFFULL;
+        q[i] ^= t << 32;
+        q[i + 4] ^= t;
+    }
+    for( i = 0; i < 8; i++ )
+    {
+        if( i & 2 )
+            continue;
+        t = ( ( q[i] >> 16 ) ^ q[i + 2] ) & 0x0000FFFF0000FFFFULL;
+        q[i] ^= t << 16;
+        q[i + 2] ^= t;
+    }
+    for( i = 0; i < 8; i += 2 )
+    {
+        t = ( ( q[i] >> 8 ) ^ q[i + 1] ) & 0x00FF00FF00FF00FFULL;
+        q[i] ^= t << 8;
+        q[i + 1] ^= t;
+    }
+}
+
+static void aes_ct_load( const unsigned char in[64], uint64_t q[8] )
+{
+    int i;
+
+    for( i = 0; i < 8; i++ )
+    {
+        GET_UINT64_LE( q[i], in, 8 * i );
+        q[i] = aes_ct_transpose8( q[i] );
+    }
+    aes_ct_transpose_bytes( q );
+}
+
+static void aes_ct_store( uint64_t q[8], unsigned char out[64] )
+{
+    int i;
+
+    aes_ct_transpose_bytes( q );
+    for( i = 0; i < 8; i++ )
+    {
+        q[i] = aes_ct_transpose8( q[i] );
+        PUT_UINT64_LE( q[i], out, 8 * i );
+    }
+}
+
+/*
+ * The S-box as the circuit of 113 gates by Boyar and Peralta, "A depth-16
+ * circuit for the AES S-box", 2011
+ */
+static void aes_ct_sbox( uint64_t q[8] )
+{
+    uint64_t x0, x1, x2, x3, x4, x5, x6, x7;
+    uint64_t y1, y2, y3, y4, y5, y6, y7, y8, y9;
+    uint64_t y10, y11, y12, y13, y14, y15, y16, y17, y18, y19;
+    uint64_t y20, y21;
+    uint64_t z0, z1, z2, z3, z4, z5, z6, z7, z8, z9;
+    uint64_t z10, z11, z12, z13, z14, z15, z16, z17;
+    uint64_t t0, t1, t2, t3, t4, t5, t6, t7, t8, t9;
+    uint64_t t10, t11, t12, t13, t14, t15, t16, t17, t18, t19;
+    uint64_t t20, t21, t22, t23, t24, t25, t26, t27, t28, t29;
+    uint64_t t30, t31, t32, t33, t34, t35, t36, t37, t38, t39;
+    uint64_t t40, t41, t42, t43, t44, t45, t46, t47, t48, t49;
+    uint64_t t50, t51, t52, t53, t54, t55, t56, t57, t58, t59;
+    uint64_t t60, t61, t62, t63, t64, t65, t66, t67;
+    uint64_t s0, s1, s2, s3, s4, s5, s6, s7;
+
+    x0 = q[7];
+    x1 = q[6];
+    x2 = q[5];
+    x3 = q[4];
+    x4 = q[3];
+    x5 = q[2];
+    x6 = q[1];
+    x7 = q[0];
+
+    /* Top linear transformation */
+    y14 = x3 ^ x5;
+    y13 = x0 ^ x6;
+    y9 = x0 ^ x3;
+    y8 = x0 ^ x5;
+    t0 = x1 ^ x2;
+    y1 = t0 ^ x7;
+    y4 = y1 ^ x3;
+    y12 = y13 ^ y14;
+    y2 = y1 ^ x0;
+    y5 = y1 ^ x6;
+    y3 = y5 ^ y8;
+    t1 = x4 ^ y12;
+    y15 = t1 ^ x5;
+    y20 = t1 ^ x1;
+    y6 = y15 ^ x7;
+    y10 = y15 ^ t0;
+    y11 = y20 ^ y9;
+    y7 = x7 ^ y11;
+    y17 = y10 ^ y11;
+    y19 = y10 ^ y8;
+    y16 = t0 ^ y11;
+    y21 = y13 ^ y16;
+    y18 = x0 ^ y16;
+
+    /* Non-linear section */
+    t2 = y12 & y15;
+    t3 = y3 & y6;
+    t4 = t3 ^ t2;
+    t5 = y4 & x7;
+    t6 = t5 ^ t2;
+    t7 = y13 & y16;
+    t8 = y5 & y1;
+    t9 = t8 ^ t7;
+    t10 = y2 & y7;
+    t11 = t10 ^ t7;
+    t12 = y9 & y11;
+    t13 = y14 & y17;
+    t14 = t13 ^ t12;
+    t15 = y8 & y10;
+    t16 = t15 ^ t12;
+    t17 = t4 ^ t14;
+    t18 = t6 ^ t16;
+    t19 = t9 ^ t14;
+    t20 = t11 ^ t16;
+    t21 = t17 ^ y20;
+    t22 = t18 ^ y19;
+    t23 = t19 ^ y21;
+    t24 = t20 ^ y18;
+
+    t25 = t21 ^ t22;
+    t26 = t21 & t23;
+    t27 = t24 ^ t26;
+    t28 = t25 & t27;
+    t29 = t28 ^ t22;
+    t30 = t23 ^ t24;
+    t31 = t22 ^ t26;
+    t32 = t31 & t30;
+    t33 = t32 ^ t24;
+    t34 = t23 ^ t33;
+    t35 = t27 ^ t33;
+    t36 = t24 & t35;
+    t37 = t36 ^ t34;
+    t38 = t27 ^ t36;
+    t39 = t29 & t38;
+    t40 = t25 ^ t39;
+
+    t41 = t40 ^ t37;
+    t42 = t29 ^ t33;
+    t43 = t29 ^ t40;
+    t44 = t33 ^ t37;
+    t45 = t42 ^ t41;
+    z0 = t44 & y15;
+    z1 = t37 & y6;
+    z2 = t33 & x7;
+    z3 = t43 & y16;
+    z4 = t40 & y1;
+    z5 = t29 & y7;
+    z6 = t42 & y11;
+    z7 = t45 & y17;
+    z8 = t41 & y10;
+    z9 = t44 & y12;
+    z10 = t37 & y3;
+    z11 = t33 & y4;
+    z12 = t43 & y13;
+    z13 = t40 & y5;
+    z14 = t29 & y2;
+    z15 = t42 & y9;
+    z16 = t45 & y14;
+    z17 = t41 & y8;
+
+    /* Bottom linear transformation */
+    t46 = z15 ^ z16;
+    t47 = z10 ^ z11;
+    t48 = z5 ^ z13;
+    t49 = z9 ^ z10;
+    t50 = z2 ^ z12;
+    t51 = z2 ^ z5;
+    t52 = z7 ^ z8;
+    t53 = z0 ^ z3;
+    t54 = z6 ^ z7;
+    t55 = z16 ^ z17;
+    t56 = z12 ^ t48;
+    t57 = t50 ^ t53;
+    t58 = z4 ^ t46;
+    t59 = z3 ^ t54;
+    t60 = t46 ^ t57;
+    t61 = z14 ^ t57;
+    t62 = t52 ^ t58;
+    t63 = t49 ^ t58;
+    t64 = z4 ^ t59;
+    t65 = t61 ^ t62;
+    t66 = z1 ^ t63;
+    s0 = t59 ^ t63;
+    s6 = t56 ^ ~t62;
+    s7 = t48 ^ ~t60;
+    t67 = t64 ^ t65;
+    s3 = t53 ^ t66;
+    s4 = t51 ^ t66;
+    s5 = t47 ^ t65;
+    s1 = t64 ^ ~s3;
+    s2 = t55 ^ ~t67;
+
+    q[7] = s0;
+    q[6] = s1;
+    q[5] = s2;
+    q[4] = s3;
+    q[3] = s4;
+    q[2] = s5;
+    q[1] = s6;
+    q[0] = s7;
+}
+
+/*
+ * The inverse of the affine transform of the S-box, constant included:
+ * as the S-box is that transform of the inversion in GF(2^8), the inverse
+ * S-box is the S-box between two of them.
+ */
+static void aes_ct_inv_affine( uint64_t q[8] )
+{
+    uint64_t t[8];
+    int i;
+
+    for( i = 0; i < 8; i++ )
+        t[i] = q[( i + 2 ) & 7] ^ q[( i + 5 ) & 7] ^ q[( i + 7 ) & 7];
+    t[0] = ~t[0];
+    t[2] = ~t[2];
+
+    memcpy( q, t, sizeof( t ) );
+}
+
+static void aes_ct_inv_sbox( uint64_t q[8] )
+{
+    aes_ct_inv_affine( q );
+    aes_ct_sbox( q );
+    aes_ct_inv_affine( q );
+}
+
+/* Row r of each block rotated by r columns */
+static void aes_ct_shift_rows( uint64_t q[8] )
+{
+    uint64_t x, r1, r2, r3;
+    int i;
+
+    for( i = 0; i < 8; i++ )
+    {
+        x = q[i];
+        r1 = x & 0x2222222222222222ULL;
+        r2 = x & 0x4444444444444444ULL;
+        r3 = x & 0x8888888888888888ULL;
+        q[i] = ( x & 0x1111111111111111ULL )
+             | ( ( r1 >>  4 ) & 0x0222022202220222ULL )
+             | ( ( r1 << 12 ) & 0x2000200020002000ULL )
+             | ( ( r2 >>  8 ) & 0x0044004400440044ULL )
+             | ( ( r2 <<  8 ) & 0x4400440044004400ULL )
+             | ( ( r3 >> 12 ) & 0x0008000800080008ULL )
+             | ( ( r3 <<  4 ) & 0x8880888088808880ULL );
+    }
+}
+
+static void aes_ct_inv_shift_rows( uint64_t q[8] )
+{
+    uint64_t x, r1, r2, r3;
+    int i;
+
+    for( i = 0; i < 8; i++ )
+    {
+        x = q[i];
+        r1 = x & 0x2222222222222222ULL;
+        r2 = x & 0x4444444444444444ULL;
+        r3 = x & 0x8888888888888888ULL;
+        q[i] = ( x & 0x1111111111111111ULL )
+             | ( ( r1 <<  4 ) & 0x2220222022202220ULL )
+             | ( ( r1 >> 12 ) & 0x0002000200020002ULL )
+             | ( ( r2 >>  8 ) & 0x0044004400440044ULL )
+             | ( ( r2 <<  8 ) & 0x4400440044004400ULL )
+             | ( ( r3 << 12 ) & 0x8000800080008000ULL )
+             | ( ( r3 >>  4 ) & 0x0888088808880888ULL );
+    }
+}
+
+/* Each row of a column replaced by the next one, or by the one after */
+#define AES_CT_ROT1( x )    ( ( ( (x) >> 1 ) & 0x7777777777777777ULL ) | \
+                              ( ( (x) << 3 ) & 0x8888888888888888ULL ) )
+#define AES_CT_ROT2( x )    ( ( ( (x) >> 2 ) & 0x3333333333333333ULL ) | \
+                              ( ( (x) << 2 ) & 0xCCCCCCCCCCCCCCCCULL ) )
+
+/* Multiplication by x in GF(2^8) of all the bytes */
+static inline void aes_ct_xtime( uint64_t r[8], const uint64_t a[8] )
+{
+    uint64_t hi = a[7];
+
+    r[7] = a[6];
+    r[6] = a[5];
+    r[5] = a[4];
+    r[4] = a[3] ^ hi;
+    r[3] = a[2] ^ hi;
+    r[2] = a[1];
+    r[1] = a[0] ^ hi;
+    r[0] = hi;
+}
+
+/*
+ * b[r] = 2 a[r] + 3 a[r + 1] + a[r + 2] + a[r + 3]
+ *      = 2 t[r] + a[r + 1] + t[r + 2], with t[r] = a[r] + a[r + 1]
+ */
+static void aes_ct_mix_columns( uint64_t q[8] )
+{
+    uint64_t t[8], r[8], x[8];
+    int i;
+
+    for( i = 0; i < 8; i++ )
+    {
+        r[i] = AES_CT_ROT1( q[i] );
+        t[i] = q[i] ^ r[i];
+    }
+    aes_ct_xtime( x, t );
+    for( i = 0; i < 8; i++ )
+        q[i] = x[i] ^ r[i] ^ AES_CT_ROT2( t[i] );
+}
+
+/*
+ * The inverse matrix is that of MixColumns times the one of
+ * u[r] = 5 a[r] + 4 a[r + 2] = a[r] + 4 (a[r] + a[r + 2])
+ */
+static void aes_ct_inv_mix_columns( uint64_t q[8] )
+{
+    uint64_t t[8], x[8];
+    int i;
+
+    for( i = 0; i < 8; i++ )
+        t[i] = q[i] ^ AES_CT_ROT2( q[i] );
+    aes_ct_xtime( x, t );
+    aes_ct_xtime( t, x );
+    for( i = 0; i < 8; i++ )
+        q[i] ^= t[i];
+
+    aes_ct_mix_columns( q );
+}
+
+/* The bit planes of the round key are those of one block */
+static inline void aes_ct_add_round_key( uint64_t q[8], const uint16_t k[8] )
+{
+    int i;
+
+    for( i = 0; i < 8; i++ )
+        q[i] ^= k[i] * 0x0001000100010001ULL;
+}
+
+/*
+ * AES_CT_BLOCKS blocks, the decryption being the equivalent inverse
+ * cipher
+ */
+static void aes_ct_crypt4( const mbedtls_aesce_context *ctx, int mode,
+                           const unsigned char in[64],
+                           unsigned char out[64] )
+{
+    uint64_t q[8];
+    int r;
+
+    aes_ct_load( in, q );
+    aes_ct_add_round_key( q, ctx->bs[0] );
+
+    if( mode == MBEDTLS_AES_ENCRYPT )
+    {
+        for( r = 1; r < ctx->nr; r++ )
+        {
+            aes_ct_sbox( q );
+            aes_ct_shift_rows( q );
+            aes_ct_mix_columns( q );
+            aes_ct_add_round_key( q, ctx->bs[r] );
+        }
+        aes_ct_sbox( q );
+        aes_ct_shift_rows( q );
+    }
+    else
+    {
+        for( r = 1; r < ctx->nr; r++ )
+        {
+            aes_ct_inv_shift_rows( q );
+            aes_ct_inv_sbox( q );
+            aes_ct_inv_mix_columns( q );
+            aes_ct_add_round_key( q, ctx->bs[r] );
+        }
+        aes_ct_inv_shift_rows( q );
+        aes_ct_inv_sbox( q );
+    }
+
+    aes_ct_add_round_key( q, ctx->bs[ctx->nr] );
+    aes_ct_store( q, out );
+
+    mbedtls_platform_zeroize( q, sizeof( q ) );
+}
+
+static void aes_ct_blocks( const mbedtls_aesce_context *ctx, int mode,
+                           const unsigned char *input,
+                           unsigned char *output, size_t blocks )
+{
+    unsigned char buf[16 * AES_CT_BLOCKS];
+
+    for( ; blocks >= AES_CT_BLOCKS; blocks -= AES_CT_BLOCKS )
+    {
+        aes_ct_crypt4( ctx, mode, input, output );
+        input += 16 * AES_CT_BLOCKS;
+        output += 16 * AES_CT_BLOCKS;
+    }
+
+    if( blocks > 0 )
+    {
+        memset( buf, 0, sizeof( buf ) );
+        memcpy( buf, input, 16 * blocks );
+        aes_ct_crypt4( ctx, mode, buf, buf );
+        memcpy( output, buf, 16 * blocks );
+        mbedtls_platform_zeroize( buf, sizeof( buf ) );
+    }
+}
+
+#if defined(AESCE_NEON)
+/*
+ * AESE/AESMC and AESD/AESIMC on AESCE_BULK_BLOCKS blocks at once, so that
+ * the latency of each instruction is hidden by the independent ones
+ */
+AESCE_TARGET
+static void aesce_ce_blocks( const mbedtls_aesce_context *ctx, int mode,
+                             const unsigned char *input,
+                             unsigned char *output, size_t blocks )
+{
+    uint8x16_t k[15], s[AESCE_BULK_BLOCKS];
+    unsigned char buf[16 * AESCE_BULK_BLOCKS];
+    const unsigned char *src;
+    unsigned char *dst;
+    int nr = ctx->nr, r, j;
+    size_t n;
+
+    for( r = 0; r <= nr; r++ )
+        k[r] = vld1q_u8( ctx->rk[r] );
+
+    while( blocks > 0 )
+    {
+        n = blocks < AESCE_BULK_BLOCKS ? blocks : AESCE_BULK_BLOCKS;
+        src = input;
+        dst = output;
+        if( n < AESCE_BULK_BLOCKS )
+        {
+            memset( buf, 0, sizeof( buf ) );
+            memcpy( buf, input, 16 * n );
+            src = dst = buf;
+        }
+
+        for( j = 0; j < AESCE_BULK_BLOCKS; j++ )
+            s[j] = vld1q_u8( src + 16 * j );
+
+        if( mode == MBEDTLS_AES_ENCRYPT )
+        {
+            for( r = 0; r < nr - 1; r++ )
+                for( j = 0; j < AESCE_BULK_BLOCKS; j++ )
+                    s[j] = vaesmcq_u8( vaeseq_u8( s[j], k[r] ) );
+            for( j = 0; j < AESCE_BULK_BLOCKS; j++ )
+                s[j] = veorq_u8( vaeseq_u8( s[j], k[nr - 1] ), k[nr] );
+        }
+        else
+        {
+            for( r = 0; r < nr - 1; r++ )
+                for( j = 0; j < AESCE_BULK_BLOCKS; j++ )
+                    s[j] = vaesimcq_u8( vaesdq_u8( s[j], k[r] ) );
+            for( j = 0; j < AESCE_BULK_BLOCKS; j++ )
+                s[j] = veorq_u8( vaesdq_u8( s[j], k[nr - 1] ), k[nr] );
+        }
+
+        for( j = 0; j < AESCE_BULK_BLOCKS; j++ )
+            vst1q_u8( dst + 16 * j, s[j] );
+
+        if( n < AESCE_BULK_BLOCKS )
+        {
+            memcpy( output, buf, 16 * n );
+            mbedtls_platform_zeroize( buf, sizeof( buf ) );
+        }
+
+        input += 16 * n;
+        output += 16 * n;
+        blocks -= n;
+    }
+}
+#endif /* AESCE_NEON */
+
+static void aesce_blocks( const mbedtls_aesce_context *ctx, int mode,
+                          const unsigned char *input,
+                          unsigned char *output, size_t blocks )
+{
+#if defined(AESCE_NEON)
+    if( aesce_use_ce() )
+    {
+        aesce_ce_blocks( ctx, mode, input, output, blocks );
+        return;
+    }
+#endif
+
+    aes_ct_blocks( ctx, mode, input, output, blocks );
+}
+
+void mbedtls_aesce_init( mbedtls_aesce_context *ctx )
+{
+    if( ctx == NULL )
+        return;
+
+    memset( ctx, 0, sizeof( mbedtls_aesce_context ) );
+}
+
+void mbedtls_aesce_free( mbedtls_aesce_context *ctx )
+{
+    if( ctx == NULL )
+        return;
+
+    mbedtls_platform_zeroize( ctx, sizeof( mbedtls_aesce_context ) );
+}
+
+void mbedtls_aesce_xts_init( mbedtls_aesce_xts_context *ctx )
+{
+    if( ctx == NULL )
+        return;
+
+    mbedtls_aesce_init( &ctx->crypt );
+    mbedtls_aesce_init( &ctx->tweak );
+}
+
+void mbedtls_aesce_xts_free( mbedtls_aesce_xts_context *ctx )
+{
+    if( ctx == NULL )
+        return;
+
+    mbedtls_aesce_free( &ctx->crypt );
+    mbedtls_aesce_free( &ctx->tweak );
+}
+
+/*
+ * Key schedule
+ *
+ * SubWord goes through the bitsliced S-box as well, the key being no less
+ * secret than the data.
+ */
+static const unsigned char aes_rcon[10] =
+{
+    0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36
+};
+
+static void aes_ct_sub_word( unsigned char w[4] )
+{
+    unsigned char buf[16 * AES_CT_BLOCKS];
+    uint64_t q[8];
+
+    memset( buf, 0, sizeof( buf ) );
+    memcpy( buf, w, 4 );
+    aes_ct_load( buf, q );
+    aes_ct_sbox( q );
+    aes_ct_store( q, buf );
+    memcpy( w, buf, 4 );
+
+    mbedtls_platform_zeroize( buf, sizeof( buf ) );
+    mbedtls_platform_zeroize( q, sizeof( q ) );
+}
+
+static void aes_ct_bitslice_key( const unsigned char rk[16], uint16_t bs[8] )
+{
+    unsigned char buf[16 * AES_CT_BLOCKS];
+    uint64_t q[8];
+    int i;
+
+    memset( buf, 0, sizeof( buf ) );
+    memcpy( buf, rk, 16 );
+    aes_ct_load( buf, q );
+    for( i = 0; i < 8; i++ )
+        bs[i] = (uint16_t) q[i];
+
+    mbedtls_platform_zeroize( buf, sizeof( buf ) );
+    mbedtls_platform_zeroize( q, sizeof( q ) );
+}
+
+int mbedtls_aesce_setkey_enc( mbedtls_aesce_context *ctx,
+                              const unsigned char *key,
+                              unsigned int keybits )
+{
+    unsigned char *w = ctx->rk[0];
+    unsigned char t[4], u;
+    unsigned int nk, i, j;
+
+    switch( keybits )
+    {
+        case 128: case 192: case 256: break;
+        default: return( MBEDTLS_ERR_AES_INVALID_KEY_LENGTH );
+    }
+
+    nk = keybits / 32;
+    ctx->nr = (int) nk + 6;
+
+    memcpy( w, key, 4 * nk );
+    for( i = nk; i < 4 * ( (unsigned int) ctx->nr + 1 ); i++ )
+    {
+        memcpy( t, w + 4 * ( i - 1 ), 4 );
+        if( i % nk == 0 )
+        {
+            u = t[0];
+            t[0] = t[1];
+            t[1] = t[2];
+            t[2] = t[3];
+            t[3] = u;
+            aes_ct_sub_word( t );
+            t[0] ^= aes_rcon[i / nk - 1];
+        }
+        else if( nk > 6 && i % nk == 4 )
+        {
+            aes_ct_sub_word( t );
+        }
+
+        for( j = 0; j < 4; j++ )
+            w[4 * i + j] = w[4 * ( i - nk ) + j] ^ t[j];
+    }
+
+    for( i = 0; i <= (unsigned int) ctx->nr; i++ )
+        aes_ct_bitslice_key( ctx->rk[i], ctx->bs[i] );
+
+    mbedtls_platform_zeroize( t, sizeof( t ) );
+
+    return( 0 );
+}
+
+/*
+ * The round keys of the equivalent inverse cipher: those of the
+ * encryption in reverse order, InvMixColumns applied to all but the first
+ * and the last one
+ */
+int mbedtls_aesce_setkey_dec( mbedtls_aesce_context *ctx,
+                              const unsigned char *key,
+                              unsigned int keybits )
+{
+    mbedtls_aesce_context cty;
+    unsigned char buf[16 * AES_CT_BLOCKS];
+    uint64_t q[8];
+    int i, j, ret;
+
+    mbedtls_aesce_init( &cty );
+
+    ret = mbedtls_aesce_setkey_enc( &cty, key, keybits );
+    if( ret != 0 )
+        goto exit;
+
+    ctx->nr = cty.nr;
+    for( i = 0; i <= ctx->nr; i++ )
+    {
+        memset( buf, 0, sizeof( buf ) );
+        memcpy( buf, cty.rk[ctx->nr - i], 16 );
+        aes_ct_load( buf, q );
+        if( i > 0 && i < ctx->nr )
+            aes_ct_inv_mix_columns( q );
+        for( j = 0; j < 8; j++ )
+            ctx->bs[i][j] = (uint16_t) q[j];
+
+        aes_ct_store( q, buf );
+        memcpy( ctx->rk[i], buf, 16 );
+    }
+
+exit:
+    mbedtls_aesce_free( &cty );
+    mbedtls_platform_zeroize( buf, sizeof( buf ) );
+    mbedtls_platform_zeroize( q, sizeof( q ) );
+
+    return( ret );
+}
+
+/*
+ * AES-ECB buffer encryption/decryption
+ */
+int mbedtls_aesce_crypt_ecb( mbedtls_aesce_context *ctx,
+                             int mode,
+                             size_t length,
+                             const unsigned char *input,
+                             unsigned char *output )
+{
+    if( length % 16 != 0 )
+        return( MBEDTLS_ERR_AES_INVALID_INPUT_LENGTH );
+
+    aesce_blocks( ctx, mode, input, output, length / 16 );
+
+    return( 0 );
+}
+
+/*
+ * AES-CBC buffer encryption/decryption. Decryption, unlike encryption, is
+ * not chained and is done AESCE_BULK_BLOCKS at a time.
+ */
+int mbedtls_aesce_crypt_cbc( mbedtls_aesce_context *ctx,
+                             int mode,
+                             size_t length,
+                             unsigned char iv[16],
+                             const unsigned char *input,
+                             unsigned char *output )
+{
+    unsigned char buf[16 * AESCE_BULK_BLOCKS];
+    unsigned char last[16];
+    size_t i, n;
+
+    if( length % 16 != 0 )
+        return( MBEDTLS_ERR_AES_INVALID_INPUT_LENGTH );
+
+    if( mode == MBEDTLS_AES_DECRYPT )
+    {
+        while( length > 0 )
+        {
+            n = length < sizeof( buf ) ? length : sizeof( buf );
+            aesce_blocks( ctx, mode, input, buf, n / 16 );
+            memcpy( last, input + n - 16, 16 );
+
+            /*
+             * From the last block down, so that each ciphertext block is
+             * read before an in-place output overwrites it
+             */
+            for( i = n; i-- > 16; )
+                output[i] = buf[i] ^ input[i - 16];
+            for( i = 16; i-- > 0; )
+                output[i] = buf[i] ^ iv[i];
+
+            memcpy( iv, last, 16 );
+            input += n;
+            output += n;
+            length -= n;
+        }
+    }
+    else
+    {
+        while( length > 0 )
+        {
+            for( i = 0; i < 16; i++ )
+                buf[i] = input[i] ^ iv[i];
+            aesce_blocks( ctx, mode, buf, output, 1 );
+            memcpy( iv, output, 16 );
+
+            input += 16;
+            output += 16;
+            length -= 16;
+        }
+    }
+
+    mbedtls_platform_zeroize( buf, sizeof( buf ) );
+
+    return( 0 );
+}
+
+/*
+ * AES-CTR buffer encryption/decryption
+ */
+static void aesce_ctr_inc( unsigned char nonce_counter[16] )
+{
+    int i;
+
+    for( i = 16; i > 0; i-- )
+        if( ++nonce_counter[i - 1] != 0 )
+            break;
+}
+
+int mbedtls_aesce_crypt_ctr( mbedtls_aesce_context *ctx,
+                             size_t length,
+                             size_t *nc_off,
+                             unsigned char nonce_counter[16],
+                             unsigned char stream_block[16],
+                             const unsigned char *input,
+                             unsigned char *output )
+{
+    unsigned char buf[16 * AESCE_BULK_BLOCKS];
+    size_t n = *nc_off;
+    size_t i, m;
+
+    if( n > 15 )
+        return( MBEDTLS_ERR_AES_BAD_INPUT_DATA );
+
+    /* Rest of the keystream block of the previous call */
+    while( n != 0 && length > 0 )
+    {
+        *output++ = *input++ ^ stream_block[n];
+        n = ( n + 1 ) & 0x0f;
+        length--;
+    }
+
+    while( length >= 16 )
+    {
+        m = length / 16 < AESCE_BULK_BLOCKS ? length / 16 : AESCE_BULK_BLOCKS;
+        for( i = 0; i < m; i++ )
+        {
+            memcpy( buf + 16 * i, nonce_counter, 16 );
+            aesce_ctr_inc( nonce_counter );
+        }
+        aesce_blocks( ctx, MBEDTLS_AES_ENCRYPT, buf, buf, m );
+        for( i = 0; i < 16 * m; i++ )
+            output[i] = input[i] ^ buf[i];
+
+        input += 16 * m;
+        output += 16 * m;
+        length -= 16 * m;
+    }
+
+    if( length > 0 )
+    {
+        aesce_blocks( ctx, MBEDTLS_AES_ENCRYPT, nonce_counter, stream_block, 1 );
+        aesce_ctr_inc( nonce_counter );
+        for( n = 0; n < length; n++ )
+            output[n] = input[n] ^ stream_block[n];
+    }
+
+    *nc_off = n;
+    mbedtls_platform_zeroize( buf, sizeof( buf ) );
+
+    return( 0 );
+}
+
+/*
+ * AES-XTS
+ */
+static int aesce_xts_decode_keys( const unsigned char *key,
+                                  unsigned int keybits,
+                                  const unsigned char **key1,
+                                  const unsigned char **key2 )
+{
+    if( keybits != 256 && keybits != 512 )
+        return( MBEDTLS_ERR_AES_INVALID_KEY_LENGTH );
+
+    *key1 = key;
+    *key2 = key + keybits / 16;
+
+    return( 0 );
+}
+
+int mbedtls_aesce_xts_setkey_enc( mbedtls_aesce_xts_context *ctx,
+                                  const unsigned char *key,
+                                  unsigned int keybits )
+{
+    const unsigned char *key1, *key2;
+    int ret;
+
+    ret = aesce_xts_decode_keys( key, keybits, &key1, &key2 );
+    if( ret != 0 )
+        return( ret );
+
+    ret = mbedtls_aesce_setkey_enc( &ctx->tweak, key2, keybits / 2 );
+    if( ret != 0 )
+        return( ret );
+
+    return( mbedtls_aesce_setkey_enc( &ctx->crypt, key1, keybits / 2 ) );
+}
+
+int mbedtls_aesce_xts_setkey_dec( mbedtls_aesce_xts_context *ctx,
+                                  const unsigned char *key,
+                                  unsigned int keybits )
+{
+    const unsigned char *key1, *key2;
+    int ret;
+
+    ret = aesce_xts_decode_keys( key, keybits, &key1, &key2 );
+    if( ret != 0 )
+        return( ret );
+
+    ret = mbedtls_aesce_setkey_enc( &ctx->tweak, key2, keybits / 2 );
+    if( ret != 0 )
+        return( ret );
+
+    return( mbedtls_aesce_setkey_dec( &ctx->crypt, key1, keybits / 2 ) );
+}
+
+/*
+ * Multiplication by x of the tweak, in GF(2^128) with the bit order of
+ * IEEE P1619
+ */
+static void aesce_gf128mul_x_ble( unsigned char r[16],
+                                  const unsigned char x[16] )
+{
+    unsigned char carry = x[15] >> 7;
+    int i;
+
+    for( i = 15; i > 0; i-- )
+        r[i] = (unsigned char) ( ( x[i] << 1 ) | ( x[i - 1] >> 7 ) );
+    r[0] = (unsigned char) ( ( x[0] << 1 ) ^ ( 0x87 & -carry ) );
+}
+
+/*
+ * AES-XTS buffer encryption/decryption, AESCE_BULK_BLOCKS blocks at a time
+ */
+int mbedtls_aesce_crypt_xts( mbedtls_aesce_xts_context *ctx,
+                             int mode,
+                             size_t length,
+                             unsigned char data_unit[16],
+                             const unsigned char *input,
+                             unsigned char *output )
+{
+    unsigned char tweaks[16 * AESCE_BULK_BLOCKS];
+    unsigned char buf[16 * AESCE_BULK_BLOCKS];
+    unsigned char tweak[16];
+    unsigned char prev_tweak[16];
+    unsigned char *t, *prev_output;
+    size_t blocks = length / 16;
+    size_t leftover = length % 16;
+    size_t i, n;
+
+    /* Data units must be at least 16 bytes long and at most 2^20 blocks */
+    if( length < 16 || length > ( (size_t) 1 << 24 ) )
+        return( MBEDTLS_ERR_AES_INVALID_INPUT_LENGTH );
+
+    aesce_blocks( &ctx->tweak, MBEDTLS_AES_ENCRYPT, data_unit, tweak, 1 );
+
+    /*
+     * With ciphertext stealing, the last full block is left to the code
+     * below
+     */
+    if( leftover != 0 )
+        blocks--;
+
+    while( blocks > 0 )
+    {
+        n = blocks < AESCE_BULK_BLOCKS ? blocks : AESCE_BULK_BLOCKS;
+        for( i = 0; i < n; i++ )
+        {
+            memcpy( tweaks + 16 * i, tweak, 16 );
+            aesce_gf128mul_x_ble( tweak, tweak );
+        }
+        for( i = 0; i < 16 * n; i++ )
+            buf[i] = input[i] ^ tweaks[i];
+        aesce_blocks( &ctx->crypt, mode, buf, buf, n );
+        for( i = 0; i < 16 * n; i++ )
+            output[i] = buf[i] ^ tweaks[i];
+
+        input += 16 * n;
+        output += 16 * n;
+        blocks -= n;
+    }
+
+    if( leftover != 0 )
+    {
+        /*
+         * The last full block takes the tweak of the partial one when
+         * decrypting, and the other way round
+         */
+        memcpy( prev_tweak, tweak, 16 );
+        aesce_gf128mul_x_ble( tweak, tweak );
+        t = mode == MBEDTLS_AES_DECRYPT ? tweak : prev_tweak;
+
+        for( i = 0; i < 16; i++ )
+            buf[i] = input[i] ^ t[i];
+        aesce_blocks( &ctx->crypt, mode, buf, buf, 1 );
+        for( i = 0; i < 16; i++ )
+            output[i] = buf[i] ^ t[i];
+        input += 16;
+        output += 16;
+
+        /* Ciphertext stealing */
+        t = mode == MBEDTLS_AES_DECRYPT ? prev_tweak : tweak;
+        prev_output = output - 16;
+        for( i = 0; i < leftover; i++ )
+        {
+            buf[i] = input[i] ^ t[i];
+            output[i] = prev_output[i];
+        }
+        for( ; i < 16; i++ )
+            buf[i] = prev_output[i] ^ t[i];
+        aesce_blocks( &ctx->crypt, mode, buf, buf, 1 );
+        for( i = 0; i < 16; i++ )
+            prev_output[i] = buf[i] ^ t[i];
+    }
+
+    /* Next data unit */
+    for( i = 0; i < 16 && ++data_unit[i] == 0; i++ )
+        ;
+
+    mbedtls_platform_zeroize( tweaks, sizeof( tweaks ) );
+    mbedtls_platform_zeroize( buf, sizeof( buf ) );
+    mbedtls_platform_zeroize( tweak, sizeof( tweak ) );
+    mbedtls_platform_zeroize( prev_tweak, sizeof( prev_tweak ) );
+
+    return( 0 );
+}
+
+/*
+ * GHASH
+ *
+ * The blocks are read as 128-bit big-endian integers, [0] being the high
+ * half and [1] the low one, so that the coefficient of x^i is bit 127 - i.
+ * Up to 4 blocks are multiplied by H^4 .. H and summed before a single
+ * reduction.
+ */
+
+/*
+ * Carry-less product of 32-bit words with integer multiplications: the
+ * bits of the operands are spread 4 apart, so that the carries of the
+ * at most 8 terms of each bit of a product stay out of the bits kept
+ */
+static inline uint64_t ghash_clmul32( uint32_t x, uint32_t y )
+{
+    uint64_t x0, x1, x2, x3, y0, y1, y2, y3;
+    uint64_t z0, z1, z2, z3;
+
+    x0 = x & 0x11111111;
+    x1 = x & 0x22222222;
+    x2 = x & 0x44444444;
+    x3 = x & 0x88888888;
+    y0 = y & 0x11111111;
+    y1 = y & 0x22222222;
+    y2 = y & 0x44444444;
+    y3 = y & 0x88888888;
+
+    z0 = ( x0 * y0 ) ^ ( x1 * y3 ) ^ ( x2 * y2 ) ^ ( x3 * y1 );
+    z1 = ( x0 * y1 ) ^ ( x1 * y0 ) ^ ( x2 * y3 ) ^ ( x3 * y2 );
+    z2 = ( x0 * y2 ) ^ ( x1 * y1 ) ^ ( x2 * y0 ) ^ ( x3 * y3 );
+    z3 = ( x0 * y3 ) ^ ( x1 * y2 ) ^ ( x2 * y1 ) ^ ( x3 * y0 );
+
+    return( ( z0 & 0x1111111111111111ULL ) |
+            ( z1 & 0x2222222222222222ULL ) |
+            ( z2 & 0x4444444444444444ULL ) |
+            ( z3 & 0x8888888888888888ULL ) );
+}
+
+/* Carry-less product of 64-bit words, by Karatsuba */
+static void ghash_clmul64( uint64_t x, uint64_t y, uint64_t r[2] )
+{
+    uint64_t lo, hi, mid;
+
+    lo = ghash_clmul32( (uint32_t) x, (uint32_t) y );
+    hi = ghash_clmul32( (uint32_t) ( x >> 32 ), (uint32_t) ( y >> 32 ) );
+    mid = ghash_clmul32( (uint32_t) ( x ^ ( x >> 32 ) ),
+                         (uint32_t) ( y ^ ( y >> 32 ) ) ) ^ lo ^ hi;
+
+    r[0] = hi ^ ( mid >> 32 );
+    r[1] = lo ^ ( mid << 32 );
+}
+
+/*
+ * Sum of the products of x[i] and H^(n - i), unreduced: by Karatsuba,
+ * the products of the high halves in acc[0..1], of the sums of the
+ * halves in acc[2..3] and of the low halves in acc[4..5]
+ */
+static void ghash_mult_c( const uint64_t h[4][2], const uint64_t x[4][2],
+                          int n, uint64_t acc[6] )
+{
+    const uint64_t *hp;
+    uint64_t r[2];
+    int i;
+
+    memset( acc, 0, 6 * sizeof( uint64_t ) );
+
+    for( i = 0; i < n; i++ )
+    {
+        hp = h[n - 1 - i];
+
+        ghash_clmul64( x[i][0], hp[0], r );
+        acc[0] ^= r[0];
+        acc[1] ^= r[1];
+        ghash_clmul64( x[i][0] ^ x[i][1], hp[0] ^ hp[1], r );
+        acc[2] ^= r[0];
+        acc[3] ^= r[1];
+        ghash_clmul64( x[i][1], hp[1], r );
+        acc[4] ^= r[0];
+        acc[5] ^= r[1];
+    }
+}
+
+#if defined(AESCE_NEON)
+AESCE_TARGET
+static void ghash_mult_ce( const uint64_t h[4][2], const uint64_t x[4][2],
+                           int n, uint64_t acc[6] )
+{
+    uint64x2_t hh = vdupq_n_u64( 0 );
+    uint64x2_t mm = vdupq_n_u64( 0 );
+    uint64x2_t ll = vdupq_n_u64( 0 );
+    const uint64_t *hp;
+    int i;
+
+    for( i = 0; i < n; i++ )
+    {
+        hp = h[n - 1 - i];
+
+        hh = veorq_u64( hh, vreinterpretq_u64_p128(
+                 vmull_p64( (poly64_t) x[i][0], (poly64_t) hp[0] ) ) );
+        mm = veorq_u64( mm, vreinterpretq_u64_p128(
+                 vmull_p64( (poly64_t) ( x[i][0] ^ x[i][1] ),
+                            (poly64_t) ( hp[0] ^ hp[1] ) ) ) );
+        ll = veorq_u64( ll, vreinterpretq_u64_p128(
+                 vmull_p64( (poly64_t) x[i][1], (poly64_t) hp[1] ) ) );
+    }
+
+    acc[0] = vgetq_lane_u64( hh, 1 );
+    acc[1] = vgetq_lane_u64( hh, 0 );
+    acc[2] = vgetq_lane_u64( mm, 1 );
+    acc[3] = vgetq_lane_u64( mm, 0 );
+    acc[4] = vgetq_lane_u64( ll, 1 );
+    acc[5] = vgetq_lane_u64( ll, 0 );
+}
+#endif /* AESCE_NEON */
+
+static void ghash_mult( const uint64_t h[4][2], const uint64_t x[4][2],
+                        int n, uint64_t acc[6] )
+{
+#if defined(AESCE_NEON)
+    if( aesce_use_ce() )
+    {
+        ghash_mult_ce( h, x, n, acc );
+        return;
+    }
+#endif
+
+    ghash_mult_c( h, x, n, acc );
+}
+
+/*
+ * Reduction modulo x^128 + x^7 + x^2 + x + 1 of the 256-bit product. The
+ * product of the bit-reflected operands is the bit-reflected product
+ * shifted right by one. The low half L of the shifted product, the
+ * coefficients of x^128 to x^255, is folded with x^128 = 1 + x + x^2 + x^7,
+ * that is L + L >> 1 + L >> 2 + L >> 7, the bits shifted out of which are
+ * folded the same way without further overflow.
+ */
+static void ghash_reduce( const uint64_t acc[6], uint64_t y[2] )
+{
+    uint64_t z0, z1, z2, z3, o;
+
+    z0 = acc[0];
+    z1 = acc[1] ^ acc[2] ^ acc[0] ^ acc[4];
+    z2 = acc[4] ^ acc[3] ^ acc[1] ^ acc[5];
+    z3 = acc[5];
+
+    z0 = ( z0 << 1 ) | ( z1 >> 63 );
+    z1 = ( z1 << 1 ) | ( z2 >> 63 );
+    z2 = ( z2 << 1 ) | ( z3 >> 63 );
+    z3 = z3 << 1;
+
+    o = ( z3 << 63 ) ^ ( z3 << 62 ) ^ ( z3 << 57 );
+    z2 ^= o;
+
+    y[0] = z0 ^ z2 ^ ( z2 >> 1 ) ^ ( z2 >> 2 ) ^ ( z2 >> 7 );
+    y[1] = z1 ^ z3 ^ ( ( z3 >> 1 ) | ( z2 << 63 ) )
+                   ^ ( ( z3 >> 2 ) | ( z2 << 62 ) )
+                   ^ ( ( z3 >> 7 ) | ( z2 << 57 ) );
+}
+
+static void ghash_blocks( const mbedtls_aesce_gcm_context *ctx,
+                          uint64_t y[2], const unsigned char *input,
+                          size_t blocks )
+{
+    uint64_t x[4][2], acc[6];
+    int i, n;
+
+    while( blocks > 0 )
+    {
+        n = blocks < 4 ? (int) blocks : 4;
+        for( i = 0; i < n; i++ )
+        {
+            GET_UINT64_BE( x[i][0], input, 16 * i );
+            GET_UINT64_BE( x[i][1], input, 16 * i + 8 );
+        }
+        x[0][0] ^= y[0];
+        x[0][1] ^= y[1];
+
+        ghash_mult( ctx->h, x, n, acc );
+        ghash_reduce( acc, y );
+
+        input += 16 * n;
+        blocks -= (size_t) n;
+    }
+
+    mbedtls_platform_zeroize( x, sizeof( x ) );
+    mbedtls_platform_zeroize( acc, sizeof( acc ) );
+}
+
+/* GHASH of a string, zero-padded to a whole number of blocks */
+static void ghash( const mbedtls_aesce_gcm_context *ctx, uint64_t y[2],
+                   const unsigned char *input, size_t length )
+{
+    unsigned char last[16];
+
+    ghash_blocks( ctx, y, input, length / 16 );
+
+    if( length % 16 != 0 )
+    {
+        memset( last, 0, sizeof( last ) );
+        memcpy( last, input + length - length % 16, length % 16 );
+        ghash_blocks( ctx, y, last, 1 );
+        mbedtls_platform_zeroize( last, sizeof( last ) );
+    }
+}
+
+/*
+ * AES-GCM
+ */
+void mbedtls_aesce_gcm_init( mbedtls_aesce_gcm_context *ctx )
+{
+    if( ctx == NULL )
+        return;
+
+    memset( ctx, 0, sizeof( mbedtls_aesce_gcm_context ) );
+}
+
+void mbedtls_aesce_gcm_free( mbedtls_aesce_gcm_context *ctx )
+{
+    if( ctx == NULL )
+        return;
+
+    mbedtls_platform_zeroize( ctx, sizeof( mbedtls_aesce_gcm_context ) );
+}
+
+int mbedtls_aesce_gcm_setkey( mbedtls_aesce_gcm_context *ctx,
+                              const unsigned char *key,
+                              unsigned int keybits )
+{
+    unsigned char h[16];
+    uint64_t x[4][2], acc[6];
+    int i, ret;
+
+    ret = mbedtls_aesce_setkey_enc( &ctx->aes, key, keybits );
+    if( ret != 0 )
+        return( ret );
+
+    memset( h, 0, sizeof( h ) );
+    aesce_blocks( &ctx->aes, MBEDTLS_AES_ENCRYPT, h, h, 1 );
+    GET_UINT64_BE( ctx->h[0][0], h, 0 );
+    GET_UINT64_BE( ctx->h[0][1], h, 8 );
+
+    /* H^(i + 1) = H^i H */
+    for( i = 1; i < 4; i++ )
+    {
+        x[0][0] = ctx->h[i - 1][0];
+        x[0][1] = ctx->h[i - 1][1];
+        ghash_mult( ctx->h, x, 1, acc );
+        ghash_reduce( acc, ctx->h[i] );
+    }
+
+    mbedtls_platform_zeroize( h, sizeof( h ) );
+    mbedtls_platform_zeroize( x, sizeof( x ) );
+    mbedtls_platform_zeroize( acc, sizeof( acc ) );
+
+    return( 0 );
+}
+
+static void gcm_inc32( unsigned char ctr[16] )
+{
+    int i;
+
+    for( i = 16; i > 12; i-- )
+        if( ++ctr[i - 1] != 0 )
+            break;
+}
+
+/*
+ * GCTR and GHASH over the text, AESCE_BULK_BLOCKS blocks at a time so
+ * that both passes find the data in the cache. The full tag is returned.
+ */
+static int gcm_crypt( mbedtls_aesce_gcm_context *ctx, int mode,
+                      size_t length,
+                      const unsigned char *iv, size_t iv_len,
+                      const unsigned char *add, size_t add_len,
+                      const unsigned char *input, unsigned char *output,
+                      unsigned char tag[16] )
+{
+    unsigned char j0[16], ctr[16], buf[16 * AESCE_BULK_BLOCKS];
+    uint64_t y[2], lens[2];
+    size_t i, n, blocks;
+
+    /* IV and AD are limited to 2^64 bits, the text to 2^36 - 32 bytes */
+    if( iv_len == 0 || (uint64_t) iv_len >> 61 != 0 ||
+        (uint64_t) add_len >> 61 != 0 ||
+        (uint64_t) length > 0xFFFFFFFE0ULL )
+        return( MBEDTLS_ERR_GCM_BAD_INPUT );
+
+    if( iv_len == 12 )
+    {
+        memcpy( j0, iv, 12 );
+        memset( j0 + 12, 0, 3 );
+        j0[15] = 1;
+    }
+    else
+    {
+        y[0] = y[1] = 0;
+        ghash( ctx, y, iv, iv_len );
+        lens[0] = 0;
+        lens[1] = (uint64_t) iv_len * 8;
+        PUT_UINT64_BE( lens[0], buf, 0 );
+        PUT_UINT64_BE( lens[1], buf, 8 );
+        ghash_blocks( ctx, y, buf, 1 );
+        PUT_UINT64_BE( y[0], j0, 0 );
+        PUT_UINT64_BE( y[1], j0, 8 );
+    }
+
+    y[0] = y[1] = 0;
+    ghash( ctx, y, add, add_len );
+
+    memcpy( ctr, j0, 16 );
+    lens[0] = (uint64_t) add_len * 8;
+    lens[1] = (uint64_t) length * 8;
+
+    while( length > 0 )
+    {
+        n = length < sizeof( buf ) ? length : sizeof( buf );
+        blocks = ( n + 15 ) / 16;
+
+        if( mode == MBEDTLS_GCM_DECRYPT )
+            ghash( ctx, y, input, n );
+
+        for( i = 0; i < blocks; i++ )
+        {
+            gcm_inc32( ctr );
+            memcpy( buf + 16 * i, ctr, 16 );
+        }
+        aesce_blocks( &ctx->aes, MBEDTLS_AES_ENCRYPT, buf, buf, blocks );
+        for( i = 0; i < n; i++ )
+            output[i] = input[i] ^ buf[i];
+
+        if( mode == MBEDTLS_GCM_ENCRYPT )
+            ghash( ctx, y, output, n );
+
+        input += n;
+        output += n;
+        length -= n;
+    }
+
+    PUT_UINT64_BE( lens[0], buf, 0 );
+    PUT_UINT64_BE( lens[1], buf, 8 );
+    ghash_blocks( ctx, y, buf, 1 );
+
+    aesce_blocks( &ctx->aes, MBEDTLS_AES_ENCRYPT, j0, buf, 1 );
+    PUT_UINT64_BE( y[0], tag, 0 );
+    PUT_UINT64_BE( y[1], tag, 8 );
+    for( i = 0; i < 16; i++ )
+        tag[i] ^= buf[i];
+
+    mbedtls_platform_zeroize( buf, sizeof( buf ) );
+    mbedtls_platform_zeroize( j0, sizeof( j0 ) );
+    mbedtls_platform_zeroize( ctr, sizeof( ctr ) );
+    mbedtls_platform_zeroize( y, sizeof( y ) );
+
+    return( 0 );
+}
+
+int mbedtls_aesce_gcm_crypt_and_tag( mbedtls_aesce_gcm_context *ctx,
+                                     int mode,
+                                     size_t length,
+                                     const unsigned char *iv,
+                                     size_t iv_len,
+                                     const unsigned char *add,
+                                     size_t add_len,
+                                     const unsigned char *input,
+                                     unsigned char *output,
+                                     size_t tag_len,
+                                     unsigned char *tag )
+{
+    unsigned char full_tag[16];
+    int ret;
+
+    if( tag_len < 4 || tag_len > 16 )
+        return( MBEDTLS_ERR_GCM_BAD_INPUT );
+
+    ret = gcm_crypt( ctx, mode, length, iv, iv_len, add, add_len,
+                     input, output, full_tag );
+    if( ret == 0 )
+        memcpy( tag, full_tag, tag_len );
+
+    mbedtls_platform_zeroize( full_tag, sizeof( full_tag ) );
+
+    return( ret );
+}
+
+int mbedtls_aesce_gcm_auth_decrypt( mbedtls_aesce_gcm_context *ctx,
+                                    size_t length,
+                                    const unsigned char *iv,
+                                    size_t iv_len,
+                                    const unsigned char *add,
+                                    size_t add_len,
+                                    const unsigned char *tag,
+                                    size_t tag_len,
+                                    const unsigned char *input,
+                                    unsigned char *output )
+{
+    unsigned char check_tag[16];
+    unsigned char diff;
+    size_t i;
+    int ret;
+
+    if( tag_len < 4 || tag_len > 16 )
+        return( MBEDTLS_ERR_GCM_BAD_INPUT );
+
+    ret = gcm_crypt( ctx, MBEDTLS_GCM_DECRYPT, length, iv, iv_len,
+                     add, add_len, input, output, check_tag );
+    if( ret != 0 )
+        return( ret );
+
+    /* Check the tag in "constant-time" */
+    for( diff = 0, i = 0; i < tag_len; i++ )
+        diff |= tag[i] ^ check_tag[i];
+
+    mbedtls_platform_zeroize( check_tag, sizeof( check_tag ) );
+
+    if( diff != 0 )
+    {
+        mbedtls_platform_zeroize( output, length );
+        return( MBEDTLS_ERR_GCM_AUTH_FAILED );
+    }
+
+    return( 0 );
+}
+
+#if defined(MBEDTLS_SELF_TEST)
+/*
+ * FIPS-197 Appendix C, then test data of the modes made with another
+ * implementation: 160 bytes 0x00, 0x01, ... under the key of SP 800-38A
+ * F.2 and the IV 0x00, 0x01, ..., for CTR the counter of SP 800-38A F.5,
+ * for XTS the same key followed by the key of FIPS-197 C.1 and the data
+ * unit 0x3333333333, for GCM the 256-bit key of FIPS-197 C.3 and the IV
+ * and additional data of the test case 16 of the GCM specification.
+ */
+static const unsigned char aesce_test_fips_key[32] =
+{
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+    0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+    0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17,
+    0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f,
+};
+
+static const unsigned char aesce_test_fips_pt[16] =
+{
+    0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+    0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff,
+};
+
+static const unsigned char aesce_test_fips_ct[3][16] =
+{
+    { 0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30,
+      0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a },
+    { 0xdd, 0xa9, 0x7c, 0xa4, 0x86, 0x4c, 0xdf, 0xe0,
+      0x6e, 0xaf, 0x70, 0xa0, 0xec, 0x0d, 0x71, 0x91 },
+    { 0x8e, 0xa2, 0xb7, 0xca, 0x51, 0x67, 0x45, 0xbf,
+      0xea, 0xfc, 0x49, 0x90, 0x4b, 0x49, 0x60, 0x89 },
+};
+
+static const unsigned char aesce_test_key[16] =
+{
+    0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
+    0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c,
+};
+
+static const unsigned char aesce_test_counter[16] =
+{
+    0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7,
+    0xf8, 0xf9, 0xfa, 0xfb, 0xfc, 0xfd, 0xfe, 0xff,
+};
+
+static const unsigned char aesce_test_data_unit[16] =
+{
+    0x33, 0x33, 0x33, 0x33, 0x33, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+static const unsigned char aesce_test_gcm_iv[12] =
+{
+    0xca, 0xfe, 0xba, 0xbe, 0xfa, 0xce, 0xdb, 0xad,
+    0xde, 0xca, 0xf8, 0x88,
+};
+
+static const unsigned char aesce_test_gcm_long_iv[60] =
+{
+    0x93, 0x13, 0x22, 0x5d, 0xf8, 0x84, 0x06, 0xe5,
+    0x55, 0x90, 0x9c, 0x5a, 0xff, 0x52, 0x69, 0xaa,
+    0x6a, 0x7a, 0x95, 0x38, 0x53, 0x4f, 0x7d, 0xa1,
+    0xe4, 0xc3, 0x03, 0xd2, 0xa3, 0x18, 0xa7, 0x28,
+    0xc3, 0xc0, 0xc9, 0x51, 0x56, 0x80, 0x95, 0x39,
+    0xfc, 0xf0, 0xe2, 0x42, 0x9a, 0x6b, 0x52, 0x54,
+    0x16, 0xae, 0xdb, 0xf5, 0xa0, 0xde, 0x6a, 0x57,
+    0xa6, 0x37, 0xb3, 0x9b,
+};
+
+static const unsigned char aesce_test_gcm_add[20] =
+{
+    0xfe, 0xed, 0xfa, 0xce, 0xde, 0xad, 0xbe, 0xef,
+    0xfe, 0xed, 0xfa, 0xce, 0xde, 0xad, 0xbe, 0xef,
+    0xab, 0xad, 0xda, 0xd2,
+};
+
+static const unsigned char aesce_test_cbc[160] =
+{
+    0x7d, 0xf7, 0x6b, 0x0c, 0x1a, 0xb8, 0x99, 0xb3,
+    0x3e, 0x42, 0xf0, 0x47, 0xb9, 0x1b, 0x54, 0x6f,
+    0x1c, 0xaa, 0x80, 0x18, 0xc8, 0x0b, 0x15, 0xb8,
+    0xe7, 0xae, 0xa8, 0x27, 0x94, 0xad, 0xcb, 0x00,
+    0xbb, 0xc1, 0xe2, 0x95, 0x91, 0x0b, 0x9d, 0xe4,
+    0xf1, 0x35, 0x8d, 0xcb, 0x42, 0x13, 0xbd, 0xd8,
+    0xee, 0xfa, 0x31, 0x54, 0x21, 0x5f, 0x47, 0x09,
+    0xaf, 0x46, 0x57, 0x3f, 0xc8, 0xcb, 0x07, 0xb9,
+    0x86, 0x0d, 0xc1, 0xdd, 0x67, 0xdd, 0xfd, 0x95,
+    0x2b, 0x41, 0xe3, 0xaa, 0x0c, 0xc4, 0x7a, 0x96,
+    0x48, 0x73, 0x85, 0x34, 0xd3, 0x7e, 0x5e, 0x29,
+    0xae, 0x21, 0x35, 0xaf, 0x75, 0x32, 0xe4, 0x1c,
+    0x14, 0x28, 0xb8, 0x47, 0xec, 0x62, 0x48, 0xfa,
+    0x03, 0x56, 0x8d, 0x55, 0x16, 0x3a, 0xa8, 0x98,
+    0x85, 0xe7, 0x57, 0xfd, 0x9c, 0x61, 0x99, 0x91,
+    0x78, 0xf9, 0x6a, 0x3c, 0x78, 0xf2, 0x6b, 0xef,
+    0xff, 0x9a, 0x03, 0x69, 0x1d, 0x10, 0xad, 0x99,
+    0x2b, 0x32, 0xf6, 0x74, 0xd0, 0x30, 0x94, 0xa6,
+    0x9b, 0x14, 0x87, 0x41, 0x26, 0x56, 0x3f, 0x8f,
+    0xf0, 0xa3, 0x03, 0x37, 0x8a, 0x36, 0xcb, 0xdd,
+};
+
+static const unsigned char aesce_test_ctr[157] =
+{
+    0xec, 0x8d, 0xdd, 0x70, 0x9c, 0x65, 0x7a, 0xb7,
+    0xfa, 0xdb, 0x1c, 0x7e, 0xe6, 0x93, 0xaf, 0xeb,
+    0x26, 0x3a, 0x6e, 0x2f, 0x73, 0x66, 0x47, 0x74,
+    0x00, 0xb9, 0x6d, 0xcc, 0xe0, 0x4d, 0x6d, 0xb1,
+    0x4a, 0x0d, 0xe1, 0x5b, 0x5c, 0xac, 0x11, 0x68,
+    0x96, 0x9d, 0xe2, 0x30, 0x3b, 0x97, 0x42, 0x6b,
+    0xd8, 0xad, 0x0b, 0xac, 0xc4, 0xc4, 0xae, 0xf1,
+    0xec, 0x33, 0x0b, 0xe0, 0x29, 0x51, 0x95, 0xc1,
+    0xf0, 0x4c, 0x05, 0xbb, 0x50, 0xcf, 0xd7, 0x49,
+    0xb8, 0x21, 0x7a, 0xdc, 0xdc, 0x06, 0xeb, 0x4d,
+    0x08, 0xc8, 0x16, 0x09, 0x19, 0xb4, 0x57, 0xa2,
+    0x4b, 0x93, 0x8b, 0xc3, 0x21, 0xd4, 0xb7, 0x44,
+    0x5b, 0xb8, 0xce, 0x1a, 0x2d, 0xbb, 0x4d, 0x9e,
+    0x0d, 0x00, 0xc6, 0x53, 0x2f, 0x95, 0x1c, 0x2d,
+    0x0d, 0xeb, 0xbc, 0xf3, 0x33, 0xb6, 0x25, 0x7e,
+    0x6d, 0x23, 0xc2, 0xd3, 0x8c, 0xf8, 0xe9, 0xce,
+    0x37, 0x1d, 0x3b, 0xa5, 0xc4, 0x6b, 0xce, 0x10,
+    0x1d, 0x26, 0xbc, 0x9e, 0xa6, 0x3e, 0x78, 0xb4,
+    0xea, 0xd3, 0xfd, 0xe5, 0x19, 0x2c, 0x73, 0x7f,
+    0x84, 0x2c, 0x52, 0xd5, 0xeb,
+};
+
+static const unsigned char aesce_test_xts[149] =
+{
+    0x07, 0xa6, 0xd5, 0x2a, 0x5b, 0x75, 0xed, 0xf2,
+    0xae, 0x22, 0x79, 0x2e, 0xed, 0x7c, 0x60, 0x7b,
+    0xa9, 0xf1, 0x44, 0x7a, 0xec, 0xe1, 0x31, 0x6d,
+    0x1b, 0xe0, 0x5d, 0x72, 0xa8, 0x49, 0x4c, 0xc0,
+    0x5f, 0x69, 0x85, 0xfc, 0x8c, 0xc1, 0x3a, 0xe6,
+    0x46, 0x39, 0x2a, 0x8f, 0x80, 0xa0, 0xa1, 0xde,
+    0x0e, 0x31, 0x28, 0xde, 0x86, 0x5f, 0xe6, 0xa0,
+    0x6a, 0x6f, 0x0f, 0xba, 0xb1, 0x61, 0xad, 0xf3,
+    0x49, 0xf3, 0x7e, 0xde, 0xdf, 0x5e, 0x20, 0x49,
+    0x9e, 0xce, 0x62, 0xed, 0x58, 0xbd, 0xcf, 0x6b,
+    0x81, 0x74, 0xb1, 0x35, 0x24, 0xe4, 0xbf, 0xe9,
+    0x7f, 0x72, 0x7d, 0x08, 0x0c, 0x52, 0xf1, 0x88,
+    0xf8, 0x2c, 0x34, 0x39, 0x1f, 0xa4, 0xf0, 0xd5,
+    0x0e, 0xb1, 0xcd, 0x90, 0x74, 0x32, 0x1e, 0xfe,
+    0xb6, 0x61, 0x5e, 0x8c, 0x90, 0x64, 0x18, 0x4d,
+    0x88, 0x38, 0x91, 0xa0, 0x7a, 0x6d, 0xa9, 0x59,
+    0x9e, 0x23, 0x39, 0x46, 0x69, 0x06, 0xdb, 0xcf,
+    0xae, 0x93, 0xa8, 0x1e, 0x07, 0xbe, 0xd2, 0x54,
+    0xf3, 0xde, 0x53, 0x77, 0x10,
+};
+
+static const unsigned char aesce_test_gcm[149] =
+{
+    0x8a, 0xa2, 0xa2, 0x25, 0xae, 0x7f, 0x49, 0x1c,
+    0x4e, 0x02, 0x57, 0xd6, 0x77, 0x10, 0x87, 0x30,
+    0x1d, 0x31, 0xd2, 0x42, 0xcb, 0x0c, 0x7c, 0x63,
+    0x56, 0xc6, 0x1e, 0x6a, 0xa2, 0x94, 0x7b, 0xe0,
+    0x8d, 0x71, 0xe3, 0x65, 0xe5, 0xf1, 0x6f, 0x45,
+    0x0e, 0x72, 0x02, 0x43, 0x1e, 0xae, 0x0e, 0x4a,
+    0x69, 0x65, 0x9b, 0x62, 0x97, 0xbf, 0xbe, 0xe7,
+    0x1b, 0xab, 0x4b, 0x07, 0x82, 0xd9, 0x89, 0x7d,
+    0x21, 0xc3, 0x1c, 0x31, 0x0b, 0x01, 0x1b, 0x98,
+    0x18, 0x93, 0x6c, 0x55, 0xe4, 0x53, 0xbe, 0x74,
+    0x48, 0xe1, 0x54, 0x2c, 0x0e, 0x70, 0x97, 0x58,
+    0xf2, 0xf4, 0x2e, 0x2b, 0x48, 0xc4, 0xc2, 0xb5,
+    0xa1, 0x16, 0xa9, 0x9e, 0xe9, 0xd8, 0xce, 0x9c,
+    0x62, 0x07, 0x64, 0x67, 0xd4, 0xc5, 0x67, 0xae,
+    0xaa, 0xdb, 0x6d, 0x7e, 0xee, 0xbf, 0xee, 0xb2,
+    0x58, 0x6b, 0x33, 0x41, 0x40, 0x3a, 0x9f, 0xea,
+    0xed, 0xad, 0x99, 0x96, 0x21, 0xb3, 0xbf, 0x3a,
+    0x51, 0xb9, 0x95, 0xc6, 0x1c, 0xca, 0x07, 0x39,
+    0x27, 0x5a, 0xb7, 0x84, 0x19,
+};
+
+static const unsigned char aesce_test_gcm_tag[16] =
+{
+    0x63, 0x50, 0x2a, 0x76, 0x11, 0x3b, 0x52, 0x88,
+    0xb7, 0x8d, 0x14, 0x01, 0x95, 0x64, 0xb5, 0x0f,
+};
+
+static const unsigned char aesce_test_gcm_long_iv_tag[16] =
+{
+    0x5d, 0xab, 0x83, 0x9d, 0x99, 0x4a, 0xad, 0xcd,
+    0x14, 0xd1, 0x94, 0x77, 0x02, 0xae, 0x05, 0xd2,
+};
+
+#define AESCE_TEST_LEN  160
+
+#if defined(AESCE_NEON)
+/* The bitsliced code and GHASH against AESE/AESD and PMULL */
+static int aesce_self_test_backends( const mbedtls_aesce_gcm_context *gcm,
+                                     const unsigned char *pt )
+{
+    unsigned char ce[AESCE_TEST_LEN], ct[AESCE_TEST_LEN];
+    uint64_t x[4][2], acc_ce[6], acc_ct[6];
+    int i;
+
+    aesce_ce_blocks( &gcm->aes, MBEDTLS_AES_ENCRYPT, pt, ce,
+                     AESCE_TEST_LEN / 16 );
+    aes_ct_blocks( &gcm->aes, MBEDTLS_AES_ENCRYPT, pt, ct,
+                   AESCE_TEST_LEN / 16 );
+    if( memcmp( ce, ct, sizeof( ce ) ) != 0 )
+        return( 1 );
+
+    for( i = 0; i < 4; i++ )
+    {
+        GET_UINT64_BE( x[i][0], ce, 16 * i );
+        GET_UINT64_BE( x[i][1], ce, 16 * i + 8 );
+    }
+    ghash_mult_ce( gcm->h, x, 4, acc_ce );
+    ghash_mult_c( gcm->h, x, 4, acc_ct );
+    if( memcmp( acc_ce, acc_ct, sizeof( acc_ce ) ) != 0 )
+        return( 1 );
+
+    return( 0 );
+}
+#endif /* AESCE_NEON */
+
+/*
+ * Checker routine
+ */
+int mbedtls_aesce_self_test( int verbose )
+{
+    mbedtls_aesce_context enc, dec;
+    mbedtls_aesce_xts_context xts;
+    mbedtls_aesce_gcm_context gcm;
+    unsigned char pt[AESCE_TEST_LEN];
+    unsigned char buf[AESCE_TEST_LEN];
+    unsigned char blk[16];
+    unsigned char iv[16];
+    unsigned char stream_block[16];
+    unsigned char tag[16];
+    size_t nc_off, i, n;
+    int k, ret = 0;
+
+    mbedtls_aesce_init( &enc );
+    mbedtls_aesce_init( &dec );
+    mbedtls_aesce_xts_init( &xts );
+    mbedtls_aesce_gcm_init( &gcm );
+
+    for( i = 0; i < AESCE_TEST_LEN; i++ )
+        pt[i] = (unsigned char) i;
+
+    if( verbose != 0 )
+        mbedtls_printf( "  AES-CE: %s\n", mbedtls_aesce_has_support() ?
+                        "Cryptographic Extension" : "bitsliced" );
+
+    for( k = 0; k < 3; k++ )
+    {
+        if( verbose != 0 )
+            mbedtls_printf( "  AES-CE-ECB-%3d: ", 128 + 64 * k );
+
+        if( mbedtls_aesce_setkey_enc( &enc, aesce_test_fips_key,
+                                      128 + 64 * k ) != 0 ||
+            mbedtls_aesce_setkey_dec( &dec, aesce_test_fips_key,
+                                      128 + 64 * k ) != 0 ||
+            mbedtls_aesce_crypt_ecb( &enc, MBEDTLS_AES_ENCRYPT, 16,
+                                     aesce_test_fips_pt, buf ) != 0 ||
+            memcmp( buf, aesce_test_fips_ct[k], 16 ) != 0 ||
+            mbedtls_aesce_crypt_ecb( &dec, MBEDTLS_AES_DECRYPT, 16,
+                                     buf, buf ) != 0 ||
+            memcmp( buf, aesce_test_fips_pt, 16 ) != 0 )
+            goto fail;
+
+        if( verbose != 0 )
+            mbedtls_printf( "passed\n" );
+    }
+
+    /*
+     * The bulk modes, in one call so that the multi-block paths run, and
+     * in pieces when the mode allows it
+     */
+    if( verbose != 0 )
+        mbedtls_printf( "  AES-CE-ECB-128 (bulk): " );
+
+    if( mbedtls_aesce_setkey_enc( &enc, aesce_test_key, 128 ) != 0 ||
+        mbedtls_aesce_setkey_dec( &dec, aesce_test_key, 128 ) != 0 ||
+        mbedtls_aesce_crypt_ecb( &enc, MBEDTLS_AES_ENCRYPT, AESCE_TEST_LEN,
+                                 pt, buf ) != 0 )
+        goto fail;
+    for( i = 0; i < AESCE_TEST_LEN; i += 16 )
+    {
+        if( mbedtls_aesce_crypt_ecb( &enc, MBEDTLS_AES_ENCRYPT, 16,
+                                     pt + i, blk ) != 0 ||
+            memcmp( buf + i, blk, 16 ) != 0 )
+            goto fail;
+    }
+    if( mbedtls_aesce_crypt_ecb( &dec, MBEDTLS_AES_DECRYPT, AESCE_TEST_LEN,
+                                 buf, buf ) != 0 ||
+        memcmp( buf, pt, AESCE_TEST_LEN ) != 0 )
+        goto fail;
+
+    if( verbose != 0 )
+        mbedtls_printf( "passed\n" );
+
+    if( verbose != 0 )
+        mbedtls_printf( "  AES-CE-CBC-128: " );
+
+    memcpy( iv, pt, 16 );
+    if( mbedtls_aesce_crypt_cbc( &enc, MBEDTLS_AES_ENCRYPT, AESCE_TEST_LEN,
+                                 iv, pt, buf ) != 0 ||
+        memcmp( buf, aesce_test_cbc, AESCE_TEST_LEN ) != 0 )
+        goto fail;
+
+    /* In place, in two calls */
+    memcpy( iv, pt, 16 );
+    if( mbedtls_aesce_crypt_cbc( &dec, MBEDTLS_AES_DECRYPT, 48, iv,
+                                 buf, buf ) != 0 ||
+        mbedtls_aesce_crypt_cbc( &dec, MBEDTLS_AES_DECRYPT,
+                                 AESCE_TEST_LEN - 48, iv, buf + 48,
+                                 buf + 48 ) != 0 ||
+        memcmp( buf, pt, AESCE_TEST_LEN ) != 0 ||
+        memcmp( iv, aesce_test_cbc + AESCE_TEST_LEN - 16, 16 ) != 0 )
+        goto fail;
+
+    if( verbose != 0 )
+        mbedtls_printf( "passed\n" );
+
+    if( verbose != 0 )
+        mbedtls_printf( "  AES-CE-CTR-128: " );
+
+    memcpy( iv, aesce_test_counter, 16 );
+    nc_off = 0;
+    if( mbedtls_aesce_crypt_ctr( &enc, sizeof( aesce_test_ctr ), &nc_off,
+                                 iv, stream_block, pt, buf ) != 0 ||
+        memcmp( buf, aesce_test_ctr, sizeof( aesce_test_ctr ) ) != 0 )
+        goto fail;
+
+    /* In pieces of 1 to 37 bytes, across the block boundaries */
+    memcpy( iv, aesce_test_counter, 16 );
+    nc_off = 0;
+    for( i = 0; i < sizeof( aesce_test_ctr ); i += n )
+    {
+        n = ( i % 37 ) + 1;
+        if( n > sizeof( aesce_test_ctr ) - i )
+            n = sizeof( aesce_test_ctr ) - i;
+        if( mbedtls_aesce_crypt_ctr( &enc, n, &nc_off, iv, stream_block,
+                                     aesce_test_ctr + i, buf + i ) != 0 )
+            goto fail;
+    }
+    if( memcmp( buf, pt, sizeof( aesce_test_ctr ) ) != 0 )
+        goto fail;
+
+    if( verbose != 0 )
+        mbedtls_printf( "passed\n" );
+
+    if( verbose != 0 )
+        mbedtls_printf( "  AES-CE-XTS-128: " );
+
+    memcpy( buf, aesce_test_key, 16 );
+    memcpy( buf + 16, aesce_test_fips_key, 16 );
+
+    memcpy( iv, aesce_test_data_unit, 16 );
+    if( mbedtls_aesce_xts_setkey_enc( &xts, buf, 256 ) != 0 ||
+        mbedtls_aesce_crypt_xts( &xts, MBEDTLS_AES_ENCRYPT,
+                                 sizeof( aesce_test_xts ), iv,
+                                 pt, buf + 32 ) != 0 ||
+        memcmp( buf + 32, aesce_test_xts, sizeof( aesce_test_xts ) ) != 0 )
+        goto fail;
+
+    memcpy( iv, aesce_test_data_unit, 16 );
+    if( mbedtls_aesce_xts_setkey_dec( &xts, buf, 256 ) != 0 )
+        goto fail;
+    memcpy( buf, aesce_test_xts, sizeof( aesce_test_xts ) );
+    if( mbedtls_aesce_crypt_xts( &xts, MBEDTLS_AES_DECRYPT,
+                                 sizeof( aesce_test_xts ), iv,
+                                 buf, buf ) != 0 ||
+        memcmp( buf, pt, sizeof( aesce_test_xts ) ) != 0 )
+        goto fail;
+
+    /* The data unit is incremented for the next call */
+    if( iv[0] != aesce_test_data_unit[0] + 1 ||
+        memcmp( iv + 1, aesce_test_data_unit + 1, 15 ) != 0 )
+        goto fail;
+
+    if( verbose != 0 )
+        mbedtls_printf( "passed\n" );
+
+    if( verbose != 0 )
+        mbedtls_printf( "  AES-CE-GCM-256: " );
+
+    if( mbedtls_aesce_gcm_setkey( &gcm, aesce_test_fips_key, 256 ) != 0 ||
+        mbedtls_aesce_gcm_crypt_and_tag( &gcm, MBEDTLS_GCM_ENCRYPT,
+                                         sizeof( aesce_test_gcm ),
+                                         aesce_test_gcm_iv,
+                                         sizeof( aesce_test_gcm_iv ),
+                                         aesce_test_gcm_add,
+                                         sizeof( aesce_test_gcm_add ),
+                                         pt, buf, 16, tag ) != 0 ||
+        memcmp( buf, aesce_test_gcm, sizeof( aesce_test_gcm ) ) != 0 ||
+        memcmp( tag, aesce_test_gcm_tag, 16 ) != 0 )
+        goto fail;
+
+    /* In place, then with a tampered tag */
+    if( mbedtls_aesce_gcm_auth_decrypt( &gcm, sizeof( aesce_test_gcm ),
+                                        aesce_test_gcm_iv,
+                                        sizeof( aesce_test_gcm_iv ),
+                                        aesce_test_gcm_add,
+                                        sizeof( aesce_test_gcm_add ),
+                                        tag, 16, buf, buf ) != 0 ||
+        memcmp( buf, pt, sizeof( aesce_test_gcm ) ) != 0 )
+        goto fail;
+
+    tag[15] ^= 1;
+    if( mbedtls_aesce_gcm_auth_decrypt( &gcm, sizeof( aesce_test_gcm ),
+                                        aesce_test_gcm_iv,
+                                        sizeof( aesce_test_gcm_iv ),
+                                        aesce_test_gcm_add,
+                                        sizeof( aesce_test_gcm_add ),
+                                        tag, 16, aesce_test_gcm,
+                                        buf ) != MBEDTLS_ERR_GCM_AUTH_FAILED )
+        goto fail;
+
+    if( verbose != 0 )
+        mbedtls_printf( "passed\n" );
+
+    if( verbose != 0 )
+        mbedtls_printf( "  AES-CE-GCM-128 (60-byte IV): " );
+
+    if( mbedtls_aesce_gcm_setkey( &gcm, aesce_test_key, 128 ) != 0 ||
+        mbedtls_aesce_gcm_crypt_and_tag( &gcm, MBEDTLS_GCM_ENCRYPT, 64,
+                                         aesce_test_gcm_long_iv,
+                                         sizeof( aesce_test_gcm_long_iv ),
+                                         aesce_test_gcm_add,
+                                         sizeof( aesce_test_gcm_add ),
+                                         pt, buf, 16, tag ) != 0 ||
+        memcmp( tag, aesce_test_gcm_long_iv_tag, 16 ) != 0 )
+        goto fail;
+
+    if( verbose != 0 )
+        mbedtls_printf( "passed\n" );
+
+#if defined(AESCE_NEON)
+    if( mbedtls_aesce_has_support() )
+    {
+        if( verbose != 0 )
+            mbedtls_printf( "  AES-CE (bitsliced and GHASH back ends): " );
+
+        if( aesce_self_test_backends( &gcm, pt ) != 0 )
+            goto fail;
+
+        if( verbose != 0 )
+            mbedtls_printf( "passed\n" );
+    }
+#endif /* AESCE_NEON */
+
+    if( verbose != 0 )
+        mbedtls_printf( "\n" );
+
+    goto exit;
+
+fail:
+    if( verbose != 0 )
+        mbedtls_printf( "failed\n" );
+    ret = 1;
+
+exit:
+    mbedtls_aesce_free( &enc );
+    mbedtls_aesce_free( &dec );
+    mbedtls_aesce_xts_free( &xts );
+    mbedtls_aesce_gcm_free( &gcm );
+    mbedtls_platform_zeroize( buf, sizeof( buf ) );
+    return( ret );
+}
+
+#endif /* MBEDTLS_SELF_TEST */
+
+#endif /* MBEDTLS_AESCE_C */
@@ -0,0 +1,770 @@
+/*
+ *  Montgomery arithmetic on 64-bit limbs
+ *
+ *  Copyright (c) 2026, D-Robotics
+ *  SPDX-License-Identifier: BSD-2-Clause
+ */
+/*
+ *  Montgomery multiplication: P. L. Montgomery, "Modular multiplication
+ *  without trial division", Mathematics of Computation 44, 1985.
+ *
+ *  Products are computed in full into ctx->T, 2n + 1 limbs, then reduced
+ *  one limb at a time. Both steps are rows of d[] += s[] * b, the only
+ *  quadratic loop, which AArch64 runs four limbs per iteration: MUL and
+ *  UMULH of the four limbs, one ADCS chain adding the low halves to the
+ *  high halves of the previous limbs, and one adding the row to d[].
+ *  Squaring computes each cross product a[i] * a[j], i < j, once, doubles
+ *  them and adds the squares a[i]^2.
+ */
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#if defined(MBEDTLS_BN_MONT_C)
+
+#include "mbedtls/bn_mont.h"
+#include "mbedtls/asn1.h"
+#include "mbedtls/oid.h"
+#include "mbedtls/platform_util.h"
+
+#include <string.h>
+
+#if defined(MBEDTLS_PLATFORM_C)
+#include "mbedtls/platform.h"
+#else
+#include <stdio.h>
+#include <stdlib.h>
+#define mbedtls_calloc    calloc
+#define mbedtls_free      free
+#define mbedtls_printf    printf
+#endif /* MBEDTLS_PLATFORM_C */
+
+#if !defined(__SIZEOF_INT128__)
+#error "MBEDTLS_BN_MONT_C needs a 64-bit target with 128-bit integers"
+#endif
+
+typedef unsigned __int128 bn_mont_udbl;
+
+/*
+ * d[0..n) += s[0..n) * b, returns the carry limb
+ */
+#if defined(__aarch64__)
+static uint64_t bn_mont_mla( uint64_t *d, const uint64_t *s, size_t n,
+                             uint64_t b )
+{
+    uint64_t c = 0;
+
+    for( ; n >= 4; n -= 4 )
+    {
+        asm volatile(
+            "ldp    x4, x5, [%[s]], #16     \n\t"
+            "ldp    x6, x7, [%[s]], #16     \n\t"
+            "mul    x8, x4, %[b]            \n\t"
+            "umulh  x4, x4, %[b]            \n\t"
+            "mul    x9, x5, %[b]            \n\t"
+            "umulh  x5, x5, %[b]            \n\t"
+            "mul    x10, x6, %[b]           \n\t"
+            "umulh  x6, x6, %[b]            \n\t"
+            "mul    x11, x7, %[b]           \n\t"
+            "umulh  x7, x7, %[b]            \n\t"
+            /* s[] * b + c, the high halves cannot overflow */
+            "adds   x8, x8, %[c]            \n\t"
+            "adcs   x9, x9, x4              \n\t"
+            "adcs   x10, x10, x5            \n\t"
+            "adcs   x11, x11, x6            \n\t"
+            "adc    %[c], x7, xzr           \n\t"
+            /* + d[] */
+            "ldp    x4, x5, [%[d]]          \n\t"
+            "ldp    x6, x7, [%[d], #16]     \n\t"
+            "adds   x4, x4, x8              \n\t"
+            "adcs   x5, x5, x9              \n\t"
+            "adcs   x6, x6, x10             \n\t"
+            "adcs   x7, x7, x11             \n\t"
+            "adc    %[c], %[c], xzr         \n\t"
+            "stp    x4, x5, [%[d]], #16     \n\t"
+            "stp    x6, x7, [%[d]], #16     \n\t"
+            : [c] "+r" (c), [d] "+r" (d), [s] "+r" (s)
+            : [b] "r" (b)
+            : "x4", "x5", "x6", "x7", "x8", "x9", "x10", "x11",
+              "cc", "memory"
+        );
+    }
+
+    for( ; n > 0; n-- )
+    {
+        asm volatile(
+            "ldr    x4, [%[s]], #8          \n\t"
+            "ldr    x5, [%[d]]              \n\t"
+            "mul    x6, x4, %[b]            \n\t"
+            "umulh  x7, x4, %[b]            \n\t"
+            "adds   x5, x5, x6              \n\t"
+            "adc    x7, x7, xzr             \n\t"
+            "adds   x5, x5, %[c]            \n\t"
+            "adc    %[c], x7, xzr           \n\t"
+            "str    x5, [%[d]], #8          \n\t"
+            : [c] "+r" (c), [d] "+r" (d), [s] "+r" (s)
+            : [b] "r" (b)
+            : "x4", "x5", "x6", "x7", "cc", "memory"
+        );
+    }
+
+    return( c );
+}
+#else
+static uint64_t bn_mont_mla( uint64_t *d, const uint64_t *s, size_t n,
+                             uint64_t b )
+{
+    bn_mont_udbl t;
+    uint64_t c = 0;
+    size_t i;
+
+    for( i = 0; i < n; i++ )
+    {
+        t = (bn_mont_udbl) s[i] * b + d[i] + c;
+        d[i] = (uint64_t) t;
+        c = (uint64_t) ( t >> 64 );
+    }
+
+    return( c );
+}
+#endif /* __aarch64__ */
+
+/* r = a - b, returns the borrow */
+static uint64_t bn_mont_sub( uint64_t *r, const uint64_t *a,
+                             const uint64_t *b, size_t n )
+{
+    bn_mont_udbl t;
+    uint64_t borrow = 0;
+    size_t i;
+
+    for( i = 0; i < n; i++ )
+    {
+        t = (bn_mont_udbl) a[i] - b[i] - borrow;
+        r[i] = (uint64_t) t;
+        borrow = (uint64_t) ( t >> 64 ) & 1;
+    }
+
+    return( borrow );
+}
+
+/*
+ * r = T / R mod N, from T = ctx->T < N * R. r may be any of the operands.
+ */
+static void bn_mont_redc( mbedtls_bn_mont_context *ctx, uint64_t *r )
+{
+    uint64_t *T = ctx->T;
+    size_t n = ctx->n;
+    uint64_t carry = 0;
+    uint64_t c, t, mask;
+    size_t i;
+
+    for( i = 0; i < n; i++ )
+    {
+        c = bn_mont_mla( T + i, ctx->N, n, T[i] * ctx->n0 );
+        t = T[i + n] + carry;
+        carry = t < carry;
+        t += c;
+        carry += t < c;
+        T[i + n] = t;
+    }
+
+    /* carry:T[n..2n) < 2N, keep it unless it is at least N */
+    c = bn_mont_sub( r, T + n, ctx->N, n );
+    mask = (uint64_t) 0 - ( c & ( carry ^ 1 ) );
+    for( i = 0; i < n; i++ )
+        r[i] = ( T[i + n] & mask ) | ( r[i] & ~mask );
+}
+
+/* r = a * b / R mod N */
+static void bn_mont_mul( mbedtls_bn_mont_context *ctx, uint64_t *r,
+                         const uint64_t *a, const uint64_t *b )
+{
+    uint64_t *T = ctx->T;
+    size_t n = ctx->n;
+    size_t i;
+
+    memset( T, 0, n * sizeof( uint64_t ) );
+    for( i = 0; i < n; i++ )
+        T[i + n] = bn_mont_mla( T + i, a, n, b[i] );
+
+    bn_mont_redc( ctx, r );
+}
+
+/* r = a^2 / R mod N */
+static void bn_mont_sqr( mbedtls_bn_mont_context *ctx, uint64_t *r,
+                         const uint64_t *a )
+{
+    uint64_t *T = ctx->T;
+    size_t n = ctx->n;
+    bn_mont_udbl t, sq;
+    uint64_t c, u;
+    size_t i;
+
+    /* The cross products, row i adding a[i] * a[i + 1..n) at T[2i + 1] */
+    memset( T, 0, n * sizeof( uint64_t ) );
+    for( i = 0; i + 1 < n; i++ )
+        T[i + n] = bn_mont_mla( T + 2 * i + 1, a + i + 1, n - i - 1, a[i] );
+    T[2 * n - 1] = 0;
+
+    /* Doubled, plus the squares */
+    c = 0;
+    for( i = 0; i < 2 * n; i++ )
+    {
+        u = T[i];
+        T[i] = ( u << 1 ) | c;
+        c = u >> 63;
+    }
+
+    c = 0;
+    for( i = 0; i < n; i++ )
+    {
+        sq = (bn_mont_udbl) a[i] * a[i];
+        t = (bn_mont_udbl) T[2 * i] + (uint64_t) sq + c;
+        T[2 * i] = (uint64_t) t;
+        t = ( t >> 64 ) + T[2 * i + 1] + (uint64_t) ( sq >> 64 );
+        T[2 * i + 1] = (uint64_t) t;
+        c = (uint64_t) ( t >> 64 );
+    }
+
+    bn_mont_redc( ctx, r );
+}
+
+/*
+ * Big-endian Bytes to and from limbs
+ */
+static void bn_mont_read_be( uint64_t *r, size_t n,
+                             const unsigned char *buf, size_t len )
+{
+    size_t i;
+
+    memset( r, 0, n * sizeof( uint64_t ) );
+    for( i = 0; i < len; i++ )
+        r[i / 8] |= (uint64_t) buf[len - 1 - i] << ( 8 * ( i % 8 ) );
+}
+
+static void bn_mont_write_be( unsigned char *buf, size_t len,
+                              const uint64_t *r )
+{
+    size_t i;
+
+    for( i = 0; i < len; i++ )
+        buf[len - 1 - i] = (unsigned char) ( r[i / 8] >> ( 8 * ( i % 8 ) ) );
+}
+
+/* r = X, in [0, N) */
+static int bn_mont_from_mpi( mbedtls_bn_mont_context *ctx, uint64_t *r,
+                             const mbedtls_mpi *X )
+{
+    unsigned char *buf = (unsigned char *) ctx->T;
+    size_t len = ctx->n * sizeof( uint64_t );
+    size_t i;
+
+    if( mbedtls_mpi_cmp_int( X, 0 ) < 0 ||
+        mbedtls_mpi_write_binary( X, buf, len ) != 0 )
+        return( MBEDTLS_ERR_MPI_BAD_INPUT_DATA );
+
+    bn_mont_read_be( r, ctx->n, buf, len );
+
+    for( i = ctx->n; i > 0; i-- )
+    {
+        if( r[i - 1] != ctx->N[i - 1] )
+            break;
+    }
+    if( i == 0 || r[i - 1] > ctx->N[i - 1] )
+        return( MBEDTLS_ERR_MPI_BAD_INPUT_DATA );
+
+    return( 0 );
+}
+
+static int bn_mont_to_mpi( mbedtls_bn_mont_context *ctx, mbedtls_mpi *X,
+                           const uint64_t *r )
+{
+    unsigned char *buf = (unsigned char *) ctx->T;
+    size_t len = ctx->n * sizeof( uint64_t );
+
+    bn_mont_write_be( buf, len, r );
+
+    return( mbedtls_mpi_read_binary( X, buf, len ) );
+}
+
+void mbedtls_bn_mont_init( mbedtls_bn_mont_context *ctx )
+{
+    memset( ctx, 0, sizeof( mbedtls_bn_mont_context ) );
+}
+
+void mbedtls_bn_mont_free( mbedtls_bn_mont_context *ctx )
+{
+    if( ctx == NULL )
+        return;
+
+    mbedtls_platform_zeroize( ctx, sizeof( mbedtls_bn_mont_context ) );
+}
+
+int mbedtls_bn_mont_setup( mbedtls_bn_mont_context *ctx,
+                           const mbedtls_mpi *N )
+{
+    unsigned char *buf = (unsigned char *) ctx->T;
+    mbedtls_mpi RR;
+    size_t bits = mbedtls_mpi_bitlen( N );
+    size_t n = ( bits + 63 ) / 64;
+    uint64_t inv;
+    int ret;
+    int i;
+
+    if( mbedtls_mpi_cmp_int( N, 1 ) <= 0 || mbedtls_mpi_get_bit( N, 0 ) == 0 ||
+        n > MBEDTLS_BN_MONT_MAX_LIMBS )
+        return( MBEDTLS_ERR_MPI_BAD_INPUT_DATA );
+
+    ctx->n = n;
+    MBEDTLS_MPI_CHK( mbedtls_mpi_write_binary( N, buf, n * 8 ) );
+    bn_mont_read_be( ctx->N, n, buf, n * 8 );
+
+    /* N^-1 mod 2^64 by Newton's iteration, each doubling the bits */
+    inv = ctx->N[0];
+    for( i = 0; i < 5; i++ )
+        inv *= 2 - ctx->N[0] * inv;
+    ctx->n0 = (uint64_t) 0 - inv;
+
+    /* R^2 mod N with libmbedtls, once per modulus */
+    mbedtls_mpi_init( &RR );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_lset( &RR, 1 ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_shift_l( &RR, 2 * 64 * n ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( &RR, &RR, N ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_write_binary( &RR, buf, n * 8 ) );
+    bn_mont_read_be( ctx->RR, n, buf, n * 8 );
+
+cleanup:
+    mbedtls_mpi_free( &RR );
+    if( ret != 0 )
+        ctx->n = 0;
+
+    return( ret );
+}
+
+int mbedtls_bn_mont_mul_mod( mbedtls_bn_mont_context *ctx,
+                             mbedtls_mpi *X,
+                             const mbedtls_mpi *A,
+                             const mbedtls_mpi *B )
+{
+    int ret;
+
+    if( ctx->n == 0 )
+        return( MBEDTLS_ERR_MPI_BAD_INPUT_DATA );
+
+    if( ( ret = bn_mont_from_mpi( ctx, ctx->A, A ) ) != 0 ||
+        ( ret = bn_mont_from_mpi( ctx, ctx->B, B ) ) != 0 )
+        return( ret );
+
+    /* A * B / R * R^2 / R */
+    bn_mont_mul( ctx, ctx->A, ctx->A, ctx->B );
+    bn_mont_mul( ctx, ctx->A, ctx->A, ctx->RR );
+
+    return( bn_mont_to_mpi( ctx, X, ctx->A ) );
+}
+
+/* Fixed window size for an exponent of ebits bits, as in bignum.c */
+static size_t bn_mont_window( size_t ebits )
+{
+    return( ebits > 671 ? 6 : ebits > 239 ? 5 :
+            ebits >  79 ? 4 : ebits >  23 ? 3 : 1 );
+}
+
+int mbedtls_bn_mont_exp_mod( mbedtls_bn_mont_context *ctx,
+                             mbedtls_mpi *X,
+                             const mbedtls_mpi *A,
+                             const mbedtls_mpi *E )
+{
+    size_t n = ctx->n;
+    size_t ebits = mbedtls_mpi_bitlen( E );
+    size_t w = bn_mont_window( ebits );
+    size_t nwin = ( ebits + w - 1 ) / w;
+    uint64_t *tab;
+    uint64_t mask;
+    size_t i, j, k, bit;
+    int ret;
+
+    if( n == 0 || mbedtls_mpi_cmp_int( E, 0 ) < 0 )
+        return( MBEDTLS_ERR_MPI_BAD_INPUT_DATA );
+
+    if( ( ret = bn_mont_from_mpi( ctx, ctx->A, A ) ) != 0 )
+        return( ret );
+
+    tab = mbedtls_calloc( (size_t) 1 << w, n * sizeof( uint64_t ) );
+    if( tab == NULL )
+        return( MBEDTLS_ERR_MPI_ALLOC_FAILED );
+
+    /* tab[i] = A^i * R mod N */
+    memset( ctx->B, 0, n * sizeof( uint64_t ) );
+    ctx->B[0] = 1;
+    bn_mont_mul( ctx, tab, ctx->RR, ctx->B );
+    bn_mont_mul( ctx, tab + n, ctx->A, ctx->RR );
+    for( i = 2; i < ( (size_t) 1 << w ); i++ )
+        bn_mont_mul( ctx, tab + i * n, tab + ( i - 1 ) * n, tab + n );
+
+    memcpy( ctx->A, tab, n * sizeof( uint64_t ) );
+
+    for( i = nwin; i > 0; i-- )
+    {
+        k = 0;
+        for( j = 0; j < w; j++ )
+        {
+            bit = ( i - 1 ) * w + ( w - 1 - j );
+            k = ( k << 1 ) | (size_t) mbedtls_mpi_get_bit( E, bit );
+        }
+
+        if( i != nwin )
+        {
+            for( j = 0; j < w; j++ )
+                bn_mont_sqr( ctx, ctx->A, ctx->A );
+        }
+
+        /* B = tab[k], reading the whole window */
+        memset( ctx->B, 0, n * sizeof( uint64_t ) );
+        for( j = 0; j < ( (size_t) 1 << w ); j++ )
+        {
+            mask = (uint64_t) 0 - ( ( (uint64_t) ( j ^ k ) - 1 ) >> 63 );
+            for( bit = 0; bit < n; bit++ )
+                ctx->B[bit] |= tab[j * n + bit] & mask;
+        }
+        bn_mont_mul( ctx, ctx->A, ctx->A, ctx->B );
+    }
+
+    /* Out of the Montgomery domain */
+    memset( ctx->B, 0, n * sizeof( uint64_t ) );
+    ctx->B[0] = 1;
+    bn_mont_mul( ctx, ctx->A, ctx->A, ctx->B );
+
+    ret = bn_mont_to_mpi( ctx, X, ctx->A );
+
+    mbedtls_platform_zeroize( tab, ( n * sizeof( uint64_t ) ) << w );
+    mbedtls_free( tab );
+
+    return( ret );
+}
+
+int mbedtls_bn_mont_rsa_public( mbedtls_bn_mont_context *ctx,
+                                const mbedtls_rsa_context *rsa,
+                                const unsigned char *input,
+                                unsigned char *output )
+{
+    unsigned char *buf = (unsigned char *) ctx->T;
+    size_t n = ctx->n;
+    size_t ebits = mbedtls_mpi_bitlen( &rsa->E );
+    size_t i;
+
+    /* ctx must be set up for the modulus of rsa */
+    if( n == 0 || rsa->len > n * sizeof( uint64_t ) || ebits < 2 ||
+        mbedtls_mpi_write_binary( &rsa->N, buf, n * sizeof( uint64_t ) ) != 0 )
+        return( MBEDTLS_ERR_RSA_BAD_INPUT_DATA );
+    bn_mont_read_be( ctx->A, n, buf, n * sizeof( uint64_t ) );
+    if( memcmp( ctx->A, ctx->N, n * sizeof( uint64_t ) ) != 0 )
+        return( MBEDTLS_ERR_RSA_BAD_INPUT_DATA );
+
+    bn_mont_read_be( ctx->A, n, input, rsa->len );
+    for( i = n; i > 0; i-- )
+    {
+        if( ctx->A[i - 1] != ctx->N[i - 1] )
+            break;
+    }
+    if( i == 0 || ctx->A[i - 1] > ctx->N[i - 1] )
+        return( MBEDTLS_ERR_RSA_BAD_INPUT_DATA );
+
+    /*
+     * The public exponent is public: square and multiply, left to right.
+     * B = input * R, A = input^E * R.
+     */
+    bn_mont_mul( ctx, ctx->B, ctx->A, ctx->RR );
+    memcpy( ctx->A, ctx->B, n * sizeof( uint64_t ) );
+    for( i = ebits - 1; i > 0; i-- )
+    {
+        bn_mont_sqr( ctx, ctx->A, ctx->A );
+        if( mbedtls_mpi_get_bit( &rsa->E, i - 1 ) )
+            bn_mont_mul( ctx, ctx->A, ctx->A, ctx->B );
+    }
+
+    memset( ctx->B, 0, n * sizeof( uint64_t ) );
+    ctx->B[0] = 1;
+    bn_mont_mul( ctx, ctx->A, ctx->A, ctx->B );
+
+    bn_mont_write_be( output, rsa->len, ctx->A );
+
+    return( 0 );
+}
+
+int mbedtls_bn_mont_rsa_pkcs1_v15_verify( mbedtls_bn_mont_context *ctx,
+                                          const mbedtls_rsa_context *rsa,
+                                          mbedtls_md_type_t md_alg,
+                                          unsigned int hashlen,
+                                          const unsigned char *hash,
+                                          const unsigned char *sig )
+{
+    const mbedtls_md_info_t *md_info;
+    const char *oid = NULL;
+    size_t oid_size = 0;
+    size_t len = rsa->len;
+    size_t nb_pad;
+    unsigned char *em, *encoded, *p;
+    int ret;
+
+    /* EMSA-PKCS1-v1_5 encoding of the hash, as rsa.c builds it */
+    nb_pad = len;
+    if( md_alg != MBEDTLS_MD_NONE )
+    {
+        md_info = mbedtls_md_info_from_type( md_alg );
+        if( md_info == NULL ||
+            mbedtls_oid_get_oid_by_md( md_alg, &oid, &oid_size ) != 0 )
+            return( MBEDTLS_ERR_RSA_BAD_INPUT_DATA );
+        hashlen = mbedtls_md_get_size( md_info );
+
+        /* Short-form ASN.1 lengths only */
+        if( 8 + hashlen + oid_size >= 0x80 ||
+            nb_pad < 10 + hashlen + oid_size )
+            return( MBEDTLS_ERR_RSA_BAD_INPUT_DATA );
+        nb_pad -= 10 + hashlen + oid_size;
+    }
+    else
+    {
+        if( nb_pad < hashlen )
+            return( MBEDTLS_ERR_RSA_BAD_INPUT_DATA );
+        nb_pad -= hashlen;
+    }
+
+    /* 0x00 0x01 PS 0x00 with at least 8 Bytes of PS */
+    if( nb_pad < 3 + 8 )
+        return( MBEDTLS_ERR_RSA_BAD_INPUT_DATA );
+    nb_pad -= 3;
+
+    em = mbedtls_calloc( 2, len );
+    if( em == NULL )
+        return( MBEDTLS_ERR_MPI_ALLOC_FAILED );
+    encoded = em + len;
+
+    p = em;
+    *p++ = 0;
+    *p++ = MBEDTLS_RSA_SIGN;
+    memset( p, 0xFF, nb_pad );
+    p += nb_pad;
+    *p++ = 0;
+    if( md_alg != MBEDTLS_MD_NONE )
+    {
+        *p++ = MBEDTLS_ASN1_SEQUENCE | MBEDTLS_ASN1_CONSTRUCTED;
+        *p++ = (unsigned char) ( 0x08 + oid_size + hashlen );
+        *p++ = MBEDTLS_ASN1_SEQUENCE | MBEDTLS_ASN1_CONSTRUCTED;
+        *p++ = (unsigned char) ( 0x04 + oid_size );
+        *p++ = MBEDTLS_ASN1_OID;
+        *p++ = (unsigned char) oid_size;
+        memcpy( p, oid, oid_size );
+        p += oid_size;
+        *p++ = MBEDTLS_ASN1_NULL;
+        *p++ = 0x00;
+        *p++ = MBEDTLS_ASN1_OCTET_STRING;
+        *p++ = (unsigned char) hashlen;
+    }
+    memcpy( p, hash, hashlen );
+
+    ret = mbedtls_bn_mont_rsa_public( ctx, rsa, sig, encoded );
+    if( ret == 0 && memcmp( em, encoded, len ) != 0 )
+        ret = MBEDTLS_ERR_RSA_VERIFY_FAILED;
+
+    mbedtls_free( em );
+
+    return( ret );
+}
+
+#if defined(MBEDTLS_SELF_TEST)
+/*
+ * RSA-4096 public key and PKCS#1 v1.5 signature of the SHA-256 of "abc"
+ */
+#define BN_MONT_TEST_N  \
+    "B68EA516CA84BBC3A5A73B4467726929ECD3B3B1DDA6D33D51F6C2960E1D2475"  \
+    "77F2B61841DCEEFDAACB498DCBD097A7BA3E44193C54AFEB8D57EB895E708945"  \
+    "C0316C2A967E22D73EC1D1F3FBFB2BD63B7D93FF5B84618CAA19F9FE622CD9D0"  \
+    "E4EA752E3D0567DEAA4844F6A07305B3063BBD1FFA0167F31F661E80443351D0"  \
+    "1E6E54F4BD81C91FF25F2A9B0667D6CF2BDEB49240CB5854C4F2765F1883D5B2"  \
+    "81BAED6083BC5FEBD9EE94A385944F69AB4808523F5B8380A73CA3A92E6DD52C"  \
+    "09574308B78868B0507BE414C9A986772DB8E2621E8E0024012CB8AA9B638D2E"  \
+    "A8A0661B9D9571CF8838F9AB996057CCBBDCAF111714832BDE618500463EF779"  \
+    "A0BEA93FD9769C78B9C2134CB5C1FEDB007ACB8DA8FA7BCD808A7703D879F5F8"  \
+    "C0E0DD71F78D6C80936D16D671EF227C6A11EADC760938FE24CA56439120973E"  \
+    "337EE018FA2C5BD53EDB30E08CCF7A496B04F25545FDDF4C3DB3AB7EF335AF2B"  \
+    "40E2BC054C49F60C0126F809FB845B1198EE7365576801A3CABFECC8E42F3172"  \
+    "1E61B21A8D60F14663E57DDDDD2C68E88C3F7BCA174E157539A5AC83D90A7077"  \
+    "F7FA1D162D54B06462AD4C53BE533E1C89902639233DBDF23EBFCFE6F08C7D56"  \
+    "01200705CDE4F56A6BC49D0977C7EFA1EC9FBD9B46B7564902CB0D2D6E7AA126"  \
+    "71B3D22E190DBE3F955CD103C5E75261BE521D3AEFD44E5E6FCD78A130124A81"
+
+#define BN_MONT_TEST_E  "10001"
+
+#define BN_MONT_TEST_SIG  \
+    "090B372772E8419ADC27DF0CB493E1FCF1B370FD6BDDE1F72CDB63F0FB7729F9"  \
+    "A927BCF651FB63B4B31D74C311E0A2550222C15D7A4B0AAF9F0D084512FA2AA2"  \
+    "B24BB9EA19503214C5F3C819E352341FF3ADA231639F5CB58B97CD93B9881317"  \
+    "4745EF0DB95059A687576695CF37B74A76046A7395B706C4DAC1F34E674C5A02"  \
+    "4D3FCD267FB8761D749261E78901287BDBD35B7AA4B8FA2DDC36D57A6EAB7B73"  \
+    "7AEA1489D0324F3DAB9EF70B0B7712E3ABE2786F6AA3A02461A34E96B587C598"  \
+    "0F51F8330CBDAF64FFEA2696C96A9471BC563BF8A2263222D70D13097A863FA4"  \
+    "5B9D5ABAC3276030EA8D4414A6A394AC6EFED6B49B691E04598AAA30074768A8"  \
+    "217371D0AB493A740C67B19175DF3C5A1BA9EFEA21DD362DECEFABF48A3212F3"  \
+    "B114A3A8E413CC80CE43AA1496AB7BFD3C95F875B3CC3E4A108F4C350D3655C9"  \
+    "B924F529341C15BF602D7CA871C03CE83FD42FEC7A8AADC03393C6868F12AF57"  \
+    "B1BD87E42E496A88BD9E6EB317FCD5885AA2752774D2C07E74F26A44AD03B833"  \
+    "97A485F48392BA492CC4E3337C67823662AAAA52C08162792C8C74A4A6CE5E15"  \
+    "4DB6DFD14A239E2713DB9B050CAFC17177685E248FB09DF2CE3C3A38872F92D3"  \
+    "3CF3DDD999A9B504A0D92C2E3A79B5C9313D450FDC98751B08301745257523FF"  \
+    "B1E74EDCCAE01B6AD92CD7CD01BFBCF6787283D5768BF375736BB43F1703CD79"
+
+static const unsigned char bn_mont_test_hash[32] =
+{
+    0xBA, 0x78, 0x16, 0xBF, 0x8F, 0x01, 0xCF, 0xEA,
+    0x41, 0x41, 0x40, 0xDE, 0x5D, 0xAE, 0x22, 0x23,
+    0xB0, 0x03, 0x61, 0xA3, 0x96, 0x17, 0x7A, 0x9C,
+    0xB4, 0x10, 0xFF, 0x61, 0xF2, 0x00, 0x15, 0xAD,
+};
+
+/* Moduli sizes in limbs, covering the unrolled loop and its tail */
+static const size_t bn_mont_test_limbs[] = { 1, 3, 4, 5, 17, 64 };
+
+/* A pseudo-random number of the given Bytes, from a xorshift64 state */
+static int bn_mont_test_rand( mbedtls_mpi *X, size_t len, uint64_t *state,
+                              unsigned char *buf )
+{
+    size_t i;
+
+    for( i = 0; i < len; i++ )
+    {
+        *state ^= *state << 13;
+        *state ^= *state >> 7;
+        *state ^= *state << 17;
+        buf[i] = (unsigned char) *state;
+    }
+
+    return( mbedtls_mpi_read_binary( X, buf, len ) );
+}
+
+/*
+ * Checks the arithmetic against the bignum of libmbedtls, then verifies an
+ * RSA-4096 signature
+ */
+int mbedtls_bn_mont_self_test( int verbose )
+{
+    mbedtls_bn_mont_context *ctx;
+    mbedtls_rsa_context rsa;
+    mbedtls_mpi N, A, B, E, X, Y;
+    unsigned char *buf;
+    unsigned char hash[32];
+    uint64_t state = 0x2545F4914F6CDD1DULL;
+    size_t i, len;
+    int ret = 1;
+
+    mbedtls_mpi_init( &N );
+    mbedtls_mpi_init( &A );
+    mbedtls_mpi_init( &B );
+    mbedtls_mpi_init( &E );
+    mbedtls_mpi_init( &X );
+    mbedtls_mpi_init( &Y );
+
+    /* Only the public key fields are used */
+    memset( &rsa, 0, sizeof( rsa ) );
+    mbedtls_mpi_init( &rsa.N );
+    mbedtls_mpi_init( &rsa.E );
+
+    ctx = mbedtls_calloc( 1, sizeof( mbedtls_bn_mont_context ) );
+    buf = mbedtls_calloc( 1, 8 * MBEDTLS_BN_MONT_MAX_LIMBS );
+    if( ctx == NULL || buf == NULL )
+        goto exit;
+    mbedtls_bn_mont_init( ctx );
+
+    for( i = 0; i < sizeof( bn_mont_test_limbs ) / sizeof( size_t ); i++ )
+    {
+        len = 8 * bn_mont_test_limbs[i];
+
+        if( verbose != 0 )
+            mbedtls_printf( "  BN-MONT %4u-bit test: ",
+                            (unsigned int) ( 8 * len ) );
+
+        /* An odd modulus of len Bytes, A and B below it */
+        if( bn_mont_test_rand( &N, len, &state, buf ) != 0 ||
+            mbedtls_mpi_set_bit( &N, 8 * len - 1, 1 ) != 0 ||
+            mbedtls_mpi_set_bit( &N, 0, 1 ) != 0 ||
+            bn_mont_test_rand( &A, len, &state, buf ) != 0 ||
+            mbedtls_mpi_mod_mpi( &A, &A, &N ) != 0 ||
+            bn_mont_test_rand( &B, len, &state, buf ) != 0 ||
+            mbedtls_mpi_mod_mpi( &B, &B, &N ) != 0 ||
+            bn_mont_test_rand( &E, len < 40 ? len : 40, &state, buf ) != 0 )
+            goto fail;
+
+        if( mbedtls_bn_mont_setup( ctx, &N ) != 0 ||
+            mbedtls_bn_mont_mul_mod( ctx, &X, &A, &B ) != 0 ||
+            mbedtls_mpi_mul_mpi( &Y, &A, &B ) != 0 ||
+            mbedtls_mpi_mod_mpi( &Y, &Y, &N ) != 0 ||
+            mbedtls_mpi_cmp_mpi( &X, &Y ) != 0 )
+            goto fail;
+
+        if( mbedtls_bn_mont_exp_mod( ctx, &X, &A, &E ) != 0 ||
+            mbedtls_mpi_exp_mod( &Y, &A, &E, &N, NULL ) != 0 ||
+            mbedtls_mpi_cmp_mpi( &X, &Y ) != 0 )
+            goto fail;
+
+        /* Operands out of range */
+        if( mbedtls_bn_mont_mul_mod( ctx, &X, &N, &B ) !=
+            MBEDTLS_ERR_MPI_BAD_INPUT_DATA )
+            goto fail;
+
+        if( verbose != 0 )
+            mbedtls_printf( "passed\n" );
+    }
+
+    if( verbose != 0 )
+        mbedtls_printf( "  BN-MONT RSA-4096 PKCS#1 v1.5 verify: " );
+
+    if( mbedtls_mpi_read_string( &rsa.N, 16, BN_MONT_TEST_N ) != 0 ||
+        mbedtls_mpi_read_string( &rsa.E, 16, BN_MONT_TEST_E ) != 0 ||
+        mbedtls_mpi_read_string( &X, 16, BN_MONT_TEST_SIG ) != 0 )
+        goto fail;
+    rsa.len = mbedtls_mpi_size( &rsa.N );
+    if( mbedtls_mpi_write_binary( &X, buf, rsa.len ) != 0 ||
+        mbedtls_bn_mont_setup( ctx, &rsa.N ) != 0 )
+        goto fail;
+
+    memcpy( hash, bn_mont_test_hash, sizeof( hash ) );
+    if( mbedtls_bn_mont_rsa_pkcs1_v15_verify( ctx, &rsa, MBEDTLS_MD_SHA256,
+                                              0, hash, buf ) != 0 )
+        goto fail;
+
+    hash[31] ^= 0x01;
+    if( mbedtls_bn_mont_rsa_pkcs1_v15_verify( ctx, &rsa, MBEDTLS_MD_SHA256,
+                                              0, hash, buf ) !=
+        MBEDTLS_ERR_RSA_VERIFY_FAILED )
+        goto fail;
+
+    if( verbose != 0 )
+        mbedtls_printf( "passed\n\n" );
+
+    ret = 0;
+    goto exit;
+
+fail:
+    if( verbose != 0 )
+        mbedtls_printf( "failed\n" );
+
+exit:
+    mbedtls_bn_mont_free( ctx );
+    mbedtls_free( ctx );
+    mbedtls_free( buf );
+    mbedtls_mpi_free( &rsa.N );
+    mbedtls_mpi_free( &rsa.E );
+    mbedtls_mpi_free( &N );
+    mbedtls_mpi_free( &A );
+    mbedtls_mpi_free( &B );
+    mbedtls_mpi_free( &E );
+    mbedtls_mpi_free( &X );
+    mbedtls_mpi_free( &Y );
+    return( ret );
+}
+
+#endif /* MBEDTLS_SELF_TEST */
+
+#endif /* MBEDTLS_BN_MONT_C */
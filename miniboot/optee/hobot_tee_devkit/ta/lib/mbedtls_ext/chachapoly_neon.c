@@ -0,0 +1,1223 @@
+/*
+ *  ChaCha20, Poly1305 and ChaCha20-Poly1305 with NEON
+ *
+ *  Copyright (c) 2026, D-Robotics
+ *  SPDX-License-Identifier: BSD-2-Clause
+ */
+/*
+ *  RFC 8439 ChaCha20 and Poly1305 for IETF Protocols
+ *
+ *  ChaCha20 computes four blocks at a time: word i of block j is lane j of
+ *  register i. The 4x4 groups of words are transposed before they are
+ *  XORed with the data. A tail of two or three blocks is taken from four
+ *  blocks of key stream, a single block from the portable code.
+ *
+ *  Poly1305 keeps h and r in five 26-bit limbs, as poly1305-donna does.
+ *  Full blocks are taken four at a time by four accumulators in the lanes
+ *  of two sets of registers: accumulator j takes blocks j, j + 4, j + 8...
+ *  and is multiplied by r^4 between them. When the accumulators are
+ *  closed, they are multiplied by r^4, r^3, r^2 and r and added up. They
+ *  stay open across updates that are multiples of 64 Bytes, which is what
+ *  the AEAD feeds them.
+ *
+ *  The AEAD goes through the data in chunks of CHACHAPOLY_NEON_CHUNK
+ *  Bytes: it encrypts a chunk then hashes the ciphertext, or hashes a
+ *  chunk of ciphertext then decrypts it, while the chunk is in the L1
+ *  data cache.
+ */
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#if defined(MBEDTLS_CHACHAPOLY_NEON_C)
+
+#include "mbedtls/chachapoly_neon.h"
+#include "mbedtls/platform_util.h"
+
+#include <string.h>
+
+#if defined(MBEDTLS_SELF_TEST)
+#if defined(MBEDTLS_PLATFORM_C)
+#include "mbedtls/platform.h"
+#else
+#include <stdio.h>
+#include <stdlib.h>
+#define mbedtls_printf printf
+#define mbedtls_calloc calloc
+#define mbedtls_free   free
+#endif /* MBEDTLS_PLATFORM_C */
+#endif /* MBEDTLS_SELF_TEST */
+
+#if defined(__aarch64__) && defined(CFG_TA_FLOAT_SUPPORT)
+#define CHACHAPOLY_NEON
+#include <arm_neon.h>
+#endif
+
+/* Bytes encrypted and hashed in turn by the AEAD, a multiple of 256 */
+#define CHACHAPOLY_NEON_CHUNK   1024
+
+/*
+ * 32-bit integer manipulation macros (little endian)
+ */
+#ifndef GET_UINT32_LE
+#define GET_UINT32_LE(n,b,i)                            \
+do {                                                    \
+    (n) = ( (uint32_t) (b)[(i)    ]       )             \
+        | ( (uint32_t) (b)[(i) + 1] <<  8 )             \
+        | ( (uint32_t) (b)[(i) + 2] << 16 )             \
+        | ( (uint32_t) (b)[(i) + 3] << 24 );            \
+} while( 0 )
+#endif
+
+#ifndef PUT_UINT32_LE
+#define PUT_UINT32_LE(n,b,i)                                    \
+do {                                                            \
+    (b)[(i)    ] = (unsigned char) ( ( (n)       ) & 0xFF );    \
+    (b)[(i) + 1] = (unsigned char) ( ( (n) >>  8 ) & 0xFF );    \
+    (b)[(i) + 2] = (unsigned char) ( ( (n) >> 16 ) & 0xFF );    \
+    (b)[(i) + 3] = (unsigned char) ( ( (n) >> 24 ) & 0xFF );    \
+} while( 0 )
+#endif
+
+int mbedtls_chachapoly_neon_has_support( void )
+{
+#if defined(CHACHAPOLY_NEON)
+    return( 1 );
+#else
+    return( 0 );
+#endif
+}
+
+/*
+ * ChaCha20
+ */
+#define ROTL32( v, c )  ( ( (v) << (c) ) | ( (v) >> ( 32 - (c) ) ) )
+
+#define QR( a, b, c, d )                                    \
+do {                                                        \
+    (a) += (b); (d) ^= (a); (d) = ROTL32( (d), 16 );        \
+    (c) += (d); (b) ^= (c); (b) = ROTL32( (b), 12 );        \
+    (a) += (b); (d) ^= (a); (d) = ROTL32( (d),  8 );        \
+    (c) += (d); (b) ^= (c); (b) = ROTL32( (b),  7 );        \
+} while( 0 )
+
+static void chacha20_setup( uint32_t state[16], const uint32_t key[8],
+                            const unsigned char nonce[12], uint32_t counter )
+{
+    /* "expand 32-byte k" */
+    state[0] = 0x61707865;
+    state[1] = 0x3320646e;
+    state[2] = 0x79622d32;
+    state[3] = 0x6b206574;
+    memcpy( state + 4, key, 32 );
+    state[12] = counter;
+    GET_UINT32_LE( state[13], nonce, 0 );
+    GET_UINT32_LE( state[14], nonce, 4 );
+    GET_UINT32_LE( state[15], nonce, 8 );
+}
+
+/* One block of key stream, the counter is incremented */
+static void chacha20_block( uint32_t state[16], unsigned char ks[64] )
+{
+    uint32_t x[16];
+    size_t i;
+
+    memcpy( x, state, sizeof( x ) );
+
+    for( i = 0; i < 10; i++ )
+    {
+        QR( x[0], x[4], x[ 8], x[12] );
+        QR( x[1], x[5], x[ 9], x[13] );
+        QR( x[2], x[6], x[10], x[14] );
+        QR( x[3], x[7], x[11], x[15] );
+        QR( x[0], x[5], x[10], x[15] );
+        QR( x[1], x[6], x[11], x[12] );
+        QR( x[2], x[7], x[ 8], x[13] );
+        QR( x[3], x[4], x[ 9], x[14] );
+    }
+
+    for( i = 0; i < 16; i++ )
+    {
+        x[i] += state[i];
+        PUT_UINT32_LE( x[i], ks, 4 * i );
+    }
+
+    state[12]++;
+    mbedtls_platform_zeroize( x, sizeof( x ) );
+}
+
+#if defined(CHACHAPOLY_NEON)
+static inline uint32x4_t chacha20_rotl16( uint32x4_t x )
+{
+    return( vreinterpretq_u32_u16(
+                vrev32q_u16( vreinterpretq_u16_u32( x ) ) ) );
+}
+
+static inline uint32x4_t chacha20_rotl8( uint32x4_t x, uint8x16_t tbl )
+{
+    return( vreinterpretq_u32_u8(
+                vqtbl1q_u8( vreinterpretq_u8_u32( x ), tbl ) ) );
+}
+
+#define QR4( a, b, c, d )                                                   \
+do {                                                                        \
+    (a) = vaddq_u32( (a), (b) ); (d) = veorq_u32( (d), (a) );               \
+    (d) = chacha20_rotl16( (d) );                                           \
+    (c) = vaddq_u32( (c), (d) ); (b) = veorq_u32( (b), (c) );               \
+    (b) = vsriq_n_u32( vshlq_n_u32( (b), 12 ), (b), 20 );                   \
+    (a) = vaddq_u32( (a), (b) ); (d) = veorq_u32( (d), (a) );               \
+    (d) = chacha20_rotl8( (d), rot8 );                                      \
+    (c) = vaddq_u32( (c), (d) ); (b) = veorq_u32( (b), (c) );               \
+    (b) = vsriq_n_u32( vshlq_n_u32( (b), 7 ), (b), 25 );                    \
+} while( 0 )
+
+/* Four blocks of 64 Bytes, the counter is incremented by 4 */
+static void chacha20_neon_4blocks( uint32_t state[16],
+                                   const unsigned char *input,
+                                   unsigned char *output )
+{
+    static const uint8_t rot8_tbl[16] =
+    {
+        3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14
+    };
+    static const uint32_t ctr_inc[4] = { 0, 1, 2, 3 };
+    const uint8x16_t rot8 = vld1q_u8( rot8_tbl );
+    uint32x4_t x[16];
+    uint32x4_t ctr;
+    uint32x4_t t0, t1, t2, t3;
+    uint8x16_t m;
+    size_t i;
+
+    for( i = 0; i < 16; i++ )
+        x[i] = vdupq_n_u32( state[i] );
+    ctr = vaddq_u32( x[12], vld1q_u32( ctr_inc ) );
+    x[12] = ctr;
+
+    for( i = 0; i < 10; i++ )
+    {
+        QR4( x[0], x[4], x[ 8], x[12] );
+        QR4( x[1], x[5], x[ 9], x[13] );
+        QR4( x[2], x[6], x[10], x[14] );
+        QR4( x[3], x[7], x[11], x[15] );
+        QR4( x[0], x[5], x[10], x[15] );
+        QR4( x[1], x[6], x[11], x[12] );
+        QR4( x[2], x[7], x[ 8], x[13] );
+        QR4( x[3], x[4], x[ 9], x[14] );
+    }
+
+    for( i = 0; i < 16; i++ )
+    {
+        if( i == 12 )
+            x[i] = vaddq_u32( x[i], ctr );
+        else
+            x[i] = vaddq_u32( x[i], vdupq_n_u32( state[i] ) );
+    }
+
+    /* Words 4i to 4i + 3 of the four blocks, block j at 64 j + 16 i */
+    for( i = 0; i < 4; i++ )
+    {
+        t0 = vtrn1q_u32( x[4 * i    ], x[4 * i + 1] );
+        t1 = vtrn2q_u32( x[4 * i    ], x[4 * i + 1] );
+        t2 = vtrn1q_u32( x[4 * i + 2], x[4 * i + 3] );
+        t3 = vtrn2q_u32( x[4 * i + 2], x[4 * i + 3] );
+
+        m = vreinterpretq_u8_u64( vtrn1q_u64( vreinterpretq_u64_u32( t0 ),
+                                              vreinterpretq_u64_u32( t2 ) ) );
+        vst1q_u8( output + 16 * i,
+                  veorq_u8( vld1q_u8( input + 16 * i ), m ) );
+        m = vreinterpretq_u8_u64( vtrn1q_u64( vreinterpretq_u64_u32( t1 ),
+                                              vreinterpretq_u64_u32( t3 ) ) );
+        vst1q_u8( output + 64 + 16 * i,
+                  veorq_u8( vld1q_u8( input + 64 + 16 * i ), m ) );
+        m = vreinterpretq_u8_u64( vtrn2q_u64( vreinterpretq_u64_u32( t0 ),
+                                              vreinterpretq_u64_u32( t2 ) ) );
+        vst1q_u8( output + 128 + 16 * i,
+                  veorq_u8( vld1q_u8( input + 128 + 16 * i ), m ) );
+        m = vreinterpretq_u8_u64( vtrn2q_u64( vreinterpretq_u64_u32( t1 ),
+                                              vreinterpretq_u64_u32( t3 ) ) );
+        vst1q_u8( output + 192 + 16 * i,
+                  veorq_u8( vld1q_u8( input + 192 + 16 * i ), m ) );
+    }
+
+    state[12] += 4;
+}
+#endif /* CHACHAPOLY_NEON */
+
+static void chacha20_xor( uint32_t state[16], const unsigned char *input,
+                          unsigned char *output, size_t len )
+{
+    unsigned char ks[64];
+    size_t i;
+
+#if defined(CHACHAPOLY_NEON)
+    unsigned char buf[256];
+
+    for( ; len >= 256; len -= 256, input += 256, output += 256 )
+        chacha20_neon_4blocks( state, input, output );
+
+    if( len > 64 )
+    {
+        memcpy( buf, input, len );
+        chacha20_neon_4blocks( state, buf, buf );
+        memcpy( output, buf, len );
+        mbedtls_platform_zeroize( buf, sizeof( buf ) );
+        /* The counter goes past the blocks used, as in the portable code */
+        state[12] -= 4 - (uint32_t) ( ( len + 63 ) / 64 );
+        return;
+    }
+#endif /* CHACHAPOLY_NEON */
+
+    for( ; len > 0; len -= i, input += i, output += i )
+    {
+        chacha20_block( state, ks );
+        for( i = 0; i < 64 && i < len; i++ )
+            output[i] = input[i] ^ ks[i];
+    }
+
+    mbedtls_platform_zeroize( ks, sizeof( ks ) );
+}
+
+int mbedtls_chacha20_neon_crypt( const unsigned char key[32],
+                                 const unsigned char nonce[12],
+                                 uint32_t counter,
+                                 size_t size,
+                                 const unsigned char *input,
+                                 unsigned char *output )
+{
+    uint32_t k[8];
+    uint32_t state[16];
+    size_t i;
+
+    for( i = 0; i < 8; i++ )
+        GET_UINT32_LE( k[i], key, 4 * i );
+
+    chacha20_setup( state, k, nonce, counter );
+    chacha20_xor( state, input, output, size );
+
+    mbedtls_platform_zeroize( k, sizeof( k ) );
+    mbedtls_platform_zeroize( state, sizeof( state ) );
+    return( 0 );
+}
+
+/*
+ * Poly1305
+ */
+#define POLY_MASK26     0x3FFFFFF
+
+typedef struct
+{
+    uint32_t r[5];              /* r, clamped */
+    uint32_t h[5];              /* The accumulator, when closed */
+    uint32_t pad[4];            /* s */
+#if defined(CHACHAPOLY_NEON)
+    int powers;                 /* rv and friends are set */
+    int open;                   /* hv holds the accumulators */
+    uint32_t rv[5][2];          /* r^4 in both lanes */
+    uint32_t sv[5][2];          /* 5 r^4 */
+    uint32_t rx[5][2];          /* r^4, r^3 */
+    uint32_t sx[5][2];
+    uint32_t ry[5][2];          /* r^2, r */
+    uint32_t sy[5][2];
+    uint32_t hv[5][4];          /* Limb i of the four accumulators */
+#endif
+}
+poly1305_state;
+
+/* h = h * r mod 2^130 - 5, partially reduced */
+static void poly1305_mul( uint32_t h[5], const uint32_t r[5] )
+{
+    uint32_t s1 = r[1] * 5, s2 = r[2] * 5, s3 = r[3] * 5, s4 = r[4] * 5;
+    uint64_t d0, d1, d2, d3, d4, c;
+
+    d0 = (uint64_t) h[0] * r[0] + (uint64_t) h[1] * s4 +
+         (uint64_t) h[2] * s3 + (uint64_t) h[3] * s2 +
+         (uint64_t) h[4] * s1;
+    d1 = (uint64_t) h[0] * r[1] + (uint64_t) h[1] * r[0] +
+         (uint64_t) h[2] * s4 + (uint64_t) h[3] * s3 +
+         (uint64_t) h[4] * s2;
+    d2 = (uint64_t) h[0] * r[2] + (uint64_t) h[1] * r[1] +
+         (uint64_t) h[2] * r[0] + (uint64_t) h[3] * s4 +
+         (uint64_t) h[4] * s3;
+    d3 = (uint64_t) h[0] * r[3] + (uint64_t) h[1] * r[2] +
+         (uint64_t) h[2] * r[1] + (uint64_t) h[3] * r[0] +
+         (uint64_t) h[4] * s4;
+    d4 = (uint64_t) h[0] * r[4] + (uint64_t) h[1] * r[3] +
+         (uint64_t) h[2] * r[2] + (uint64_t) h[3] * r[1] +
+         (uint64_t) h[4] * r[0];
+
+    c = d0 >> 26; d0 &= POLY_MASK26;
+    d1 += c; c = d1 >> 26; d1 &= POLY_MASK26;
+    d2 += c; c = d2 >> 26; d2 &= POLY_MASK26;
+    d3 += c; c = d3 >> 26; d3 &= POLY_MASK26;
+    d4 += c; c = d4 >> 26; d4 &= POLY_MASK26;
+    d0 += c * 5; c = d0 >> 26; d0 &= POLY_MASK26;
+    d1 += c;
+
+    h[0] = (uint32_t) d0;
+    h[1] = (uint32_t) d1;
+    h[2] = (uint32_t) d2;
+    h[3] = (uint32_t) d3;
+    h[4] = (uint32_t) d4;
+}
+
+static void poly1305_starts( poly1305_state *st, const unsigned char key[32] )
+{
+    uint32_t t;
+    size_t i;
+
+    memset( st, 0, sizeof( *st ) );
+
+    GET_UINT32_LE( t, key,  0 ); st->r[0] = t & 0x3FFFFFF;
+    GET_UINT32_LE( t, key,  3 ); st->r[1] = ( t >> 2 ) & 0x3FFFF03;
+    GET_UINT32_LE( t, key,  6 ); st->r[2] = ( t >> 4 ) & 0x3FFC0FF;
+    GET_UINT32_LE( t, key,  9 ); st->r[3] = ( t >> 6 ) & 0x3F03FFF;
+    GET_UINT32_LE( t, key, 12 ); st->r[4] = ( t >> 8 ) & 0x00FFFFF;
+
+    for( i = 0; i < 4; i++ )
+        GET_UINT32_LE( st->pad[i], key, 16 + 4 * i );
+}
+
+/* Blocks of 16 Bytes, with the 2^128 bit when hibit is 1 << 24 */
+static void poly1305_blocks_c( poly1305_state *st, const unsigned char *in,
+                               size_t nblocks, uint32_t hibit )
+{
+    uint32_t t;
+
+    for( ; nblocks > 0; nblocks--, in += 16 )
+    {
+        GET_UINT32_LE( t, in,  0 ); st->h[0] += t & POLY_MASK26;
+        GET_UINT32_LE( t, in,  3 ); st->h[1] += ( t >> 2 ) & POLY_MASK26;
+        GET_UINT32_LE( t, in,  6 ); st->h[2] += ( t >> 4 ) & POLY_MASK26;
+        GET_UINT32_LE( t, in,  9 ); st->h[3] += ( t >> 6 ) & POLY_MASK26;
+        GET_UINT32_LE( t, in, 12 ); st->h[4] += ( t >> 8 ) | hibit;
+        poly1305_mul( st->h, st->r );
+    }
+}
+
+#if defined(CHACHAPOLY_NEON)
+/* Blocks to hash before the four accumulators are worth setting up */
+#define POLY_NEON_MIN_BLOCKS    8
+
+static void poly1305_neon_powers( poly1305_state *st )
+{
+    uint32_t p[5][5];           /* r, r^2, r^3, r^4 in p[1] to p[4] */
+    size_t i;
+
+    memcpy( p[1], st->r, sizeof( p[1] ) );
+    for( i = 2; i <= 4; i++ )
+    {
+        memcpy( p[i], p[i - 1], sizeof( p[i] ) );
+        poly1305_mul( p[i], st->r );
+    }
+
+    for( i = 0; i < 5; i++ )
+    {
+        st->rv[i][0] = st->rv[i][1] = p[4][i];
+        st->rx[i][0] = p[4][i];
+        st->rx[i][1] = p[3][i];
+        st->ry[i][0] = p[2][i];
+        st->ry[i][1] = p[1][i];
+        st->sv[i][0] = st->rv[i][0] * 5;
+        st->sv[i][1] = st->rv[i][1] * 5;
+        st->sx[i][0] = st->rx[i][0] * 5;
+        st->sx[i][1] = st->rx[i][1] * 5;
+        st->sy[i][0] = st->ry[i][0] * 5;
+        st->sy[i][1] = st->ry[i][1] * 5;
+    }
+
+    st->powers = 1;
+    mbedtls_platform_zeroize( p, sizeof( p ) );
+}
+
+/* h = h * r for two lanes, partially reduced */
+#define POLY_MUL2( h, r, s )                                                \
+do {                                                                        \
+    uint64x2_t d0, d1, d2, d3, d4, c;                                       \
+    d0 = vmull_u32( (h)[0], (r)[0] );                                       \
+    d0 = vmlal_u32( d0, (h)[1], (s)[4] );                                   \
+    d0 = vmlal_u32( d0, (h)[2], (s)[3] );                                   \
+    d0 = vmlal_u32( d0, (h)[3], (s)[2] );                                   \
+    d0 = vmlal_u32( d0, (h)[4], (s)[1] );                                   \
+    d1 = vmull_u32( (h)[0], (r)[1] );                                       \
+    d1 = vmlal_u32( d1, (h)[1], (r)[0] );                                   \
+    d1 = vmlal_u32( d1, (h)[2], (s)[4] );                                   \
+    d1 = vmlal_u32( d1, (h)[3], (s)[3] );                                   \
+    d1 = vmlal_u32( d1, (h)[4], (s)[2] );                                   \
+    d2 = vmull_u32( (h)[0], (r)[2] );                                       \
+    d2 = vmlal_u32( d2, (h)[1], (r)[1] );                                   \
+    d2 = vmlal_u32( d2, (h)[2], (r)[0] );                                   \
+    d2 = vmlal_u32( d2, (h)[3], (s)[4] );                                   \
+    d2 = vmlal_u32( d2, (h)[4], (s)[3] );                                   \
+    d3 = vmull_u32( (h)[0], (r)[3] );                                       \
+    d3 = vmlal_u32( d3, (h)[1], (r)[2] );                                   \
+    d3 = vmlal_u32( d3, (h)[2], (r)[1] );                                   \
+    d3 = vmlal_u32( d3, (h)[3], (r)[0] );                                   \
+    d3 = vmlal_u32( d3, (h)[4], (s)[4] );                                   \
+    d4 = vmull_u32( (h)[0], (r)[4] );                                       \
+    d4 = vmlal_u32( d4, (h)[1], (r)[3] );                                   \
+    d4 = vmlal_u32( d4, (h)[2], (r)[2] );                                   \
+    d4 = vmlal_u32( d4, (h)[3], (r)[1] );                                   \
+    d4 = vmlal_u32( d4, (h)[4], (r)[0] );                                   \
+    c = vshrq_n_u64( d0, 26 ); d0 = vandq_u64( d0, mask );                  \
+    d1 = vaddq_u64( d1, c );                                                \
+    c = vshrq_n_u64( d1, 26 ); d1 = vandq_u64( d1, mask );                  \
+    d2 = vaddq_u64( d2, c );                                                \
+    c = vshrq_n_u64( d2, 26 ); d2 = vandq_u64( d2, mask );                  \
+    d3 = vaddq_u64( d3, c );                                                \
+    c = vshrq_n_u64( d3, 26 ); d3 = vandq_u64( d3, mask );                  \
+    d4 = vaddq_u64( d4, c );                                                \
+    c = vshrq_n_u64( d4, 26 ); d4 = vandq_u64( d4, mask );                  \
+    d0 = vaddq_u64( d0, vaddq_u64( c, vshlq_n_u64( c, 2 ) ) );              \
+    c = vshrq_n_u64( d0, 26 ); d0 = vandq_u64( d0, mask );                  \
+    d1 = vaddq_u64( d1, c );                                                \
+    (h)[0] = vmovn_u64( d0 );                                               \
+    (h)[1] = vmovn_u64( d1 );                                               \
+    (h)[2] = vmovn_u64( d2 );                                               \
+    (h)[3] = vmovn_u64( d3 );                                               \
+    (h)[4] = vmovn_u64( d4 );                                               \
+} while( 0 )
+
+/* The limbs of two consecutive blocks, one per lane */
+#define POLY_LOAD2( m, in )                                                 \
+do {                                                                        \
+    uint64x2x2_t t = vld2q_u64( (const uint64_t *) (in) );                  \
+    (m)[0] = vmovn_u64( vandq_u64( t.val[0], mask ) );                      \
+    (m)[1] = vmovn_u64( vandq_u64( vshrq_n_u64( t.val[0], 26 ), mask ) );   \
+    (m)[2] = vmovn_u64( vandq_u64( vsriq_n_u64(                             \
+                vshlq_n_u64( t.val[1], 12 ), t.val[0], 52 ), mask ) );      \
+    (m)[3] = vmovn_u64( vandq_u64( vshrq_n_u64( t.val[1], 14 ), mask ) );   \
+    (m)[4] = vorr_u32( vmovn_u64( vshrq_n_u64( t.val[1], 40 ) ), hibit );   \
+} while( 0 )
+
+/* Hashes 4 * ngroups full blocks into the four accumulators */
+static void poly1305_neon_blocks( poly1305_state *st, const unsigned char *in,
+                                  size_t ngroups )
+{
+    const uint64x2_t mask = vdupq_n_u64( POLY_MASK26 );
+    const uint32x2_t hibit = vdup_n_u32( 1 << 24 );
+    uint32x2_t hx[5], hy[5], mx[5], my[5], r[5], s[5];
+    size_t i;
+
+    for( i = 0; i < 5; i++ )
+    {
+        r[i] = vld1_u32( st->rv[i] );
+        s[i] = vld1_u32( st->sv[i] );
+    }
+
+    if( st->open )
+    {
+        for( i = 0; i < 5; i++ )
+        {
+            hx[i] = vld1_u32( st->hv[i] );
+            hy[i] = vld1_u32( st->hv[i] + 2 );
+        }
+    }
+    else
+    {
+        /* h goes with the first block, which gets the highest power */
+        POLY_LOAD2( hx, in );
+        POLY_LOAD2( hy, in + 32 );
+        for( i = 0; i < 5; i++ )
+            hx[i] = vadd_u32( hx[i], vset_lane_u32( st->h[i],
+                                                    vdup_n_u32( 0 ), 0 ) );
+        in += 64;
+        ngroups--;
+        st->open = 1;
+    }
+
+    for( ; ngroups > 0; ngroups--, in += 64 )
+    {
+        POLY_LOAD2( mx, in );
+        POLY_LOAD2( my, in + 32 );
+        POLY_MUL2( hx, r, s );
+        POLY_MUL2( hy, r, s );
+        for( i = 0; i < 5; i++ )
+        {
+            hx[i] = vadd_u32( hx[i], mx[i] );
+            hy[i] = vadd_u32( hy[i], my[i] );
+        }
+    }
+
+    for( i = 0; i < 5; i++ )
+    {
+        vst1_u32( st->hv[i], hx[i] );
+        vst1_u32( st->hv[i] + 2, hy[i] );
+    }
+}
+
+/* Multiplies the accumulators by r^4 to r and adds them up into h */
+static void poly1305_neon_close( poly1305_state *st )
+{
+    const uint64x2_t mask = vdupq_n_u64( POLY_MASK26 );
+    uint32x2_t hx[5], hy[5], r[5], s[5];
+    uint64_t d[5], c;
+    size_t i;
+
+    if( !st->open )
+        return;
+
+    for( i = 0; i < 5; i++ )
+    {
+        hx[i] = vld1_u32( st->hv[i] );
+        hy[i] = vld1_u32( st->hv[i] + 2 );
+    }
+
+    for( i = 0; i < 5; i++ )
+    {
+        r[i] = vld1_u32( st->rx[i] );
+        s[i] = vld1_u32( st->sx[i] );
+    }
+    POLY_MUL2( hx, r, s );
+
+    for( i = 0; i < 5; i++ )
+    {
+        r[i] = vld1_u32( st->ry[i] );
+        s[i] = vld1_u32( st->sy[i] );
+    }
+    POLY_MUL2( hy, r, s );
+
+    for( i = 0; i < 5; i++ )
+        d[i] = vaddlvq_u32( vcombine_u32( hx[i], hy[i] ) );
+
+    c = d[0] >> 26; d[0] &= POLY_MASK26;
+    d[1] += c; c = d[1] >> 26; d[1] &= POLY_MASK26;
+    d[2] += c; c = d[2] >> 26; d[2] &= POLY_MASK26;
+    d[3] += c; c = d[3] >> 26; d[3] &= POLY_MASK26;
+    d[4] += c; c = d[4] >> 26; d[4] &= POLY_MASK26;
+    d[0] += c * 5; c = d[0] >> 26; d[0] &= POLY_MASK26;
+    d[1] += c;
+
+    for( i = 0; i < 5; i++ )
+        st->h[i] = (uint32_t) d[i];
+
+    st->open = 0;
+    mbedtls_platform_zeroize( st->hv, sizeof( st->hv ) );
+}
+#endif /* CHACHAPOLY_NEON */
+
+/* Full blocks of 16 Bytes */
+static void poly1305_blocks( poly1305_state *st, const unsigned char *in,
+                             size_t nblocks )
+{
+#if defined(CHACHAPOLY_NEON)
+    if( st->open || nblocks >= POLY_NEON_MIN_BLOCKS )
+    {
+        if( nblocks >= 4 )
+        {
+            if( !st->powers )
+                poly1305_neon_powers( st );
+            poly1305_neon_blocks( st, in, nblocks / 4 );
+            in += 64 * ( nblocks / 4 );
+            nblocks %= 4;
+        }
+        if( nblocks > 0 )
+            poly1305_neon_close( st );
+    }
+#endif /* CHACHAPOLY_NEON */
+
+    poly1305_blocks_c( st, in, nblocks, 1 << 24 );
+}
+
+/* Data padded with zeros to a multiple of 16 Bytes, as the AEAD does */
+static void poly1305_update_padded( poly1305_state *st,
+                                    const unsigned char *in, size_t len )
+{
+    unsigned char block[16];
+
+    poly1305_blocks( st, in, len / 16 );
+
+    if( len % 16 != 0 )
+    {
+        memset( block, 0, sizeof( block ) );
+        memcpy( block, in + len - len % 16, len % 16 );
+        poly1305_blocks( st, block, 1 );
+    }
+}
+
+static void poly1305_finish( poly1305_state *st, unsigned char mac[16] )
+{
+    uint32_t h0, h1, h2, h3, h4, g0, g1, g2, g3, g4, c, mask;
+    uint64_t f;
+
+#if defined(CHACHAPOLY_NEON)
+    poly1305_neon_close( st );
+#endif
+
+    h0 = st->h[0]; h1 = st->h[1]; h2 = st->h[2]; h3 = st->h[3]; h4 = st->h[4];
+
+    /* Full carry */
+    c = h1 >> 26; h1 &= POLY_MASK26;
+    h2 += c; c = h2 >> 26; h2 &= POLY_MASK26;
+    h3 += c; c = h3 >> 26; h3 &= POLY_MASK26;
+    h4 += c; c = h4 >> 26; h4 &= POLY_MASK26;
+    h0 += c * 5; c = h0 >> 26; h0 &= POLY_MASK26;
+    h1 += c;
+
+    /* h - p, selected in constant time if h >= p */
+    g0 = h0 + 5; c = g0 >> 26; g0 &= POLY_MASK26;
+    g1 = h1 + c; c = g1 >> 26; g1 &= POLY_MASK26;
+    g2 = h2 + c; c = g2 >> 26; g2 &= POLY_MASK26;
+    g3 = h3 + c; c = g3 >> 26; g3 &= POLY_MASK26;
+    g4 = h4 + c - ( 1 << 26 );
+
+    mask = ( g4 >> 31 ) - 1;
+    h0 = ( h0 & ~mask ) | ( g0 & mask );
+    h1 = ( h1 & ~mask ) | ( g1 & mask );
+    h2 = ( h2 & ~mask ) | ( g2 & mask );
+    h3 = ( h3 & ~mask ) | ( g3 & mask );
+    h4 = ( h4 & ~mask ) | ( g4 & mask );
+
+    /* h mod 2^128 + s */
+    h0 = h0 | ( h1 << 26 );
+    h1 = ( h1 >> 6 ) | ( h2 << 20 );
+    h2 = ( h2 >> 12 ) | ( h3 << 14 );
+    h3 = ( h3 >> 18 ) | ( h4 << 8 );
+
+    f = (uint64_t) h0 + st->pad[0];             h0 = (uint32_t) f;
+    f = (uint64_t) h1 + st->pad[1] + ( f >> 32 ); h1 = (uint32_t) f;
+    f = (uint64_t) h2 + st->pad[2] + ( f >> 32 ); h2 = (uint32_t) f;
+    f = (uint64_t) h3 + st->pad[3] + ( f >> 32 ); h3 = (uint32_t) f;
+
+    PUT_UINT32_LE( h0, mac,  0 );
+    PUT_UINT32_LE( h1, mac,  4 );
+    PUT_UINT32_LE( h2, mac,  8 );
+    PUT_UINT32_LE( h3, mac, 12 );
+
+    mbedtls_platform_zeroize( st, sizeof( *st ) );
+}
+
+int mbedtls_poly1305_neon_mac( const unsigned char key[32],
+                               const unsigned char *input,
+                               size_t ilen,
+                               unsigned char mac[16] )
+{
+    poly1305_state st;
+    unsigned char block[16];
+    size_t rem = ilen % 16;
+
+    poly1305_starts( &st, key );
+    poly1305_blocks( &st, input, ilen / 16 );
+
+    /* The last partial block is padded with 1 then zeros */
+    if( rem != 0 )
+    {
+        memset( block, 0, sizeof( block ) );
+        memcpy( block, input + ilen - rem, rem );
+        block[rem] = 1;
+#if defined(CHACHAPOLY_NEON)
+        poly1305_neon_close( &st );
+#endif
+        poly1305_blocks_c( &st, block, 1, 0 );
+    }
+
+    poly1305_finish( &st, mac );
+    return( 0 );
+}
+
+/*
+ * ChaCha20-Poly1305
+ */
+void mbedtls_chachapoly_neon_init( mbedtls_chachapoly_neon_context *ctx )
+{
+    memset( ctx, 0, sizeof( mbedtls_chachapoly_neon_context ) );
+}
+
+void mbedtls_chachapoly_neon_free( mbedtls_chachapoly_neon_context *ctx )
+{
+    if( ctx == NULL )
+        return;
+
+    mbedtls_platform_zeroize( ctx, sizeof( mbedtls_chachapoly_neon_context ) );
+}
+
+int mbedtls_chachapoly_neon_setkey( mbedtls_chachapoly_neon_context *ctx,
+                                    const unsigned char key[32] )
+{
+    size_t i;
+
+    for( i = 0; i < 8; i++ )
+        GET_UINT32_LE( ctx->key[i], key, 4 * i );
+
+    return( 0 );
+}
+
+/* Encrypts or decrypts, and computes the tag over the ciphertext */
+static void chachapoly_neon_crypt_and_tag( mbedtls_chachapoly_neon_context *ctx,
+                                           int decrypt,
+                                           size_t length,
+                                           const unsigned char nonce[12],
+                                           const unsigned char *aad,
+                                           size_t aad_len,
+                                           const unsigned char *input,
+                                           unsigned char *output,
+                                           unsigned char tag[16] )
+{
+    poly1305_state st;
+    uint32_t state[16];
+    unsigned char block[64];
+    uint64_t len;
+    size_t done, n;
+
+    /* The Poly1305 key is the first half of block 0 */
+    chacha20_setup( state, ctx->key, nonce, 0 );
+    chacha20_block( state, block );
+    poly1305_starts( &st, block );
+
+    poly1305_update_padded( &st, aad, aad_len );
+
+    for( done = 0; done < length; done += n )
+    {
+        n = length - done;
+        if( n > CHACHAPOLY_NEON_CHUNK )
+            n = CHACHAPOLY_NEON_CHUNK;
+
+        if( decrypt )
+            poly1305_update_padded( &st, input + done, n );
+        chacha20_xor( state, input + done, output + done, n );
+        if( !decrypt )
+            poly1305_update_padded( &st, output + done, n );
+    }
+
+    len = aad_len;
+    PUT_UINT32_LE( (uint32_t) len, block, 0 );
+    PUT_UINT32_LE( (uint32_t) ( len >> 32 ), block, 4 );
+    len = length;
+    PUT_UINT32_LE( (uint32_t) len, block, 8 );
+    PUT_UINT32_LE( (uint32_t) ( len >> 32 ), block, 12 );
+    poly1305_blocks( &st, block, 1 );
+    poly1305_finish( &st, tag );
+
+    mbedtls_platform_zeroize( state, sizeof( state ) );
+    mbedtls_platform_zeroize( block, sizeof( block ) );
+}
+
+int mbedtls_chachapoly_neon_encrypt_and_tag(
+                                    mbedtls_chachapoly_neon_context *ctx,
+                                    size_t length,
+                                    const unsigned char nonce[12],
+                                    const unsigned char *aad,
+                                    size_t aad_len,
+                                    const unsigned char *input,
+                                    unsigned char *output,
+                                    unsigned char tag[16] )
+{
+    chachapoly_neon_crypt_and_tag( ctx, 0, length, nonce, aad, aad_len,
+                                   input, output, tag );
+    return( 0 );
+}
+
+int mbedtls_chachapoly_neon_auth_decrypt(
+                                    mbedtls_chachapoly_neon_context *ctx,
+                                    size_t length,
+                                    const unsigned char nonce[12],
+                                    const unsigned char *aad,
+                                    size_t aad_len,
+                                    const unsigned char tag[16],
+                                    const unsigned char *input,
+                                    unsigned char *output )
+{
+    unsigned char check_tag[16];
+    unsigned char diff = 0;
+    size_t i;
+
+    chachapoly_neon_crypt_and_tag( ctx, 1, length, nonce, aad, aad_len,
+                                   input, output, check_tag );
+
+    /* Check tag in "constant-time" */
+    for( i = 0; i < sizeof( check_tag ); i++ )
+        diff |= tag[i] ^ check_tag[i];
+
+    mbedtls_platform_zeroize( check_tag, sizeof( check_tag ) );
+
+    if( diff != 0 )
+    {
+        mbedtls_platform_zeroize( output, length );
+        return( MBEDTLS_ERR_CHACHAPOLY_AUTH_FAILED );
+    }
+
+    return( 0 );
+}
+
+#if defined(MBEDTLS_SELF_TEST)
+
+/*
+ * RFC 8439 section 2.4.2 (ChaCha20, key 00..1F, counter 1), section 2.5.2
+ * (Poly1305), section 2.8.2 (AEAD, key 80..9F) and appendix A.5 (AEAD)
+ */
+static const unsigned char chachapoly_neon_test_sunscreen[114] =
+{
+    0x4C, 0x61, 0x64, 0x69, 0x65, 0x73, 0x20, 0x61,
+    0x6E, 0x64, 0x20, 0x47, 0x65, 0x6E, 0x74, 0x6C,
+    0x65, 0x6D, 0x65, 0x6E, 0x20, 0x6F, 0x66, 0x20,
+    0x74, 0x68, 0x65, 0x20, 0x63, 0x6C, 0x61, 0x73,
+    0x73, 0x20, 0x6F, 0x66, 0x20, 0x27, 0x39, 0x39,
+    0x3A, 0x20, 0x49, 0x66, 0x20, 0x49, 0x20, 0x63,
+    0x6F, 0x75, 0x6C, 0x64, 0x20, 0x6F, 0x66, 0x66,
+    0x65, 0x72, 0x20, 0x79, 0x6F, 0x75, 0x20, 0x6F,
+    0x6E, 0x6C, 0x79, 0x20, 0x6F, 0x6E, 0x65, 0x20,
+    0x74, 0x69, 0x70, 0x20, 0x66, 0x6F, 0x72, 0x20,
+    0x74, 0x68, 0x65, 0x20, 0x66, 0x75, 0x74, 0x75,
+    0x72, 0x65, 0x2C, 0x20, 0x73, 0x75, 0x6E, 0x73,
+    0x63, 0x72, 0x65, 0x65, 0x6E, 0x20, 0x77, 0x6F,
+    0x75, 0x6C, 0x64, 0x20, 0x62, 0x65, 0x20, 0x69,
+    0x74, 0x2E,
+};
+
+static const unsigned char chacha20_neon_test_ct[114] =
+{
+    0x6E, 0x2E, 0x35, 0x9A, 0x25, 0x68, 0xF9, 0x80,
+    0x41, 0xBA, 0x07, 0x28, 0xDD, 0x0D, 0x69, 0x81,
+    0xE9, 0x7E, 0x7A, 0xEC, 0x1D, 0x43, 0x60, 0xC2,
+    0x0A, 0x27, 0xAF, 0xCC, 0xFD, 0x9F, 0xAE, 0x0B,
+    0xF9, 0x1B, 0x65, 0xC5, 0x52, 0x47, 0x33, 0xAB,
+    0x8F, 0x59, 0x3D, 0xAB, 0xCD, 0x62, 0xB3, 0x57,
+    0x16, 0x39, 0xD6, 0x24, 0xE6, 0x51, 0x52, 0xAB,
+    0x8F, 0x53, 0x0C, 0x35, 0x9F, 0x08, 0x61, 0xD8,
+    0x07, 0xCA, 0x0D, 0xBF, 0x50, 0x0D, 0x6A, 0x61,
+    0x56, 0xA3, 0x8E, 0x08, 0x8A, 0x22, 0xB6, 0x5E,
+    0x52, 0xBC, 0x51, 0x4D, 0x16, 0xCC, 0xF8, 0x06,
+    0x81, 0x8C, 0xE9, 0x1A, 0xB7, 0x79, 0x37, 0x36,
+    0x5A, 0xF9, 0x0B, 0xBF, 0x74, 0xA3, 0x5B, 0xE6,
+    0xB4, 0x0B, 0x8E, 0xED, 0xF2, 0x78, 0x5E, 0x42,
+    0x87, 0x4D,
+};
+
+static const unsigned char poly1305_neon_test_key[32] =
+{
+    0x85, 0xD6, 0xBE, 0x78, 0x57, 0x55, 0x6D, 0x33,
+    0x7F, 0x44, 0x52, 0xFE, 0x42, 0xD5, 0x06, 0xA8,
+    0x01, 0x03, 0x80, 0x8A, 0xFB, 0x0D, 0xB2, 0xFD,
+    0x4A, 0xBF, 0xF6, 0xAF, 0x41, 0x49, 0xF5, 0x1B,
+};
+
+static const unsigned char poly1305_neon_test_mac[16] =
+{
+    0xA8, 0x06, 0x1D, 0xC1, 0x30, 0x51, 0x36, 0xC6,
+    0xC2, 0x2B, 0x8B, 0xAF, 0x0C, 0x01, 0x27, 0xA9,
+};
+
+static const unsigned char chachapoly_neon_test_aead_ct[114] =
+{
+    0xD3, 0x1A, 0x8D, 0x34, 0x64, 0x8E, 0x60, 0xDB,
+    0x7B, 0x86, 0xAF, 0xBC, 0x53, 0xEF, 0x7E, 0xC2,
+    0xA4, 0xAD, 0xED, 0x51, 0x29, 0x6E, 0x08, 0xFE,
+    0xA9, 0xE2, 0xB5, 0xA7, 0x36, 0xEE, 0x62, 0xD6,
+    0x3D, 0xBE, 0xA4, 0x5E, 0x8C, 0xA9, 0x67, 0x12,
+    0x82, 0xFA, 0xFB, 0x69, 0xDA, 0x92, 0x72, 0x8B,
+    0x1A, 0x71, 0xDE, 0x0A, 0x9E, 0x06, 0x0B, 0x29,
+    0x05, 0xD6, 0xA5, 0xB6, 0x7E, 0xCD, 0x3B, 0x36,
+    0x92, 0xDD, 0xBD, 0x7F, 0x2D, 0x77, 0x8B, 0x8C,
+    0x98, 0x03, 0xAE, 0xE3, 0x28, 0x09, 0x1B, 0x58,
+    0xFA, 0xB3, 0x24, 0xE4, 0xFA, 0xD6, 0x75, 0x94,
+    0x55, 0x85, 0x80, 0x8B, 0x48, 0x31, 0xD7, 0xBC,
+    0x3F, 0xF4, 0xDE, 0xF0, 0x8E, 0x4B, 0x7A, 0x9D,
+    0xE5, 0x76, 0xD2, 0x65, 0x86, 0xCE, 0xC6, 0x4B,
+    0x61, 0x16,
+};
+
+static const unsigned char chachapoly_neon_test_aead_tag[16] =
+{
+    0x1A, 0xE1, 0x0B, 0x59, 0x4F, 0x09, 0xE2, 0x6A,
+    0x7E, 0x90, 0x2E, 0xCB, 0xD0, 0x60, 0x06, 0x91,
+};
+
+static const unsigned char chachapoly_neon_test_a5_key[32] =
+{
+    0x1C, 0x92, 0x40, 0xA5, 0xEB, 0x55, 0xD3, 0x8A,
+    0xF3, 0x33, 0x88, 0x86, 0x04, 0xF6, 0xB5, 0xF0,
+    0x47, 0x39, 0x17, 0xC1, 0x40, 0x2B, 0x80, 0x09,
+    0x9D, 0xCA, 0x5C, 0xBC, 0x20, 0x70, 0x75, 0xC0,
+};
+
+static const unsigned char chachapoly_neon_test_a5_ct[265] =
+{
+    0x64, 0xA0, 0x86, 0x15, 0x75, 0x86, 0x1A, 0xF4,
+    0x60, 0xF0, 0x62, 0xC7, 0x9B, 0xE6, 0x43, 0xBD,
+    0x5E, 0x80, 0x5C, 0xFD, 0x34, 0x5C, 0xF3, 0x89,
+    0xF1, 0x08, 0x67, 0x0A, 0xC7, 0x6C, 0x8C, 0xB2,
+    0x4C, 0x6C, 0xFC, 0x18, 0x75, 0x5D, 0x43, 0xEE,
+    0xA0, 0x9E, 0xE9, 0x4E, 0x38, 0x2D, 0x26, 0xB0,
+    0xBD, 0xB7, 0xB7, 0x3C, 0x32, 0x1B, 0x01, 0x00,
+    0xD4, 0xF0, 0x3B, 0x7F, 0x35, 0x58, 0x94, 0xCF,
+    0x33, 0x2F, 0x83, 0x0E, 0x71, 0x0B, 0x97, 0xCE,
+    0x98, 0xC8, 0xA8, 0x4A, 0xBD, 0x0B, 0x94, 0x81,
+    0x14, 0xAD, 0x17, 0x6E, 0x00, 0x8D, 0x33, 0xBD,
+    0x60, 0xF9, 0x82, 0xB1, 0xFF, 0x37, 0xC8, 0x55,
+    0x97, 0x97, 0xA0, 0x6E, 0xF4, 0xF0, 0xEF, 0x61,
+    0xC1, 0x86, 0x32, 0x4E, 0x2B, 0x35, 0x06, 0x38,
+    0x36, 0x06, 0x90, 0x7B, 0x6A, 0x7C, 0x02, 0xB0,
+    0xF9, 0xF6, 0x15, 0x7B, 0x53, 0xC8, 0x67, 0xE4,
+    0xB9, 0x16, 0x6C, 0x76, 0x7B, 0x80, 0x4D, 0x46,
+    0xA5, 0x9B, 0x52, 0x16, 0xCD, 0xE7, 0xA4, 0xE9,
+    0x90, 0x40, 0xC5, 0xA4, 0x04, 0x33, 0x22, 0x5E,
+    0xE2, 0x82, 0xA1, 0xB0, 0xA0, 0x6C, 0x52, 0x3E,
+    0xAF, 0x45, 0x34, 0xD7, 0xF8, 0x3F, 0xA1, 0x15,
+    0x5B, 0x00, 0x47, 0x71, 0x8C, 0xBC, 0x54, 0x6A,
+    0x0D, 0x07, 0x2B, 0x04, 0xB3, 0x56, 0x4E, 0xEA,
+    0x1B, 0x42, 0x22, 0x73, 0xF5, 0x48, 0x27, 0x1A,
+    0x0B, 0xB2, 0x31, 0x60, 0x53, 0xFA, 0x76, 0x99,
+    0x19, 0x55, 0xEB, 0xD6, 0x31, 0x59, 0x43, 0x4E,
+    0xCE, 0xBB, 0x4E, 0x46, 0x6D, 0xAE, 0x5A, 0x10,
+    0x73, 0xA6, 0x72, 0x76, 0x27, 0x09, 0x7A, 0x10,
+    0x49, 0xE6, 0x17, 0xD9, 0x1D, 0x36, 0x10, 0x94,
+    0xFA, 0x68, 0xF0, 0xFF, 0x77, 0x98, 0x71, 0x30,
+    0x30, 0x5B, 0xEA, 0xBA, 0x2E, 0xDA, 0x04, 0xDF,
+    0x99, 0x7B, 0x71, 0x4D, 0x6C, 0x6F, 0x2C, 0x29,
+    0xA6, 0xAD, 0x5C, 0xB4, 0x02, 0x2B, 0x02, 0x70,
+    0x9B,
+};
+
+static const unsigned char chachapoly_neon_test_a5_pt[265] =
+{
+    0x49, 0x6E, 0x74, 0x65, 0x72, 0x6E, 0x65, 0x74,
+    0x2D, 0x44, 0x72, 0x61, 0x66, 0x74, 0x73, 0x20,
+    0x61, 0x72, 0x65, 0x20, 0x64, 0x72, 0x61, 0x66,
+    0x74, 0x20, 0x64, 0x6F, 0x63, 0x75, 0x6D, 0x65,
+    0x6E, 0x74, 0x73, 0x20, 0x76, 0x61, 0x6C, 0x69,
+    0x64, 0x20, 0x66, 0x6F, 0x72, 0x20, 0x61, 0x20,
+    0x6D, 0x61, 0x78, 0x69, 0x6D, 0x75, 0x6D, 0x20,
+    0x6F, 0x66, 0x20, 0x73, 0x69, 0x78, 0x20, 0x6D,
+    0x6F, 0x6E, 0x74, 0x68, 0x73, 0x20, 0x61, 0x6E,
+    0x64, 0x20, 0x6D, 0x61, 0x79, 0x20, 0x62, 0x65,
+    0x20, 0x75, 0x70, 0x64, 0x61, 0x74, 0x65, 0x64,
+    0x2C, 0x20, 0x72, 0x65, 0x70, 0x6C, 0x61, 0x63,
+    0x65, 0x64, 0x2C, 0x20, 0x6F, 0x72, 0x20, 0x6F,
+    0x62, 0x73, 0x6F, 0x6C, 0x65, 0x74, 0x65, 0x64,
+    0x20, 0x62, 0x79, 0x20, 0x6F, 0x74, 0x68, 0x65,
+    0x72, 0x20, 0x64, 0x6F, 0x63, 0x75, 0x6D, 0x65,
+    0x6E, 0x74, 0x73, 0x20, 0x61, 0x74, 0x20, 0x61,
+    0x6E, 0x79, 0x20, 0x74, 0x69, 0x6D, 0x65, 0x2E,
+    0x20, 0x49, 0x74, 0x20, 0x69, 0x73, 0x20, 0x69,
+    0x6E, 0x61, 0x70, 0x70, 0x72, 0x6F, 0x70, 0x72,
+    0x69, 0x61, 0x74, 0x65, 0x20, 0x74, 0x6F, 0x20,
+    0x75, 0x73, 0x65, 0x20, 0x49, 0x6E, 0x74, 0x65,
+    0x72, 0x6E, 0x65, 0x74, 0x2D, 0x44, 0x72, 0x61,
+    0x66, 0x74, 0x73, 0x20, 0x61, 0x73, 0x20, 0x72,
+    0x65, 0x66, 0x65, 0x72, 0x65, 0x6E, 0x63, 0x65,
+    0x20, 0x6D, 0x61, 0x74, 0x65, 0x72, 0x69, 0x61,
+    0x6C, 0x20, 0x6F, 0x72, 0x20, 0x74, 0x6F, 0x20,
+    0x63, 0x69, 0x74, 0x65, 0x20, 0x74, 0x68, 0x65,
+    0x6D, 0x20, 0x6F, 0x74, 0x68, 0x65, 0x72, 0x20,
+    0x74, 0x68, 0x61, 0x6E, 0x20, 0x61, 0x73, 0x20,
+    0x2F, 0xE2, 0x80, 0x9C, 0x77, 0x6F, 0x72, 0x6B,
+    0x20, 0x69, 0x6E, 0x20, 0x70, 0x72, 0x6F, 0x67,
+    0x72, 0x65, 0x73, 0x73, 0x2E, 0x2F, 0xE2, 0x80,
+    0x9D,
+};
+
+static const unsigned char chachapoly_neon_test_a5_tag[16] =
+{
+    0xEE, 0xAD, 0x9D, 0x67, 0x89, 0x0C, 0xBB, 0x22,
+    0x39, 0x23, 0x36, 0xFE, 0xA1, 0x85, 0x1F, 0x38,
+};
+
+static const unsigned char chacha20_neon_test_nonce[12] =
+{
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x4A,
+    0x00, 0x00, 0x00, 0x00,
+};
+
+static const unsigned char chachapoly_neon_test_aead_nonce[12] =
+{
+    0x07, 0x00, 0x00, 0x00, 0x40, 0x41, 0x42, 0x43,
+    0x44, 0x45, 0x46, 0x47,
+};
+
+static const unsigned char chachapoly_neon_test_aead_aad[12] =
+{
+    0x50, 0x51, 0x52, 0x53, 0xC0, 0xC1, 0xC2, 0xC3,
+    0xC4, 0xC5, 0xC6, 0xC7,
+};
+
+static const unsigned char chachapoly_neon_test_a5_nonce[12] =
+{
+    0x00, 0x00, 0x00, 0x00, 0x01, 0x02, 0x03, 0x04,
+    0x05, 0x06, 0x07, 0x08,
+};
+
+static const unsigned char chachapoly_neon_test_a5_aad[12] =
+{
+    0xF3, 0x33, 0x88, 0x86, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x4E, 0x91,
+};
+
+/* Lengths compared with libmbedtls, around the block and chunk sizes */
+static const size_t chachapoly_neon_test_lens[] =
+{
+    0, 1, 15, 16, 63, 64, 65, 127, 128, 191, 255, 256, 257, 511, 1023,
+    1024, 1025, 2100, 4097,
+};
+
+#define CHACHAPOLY_NEON_TEST_MAX_LEN    4097
+
+/* Same tag and ciphertext as libmbedtls, aad and data of all lengths */
+static int chachapoly_neon_self_test_mbedtls( void )
+{
+    mbedtls_chachapoly_context ref;
+    mbedtls_chachapoly_neon_context ctx;
+    unsigned char key[32], nonce[12], tag[16], ref_tag[16];
+    unsigned char *in, *out, *ref_out;
+    size_t i, j, len, aad_len;
+    int ret = 1;
+
+    mbedtls_chachapoly_init( &ref );
+    mbedtls_chachapoly_neon_init( &ctx );
+
+    in = mbedtls_calloc( 3, CHACHAPOLY_NEON_TEST_MAX_LEN );
+    if( in == NULL )
+        return( 1 );
+    out = in + CHACHAPOLY_NEON_TEST_MAX_LEN;
+    ref_out = out + CHACHAPOLY_NEON_TEST_MAX_LEN;
+
+    for( i = 0; i < sizeof( key ); i++ )
+        key[i] = (unsigned char) ( i * 7 + 3 );
+    for( i = 0; i < sizeof( nonce ); i++ )
+        nonce[i] = (unsigned char) ( i * 11 + 1 );
+    for( i = 0; i < CHACHAPOLY_NEON_TEST_MAX_LEN; i++ )
+        in[i] = (unsigned char) ( i * 13 + 5 );
+
+    if( mbedtls_chachapoly_setkey( &ref, key ) != 0 ||
+        mbedtls_chachapoly_neon_setkey( &ctx, key ) != 0 )
+        goto exit;
+
+    for( i = 0; i < sizeof( chachapoly_neon_test_lens ) / sizeof( size_t );
+         i++ )
+    {
+        len = chachapoly_neon_test_lens[i];
+        /* The AAD is taken from the end of the data */
+        aad_len = chachapoly_neon_test_lens[i % 13];
+        nonce[0] = (unsigned char) i;
+
+        if( mbedtls_chachapoly_encrypt_and_tag( &ref, len, nonce,
+                in + CHACHAPOLY_NEON_TEST_MAX_LEN - aad_len, aad_len,
+                in, ref_out, ref_tag ) != 0 ||
+            mbedtls_chachapoly_neon_encrypt_and_tag( &ctx, len, nonce,
+                in + CHACHAPOLY_NEON_TEST_MAX_LEN - aad_len, aad_len,
+                in, out, tag ) != 0 ||
+            memcmp( out, ref_out, len ) != 0 ||
+            memcmp( tag, ref_tag, 16 ) != 0 )
+            goto exit;
+
+        /* In place */
+        if( mbedtls_chachapoly_neon_auth_decrypt( &ctx, len, nonce,
+                in + CHACHAPOLY_NEON_TEST_MAX_LEN - aad_len, aad_len,
+                tag, out, out ) != 0 ||
+            memcmp( out, in, len ) != 0 )
+            goto exit;
+
+        tag[i % 16] ^= 0x80;
+        if( mbedtls_chachapoly_neon_auth_decrypt( &ctx, len, nonce,
+                in + CHACHAPOLY_NEON_TEST_MAX_LEN - aad_len, aad_len,
+                tag, ref_out, out ) != MBEDTLS_ERR_CHACHAPOLY_AUTH_FAILED )
+            goto exit;
+        for( j = 0; j < len; j++ )
+            if( out[j] != 0 )
+                goto exit;
+    }
+
+    ret = 0;
+
+exit:
+    mbedtls_chachapoly_free( &ref );
+    mbedtls_chachapoly_neon_free( &ctx );
+    mbedtls_free( in );
+    return( ret );
+}
+
+int mbedtls_chachapoly_neon_self_test( int verbose )
+{
+    mbedtls_chachapoly_neon_context ctx;
+    unsigned char key[32];
+    unsigned char buf[265];
+    unsigned char tag[16];
+    size_t i;
+    int ret = 0;
+
+    mbedtls_chachapoly_neon_init( &ctx );
+
+    if( verbose != 0 )
+        mbedtls_printf( "  ChaCha20-NEON test #1: " );
+
+    for( i = 0; i < sizeof( key ); i++ )
+        key[i] = (unsigned char) i;
+
+    if( mbedtls_chacha20_neon_crypt( key, chacha20_neon_test_nonce, 1,
+                                     sizeof( chachapoly_neon_test_sunscreen ),
+                                     chachapoly_neon_test_sunscreen,
+                                     buf ) != 0 ||
+        memcmp( buf, chacha20_neon_test_ct,
+                sizeof( chacha20_neon_test_ct ) ) != 0 )
+        goto fail;
+
+    if( verbose != 0 )
+        mbedtls_printf( "passed\n  Poly1305-NEON test #1: " );
+
+    if( mbedtls_poly1305_neon_mac( poly1305_neon_test_key,
+                                   (const unsigned char *)
+                                   "Cryptographic Forum Research Group",
+                                   34, tag ) != 0 ||
+        memcmp( tag, poly1305_neon_test_mac, 16 ) != 0 )
+        goto fail;
+
+    if( verbose != 0 )
+        mbedtls_printf( "passed\n  ChaCha20-Poly1305-NEON test #1: " );
+
+    for( i = 0; i < sizeof( key ); i++ )
+        key[i] = (unsigned char) ( 0x80 + i );
+
+    if( mbedtls_chachapoly_neon_setkey( &ctx, key ) != 0 ||
+        mbedtls_chachapoly_neon_encrypt_and_tag( &ctx,
+                sizeof( chachapoly_neon_test_sunscreen ),
+                chachapoly_neon_test_aead_nonce,
+                chachapoly_neon_test_aead_aad,
+                sizeof( chachapoly_neon_test_aead_aad ),
+                chachapoly_neon_test_sunscreen, buf, tag ) != 0 ||
+        memcmp( buf, chachapoly_neon_test_aead_ct,
+                sizeof( chachapoly_neon_test_aead_ct ) ) != 0 ||
+        memcmp( tag, chachapoly_neon_test_aead_tag, 16 ) != 0 )
+        goto fail;
+
+    if( verbose != 0 )
+        mbedtls_printf( "passed\n  ChaCha20-Poly1305-NEON test #2: " );
+
+    if( mbedtls_chachapoly_neon_setkey( &ctx,
+                                        chachapoly_neon_test_a5_key ) != 0 ||
+        mbedtls_chachapoly_neon_auth_decrypt( &ctx,
+                sizeof( chachapoly_neon_test_a5_ct ),
+                chachapoly_neon_test_a5_nonce,
+                chachapoly_neon_test_a5_aad,
+                sizeof( chachapoly_neon_test_a5_aad ),
+                chachapoly_neon_test_a5_tag,
+                chachapoly_neon_test_a5_ct, buf ) != 0 ||
+        memcmp( buf, chachapoly_neon_test_a5_pt,
+                sizeof( chachapoly_neon_test_a5_pt ) ) != 0 )
+        goto fail;
+
+    if( verbose != 0 )
+        mbedtls_printf( "passed\n  ChaCha20-Poly1305-NEON vs libmbedtls: " );
+
+    if( chachapoly_neon_self_test_mbedtls() != 0 )
+        goto fail;
+
+    if( verbose != 0 )
+        mbedtls_printf( "passed\n\n" );
+
+    goto exit;
+
+fail:
+    if( verbose != 0 )
+        mbedtls_printf( "failed\n" );
+    ret = 1;
+
+exit:
+    mbedtls_chachapoly_neon_free( &ctx );
+    mbedtls_platform_zeroize( buf, sizeof( buf ) );
+    return( ret );
+}
+
+#endif /* MBEDTLS_SELF_TEST */
+
+#endif /* MBEDTLS_CHACHAPOLY_NEON_C */
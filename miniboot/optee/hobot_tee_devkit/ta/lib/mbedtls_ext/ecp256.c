@@ -0,0 +1,1051 @@
+/*
+ *  ECDSA over SECP256R1 and SM2DSA over SM2P256V1, verification
+ *
+ *  Copyright (c) 2026, D-Robotics
+ *  SPDX-License-Identifier: BSD-2-Clause
+ */
+/*
+ *  SEC 1 v2, section 4.1.4, and GB/T 32918.2-2016, section 7
+ *
+ *  Both curves are y^2 = x^3 - 3x + b over a 256-bit prime. Field and
+ *  scalar elements are four 64-bit limbs, least significant first, kept in
+ *  the Montgomery domain of their modulus.
+ *
+ *  A signature is checked by computing u1 * G + u2 * Q in Jacobian
+ *  coordinates, in a single loop of 256 doublings:
+ *
+ *  - u2 * Q adds the odd multiples Q, 3Q, ..., 15Q or their opposites at
+ *    the digits of the width-5 NAF of u2;
+ *  - u1 * G adds, in the last 32 iterations, the entries of a comb table
+ *    of G with 8 teeth spaced 32 bits apart, see scripts/ecp256_comb.py.
+ *
+ *  Both only add affine points. A batch shares one field inversion between
+ *  all its signatures to make the odd multiples of their keys affine, one
+ *  to recover the x coordinates of the results and, for ECDSA, one scalar
+ *  inversion for s^-1.
+ */
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#if defined(MBEDTLS_ECP256_C)
+
+#include "mbedtls/ecp256.h"
+#include "mbedtls/bignum.h"
+
+#include <string.h>
+
+#if defined(MBEDTLS_PLATFORM_C)
+#include "mbedtls/platform.h"
+#else
+#include <stdio.h>
+#include <stdlib.h>
+#define mbedtls_calloc    calloc
+#define mbedtls_free      free
+#define mbedtls_printf    printf
+#endif /* MBEDTLS_PLATFORM_C */
+
+#if !defined(__SIZEOF_INT128__)
+#error "MBEDTLS_ECP256_C needs a 64-bit target with 128-bit integers"
+#endif
+
+typedef unsigned __int128 ecp256_udbl;
+
+#include "ecp256_tables.inc"
+
+/*
+ * 64-bit integer manipulation macros (big endian)
+ */
+#ifndef GET_UINT64_BE
+#define GET_UINT64_BE(n,b,i)                            \
+do {                                                    \
+    (n) = ( (uint64_t) (b)[(i)    ] << 56 )             \
+        | ( (uint64_t) (b)[(i) + 1] << 48 )             \
+        | ( (uint64_t) (b)[(i) + 2] << 40 )             \
+        | ( (uint64_t) (b)[(i) + 3] << 32 )             \
+        | ( (uint64_t) (b)[(i) + 4] << 24 )             \
+        | ( (uint64_t) (b)[(i) + 5] << 16 )             \
+        | ( (uint64_t) (b)[(i) + 6] <<  8 )             \
+        | ( (uint64_t) (b)[(i) + 7]       );            \
+} while( 0 )
+#endif
+
+/* Width of the NAF of u2 and number of odd multiples of Q */
+#define ECP256_WNAF_WIDTH   5
+#define ECP256_WNAF_POINTS  ( 1 << ( ECP256_WNAF_WIDTH - 2 ) )
+
+/*
+ * A modulus, its R^2 mod m with R = 2^256, and -m^-1 mod 2^64
+ */
+typedef struct
+{
+    const uint64_t *m;
+    const uint64_t *rr;
+    uint64_t n0;
+}
+ecp256_mod;
+
+typedef struct
+{
+    mbedtls_ecp_group_id id;
+    int sm2;                    /* SM2DSA rather than ECDSA */
+    ecp256_mod p;
+    ecp256_mod n;
+    const uint64_t *one;        /* R mod p */
+    const uint64_t *b;          /* b * R mod p */
+    const uint64_t (*comb)[8];
+}
+ecp256_curve;
+
+/* A point in Jacobian coordinates, the infinity having Z = 0 */
+typedef struct
+{
+    uint64_t X[4];
+    uint64_t Y[4];
+    uint64_t Z[4];
+}
+ecp256_jac;
+
+static const ecp256_curve ecp256_curves[] =
+{
+    {
+        MBEDTLS_ECP_DP_SECP256R1, 0,
+        { ecp256_secp256r1_p, ecp256_secp256r1_p_rr,
+          ECP256_SECP256R1_P_N0 },
+        { ecp256_secp256r1_n, ecp256_secp256r1_n_rr,
+          ECP256_SECP256R1_N_N0 },
+        ecp256_secp256r1_p_one, ecp256_secp256r1_b, ecp256_secp256r1_comb,
+    },
+    {
+        MBEDTLS_ECP_DP_SM2P256V1, 1,
+        { ecp256_sm2p256v1_p, ecp256_sm2p256v1_p_rr,
+          ECP256_SM2P256V1_P_N0 },
+        { ecp256_sm2p256v1_n, ecp256_sm2p256v1_n_rr,
+          ECP256_SM2P256V1_N_N0 },
+        ecp256_sm2p256v1_p_one, ecp256_sm2p256v1_b, ecp256_sm2p256v1_comb,
+    },
+};
+
+static const ecp256_curve *ecp256_curve_get( mbedtls_ecp_group_id grp_id )
+{
+    size_t i;
+
+    for( i = 0; i < sizeof( ecp256_curves ) / sizeof( ecp256_curves[0] ); i++ )
+        if( ecp256_curves[i].id == grp_id )
+            return( &ecp256_curves[i] );
+
+    return( NULL );
+}
+
+int mbedtls_ecp256_has_curve( mbedtls_ecp_group_id grp_id )
+{
+    return( ecp256_curve_get( grp_id ) != NULL );
+}
+
+/*
+ * Multi-precision helpers
+ */
+static int ecp256_is_zero( const uint64_t a[4] )
+{
+    return( ( a[0] | a[1] | a[2] | a[3] ) == 0 );
+}
+
+static int ecp256_cmp( const uint64_t a[4], const uint64_t b[4] )
+{
+    int i;
+
+    for( i = 3; i >= 0; i-- )
+    {
+        if( a[i] != b[i] )
+            return( a[i] > b[i] ? 1 : -1 );
+    }
+
+    return( 0 );
+}
+
+/* r = a + b, returns the carry */
+static uint64_t ecp256_add( uint64_t r[4], const uint64_t a[4],
+                            const uint64_t b[4] )
+{
+    ecp256_udbl t = 0;
+    unsigned int i;
+
+    for( i = 0; i < 4; i++ )
+    {
+        t += (ecp256_udbl) a[i] + b[i];
+        r[i] = (uint64_t) t;
+        t >>= 64;
+    }
+
+    return( (uint64_t) t );
+}
+
+/* r = a - b, returns the borrow */
+static uint64_t ecp256_sub( uint64_t r[4], const uint64_t a[4],
+                            const uint64_t b[4] )
+{
+    ecp256_udbl t;
+    uint64_t borrow = 0;
+    unsigned int i;
+
+    for( i = 0; i < 4; i++ )
+    {
+        t = (ecp256_udbl) a[i] - b[i] - borrow;
+        r[i] = (uint64_t) t;
+        borrow = (uint64_t) ( t >> 64 ) & 1;
+    }
+
+    return( borrow );
+}
+
+/*
+ * Arithmetic modulo m, on elements below m
+ */
+static void ecp256_mod_add( uint64_t r[4], const uint64_t a[4],
+                            const uint64_t b[4], const ecp256_mod *m )
+{
+    uint64_t t[4], u[4];
+    uint64_t carry;
+
+    carry = ecp256_add( t, a, b );
+    if( ecp256_sub( u, t, m->m ) == 0 || carry != 0 )
+        memcpy( r, u, sizeof( u ) );
+    else
+        memcpy( r, t, sizeof( t ) );
+}
+
+static void ecp256_mod_sub( uint64_t r[4], const uint64_t a[4],
+                            const uint64_t b[4], const ecp256_mod *m )
+{
+    if( ecp256_sub( r, a, b ) != 0 )
+        ecp256_add( r, r, m->m );
+}
+
+/* r = a * b / R mod m */
+static void ecp256_mod_mul( uint64_t r[4], const uint64_t a[4],
+                            const uint64_t b[4], const ecp256_mod *m )
+{
+    uint64_t t[6] = { 0 };
+    uint64_t u[4];
+    uint64_t q, c;
+    ecp256_udbl uv;
+    unsigned int i, j;
+
+    for( i = 0; i < 4; i++ )
+    {
+        c = 0;
+        for( j = 0; j < 4; j++ )
+        {
+            uv = (ecp256_udbl) a[j] * b[i] + t[j] + c;
+            t[j] = (uint64_t) uv;
+            c = (uint64_t) ( uv >> 64 );
+        }
+        uv = (ecp256_udbl) t[4] + c;
+        t[4] = (uint64_t) uv;
+        t[5] = (uint64_t) ( uv >> 64 );
+
+        q = t[0] * m->n0;
+        uv = (ecp256_udbl) q * m->m[0] + t[0];
+        c = (uint64_t) ( uv >> 64 );
+        for( j = 1; j < 4; j++ )
+        {
+            uv = (ecp256_udbl) q * m->m[j] + t[j] + c;
+            t[j - 1] = (uint64_t) uv;
+            c = (uint64_t) ( uv >> 64 );
+        }
+        uv = (ecp256_udbl) t[4] + c;
+        t[3] = (uint64_t) uv;
+        t[4] = t[5] + (uint64_t) ( uv >> 64 );
+    }
+
+    /* t < 2m */
+    if( ecp256_sub( u, t, m->m ) == 0 || t[4] != 0 )
+        memcpy( r, u, sizeof( u ) );
+    else
+        memcpy( r, t, sizeof( u ) );
+}
+
+static void ecp256_mod_sqr( uint64_t r[4], const uint64_t a[4],
+                            const ecp256_mod *m )
+{
+    ecp256_mod_mul( r, a, a, m );
+}
+
+static void ecp256_to_mont( uint64_t r[4], const uint64_t a[4],
+                            const ecp256_mod *m )
+{
+    ecp256_mod_mul( r, a, m->rr, m );
+}
+
+static void ecp256_from_mont( uint64_t r[4], const uint64_t a[4],
+                              const ecp256_mod *m )
+{
+    static const uint64_t one[4] = { 1, 0, 0, 0 };
+
+    ecp256_mod_mul( r, a, one, m );
+}
+
+/*
+ * r = a^-1 in the Montgomery domain, as a^(m - 2) with 4-bit windows. The
+ * exponent is public.
+ */
+static void ecp256_mod_inv( uint64_t r[4], const uint64_t a[4],
+                            const ecp256_mod *m )
+{
+    static const uint64_t two[4] = { 2, 0, 0, 0 };
+    uint64_t tab[15][4];
+    uint64_t e[4];
+    unsigned int i, w;
+    int nib;
+
+    ecp256_sub( e, m->m, two );
+
+    memcpy( tab[0], a, sizeof( tab[0] ) );
+    for( i = 1; i < 15; i++ )
+        ecp256_mod_mul( tab[i], tab[i - 1], a, m );
+
+    /* The moduli have their top nibble set */
+    memcpy( r, tab[( e[3] >> 60 ) - 1], sizeof( tab[0] ) );
+
+    for( nib = 62; nib >= 0; nib-- )
+    {
+        for( i = 0; i < 4; i++ )
+            ecp256_mod_sqr( r, r, m );
+
+        w = (unsigned int) ( e[nib / 16] >> ( 4 * ( nib % 16 ) ) ) & 0xf;
+        if( w != 0 )
+            ecp256_mod_mul( r, r, tab[w - 1], m );
+    }
+}
+
+/*
+ * Replaces each *v[i] by its inverse, in the Montgomery domain, with one
+ * inversion: acc[i] = v[0] * ... * v[i] and v[i]^-1 = acc[i - 1] *
+ * acc[i]^-1. None of the elements may be zero.
+ */
+static void ecp256_mod_inv_batch( uint64_t *v[], size_t n,
+                                  uint64_t (*acc)[4], const ecp256_mod *m )
+{
+    uint64_t inv[4], t[4];
+    size_t i;
+
+    if( n == 0 )
+        return;
+
+    memcpy( acc[0], v[0], sizeof( acc[0] ) );
+    for( i = 1; i < n; i++ )
+        ecp256_mod_mul( acc[i], acc[i - 1], v[i], m );
+
+    ecp256_mod_inv( inv, acc[n - 1], m );
+
+    for( i = n - 1; i > 0; i-- )
+    {
+        ecp256_mod_mul( t, inv, acc[i - 1], m );
+        ecp256_mod_mul( inv, inv, v[i], m );
+        memcpy( v[i], t, sizeof( t ) );
+    }
+    memcpy( v[0], inv, sizeof( inv ) );
+}
+
+/*
+ * Point arithmetic for a = -3, in the Montgomery domain
+ */
+
+/* R = 2P, dbl-2001-b. R may be P. */
+static void ecp256_jac_dbl( ecp256_jac *R, const ecp256_jac *P,
+                            const ecp256_curve *cv )
+{
+    const ecp256_mod *fp = &cv->p;
+    uint64_t delta[4], gamma[4], beta[4], alpha[4], t[4], u[4];
+
+    ecp256_mod_sqr( delta, P->Z, fp );
+    ecp256_mod_sqr( gamma, P->Y, fp );
+    ecp256_mod_mul( beta, P->X, gamma, fp );
+
+    /* alpha = 3 * (X - delta) * (X + delta) */
+    ecp256_mod_sub( t, P->X, delta, fp );
+    ecp256_mod_add( u, P->X, delta, fp );
+    ecp256_mod_mul( alpha, t, u, fp );
+    ecp256_mod_add( t, alpha, alpha, fp );
+    ecp256_mod_add( alpha, alpha, t, fp );
+
+    /* Z3 = (Y + Z)^2 - gamma - delta */
+    ecp256_mod_add( t, P->Y, P->Z, fp );
+    ecp256_mod_sqr( t, t, fp );
+    ecp256_mod_sub( t, t, gamma, fp );
+    ecp256_mod_sub( R->Z, t, delta, fp );
+
+    /* X3 = alpha^2 - 8 * beta */
+    ecp256_mod_add( beta, beta, beta, fp );
+    ecp256_mod_add( beta, beta, beta, fp );
+    ecp256_mod_sqr( t, alpha, fp );
+    ecp256_mod_add( u, beta, beta, fp );
+    ecp256_mod_sub( R->X, t, u, fp );
+
+    /* Y3 = alpha * (4 * beta - X3) - 8 * gamma^2 */
+    ecp256_mod_sub( t, beta, R->X, fp );
+    ecp256_mod_mul( t, alpha, t, fp );
+    ecp256_mod_sqr( u, gamma, fp );
+    ecp256_mod_add( u, u, u, fp );
+    ecp256_mod_add( u, u, u, fp );
+    ecp256_mod_add( u, u, u, fp );
+    ecp256_mod_sub( R->Y, t, u, fp );
+}
+
+/* R += (x, y), madd-2007-bl */
+static void ecp256_jac_add_affine( ecp256_jac *R, const uint64_t x[4],
+                                   const uint64_t y[4],
+                                   const ecp256_curve *cv )
+{
+    const ecp256_mod *fp = &cv->p;
+    uint64_t z1z1[4], u2[4], s2[4], h[4], hh[4], i[4], j[4], r[4], v[4];
+    uint64_t t[4];
+
+    if( ecp256_is_zero( R->Z ) )
+    {
+        memcpy( R->X, x, sizeof( R->X ) );
+        memcpy( R->Y, y, sizeof( R->Y ) );
+        memcpy( R->Z, cv->one, sizeof( R->Z ) );
+        return;
+    }
+
+    ecp256_mod_sqr( z1z1, R->Z, fp );
+    ecp256_mod_mul( u2, x, z1z1, fp );
+    ecp256_mod_mul( s2, R->Z, z1z1, fp );
+    ecp256_mod_mul( s2, y, s2, fp );
+    ecp256_mod_sub( h, u2, R->X, fp );
+    ecp256_mod_sub( r, s2, R->Y, fp );
+
+    if( ecp256_is_zero( h ) )
+    {
+        if( ecp256_is_zero( r ) )
+            ecp256_jac_dbl( R, R, cv );
+        else
+            memset( R->Z, 0, sizeof( R->Z ) );
+        return;
+    }
+
+    ecp256_mod_add( r, r, r, fp );
+    ecp256_mod_sqr( hh, h, fp );
+    ecp256_mod_add( i, hh, hh, fp );
+    ecp256_mod_add( i, i, i, fp );
+    ecp256_mod_mul( j, h, i, fp );
+    ecp256_mod_mul( v, R->X, i, fp );
+
+    /* Z3 = (Z1 + H)^2 - Z1Z1 - HH */
+    ecp256_mod_add( t, R->Z, h, fp );
+    ecp256_mod_sqr( t, t, fp );
+    ecp256_mod_sub( t, t, z1z1, fp );
+    ecp256_mod_sub( R->Z, t, hh, fp );
+
+    /* X3 = r^2 - J - 2 * V */
+    ecp256_mod_sqr( t, r, fp );
+    ecp256_mod_sub( t, t, j, fp );
+    ecp256_mod_sub( t, t, v, fp );
+    ecp256_mod_sub( R->X, t, v, fp );
+
+    /* Y3 = r * (V - X3) - 2 * Y1 * J */
+    ecp256_mod_mul( j, R->Y, j, fp );
+    ecp256_mod_add( j, j, j, fp );
+    ecp256_mod_sub( t, v, R->X, fp );
+    ecp256_mod_mul( t, r, t, fp );
+    ecp256_mod_sub( R->Y, t, j, fp );
+}
+
+/* R = P + Q, add-2007-bl. R may be P or Q. */
+static void ecp256_jac_add( ecp256_jac *R, const ecp256_jac *P,
+                            const ecp256_jac *Q, const ecp256_curve *cv )
+{
+    const ecp256_mod *fp = &cv->p;
+    uint64_t z1z1[4], z2z2[4], u1[4], u2[4], s1[4], s2[4], h[4], i[4];
+    uint64_t j[4], r[4], v[4], t[4];
+
+    if( ecp256_is_zero( P->Z ) )
+    {
+        *R = *Q;
+        return;
+    }
+    if( ecp256_is_zero( Q->Z ) )
+    {
+        *R = *P;
+        return;
+    }
+
+    ecp256_mod_sqr( z1z1, P->Z, fp );
+    ecp256_mod_sqr( z2z2, Q->Z, fp );
+    ecp256_mod_mul( u1, P->X, z2z2, fp );
+    ecp256_mod_mul( u2, Q->X, z1z1, fp );
+    ecp256_mod_mul( s1, Q->Z, z2z2, fp );
+    ecp256_mod_mul( s1, P->Y, s1, fp );
+    ecp256_mod_mul( s2, P->Z, z1z1, fp );
+    ecp256_mod_mul( s2, Q->Y, s2, fp );
+    ecp256_mod_sub( h, u2, u1, fp );
+    ecp256_mod_sub( r, s2, s1, fp );
+
+    if( ecp256_is_zero( h ) )
+    {
+        if( ecp256_is_zero( r ) )
+            ecp256_jac_dbl( R, P, cv );
+        else
+            memset( R->Z, 0, sizeof( R->Z ) );
+        return;
+    }
+
+    ecp256_mod_add( r, r, r, fp );
+    ecp256_mod_add( i, h, h, fp );
+    ecp256_mod_sqr( i, i, fp );
+    ecp256_mod_mul( j, h, i, fp );
+    ecp256_mod_mul( v, u1, i, fp );
+
+    /* Z3 = ((Z1 + Z2)^2 - Z1Z1 - Z2Z2) * H */
+    ecp256_mod_add( t, P->Z, Q->Z, fp );
+    ecp256_mod_sqr( t, t, fp );
+    ecp256_mod_sub( t, t, z1z1, fp );
+    ecp256_mod_sub( t, t, z2z2, fp );
+    ecp256_mod_mul( R->Z, t, h, fp );
+
+    /* X3 = r^2 - J - 2 * V */
+    ecp256_mod_sqr( t, r, fp );
+    ecp256_mod_sub( t, t, j, fp );
+    ecp256_mod_sub( t, t, v, fp );
+    ecp256_mod_sub( R->X, t, v, fp );
+
+    /* Y3 = r * (V - X3) - 2 * S1 * J */
+    ecp256_mod_mul( j, s1, j, fp );
+    ecp256_mod_add( j, j, j, fp );
+    ecp256_mod_sub( t, v, R->X, fp );
+    ecp256_mod_mul( t, r, t, fp );
+    ecp256_mod_sub( R->Y, t, j, fp );
+}
+
+/*
+ * Verification
+ */
+typedef struct
+{
+    uint64_t u1[4];             /* Scalar of G */
+    uint64_t u2[4];             /* Scalar of Q */
+    uint64_t r[4];
+    uint64_t e[4];
+    ecp256_jac t[ECP256_WNAF_POINTS];   /* (2i + 1)Q, made affine */
+    ecp256_jac R;               /* u1 * G + u2 * Q */
+    int ret;
+}
+ecp256_state;
+
+/* Work area of mbedtls_ecp256_verify_batch() */
+typedef struct
+{
+    ecp256_state st[MBEDTLS_ECP256_BATCH];
+    uint64_t *v[MBEDTLS_ECP256_BATCH * ( ECP256_WNAF_POINTS - 1 )];
+    uint64_t acc[MBEDTLS_ECP256_BATCH * ( ECP256_WNAF_POINTS - 1 )][4];
+}
+ecp256_batch;
+
+/* An integer in [0, 2^256), non-negative */
+static int ecp256_read_mpi( uint64_t r[4], const mbedtls_mpi *X )
+{
+    unsigned char buf[32];
+    unsigned int i;
+
+    if( X->s < 0 || mbedtls_mpi_write_binary( X, buf, sizeof( buf ) ) != 0 )
+        return( -1 );
+
+    for( i = 0; i < 4; i++ )
+        GET_UINT64_BE( r[i], buf, 8 * ( 3 - i ) );
+
+    return( 0 );
+}
+
+/* The leftmost 256 bits of the hash, reduced modulo n */
+static void ecp256_read_hash( uint64_t e[4], const unsigned char *buf,
+                              size_t blen, const ecp256_mod *fn )
+{
+    unsigned char h[32] = { 0 };
+    unsigned int i;
+
+    if( blen > sizeof( h ) )
+        blen = sizeof( h );
+    if( blen > 0 )
+        memcpy( h + sizeof( h ) - blen, buf, blen );
+
+    for( i = 0; i < 4; i++ )
+        GET_UINT64_BE( e[i], h, 8 * ( 3 - i ) );
+
+    if( ecp256_cmp( e, fn->m ) >= 0 )
+        ecp256_sub( e, e, fn->m );
+}
+
+/*
+ * Reads a job into st: Q, checked to be on the curve, into st->t[0], r, e,
+ * and s into st->u1
+ */
+static int ecp256_load( const ecp256_curve *cv,
+                        const mbedtls_ecp256_verify_job *job,
+                        ecp256_state *st )
+{
+    const ecp256_mod *fp = &cv->p;
+    ecp256_jac *Q = &st->t[0];
+    uint64_t t[4], u[4];
+
+    if( ecp256_read_mpi( Q->X, &job->Q->X ) != 0 ||
+        ecp256_read_mpi( Q->Y, &job->Q->Y ) != 0 ||
+        mbedtls_mpi_cmp_int( &job->Q->Z, 1 ) != 0 ||
+        ecp256_cmp( Q->X, fp->m ) >= 0 ||
+        ecp256_cmp( Q->Y, fp->m ) >= 0 )
+        return( MBEDTLS_ERR_ECP_INVALID_KEY );
+
+    ecp256_to_mont( Q->X, Q->X, fp );
+    ecp256_to_mont( Q->Y, Q->Y, fp );
+    memcpy( Q->Z, cv->one, sizeof( Q->Z ) );
+
+    /* y^2 = x^3 - 3x + b */
+    ecp256_mod_sqr( t, Q->X, fp );
+    ecp256_mod_mul( t, t, Q->X, fp );
+    ecp256_mod_add( u, Q->X, Q->X, fp );
+    ecp256_mod_add( u, u, Q->X, fp );
+    ecp256_mod_sub( t, t, u, fp );
+    ecp256_mod_add( t, t, cv->b, fp );
+    ecp256_mod_sqr( u, Q->Y, fp );
+    if( ecp256_cmp( t, u ) != 0 )
+        return( MBEDTLS_ERR_ECP_INVALID_KEY );
+
+    /* 1 <= r, s < n */
+    if( ecp256_read_mpi( st->r, job->r ) != 0 ||
+        ecp256_read_mpi( st->u1, job->s ) != 0 ||
+        ecp256_is_zero( st->r ) || ecp256_cmp( st->r, cv->n.m ) >= 0 ||
+        ecp256_is_zero( st->u1 ) || ecp256_cmp( st->u1, cv->n.m ) >= 0 )
+        return( MBEDTLS_ERR_ECP_VERIFY_FAILED );
+
+    ecp256_read_hash( st->e, job->buf, job->blen, &cv->n );
+
+    return( 0 );
+}
+
+/* Q, 3Q, 5Q, ..., 15Q from st->t[0], in Jacobian coordinates */
+static void ecp256_wnaf_table( ecp256_state *st, const ecp256_curve *cv )
+{
+    ecp256_jac q2;
+    unsigned int i;
+
+    ecp256_jac_dbl( &q2, &st->t[0], cv );
+    for( i = 1; i < ECP256_WNAF_POINTS; i++ )
+        ecp256_jac_add( &st->t[i], &st->t[i - 1], &q2, cv );
+}
+
+/* Width-5 NAF of k: odd digits in [-15, 15], at least 4 zeros after each */
+static void ecp256_wnaf( int8_t naf[257], const uint64_t k[4] )
+{
+    uint64_t t[5];
+    uint64_t c;
+    unsigned int i, j;
+    int d;
+
+    memcpy( t, k, 4 * sizeof( uint64_t ) );
+    t[4] = 0;
+
+    for( i = 0; i < 257; i++ )
+    {
+        d = 0;
+        if( t[0] & 1 )
+        {
+            d = (int) ( t[0] & ( ( 1 << ECP256_WNAF_WIDTH ) - 1 ) );
+            if( d >= 1 << ( ECP256_WNAF_WIDTH - 1 ) )
+                d -= 1 << ECP256_WNAF_WIDTH;
+
+            /* t -= d: clears the low bits, or carries into the upper ones */
+            if( d > 0 )
+            {
+                t[0] -= (uint64_t) d;
+            }
+            else
+            {
+                c = (uint64_t) -d;
+                for( j = 0; j < 5 && c != 0; j++ )
+                {
+                    t[j] += c;
+                    c = t[j] < c;
+                }
+            }
+        }
+        naf[i] = (int8_t) d;
+
+        for( j = 0; j < 4; j++ )
+            t[j] = ( t[j] >> 1 ) | ( t[j + 1] << 63 );
+        t[4] >>= 1;
+    }
+}
+
+/* st->R = u1 * G + u2 * Q, with st->t affine */
+static void ecp256_mul_shamir( const ecp256_curve *cv, ecp256_state *st )
+{
+    ecp256_jac *R = &st->R;
+    const uint64_t *pt;
+    uint64_t ny[4];
+    int8_t naf[257];
+    unsigned int idx, j;
+    int i, d;
+
+    ecp256_wnaf( naf, st->u2 );
+    memset( R, 0, sizeof( *R ) );
+
+    for( i = 256; i >= 0; i-- )
+    {
+        if( !ecp256_is_zero( R->Z ) )
+            ecp256_jac_dbl( R, R, cv );
+
+        d = naf[i];
+        if( d > 0 )
+        {
+            ecp256_jac_add_affine( R, st->t[d >> 1].X, st->t[d >> 1].Y, cv );
+        }
+        else if( d < 0 )
+        {
+            memset( ny, 0, sizeof( ny ) );
+            ecp256_mod_sub( ny, ny, st->t[-d >> 1].Y, &cv->p );
+            ecp256_jac_add_affine( R, st->t[-d >> 1].X, ny, cv );
+        }
+
+        if( i < ECP256_COMB_SPACING )
+        {
+            idx = 0;
+            for( j = 0; j < ECP256_COMB_TEETH; j++ )
+            {
+                unsigned int bit = ECP256_COMB_SPACING * j + (unsigned int) i;
+                idx |= (unsigned int) ( ( st->u1[bit / 64] >>
+                                          ( bit % 64 ) ) & 1 ) << j;
+            }
+            if( idx != 0 )
+            {
+                pt = cv->comb[idx - 1];
+                ecp256_jac_add_affine( R, pt, pt + 4, cv );
+            }
+        }
+    }
+}
+
+/*
+ * Verifies n <= MBEDTLS_ECP256_BATCH jobs. v and acc have room for
+ * n * (ECP256_WNAF_POINTS - 1) elements.
+ */
+static void ecp256_verify_chunk( const ecp256_curve *cv,
+                                 mbedtls_ecp256_verify_job *jobs, size_t n,
+                                 ecp256_state *st, uint64_t *v[],
+                                 uint64_t (*acc)[4] )
+{
+    const ecp256_mod *fp = &cv->p;
+    const ecp256_mod *fn = &cv->n;
+    uint64_t t[4];
+    size_t k, nv;
+    unsigned int i;
+
+    for( k = 0; k < n; k++ )
+        st[k].ret = ecp256_load( cv, &jobs[k], &st[k] );
+
+    /*
+     * ECDSA: u1 = e / s, u2 = r / s. SM2DSA: u1 = s, u2 = r + s, which
+     * must not be zero.
+     */
+    if( cv->sm2 )
+    {
+        for( k = 0; k < n; k++ )
+        {
+            if( st[k].ret != 0 )
+                continue;
+            ecp256_mod_add( st[k].u2, st[k].r, st[k].u1, fn );
+            if( ecp256_is_zero( st[k].u2 ) )
+                st[k].ret = MBEDTLS_ERR_ECP_VERIFY_FAILED;
+        }
+    }
+    else
+    {
+        for( k = 0, nv = 0; k < n; k++ )
+        {
+            if( st[k].ret != 0 )
+                continue;
+            ecp256_to_mont( st[k].u1, st[k].u1, fn );
+            v[nv++] = st[k].u1;
+        }
+        ecp256_mod_inv_batch( v, nv, acc, fn );
+        for( k = 0; k < n; k++ )
+        {
+            if( st[k].ret != 0 )
+                continue;
+            ecp256_mod_mul( st[k].u2, st[k].r, st[k].u1, fn );
+            ecp256_mod_mul( st[k].u1, st[k].e, st[k].u1, fn );
+        }
+    }
+
+    /* The odd multiples of the keys, made affine together */
+    for( k = 0, nv = 0; k < n; k++ )
+    {
+        if( st[k].ret != 0 )
+            continue;
+        ecp256_wnaf_table( &st[k], cv );
+        for( i = 1; i < ECP256_WNAF_POINTS; i++ )
+            v[nv++] = st[k].t[i].Z;
+    }
+    ecp256_mod_inv_batch( v, nv, acc, fp );
+    for( k = 0; k < n; k++ )
+    {
+        if( st[k].ret != 0 )
+            continue;
+        for( i = 1; i < ECP256_WNAF_POINTS; i++ )
+        {
+            ecp256_jac *T = &st[k].t[i];
+
+            ecp256_mod_sqr( t, T->Z, fp );
+            ecp256_mod_mul( T->X, T->X, t, fp );
+            ecp256_mod_mul( t, t, T->Z, fp );
+            ecp256_mod_mul( T->Y, T->Y, t, fp );
+        }
+    }
+
+    for( k = 0; k < n; k++ )
+    {
+        if( st[k].ret != 0 )
+            continue;
+        ecp256_mul_shamir( cv, &st[k] );
+        if( ecp256_is_zero( st[k].R.Z ) )
+            st[k].ret = MBEDTLS_ERR_ECP_VERIFY_FAILED;
+    }
+
+    /*
+     * x1 of the results. ECDSA: x1 mod n = r. SM2DSA: e + x1 mod n = r.
+     * p < 2n on both curves.
+     */
+    for( k = 0, nv = 0; k < n; k++ )
+    {
+        if( st[k].ret == 0 )
+            v[nv++] = st[k].R.Z;
+    }
+    ecp256_mod_inv_batch( v, nv, acc, fp );
+    for( k = 0; k < n; k++ )
+    {
+        if( st[k].ret == 0 )
+        {
+            ecp256_mod_sqr( t, st[k].R.Z, fp );
+            ecp256_mod_mul( t, st[k].R.X, t, fp );
+            ecp256_from_mont( t, t, fp );
+            if( ecp256_cmp( t, fn->m ) >= 0 )
+                ecp256_sub( t, t, fn->m );
+            if( cv->sm2 )
+                ecp256_mod_add( t, t, st[k].e, fn );
+            if( ecp256_cmp( t, st[k].r ) != 0 )
+                st[k].ret = MBEDTLS_ERR_ECP_VERIFY_FAILED;
+        }
+        jobs[k].ret = st[k].ret;
+    }
+}
+
+int mbedtls_ecp256_verify( mbedtls_ecp_group_id grp_id,
+                           const unsigned char *buf,
+                           size_t blen,
+                           const mbedtls_ecp_point *Q,
+                           const mbedtls_mpi *r,
+                           const mbedtls_mpi *s )
+{
+    const ecp256_curve *cv = ecp256_curve_get( grp_id );
+    mbedtls_ecp256_verify_job job;
+    ecp256_state st;
+    uint64_t *v[ECP256_WNAF_POINTS - 1];
+    uint64_t acc[ECP256_WNAF_POINTS - 1][4];
+
+    if( cv == NULL )
+        return( MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE );
+
+    job.buf = buf;
+    job.blen = blen;
+    job.Q = Q;
+    job.r = r;
+    job.s = s;
+    ecp256_verify_chunk( cv, &job, 1, &st, v, acc );
+
+    return( job.ret );
+}
+
+int mbedtls_ecp256_verify_batch( mbedtls_ecp_group_id grp_id,
+                                 mbedtls_ecp256_verify_job *jobs,
+                                 size_t n )
+{
+    const ecp256_curve *cv = ecp256_curve_get( grp_id );
+    ecp256_batch *ws;
+    size_t i, chunk;
+    int ret = 0;
+
+    if( cv == NULL )
+        return( MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE );
+
+    ws = mbedtls_calloc( 1, sizeof( ecp256_batch ) );
+    if( ws == NULL )
+        return( MBEDTLS_ERR_ECP_ALLOC_FAILED );
+
+    for( i = 0; i < n; i += chunk )
+    {
+        chunk = n - i < MBEDTLS_ECP256_BATCH ? n - i : MBEDTLS_ECP256_BATCH;
+        ecp256_verify_chunk( cv, jobs + i, chunk, ws->st, ws->v, ws->acc );
+    }
+
+    for( i = 0; i < n; i++ )
+    {
+        if( jobs[i].ret != 0 )
+            ret = MBEDTLS_ERR_ECP_VERIFY_FAILED;
+    }
+
+    mbedtls_free( ws );
+
+    return( ret );
+}
+
+#if defined(MBEDTLS_SELF_TEST)
+/*
+ * Q, hash, r and s. ECDSA: RFC 6979, A.2.5, SHA-256 of "sample". SM2DSA:
+ * SM3 of "message digest", signed with an independent implementation.
+ */
+static const unsigned char ecp256_test_vec[2][5][32] =
+{
+    {
+        { 0x60, 0xFE, 0xD4, 0xBA, 0x25, 0x5A, 0x9D, 0x31,
+          0xC9, 0x61, 0xEB, 0x74, 0xC6, 0x35, 0x6D, 0x68,
+          0xC0, 0x49, 0xB8, 0x92, 0x3B, 0x61, 0xFA, 0x6C,
+          0xE6, 0x69, 0x62, 0x2E, 0x60, 0xF2, 0x9F, 0xB6 },
+        { 0x79, 0x03, 0xFE, 0x10, 0x08, 0xB8, 0xBC, 0x99,
+          0xA4, 0x1A, 0xE9, 0xE9, 0x56, 0x28, 0xBC, 0x64,
+          0xF2, 0xF1, 0xB2, 0x0C, 0x2D, 0x7E, 0x9F, 0x51,
+          0x77, 0xA3, 0xC2, 0x94, 0xD4, 0x46, 0x22, 0x99 },
+        { 0xAF, 0x2B, 0xDB, 0xE1, 0xAA, 0x9B, 0x6E, 0xC1,
+          0xE2, 0xAD, 0xE1, 0xD6, 0x94, 0xF4, 0x1F, 0xC7,
+          0x1A, 0x83, 0x1D, 0x02, 0x68, 0xE9, 0x89, 0x15,
+          0x62, 0x11, 0x3D, 0x8A, 0x62, 0xAD, 0xD1, 0xBF },
+        { 0xEF, 0xD4, 0x8B, 0x2A, 0xAC, 0xB6, 0xA8, 0xFD,
+          0x11, 0x40, 0xDD, 0x9C, 0xD4, 0x5E, 0x81, 0xD6,
+          0x9D, 0x2C, 0x87, 0x7B, 0x56, 0xAA, 0xF9, 0x91,
+          0xC3, 0x4D, 0x0E, 0xA8, 0x4E, 0xAF, 0x37, 0x16 },
+        { 0xF7, 0xCB, 0x1C, 0x94, 0x2D, 0x65, 0x7C, 0x41,
+          0xD4, 0x36, 0xC7, 0xA1, 0xB6, 0xE2, 0x9F, 0x65,
+          0xF3, 0xE9, 0x00, 0xDB, 0xB9, 0xAF, 0xF4, 0x06,
+          0x4D, 0xC4, 0xAB, 0x2F, 0x84, 0x3A, 0xCD, 0xA8 },
+    },
+    {
+        { 0x02, 0x22, 0x9B, 0xE9, 0x79, 0xA1, 0x01, 0x3A,
+          0xA6, 0xB1, 0x5D, 0x6B, 0xC6, 0x30, 0x10, 0xDB,
+          0x83, 0x3F, 0xD9, 0x1F, 0xE5, 0x60, 0xFC, 0xF9,
+          0x7B, 0x5F, 0x03, 0xE8, 0x15, 0x91, 0x2C, 0xD4 },
+        { 0x64, 0x8B, 0xAA, 0xFC, 0xA4, 0xEB, 0x98, 0x1B,
+          0xE0, 0x02, 0x77, 0x40, 0xD1, 0x78, 0xD8, 0x61,
+          0xD6, 0x23, 0x35, 0xA9, 0xA8, 0x96, 0x07, 0xA8,
+          0x27, 0x55, 0x30, 0x78, 0x73, 0xFD, 0xA7, 0x3E },
+        { 0xC5, 0x22, 0xA9, 0x42, 0xE8, 0x9B, 0xD8, 0x0D,
+          0x97, 0xDD, 0x66, 0x6E, 0x7A, 0x55, 0x31, 0xB3,
+          0x61, 0x88, 0xC9, 0x81, 0x71, 0x49, 0xE9, 0xB2,
+          0x58, 0xDF, 0xE5, 0x1E, 0xCE, 0x98, 0xED, 0x77 },
+        { 0x80, 0xAC, 0xF3, 0x3A, 0xD4, 0x1D, 0xC3, 0x0D,
+          0xC8, 0x41, 0x92, 0xD5, 0x38, 0x0E, 0x54, 0x1C,
+          0x9B, 0x7D, 0x6B, 0xE6, 0x0B, 0xC2, 0xD9, 0x43,
+          0x59, 0xF4, 0x9D, 0x74, 0x96, 0x1C, 0x1A, 0x91 },
+        { 0x97, 0x58, 0xBF, 0x65, 0x72, 0x24, 0xA3, 0x16,
+          0x66, 0xC6, 0x48, 0x90, 0xAB, 0x13, 0x19, 0x0C,
+          0xB9, 0x9F, 0x75, 0xB1, 0xFB, 0x22, 0x34, 0x3C,
+          0x99, 0x80, 0xFA, 0xD7, 0x79, 0x23, 0xE7, 0xDF },
+    },
+};
+
+static const mbedtls_ecp_group_id ecp256_test_grp[2] =
+{
+    MBEDTLS_ECP_DP_SECP256R1,
+    MBEDTLS_ECP_DP_SM2P256V1,
+};
+
+#define ECP256_TEST_JOBS    ( MBEDTLS_ECP256_BATCH + 3 )
+
+int mbedtls_ecp256_self_test( int verbose )
+{
+    mbedtls_ecp256_verify_job jobs[ECP256_TEST_JOBS];
+    mbedtls_ecp_point Q;
+    mbedtls_mpi r, s, r1;
+    unsigned char hash[ECP256_TEST_JOBS][32];
+    unsigned int i, c;
+    int ret = 0;
+
+    mbedtls_ecp_point_init( &Q );
+    mbedtls_mpi_init( &r );
+    mbedtls_mpi_init( &s );
+    mbedtls_mpi_init( &r1 );
+
+    for( c = 0; c < 2; c++ )
+    {
+        if( verbose != 0 )
+            mbedtls_printf( "  ECP256 %s test: ",
+                            c == 0 ? "ECDSA P-256" : "SM2DSA" );
+
+        if( mbedtls_mpi_read_binary( &Q.X, ecp256_test_vec[c][0], 32 ) != 0 ||
+            mbedtls_mpi_read_binary( &Q.Y, ecp256_test_vec[c][1], 32 ) != 0 ||
+            mbedtls_mpi_lset( &Q.Z, 1 ) != 0 ||
+            mbedtls_mpi_read_binary( &r, ecp256_test_vec[c][3], 32 ) != 0 ||
+            mbedtls_mpi_read_binary( &s, ecp256_test_vec[c][4], 32 ) != 0 ||
+            mbedtls_mpi_add_int( &r1, &r, 1 ) != 0 )
+            goto fail;
+
+        if( mbedtls_ecp256_verify( ecp256_test_grp[c],
+                                   ecp256_test_vec[c][2], 32,
+                                   &Q, &r, &s ) != 0 )
+            goto fail;
+
+        /*
+         * A batch of the signature, of altered hashes and of an altered
+         * r, which must fail alone
+         */
+        for( i = 0; i < ECP256_TEST_JOBS; i++ )
+        {
+            memcpy( hash[i], ecp256_test_vec[c][2], 32 );
+            if( i % 3 == 1 )
+                hash[i][i % 32] ^= 0x01;
+            jobs[i].buf = hash[i];
+            jobs[i].blen = 32;
+            jobs[i].Q = &Q;
+            jobs[i].r = i == ECP256_TEST_JOBS - 1 ? &r1 : &r;
+            jobs[i].s = &s;
+        }
+
+        if( mbedtls_ecp256_verify_batch( ecp256_test_grp[c], jobs,
+                                         ECP256_TEST_JOBS ) !=
+            MBEDTLS_ERR_ECP_VERIFY_FAILED )
+            goto fail;
+
+        for( i = 0; i < ECP256_TEST_JOBS; i++ )
+        {
+            int expect = i % 3 == 1 || i == ECP256_TEST_JOBS - 1 ?
+                         MBEDTLS_ERR_ECP_VERIFY_FAILED : 0;
+
+            if( jobs[i].ret != expect )
+                goto fail;
+        }
+
+        if( verbose != 0 )
+            mbedtls_printf( "passed\n" );
+    }
+
+    if( verbose != 0 )
+        mbedtls_printf( "\n" );
+
+    goto exit;
+
+fail:
+    if( verbose != 0 )
+        mbedtls_printf( "failed\n" );
+    ret = 1;
+
+exit:
+    mbedtls_ecp_point_free( &Q );
+    mbedtls_mpi_free( &r );
+    mbedtls_mpi_free( &s );
+    mbedtls_mpi_free( &r1 );
+    return( ret );
+}
+
+#endif /* MBEDTLS_SELF_TEST */
+
+#endif /* MBEDTLS_ECP256_C */
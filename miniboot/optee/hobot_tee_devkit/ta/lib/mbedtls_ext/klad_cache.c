@@ -0,0 +1,524 @@
+/*
+ *  Cache of the keys unwrapped by the key ladder
+ *
+ *  Copyright (c) 2026, D-Robotics
+ *  SPDX-License-Identifier: BSD-2-Clause
+ */
+/*
+ *  The slots are few, a lookup compares the digest of the secure key with
+ *  each of them and remembers the least recently used one on the way, it
+ *  is the one a miss evicts. Secure keys are told apart by the digest of
+ *  the part of ek1 || ek2 || ek3 the ladder reads, so that an unused tail
+ *  of ek3 does not matter, and by the root key selection and the key
+ *  length.
+ */
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#if defined(MBEDTLS_KLAD_CACHE_C)
+
+#include "mbedtls/klad_cache.h"
+#include "mbedtls/aes.h"
+#include "mbedtls/sha256.h"
+#include "mbedtls/platform_util.h"
+
+#include <string.h>
+
+#if defined(MBEDTLS_SELF_TEST)
+#if defined(MBEDTLS_ZUC_C)
+#include "mbedtls/zuc.h"
+#endif
+#if defined(MBEDTLS_SM4_C)
+#include "mbedtls/sm4.h"
+#endif
+#endif /* MBEDTLS_SELF_TEST */
+
+#if defined(MBEDTLS_PLATFORM_C)
+#include "mbedtls/platform.h"
+#else
+#include <stdio.h>
+#include <stdlib.h>
+#define mbedtls_calloc    calloc
+#define mbedtls_free      free
+#define mbedtls_printf    printf
+#endif /* MBEDTLS_PLATFORM_C */
+
+/*
+ * The cache of the session being served, see
+ * mbedtls_klad_cache_set_default()
+ */
+static mbedtls_klad_cache_context *klad_cache_default;
+
+void mbedtls_klad_cache_init( mbedtls_klad_cache_context *ctx )
+{
+    if( ctx == NULL )
+        return;
+
+    memset( ctx, 0, sizeof( mbedtls_klad_cache_context ) );
+}
+
+void mbedtls_klad_cache_flush( mbedtls_klad_cache_context *ctx )
+{
+    if( ctx == NULL || ctx->slots == NULL )
+        return;
+
+    mbedtls_platform_zeroize( ctx->slots,
+                              ctx->nslots * sizeof( mbedtls_klad_cache_slot ) );
+}
+
+void mbedtls_klad_cache_free( mbedtls_klad_cache_context *ctx )
+{
+    if( ctx == NULL )
+        return;
+
+    if( klad_cache_default == ctx )
+        klad_cache_default = NULL;
+
+    mbedtls_klad_cache_flush( ctx );
+    mbedtls_free( ctx->slots );
+    mbedtls_platform_zeroize( ctx, sizeof( mbedtls_klad_cache_context ) );
+}
+
+int mbedtls_klad_cache_setup( mbedtls_klad_cache_context *ctx,
+                              size_t nslots,
+                              mbedtls_klad_unwrap_t f_unwrap,
+                              void *p_ladder )
+{
+    if( ctx == NULL || f_unwrap == NULL || ctx->slots != NULL )
+        return( MBEDTLS_ERR_KLAD_CACHE_BAD_INPUT_DATA );
+
+    if( nslots == 0 )
+        nslots = MBEDTLS_KLAD_CACHE_SLOTS;
+
+    ctx->slots = mbedtls_calloc( nslots, sizeof( mbedtls_klad_cache_slot ) );
+    if( ctx->slots == NULL )
+        return( MBEDTLS_ERR_KLAD_CACHE_ALLOC_FAILED );
+
+    ctx->nslots = nslots;
+    ctx->f_unwrap = f_unwrap;
+    ctx->p_ladder = p_ladder;
+
+    return( 0 );
+}
+
+void mbedtls_klad_cache_set_default( mbedtls_klad_cache_context *ctx )
+{
+    klad_cache_default = ctx;
+}
+
+mbedtls_klad_cache_context *mbedtls_klad_cache_get_default( void )
+{
+    return( klad_cache_default );
+}
+
+int mbedtls_klad_cache_unwrap( mbedtls_klad_cache_context *ctx,
+                               const mbedtls_klad_seckey_t *key,
+                               unsigned char *out, size_t *olen )
+{
+    mbedtls_klad_cache_slot *slot, *victim;
+    unsigned char digest[32];
+    size_t i, len;
+    int ret;
+
+    if( key == NULL || out == NULL || olen == NULL )
+        return( MBEDTLS_ERR_KLAD_CACHE_BAD_INPUT_DATA );
+    if( ctx == NULL )
+        ctx = klad_cache_default;
+    if( ctx == NULL )
+        return( MBEDTLS_ERR_KLAD_CACHE_NO_LADDER );
+    if( ctx->slots == NULL ||
+        ( key->ek3bits != 128 && key->ek3bits != 256 ) )
+        return( MBEDTLS_ERR_KLAD_CACHE_BAD_INPUT_DATA );
+
+    len = key->ek3bits / 8;
+
+    ret = mbedtls_sha256_ret( key->eks, 32 + len, digest, 0 );
+    if( ret != 0 )
+        return( ret );
+
+    victim = ctx->slots;
+    for( i = 0; i < ctx->nslots; i++ )
+    {
+        slot = ctx->slots + i;
+
+        if( slot->stamp != 0 && slot->sel == key->sel &&
+            slot->ek3bits == key->ek3bits &&
+            memcmp( slot->digest, digest, sizeof( digest ) ) == 0 )
+        {
+            slot->stamp = ++ctx->clock;
+            ctx->hits++;
+            memcpy( out, slot->key, len );
+            *olen = len;
+            return( 0 );
+        }
+
+        /* Empty slots have the oldest stamp */
+        if( slot->stamp < victim->stamp )
+            victim = slot;
+    }
+
+    ctx->misses++;
+
+    ret = ctx->f_unwrap( ctx->p_ladder, key, out );
+    if( ret != 0 )
+    {
+        mbedtls_platform_zeroize( out, len );
+        return( ret );
+    }
+
+    if( victim->stamp != 0 )
+    {
+        ctx->evictions++;
+        mbedtls_platform_zeroize( victim->key, sizeof( victim->key ) );
+    }
+
+    victim->stamp = ++ctx->clock;
+    victim->sel = key->sel;
+    victim->ek3bits = key->ek3bits;
+    memcpy( victim->digest, digest, sizeof( digest ) );
+    memcpy( victim->key, out, len );
+    *olen = len;
+
+    return( 0 );
+}
+
+/*
+ * Software key ladder
+ */
+void mbedtls_klad_emul_setup( mbedtls_klad_emul_context *ctx,
+                              const unsigned char model_key[16],
+                              const unsigned char root_key[16] )
+{
+    memcpy( ctx->model_key, model_key, sizeof( ctx->model_key ) );
+    memcpy( ctx->root_key, root_key, sizeof( ctx->root_key ) );
+}
+
+void mbedtls_klad_emul_free( mbedtls_klad_emul_context *ctx )
+{
+    if( ctx == NULL )
+        return;
+
+    mbedtls_platform_zeroize( ctx, sizeof( mbedtls_klad_emul_context ) );
+}
+
+/*
+ * One rung of the ladder: len Bytes of input under the 128-bit key k
+ */
+static int klad_emul_ecb( const unsigned char k[16], int mode,
+                          const unsigned char *input, size_t len,
+                          unsigned char *output )
+{
+    mbedtls_aes_context aes;
+    size_t i;
+    int ret;
+
+    mbedtls_aes_init( &aes );
+
+    if( mode == MBEDTLS_AES_DECRYPT )
+        ret = mbedtls_aes_setkey_dec( &aes, k, 128 );
+    else
+        ret = mbedtls_aes_setkey_enc( &aes, k, 128 );
+
+    for( i = 0; ret == 0 && i < len; i += 16 )
+        ret = mbedtls_aes_crypt_ecb( &aes, mode, input + i, output + i );
+
+    mbedtls_aes_free( &aes );
+    return( ret );
+}
+
+static const unsigned char *klad_emul_root(
+                                        const mbedtls_klad_emul_context *ctx,
+                                        mbedtls_klad_key_sel_t sel )
+{
+    switch( sel )
+    {
+        case MBEDTLS_KL_KEY_MODEL:
+            return( ctx->model_key );
+        case MBEDTLS_KL_KEY_ROOT:
+            return( ctx->root_key );
+        default:
+            return( NULL );
+    }
+}
+
+int mbedtls_klad_emul_unwrap( void *p_ladder,
+                              const mbedtls_klad_seckey_t *key,
+                              unsigned char *out )
+{
+    const mbedtls_klad_emul_context *ctx = p_ladder;
+    const unsigned char *root;
+    unsigned char k1[16], k2[16];
+    int ret;
+
+    if( ctx == NULL || key == NULL || out == NULL )
+        return( MBEDTLS_ERR_KLAD_CACHE_BAD_INPUT_DATA );
+
+    root = klad_emul_root( ctx, key->sel );
+    if( root == NULL || ( key->ek3bits != 128 && key->ek3bits != 256 ) )
+        return( MBEDTLS_ERR_KLAD_CACHE_BAD_INPUT_DATA );
+
+    if( ( ret = klad_emul_ecb( root, MBEDTLS_AES_DECRYPT,
+                               key->ek1, 16, k1 ) ) != 0 ||
+        ( ret = klad_emul_ecb( k1, MBEDTLS_AES_DECRYPT,
+                               key->ek2, 16, k2 ) ) != 0 )
+        goto cleanup;
+
+    ret = klad_emul_ecb( k2, MBEDTLS_AES_DECRYPT,
+                         key->ek3, key->ek3bits / 8, out );
+
+cleanup:
+    mbedtls_platform_zeroize( k1, sizeof( k1 ) );
+    mbedtls_platform_zeroize( k2, sizeof( k2 ) );
+    return( ret );
+}
+
+int mbedtls_klad_emul_wrap( const mbedtls_klad_emul_context *ctx,
+                            mbedtls_klad_key_sel_t sel,
+                            const unsigned char key1[16],
+                            const unsigned char key2[16],
+                            const unsigned char *k, int kbits,
+                            mbedtls_klad_seckey_t *key )
+{
+    const unsigned char *root;
+    int ret;
+
+    if( ctx == NULL || key1 == NULL || key2 == NULL || k == NULL ||
+        key == NULL )
+        return( MBEDTLS_ERR_KLAD_CACHE_BAD_INPUT_DATA );
+
+    root = klad_emul_root( ctx, sel );
+    if( root == NULL || ( kbits != 128 && kbits != 256 ) )
+        return( MBEDTLS_ERR_KLAD_CACHE_BAD_INPUT_DATA );
+
+    memset( key, 0, sizeof( mbedtls_klad_seckey_t ) );
+    key->sel = sel;
+    key->ek3bits = kbits;
+
+    if( ( ret = klad_emul_ecb( root, MBEDTLS_AES_ENCRYPT,
+                               key1, 16, key->ek1 ) ) != 0 ||
+        ( ret = klad_emul_ecb( key1, MBEDTLS_AES_ENCRYPT,
+                               key2, 16, key->ek2 ) ) != 0 )
+        return( ret );
+
+    return( klad_emul_ecb( key2, MBEDTLS_AES_ENCRYPT,
+                           k, kbits / 8, key->ek3 ) );
+}
+
+#if defined(MBEDTLS_SELF_TEST)
+
+/*
+ * Root keys of the software ladder, and the key a ladder of AES-128
+ * decryptions gives for ek1 || ek2 || ek3 = 0x20, 0x21, ..., 0x5f under
+ * the device root key
+ */
+static const unsigned char klad_test_model_key[16] =
+{
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+    0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f
+};
+
+static const unsigned char klad_test_root_key[16] =
+{
+    0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17,
+    0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f
+};
+
+static const unsigned char klad_test_key[32] =
+{
+    0xda, 0xd4, 0x1a, 0xdb, 0xe9, 0x25, 0x0c, 0x75,
+    0x7c, 0xd4, 0x60, 0x91, 0x59, 0x22, 0x07, 0x68,
+    0x22, 0xe1, 0xae, 0xf1, 0x7d, 0x23, 0xa3, 0xca,
+    0x93, 0xd2, 0x37, 0x4c, 0xc1, 0xed, 0x93, 0x3d
+};
+
+/*
+ * Key i of the LRU test, wrapped under the model key
+ */
+static int klad_test_seckey( const mbedtls_klad_emul_context *emul,
+                             unsigned char i, unsigned char k[16],
+                             mbedtls_klad_seckey_t *key )
+{
+    unsigned char key1[16], key2[16];
+
+    memset( key1, 0xa0 + i, sizeof( key1 ) );
+    memset( key2, 0xb0 + i, sizeof( key2 ) );
+    memset( k, 0xc0 + i, 16 );
+
+    return( mbedtls_klad_emul_wrap( emul, MBEDTLS_KL_KEY_MODEL, key1, key2,
+                                    k, 128, key ) );
+}
+
+/*
+ * Unwraps key i of the LRU test and checks the key and the counters
+ */
+static int klad_test_lookup( mbedtls_klad_cache_context *ctx,
+                             const mbedtls_klad_seckey_t *keys,
+                             unsigned char k[][16], int i,
+                             uint32_t hits, uint32_t misses,
+                             uint32_t evictions )
+{
+    unsigned char out[MBEDTLS_KLAD_KEY_MAX];
+    size_t olen;
+
+    if( mbedtls_klad_cache_unwrap( ctx, keys + i, out, &olen ) != 0 ||
+        olen != 16 || memcmp( out, k[i], 16 ) != 0 ||
+        ctx->hits != hits || ctx->misses != misses ||
+        ctx->evictions != evictions )
+        return( 1 );
+
+    return( 0 );
+}
+
+int mbedtls_klad_cache_self_test( int verbose )
+{
+    mbedtls_klad_emul_context emul;
+    mbedtls_klad_cache_context ctx;
+    mbedtls_klad_cache_context *saved = klad_cache_default;
+    mbedtls_klad_seckey_t keys[3];
+    unsigned char k[3][16];
+    unsigned char out[MBEDTLS_KLAD_KEY_MAX];
+    size_t i, olen;
+    int ret = 1;
+
+    mbedtls_klad_emul_setup( &emul, klad_test_model_key, klad_test_root_key );
+    mbedtls_klad_cache_init( &ctx );
+
+    if( verbose != 0 )
+        mbedtls_printf( "  KLAD software ladder test: " );
+
+    memset( keys, 0, sizeof( keys ) );
+    keys[0].sel = MBEDTLS_KL_KEY_ROOT;
+    for( i = 0; i < sizeof( keys[0].eks ); i++ )
+        keys[0].eks[i] = (unsigned char) ( 0x20 + i );
+
+    keys[0].ek3bits = 256;
+    if( mbedtls_klad_emul_unwrap( &emul, keys, out ) != 0 ||
+        memcmp( out, klad_test_key, 32 ) != 0 )
+        goto fail;
+
+    keys[0].ek3bits = 128;
+    if( mbedtls_klad_emul_unwrap( &emul, keys, out ) != 0 ||
+        memcmp( out, klad_test_key, 16 ) != 0 )
+        goto fail;
+
+    if( mbedtls_klad_emul_wrap( &emul, MBEDTLS_KL_KEY_MODEL,
+                                klad_test_root_key, klad_test_model_key,
+                                klad_test_key, 256, keys ) != 0 ||
+        mbedtls_klad_emul_unwrap( &emul, keys, out ) != 0 ||
+        memcmp( out, klad_test_key, 32 ) != 0 )
+        goto fail;
+
+    if( verbose != 0 )
+        mbedtls_printf( "passed\n  KLAD cache LRU test: " );
+
+    /* Two slots for three keys: 0 stays, 1 and 2 evict each other */
+    for( i = 0; i < 3; i++ )
+        if( klad_test_seckey( &emul, (unsigned char) i, k[i],
+                              keys + i ) != 0 )
+            goto fail;
+
+    if( mbedtls_klad_cache_setup( &ctx, 2, mbedtls_klad_emul_unwrap,
+                                  &emul ) != 0 ||
+        klad_test_lookup( &ctx, keys, k, 0, 0, 1, 0 ) != 0 ||
+        klad_test_lookup( &ctx, keys, k, 0, 1, 1, 0 ) != 0 ||
+        klad_test_lookup( &ctx, keys, k, 1, 1, 2, 0 ) != 0 ||
+        klad_test_lookup( &ctx, keys, k, 0, 2, 2, 0 ) != 0 ||
+        klad_test_lookup( &ctx, keys, k, 2, 2, 3, 1 ) != 0 ||
+        klad_test_lookup( &ctx, keys, k, 0, 3, 3, 1 ) != 0 ||
+        klad_test_lookup( &ctx, keys, k, 1, 3, 4, 2 ) != 0 )
+        goto fail;
+
+    /* Same eks under the other root key */
+    keys[2] = keys[0];
+    keys[2].sel = MBEDTLS_KL_KEY_ROOT;
+    if( mbedtls_klad_cache_unwrap( &ctx, keys + 2, out, &olen ) != 0 ||
+        ctx.misses != 5 || memcmp( out, k[0], 16 ) == 0 )
+        goto fail;
+
+    /* Flushed slots are cleared and miss */
+    mbedtls_klad_cache_flush( &ctx );
+    for( i = 0; i < sizeof( mbedtls_klad_cache_slot ) * ctx.nslots; i++ )
+        if( ( (unsigned char *) ctx.slots )[i] != 0 )
+            goto fail;
+    if( klad_test_lookup( &ctx, keys, k, 0, 3, 6, 3 ) != 0 )
+        goto fail;
+
+    if( verbose != 0 )
+        mbedtls_printf( "passed\n  KLAD cache setseckey test: " );
+
+    mbedtls_klad_cache_set_default( &ctx );
+
+#if defined(MBEDTLS_ZUC_C)
+    {
+        unsigned char buf[2][64];
+
+        memset( buf, 0, sizeof( buf ) );
+        if( mbedtls_eea3_crypt( k[1], 0x12345678, 3, 1, sizeof( buf[0] ),
+                                buf[0], buf[0] ) != 0 ||
+            mbedtls_eea3_crypt_seckey( keys + 1, 0x12345678, 3, 1,
+                                       sizeof( buf[1] ), buf[1],
+                                       buf[1] ) != 0 ||
+            memcmp( buf[0], buf[1], sizeof( buf[0] ) ) != 0 )
+            goto fail;
+    }
+#endif /* MBEDTLS_ZUC_C */
+
+#if defined(MBEDTLS_SM4_C)
+    {
+        mbedtls_sm4_context sm4[2];
+        mbedtls_sm4_sec_key_t sec;
+        int err;
+
+        memset( &sec, 0, sizeof( sec ) );
+        sec.sel = MBEDTLS_SM4_KL_KEY_MODEL;
+        sec.ek3bits = 128;
+        memcpy( sec.eks, keys[1].eks, sizeof( sec.eks ) );
+
+        mbedtls_sm4_init( sm4 );
+        mbedtls_sm4_init( sm4 + 1 );
+        err = mbedtls_sm4_setkey_dec( sm4, k[1], 128 ) != 0 ||
+              mbedtls_sm4_setseckey_dec( sm4 + 1, &sec ) != 0 ||
+              memcmp( sm4[0].rk, sm4[1].rk, sizeof( sm4[0].rk ) ) != 0;
+        mbedtls_sm4_free( sm4 );
+        mbedtls_sm4_free( sm4 + 1 );
+        if( err != 0 )
+            goto fail;
+    }
+#endif /* MBEDTLS_SM4_C */
+
+    /* All of them were unwrapped once */
+    if( ctx.misses != 7 )
+        goto fail;
+
+#if defined(MBEDTLS_ZUC_C)
+    mbedtls_klad_cache_set_default( NULL );
+    if( mbedtls_eea3_crypt_seckey( keys + 1, 0, 0, 0, 0, NULL,
+                                   NULL ) != MBEDTLS_ERR_ZUC_HW_ACCEL_FAILED )
+        goto fail;
+#endif /* MBEDTLS_ZUC_C */
+
+    if( verbose != 0 )
+        mbedtls_printf( "passed\n\n" );
+
+    ret = 0;
+    goto exit;
+
+fail:
+    if( verbose != 0 )
+        mbedtls_printf( "failed\n" );
+
+exit:
+    mbedtls_klad_cache_free( &ctx );
+    mbedtls_klad_emul_free( &emul );
+    mbedtls_klad_cache_set_default( saved );
+    mbedtls_platform_zeroize( out, sizeof( out ) );
+    return( ret );
+}
+
+#endif /* MBEDTLS_SELF_TEST */
+
+#endif /* MBEDTLS_KLAD_CACHE_C */
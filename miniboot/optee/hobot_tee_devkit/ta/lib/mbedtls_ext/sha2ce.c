@@ -0,0 +1,1115 @@
+/*
+ *  SHA-224/256 and SHA-384/512 with the Armv8 SHA2 and SHA512 instructions
+ *
+ *  Copyright (c) 2026, D-Robotics
+ *  SPDX-License-Identifier: BSD-2-Clause
+ */
+/*
+ *  FIPS 180-4 Secure Hash Standard (SHS)
+ *
+ *  The compression functions take any number of blocks, so that update()
+ *  hashes the whole blocks of its input where they are and only copies a
+ *  partial block to the context. They are:
+ *
+ *  - SHA256H/SHA256H2/SHA256SU0/SHA256SU1 for SHA-256 and SHA512H/
+ *    SHA512H2/SHA512SU0/SHA512SU1 for SHA-512, when the core implements
+ *    them;
+ *  - for SHA-512 without its instructions, the 80 words of the message
+ *    schedule computed two at a time with NEON ahead of scalar rounds;
+ *  - portable C otherwise.
+ *
+ *  The choice is made at compile time when the TA targets the instructions,
+ *  see CFG_TA_CRYPTO_WITH_CE, and at run time from ID_AA64ISAR0_EL1 when
+ *  the OP-TEE core lets TAs read it, see CFG_TA_CRYPTO_CE_DETECT.
+ */
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#if defined(MBEDTLS_SHA2CE_C)
+
+#include "mbedtls/sha2ce.h"
+#include "mbedtls/platform_util.h"
+
+#include <string.h>
+
+#if defined(MBEDTLS_SELF_TEST)
+#if defined(MBEDTLS_PLATFORM_C)
+#include "mbedtls/platform.h"
+#else
+#include <stdio.h>
+#define mbedtls_printf printf
+#endif /* MBEDTLS_PLATFORM_C */
+#endif /* MBEDTLS_SELF_TEST */
+
+/*
+ * SHA-256 needs the SHA2 instructions of the Cryptographic Extension,
+ * SHA-512 the SHA512 instructions of Armv8.2, which cores with the former
+ * often lack. Each is built when the compiler targets it or when its
+ * presence is probed at run time; in the latter case only the functions
+ * using it are compiled for it.
+ */
+#if defined(__aarch64__) && defined(CFG_TA_FLOAT_SUPPORT)
+#define SHA2CE_NEON
+#if defined(__ARM_FEATURE_SHA2) || defined(__ARM_FEATURE_CRYPTO)
+#define SHA256CE_INSN
+#define SHA256CE_TARGET
+#elif defined(CFG_TA_CRYPTO_CE_DETECT)
+#define SHA256CE_INSN
+#define SHA256CE_DETECT
+#define SHA256CE_TARGET __attribute__(( target( "+crypto" ) ))
+#endif
+#if defined(__ARM_FEATURE_SHA512)
+#define SHA512CE_INSN
+#define SHA512CE_TARGET
+#elif defined(CFG_TA_CRYPTO_CE_DETECT)
+#define SHA512CE_INSN
+#define SHA512CE_DETECT
+#define SHA512CE_TARGET __attribute__(( target( "arch=armv8.2-a+sha3" ) ))
+#endif
+#endif
+
+#if defined(SHA2CE_NEON)
+#include <arm_neon.h>
+#endif
+
+#if defined(SHA256CE_DETECT) || defined(SHA512CE_DETECT)
+#include <arm64_user_sysreg.h>
+#endif
+
+/*
+ * 32-bit integer manipulation macros (big endian)
+ */
+#ifndef GET_UINT32_BE
+#define GET_UINT32_BE(n,b,i)                            \
+do {                                                    \
+    (n) = ( (uint32_t) (b)[(i)    ] << 24 )             \
+        | ( (uint32_t) (b)[(i) + 1] << 16 )             \
+        | ( (uint32_t) (b)[(i) + 2] <<  8 )             \
+        | ( (uint32_t) (b)[(i) + 3]       );            \
+} while( 0 )
+#endif
+
+#ifndef PUT_UINT32_BE
+#define PUT_UINT32_BE(n,b,i)                            \
+do {                                                    \
+    (b)[(i)    ] = (unsigned char) ( (n) >> 24 );       \
+    (b)[(i) + 1] = (unsigned char) ( (n) >> 16 );       \
+    (b)[(i) + 2] = (unsigned char) ( (n) >>  8 );       \
+    (b)[(i) + 3] = (unsigned char) ( (n)       );       \
+} while( 0 )
+#endif
+
+/*
+ * 64-bit integer manipulation macros (big endian)
+ */
+#ifndef GET_UINT64_BE
+#define GET_UINT64_BE(n,b,i)                            \
+do {                                                    \
+    (n) = ( (uint64_t) (b)[(i)    ] << 56 )             \
+        | ( (uint64_t) (b)[(i) + 1] << 48 )             \
+        | ( (uint64_t) (b)[(i) + 2] << 40 )             \
+        | ( (uint64_t) (b)[(i) + 3] << 32 )             \
+        | ( (uint64_t) (b)[(i) + 4] << 24 )             \
+        | ( (uint64_t) (b)[(i) + 5] << 16 )             \
+        | ( (uint64_t) (b)[(i) + 6] <<  8 )             \
+        | ( (uint64_t) (b)[(i) + 7]       );            \
+} while( 0 )
+#endif
+
+#ifndef PUT_UINT64_BE
+#define PUT_UINT64_BE(n,b,i)                            \
+do {                                                    \
+    (b)[(i)    ] = (unsigned char) ( (n) >> 56 );       \
+    (b)[(i) + 1] = (unsigned char) ( (n) >> 48 );       \
+    (b)[(i) + 2] = (unsigned char) ( (n) >> 40 );       \
+    (b)[(i) + 3] = (unsigned char) ( (n) >> 32 );       \
+    (b)[(i) + 4] = (unsigned char) ( (n) >> 24 );       \
+    (b)[(i) + 5] = (unsigned char) ( (n) >> 16 );       \
+    (b)[(i) + 6] = (unsigned char) ( (n) >>  8 );       \
+    (b)[(i) + 7] = (unsigned char) ( (n)       );       \
+} while( 0 )
+#endif
+
+#if defined(SHA256CE_DETECT) || defined(SHA512CE_DETECT)
+/*
+ * ID_AA64ISAR0_EL1.SHA2 is 1 with SHA256H and friends, 2 with SHA512H and
+ * friends as well
+ */
+static unsigned int sha2ce_isar0_sha2( void )
+{
+    static int sha2 = -1;
+
+    if( sha2 < 0 )
+        sha2 = (int) ( ( read_id_aa64isar0_el1() >> 12 ) & 0xf );
+
+    return( (unsigned int) sha2 );
+}
+#endif
+
+static int sha256ce_use_insn( void )
+{
+#if defined(SHA256CE_DETECT)
+    return( sha2ce_isar0_sha2() >= 1 );
+#elif defined(SHA256CE_INSN)
+    return( 1 );
+#else
+    return( 0 );
+#endif
+}
+
+static int sha512ce_use_insn( void )
+{
+#if defined(SHA512CE_DETECT)
+    return( sha2ce_isar0_sha2() >= 2 );
+#elif defined(SHA512CE_INSN)
+    return( 1 );
+#else
+    return( 0 );
+#endif
+}
+
+int mbedtls_sha256ce_has_support( void )
+{
+    return( sha256ce_use_insn() );
+}
+
+int mbedtls_sha512ce_has_support( void )
+{
+    if( sha512ce_use_insn() )
+        return( 2 );
+#if defined(SHA2CE_NEON)
+    return( 1 );
+#else
+    return( 0 );
+#endif
+}
+
+/*
+ * SHA-256
+ */
+static const uint32_t K256[64] =
+{
+    0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5,
+    0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+    0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3,
+    0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+    0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC,
+    0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+    0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7,
+    0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+    0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13,
+    0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+    0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3,
+    0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+    0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5,
+    0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+    0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208,
+    0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2,
+};
+
+#define ROR32(x,n)  ( ( (x) >> (n) ) | ( (x) << ( 32 - (n) ) ) )
+
+#define S256_0(x)   ( ROR32( x,  7 ) ^ ROR32( x, 18 ) ^ ( (x) >>  3 ) )
+#define S256_1(x)   ( ROR32( x, 17 ) ^ ROR32( x, 19 ) ^ ( (x) >> 10 ) )
+#define S256_2(x)   ( ROR32( x,  2 ) ^ ROR32( x, 13 ) ^ ROR32( x, 22 ) )
+#define S256_3(x)   ( ROR32( x,  6 ) ^ ROR32( x, 11 ) ^ ROR32( x, 25 ) )
+
+#define F0(x,y,z)   ( ( (x) & (y) ) | ( (z) & ( (x) | (y) ) ) )
+#define F1(x,y,z)   ( (z) ^ ( (x) & ( (y) ^ (z) ) ) )
+
+/* The 16 words of the message schedule in use, W[t] in w[t % 16] */
+#define W256(t)                                                         \
+    ( w[(t) & 15] += S256_1( w[( (t) - 2 ) & 15] ) +                    \
+                     w[( (t) - 7 ) & 15] +                              \
+                     S256_0( w[( (t) - 15 ) & 15] ) )
+
+#define P256(a,b,c,d,e,f,g,h,x,K)                                       \
+do {                                                                    \
+    uint32_t t1 = (h) + S256_3( e ) + F1( e, f, g ) + (K) + (x);        \
+    uint32_t t2 = S256_2( a ) + F0( a, b, c );                          \
+    (d) += t1;                                                          \
+    (h) = t1 + t2;                                                      \
+} while( 0 )
+
+static void sha256_blocks_c( uint32_t state[8],
+                             const unsigned char *data,
+                             size_t blocks )
+{
+    uint32_t w[16];
+    uint32_t a, b, c, d, e, f, g, h;
+    unsigned int t;
+
+    for( ; blocks > 0; blocks--, data += 64 )
+    {
+        for( t = 0; t < 16; t++ )
+            GET_UINT32_BE( w[t], data, 4 * t );
+
+        a = state[0]; b = state[1]; c = state[2]; d = state[3];
+        e = state[4]; f = state[5]; g = state[6]; h = state[7];
+
+        for( t = 0; t < 16; t += 8 )
+        {
+            P256( a, b, c, d, e, f, g, h, w[t    ], K256[t    ] );
+            P256( h, a, b, c, d, e, f, g, w[t + 1], K256[t + 1] );
+            P256( g, h, a, b, c, d, e, f, w[t + 2], K256[t + 2] );
+            P256( f, g, h, a, b, c, d, e, w[t + 3], K256[t + 3] );
+            P256( e, f, g, h, a, b, c, d, w[t + 4], K256[t + 4] );
+            P256( d, e, f, g, h, a, b, c, w[t + 5], K256[t + 5] );
+            P256( c, d, e, f, g, h, a, b, w[t + 6], K256[t + 6] );
+            P256( b, c, d, e, f, g, h, a, w[t + 7], K256[t + 7] );
+        }
+
+        for( ; t < 64; t += 8 )
+        {
+            P256( a, b, c, d, e, f, g, h, W256( t     ), K256[t    ] );
+            P256( h, a, b, c, d, e, f, g, W256( t + 1 ), K256[t + 1] );
+            P256( g, h, a, b, c, d, e, f, W256( t + 2 ), K256[t + 2] );
+            P256( f, g, h, a, b, c, d, e, W256( t + 3 ), K256[t + 3] );
+            P256( e, f, g, h, a, b, c, d, W256( t + 4 ), K256[t + 4] );
+            P256( d, e, f, g, h, a, b, c, W256( t + 5 ), K256[t + 5] );
+            P256( c, d, e, f, g, h, a, b, W256( t + 6 ), K256[t + 6] );
+            P256( b, c, d, e, f, g, h, a, W256( t + 7 ), K256[t + 7] );
+        }
+
+        state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+        state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+    }
+
+    mbedtls_platform_zeroize( w, sizeof( w ) );
+}
+
+#if defined(SHA256CE_INSN)
+/*
+ * SHA256H and SHA256H2 do four rounds on the state halves ABCD and EFGH;
+ * SHA256SU0 and SHA256SU1 compute the next four words of the schedule
+ * from the last sixteen.
+ */
+SHA256CE_TARGET
+static void sha256_blocks_insn( uint32_t state[8],
+                                const unsigned char *data,
+                                size_t blocks )
+{
+    uint32x4_t abcd = vld1q_u32( state );
+    uint32x4_t efgh = vld1q_u32( state + 4 );
+    uint32x4_t abcd0, efgh0, abcd1, wk;
+    uint32x4_t m[4];
+    unsigned int i;
+
+    for( ; blocks > 0; blocks--, data += 64 )
+    {
+        for( i = 0; i < 4; i++ )
+            m[i] = vreinterpretq_u32_u8(
+                       vrev32q_u8( vld1q_u8( data + 16 * i ) ) );
+
+        abcd0 = abcd;
+        efgh0 = efgh;
+
+        for( i = 0; i < 16; i++ )
+        {
+            wk = vaddq_u32( m[i & 3], vld1q_u32( K256 + 4 * i ) );
+            if( i < 12 )
+                m[i & 3] = vsha256su1q_u32(
+                               vsha256su0q_u32( m[i & 3],
+                                                m[( i + 1 ) & 3] ),
+                               m[( i + 2 ) & 3], m[( i + 3 ) & 3] );
+
+            abcd1 = abcd;
+            abcd = vsha256hq_u32( abcd, efgh, wk );
+            efgh = vsha256h2q_u32( efgh, abcd1, wk );
+        }
+
+        abcd = vaddq_u32( abcd, abcd0 );
+        efgh = vaddq_u32( efgh, efgh0 );
+    }
+
+    vst1q_u32( state, abcd );
+    vst1q_u32( state + 4, efgh );
+}
+#endif /* SHA256CE_INSN */
+
+static void sha256_blocks( uint32_t state[8],
+                           const unsigned char *data,
+                           size_t blocks )
+{
+#if defined(SHA256CE_INSN)
+    if( sha256ce_use_insn() )
+    {
+        sha256_blocks_insn( state, data, blocks );
+        return;
+    }
+#endif
+    sha256_blocks_c( state, data, blocks );
+}
+
+void mbedtls_sha256ce_init( mbedtls_sha256ce_context *ctx )
+{
+    memset( ctx, 0, sizeof( mbedtls_sha256ce_context ) );
+}
+
+void mbedtls_sha256ce_free( mbedtls_sha256ce_context *ctx )
+{
+    if( ctx == NULL )
+        return;
+
+    mbedtls_platform_zeroize( ctx, sizeof( mbedtls_sha256ce_context ) );
+}
+
+void mbedtls_sha256ce_clone( mbedtls_sha256ce_context *dst,
+                             const mbedtls_sha256ce_context *src )
+{
+    *dst = *src;
+}
+
+int mbedtls_sha256ce_starts_ret( mbedtls_sha256ce_context *ctx, int is224 )
+{
+    static const uint32_t iv[2][8] =
+    {
+        { 0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A,
+          0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19 },
+        { 0xC1059ED8, 0x367CD507, 0x3070DD17, 0xF70E5939,
+          0xFFC00B31, 0x68581511, 0x64F98FA7, 0xBEFA4FA4 },
+    };
+
+    if( is224 != 0 && is224 != 1 )
+        return( MBEDTLS_ERR_SHA256_BAD_INPUT_DATA );
+
+    ctx->total = 0;
+    memcpy( ctx->state, iv[is224], sizeof( ctx->state ) );
+    ctx->is224 = is224;
+
+    return( 0 );
+}
+
+int mbedtls_sha256ce_update_ret( mbedtls_sha256ce_context *ctx,
+                                 const unsigned char *input,
+                                 size_t ilen )
+{
+    size_t left, fill;
+
+    if( ilen == 0 )
+        return( 0 );
+
+    left = (size_t) ( ctx->total & 0x3F );
+    fill = 64 - left;
+    ctx->total += ilen;
+
+    if( left != 0 && ilen >= fill )
+    {
+        memcpy( ctx->buffer + left, input, fill );
+        sha256_blocks( ctx->state, ctx->buffer, 1 );
+        input += fill;
+        ilen  -= fill;
+        left = 0;
+    }
+
+    if( ilen >= 64 )
+    {
+        sha256_blocks( ctx->state, input, ilen / 64 );
+        input += ilen & ~(size_t) 0x3F;
+        ilen  &= 0x3F;
+    }
+
+    if( ilen > 0 )
+        memcpy( ctx->buffer + left, input, ilen );
+
+    return( 0 );
+}
+
+int mbedtls_sha256ce_finish_ret( mbedtls_sha256ce_context *ctx,
+                                 unsigned char output[32] )
+{
+    uint64_t bits = ctx->total << 3;
+    size_t used = (size_t) ( ctx->total & 0x3F );
+    unsigned int i;
+
+    ctx->buffer[used++] = 0x80;
+
+    if( used > 56 )
+    {
+        memset( ctx->buffer + used, 0, 64 - used );
+        sha256_blocks( ctx->state, ctx->buffer, 1 );
+        used = 0;
+    }
+
+    memset( ctx->buffer + used, 0, 56 - used );
+    PUT_UINT32_BE( (uint32_t) ( bits >> 32 ), ctx->buffer, 56 );
+    PUT_UINT32_BE( (uint32_t) bits, ctx->buffer, 60 );
+    sha256_blocks( ctx->state, ctx->buffer, 1 );
+
+    for( i = 0; i < ( ctx->is224 ? 7u : 8u ); i++ )
+        PUT_UINT32_BE( ctx->state[i], output, 4 * i );
+
+    return( 0 );
+}
+
+int mbedtls_sha256ce_ret( const unsigned char *input,
+                          size_t ilen,
+                          unsigned char output[32],
+                          int is224 )
+{
+    mbedtls_sha256ce_context ctx;
+    int ret;
+
+    mbedtls_sha256ce_init( &ctx );
+
+    if( ( ret = mbedtls_sha256ce_starts_ret( &ctx, is224 ) ) == 0 &&
+        ( ret = mbedtls_sha256ce_update_ret( &ctx, input, ilen ) ) == 0 )
+        ret = mbedtls_sha256ce_finish_ret( &ctx, output );
+
+    mbedtls_sha256ce_free( &ctx );
+
+    return( ret );
+}
+
+/*
+ * SHA-512
+ */
+static const uint64_t K512[80] =
+{
+    0x428A2F98D728AE22ULL, 0x7137449123EF65CDULL,
+    0xB5C0FBCFEC4D3B2FULL, 0xE9B5DBA58189DBBCULL,
+    0x3956C25BF348B538ULL, 0x59F111F1B605D019ULL,
+    0x923F82A4AF194F9BULL, 0xAB1C5ED5DA6D8118ULL,
+    0xD807AA98A3030242ULL, 0x12835B0145706FBEULL,
+    0x243185BE4EE4B28CULL, 0x550C7DC3D5FFB4E2ULL,
+    0x72BE5D74F27B896FULL, 0x80DEB1FE3B1696B1ULL,
+    0x9BDC06A725C71235ULL, 0xC19BF174CF692694ULL,
+    0xE49B69C19EF14AD2ULL, 0xEFBE4786384F25E3ULL,
+    0x0FC19DC68B8CD5B5ULL, 0x240CA1CC77AC9C65ULL,
+    0x2DE92C6F592B0275ULL, 0x4A7484AA6EA6E483ULL,
+    0x5CB0A9DCBD41FBD4ULL, 0x76F988DA831153B5ULL,
+    0x983E5152EE66DFABULL, 0xA831C66D2DB43210ULL,
+    0xB00327C898FB213FULL, 0xBF597FC7BEEF0EE4ULL,
+    0xC6E00BF33DA88FC2ULL, 0xD5A79147930AA725ULL,
+    0x06CA6351E003826FULL, 0x142929670A0E6E70ULL,
+    0x27B70A8546D22FFCULL, 0x2E1B21385C26C926ULL,
+    0x4D2C6DFC5AC42AEDULL, 0x53380D139D95B3DFULL,
+    0x650A73548BAF63DEULL, 0x766A0ABB3C77B2A8ULL,
+    0x81C2C92E47EDAEE6ULL, 0x92722C851482353BULL,
+    0xA2BFE8A14CF10364ULL, 0xA81A664BBC423001ULL,
+    0xC24B8B70D0F89791ULL, 0xC76C51A30654BE30ULL,
+    0xD192E819D6EF5218ULL, 0xD69906245565A910ULL,
+    0xF40E35855771202AULL, 0x106AA07032BBD1B8ULL,
+    0x19A4C116B8D2D0C8ULL, 0x1E376C085141AB53ULL,
+    0x2748774CDF8EEB99ULL, 0x34B0BCB5E19B48A8ULL,
+    0x391C0CB3C5C95A63ULL, 0x4ED8AA4AE3418ACBULL,
+    0x5B9CCA4F7763E373ULL, 0x682E6FF3D6B2B8A3ULL,
+    0x748F82EE5DEFB2FCULL, 0x78A5636F43172F60ULL,
+    0x84C87814A1F0AB72ULL, 0x8CC702081A6439ECULL,
+    0x90BEFFFA23631E28ULL, 0xA4506CEBDE82BDE9ULL,
+    0xBEF9A3F7B2C67915ULL, 0xC67178F2E372532BULL,
+    0xCA273ECEEA26619CULL, 0xD186B8C721C0C207ULL,
+    0xEADA7DD6CDE0EB1EULL, 0xF57D4F7FEE6ED178ULL,
+    0x06F067AA72176FBAULL, 0x0A637DC5A2C898A6ULL,
+    0x113F9804BEF90DAEULL, 0x1B710B35131C471BULL,
+    0x28DB77F523047D84ULL, 0x32CAAB7B40C72493ULL,
+    0x3C9EBE0A15C9BEBCULL, 0x431D67C49C100D4CULL,
+    0x4CC5D4BECB3E42B6ULL, 0x597F299CFC657E2AULL,
+    0x5FCB6FAB3AD6FAECULL, 0x6C44198C4A475817ULL,
+};
+
+#define ROR64(x,n)  ( ( (x) >> (n) ) | ( (x) << ( 64 - (n) ) ) )
+
+#define S512_0(x)   ( ROR64( x,  1 ) ^ ROR64( x,  8 ) ^ ( (x) >> 7 ) )
+#define S512_1(x)   ( ROR64( x, 19 ) ^ ROR64( x, 61 ) ^ ( (x) >> 6 ) )
+#define S512_2(x)   ( ROR64( x, 28 ) ^ ROR64( x, 34 ) ^ ROR64( x, 39 ) )
+#define S512_3(x)   ( ROR64( x, 14 ) ^ ROR64( x, 18 ) ^ ROR64( x, 41 ) )
+
+/* One round; wk is W[t] + K[t] */
+#define P512(a,b,c,d,e,f,g,h,wk)                                        \
+do {                                                                    \
+    uint64_t t1 = (h) + S512_3( e ) + F1( e, f, g ) + (wk);             \
+    uint64_t t2 = S512_2( a ) + F0( a, b, c );                          \
+    (d) += t1;                                                          \
+    (h) = t1 + t2;                                                      \
+} while( 0 )
+
+#if defined(SHA2CE_NEON)
+/*
+ * sigma0 and sigma1 of two words at once. W[t] and W[t + 1] only depend
+ * on words up to W[t - 1], so the schedule advances by pairs, each of
+ * eight registers holding two consecutive words.
+ */
+#define SHA512_NEON_ROR(x,n)    \
+    vsriq_n_u64( vshlq_n_u64( (x), 64 - (n) ), (x), (n) )
+
+static inline uint64x2_t sha512_neon_s0( uint64x2_t x )
+{
+    return( veorq_u64( veorq_u64( SHA512_NEON_ROR( x, 1 ),
+                                  SHA512_NEON_ROR( x, 8 ) ),
+                       vshrq_n_u64( x, 7 ) ) );
+}
+
+static inline uint64x2_t sha512_neon_s1( uint64x2_t x )
+{
+    return( veorq_u64( veorq_u64( SHA512_NEON_ROR( x, 19 ),
+                                  SHA512_NEON_ROR( x, 61 ) ),
+                       vshrq_n_u64( x, 6 ) ) );
+}
+
+/* W[t] + K[t] for the 80 rounds of a block */
+static void sha512_schedule( uint64_t wk[80], const unsigned char *data )
+{
+    uint64x2_t w[8];
+    unsigned int t, j;
+
+    for( j = 0; j < 8; j++ )
+    {
+        w[j] = vreinterpretq_u64_u8( vrev64q_u8( vld1q_u8( data + 16 * j ) ) );
+        vst1q_u64( wk + 2 * j, vaddq_u64( w[j], vld1q_u64( K512 + 2 * j ) ) );
+    }
+
+    /* w[j] holds W[t - 16] and W[t - 15] and receives W[t] and W[t + 1] */
+    for( t = 16; t < 80; t += 2 )
+    {
+        j = ( t / 2 ) & 7;
+        w[j] = vaddq_u64(
+                   vaddq_u64( w[j],
+                              sha512_neon_s0( vextq_u64( w[j],
+                                                         w[( j + 1 ) & 7],
+                                                         1 ) ) ),
+                   vaddq_u64( vextq_u64( w[( j + 4 ) & 7],
+                                         w[( j + 5 ) & 7], 1 ),
+                              sha512_neon_s1( w[( j + 7 ) & 7] ) ) );
+        vst1q_u64( wk + t, vaddq_u64( w[j], vld1q_u64( K512 + t ) ) );
+    }
+}
+#else
+static void sha512_schedule( uint64_t wk[80], const unsigned char *data )
+{
+    uint64_t w[80];
+    unsigned int t;
+
+    for( t = 0; t < 16; t++ )
+        GET_UINT64_BE( w[t], data, 8 * t );
+
+    for( ; t < 80; t++ )
+        w[t] = S512_1( w[t - 2] ) + w[t - 7] + S512_0( w[t - 15] ) + w[t - 16];
+
+    for( t = 0; t < 80; t++ )
+        wk[t] = w[t] + K512[t];
+
+    mbedtls_platform_zeroize( w, sizeof( w ) );
+}
+#endif /* SHA2CE_NEON */
+
+static void sha512_blocks_c( uint64_t state[8],
+                             const unsigned char *data,
+                             size_t blocks )
+{
+    uint64_t wk[80];
+    uint64_t a, b, c, d, e, f, g, h;
+    unsigned int t;
+
+    for( ; blocks > 0; blocks--, data += 128 )
+    {
+        sha512_schedule( wk, data );
+
+        a = state[0]; b = state[1]; c = state[2]; d = state[3];
+        e = state[4]; f = state[5]; g = state[6]; h = state[7];
+
+        for( t = 0; t < 80; t += 8 )
+        {
+            P512( a, b, c, d, e, f, g, h, wk[t    ] );
+            P512( h, a, b, c, d, e, f, g, wk[t + 1] );
+            P512( g, h, a, b, c, d, e, f, wk[t + 2] );
+            P512( f, g, h, a, b, c, d, e, wk[t + 3] );
+            P512( e, f, g, h, a, b, c, d, wk[t + 4] );
+            P512( d, e, f, g, h, a, b, c, wk[t + 5] );
+            P512( c, d, e, f, g, h, a, b, wk[t + 6] );
+            P512( b, c, d, e, f, g, h, a, wk[t + 7] );
+        }
+
+        state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+        state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+    }
+
+    mbedtls_platform_zeroize( wk, sizeof( wk ) );
+}
+
+#if defined(SHA512CE_INSN)
+/*
+ * SHA512H and SHA512H2 do two rounds on the state, kept as the pairs AB,
+ * CD, EF and GH whose roles rotate by one pair every two rounds;
+ * SHA512SU0 and SHA512SU1 compute the next two words of the schedule.
+ */
+#define SHA512_INSN_ROUNDS(s,k,ab,cd,ef,gh)                             \
+do {                                                                    \
+    uint64x2_t sum_, tmp_;                                              \
+    sum_ = vaddq_u64( (s), vld1q_u64( K512 + (k) ) );                   \
+    sum_ = vaddq_u64( vextq_u64( sum_, sum_, 1 ), (gh) );               \
+    tmp_ = vsha512hq_u64( sum_, vextq_u64( (ef), (gh), 1 ),             \
+                          vextq_u64( (cd), (ef), 1 ) );                 \
+    (gh) = vsha512h2q_u64( tmp_, (cd), (ab) );                          \
+    (cd) = vaddq_u64( (cd), tmp_ );                                     \
+} while( 0 )
+
+#define SHA512_INSN_SCHED(s0,s1,s4,s5,s7)                               \
+    (s0) = vsha512su1q_u64( vsha512su0q_u64( (s0), (s1) ), (s7),        \
+                            vextq_u64( (s4), (s5), 1 ) )
+
+SHA512CE_TARGET
+static void sha512_blocks_insn( uint64_t state[8],
+                                const unsigned char *data,
+                                size_t blocks )
+{
+    uint64x2_t ab = vld1q_u64( state );
+    uint64x2_t cd = vld1q_u64( state + 2 );
+    uint64x2_t ef = vld1q_u64( state + 4 );
+    uint64x2_t gh = vld1q_u64( state + 6 );
+    uint64x2_t ab0, cd0, ef0, gh0;
+    uint64x2_t s[8];
+    unsigned int t;
+
+    for( ; blocks > 0; blocks--, data += 128 )
+    {
+        for( t = 0; t < 8; t++ )
+            s[t] = vreinterpretq_u64_u8(
+                       vrev64q_u8( vld1q_u8( data + 16 * t ) ) );
+
+        ab0 = ab; cd0 = cd; ef0 = ef; gh0 = gh;
+
+        for( t = 0; ; t += 16 )
+        {
+            SHA512_INSN_ROUNDS( s[0], t     , ab, cd, ef, gh );
+            SHA512_INSN_ROUNDS( s[1], t +  2, gh, ab, cd, ef );
+            SHA512_INSN_ROUNDS( s[2], t +  4, ef, gh, ab, cd );
+            SHA512_INSN_ROUNDS( s[3], t +  6, cd, ef, gh, ab );
+            SHA512_INSN_ROUNDS( s[4], t +  8, ab, cd, ef, gh );
+            SHA512_INSN_ROUNDS( s[5], t + 10, gh, ab, cd, ef );
+            SHA512_INSN_ROUNDS( s[6], t + 12, ef, gh, ab, cd );
+            SHA512_INSN_ROUNDS( s[7], t + 14, cd, ef, gh, ab );
+
+            if( t == 64 )
+                break;
+
+            SHA512_INSN_SCHED( s[0], s[1], s[4], s[5], s[7] );
+            SHA512_INSN_SCHED( s[1], s[2], s[5], s[6], s[0] );
+            SHA512_INSN_SCHED( s[2], s[3], s[6], s[7], s[1] );
+            SHA512_INSN_SCHED( s[3], s[4], s[7], s[0], s[2] );
+            SHA512_INSN_SCHED( s[4], s[5], s[0], s[1], s[3] );
+            SHA512_INSN_SCHED( s[5], s[6], s[1], s[2], s[4] );
+            SHA512_INSN_SCHED( s[6], s[7], s[2], s[3], s[5] );
+            SHA512_INSN_SCHED( s[7], s[0], s[3], s[4], s[6] );
+        }
+
+        ab = vaddq_u64( ab, ab0 );
+        cd = vaddq_u64( cd, cd0 );
+        ef = vaddq_u64( ef, ef0 );
+        gh = vaddq_u64( gh, gh0 );
+    }
+
+    vst1q_u64( state, ab );
+    vst1q_u64( state + 2, cd );
+    vst1q_u64( state + 4, ef );
+    vst1q_u64( state + 6, gh );
+}
+#endif /* SHA512CE_INSN */
+
+static void sha512_blocks( uint64_t state[8],
+                           const unsigned char *data,
+                           size_t blocks )
+{
+#if defined(SHA512CE_INSN)
+    if( sha512ce_use_insn() )
+    {
+        sha512_blocks_insn( state, data, blocks );
+        return;
+    }
+#endif
+    sha512_blocks_c( state, data, blocks );
+}
+
+void mbedtls_sha512ce_init( mbedtls_sha512ce_context *ctx )
+{
+    memset( ctx, 0, sizeof( mbedtls_sha512ce_context ) );
+}
+
+void mbedtls_sha512ce_free( mbedtls_sha512ce_context *ctx )
+{
+    if( ctx == NULL )
+        return;
+
+    mbedtls_platform_zeroize( ctx, sizeof( mbedtls_sha512ce_context ) );
+}
+
+void mbedtls_sha512ce_clone( mbedtls_sha512ce_context *dst,
+                             const mbedtls_sha512ce_context *src )
+{
+    *dst = *src;
+}
+
+int mbedtls_sha512ce_starts_ret( mbedtls_sha512ce_context *ctx, int is384 )
+{
+    static const uint64_t iv[2][8] =
+    {
+        { 0x6A09E667F3BCC908ULL, 0xBB67AE8584CAA73BULL,
+          0x3C6EF372FE94F82BULL, 0xA54FF53A5F1D36F1ULL,
+          0x510E527FADE682D1ULL, 0x9B05688C2B3E6C1FULL,
+          0x1F83D9ABFB41BD6BULL, 0x5BE0CD19137E2179ULL },
+        { 0xCBBB9D5DC1059ED8ULL, 0x629A292A367CD507ULL,
+          0x9159015A3070DD17ULL, 0x152FECD8F70E5939ULL,
+          0x67332667FFC00B31ULL, 0x8EB44A8768581511ULL,
+          0xDB0C2E0D64F98FA7ULL, 0x47B5481DBEFA4FA4ULL },
+    };
+
+    if( is384 != 0 && is384 != 1 )
+        return( MBEDTLS_ERR_SHA512_BAD_INPUT_DATA );
+
+    ctx->total[0] = 0;
+    ctx->total[1] = 0;
+    memcpy( ctx->state, iv[is384], sizeof( ctx->state ) );
+    ctx->is384 = is384;
+
+    return( 0 );
+}
+
+int mbedtls_sha512ce_update_ret( mbedtls_sha512ce_context *ctx,
+                                 const unsigned char *input,
+                                 size_t ilen )
+{
+    size_t left, fill;
+
+    if( ilen == 0 )
+        return( 0 );
+
+    left = (size_t) ( ctx->total[0] & 0x7F );
+    fill = 128 - left;
+
+    ctx->total[0] += (uint64_t) ilen;
+    if( ctx->total[0] < (uint64_t) ilen )
+        ctx->total[1]++;
+
+    if( left != 0 && ilen >= fill )
+    {
+        memcpy( ctx->buffer + left, input, fill );
+        sha512_blocks( ctx->state, ctx->buffer, 1 );
+        input += fill;
+        ilen  -= fill;
+        left = 0;
+    }
+
+    if( ilen >= 128 )
+    {
+        sha512_blocks( ctx->state, input, ilen / 128 );
+        input += ilen & ~(size_t) 0x7F;
+        ilen  &= 0x7F;
+    }
+
+    if( ilen > 0 )
+        memcpy( ctx->buffer + left, input, ilen );
+
+    return( 0 );
+}
+
+int mbedtls_sha512ce_finish_ret( mbedtls_sha512ce_context *ctx,
+                                 unsigned char output[64] )
+{
+    uint64_t high = ( ctx->total[0] >> 61 ) | ( ctx->total[1] << 3 );
+    uint64_t low  = ctx->total[0] << 3;
+    size_t used = (size_t) ( ctx->total[0] & 0x7F );
+    unsigned int i;
+
+    ctx->buffer[used++] = 0x80;
+
+    if( used > 112 )
+    {
+        memset( ctx->buffer + used, 0, 128 - used );
+        sha512_blocks( ctx->state, ctx->buffer, 1 );
+        used = 0;
+    }
+
+    memset( ctx->buffer + used, 0, 112 - used );
+    PUT_UINT64_BE( high, ctx->buffer, 112 );
+    PUT_UINT64_BE( low, ctx->buffer, 120 );
+    sha512_blocks( ctx->state, ctx->buffer, 1 );
+
+    for( i = 0; i < ( ctx->is384 ? 6u : 8u ); i++ )
+        PUT_UINT64_BE( ctx->state[i], output, 8 * i );
+
+    return( 0 );
+}
+
+int mbedtls_sha512ce_ret( const unsigned char *input,
+                          size_t ilen,
+                          unsigned char output[64],
+                          int is384 )
+{
+    mbedtls_sha512ce_context ctx;
+    int ret;
+
+    mbedtls_sha512ce_init( &ctx );
+
+    if( ( ret = mbedtls_sha512ce_starts_ret( &ctx, is384 ) ) == 0 &&
+        ( ret = mbedtls_sha512ce_update_ret( &ctx, input, ilen ) ) == 0 )
+        ret = mbedtls_sha512ce_finish_ret( &ctx, output );
+
+    mbedtls_sha512ce_free( &ctx );
+
+    return( ret );
+}
+
+#if defined(MBEDTLS_SELF_TEST)
+/*
+ * FIPS 180-4 examples: "abc" and the two-block messages of 448 and 896
+ * bits
+ */
+static const unsigned char sha2ce_test_buf[3][113] =
+{
+    { "abc" },
+    { "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq" },
+    { "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmn"
+      "hijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu" },
+};
+
+static const size_t sha2ce_test_buflen[3] = { 3, 56, 112 };
+
+static const unsigned char sha256ce_test_sum[2][32] =
+{
+    { 0xBA, 0x78, 0x16, 0xBF, 0x8F, 0x01, 0xCF, 0xEA,
+      0x41, 0x41, 0x40, 0xDE, 0x5D, 0xAE, 0x22, 0x23,
+      0xB0, 0x03, 0x61, 0xA3, 0x96, 0x17, 0x7A, 0x9C,
+      0xB4, 0x10, 0xFF, 0x61, 0xF2, 0x00, 0x15, 0xAD },
+    { 0x24, 0x8D, 0x6A, 0x61, 0xD2, 0x06, 0x38, 0xB8,
+      0xE5, 0xC0, 0x26, 0x93, 0x0C, 0x3E, 0x60, 0x39,
+      0xA3, 0x3C, 0xE4, 0x59, 0x64, 0xFF, 0x21, 0x67,
+      0xF6, 0xEC, 0xED, 0xD4, 0x19, 0xDB, 0x06, 0xC1 },
+};
+
+static const unsigned char sha512ce_test_sum[2][64] =
+{
+    { 0xDD, 0xAF, 0x35, 0xA1, 0x93, 0x61, 0x7A, 0xBA,
+      0xCC, 0x41, 0x73, 0x49, 0xAE, 0x20, 0x41, 0x31,
+      0x12, 0xE6, 0xFA, 0x4E, 0x89, 0xA9, 0x7E, 0xA2,
+      0x0A, 0x9E, 0xEE, 0xE6, 0x4B, 0x55, 0xD3, 0x9A,
+      0x21, 0x92, 0x99, 0x2A, 0x27, 0x4F, 0xC1, 0xA8,
+      0x36, 0xBA, 0x3C, 0x23, 0xA3, 0xFE, 0xEB, 0xBD,
+      0x45, 0x4D, 0x44, 0x23, 0x64, 0x3C, 0xE8, 0x0E,
+      0x2A, 0x9A, 0xC9, 0x4F, 0xA5, 0x4C, 0xA4, 0x9F },
+    { 0x8E, 0x95, 0x9B, 0x75, 0xDA, 0xE3, 0x13, 0xDA,
+      0x8C, 0xF4, 0xF7, 0x28, 0x14, 0xFC, 0x14, 0x3F,
+      0x8F, 0x77, 0x79, 0xC6, 0xEB, 0x9F, 0x7F, 0xA1,
+      0x72, 0x99, 0xAE, 0xAD, 0xB6, 0x88, 0x90, 0x18,
+      0x50, 0x1D, 0x28, 0x9E, 0x49, 0x00, 0xF7, 0xE4,
+      0x33, 0x1B, 0x99, 0xDE, 0xC4, 0xB5, 0x43, 0x3A,
+      0xC7, 0xD3, 0x29, 0xEE, 0xB6, 0xDD, 0x26, 0x54,
+      0x5E, 0x96, 0xE5, 0x5B, 0x87, 0x4B, 0xE9, 0x09 },
+};
+
+/* SHA-224 and SHA-384 of "abc" */
+static const unsigned char sha224ce_test_sum[28] =
+{
+    0x23, 0x09, 0x7D, 0x22, 0x34, 0x05, 0xD8, 0x22,
+    0x86, 0x42, 0xA4, 0x77, 0xBD, 0xA2, 0x55, 0xB3,
+    0x2A, 0xAD, 0xBC, 0xE4, 0xBD, 0xA0, 0xB3, 0xF7,
+    0xE3, 0x6C, 0x9D, 0xA7,
+};
+
+static const unsigned char sha384ce_test_sum[48] =
+{
+    0xCB, 0x00, 0x75, 0x3F, 0x45, 0xA3, 0x5E, 0x8B,
+    0xB5, 0xA0, 0x3D, 0x69, 0x9A, 0xC6, 0x50, 0x07,
+    0x27, 0x2C, 0x32, 0xAB, 0x0E, 0xDE, 0xD1, 0x63,
+    0x1A, 0x8B, 0x60, 0x5A, 0x43, 0xFF, 0x5B, 0xED,
+    0x80, 0x86, 0x07, 0x2B, 0xA1, 0xE7, 0xCC, 0x23,
+    0x58, 0xBA, 0xEC, 0xA1, 0x34, 0xC8, 0x25, 0xA7,
+};
+
+#define SHA2CE_TEST_LEN     1000
+
+/*
+ * The message of 1000 Bytes hashed at once and fed in pieces of every
+ * size from 1 to 129, so that update() meets each split of the context
+ * buffer, must give the same digest
+ */
+static int sha2ce_self_test_split( const unsigned char *buf )
+{
+    mbedtls_sha256ce_context c256;
+    mbedtls_sha512ce_context c512;
+    unsigned char ref[64], sum[64];
+    size_t piece, off, n;
+    int ret = 1;
+
+    mbedtls_sha256ce_init( &c256 );
+    mbedtls_sha512ce_init( &c512 );
+
+    for( piece = 1; piece <= 129; piece++ )
+    {
+        mbedtls_sha256ce_ret( buf, SHA2CE_TEST_LEN, ref, 0 );
+        mbedtls_sha256ce_starts_ret( &c256, 0 );
+        for( off = 0; off < SHA2CE_TEST_LEN; off += n )
+        {
+            n = SHA2CE_TEST_LEN - off < piece ? SHA2CE_TEST_LEN - off
+                                              : piece;
+            mbedtls_sha256ce_update_ret( &c256, buf + off, n );
+        }
+        mbedtls_sha256ce_finish_ret( &c256, sum );
+        if( memcmp( sum, ref, 32 ) != 0 )
+            goto exit;
+
+        mbedtls_sha512ce_ret( buf, SHA2CE_TEST_LEN, ref, 0 );
+        mbedtls_sha512ce_starts_ret( &c512, 0 );
+        for( off = 0; off < SHA2CE_TEST_LEN; off += n )
+        {
+            n = SHA2CE_TEST_LEN - off < piece ? SHA2CE_TEST_LEN - off
+                                              : piece;
+            mbedtls_sha512ce_update_ret( &c512, buf + off, n );
+        }
+        mbedtls_sha512ce_finish_ret( &c512, sum );
+        if( memcmp( sum, ref, 64 ) != 0 )
+            goto exit;
+    }
+
+    ret = 0;
+
+exit:
+    mbedtls_sha256ce_free( &c256 );
+    mbedtls_sha512ce_free( &c512 );
+    return( ret );
+}
+
+#if defined(SHA2CE_NEON)
+/* The instruction and NEON code against the portable code */
+static int sha2ce_self_test_backends( const unsigned char *buf )
+{
+    uint32_t s256[2][8];
+    uint64_t s512[2][8];
+    unsigned int i;
+
+    for( i = 0; i < 8; i++ )
+    {
+        s256[0][i] = s256[1][i] = 0x01234567 * ( i + 1 );
+        s512[0][i] = s512[1][i] = 0x0123456789ABCDEFULL * ( i + 1 );
+    }
+
+    sha256_blocks( s256[0], buf, SHA2CE_TEST_LEN / 64 );
+    sha256_blocks_c( s256[1], buf, SHA2CE_TEST_LEN / 64 );
+    if( memcmp( s256[0], s256[1], sizeof( s256[0] ) ) != 0 )
+        return( 1 );
+
+    sha512_blocks( s512[0], buf, SHA2CE_TEST_LEN / 128 );
+    for( i = 0; i < SHA2CE_TEST_LEN / 128; i++ )
+    {
+        uint64_t w[16], a, b, c, d, e, f, g, h, t1, t2;
+        unsigned int t;
+
+        for( t = 0; t < 16; t++ )
+            GET_UINT64_BE( w[t], buf, 128 * i + 8 * t );
+
+        a = s512[1][0]; b = s512[1][1]; c = s512[1][2]; d = s512[1][3];
+        e = s512[1][4]; f = s512[1][5]; g = s512[1][6]; h = s512[1][7];
+
+        for( t = 0; t < 80; t++ )
+        {
+            if( t >= 16 )
+                w[t & 15] += S512_1( w[( t - 2 ) & 15] ) +
+                             w[( t - 7 ) & 15] +
+                             S512_0( w[( t - 15 ) & 15] );
+            t1 = h + S512_3( e ) + F1( e, f, g ) + K512[t] + w[t & 15];
+            t2 = S512_2( a ) + F0( a, b, c );
+            h = g; g = f; f = e; e = d + t1;
+            d = c; c = b; b = a; a = t1 + t2;
+        }
+
+        s512[1][0] += a; s512[1][1] += b; s512[1][2] += c; s512[1][3] += d;
+        s512[1][4] += e; s512[1][5] += f; s512[1][6] += g; s512[1][7] += h;
+    }
+    if( memcmp( s512[0], s512[1], sizeof( s512[0] ) ) != 0 )
+        return( 1 );
+
+    return( 0 );
+}
+#endif /* SHA2CE_NEON */
+
+int mbedtls_sha2ce_self_test( int verbose )
+{
+    unsigned char buf[SHA2CE_TEST_LEN];
+    unsigned char sum[64];
+    unsigned int i;
+    int ret = 0;
+
+    for( i = 0; i < 2; i++ )
+    {
+        if( verbose != 0 )
+            mbedtls_printf( "  SHA-256-CE test #%u: ", i + 1 );
+
+        if( mbedtls_sha256ce_ret( sha2ce_test_buf[i], sha2ce_test_buflen[i],
+                                  sum, 0 ) != 0 ||
+            memcmp( sum, sha256ce_test_sum[i], 32 ) != 0 )
+            goto fail;
+
+        if( verbose != 0 )
+            mbedtls_printf( "passed\n" );
+    }
+
+    for( i = 0; i < 2; i++ )
+    {
+        if( verbose != 0 )
+            mbedtls_printf( "  SHA-512-CE test #%u: ", i + 1 );
+
+        if( mbedtls_sha512ce_ret( sha2ce_test_buf[2 * i],
+                                  sha2ce_test_buflen[2 * i], sum, 0 ) != 0 ||
+            memcmp( sum, sha512ce_test_sum[i], 64 ) != 0 )
+            goto fail;
+
+        if( verbose != 0 )
+            mbedtls_printf( "passed\n" );
+    }
+
+    if( verbose != 0 )
+        mbedtls_printf( "  SHA-224-CE and SHA-384-CE test: " );
+
+    if( mbedtls_sha256ce_ret( sha2ce_test_buf[0], 3, sum, 1 ) != 0 ||
+        memcmp( sum, sha224ce_test_sum, 28 ) != 0 ||
+        mbedtls_sha512ce_ret( sha2ce_test_buf[0], 3, sum, 1 ) != 0 ||
+        memcmp( sum, sha384ce_test_sum, 48 ) != 0 )
+        goto fail;
+
+    if( verbose != 0 )
+        mbedtls_printf( "passed\n" );
+
+    for( i = 0; i < SHA2CE_TEST_LEN; i++ )
+        buf[i] = (unsigned char) ( i * 13 + 5 );
+
+    if( verbose != 0 )
+        mbedtls_printf( "  SHA-2-CE split update test: " );
+
+    if( sha2ce_self_test_split( buf ) != 0 )
+        goto fail;
+
+    if( verbose != 0 )
+        mbedtls_printf( "passed\n" );
+
+#if defined(SHA2CE_NEON)
+    if( verbose != 0 )
+        mbedtls_printf( "  SHA-2-CE (portable back end): " );
+
+    if( sha2ce_self_test_backends( buf ) != 0 )
+        goto fail;
+
+    if( verbose != 0 )
+        mbedtls_printf( "passed\n" );
+#endif /* SHA2CE_NEON */
+
+    if( verbose != 0 )
+        mbedtls_printf( "\n" );
+
+    goto exit;
+
+fail:
+    if( verbose != 0 )
+        mbedtls_printf( "failed\n" );
+    ret = 1;
+
+exit:
+    mbedtls_platform_zeroize( sum, sizeof( sum ) );
+    return( ret );
+}
+
+#endif /* MBEDTLS_SELF_TEST */
+
+#endif /* MBEDTLS_SHA2CE_C */
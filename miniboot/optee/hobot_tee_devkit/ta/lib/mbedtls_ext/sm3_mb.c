@@ -0,0 +1,668 @@
+/*
+ *  Multi-buffer SM3 hash function
+ *
+ *  Copyright (c) 2026, D-Robotics
+ *  SPDX-License-Identifier: BSD-2-Clause
+ */
+/*
+ *  GB/T 32905-2016 Information security technology - SM3 cryptographic
+ *  hash algorithm
+ *
+ *  The SM3 of libmbedtls hashes one message at a time. Here up to
+ *  MBEDTLS_SM3_MB_MAX_LANES independent messages are compressed in
+ *  parallel, each step of the compression function being a loop over the
+ *  messages that the compiler turns into vector instructions.
+ */
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#if defined(MBEDTLS_SM3_MB_C)
+
+#include "mbedtls/sm3.h"
+#include "mbedtls/platform_util.h"
+
+#include <string.h>
+
+#if defined(MBEDTLS_SELF_TEST)
+#if defined(MBEDTLS_PLATFORM_C)
+#include "mbedtls/platform.h"
+#else
+#include <stdio.h>
+#define mbedtls_printf printf
+#endif /* MBEDTLS_PLATFORM_C */
+#endif /* MBEDTLS_SELF_TEST */
+
+/*
+ * 32-bit integer manipulation macros (big endian)
+ */
+#ifndef GET_UINT32_BE
+#define GET_UINT32_BE(n,b,i)                            \
+do {                                                    \
+    (n) = ( (uint32_t) (b)[(i)    ] << 24 )             \
+        | ( (uint32_t) (b)[(i) + 1] << 16 )             \
+        | ( (uint32_t) (b)[(i) + 2] <<  8 )             \
+        | ( (uint32_t) (b)[(i) + 3]       );            \
+} while( 0 )
+#endif
+
+#ifndef PUT_UINT32_BE
+#define PUT_UINT32_BE(n,b,i)                            \
+do {                                                    \
+    (b)[(i)    ] = (unsigned char) ( (n) >> 24 );       \
+    (b)[(i) + 1] = (unsigned char) ( (n) >> 16 );       \
+    (b)[(i) + 2] = (unsigned char) ( (n) >>  8 );       \
+    (b)[(i) + 3] = (unsigned char) ( (n)       );       \
+} while( 0 )
+#endif
+
+#define ROTL32( x, n )      ( ( (x) << (n) ) | ( (x) >> ( 32 - (n) ) ) )
+
+#define P0( x )             ( (x) ^ ROTL32( (x), 9 ) ^ ROTL32( (x), 17 ) )
+#define P1( x )             ( (x) ^ ROTL32( (x), 15 ) ^ ROTL32( (x), 23 ) )
+
+#define FF0( x, y, z )      ( (x) ^ (y) ^ (z) )
+#define FF1( x, y, z )      ( ( (x) & (y) ) | ( ( (x) | (y) ) & (z) ) )
+#define GG0( x, y, z )      ( (x) ^ (y) ^ (z) )
+#define GG1( x, y, z )      ( ( (z) ^ ( (x) & ( (y) ^ (z) ) ) ) )
+
+/*
+ * Message expansion: W[j] from the 16 words before it, in a window of 16
+ * words indexed modulo 16
+ */
+#define EXPAND( w, j )                                                  \
+    ( P1( (w)[( (j) - 16 ) & 15] ^ (w)[( (j) - 9 ) & 15] ^              \
+          ROTL32( (w)[( (j) - 3 ) & 15], 15 ) ) ^                       \
+      ROTL32( (w)[( (j) - 13 ) & 15], 7 ) ^ (w)[( (j) - 6 ) & 15] )
+
+static const uint32_t SM3_IV[8] =
+{
+    0x7380166f, 0x4914b2b9, 0x172442d7, 0xda8a0600,
+    0xa96f30bc, 0x163138aa, 0xe38dee4d, 0xb0fb0e4e,
+};
+
+/*
+ * The round constants rotated by the round number: T[j] <<< (j mod 32)
+ */
+static const uint32_t SM3_T[64] =
+{
+    0x79cc4519, 0xf3988a32, 0xe7311465, 0xce6228cb,
+    0x9cc45197, 0x3988a32f, 0x7311465e, 0xe6228cbc,
+    0xcc451979, 0x988a32f3, 0x311465e7, 0x6228cbce,
+    0xc451979c, 0x88a32f39, 0x11465e73, 0x228cbce6,
+    0x9d8a7a87, 0x3b14f50f, 0x7629ea1e, 0xec53d43c,
+    0xd8a7a879, 0xb14f50f3, 0x629ea1e7, 0xc53d43ce,
+    0x8a7a879d, 0x14f50f3b, 0x29ea1e76, 0x53d43cec,
+    0xa7a879d8, 0x4f50f3b1, 0x9ea1e762, 0x3d43cec5,
+    0x7a879d8a, 0xf50f3b14, 0xea1e7629, 0xd43cec53,
+    0xa879d8a7, 0x50f3b14f, 0xa1e7629e, 0x43cec53d,
+    0x879d8a7a, 0x0f3b14f5, 0x1e7629ea, 0x3cec53d4,
+    0x79d8a7a8, 0xf3b14f50, 0xe7629ea1, 0xcec53d43,
+    0x9d8a7a87, 0x3b14f50f, 0x7629ea1e, 0xec53d43c,
+    0xd8a7a879, 0xb14f50f3, 0x629ea1e7, 0xc53d43ce,
+    0x8a7a879d, 0x14f50f3b, 0x29ea1e76, 0x53d43cec,
+    0xa7a879d8, 0x4f50f3b1, 0x9ea1e762, 0x3d43cec5,
+};
+
+/*
+ * Single stream compression
+ *
+ * W[j + 4] is expanded in round j, just before W'[j] = W[j] ^ W[j + 4]
+ * needs it, so that only a window of 16 words is live instead of the 68 W
+ * and 64 W' words of the reference description. The rounds rename the
+ * registers instead of moving them: after a round, A B C D E F G H are
+ * found in D A B' C H E F' G, B' and F' being B and F rotated.
+ */
+#define SM3_ROUND( a, b, c, d, e, f, g, h, j, FF, GG )                  \
+do {                                                                    \
+    uint32_t a12 = ROTL32( a, 12 );                                     \
+    uint32_t ss1 = ROTL32( a12 + e + SM3_T[j], 7 );                     \
+    uint32_t wj = w[(j) & 15];                                          \
+    if( (j) >= 12 )                                                     \
+        w[( (j) + 4 ) & 15] = EXPAND( w, (j) + 4 );                     \
+    d += FF( a, b, c ) + ( ss1 ^ a12 ) + ( wj ^ w[( (j) + 4 ) & 15] );  \
+    h += GG( e, f, g ) + ss1 + wj;                                      \
+    b = ROTL32( b, 9 );                                                 \
+    f = ROTL32( f, 19 );                                                \
+    h = P0( h );                                                        \
+} while( 0 )
+
+static void sm3_process( uint32_t state[8], const unsigned char *data,
+                         size_t blocks )
+{
+    uint32_t w[16];
+    uint32_t a, b, c, d, e, f, g, h;
+    int i;
+
+    for( ; blocks > 0; blocks--, data += 64 )
+    {
+        for( i = 0; i < 16; i++ )
+            GET_UINT32_BE( w[i], data, 4 * i );
+
+        a = state[0]; b = state[1]; c = state[2]; d = state[3];
+        e = state[4]; f = state[5]; g = state[6]; h = state[7];
+
+        for( i = 0; i < 16; i += 4 )
+        {
+            SM3_ROUND( a, b, c, d, e, f, g, h, i,     FF0, GG0 );
+            SM3_ROUND( d, a, b, c, h, e, f, g, i + 1, FF0, GG0 );
+            SM3_ROUND( c, d, a, b, g, h, e, f, i + 2, FF0, GG0 );
+            SM3_ROUND( b, c, d, a, f, g, h, e, i + 3, FF0, GG0 );
+        }
+        for( ; i < 64; i += 4 )
+        {
+            SM3_ROUND( a, b, c, d, e, f, g, h, i,     FF1, GG1 );
+            SM3_ROUND( d, a, b, c, h, e, f, g, i + 1, FF1, GG1 );
+            SM3_ROUND( c, d, a, b, g, h, e, f, i + 2, FF1, GG1 );
+            SM3_ROUND( b, c, d, a, f, g, h, e, i + 3, FF1, GG1 );
+        }
+
+        state[0] ^= a; state[1] ^= b; state[2] ^= c; state[3] ^= d;
+        state[4] ^= e; state[5] ^= f; state[6] ^= g; state[7] ^= h;
+    }
+
+    mbedtls_platform_zeroize( w, sizeof( w ) );
+}
+
+/*
+ * Pads the last ilen % 64 bytes of the message into @tail, returns the
+ * number of blocks it takes, 1 or 2
+ */
+static size_t sm3_pad( unsigned char tail[128], const unsigned char *input,
+                       size_t ilen )
+{
+    size_t rem = ilen % 64;
+    size_t n = rem < 56 ? 1 : 2;
+    uint32_t high = (uint32_t) ( (uint64_t) ilen >> 29 );
+    uint32_t low = (uint32_t) ( ilen << 3 );
+
+    if( rem > 0 )
+        memcpy( tail, input + ilen - rem, rem );
+    tail[rem] = 0x80;
+    memset( tail + rem + 1, 0, 64 * n - rem - 9 );
+    PUT_UINT32_BE( high, tail, 64 * n - 8 );
+    PUT_UINT32_BE( low, tail, 64 * n - 4 );
+
+    return( n );
+}
+
+int mbedtls_sm3_mb_ret( const unsigned char *input,
+                        size_t ilen,
+                        unsigned char output[32] )
+{
+    unsigned char tail[128];
+    uint32_t state[8];
+    size_t n;
+    int i;
+
+    if( input == NULL && ilen > 0 )
+        return( MBEDTLS_ERR_SM3_BAD_INPUT_DATA );
+    if( output == NULL )
+        return( MBEDTLS_ERR_SM3_BAD_INPUT_DATA );
+
+    memcpy( state, SM3_IV, sizeof( state ) );
+    sm3_process( state, input, ilen / 64 );
+    n = sm3_pad( tail, input, ilen );
+    sm3_process( state, tail, n );
+
+    for( i = 0; i < 8; i++ )
+        PUT_UINT32_BE( state[i], output, 4 * i );
+
+    mbedtls_platform_zeroize( tail, sizeof( tail ) );
+    mbedtls_platform_zeroize( state, sizeof( state ) );
+
+    return( 0 );
+}
+
+/*
+ * Multi-lane compression: one round of all the lanes, the state and the
+ * message words of the lanes being stored side by side
+ */
+#define SM3_LANES_ROUND( j, FF, GG )                                    \
+do {                                                                    \
+    if( (j) >= 12 )                                                     \
+    {                                                                   \
+        for( l = 0; l < lanes; l++ )                                    \
+            w[( (j) + 4 ) & 15][l] =                                    \
+                P1( w[( (j) - 12 ) & 15][l] ^ w[( (j) - 5 ) & 15][l] ^  \
+                    ROTL32( w[( (j) + 1 ) & 15][l], 15 ) ) ^            \
+                ROTL32( w[( (j) - 9 ) & 15][l], 7 ) ^                   \
+                w[( (j) - 2 ) & 15][l];                                 \
+    }                                                                   \
+    for( l = 0; l < lanes; l++ )                                        \
+    {                                                                   \
+        uint32_t a12 = ROTL32( x[0][l], 12 );                           \
+        uint32_t ss1 = ROTL32( a12 + x[4][l] + SM3_T[j], 7 );           \
+        uint32_t tt1 = FF( x[0][l], x[1][l], x[2][l] ) + x[3][l] +      \
+                       ( ss1 ^ a12 ) +                                  \
+                       ( w[(j) & 15][l] ^ w[( (j) + 4 ) & 15][l] );     \
+        uint32_t tt2 = GG( x[4][l], x[5][l], x[6][l] ) + x[7][l] +      \
+                       ss1 + w[(j) & 15][l];                            \
+                                                                        \
+        x[3][l] = x[2][l];                                              \
+        x[2][l] = ROTL32( x[1][l], 9 );                                 \
+        x[1][l] = x[0][l];                                              \
+        x[0][l] = tt1;                                                  \
+        x[7][l] = x[6][l];                                              \
+        x[6][l] = ROTL32( x[5][l], 19 );                                \
+        x[5][l] = x[4][l];                                              \
+        x[4][l] = P0( tt2 );                                            \
+    }                                                                   \
+} while( 0 )
+
+/*
+ * Compresses @blocks blocks of each lane, the blocks of lane l being read
+ * from data[l] on, which is advanced by step[l]. Inlined with a constant
+ * @lanes so that the loops over the lanes have a fixed trip count.
+ */
+static inline void sm3_lanes_process(
+                        uint32_t state[8][MBEDTLS_SM3_MB_MAX_LANES],
+                        const unsigned char **data, const size_t *step,
+                        size_t blocks, size_t lanes )
+{
+    uint32_t w[16][MBEDTLS_SM3_MB_MAX_LANES];
+    uint32_t x[8][MBEDTLS_SM3_MB_MAX_LANES];
+    size_t l;
+    int i, j;
+
+    for( ; blocks > 0; blocks-- )
+    {
+        for( l = 0; l < lanes; l++ )
+        {
+            for( i = 0; i < 16; i++ )
+                GET_UINT32_BE( w[i][l], data[l], 4 * i );
+            data[l] += step[l];
+        }
+        for( i = 0; i < 8; i++ )
+            for( l = 0; l < lanes; l++ )
+                x[i][l] = state[i][l];
+
+        for( j = 0; j < 16; j++ )
+            SM3_LANES_ROUND( j, FF0, GG0 );
+        for( ; j < 64; j++ )
+            SM3_LANES_ROUND( j, FF1, GG1 );
+
+        for( i = 0; i < 8; i++ )
+            for( l = 0; l < lanes; l++ )
+                state[i][l] ^= x[i][l];
+    }
+
+    mbedtls_platform_zeroize( w, sizeof( w ) );
+    mbedtls_platform_zeroize( x, sizeof( x ) );
+}
+
+/* Fed to the idle lanes */
+static const unsigned char sm3_idle_block[64];
+
+int mbedtls_sm3_mb_init( mbedtls_sm3_mb_context *ctx, unsigned int lanes )
+{
+    if( ctx == NULL ||
+        ( lanes != 4 && lanes != MBEDTLS_SM3_MB_MAX_LANES ) )
+        return( MBEDTLS_ERR_SM3_BAD_INPUT_DATA );
+
+    memset( ctx, 0, sizeof( mbedtls_sm3_mb_context ) );
+    ctx->lanes = lanes;
+
+    return( 0 );
+}
+
+void mbedtls_sm3_mb_free( mbedtls_sm3_mb_context *ctx )
+{
+    if( ctx == NULL )
+        return;
+
+    mbedtls_platform_zeroize( ctx, sizeof( mbedtls_sm3_mb_context ) );
+}
+
+/*
+ * Writes the digest of the job of lane @l and frees the lane
+ */
+static mbedtls_sm3_mb_job *sm3_mb_complete( mbedtls_sm3_mb_context *ctx,
+                                            size_t l )
+{
+    mbedtls_sm3_mb_job *job = ctx->jobs[l];
+    int i;
+
+    for( i = 0; i < 8; i++ )
+        PUT_UINT32_BE( ctx->state[i][l], job->output, 4 * i );
+
+    ctx->jobs[l] = NULL;
+    mbedtls_platform_zeroize( ctx->tail[l], sizeof( ctx->tail[l] ) );
+
+    return( job );
+}
+
+/*
+ * Compresses the blocks of the busy lanes until a job completes, and
+ * returns it, or NULL if all the lanes are idle
+ */
+static mbedtls_sm3_mb_job *sm3_mb_run( mbedtls_sm3_mb_context *ctx )
+{
+    const unsigned char *data[MBEDTLS_SM3_MB_MAX_LANES];
+    size_t step[MBEDTLS_SM3_MB_MAX_LANES];
+    uint32_t state[8];
+    size_t busy, last = 0, n = 0;
+    size_t l;
+    int i;
+
+    for( ;; )
+    {
+        busy = 0;
+        for( l = 0; l < ctx->lanes; l++ )
+        {
+            if( ctx->jobs[l] == NULL )
+                continue;
+
+            /* Input blocks done, on to the padded last ones */
+            if( ctx->blocks[l] == 0 && ctx->tail_blocks[l] > 0 )
+            {
+                ctx->data[l] = ctx->tail[l];
+                ctx->blocks[l] = ctx->tail_blocks[l];
+                ctx->tail_blocks[l] = 0;
+            }
+            if( ctx->blocks[l] == 0 )
+                return( sm3_mb_complete( ctx, l ) );
+
+            if( busy == 0 || ctx->blocks[l] < n )
+                n = ctx->blocks[l];
+            busy++;
+            last = l;
+        }
+
+        if( busy == 0 )
+            return( NULL );
+
+        /* A lone job is finished by the single stream code */
+        if( busy == 1 )
+        {
+            for( i = 0; i < 8; i++ )
+                state[i] = ctx->state[i][last];
+            sm3_process( state, ctx->data[last], ctx->blocks[last] );
+            if( ctx->tail_blocks[last] > 0 )
+                sm3_process( state, ctx->tail[last],
+                             ctx->tail_blocks[last] );
+            for( i = 0; i < 8; i++ )
+                ctx->state[i][last] = state[i];
+            ctx->blocks[last] = 0;
+            ctx->tail_blocks[last] = 0;
+            mbedtls_platform_zeroize( state, sizeof( state ) );
+
+            return( sm3_mb_complete( ctx, last ) );
+        }
+
+        for( l = 0; l < ctx->lanes; l++ )
+        {
+            if( ctx->jobs[l] == NULL )
+            {
+                data[l] = sm3_idle_block;
+                step[l] = 0;
+            }
+            else
+            {
+                data[l] = ctx->data[l];
+                step[l] = 64;
+                ctx->data[l] += 64 * n;
+                ctx->blocks[l] -= n;
+            }
+        }
+
+        if( ctx->lanes == MBEDTLS_SM3_MB_MAX_LANES )
+            sm3_lanes_process( ctx->state, data, step, n,
+                               MBEDTLS_SM3_MB_MAX_LANES );
+        else
+            sm3_lanes_process( ctx->state, data, step, n, 4 );
+    }
+}
+
+int mbedtls_sm3_mb_submit( mbedtls_sm3_mb_context *ctx,
+                           mbedtls_sm3_mb_job *job,
+                           mbedtls_sm3_mb_job **done )
+{
+    size_t l, busy = 0;
+    int i;
+
+    if( ctx == NULL || job == NULL || done == NULL ||
+        job->output == NULL || ( job->input == NULL && job->ilen > 0 ) )
+        return( MBEDTLS_ERR_SM3_BAD_INPUT_DATA );
+
+    *done = NULL;
+
+    /* At least one lane is idle between the calls */
+    for( l = 0; ctx->jobs[l] != NULL; l++ )
+        ;
+
+    ctx->jobs[l] = job;
+    for( i = 0; i < 8; i++ )
+        ctx->state[i][l] = SM3_IV[i];
+    ctx->data[l] = job->input;
+    ctx->blocks[l] = job->ilen / 64;
+    ctx->tail_blocks[l] = sm3_pad( ctx->tail[l], job->input, job->ilen );
+
+    for( l = 0; l < ctx->lanes; l++ )
+        if( ctx->jobs[l] != NULL )
+            busy++;
+
+    if( busy == ctx->lanes )
+        *done = sm3_mb_run( ctx );
+
+    return( 0 );
+}
+
+int mbedtls_sm3_mb_flush( mbedtls_sm3_mb_context *ctx,
+                          mbedtls_sm3_mb_job **done )
+{
+    if( ctx == NULL || done == NULL )
+        return( MBEDTLS_ERR_SM3_BAD_INPUT_DATA );
+
+    *done = sm3_mb_run( ctx );
+
+    return( 0 );
+}
+
+int mbedtls_sm3_mb_multi( size_t n, mbedtls_sm3_mb_job *jobs )
+{
+    mbedtls_sm3_mb_context ctx;
+    mbedtls_sm3_mb_job *done;
+    size_t i;
+
+    if( n > 0 && jobs == NULL )
+        return( MBEDTLS_ERR_SM3_BAD_INPUT_DATA );
+
+    for( i = 0; i < n; i++ )
+    {
+        if( jobs[i].output == NULL ||
+            ( jobs[i].input == NULL && jobs[i].ilen > 0 ) )
+            return( MBEDTLS_ERR_SM3_BAD_INPUT_DATA );
+    }
+
+    if( n == 1 )
+        return( mbedtls_sm3_mb_ret( jobs[0].input, jobs[0].ilen,
+                                    jobs[0].output ) );
+
+    mbedtls_sm3_mb_init( &ctx, n >= MBEDTLS_SM3_MB_MAX_LANES ?
+                               MBEDTLS_SM3_MB_MAX_LANES : 4 );
+    for( i = 0; i < n; i++ )
+        mbedtls_sm3_mb_submit( &ctx, jobs + i, &done );
+    do
+        mbedtls_sm3_mb_flush( &ctx, &done );
+    while( done != NULL );
+    mbedtls_sm3_mb_free( &ctx );
+
+    return( 0 );
+}
+
+#if defined(MBEDTLS_SELF_TEST)
+/*
+ * GB/T 32905-2016, appendix A
+ */
+static const unsigned char sm3_test_buf[2][65] =
+{
+    { "abc" },
+    { "abcdabcdabcdabcdabcdabcdabcdabcdabcdabcdabcdabcdabcdabcdabcdabcd" },
+};
+
+static const size_t sm3_test_buflen[2] =
+{
+    3, 64
+};
+
+static const unsigned char sm3_test_sum[2][32] =
+{
+    { 0x66, 0xc7, 0xf0, 0xf4, 0x62, 0xee, 0xed, 0xd9,
+      0xd1, 0xf2, 0xd4, 0x6b, 0xdc, 0x10, 0xe4, 0xe2,
+      0x41, 0x67, 0xc4, 0x87, 0x5c, 0xf2, 0xf7, 0xa2,
+      0x29, 0x7d, 0xa0, 0x2b, 0x8f, 0x4b, 0xa8, 0xe0 },
+    { 0xde, 0xbe, 0x9f, 0xf9, 0x22, 0x75, 0xb8, 0xa1,
+      0x38, 0x60, 0x48, 0x89, 0xc1, 0x8e, 0x5a, 0x4d,
+      0x6f, 0xdb, 0x70, 0xe5, 0x38, 0x7e, 0x57, 0x65,
+      0x29, 0x3d, 0xcb, 0xa3, 0x9c, 0x0c, 0x57, 0x32 },
+};
+
+/*
+ * Lengths of the other messages of the job manager test: around the
+ * lengths that take one more padding block, and unequal
+ */
+#define SM3_TEST_JOBS   12
+#define SM3_TEST_LEN    448
+
+static const size_t sm3_test_len[SM3_TEST_JOBS - 2] =
+{
+    0, 1, 55, 56, 63, 64, 119, 120, 183, 443
+};
+
+/*
+ * Checker routine
+ */
+int mbedtls_sm3_mb_self_test( int verbose )
+{
+    mbedtls_sm3_mb_context ctx;
+    mbedtls_sm3_mb_job jobs[SM3_TEST_JOBS];
+    mbedtls_sm3_mb_job *done;
+    unsigned char buf[SM3_TEST_LEN];
+    unsigned char sum[SM3_TEST_JOBS][32];
+    unsigned char ref[32];
+    unsigned int lanes;
+    size_t i, completed;
+    int ret = 0;
+
+    mbedtls_sm3_mb_init( &ctx, 4 );
+
+    for( i = 0; i < 2; i++ )
+    {
+        if( verbose != 0 )
+            mbedtls_printf( "  SM3 test #%u: ", (unsigned) i + 1 );
+
+        if( mbedtls_sm3_mb_ret( sm3_test_buf[i], sm3_test_buflen[i],
+                                sum[0] ) != 0 ||
+            memcmp( sum[0], sm3_test_sum[i], 32 ) != 0 )
+            goto fail;
+
+        if( verbose != 0 )
+            mbedtls_printf( "passed\n" );
+    }
+
+    for( i = 0; i < SM3_TEST_LEN; i++ )
+        buf[i] = (unsigned char) ( i * 7 + 1 );
+
+    /*
+     * The standard vectors and the messages above, with 4 and 8 lanes,
+     * against the single stream code
+     */
+    for( lanes = 4; lanes <= MBEDTLS_SM3_MB_MAX_LANES; lanes += 4 )
+    {
+        if( verbose != 0 )
+            mbedtls_printf( "  SM3 %u lanes test: ", lanes );
+
+        for( i = 0; i < SM3_TEST_JOBS; i++ )
+        {
+            if( i < 2 )
+            {
+                jobs[i].input = sm3_test_buf[i];
+                jobs[i].ilen = sm3_test_buflen[i];
+            }
+            else
+            {
+                jobs[i].input = buf + ( i % 5 );
+                jobs[i].ilen = sm3_test_len[i - 2];
+            }
+            jobs[i].output = sum[i];
+            jobs[i].user_data = NULL;
+        }
+
+        if( mbedtls_sm3_mb_init( &ctx, lanes ) != 0 )
+            goto fail;
+
+        completed = 0;
+        for( i = 0; i < SM3_TEST_JOBS; i++ )
+        {
+            if( mbedtls_sm3_mb_submit( &ctx, jobs + i, &done ) != 0 )
+                goto fail;
+            if( done != NULL )
+            {
+                done->user_data = done;
+                completed++;
+            }
+        }
+        for( ;; )
+        {
+            if( mbedtls_sm3_mb_flush( &ctx, &done ) != 0 )
+                goto fail;
+            if( done == NULL )
+                break;
+            done->user_data = done;
+            completed++;
+        }
+        if( completed != SM3_TEST_JOBS )
+            goto fail;
+
+        for( i = 0; i < SM3_TEST_JOBS; i++ )
+        {
+            if( jobs[i].user_data != jobs + i )
+                goto fail;
+            if( i < 2 )
+            {
+                if( memcmp( sum[i], sm3_test_sum[i], 32 ) != 0 )
+                    goto fail;
+                continue;
+            }
+            mbedtls_sm3_mb_ret( jobs[i].input, jobs[i].ilen, ref );
+            if( memcmp( sum[i], ref, 32 ) != 0 )
+                goto fail;
+        }
+
+        /* The one-shot interface, on the same jobs */
+        memset( sum, 0, sizeof( sum ) );
+        if( mbedtls_sm3_mb_multi( lanes + 1, jobs ) != 0 )
+            goto fail;
+        for( i = 0; i < lanes + 1; i++ )
+        {
+            mbedtls_sm3_mb_ret( jobs[i].input, jobs[i].ilen, ref );
+            if( memcmp( sum[i], ref, 32 ) != 0 )
+                goto fail;
+        }
+
+        if( verbose != 0 )
+            mbedtls_printf( "passed\n" );
+    }
+
+    if( verbose != 0 )
+        mbedtls_printf( "\n" );
+
+    goto exit;
+
+fail:
+    if( verbose != 0 )
+        mbedtls_printf( "failed\n" );
+    ret = 1;
+
+exit:
+    mbedtls_sm3_mb_free( &ctx );
+    return( ret );
+}
+
+#endif /* MBEDTLS_SELF_TEST */
+
+#endif /* MBEDTLS_SM3_MB_C */
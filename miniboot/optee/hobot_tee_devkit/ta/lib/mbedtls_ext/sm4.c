@@ -0,0 +1,1457 @@
+/*
+ *  SM4 block cipher
+ *
+ *  Copyright (c) 2026, D-Robotics
+ *  SPDX-License-Identifier: BSD-2-Clause
+ */
+/*
+ *  GB/T 32907-2016 Information security technology - SM4 block cipher
+ *  algorithm
+ *
+ *  The modes of operation follow aes.c. Several blocks are encrypted at
+ *  once wherever the mode allows it: ECB, CBC decryption, CTR and XTS.
+ */
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#if defined(MBEDTLS_SM4_C)
+
+#include "mbedtls/sm4.h"
+#include "mbedtls/platform_util.h"
+#if defined(MBEDTLS_KLAD_CACHE_C)
+#include "mbedtls/klad_cache.h"
+#endif
+
+#include <string.h>
+
+#if defined(MBEDTLS_SELF_TEST)
+#if defined(MBEDTLS_PLATFORM_C)
+#include "mbedtls/platform.h"
+#else
+#include <stdio.h>
+#define mbedtls_printf printf
+#endif /* MBEDTLS_PLATFORM_C */
+#endif /* MBEDTLS_SELF_TEST */
+
+#if !defined(MBEDTLS_SM4_ALT)
+
+/*
+ * On AArch64 the S-box of 8 blocks is evaluated at once in the vector
+ * registers: with AESE and two affine transforms when the compiler targets
+ * the Armv8 Cryptographic Extension, see CFG_TA_CRYPTO_WITH_CE, with table
+ * lookups otherwise.
+ */
+#if defined(__aarch64__) && defined(CFG_TA_FLOAT_SUPPORT)
+#define SM4_NEON
+#include <arm_neon.h>
+#if defined(__ARM_FEATURE_AES) || defined(__ARM_FEATURE_CRYPTO)
+#define SM4_CE
+#endif
+#endif
+
+/*
+ * 32-bit integer manipulation macros (big endian)
+ */
+#ifndef GET_UINT32_BE
+#define GET_UINT32_BE(n,b,i)                            \
+do {                                                    \
+    (n) = ( (uint32_t) (b)[(i)    ] << 24 )             \
+        | ( (uint32_t) (b)[(i) + 1] << 16 )             \
+        | ( (uint32_t) (b)[(i) + 2] <<  8 )             \
+        | ( (uint32_t) (b)[(i) + 3]       );            \
+} while( 0 )
+#endif
+
+#ifndef PUT_UINT32_BE
+#define PUT_UINT32_BE(n,b,i)                            \
+do {                                                    \
+    (b)[(i)    ] = (unsigned char) ( (n) >> 24 );       \
+    (b)[(i) + 1] = (unsigned char) ( (n) >> 16 );       \
+    (b)[(i) + 2] = (unsigned char) ( (n) >>  8 );       \
+    (b)[(i) + 3] = (unsigned char) ( (n)       );       \
+} while( 0 )
+#endif
+
+/* Blocks processed at once by the bulk loops */
+#define SM4_BULK_BLOCKS     8
+
+#define ROTL32( x, n )      ( ( (x) << (n) ) | ( (x) >> ( 32 - (n) ) ) )
+#define ROTR32( x, n )      ( ( (x) >> (n) ) | ( (x) << ( 32 - (n) ) ) )
+
+/*
+ * S-box
+ */
+static const unsigned char SBOX[256] =
+{
+    0xd6, 0x90, 0xe9, 0xfe, 0xcc, 0xe1, 0x3d, 0xb7, 0x16, 0xb6, 0x14, 0xc2,
+    0x28, 0xfb, 0x2c, 0x05, 0x2b, 0x67, 0x9a, 0x76, 0x2a, 0xbe, 0x04, 0xc3,
+    0xaa, 0x44, 0x13, 0x26, 0x49, 0x86, 0x06, 0x99, 0x9c, 0x42, 0x50, 0xf4,
+    0x91, 0xef, 0x98, 0x7a, 0x33, 0x54, 0x0b, 0x43, 0xed, 0xcf, 0xac, 0x62,
+    0xe4, 0xb3, 0x1c, 0xa9, 0xc9, 0x08, 0xe8, 0x95, 0x80, 0xdf, 0x94, 0xfa,
+    0x75, 0x8f, 0x3f, 0xa6, 0x47, 0x07, 0xa7, 0xfc, 0xf3, 0x73, 0x17, 0xba,
+    0x83, 0x59, 0x3c, 0x19, 0xe6, 0x85, 0x4f, 0xa8, 0x68, 0x6b, 0x81, 0xb2,
+    0x71, 0x64, 0xda, 0x8b, 0xf8, 0xeb, 0x0f, 0x4b, 0x70, 0x56, 0x9d, 0x35,
+    0x1e, 0x24, 0x0e, 0x5e, 0x63, 0x58, 0xd1, 0xa2, 0x25, 0x22, 0x7c, 0x3b,
+    0x01, 0x21, 0x78, 0x87, 0xd4, 0x00, 0x46, 0x57, 0x9f, 0xd3, 0x27, 0x52,
+    0x4c, 0x36, 0x02, 0xe7, 0xa0, 0xc4, 0xc8, 0x9e, 0xea, 0xbf, 0x8a, 0xd2,
+    0x40, 0xc7, 0x38, 0xb5, 0xa3, 0xf7, 0xf2, 0xce, 0xf9, 0x61, 0x15, 0xa1,
+    0xe0, 0xae, 0x5d, 0xa4, 0x9b, 0x34, 0x1a, 0x55, 0xad, 0x93, 0x32, 0x30,
+    0xf5, 0x8c, 0xb1, 0xe3, 0x1d, 0xf6, 0xe2, 0x2e, 0x82, 0x66, 0xca, 0x60,
+    0xc0, 0x29, 0x23, 0xab, 0x0d, 0x53, 0x4e, 0x6f, 0xd5, 0xdb, 0x37, 0x45,
+    0xde, 0xfd, 0x8e, 0x2f, 0x03, 0xff, 0x6a, 0x72, 0x6d, 0x6c, 0x5b, 0x51,
+    0x8d, 0x1b, 0xaf, 0x92, 0xbb, 0xdd, 0xbc, 0x7f, 0x11, 0xd9, 0x5c, 0x41,
+    0x1f, 0x10, 0x5a, 0xd8, 0x0a, 0xc1, 0x31, 0x88, 0xa5, 0xcd, 0x7b, 0xbd,
+    0x2d, 0x74, 0xd0, 0x12, 0xb8, 0xe5, 0xb4, 0xb0, 0x89, 0x69, 0x97, 0x4a,
+    0x0c, 0x96, 0x77, 0x7e, 0x65, 0xb9, 0xf1, 0x09, 0xc5, 0x6e, 0xc6, 0x84,
+    0x18, 0xf0, 0x7d, 0xec, 0x3a, 0xdc, 0x4d, 0x20, 0x79, 0xee, 0x5f, 0x3e,
+    0xd7, 0xcb, 0x39, 0x48,
+};
+
+/*
+ * The linear transform L applied to the S-box output placed in the most
+ * significant byte. L commutes with rotations, so the other input bytes
+ * use the same table, rotated.
+ */
+static const uint32_t SM4_T[256] =
+{
+    0x8ed55b5b, 0xd0924242, 0x4deaa7a7, 0x06fdfbfb, 0xfccf3333, 0x65e28787,
+    0xc93df4f4, 0x6bb5dede, 0x4e165858, 0x6eb4dada, 0x44145050, 0xcac10b0b,
+    0x8828a0a0, 0x17f8efef, 0x9c2cb0b0, 0x11051414, 0x872bacac, 0xfb669d9d,
+    0xf2986a6a, 0xae77d9d9, 0x822aa8a8, 0x46bcfafa, 0x14041010, 0xcfc00f0f,
+    0x02a8aaaa, 0x54451111, 0x5f134c4c, 0xbe269898, 0x6d482525, 0x9e841a1a,
+    0x1e061818, 0xfd9b6666, 0xec9e7272, 0x4a430909, 0x10514141, 0x24f7d3d3,
+    0xd5934646, 0x53ecbfbf, 0xf89a6262, 0x927be9e9, 0xff33cccc, 0x04555151,
+    0x270b2c2c, 0x4f420d0d, 0x59eeb7b7, 0xf3cc3f3f, 0x1caeb2b2, 0xea638989,
+    0x74e79393, 0x7fb1cece, 0x6c1c7070, 0x0daba6a6, 0xedca2727, 0x28082020,
+    0x48eba3a3, 0xc1975656, 0x80820202, 0xa3dc7f7f, 0xc4965252, 0x12f9ebeb,
+    0xa174d5d5, 0xb38d3e3e, 0xc33ffcfc, 0x3ea49a9a, 0x5b461d1d, 0x1b071c1c,
+    0x3ba59e9e, 0x0cfff3f3, 0x3ff0cfcf, 0xbf72cdcd, 0x4b175c5c, 0x52b8eaea,
+    0x8f810e0e, 0x3d586565, 0xcc3cf0f0, 0x7d196464, 0x7ee59b9b, 0x91871616,
+    0x734e3d3d, 0x08aaa2a2, 0xc869a1a1, 0xc76aadad, 0x85830606, 0x7ab0caca,
+    0xb570c5c5, 0xf4659191, 0xb2d96b6b, 0xa7892e2e, 0x18fbe3e3, 0x47e8afaf,
+    0x330f3c3c, 0x674a2d2d, 0xb071c1c1, 0x0e575959, 0xe99f7676, 0xe135d4d4,
+    0x661e7878, 0xb4249090, 0x360e3838, 0x265f7979, 0xef628d8d, 0x38596161,
+    0x95d24747, 0x2aa08a8a, 0xb1259494, 0xaa228888, 0x8c7df1f1, 0xd73becec,
+    0x05010404, 0xa5218484, 0x9879e1e1, 0x9b851e1e, 0x84d75353, 0x00000000,
+    0x5e471919, 0x0b565d5d, 0xe39d7e7e, 0x9fd04f4f, 0xbb279c9c, 0x1a534949,
+    0x7c4d3131, 0xee36d8d8, 0x0a020808, 0x7be49f9f, 0x20a28282, 0xd4c71313,
+    0xe8cb2323, 0xe69c7a7a, 0x42e9abab, 0x43bdfefe, 0xa2882a2a, 0x9ad14b4b,
+    0x40410101, 0xdbc41f1f, 0xd838e0e0, 0x61b7d6d6, 0x2fa18e8e, 0x2bf4dfdf,
+    0x3af1cbcb, 0xf6cd3b3b, 0x1dfae7e7, 0xe5608585, 0x41155454, 0x25a38686,
+    0x60e38383, 0x16acbaba, 0x295c7575, 0x34a69292, 0xf7996e6e, 0xe434d0d0,
+    0x721a6868, 0x01545555, 0x19afb6b6, 0xdf914e4e, 0xfa32c8c8, 0xf030c0c0,
+    0x21f6d7d7, 0xbc8e3232, 0x75b3c6c6, 0x6fe08f8f, 0x691d7474, 0x2ef5dbdb,
+    0x6ae18b8b, 0x962eb8b8, 0x8a800a0a, 0xfe679999, 0xe2c92b2b, 0xe0618181,
+    0xc0c30303, 0x8d29a4a4, 0xaf238c8c, 0x07a9aeae, 0x390d3434, 0x1f524d4d,
+    0x764f3939, 0xd36ebdbd, 0x81d65757, 0xb7d86f6f, 0xeb37dcdc, 0x51441515,
+    0xa6dd7b7b, 0x09fef7f7, 0xb68c3a3a, 0x932fbcbc, 0x0f030c0c, 0x03fcffff,
+    0xc26ba9a9, 0xba73c9c9, 0xd96cb5b5, 0xdc6db1b1, 0x375a6d6d, 0x15504545,
+    0xb98f3636, 0x771b6c6c, 0x13adbebe, 0xda904a4a, 0x57b9eeee, 0xa9de7777,
+    0x4cbef2f2, 0x837efdfd, 0x55114444, 0xbdda6767, 0x2c5d7171, 0x45400505,
+    0x631f7c7c, 0x50104040, 0x325b6969, 0xb8db6363, 0x220a2828, 0xc5c20707,
+    0xf531c4c4, 0xa88a2222, 0x31a79696, 0xf9ce3737, 0x977aeded, 0x49bff6f6,
+    0x992db4b4, 0xa475d1d1, 0x90d34343, 0x5a124848, 0x58bae2e2, 0x71e69797,
+    0x64b6d2d2, 0x70b2c2c2, 0xad8b2626, 0xcd68a5a5, 0xcb955e5e, 0x624b2929,
+    0x3c0c3030, 0xce945a5a, 0xab76dddd, 0x867ff9f9, 0xf1649595, 0x5dbbe6e6,
+    0x35f2c7c7, 0x2d092424, 0xd1c61717, 0xd66fb9b9, 0xdec51b1b, 0x94861212,
+    0x78186060, 0x30f3c3c3, 0x897cf5f5, 0x5cefb3b3, 0xd23ae8e8, 0xacdf7373,
+    0x794c3535, 0xa0208080, 0x9d78e5e5, 0x56edbbbb, 0x235e7d7d, 0xc63ef8f8,
+    0x8bd45f5f, 0xe7c82f2f, 0xdd39e4e4, 0x68492121,
+};
+
+static const uint32_t FK[4] =
+{
+    0xa3b1bac6, 0x56aa3350, 0x677d9197, 0xb27022dc,
+};
+
+static const uint32_t CK[32] =
+{
+    0x00070e15, 0x1c232a31, 0x383f464d, 0x545b6269, 0x70777e85, 0x8c939aa1,
+    0xa8afb6bd, 0xc4cbd2d9, 0xe0e7eef5, 0xfc030a11, 0x181f262d, 0x343b4249,
+    0x50575e65, 0x6c737a81, 0x888f969d, 0xa4abb2b9, 0xc0c7ced5, 0xdce3eaf1,
+    0xf8ff060d, 0x141b2229, 0x30373e45, 0x4c535a61, 0x686f767d, 0x848b9299,
+    0xa0a7aeb5, 0xbcc3cad1, 0xd8dfe6ed, 0xf4fb0209, 0x10171e25, 0x2c333a41,
+    0x484f565d, 0x646b7279,
+};
+
+/*
+ * The round transform T = L(tau(x))
+ */
+static inline uint32_t sm4_t( uint32_t x )
+{
+    return( SM4_T[x >> 24] ^ ROTR32( SM4_T[( x >> 16 ) & 0xff], 8 ) ^
+            ROTR32( SM4_T[( x >> 8 ) & 0xff], 16 ) ^
+            ROTR32( SM4_T[x & 0xff], 24 ) );
+}
+
+/*
+ * The transform T' = L'(tau(x)) of the key schedule
+ */
+static uint32_t sm4_t_key( uint32_t x )
+{
+    uint32_t b = ( (uint32_t) SBOX[x >> 24] << 24 ) |
+                 ( (uint32_t) SBOX[( x >> 16 ) & 0xff] << 16 ) |
+                 ( (uint32_t) SBOX[( x >> 8 ) & 0xff] << 8 ) |
+                 SBOX[x & 0xff];
+
+    return( b ^ ROTL32( b, 13 ) ^ ROTL32( b, 23 ) );
+}
+
+/*
+ * Encrypts or, with the round keys reversed, decrypts @n <= 4 blocks. The
+ * rounds of the blocks are interleaved so that their table lookups
+ * overlap.
+ */
+static inline void sm4_blocks_c( const uint32_t rk[32],
+                                 const unsigned char *input,
+                                 unsigned char *output, size_t n )
+{
+    uint32_t x0[4], x1[4], x2[4], x3[4];
+    size_t b;
+    int i;
+
+    for( b = 0; b < n; b++ )
+    {
+        GET_UINT32_BE( x0[b], input, 16 * b );
+        GET_UINT32_BE( x1[b], input, 16 * b + 4 );
+        GET_UINT32_BE( x2[b], input, 16 * b + 8 );
+        GET_UINT32_BE( x3[b], input, 16 * b + 12 );
+    }
+
+    for( i = 0; i < 32; i += 4 )
+    {
+        for( b = 0; b < n; b++ )
+            x0[b] ^= sm4_t( x1[b] ^ x2[b] ^ x3[b] ^ rk[i] );
+        for( b = 0; b < n; b++ )
+            x1[b] ^= sm4_t( x2[b] ^ x3[b] ^ x0[b] ^ rk[i + 1] );
+        for( b = 0; b < n; b++ )
+            x2[b] ^= sm4_t( x3[b] ^ x0[b] ^ x1[b] ^ rk[i + 2] );
+        for( b = 0; b < n; b++ )
+            x3[b] ^= sm4_t( x0[b] ^ x1[b] ^ x2[b] ^ rk[i + 3] );
+    }
+
+    for( b = 0; b < n; b++ )
+    {
+        PUT_UINT32_BE( x3[b], output, 16 * b );
+        PUT_UINT32_BE( x2[b], output, 16 * b + 4 );
+        PUT_UINT32_BE( x1[b], output, 16 * b + 8 );
+        PUT_UINT32_BE( x0[b], output, 16 * b + 12 );
+    }
+
+    mbedtls_platform_zeroize( x0, sizeof( x0 ) );
+    mbedtls_platform_zeroize( x1, sizeof( x1 ) );
+    mbedtls_platform_zeroize( x2, sizeof( x2 ) );
+    mbedtls_platform_zeroize( x3, sizeof( x3 ) );
+}
+
+#if defined(SM4_NEON)
+/*
+ * Byte permutations of the 32-bit lanes: rotations by 8 and 24 bits, and
+ * the inverse of the AES ShiftRows that AESE applies before SubBytes
+ */
+static const unsigned char SM4_ROL8[16] =
+{
+    3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14,
+};
+
+static const unsigned char SM4_ROL24[16] =
+{
+    1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12,
+};
+
+#if defined(SM4_CE)
+static const unsigned char SM4_INV_SHIFT_ROWS[16] =
+{
+    0, 13, 10, 7, 4, 1, 14, 11, 8, 5, 2, 15, 12, 9, 6, 3,
+};
+
+/*
+ * The SM4 and AES S-boxes are both an inversion in GF(2^8) between two
+ * affine transforms, over different but isomorphic fields, so that
+ * S(x) = A2(AES_S(A1(x))). Each affine transform is the sum of two
+ * lookups of 16 entries, for the low and the high nibble of x.
+ */
+static const unsigned char SM4_A1[2][16] =
+{
+    { 0x3e, 0xb2, 0x0e, 0x82, 0xbb, 0x37, 0x8b, 0x07,
+      0xa1, 0x2d, 0x91, 0x1d, 0x24, 0xa8, 0x14, 0x98 },
+    { 0x00, 0xdc, 0x2e, 0xf2, 0xc5, 0x19, 0xeb, 0x37,
+      0x08, 0xd4, 0x26, 0xfa, 0xcd, 0x11, 0xe3, 0x3f },
+};
+
+static const unsigned char SM4_A2[2][16] =
+{
+    { 0x6c, 0xd4, 0xa6, 0x1e, 0x52, 0xea, 0x98, 0x20,
+      0x0b, 0xb3, 0xc1, 0x79, 0x35, 0x8d, 0xff, 0x47 },
+    { 0x00, 0xe0, 0x50, 0xb0, 0x9d, 0x7d, 0xcd, 0x2d,
+      0xc0, 0x20, 0x90, 0x70, 0x5d, 0xbd, 0x0d, 0xed },
+};
+
+typedef struct
+{
+    uint8x16_t a1_lo, a1_hi, a2_lo, a2_hi, isr;
+} sm4_neon_sbox;
+
+static inline void sm4_neon_sbox_load( sm4_neon_sbox *s )
+{
+    s->a1_lo = vld1q_u8( SM4_A1[0] );
+    s->a1_hi = vld1q_u8( SM4_A1[1] );
+    s->a2_lo = vld1q_u8( SM4_A2[0] );
+    s->a2_hi = vld1q_u8( SM4_A2[1] );
+    s->isr = vld1q_u8( SM4_INV_SHIFT_ROWS );
+}
+
+static inline uint8x16_t sm4_neon_affine( uint8x16_t x, uint8x16_t lo,
+                                          uint8x16_t hi )
+{
+    return( veorq_u8( vqtbl1q_u8( lo, vandq_u8( x, vdupq_n_u8( 0x0f ) ) ),
+                      vqtbl1q_u8( hi, vshrq_n_u8( x, 4 ) ) ) );
+}
+
+static inline uint8x16_t sm4_neon_sub( const sm4_neon_sbox *s,
+                                       uint8x16_t x )
+{
+    x = sm4_neon_affine( x, s->a1_lo, s->a1_hi );
+    x = vaeseq_u8( vqtbl1q_u8( x, s->isr ), vdupq_n_u8( 0 ) );
+    return( sm4_neon_affine( x, s->a2_lo, s->a2_hi ) );
+}
+#else /* SM4_CE */
+typedef struct
+{
+    uint8x16x4_t t[4];
+} sm4_neon_sbox;
+
+static inline void sm4_neon_sbox_load( sm4_neon_sbox *s )
+{
+    int i, j;
+
+    for( i = 0; i < 4; i++ )
+        for( j = 0; j < 4; j++ )
+            s->t[i].val[j] = vld1q_u8( SBOX + 64 * i + 16 * j );
+}
+
+/* The S-box is 16 vector registers, looked up 64 entries at a time */
+static inline uint8x16_t sm4_neon_sub( const sm4_neon_sbox *s,
+                                       uint8x16_t x )
+{
+    uint8x16_t y = vqtbl4q_u8( s->t[0], x );
+
+    y = vqtbx4q_u8( y, s->t[1], veorq_u8( x, vdupq_n_u8( 0x40 ) ) );
+    y = vqtbx4q_u8( y, s->t[2], veorq_u8( x, vdupq_n_u8( 0x80 ) ) );
+    return( vqtbx4q_u8( y, s->t[3], veorq_u8( x, vdupq_n_u8( 0xc0 ) ) ) );
+}
+#endif /* SM4_CE */
+
+/*
+ * T on the word j of 4 blocks, L(B) being computed as
+ * B ^ (B <<< 24) ^ ((B ^ (B <<< 8) ^ (B <<< 16)) <<< 2)
+ */
+static inline uint32x4_t sm4_neon_t( const sm4_neon_sbox *s,
+                                     uint8x16_t rol8, uint8x16_t rol24,
+                                     uint32x4_t x )
+{
+    uint8x16_t b = sm4_neon_sub( s, vreinterpretq_u8_u32( x ) );
+    uint32x4_t u, l;
+
+    u = vreinterpretq_u32_u8( veorq_u8( veorq_u8( b,
+            vqtbl1q_u8( b, rol8 ) ),
+            vreinterpretq_u8_u16( vrev32q_u16( vreinterpretq_u16_u8( b ) ) ) ) );
+    l = vreinterpretq_u32_u8( veorq_u8( b, vqtbl1q_u8( b, rol24 ) ) );
+
+    return( veorq_u32( l, vsliq_n_u32( vshrq_n_u32( u, 30 ), u, 2 ) ) );
+}
+
+/* Transposes 4 blocks of 4 words, or the 4 words back into blocks */
+static inline void sm4_neon_transpose( uint32x4_t x[4] )
+{
+    uint32x4_t t0 = vtrn1q_u32( x[0], x[1] );
+    uint32x4_t t1 = vtrn2q_u32( x[0], x[1] );
+    uint32x4_t t2 = vtrn1q_u32( x[2], x[3] );
+    uint32x4_t t3 = vtrn2q_u32( x[2], x[3] );
+
+    x[0] = vreinterpretq_u32_u64( vtrn1q_u64( vreinterpretq_u64_u32( t0 ),
+                                              vreinterpretq_u64_u32( t2 ) ) );
+    x[1] = vreinterpretq_u32_u64( vtrn1q_u64( vreinterpretq_u64_u32( t1 ),
+                                              vreinterpretq_u64_u32( t3 ) ) );
+    x[2] = vreinterpretq_u32_u64( vtrn2q_u64( vreinterpretq_u64_u32( t0 ),
+                                              vreinterpretq_u64_u32( t2 ) ) );
+    x[3] = vreinterpretq_u32_u64( vtrn2q_u64( vreinterpretq_u64_u32( t1 ),
+                                              vreinterpretq_u64_u32( t3 ) ) );
+}
+
+/*
+ * Loads 4 blocks as 4 vectors of words, x[j] holding the word j of each
+ * block. Byte loads keep the buffers free of alignment constraints.
+ */
+static inline void sm4_neon_load( uint32x4_t x[4], const unsigned char *in )
+{
+    int j;
+
+    for( j = 0; j < 4; j++ )
+        x[j] = vreinterpretq_u32_u8( vrev32q_u8( vld1q_u8( in + 16 * j ) ) );
+    sm4_neon_transpose( x );
+}
+
+/* Stores the 4 blocks of x, the words of each in reverse order */
+static inline void sm4_neon_store( unsigned char *out, uint32x4_t x[4] )
+{
+    uint32x4_t t;
+    int j;
+
+    t = x[0];
+    x[0] = x[3];
+    x[3] = t;
+    t = x[1];
+    x[1] = x[2];
+    x[2] = t;
+    sm4_neon_transpose( x );
+    for( j = 0; j < 4; j++ )
+        vst1q_u8( out + 16 * j,
+                  vrev32q_u8( vreinterpretq_u8_u32( x[j] ) ) );
+}
+
+/*
+ * Encrypts or decrypts 8 blocks, two groups of 4 whose rounds are
+ * interleaved
+ */
+static void sm4_neon_blocks8( const uint32_t rk[32],
+                              const unsigned char *input,
+                              unsigned char *output )
+{
+    sm4_neon_sbox s;
+    uint8x16_t rol8 = vld1q_u8( SM4_ROL8 );
+    uint8x16_t rol24 = vld1q_u8( SM4_ROL24 );
+    uint32x4_t a[4], b[4], k;
+    int i, j;
+
+    sm4_neon_sbox_load( &s );
+    sm4_neon_load( a, input );
+    sm4_neon_load( b, input + 64 );
+
+    for( i = 0; i < 32; i++ )
+    {
+        j = i & 3;
+        k = vdupq_n_u32( rk[i] );
+        a[j] = veorq_u32( a[j], sm4_neon_t( &s, rol8, rol24,
+                 veorq_u32( veorq_u32( a[( j + 1 ) & 3], a[( j + 2 ) & 3] ),
+                            veorq_u32( a[( j + 3 ) & 3], k ) ) ) );
+        b[j] = veorq_u32( b[j], sm4_neon_t( &s, rol8, rol24,
+                 veorq_u32( veorq_u32( b[( j + 1 ) & 3], b[( j + 2 ) & 3] ),
+                            veorq_u32( b[( j + 3 ) & 3], k ) ) ) );
+    }
+
+    sm4_neon_store( output, a );
+    sm4_neon_store( output + 64, b );
+}
+#endif /* SM4_NEON */
+
+/*
+ * Encrypts or decrypts @n blocks, up to 8 at a time
+ */
+static void sm4_blocks( const uint32_t rk[32], const unsigned char *input,
+                        unsigned char *output, size_t n )
+{
+#if defined(SM4_NEON)
+    for( ; n >= 8; n -= 8, input += 128, output += 128 )
+        sm4_neon_blocks8( rk, input, output );
+#endif
+    for( ; n >= 4; n -= 4, input += 64, output += 64 )
+        sm4_blocks_c( rk, input, output, 4 );
+    if( n > 0 )
+        sm4_blocks_c( rk, input, output, n );
+}
+
+void mbedtls_sm4_init( mbedtls_sm4_context *ctx )
+{
+    if( ctx == NULL )
+        return;
+
+    memset( ctx, 0, sizeof( mbedtls_sm4_context ) );
+}
+
+int mbedtls_sm4_clone( mbedtls_sm4_context *dst,
+                       const mbedtls_sm4_context *src )
+{
+    if( dst == NULL || src == NULL )
+        return( MBEDTLS_ERR_SM4_BAD_INPUT_DATA );
+
+    *dst = *src;
+
+    return( 0 );
+}
+
+void mbedtls_sm4_free( mbedtls_sm4_context *ctx )
+{
+    if( ctx == NULL )
+        return;
+
+    mbedtls_platform_zeroize( ctx, sizeof( mbedtls_sm4_context ) );
+}
+
+#if defined(MBEDTLS_SM4_MODE_XTS)
+void mbedtls_sm4_xts_init( mbedtls_sm4_xts_context *ctx )
+{
+    if( ctx == NULL )
+        return;
+
+    mbedtls_sm4_init( &ctx->crypt );
+    mbedtls_sm4_init( &ctx->tweak );
+}
+
+int mbedtls_sm4_xts_clone( mbedtls_sm4_xts_context *dst,
+                           const mbedtls_sm4_xts_context *src )
+{
+    if( dst == NULL || src == NULL )
+        return( MBEDTLS_ERR_SM4_BAD_INPUT_DATA );
+
+    *dst = *src;
+
+    return( 0 );
+}
+
+void mbedtls_sm4_xts_free( mbedtls_sm4_xts_context *ctx )
+{
+    if( ctx == NULL )
+        return;
+
+    mbedtls_sm4_free( &ctx->crypt );
+    mbedtls_sm4_free( &ctx->tweak );
+}
+#endif /* MBEDTLS_SM4_MODE_XTS */
+
+/*
+ * Key schedule
+ */
+int mbedtls_sm4_setkey_enc( mbedtls_sm4_context *ctx, const unsigned char *key,
+                    unsigned int keybits )
+{
+    uint32_t k[4];
+    int i;
+
+    if( ctx == NULL || key == NULL )
+        return( MBEDTLS_ERR_SM4_BAD_INPUT_DATA );
+    if( keybits != 128 )
+        return( MBEDTLS_ERR_SM4_INVALID_KEY_LENGTH );
+
+    for( i = 0; i < 4; i++ )
+    {
+        GET_UINT32_BE( k[i], key, 4 * i );
+        k[i] ^= FK[i];
+    }
+
+    for( i = 0; i < 32; i++ )
+    {
+        k[i & 3] ^= sm4_t_key( k[( i + 1 ) & 3] ^ k[( i + 2 ) & 3] ^
+                               k[( i + 3 ) & 3] ^ CK[i] );
+        ctx->rk[i] = k[i & 3];
+    }
+
+    mbedtls_platform_zeroize( k, sizeof( k ) );
+
+    return( 0 );
+}
+
+/*
+ * Secure keys are unwrapped by the key ladder of the session, see
+ * mbedtls_klad_cache_set_default(), once per key
+ */
+static int sm4_unwrap_seckey( const mbedtls_sm4_sec_key_t *key,
+                              unsigned char k[16] )
+{
+#if defined(MBEDTLS_KLAD_CACHE_C)
+    mbedtls_klad_seckey_t sec;
+    size_t len;
+
+    if( key->ek3bits != 128 )
+        return( MBEDTLS_ERR_SM4_INVALID_KEY_LENGTH );
+
+    /* The same ladder as the secure keys of klad.h */
+    sec.sel = (mbedtls_klad_key_sel_t) key->sel;
+    sec.ek3bits = 128;
+    memcpy( sec.eks, key->eks, sizeof( sec.eks ) );
+
+    if( mbedtls_klad_cache_unwrap( NULL, &sec, k, &len ) != 0 )
+        return( MBEDTLS_ERR_SM4_FEATURE_UNAVAILABLE );
+
+    return( 0 );
+#else
+    (void) key;
+    (void) k;
+
+    /* Secure keys are only usable through the trust engine key ladder */
+    return( MBEDTLS_ERR_SM4_FEATURE_UNAVAILABLE );
+#endif /* MBEDTLS_KLAD_CACHE_C */
+}
+
+int mbedtls_sm4_setseckey_enc( mbedtls_sm4_context *ctx,
+                               mbedtls_sm4_sec_key_t *key )
+{
+    unsigned char k[16];
+    int ret;
+
+    if( ctx == NULL || key == NULL )
+        return( MBEDTLS_ERR_SM4_BAD_INPUT_DATA );
+
+    ret = sm4_unwrap_seckey( key, k );
+    if( ret == 0 )
+        ret = mbedtls_sm4_setkey_enc( ctx, k, 128 );
+
+    mbedtls_platform_zeroize( k, sizeof( k ) );
+    return( ret );
+}
+
+/*
+ * Decryption is encryption with the round keys in reverse order
+ */
+int mbedtls_sm4_setkey_dec( mbedtls_sm4_context *ctx, const unsigned char *key,
+                    unsigned int keybits )
+{
+    uint32_t t;
+    int i, ret;
+
+    ret = mbedtls_sm4_setkey_enc( ctx, key, keybits );
+    if( ret != 0 )
+        return( ret );
+
+    for( i = 0; i < 16; i++ )
+    {
+        t = ctx->rk[i];
+        ctx->rk[i] = ctx->rk[31 - i];
+        ctx->rk[31 - i] = t;
+    }
+
+    return( 0 );
+}
+
+int mbedtls_sm4_setseckey_dec( mbedtls_sm4_context *ctx,
+                               mbedtls_sm4_sec_key_t *key )
+{
+    unsigned char k[16];
+    int ret;
+
+    if( ctx == NULL || key == NULL )
+        return( MBEDTLS_ERR_SM4_BAD_INPUT_DATA );
+
+    ret = sm4_unwrap_seckey( key, k );
+    if( ret == 0 )
+        ret = mbedtls_sm4_setkey_dec( ctx, k, 128 );
+
+    mbedtls_platform_zeroize( k, sizeof( k ) );
+    return( ret );
+}
+
+#if defined(MBEDTLS_SM4_MODE_XTS)
+/*
+ * The tweak is always encrypted, with the second half of the key
+ */
+int mbedtls_sm4_xts_setkey_enc( mbedtls_sm4_xts_context *ctx,
+                                const unsigned char *key,
+                                unsigned int keybits )
+{
+    int ret;
+
+    if( ctx == NULL || key == NULL )
+        return( MBEDTLS_ERR_SM4_BAD_INPUT_DATA );
+    if( keybits != 256 )
+        return( MBEDTLS_ERR_SM4_INVALID_KEY_LENGTH );
+
+    ret = mbedtls_sm4_setkey_enc( &ctx->tweak, key + 16, 128 );
+    if( ret != 0 )
+        return( ret );
+
+    return( mbedtls_sm4_setkey_enc( &ctx->crypt, key, 128 ) );
+}
+
+int mbedtls_sm4_xts_setseckey_enc( mbedtls_sm4_xts_context *ctx,
+                                       mbedtls_sm4_sec_key_t *key1,
+                                       mbedtls_sm4_sec_key_t *key2)
+{
+    unsigned char k[32];
+    int ret;
+
+    if( ctx == NULL || key1 == NULL || key2 == NULL )
+        return( MBEDTLS_ERR_SM4_BAD_INPUT_DATA );
+
+    /* key1 encrypts the data and key2 the tweak, as in a 256-bit key */
+    ret = sm4_unwrap_seckey( key1, k );
+    if( ret == 0 )
+        ret = sm4_unwrap_seckey( key2, k + 16 );
+    if( ret == 0 )
+        ret = mbedtls_sm4_xts_setkey_enc( ctx, k, 256 );
+
+    mbedtls_platform_zeroize( k, sizeof( k ) );
+    return( ret );
+}
+
+int mbedtls_sm4_xts_setkey_dec( mbedtls_sm4_xts_context *ctx,
+                                const unsigned char *key,
+                                unsigned int keybits )
+{
+    int ret;
+
+    if( ctx == NULL || key == NULL )
+        return( MBEDTLS_ERR_SM4_BAD_INPUT_DATA );
+    if( keybits != 256 )
+        return( MBEDTLS_ERR_SM4_INVALID_KEY_LENGTH );
+
+    ret = mbedtls_sm4_setkey_enc( &ctx->tweak, key + 16, 128 );
+    if( ret != 0 )
+        return( ret );
+
+    return( mbedtls_sm4_setkey_dec( &ctx->crypt, key, 128 ) );
+}
+
+int mbedtls_sm4_xts_setseckey_dec( mbedtls_sm4_xts_context *ctx,
+                                       mbedtls_sm4_sec_key_t *key1,
+                                       mbedtls_sm4_sec_key_t *key2)
+{
+    unsigned char k[32];
+    int ret;
+
+    if( ctx == NULL || key1 == NULL || key2 == NULL )
+        return( MBEDTLS_ERR_SM4_BAD_INPUT_DATA );
+
+    /* key1 encrypts the data and key2 the tweak, as in a 256-bit key */
+    ret = sm4_unwrap_seckey( key1, k );
+    if( ret == 0 )
+        ret = sm4_unwrap_seckey( key2, k + 16 );
+    if( ret == 0 )
+        ret = mbedtls_sm4_xts_setkey_dec( ctx, k, 256 );
+
+    mbedtls_platform_zeroize( k, sizeof( k ) );
+    return( ret );
+}
+#endif /* MBEDTLS_SM4_MODE_XTS */
+
+/*
+ * SM4 block encryption and decryption, the direction being set by the
+ * order of the round keys
+ */
+int mbedtls_internal_sm4_encrypt( mbedtls_sm4_context *ctx,
+                                  const unsigned char input[16],
+                                  unsigned char output[16] )
+{
+    sm4_blocks_c( ctx->rk, input, output, 1 );
+
+    return( 0 );
+}
+
+int mbedtls_internal_sm4_decrypt( mbedtls_sm4_context *ctx,
+                                  const unsigned char input[16],
+                                  unsigned char output[16] )
+{
+    sm4_blocks_c( ctx->rk, input, output, 1 );
+
+    return( 0 );
+}
+
+#if !defined(MBEDTLS_DEPRECATED_REMOVED)
+void mbedtls_sm4_encrypt( mbedtls_sm4_context *ctx,
+                          const unsigned char input[16],
+                          unsigned char output[16] )
+{
+    mbedtls_internal_sm4_encrypt( ctx, input, output );
+}
+
+void mbedtls_sm4_decrypt( mbedtls_sm4_context *ctx,
+                          const unsigned char input[16],
+                          unsigned char output[16] )
+{
+    mbedtls_internal_sm4_decrypt( ctx, input, output );
+}
+#endif /* !MBEDTLS_DEPRECATED_REMOVED */
+
+/*
+ * SM4-ECB block encryption/decryption
+ */
+int mbedtls_sm4_crypt_ecb( mbedtls_sm4_context *ctx,
+                    int mode,
+                    const unsigned char input[16],
+                    unsigned char output[16] )
+{
+    if( mode == MBEDTLS_SM4_ENCRYPT )
+        return( mbedtls_internal_sm4_encrypt( ctx, input, output ) );
+    else
+        return( mbedtls_internal_sm4_decrypt( ctx, input, output ) );
+}
+
+int mbedtls_sm4_crypt_ecb_blocks( mbedtls_sm4_context *ctx,
+                                  int mode,
+                                  size_t length,
+                                  const unsigned char *input,
+                                  unsigned char *output )
+{
+    (void) mode;
+
+    if( length % 16 != 0 )
+        return( MBEDTLS_ERR_SM4_INVALID_INPUT_LENGTH );
+
+    sm4_blocks( ctx->rk, input, output, length / 16 );
+
+    return( 0 );
+}
+
+#if defined(MBEDTLS_CIPHER_MODE_CBC)
+/*
+ * SM4-CBC buffer encryption/decryption. Decryption, unlike encryption, is
+ * not chained and is done SM4_BULK_BLOCKS at a time.
+ */
+int mbedtls_sm4_crypt_cbc( mbedtls_sm4_context *ctx,
+                    int mode,
+                    size_t length,
+                    unsigned char iv[16],
+                    const unsigned char *input,
+                    unsigned char *output )
+{
+    unsigned char buf[16 * SM4_BULK_BLOCKS];
+    unsigned char last[16];
+    size_t i, n;
+
+    if( length % 16 != 0 )
+        return( MBEDTLS_ERR_SM4_INVALID_INPUT_LENGTH );
+
+    if( mode == MBEDTLS_SM4_DECRYPT )
+    {
+        while( length > 0 )
+        {
+            n = length < sizeof( buf ) ? length : sizeof( buf );
+            sm4_blocks( ctx->rk, input, buf, n / 16 );
+            memcpy( last, input + n - 16, 16 );
+
+            /*
+             * From the last block down, so that each ciphertext block is
+             * read before an in-place output overwrites it
+             */
+            for( i = n; i-- > 16; )
+                output[i] = buf[i] ^ input[i - 16];
+            for( i = 16; i-- > 0; )
+                output[i] = buf[i] ^ iv[i];
+
+            memcpy( iv, last, 16 );
+            input += n;
+            output += n;
+            length -= n;
+        }
+    }
+    else
+    {
+        while( length > 0 )
+        {
+            for( i = 0; i < 16; i++ )
+                buf[i] = input[i] ^ iv[i];
+            sm4_blocks_c( ctx->rk, buf, output, 1 );
+            memcpy( iv, output, 16 );
+
+            input += 16;
+            output += 16;
+            length -= 16;
+        }
+    }
+
+    mbedtls_platform_zeroize( buf, sizeof( buf ) );
+
+    return( 0 );
+}
+#endif /* MBEDTLS_CIPHER_MODE_CBC */
+
+#if defined(MBEDTLS_SM4_MODE_XTS)
+/*
+ * Multiplication by x of the tweak, in GF(2^128) with the bit order of
+ * IEEE P1619
+ */
+static void sm4_gf128mul_x_ble( unsigned char r[16],
+                                const unsigned char x[16] )
+{
+    unsigned char carry = x[15] >> 7;
+    int i;
+
+    for( i = 15; i > 0; i-- )
+        r[i] = (unsigned char) ( ( x[i] << 1 ) | ( x[i - 1] >> 7 ) );
+    r[0] = (unsigned char) ( ( x[0] << 1 ) ^ ( 0x87 & -carry ) );
+}
+
+/*
+ * SM4-XTS buffer encryption/decryption, SM4_BULK_BLOCKS blocks at a time
+ */
+int mbedtls_sm4_crypt_xts( mbedtls_sm4_xts_context *ctx,
+                           int mode,
+                           size_t length,
+                           unsigned char data_unit[16],
+                           const unsigned char *input,
+                           unsigned char *output )
+{
+    unsigned char tweaks[16 * SM4_BULK_BLOCKS];
+    unsigned char buf[16 * SM4_BULK_BLOCKS];
+    unsigned char tweak[16];
+    unsigned char prev_tweak[16];
+    unsigned char *t, *prev_output;
+    size_t blocks = length / 16;
+    size_t leftover = length % 16;
+    size_t i, n;
+
+    /* Data units must be at least 16 bytes long and at most 2^20 blocks */
+    if( length < 16 || length > ( (size_t) 1 << 24 ) )
+        return( MBEDTLS_ERR_SM4_INVALID_INPUT_LENGTH );
+
+    sm4_blocks_c( ctx->tweak.rk, data_unit, tweak, 1 );
+
+    /*
+     * With ciphertext stealing, the last full block is left to the code
+     * below
+     */
+    if( leftover != 0 )
+        blocks--;
+
+    while( blocks > 0 )
+    {
+        n = blocks < SM4_BULK_BLOCKS ? blocks : SM4_BULK_BLOCKS;
+        for( i = 0; i < n; i++ )
+        {
+            memcpy( tweaks + 16 * i, tweak, 16 );
+            sm4_gf128mul_x_ble( tweak, tweak );
+        }
+        for( i = 0; i < 16 * n; i++ )
+            buf[i] = input[i] ^ tweaks[i];
+        sm4_blocks( ctx->crypt.rk, buf, buf, n );
+        for( i = 0; i < 16 * n; i++ )
+            output[i] = buf[i] ^ tweaks[i];
+
+        input += 16 * n;
+        output += 16 * n;
+        blocks -= n;
+    }
+
+    if( leftover != 0 )
+    {
+        /*
+         * The last full block takes the tweak of the partial one when
+         * decrypting, and the other way round
+         */
+        memcpy( prev_tweak, tweak, 16 );
+        sm4_gf128mul_x_ble( tweak, tweak );
+        t = mode == MBEDTLS_SM4_DECRYPT ? tweak : prev_tweak;
+
+        for( i = 0; i < 16; i++ )
+            buf[i] = input[i] ^ t[i];
+        sm4_blocks_c( ctx->crypt.rk, buf, buf, 1 );
+        for( i = 0; i < 16; i++ )
+            output[i] = buf[i] ^ t[i];
+        input += 16;
+        output += 16;
+
+        /* Ciphertext stealing */
+        t = mode == MBEDTLS_SM4_DECRYPT ? prev_tweak : tweak;
+        prev_output = output - 16;
+        for( i = 0; i < leftover; i++ )
+        {
+            buf[i] = input[i] ^ t[i];
+            output[i] = prev_output[i];
+        }
+        for( ; i < 16; i++ )
+            buf[i] = prev_output[i] ^ t[i];
+        sm4_blocks_c( ctx->crypt.rk, buf, buf, 1 );
+        for( i = 0; i < 16; i++ )
+            prev_output[i] = buf[i] ^ t[i];
+    }
+
+    /* Next data unit */
+    for( i = 0; i < 16 && ++data_unit[i] == 0; i++ )
+        ;
+
+    mbedtls_platform_zeroize( tweaks, sizeof( tweaks ) );
+    mbedtls_platform_zeroize( buf, sizeof( buf ) );
+    mbedtls_platform_zeroize( tweak, sizeof( tweak ) );
+    mbedtls_platform_zeroize( prev_tweak, sizeof( prev_tweak ) );
+
+    return( 0 );
+}
+#endif /* MBEDTLS_SM4_MODE_XTS */
+
+#if defined(MBEDTLS_CIPHER_MODE_CFB)
+/*
+ * SM4-CFB128 buffer encryption/decryption
+ */
+int mbedtls_sm4_crypt_cfb128( mbedtls_sm4_context *ctx,
+                       int mode,
+                       size_t length,
+                       size_t *iv_off,
+                       unsigned char iv[16],
+                       const unsigned char *input,
+                       unsigned char *output )
+{
+    size_t n = *iv_off;
+    unsigned char c;
+
+    if( n > 15 )
+        return( MBEDTLS_ERR_SM4_BAD_INPUT_DATA );
+
+    while( length-- )
+    {
+        if( n == 0 )
+            sm4_blocks_c( ctx->rk, iv, iv, 1 );
+
+        if( mode == MBEDTLS_SM4_DECRYPT )
+        {
+            c = *input++;
+            *output++ = c ^ iv[n];
+            iv[n] = c;
+        }
+        else
+        {
+            iv[n] = *output++ = *input++ ^ iv[n];
+        }
+
+        n = ( n + 1 ) & 0x0f;
+    }
+
+    *iv_off = n;
+
+    return( 0 );
+}
+
+/*
+ * SM4-CFB8 buffer encryption/decryption
+ */
+int mbedtls_sm4_crypt_cfb8( mbedtls_sm4_context *ctx,
+                    int mode,
+                    size_t length,
+                    unsigned char iv[16],
+                    const unsigned char *input,
+                    unsigned char *output )
+{
+    unsigned char c;
+    unsigned char ov[17];
+
+    while( length-- )
+    {
+        memcpy( ov, iv, 16 );
+        sm4_blocks_c( ctx->rk, iv, iv, 1 );
+
+        if( mode == MBEDTLS_SM4_DECRYPT )
+            ov[16] = *input;
+
+        c = *output++ = (unsigned char)( iv[0] ^ *input++ );
+
+        if( mode == MBEDTLS_SM4_ENCRYPT )
+            ov[16] = c;
+
+        memcpy( iv, ov + 1, 16 );
+    }
+
+    return( 0 );
+}
+#endif /* MBEDTLS_CIPHER_MODE_CFB */
+
+#if defined(MBEDTLS_CIPHER_MODE_OFB)
+/*
+ * SM4-OFB (Output Feedback Mode) buffer encryption/decryption
+ */
+int mbedtls_sm4_crypt_ofb( mbedtls_sm4_context *ctx,
+                           size_t length,
+                           size_t *iv_off,
+                           unsigned char iv[16],
+                           const unsigned char *input,
+                           unsigned char *output )
+{
+    size_t n = *iv_off;
+
+    if( n > 15 )
+        return( MBEDTLS_ERR_SM4_BAD_INPUT_DATA );
+
+    while( length-- )
+    {
+        if( n == 0 )
+            sm4_blocks_c( ctx->rk, iv, iv, 1 );
+        *output++ = *input++ ^ iv[n];
+
+        n = ( n + 1 ) & 0x0f;
+    }
+
+    *iv_off = n;
+
+    return( 0 );
+}
+#endif /* MBEDTLS_CIPHER_MODE_OFB */
+
+#if defined(MBEDTLS_SM4_MODE_CTR)
+static void sm4_ctr_inc( unsigned char nonce_counter[16] )
+{
+    int i;
+
+    for( i = 16; i > 0; i-- )
+        if( ++nonce_counter[i - 1] != 0 )
+            break;
+}
+
+/*
+ * SM4-CTR buffer encryption/decryption, the keystream of the whole blocks
+ * being generated SM4_BULK_BLOCKS at a time
+ */
+int mbedtls_sm4_crypt_ctr( mbedtls_sm4_context *ctx,
+                       size_t length,
+                       size_t *nc_off,
+                       unsigned char nonce_counter[16],
+                       unsigned char stream_block[16],
+                       const unsigned char *input,
+                       unsigned char *output )
+{
+    unsigned char buf[16 * SM4_BULK_BLOCKS];
+    size_t n = *nc_off;
+    size_t i, m;
+
+    if( n > 15 )
+        return( MBEDTLS_ERR_SM4_BAD_INPUT_DATA );
+
+    /* Rest of the keystream block of the previous call */
+    while( n != 0 && length > 0 )
+    {
+        *output++ = *input++ ^ stream_block[n];
+        n = ( n + 1 ) & 0x0f;
+        length--;
+    }
+
+    while( length >= 16 )
+    {
+        m = length / 16 < SM4_BULK_BLOCKS ? length / 16 : SM4_BULK_BLOCKS;
+        for( i = 0; i < m; i++ )
+        {
+            memcpy( buf + 16 * i, nonce_counter, 16 );
+            sm4_ctr_inc( nonce_counter );
+        }
+        sm4_blocks( ctx->rk, buf, buf, m );
+        for( i = 0; i < 16 * m; i++ )
+            output[i] = input[i] ^ buf[i];
+
+        input += 16 * m;
+        output += 16 * m;
+        length -= 16 * m;
+    }
+
+    if( length > 0 )
+    {
+        sm4_blocks_c( ctx->rk, nonce_counter, stream_block, 1 );
+        sm4_ctr_inc( nonce_counter );
+        for( n = 0; n < length; n++ )
+            output[n] = input[n] ^ stream_block[n];
+    }
+
+    *nc_off = n;
+    mbedtls_platform_zeroize( buf, sizeof( buf ) );
+
+    return( 0 );
+}
+#endif /* MBEDTLS_SM4_MODE_CTR */
+
+#if defined(MBEDTLS_SELF_TEST)
+/*
+ * GB/T 32907-2016, appendix A.1
+ */
+static const unsigned char sm4_test_key[16] =
+{
+    0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef,
+    0xfe, 0xdc, 0xba, 0x98, 0x76, 0x54, 0x32, 0x10,
+};
+
+static const unsigned char sm4_test_block[16] =
+{
+    0x68, 0x1e, 0xdf, 0x34, 0xd2, 0x06, 0x96, 0x5e,
+    0x86, 0xb3, 0xe9, 0x4f, 0x53, 0x6e, 0x42, 0x46,
+};
+
+/*
+ * The modes encrypt the 160 bytes 0x00, 0x01, ..., 0x9f under the key
+ * above, CBC with the IV 0x00, 0x01, ..., 0x0f, CTR from the counter
+ * below, so that its low word wraps around, and XTS under the key above
+ * followed by sm4_test_key2 for the first data unit below. Checked against
+ * OpenSSL.
+ */
+static const unsigned char sm4_test_key2[16] =
+{
+    0xfe, 0xdc, 0xba, 0x98, 0x76, 0x54, 0x32, 0x10,
+    0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef,
+};
+
+static const unsigned char sm4_test_counter[16] =
+{
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+    0x08, 0x09, 0x0a, 0x0b, 0xff, 0xff, 0xff, 0xfe,
+};
+
+static const unsigned char sm4_test_data_unit[16] =
+{
+    0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08,
+    0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10,
+};
+
+static const unsigned char sm4_test_ecb[160] =
+{
+    0x06, 0x98, 0x9c, 0x61, 0x3d, 0xa6, 0x68, 0xad,
+    0x2a, 0x8d, 0xf7, 0x82, 0xe1, 0xa8, 0xf9, 0x6a,
+    0x4b, 0x91, 0x06, 0x51, 0x75, 0x4b, 0x55, 0x53,
+    0xf1, 0x0c, 0xfa, 0x0c, 0x8a, 0x09, 0xe9, 0xe5,
+    0xf4, 0x29, 0x52, 0xcf, 0x94, 0xac, 0x83, 0x68,
+    0x84, 0x37, 0xc9, 0xb6, 0x71, 0xd6, 0xc7, 0xfa,
+    0xd5, 0x5b, 0xfd, 0x68, 0xe7, 0x90, 0x12, 0x19,
+    0xf4, 0x1f, 0xab, 0x48, 0x42, 0x7a, 0xb5, 0x8d,
+    0x71, 0x8e, 0x20, 0x43, 0xba, 0xc7, 0xec, 0x8b,
+    0xfd, 0x57, 0xa9, 0x07, 0x11, 0x86, 0x50, 0x15,
+    0x0c, 0x2c, 0x0f, 0xab, 0x0b, 0x4e, 0x22, 0xee,
+    0x8d, 0xe3, 0x02, 0x8b, 0x16, 0x1a, 0x7c, 0x37,
+    0x1c, 0xd7, 0x85, 0x5a, 0xfd, 0x87, 0xef, 0x60,
+    0x6b, 0xcf, 0xed, 0xad, 0x65, 0xc8, 0x6b, 0x5b,
+    0x59, 0x68, 0x49, 0xdc, 0x7c, 0x7a, 0x6d, 0x63,
+    0xca, 0x3a, 0x76, 0x75, 0x38, 0xd1, 0x5e, 0xf6,
+    0x27, 0x4c, 0xe8, 0xf0, 0x40, 0xd6, 0x63, 0xda,
+    0x6e, 0x6d, 0xab, 0x9c, 0x56, 0x38, 0xb0, 0xf0,
+    0x3a, 0xe7, 0x76, 0x4f, 0xd2, 0x1a, 0x7e, 0x3f,
+    0xd8, 0xa0, 0xa0, 0x1b, 0x5e, 0xa5, 0xee, 0x7d,
+};
+
+static const unsigned char sm4_test_cbc[160] =
+{
+    0x26, 0x77, 0xf4, 0x6b, 0x09, 0xc1, 0x22, 0xcc,
+    0x97, 0x55, 0x33, 0x10, 0x5b, 0xd4, 0xa2, 0x2a,
+    0xd9, 0xee, 0x98, 0x83, 0x0e, 0x69, 0x74, 0x5c,
+    0x98, 0x27, 0xf9, 0x34, 0xa1, 0x96, 0x21, 0xf8,
+    0xdb, 0x45, 0xa4, 0x86, 0x45, 0x90, 0x9e, 0xef,
+    0xda, 0x6b, 0xae, 0x89, 0xa7, 0x2e, 0x65, 0x9b,
+    0xa6, 0x39, 0x4a, 0x4e, 0x05, 0xbd, 0x7c, 0xfe,
+    0x51, 0x48, 0x52, 0xa2, 0xab, 0x9a, 0x2d, 0x80,
+    0xcd, 0x87, 0x3a, 0x55, 0x85, 0xae, 0x7b, 0x01,
+    0xda, 0x2d, 0x9a, 0x41, 0x73, 0x93, 0x34, 0x5b,
+    0x83, 0xf4, 0x3b, 0xfc, 0x57, 0x91, 0x97, 0x60,
+    0x26, 0x1c, 0xb4, 0xdf, 0xbc, 0x04, 0xc7, 0x41,
+    0xba, 0xb9, 0x94, 0x8e, 0x77, 0xc0, 0x27, 0x2d,
+    0x28, 0x59, 0x87, 0x8a, 0x25, 0xa0, 0x04, 0x0a,
+    0xc1, 0xa5, 0xab, 0x06, 0xe7, 0x62, 0x7a, 0x32,
+    0x91, 0xd1, 0x54, 0x22, 0xdc, 0xa1, 0x62, 0xb8,
+    0xb5, 0x25, 0x97, 0x6b, 0x63, 0x57, 0x0c, 0x0c,
+    0x03, 0x17, 0x25, 0xc7, 0x8e, 0xcd, 0x00, 0x7c,
+    0x23, 0x35, 0x99, 0x53, 0xa3, 0xef, 0xc7, 0x4a,
+    0xdc, 0x98, 0x71, 0xae, 0xa3, 0xc3, 0x64, 0x52,
+};
+
+static const unsigned char sm4_test_ctr[150] =
+{
+    0xe1, 0xb0, 0x47, 0xbf, 0x00, 0xe2, 0x5b, 0x36,
+    0x12, 0xcb, 0xe6, 0xc4, 0xb5, 0x22, 0x5c, 0xf4,
+    0x93, 0xd8, 0x0d, 0x56, 0x8c, 0x68, 0x21, 0xf4,
+    0xb9, 0x95, 0xf6, 0x97, 0x82, 0xcd, 0x55, 0xac,
+    0x32, 0xf0, 0x23, 0x9d, 0x0d, 0xfd, 0x6d, 0x98,
+    0x8c, 0x81, 0xaa, 0x18, 0x7c, 0xd9, 0x2f, 0x39,
+    0x2a, 0x83, 0xf6, 0x98, 0x82, 0xbc, 0xbc, 0x77,
+    0x50, 0x07, 0x90, 0x4e, 0xdc, 0x22, 0x91, 0x9e,
+    0x6d, 0xa5, 0xc0, 0xb1, 0x08, 0x99, 0x5c, 0x31,
+    0x4a, 0xc9, 0x9f, 0x9b, 0x1a, 0x05, 0x1d, 0xbb,
+    0x06, 0x47, 0xa0, 0xf5, 0x7a, 0xef, 0x9d, 0xee,
+    0x5d, 0xd7, 0xdd, 0xe9, 0x28, 0xd1, 0xf2, 0x5a,
+    0xaa, 0x1a, 0xac, 0x54, 0x94, 0xdc, 0x95, 0xe2,
+    0x97, 0xdc, 0x18, 0xdb, 0x61, 0x07, 0x19, 0x37,
+    0x12, 0xd0, 0xc0, 0x78, 0xe2, 0xb5, 0x58, 0x70,
+    0x46, 0x1b, 0x3f, 0x2d, 0x05, 0x0f, 0x21, 0x1c,
+    0x17, 0xbf, 0x85, 0xc2, 0xb2, 0x57, 0xf0, 0x5d,
+    0x5a, 0x72, 0x24, 0x49, 0x8a, 0xdd, 0xa4, 0xe9,
+    0x21, 0x87, 0x6a, 0xe3, 0x2f, 0x9f,
+};
+
+static const unsigned char sm4_test_xts[149] =
+{
+    0xdd, 0xed, 0x98, 0x04, 0x89, 0x0a, 0x9a, 0x1f,
+    0xc7, 0x1a, 0xf3, 0x00, 0xbd, 0x7f, 0xa3, 0x78,
+    0xb1, 0xb1, 0x66, 0x84, 0x5a, 0x1b, 0x5e, 0xbb,
+    0xeb, 0x79, 0x94, 0xb8, 0x56, 0x2e, 0x88, 0x73,
+    0x40, 0x81, 0x8b, 0xe2, 0xe0, 0xca, 0xae, 0x66,
+    0x8d, 0x1e, 0x65, 0x4b, 0xbf, 0x53, 0x43, 0x23,
+    0xf2, 0x13, 0x01, 0x58, 0xb6, 0xbf, 0x55, 0x59,
+    0xea, 0x2b, 0x95, 0x0b, 0x84, 0x10, 0x06, 0x29,
+    0x78, 0x09, 0x64, 0xde, 0x74, 0xd5, 0x31, 0x2b,
+    0xc5, 0x31, 0xe5, 0x61, 0x1e, 0xd9, 0xf4, 0x1e,
+    0xc8, 0x61, 0x5d, 0x7d, 0x0e, 0x4d, 0x77, 0x43,
+    0x71, 0xb5, 0x52, 0x33, 0x32, 0x14, 0x3e, 0xf5,
+    0x82, 0x35, 0x26, 0x3b, 0x22, 0xed, 0x16, 0xb2,
+    0x0d, 0xf5, 0xd2, 0xbe, 0x6a, 0x7b, 0x95, 0xd2,
+    0xbf, 0x9a, 0x8c, 0xef, 0x2c, 0x47, 0x26, 0x5c,
+    0xf6, 0x03, 0x00, 0xdf, 0xd6, 0xcc, 0x0e, 0x47,
+    0x1d, 0x16, 0x14, 0x86, 0xf7, 0x97, 0xf8, 0x50,
+    0x6c, 0x28, 0x5b, 0x62, 0x3a, 0xb8, 0x34, 0xb7,
+    0xbf, 0xb6, 0x33, 0xcf, 0x6b,
+};
+
+
+#define SM4_TEST_LEN    160
+
+/*
+ * Checker routine
+ */
+int mbedtls_sm4_self_test( int verbose )
+{
+    mbedtls_sm4_context enc, dec;
+#if defined(MBEDTLS_SM4_MODE_XTS)
+    mbedtls_sm4_xts_context xts;
+    unsigned char xts_key[32];
+#endif
+    unsigned char pt[SM4_TEST_LEN];
+    unsigned char buf[SM4_TEST_LEN];
+    unsigned char iv[16];
+#if defined(MBEDTLS_SM4_MODE_CTR)
+    unsigned char stream_block[16];
+    size_t nc_off, n;
+#endif
+    size_t i;
+    int ret = 0;
+
+    mbedtls_sm4_init( &enc );
+    mbedtls_sm4_init( &dec );
+#if defined(MBEDTLS_SM4_MODE_XTS)
+    mbedtls_sm4_xts_init( &xts );
+#endif
+
+    for( i = 0; i < SM4_TEST_LEN; i++ )
+        pt[i] = (unsigned char) i;
+
+    if( verbose != 0 )
+        mbedtls_printf( "  SM4-ECB-128 (single block): " );
+
+    if( mbedtls_sm4_setkey_enc( &enc, sm4_test_key, 128 ) != 0 ||
+        mbedtls_sm4_setkey_dec( &dec, sm4_test_key, 128 ) != 0 ||
+        mbedtls_sm4_crypt_ecb( &enc, MBEDTLS_SM4_ENCRYPT, sm4_test_key,
+                               buf ) != 0 ||
+        memcmp( buf, sm4_test_block, 16 ) != 0 ||
+        mbedtls_sm4_crypt_ecb( &dec, MBEDTLS_SM4_DECRYPT, buf, buf ) != 0 ||
+        memcmp( buf, sm4_test_key, 16 ) != 0 )
+        goto fail;
+
+    if( verbose != 0 )
+        mbedtls_printf( "passed\n" );
+
+    /*
+     * The bulk modes, in one call so that the multi-block paths run, and
+     * in pieces when the mode allows it
+     */
+    if( verbose != 0 )
+        mbedtls_printf( "  SM4-ECB-128 (bulk): " );
+
+    if( mbedtls_sm4_crypt_ecb_blocks( &enc, MBEDTLS_SM4_ENCRYPT,
+                                      SM4_TEST_LEN, pt, buf ) != 0 ||
+        memcmp( buf, sm4_test_ecb, SM4_TEST_LEN ) != 0 ||
+        mbedtls_sm4_crypt_ecb_blocks( &dec, MBEDTLS_SM4_DECRYPT,
+                                      SM4_TEST_LEN, buf, buf ) != 0 ||
+        memcmp( buf, pt, SM4_TEST_LEN ) != 0 )
+        goto fail;
+
+    if( verbose != 0 )
+        mbedtls_printf( "passed\n" );
+
+#if defined(MBEDTLS_CIPHER_MODE_CBC)
+    if( verbose != 0 )
+        mbedtls_printf( "  SM4-CBC-128: " );
+
+    memcpy( iv, pt, 16 );
+    if( mbedtls_sm4_crypt_cbc( &enc, MBEDTLS_SM4_ENCRYPT, SM4_TEST_LEN, iv,
+                               pt, buf ) != 0 ||
+        memcmp( buf, sm4_test_cbc, SM4_TEST_LEN ) != 0 )
+        goto fail;
+
+    /* In place, in two calls */
+    memcpy( iv, pt, 16 );
+    if( mbedtls_sm4_crypt_cbc( &dec, MBEDTLS_SM4_DECRYPT, 48, iv,
+                               buf, buf ) != 0 ||
+        mbedtls_sm4_crypt_cbc( &dec, MBEDTLS_SM4_DECRYPT, SM4_TEST_LEN - 48,
+                               iv, buf + 48, buf + 48 ) != 0 ||
+        memcmp( buf, pt, SM4_TEST_LEN ) != 0 ||
+        memcmp( iv, sm4_test_cbc + SM4_TEST_LEN - 16, 16 ) != 0 )
+        goto fail;
+
+    if( verbose != 0 )
+        mbedtls_printf( "passed\n" );
+#endif /* MBEDTLS_CIPHER_MODE_CBC */
+
+#if defined(MBEDTLS_SM4_MODE_CTR)
+    if( verbose != 0 )
+        mbedtls_printf( "  SM4-CTR-128: " );
+
+    memcpy( iv, sm4_test_counter, 16 );
+    nc_off = 0;
+    if( mbedtls_sm4_crypt_ctr( &enc, sizeof( sm4_test_ctr ), &nc_off, iv,
+                               stream_block, pt, buf ) != 0 ||
+        memcmp( buf, sm4_test_ctr, sizeof( sm4_test_ctr ) ) != 0 )
+        goto fail;
+
+    /* In pieces of 1 to 37 bytes, across the block boundaries */
+    memcpy( iv, sm4_test_counter, 16 );
+    nc_off = 0;
+    for( i = 0; i < sizeof( sm4_test_ctr ); i += n )
+    {
+        n = ( i % 37 ) + 1;
+        if( n > sizeof( sm4_test_ctr ) - i )
+            n = sizeof( sm4_test_ctr ) - i;
+        if( mbedtls_sm4_crypt_ctr( &enc, n, &nc_off, iv, stream_block,
+                                   sm4_test_ctr + i, buf + i ) != 0 )
+            goto fail;
+    }
+    if( memcmp( buf, pt, sizeof( sm4_test_ctr ) ) != 0 )
+        goto fail;
+
+    if( verbose != 0 )
+        mbedtls_printf( "passed\n" );
+#endif /* MBEDTLS_SM4_MODE_CTR */
+
+#if defined(MBEDTLS_SM4_MODE_XTS)
+    if( verbose != 0 )
+        mbedtls_printf( "  SM4-XTS-128: " );
+
+    memcpy( xts_key, sm4_test_key, 16 );
+    memcpy( xts_key + 16, sm4_test_key2, 16 );
+
+    memcpy( iv, sm4_test_data_unit, 16 );
+    if( mbedtls_sm4_xts_setkey_enc( &xts, xts_key, 256 ) != 0 ||
+        mbedtls_sm4_crypt_xts( &xts, MBEDTLS_SM4_ENCRYPT,
+                               sizeof( sm4_test_xts ), iv, pt, buf ) != 0 ||
+        memcmp( buf, sm4_test_xts, sizeof( sm4_test_xts ) ) != 0 )
+        goto fail;
+
+    memcpy( iv, sm4_test_data_unit, 16 );
+    if( mbedtls_sm4_xts_setkey_dec( &xts, xts_key, 256 ) != 0 ||
+        mbedtls_sm4_crypt_xts( &xts, MBEDTLS_SM4_DECRYPT,
+                               sizeof( sm4_test_xts ), iv, buf, buf ) != 0 ||
+        memcmp( buf, pt, sizeof( sm4_test_xts ) ) != 0 )
+        goto fail;
+
+    /* The data unit is incremented for the next call */
+    if( iv[0] != sm4_test_data_unit[0] + 1 ||
+        memcmp( iv + 1, sm4_test_data_unit + 1, 15 ) != 0 )
+        goto fail;
+
+    if( verbose != 0 )
+        mbedtls_printf( "passed\n" );
+#endif /* MBEDTLS_SM4_MODE_XTS */
+
+    if( verbose != 0 )
+        mbedtls_printf( "\n" );
+
+    goto exit;
+
+fail:
+    if( verbose != 0 )
+        mbedtls_printf( "failed\n" );
+    ret = 1;
+
+exit:
+    mbedtls_sm4_free( &enc );
+    mbedtls_sm4_free( &dec );
+#if defined(MBEDTLS_SM4_MODE_XTS)
+    mbedtls_sm4_xts_free( &xts );
+    mbedtls_platform_zeroize( xts_key, sizeof( xts_key ) );
+#endif
+    return( ret );
+}
+
+#endif /* MBEDTLS_SELF_TEST */
+
+#endif /* !MBEDTLS_SM4_ALT */
+
+#endif /* MBEDTLS_SM4_C */
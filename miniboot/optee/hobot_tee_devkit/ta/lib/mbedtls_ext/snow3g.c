@@ -0,0 +1,1508 @@
+/*
+ *  SNOW 3G stream cipher and the 3GPP UEA2 / UIA2 algorithms
+ *
+ *  Copyright (c) 2026, D-Robotics
+ *  SPDX-License-Identifier: BSD-2-Clause
+ */
+/*
+ *  ETSI/SAGE Specification of the 3GPP Confidentiality and Integrity
+ *  Algorithms UEA2 & UIA2:
+ *
+ *  Document 1: UEA2 and UIA2 Specification
+ *  Document 2: SNOW 3G Specification
+ *  Documents 4 and 5: Implementors' and Design Conformance Test Data, see
+ *  mbedtls_snow3g_self_test()
+ */
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#if defined(MBEDTLS_SNOW3G_C)
+
+#include "mbedtls/snow3g.h"
+#include "mbedtls/platform_util.h"
+#if defined(MBEDTLS_KLAD_CACHE_C)
+#include "mbedtls/klad_cache.h"
+#endif
+
+#include <string.h>
+
+#if defined(MBEDTLS_SELF_TEST)
+#if defined(MBEDTLS_PLATFORM_C)
+#include "mbedtls/platform.h"
+#else
+#include <stdio.h>
+#define mbedtls_printf printf
+#endif /* MBEDTLS_PLATFORM_C */
+#endif /* MBEDTLS_SELF_TEST */
+
+#if !defined(MBEDTLS_SNOW3G_ALT)
+
+/*
+ * UIA2 multiplies in GF(2^64) with PMULL when the compiler targets the
+ * Armv8 Cryptographic Extension, see CFG_TA_CRYPTO_WITH_CE
+ */
+#if defined(__aarch64__) && \
+    ( defined(__ARM_FEATURE_AES) || defined(__ARM_FEATURE_CRYPTO) )
+#define SNOW3G_PMULL
+#include <arm_neon.h>
+#endif
+
+/*
+ * 32-bit integer manipulation macros (big endian)
+ */
+#ifndef GET_UINT32_BE
+#define GET_UINT32_BE(n,b,i)                            \
+do {                                                    \
+    (n) = ( (uint32_t) (b)[(i)    ] << 24 )             \
+        | ( (uint32_t) (b)[(i) + 1] << 16 )             \
+        | ( (uint32_t) (b)[(i) + 2] <<  8 )             \
+        | ( (uint32_t) (b)[(i) + 3]       );            \
+} while( 0 )
+#endif
+
+#ifndef PUT_UINT32_BE
+#define PUT_UINT32_BE(n,b,i)                            \
+do {                                                    \
+    (b)[(i)    ] = (unsigned char) ( (n) >> 24 );       \
+    (b)[(i) + 1] = (unsigned char) ( (n) >> 16 );       \
+    (b)[(i) + 2] = (unsigned char) ( (n) >>  8 );       \
+    (b)[(i) + 3] = (unsigned char) ( (n)       );       \
+} while( 0 )
+#endif
+
+#define SNOW3G_STATE_INIT       0   /* Context initialized */
+#define SNOW3G_STATE_KEY        1   /* Key set */
+#define SNOW3G_STATE_STARTED    2   /* Count, bearer/fresh and dir set */
+
+/* Keystream words generated at once by the bulk loops */
+#define SNOW3G_BLOCK_WORDS      16
+
+#define ROTR32( x, n )      ( ( (x) >> (n) ) | ( (x) << ( 32 - (n) ) ) )
+
+/*
+ * S1 T-table: row 0 of the S1 MixColumn applied to SR[x], the rows
+ * of the other input bytes are rotations of it
+ */
+static const uint32_t S1_T[256] =
+{
+    0xc6a56363, 0xf8847c7c, 0xee997777, 0xf68d7b7b, 0xff0df2f2, 0xd6bd6b6b,
+    0xdeb16f6f, 0x9154c5c5, 0x60503030, 0x02030101, 0xcea96767, 0x567d2b2b,
+    0xe719fefe, 0xb562d7d7, 0x4de6abab, 0xec9a7676, 0x8f45caca, 0x1f9d8282,
+    0x8940c9c9, 0xfa877d7d, 0xef15fafa, 0xb2eb5959, 0x8ec94747, 0xfb0bf0f0,
+    0x41ecadad, 0xb367d4d4, 0x5ffda2a2, 0x45eaafaf, 0x23bf9c9c, 0x53f7a4a4,
+    0xe4967272, 0x9b5bc0c0, 0x75c2b7b7, 0xe11cfdfd, 0x3dae9393, 0x4c6a2626,
+    0x6c5a3636, 0x7e413f3f, 0xf502f7f7, 0x834fcccc, 0x685c3434, 0x51f4a5a5,
+    0xd134e5e5, 0xf908f1f1, 0xe2937171, 0xab73d8d8, 0x62533131, 0x2a3f1515,
+    0x080c0404, 0x9552c7c7, 0x46652323, 0x9d5ec3c3, 0x30281818, 0x37a19696,
+    0x0a0f0505, 0x2fb59a9a, 0x0e090707, 0x24361212, 0x1b9b8080, 0xdf3de2e2,
+    0xcd26ebeb, 0x4e692727, 0x7fcdb2b2, 0xea9f7575, 0x121b0909, 0x1d9e8383,
+    0x58742c2c, 0x342e1a1a, 0x362d1b1b, 0xdcb26e6e, 0xb4ee5a5a, 0x5bfba0a0,
+    0xa4f65252, 0x764d3b3b, 0xb761d6d6, 0x7dceb3b3, 0x527b2929, 0xdd3ee3e3,
+    0x5e712f2f, 0x13978484, 0xa6f55353, 0xb968d1d1, 0x00000000, 0xc12ceded,
+    0x40602020, 0xe31ffcfc, 0x79c8b1b1, 0xb6ed5b5b, 0xd4be6a6a, 0x8d46cbcb,
+    0x67d9bebe, 0x724b3939, 0x94de4a4a, 0x98d44c4c, 0xb0e85858, 0x854acfcf,
+    0xbb6bd0d0, 0xc52aefef, 0x4fe5aaaa, 0xed16fbfb, 0x86c54343, 0x9ad74d4d,
+    0x66553333, 0x11948585, 0x8acf4545, 0xe910f9f9, 0x04060202, 0xfe817f7f,
+    0xa0f05050, 0x78443c3c, 0x25ba9f9f, 0x4be3a8a8, 0xa2f35151, 0x5dfea3a3,
+    0x80c04040, 0x058a8f8f, 0x3fad9292, 0x21bc9d9d, 0x70483838, 0xf104f5f5,
+    0x63dfbcbc, 0x77c1b6b6, 0xaf75dada, 0x42632121, 0x20301010, 0xe51affff,
+    0xfd0ef3f3, 0xbf6dd2d2, 0x814ccdcd, 0x18140c0c, 0x26351313, 0xc32fecec,
+    0xbee15f5f, 0x35a29797, 0x88cc4444, 0x2e391717, 0x9357c4c4, 0x55f2a7a7,
+    0xfc827e7e, 0x7a473d3d, 0xc8ac6464, 0xbae75d5d, 0x322b1919, 0xe6957373,
+    0xc0a06060, 0x19988181, 0x9ed14f4f, 0xa37fdcdc, 0x44662222, 0x547e2a2a,
+    0x3bab9090, 0x0b838888, 0x8cca4646, 0xc729eeee, 0x6bd3b8b8, 0x283c1414,
+    0xa779dede, 0xbce25e5e, 0x161d0b0b, 0xad76dbdb, 0xdb3be0e0, 0x64563232,
+    0x744e3a3a, 0x141e0a0a, 0x92db4949, 0x0c0a0606, 0x486c2424, 0xb8e45c5c,
+    0x9f5dc2c2, 0xbd6ed3d3, 0x43efacac, 0xc4a66262, 0x39a89191, 0x31a49595,
+    0xd337e4e4, 0xf28b7979, 0xd532e7e7, 0x8b43c8c8, 0x6e593737, 0xdab76d6d,
+    0x018c8d8d, 0xb164d5d5, 0x9cd24e4e, 0x49e0a9a9, 0xd8b46c6c, 0xacfa5656,
+    0xf307f4f4, 0xcf25eaea, 0xcaaf6565, 0xf48e7a7a, 0x47e9aeae, 0x10180808,
+    0x6fd5baba, 0xf0887878, 0x4a6f2525, 0x5c722e2e, 0x38241c1c, 0x57f1a6a6,
+    0x73c7b4b4, 0x9751c6c6, 0xcb23e8e8, 0xa17cdddd, 0xe89c7474, 0x3e211f1f,
+    0x96dd4b4b, 0x61dcbdbd, 0x0d868b8b, 0x0f858a8a, 0xe0907070, 0x7c423e3e,
+    0x71c4b5b5, 0xccaa6666, 0x90d84848, 0x06050303, 0xf701f6f6, 0x1c120e0e,
+    0xc2a36161, 0x6a5f3535, 0xaef95757, 0x69d0b9b9, 0x17918686, 0x9958c1c1,
+    0x3a271d1d, 0x27b99e9e, 0xd938e1e1, 0xeb13f8f8, 0x2bb39898, 0x22331111,
+    0xd2bb6969, 0xa970d9d9, 0x07898e8e, 0x33a79494, 0x2db69b9b, 0x3c221e1e,
+    0x15928787, 0xc920e9e9, 0x8749cece, 0xaaff5555, 0x50782828, 0xa57adfdf,
+    0x038f8c8c, 0x59f8a1a1, 0x09808989, 0x1a170d0d, 0x65dabfbf, 0xd731e6e6,
+    0x84c64242, 0xd0b86868, 0x82c34141, 0x29b09999, 0x5a772d2d, 0x1e110f0f,
+    0x7bcbb0b0, 0xa8fc5454, 0x6dd6bbbb, 0x2c3a1616,
+};
+
+/*
+ * S2 T-table, the same for SQ[x] and the polynomial 0x69
+ */
+static const uint32_t S2_T[256] =
+{
+    0x4a6f2525, 0x486c2424, 0xe6957373, 0xcea96767, 0xc710d7d7, 0x359baeae,
+    0xb8e45c5c, 0x60503030, 0x2185a4a4, 0xb55beeee, 0xdcb26e6e, 0xff34cbcb,
+    0xfa877d7d, 0x03b6b5b5, 0x6def8282, 0xdf04dbdb, 0xa145e4e4, 0x75fb8e8e,
+    0x90d84848, 0x92db4949, 0x9ed14f4f, 0xbae75d5d, 0xd4be6a6a, 0xf0887878,
+    0xe0907070, 0x79f18888, 0xb951e8e8, 0xbee15f5f, 0xbce25e5e, 0x61e58484,
+    0xcaaf6565, 0xad4fe2e2, 0xd901d8d8, 0xbb52e9e9, 0xf13dcccc, 0xb35eeded,
+    0x80c04040, 0x5e712f2f, 0x22331111, 0x50782828, 0xaef95757, 0xcd1fd2d2,
+    0x319dacac, 0xaf4ce3e3, 0x94de4a4a, 0x2a3f1515, 0x362d1b1b, 0x1ba2b9b9,
+    0x0dbfb2b2, 0x69e98080, 0x63e68585, 0x2583a6a6, 0x5c722e2e, 0x04060202,
+    0x8ec94747, 0x527b2929, 0x0e090707, 0x96dd4b4b, 0x1c120e0e, 0xeb2ac1c1,
+    0xa2f35151, 0x3d97aaaa, 0x7bf28989, 0xc115d4d4, 0xfd37caca, 0x02030101,
+    0x8cca4646, 0x0fbcb3b3, 0xb758efef, 0xd30edddd, 0x88cc4444, 0xf68d7b7b,
+    0xed2fc2c2, 0xfe817f7f, 0x15abbebe, 0xef2cc3c3, 0x57c89f9f, 0x40602020,
+    0x98d44c4c, 0xc8ac6464, 0x6fec8383, 0x2d8fa2a2, 0xd0b86868, 0x84c64242,
+    0x26351313, 0x01b5b4b4, 0x82c34141, 0xf33ecdcd, 0x1da7baba, 0xe523c6c6,
+    0x1fa4bbbb, 0xdab76d6d, 0x9ad74d4d, 0xe2937171, 0x42632121, 0x8175f4f4,
+    0x73fe8d8d, 0x09b9b0b0, 0xa346e5e5, 0x4fdc9393, 0x956bfefe, 0x77f88f8f,
+    0xa543e6e6, 0xf738cfcf, 0x86c54343, 0x8acf4545, 0x62533131, 0x44662222,
+    0x6e593737, 0x6c5a3636, 0x45d39696, 0x9d67fafa, 0x11adbcbc, 0x1e110f0f,
+    0x10180808, 0xa4f65252, 0x3a271d1d, 0xaaff5555, 0x342e1a1a, 0xe326c5c5,
+    0x9cd24e4e, 0x46652323, 0xd2bb6969, 0xf48e7a7a, 0x4ddf9292, 0x9768ffff,
+    0xb6ed5b5b, 0xb4ee5a5a, 0xbf54ebeb, 0x5dc79a9a, 0x38241c1c, 0x3b92a9a9,
+    0xcb1ad1d1, 0xfc827e7e, 0x1a170d0d, 0x916dfcfc, 0xa0f05050, 0x7df78a8a,
+    0x05b3b6b6, 0xc4a66262, 0x8376f5f5, 0x141e0a0a, 0x9961f8f8, 0xd10ddcdc,
+    0x06050303, 0x78443c3c, 0x18140c0c, 0x724b3939, 0x8b7af1f1, 0x19a1b8b8,
+    0x8f7cf3f3, 0x7a473d3d, 0x8d7ff2f2, 0xc316d5d5, 0x47d09797, 0xccaa6666,
+    0x6bea8181, 0x64563232, 0x2989a0a0, 0x00000000, 0x0c0a0606, 0xf53bcece,
+    0x8573f6f6, 0xbd57eaea, 0x07b0b7b7, 0x2e391717, 0x8770f7f7, 0x71fd8c8c,
+    0xf28b7979, 0xc513d6d6, 0x2780a7a7, 0x17a8bfbf, 0x7ff48b8b, 0x7e413f3f,
+    0x3e211f1f, 0xa6f55353, 0xc6a56363, 0xea9f7575, 0x6a5f3535, 0x58742c2c,
+    0xc0a06060, 0x936efdfd, 0x4e692727, 0xcf1cd3d3, 0x41d59494, 0x2386a5a5,
+    0xf8847c7c, 0x2b8aa1a1, 0x0a0f0505, 0xb0e85858, 0x5a772d2d, 0x13aebdbd,
+    0xdb02d9d9, 0xe720c7c7, 0x3798afaf, 0xd6bd6b6b, 0xa8fc5454, 0x161d0b0b,
+    0xa949e0e0, 0x70483838, 0x080c0404, 0xf931c8c8, 0x53ce9d9d, 0xa740e7e7,
+    0x283c1414, 0x0bbab1b1, 0x67e08787, 0x51cd9c9c, 0xd708dfdf, 0xdeb16f6f,
+    0x9b62f9f9, 0xdd07dada, 0x547e2a2a, 0xe125c4c4, 0xb2eb5959, 0x2c3a1616,
+    0xe89c7474, 0x4bda9191, 0x3f94abab, 0x4c6a2626, 0xc2a36161, 0xec9a7676,
+    0x685c3434, 0x567d2b2b, 0x339eadad, 0x5bc29999, 0x9f64fbfb, 0xe4967272,
+    0xb15decec, 0x66553333, 0x24361212, 0xd50bdede, 0x59c19898, 0x764d3b3b,
+    0xe929c0c0, 0x5fc49b9b, 0x7c423e3e, 0x30281818, 0x20301010, 0x744e3a3a,
+    0xacfa5656, 0xab4ae1e1, 0xee997777, 0xfb32c9c9, 0x3c221e1e, 0x55cb9e9e,
+    0x43d69595, 0x2f8ca3a3, 0x49d99090, 0x322b1919, 0x3991a8a8, 0xd8b46c6c,
+    0x121b0909, 0xc919d0d0, 0x8979f0f0, 0x65e38686,
+};
+
+/*
+ * MUL_alpha(c), c being the most significant byte of s0
+ */
+static const uint32_t MUL_ALPHA[256] =
+{
+    0x00000000, 0xe19fcf13, 0x6b973726, 0x8a08f835, 0xd6876e4c, 0x3718a15f,
+    0xbd10596a, 0x5c8f9679, 0x05a7dc98, 0xe438138b, 0x6e30ebbe, 0x8faf24ad,
+    0xd320b2d4, 0x32bf7dc7, 0xb8b785f2, 0x59284ae1, 0x0ae71199, 0xeb78de8a,
+    0x617026bf, 0x80efe9ac, 0xdc607fd5, 0x3dffb0c6, 0xb7f748f3, 0x566887e0,
+    0x0f40cd01, 0xeedf0212, 0x64d7fa27, 0x85483534, 0xd9c7a34d, 0x38586c5e,
+    0xb250946b, 0x53cf5b78, 0x1467229b, 0xf5f8ed88, 0x7ff015bd, 0x9e6fdaae,
+    0xc2e04cd7, 0x237f83c4, 0xa9777bf1, 0x48e8b4e2, 0x11c0fe03, 0xf05f3110,
+    0x7a57c925, 0x9bc80636, 0xc747904f, 0x26d85f5c, 0xacd0a769, 0x4d4f687a,
+    0x1e803302, 0xff1ffc11, 0x75170424, 0x9488cb37, 0xc8075d4e, 0x2998925d,
+    0xa3906a68, 0x420fa57b, 0x1b27ef9a, 0xfab82089, 0x70b0d8bc, 0x912f17af,
+    0xcda081d6, 0x2c3f4ec5, 0xa637b6f0, 0x47a879e3, 0x28ce449f, 0xc9518b8c,
+    0x435973b9, 0xa2c6bcaa, 0xfe492ad3, 0x1fd6e5c0, 0x95de1df5, 0x7441d2e6,
+    0x2d699807, 0xccf65714, 0x46feaf21, 0xa7616032, 0xfbeef64b, 0x1a713958,
+    0x9079c16d, 0x71e60e7e, 0x22295506, 0xc3b69a15, 0x49be6220, 0xa821ad33,
+    0xf4ae3b4a, 0x1531f459, 0x9f390c6c, 0x7ea6c37f, 0x278e899e, 0xc611468d,
+    0x4c19beb8, 0xad8671ab, 0xf109e7d2, 0x109628c1, 0x9a9ed0f4, 0x7b011fe7,
+    0x3ca96604, 0xdd36a917, 0x573e5122, 0xb6a19e31, 0xea2e0848, 0x0bb1c75b,
+    0x81b93f6e, 0x6026f07d, 0x390eba9c, 0xd891758f, 0x52998dba, 0xb30642a9,
+    0xef89d4d0, 0x0e161bc3, 0x841ee3f6, 0x65812ce5, 0x364e779d, 0xd7d1b88e,
+    0x5dd940bb, 0xbc468fa8, 0xe0c919d1, 0x0156d6c2, 0x8b5e2ef7, 0x6ac1e1e4,
+    0x33e9ab05, 0xd2766416, 0x587e9c23, 0xb9e15330, 0xe56ec549, 0x04f10a5a,
+    0x8ef9f26f, 0x6f663d7c, 0x50358897, 0xb1aa4784, 0x3ba2bfb1, 0xda3d70a2,
+    0x86b2e6db, 0x672d29c8, 0xed25d1fd, 0x0cba1eee, 0x5592540f, 0xb40d9b1c,
+    0x3e056329, 0xdf9aac3a, 0x83153a43, 0x628af550, 0xe8820d65, 0x091dc276,
+    0x5ad2990e, 0xbb4d561d, 0x3145ae28, 0xd0da613b, 0x8c55f742, 0x6dca3851,
+    0xe7c2c064, 0x065d0f77, 0x5f754596, 0xbeea8a85, 0x34e272b0, 0xd57dbda3,
+    0x89f22bda, 0x686de4c9, 0xe2651cfc, 0x03fad3ef, 0x4452aa0c, 0xa5cd651f,
+    0x2fc59d2a, 0xce5a5239, 0x92d5c440, 0x734a0b53, 0xf942f366, 0x18dd3c75,
+    0x41f57694, 0xa06ab987, 0x2a6241b2, 0xcbfd8ea1, 0x977218d8, 0x76edd7cb,
+    0xfce52ffe, 0x1d7ae0ed, 0x4eb5bb95, 0xaf2a7486, 0x25228cb3, 0xc4bd43a0,
+    0x9832d5d9, 0x79ad1aca, 0xf3a5e2ff, 0x123a2dec, 0x4b12670d, 0xaa8da81e,
+    0x2085502b, 0xc11a9f38, 0x9d950941, 0x7c0ac652, 0xf6023e67, 0x179df174,
+    0x78fbcc08, 0x9964031b, 0x136cfb2e, 0xf2f3343d, 0xae7ca244, 0x4fe36d57,
+    0xc5eb9562, 0x24745a71, 0x7d5c1090, 0x9cc3df83, 0x16cb27b6, 0xf754e8a5,
+    0xabdb7edc, 0x4a44b1cf, 0xc04c49fa, 0x21d386e9, 0x721cdd91, 0x93831282,
+    0x198beab7, 0xf81425a4, 0xa49bb3dd, 0x45047cce, 0xcf0c84fb, 0x2e934be8,
+    0x77bb0109, 0x9624ce1a, 0x1c2c362f, 0xfdb3f93c, 0xa13c6f45, 0x40a3a056,
+    0xcaab5863, 0x2b349770, 0x6c9cee93, 0x8d032180, 0x070bd9b5, 0xe69416a6,
+    0xba1b80df, 0x5b844fcc, 0xd18cb7f9, 0x301378ea, 0x693b320b, 0x88a4fd18,
+    0x02ac052d, 0xe333ca3e, 0xbfbc5c47, 0x5e239354, 0xd42b6b61, 0x35b4a472,
+    0x667bff0a, 0x87e43019, 0x0decc82c, 0xec73073f, 0xb0fc9146, 0x51635e55,
+    0xdb6ba660, 0x3af46973, 0x63dc2392, 0x8243ec81, 0x084b14b4, 0xe9d4dba7,
+    0xb55b4dde, 0x54c482cd, 0xdecc7af8, 0x3f53b5eb,
+};
+
+/*
+ * DIV_alpha(c), c being the least significant byte of s11
+ */
+static const uint32_t DIV_ALPHA[256] =
+{
+    0x00000000, 0x180f40cd, 0x301e8033, 0x2811c0fe, 0x603ca966, 0x7833e9ab,
+    0x50222955, 0x482d6998, 0xc078fbcc, 0xd877bb01, 0xf0667bff, 0xe8693b32,
+    0xa04452aa, 0xb84b1267, 0x905ad299, 0x88559254, 0x29f05f31, 0x31ff1ffc,
+    0x19eedf02, 0x01e19fcf, 0x49ccf657, 0x51c3b69a, 0x79d27664, 0x61dd36a9,
+    0xe988a4fd, 0xf187e430, 0xd99624ce, 0xc1996403, 0x89b40d9b, 0x91bb4d56,
+    0xb9aa8da8, 0xa1a5cd65, 0x5249be62, 0x4a46feaf, 0x62573e51, 0x7a587e9c,
+    0x32751704, 0x2a7a57c9, 0x026b9737, 0x1a64d7fa, 0x923145ae, 0x8a3e0563,
+    0xa22fc59d, 0xba208550, 0xf20decc8, 0xea02ac05, 0xc2136cfb, 0xda1c2c36,
+    0x7bb9e153, 0x63b6a19e, 0x4ba76160, 0x53a821ad, 0x1b854835, 0x038a08f8,
+    0x2b9bc806, 0x339488cb, 0xbbc11a9f, 0xa3ce5a52, 0x8bdf9aac, 0x93d0da61,
+    0xdbfdb3f9, 0xc3f2f334, 0xebe333ca, 0xf3ec7307, 0xa492d5c4, 0xbc9d9509,
+    0x948c55f7, 0x8c83153a, 0xc4ae7ca2, 0xdca13c6f, 0xf4b0fc91, 0xecbfbc5c,
+    0x64ea2e08, 0x7ce56ec5, 0x54f4ae3b, 0x4cfbeef6, 0x04d6876e, 0x1cd9c7a3,
+    0x34c8075d, 0x2cc74790, 0x8d628af5, 0x956dca38, 0xbd7c0ac6, 0xa5734a0b,
+    0xed5e2393, 0xf551635e, 0xdd40a3a0, 0xc54fe36d, 0x4d1a7139, 0x551531f4,
+    0x7d04f10a, 0x650bb1c7, 0x2d26d85f, 0x35299892, 0x1d38586c, 0x053718a1,
+    0xf6db6ba6, 0xeed42b6b, 0xc6c5eb95, 0xdecaab58, 0x96e7c2c0, 0x8ee8820d,
+    0xa6f942f3, 0xbef6023e, 0x36a3906a, 0x2eacd0a7, 0x06bd1059, 0x1eb25094,
+    0x569f390c, 0x4e9079c1, 0x6681b93f, 0x7e8ef9f2, 0xdf2b3497, 0xc724745a,
+    0xef35b4a4, 0xf73af469, 0xbf179df1, 0xa718dd3c, 0x8f091dc2, 0x97065d0f,
+    0x1f53cf5b, 0x075c8f96, 0x2f4d4f68, 0x37420fa5, 0x7f6f663d, 0x676026f0,
+    0x4f71e60e, 0x577ea6c3, 0xe18d0321, 0xf98243ec, 0xd1938312, 0xc99cc3df,
+    0x81b1aa47, 0x99beea8a, 0xb1af2a74, 0xa9a06ab9, 0x21f5f8ed, 0x39fab820,
+    0x11eb78de, 0x09e43813, 0x41c9518b, 0x59c61146, 0x71d7d1b8, 0x69d89175,
+    0xc87d5c10, 0xd0721cdd, 0xf863dc23, 0xe06c9cee, 0xa841f576, 0xb04eb5bb,
+    0x985f7545, 0x80503588, 0x0805a7dc, 0x100ae711, 0x381b27ef, 0x20146722,
+    0x68390eba, 0x70364e77, 0x58278e89, 0x4028ce44, 0xb3c4bd43, 0xabcbfd8e,
+    0x83da3d70, 0x9bd57dbd, 0xd3f81425, 0xcbf754e8, 0xe3e69416, 0xfbe9d4db,
+    0x73bc468f, 0x6bb30642, 0x43a2c6bc, 0x5bad8671, 0x1380efe9, 0x0b8faf24,
+    0x239e6fda, 0x3b912f17, 0x9a34e272, 0x823ba2bf, 0xaa2a6241, 0xb225228c,
+    0xfa084b14, 0xe2070bd9, 0xca16cb27, 0xd2198bea, 0x5a4c19be, 0x42435973,
+    0x6a52998d, 0x725dd940, 0x3a70b0d8, 0x227ff015, 0x0a6e30eb, 0x12617026,
+    0x451fd6e5, 0x5d109628, 0x750156d6, 0x6d0e161b, 0x25237f83, 0x3d2c3f4e,
+    0x153dffb0, 0x0d32bf7d, 0x85672d29, 0x9d686de4, 0xb579ad1a, 0xad76edd7,
+    0xe55b844f, 0xfd54c482, 0xd545047c, 0xcd4a44b1, 0x6cef89d4, 0x74e0c919,
+    0x5cf109e7, 0x44fe492a, 0x0cd320b2, 0x14dc607f, 0x3ccda081, 0x24c2e04c,
+    0xac977218, 0xb49832d5, 0x9c89f22b, 0x8486b2e6, 0xccabdb7e, 0xd4a49bb3,
+    0xfcb55b4d, 0xe4ba1b80, 0x17566887, 0x0f59284a, 0x2748e8b4, 0x3f47a879,
+    0x776ac1e1, 0x6f65812c, 0x477441d2, 0x5f7b011f, 0xd72e934b, 0xcf21d386,
+    0xe7301378, 0xff3f53b5, 0xb7123a2d, 0xaf1d7ae0, 0x870cba1e, 0x9f03fad3,
+    0x3ea637b6, 0x26a9777b, 0x0eb8b785, 0x16b7f748, 0x5e9a9ed0, 0x4695de1d,
+    0x6e841ee3, 0x768b5e2e, 0xfedecc7a, 0xe6d18cb7, 0xcec04c49, 0xd6cf0c84,
+    0x9ee2651c, 0x86ed25d1, 0xaefce52f, 0xb6f3a5e2,
+};
+
+/*
+ * S-boxes S1 and S2 of the FSM. Each is a byte substitution followed by a
+ * MixColumn whose rows are rotations of each other, so a single table per
+ * S-box serves the four input bytes: the rotations come for free as
+ * shifted operands of the XORs on AArch64, and 2 KiB of tables stay in
+ * the L1 cache where 8 KiB would not, next to the data, on small cores.
+ */
+static inline uint32_t snow3g_s1( uint32_t w )
+{
+    return( S1_T[w >> 24] ^ ROTR32( S1_T[( w >> 16 ) & 0xff], 8 ) ^
+            ROTR32( S1_T[( w >> 8 ) & 0xff], 16 ) ^
+            ROTR32( S1_T[w & 0xff], 24 ) );
+}
+
+static inline uint32_t snow3g_s2( uint32_t w )
+{
+    return( S2_T[w >> 24] ^ ROTR32( S2_T[( w >> 16 ) & 0xff], 8 ) ^
+            ROTR32( S2_T[( w >> 8 ) & 0xff], 16 ) ^
+            ROTR32( S2_T[w & 0xff], 24 ) );
+}
+
+/*
+ * LFSR feedback alpha * s0 + s2 + alpha^-1 * s11, plus F in
+ * initialization mode
+ */
+static inline uint32_t snow3g_feedback( uint32_t s0, uint32_t s2,
+                                        uint32_t s11, uint32_t f )
+{
+    return( ( s0 << 8 ) ^ MUL_ALPHA[s0 >> 24] ^ s2 ^ ( s11 >> 8 ) ^
+            DIV_ALPHA[s11 & 0xff] ^ f );
+}
+
+/*
+ * One clock of the FSM and the LFSR on the cells s0 to s15, the new cell
+ * being returned in s16. Returns F ^ s0, the keystream word in keystream
+ * mode, F being fed back to the LFSR in initialization mode.
+ */
+static inline uint32_t snow3g_round( const uint32_t *s, uint32_t *r1,
+                                     uint32_t *r2, uint32_t *r3, int init,
+                                     uint32_t *s16 )
+{
+    uint32_t f, r;
+
+    f = ( s[15] + *r1 ) ^ *r2;
+    r = *r2 + ( *r3 ^ s[5] );
+    *r3 = snow3g_s2( *r2 );
+    *r2 = snow3g_s1( *r1 );
+    *r1 = r;
+
+    *s16 = snow3g_feedback( s[0], s[2], s[11], init ? f : 0 );
+
+    return( f ^ s[0] );
+}
+
+/*
+ * The LFSR of the context is a circular buffer, shifting it is moving its
+ * head. The bulk loop works on a linear copy instead, which the compiler
+ * can address without wrapping.
+ */
+static void snow3g_unwrap( const mbedtls_snow3g_state *g, uint32_t *s )
+{
+    unsigned int i;
+
+    for( i = 0; i < 16; i++ )
+        s[i] = g->lfsr[( g->head + i ) & 15];
+}
+
+static uint32_t snow3g_clock( mbedtls_snow3g_state *g, int init )
+{
+    uint32_t s[16], z;
+
+    snow3g_unwrap( g, s );
+    z = snow3g_round( s, &g->r1, &g->r2, &g->r3, init,
+                      &g->lfsr[g->head] );
+    g->head = ( g->head + 1 ) & 15;
+
+    return( z );
+}
+
+/*
+ * k[0] is the most significant word of the 128-bit key, k3 in the
+ * specification, and iv[0] is IV3
+ */
+static void snow3g_init( mbedtls_snow3g_state *g, const unsigned char key[16],
+                         const uint32_t iv[4] )
+{
+    uint32_t k[4];
+    int i;
+
+    for( i = 0; i < 4; i++ )
+        GET_UINT32_BE( k[i], key, 4 * i );
+
+    g->lfsr[15] = k[0] ^ iv[3];
+    g->lfsr[14] = k[1];
+    g->lfsr[13] = k[2];
+    g->lfsr[12] = k[3] ^ iv[2];
+    g->lfsr[11] = k[0] ^ 0xffffffff;
+    g->lfsr[10] = k[1] ^ 0xffffffff ^ iv[1];
+    g->lfsr[9] = k[2] ^ 0xffffffff ^ iv[0];
+    g->lfsr[8] = k[3] ^ 0xffffffff;
+    g->lfsr[7] = k[0];
+    g->lfsr[6] = k[1];
+    g->lfsr[5] = k[2];
+    g->lfsr[4] = k[3];
+    g->lfsr[3] = k[0] ^ 0xffffffff;
+    g->lfsr[2] = k[1] ^ 0xffffffff;
+    g->lfsr[1] = k[2] ^ 0xffffffff;
+    g->lfsr[0] = k[3] ^ 0xffffffff;
+    g->r1 = 0;
+    g->r2 = 0;
+    g->r3 = 0;
+    g->head = 0;
+
+    for( i = 0; i < 32; i++ )
+        snow3g_clock( g, 1 );
+
+    /* The first word of keystream mode is discarded */
+    snow3g_clock( g, 0 );
+
+    mbedtls_platform_zeroize( k, sizeof( k ) );
+}
+
+static void snow3g_keystream( mbedtls_snow3g_state *g, uint32_t *ks,
+                              size_t n )
+{
+    uint32_t s[16 + SNOW3G_BLOCK_WORDS];
+    size_t i, m;
+
+    while( n > 0 )
+    {
+        m = n < SNOW3G_BLOCK_WORDS ? n : SNOW3G_BLOCK_WORDS;
+        snow3g_unwrap( g, s );
+        for( i = 0; i < m; i++ )
+            ks[i] = snow3g_round( s + i, &g->r1, &g->r2, &g->r3, 0,
+                                  s + 16 + i );
+        memcpy( g->lfsr, s + m, sizeof( g->lfsr ) );
+        g->head = 0;
+        ks += m;
+        n -= m;
+    }
+
+    mbedtls_platform_zeroize( s, sizeof( s ) );
+}
+
+/*
+ * XORs the keystream with whole words of input
+ */
+static void snow3g_xor_words( mbedtls_snow3g_state *g, size_t words,
+                              const unsigned char *input,
+                              unsigned char *output )
+{
+    uint32_t ks[SNOW3G_BLOCK_WORDS];
+    uint32_t x;
+    size_t i, n;
+
+    while( words > 0 )
+    {
+        n = words < SNOW3G_BLOCK_WORDS ? words : SNOW3G_BLOCK_WORDS;
+        snow3g_keystream( g, ks, n );
+        for( i = 0; i < n; i++ )
+        {
+            GET_UINT32_BE( x, input, 4 * i );
+            x ^= ks[i];
+            PUT_UINT32_BE( x, output, 4 * i );
+        }
+        input += 4 * n;
+        output += 4 * n;
+        words -= n;
+    }
+
+    mbedtls_platform_zeroize( ks, sizeof( ks ) );
+}
+
+static void uea2_iv( uint32_t iv[4], uint32_t count, uint32_t bearer,
+                     uint32_t dir )
+{
+    iv[0] = count;
+    iv[1] = ( bearer << 27 ) | ( dir << 26 );
+    iv[2] = iv[0];
+    iv[3] = iv[1];
+}
+
+/*
+ * UEA2
+ */
+void mbedtls_uea2_init( mbedtls_uea2_context *ctx )
+{
+    if( ctx == NULL )
+        return;
+
+    memset( ctx, 0, sizeof( mbedtls_uea2_context ) );
+}
+
+void mbedtls_uea2_free( mbedtls_uea2_context *ctx )
+{
+    if( ctx == NULL )
+        return;
+
+    mbedtls_platform_zeroize( ctx, sizeof( mbedtls_uea2_context ) );
+}
+
+int mbedtls_uea2_setkey( mbedtls_uea2_context *ctx,
+                         const unsigned char key[16] )
+{
+    if( ctx == NULL || key == NULL )
+        return( MBEDTLS_ERR_SNOW3G_BAD_INPUT_DATA );
+    if( ctx->state == SNOW3G_STATE_STARTED )
+        return( MBEDTLS_ERR_SNOW3G_HW_ACCEL_FAILED );
+
+    memcpy( ctx->key, key, sizeof( ctx->key ) );
+    ctx->state = SNOW3G_STATE_KEY;
+
+    return( 0 );
+}
+
+/*
+ * Secure keys are unwrapped by the key ladder of the session, see
+ * mbedtls_klad_cache_set_default(), once per key
+ */
+static int snow3g_unwrap_seckey( const mbedtls_klad_seckey_t *key,
+                                 unsigned char k[16] )
+{
+#if defined(MBEDTLS_KLAD_CACHE_C)
+    size_t len;
+
+    if( key->ek3bits != 128 )
+        return( MBEDTLS_ERR_SNOW3G_INVALID_KEY_LENGTH );
+
+    if( mbedtls_klad_cache_unwrap( NULL, key, k, &len ) != 0 )
+        return( MBEDTLS_ERR_SNOW3G_HW_ACCEL_FAILED );
+
+    return( 0 );
+#else
+    (void) key;
+    (void) k;
+
+    /* Secure keys are only usable through the trust engine key ladder */
+    return( MBEDTLS_ERR_SNOW3G_HW_ACCEL_FAILED );
+#endif /* MBEDTLS_KLAD_CACHE_C */
+}
+
+int mbedtls_uea2_setseckey( mbedtls_uea2_context *ctx,
+                            const mbedtls_klad_seckey_t *key )
+{
+    unsigned char k[16];
+    int ret;
+
+    if( ctx == NULL || key == NULL )
+        return( MBEDTLS_ERR_SNOW3G_BAD_INPUT_DATA );
+
+    ret = snow3g_unwrap_seckey( key, k );
+    if( ret == 0 )
+        ret = mbedtls_uea2_setkey( ctx, k );
+
+    mbedtls_platform_zeroize( k, sizeof( k ) );
+    return( ret );
+}
+
+int mbedtls_uea2_starts( mbedtls_uea2_context *ctx,
+                         uint32_t count, uint32_t bearer, uint32_t dir )
+{
+    uint32_t iv[4];
+
+    if( ctx == NULL || bearer > 0x1f || dir > 1 )
+        return( MBEDTLS_ERR_SNOW3G_BAD_INPUT_DATA );
+    if( ctx->state == SNOW3G_STATE_INIT )
+        return( MBEDTLS_ERR_SNOW3G_HW_ACCEL_FAILED );
+
+    uea2_iv( iv, count, bearer, dir );
+    snow3g_init( &ctx->snow, ctx->key, iv );
+    ctx->ks_used = sizeof( ctx->ks );
+    ctx->state = SNOW3G_STATE_STARTED;
+
+    return( 0 );
+}
+
+int mbedtls_uea2_update( mbedtls_uea2_context *ctx,
+                         size_t size, const unsigned char *input,
+                         unsigned char *output )
+{
+    uint32_t z;
+    size_t words;
+
+    if( ctx == NULL || ( size > 0 && ( input == NULL || output == NULL ) ) )
+        return( MBEDTLS_ERR_SNOW3G_BAD_INPUT_DATA );
+    if( ctx->state != SNOW3G_STATE_STARTED )
+        return( MBEDTLS_ERR_SNOW3G_HW_ACCEL_FAILED );
+
+    /* Rest of the keystream word of the previous call */
+    while( size > 0 && ctx->ks_used < sizeof( ctx->ks ) )
+    {
+        *output++ = *input++ ^ ctx->ks[ctx->ks_used++];
+        size--;
+    }
+
+    words = size / 4;
+    snow3g_xor_words( &ctx->snow, words, input, output );
+    input += 4 * words;
+    output += 4 * words;
+    size -= 4 * words;
+
+    if( size > 0 )
+    {
+        z = snow3g_clock( &ctx->snow, 0 );
+        PUT_UINT32_BE( z, ctx->ks, 0 );
+        for( ctx->ks_used = 0; ctx->ks_used < size; ctx->ks_used++ )
+            output[ctx->ks_used] = input[ctx->ks_used] ^
+                                   ctx->ks[ctx->ks_used];
+    }
+
+    return( 0 );
+}
+
+int mbedtls_uea2_finish( mbedtls_uea2_context *ctx )
+{
+    if( ctx == NULL )
+        return( MBEDTLS_ERR_SNOW3G_BAD_INPUT_DATA );
+    if( ctx->state != SNOW3G_STATE_STARTED )
+        return( MBEDTLS_ERR_SNOW3G_HW_ACCEL_FAILED );
+
+    mbedtls_platform_zeroize( &ctx->snow, sizeof( ctx->snow ) );
+    mbedtls_platform_zeroize( ctx->ks, sizeof( ctx->ks ) );
+    ctx->state = SNOW3G_STATE_KEY;
+
+    return( 0 );
+}
+
+int mbedtls_uea2_crypt( const unsigned char key[16],
+                        uint32_t count, uint32_t bearer, uint32_t dir,
+                        size_t size, const unsigned char *input,
+                        unsigned char *output )
+{
+    mbedtls_uea2_context ctx;
+    int ret;
+
+    mbedtls_uea2_init( &ctx );
+
+    ret = mbedtls_uea2_setkey( &ctx, key );
+    if( ret != 0 )
+        goto cleanup;
+
+    ret = mbedtls_uea2_starts( &ctx, count, bearer, dir );
+    if( ret != 0 )
+        goto cleanup;
+
+    ret = mbedtls_uea2_update( &ctx, size, input, output );
+    if( ret != 0 )
+        goto cleanup;
+
+    ret = mbedtls_uea2_finish( &ctx );
+
+cleanup:
+    mbedtls_uea2_free( &ctx );
+    return( ret );
+}
+
+int mbedtls_uea2_crypt_seckey( const mbedtls_klad_seckey_t *key,
+                               uint32_t count, uint32_t bearer, uint32_t dir,
+                               size_t size, const unsigned char *input,
+                               unsigned char *output )
+{
+    unsigned char k[16];
+    int ret;
+
+    if( key == NULL )
+        return( MBEDTLS_ERR_SNOW3G_BAD_INPUT_DATA );
+
+    ret = snow3g_unwrap_seckey( key, k );
+    if( ret == 0 )
+        ret = mbedtls_uea2_crypt( k, count, bearer, dir, size, input, output );
+
+    mbedtls_platform_zeroize( k, sizeof( k ) );
+    return( ret );
+}
+
+/*
+ * Multi-lane keystream generator: the state of each cell is stored lane
+ * by lane so that the arithmetic of a clock is a loop over the lanes the
+ * compiler turns into vector instructions, the table lookups being done
+ * in a second loop.
+ */
+typedef struct
+{
+    uint32_t lfsr[16][MBEDTLS_SNOW3G_MAX_LANES];
+    uint32_t r1[MBEDTLS_SNOW3G_MAX_LANES];
+    uint32_t r2[MBEDTLS_SNOW3G_MAX_LANES];
+    uint32_t r3[MBEDTLS_SNOW3G_MAX_LANES];
+    unsigned int head;
+} snow3g_lanes;
+
+#define SL( g, i )  ( (g)->lfsr[( (g)->head + (i) ) & 15] )
+
+static inline void snow3g_lanes_clock( snow3g_lanes *g, size_t lanes,
+                                       int init, uint32_t *ks )
+{
+    uint32_t *s0 = SL( g, 0 );
+    const uint32_t *s2 = SL( g, 2 ), *s5 = SL( g, 5 );
+    const uint32_t *s11 = SL( g, 11 ), *s15 = SL( g, 15 );
+    uint32_t f[MBEDTLS_SNOW3G_MAX_LANES];
+    uint32_t r;
+    size_t l;
+
+    for( l = 0; l < lanes; l++ )
+    {
+        f[l] = ( s15[l] + g->r1[l] ) ^ g->r2[l];
+        ks[l] = f[l] ^ s0[l];
+        if( !init )
+            f[l] = 0;
+    }
+
+    for( l = 0; l < lanes; l++ )
+    {
+        r = g->r2[l] + ( g->r3[l] ^ s5[l] );
+        g->r3[l] = snow3g_s2( g->r2[l] );
+        g->r2[l] = snow3g_s1( g->r1[l] );
+        g->r1[l] = r;
+        s0[l] = snow3g_feedback( s0[l], s2[l], s11[l], f[l] );
+    }
+
+    g->head = ( g->head + 1 ) & 15;
+}
+
+/*
+ * Encrypts @lanes messages of msgs: the common length in parallel, then
+ * the rest of each message with its own single stream generator.
+ */
+static void uea2_lanes( const mbedtls_uea2_msg *msgs, size_t lanes )
+{
+    snow3g_lanes g;
+    mbedtls_snow3g_state one;
+    mbedtls_uea2_context ctx;
+    uint32_t ks[SNOW3G_BLOCK_WORDS][MBEDTLS_SNOW3G_MAX_LANES];
+    uint32_t iv[4];
+    size_t min = msgs[0].size;
+    size_t off, i, l;
+    uint32_t x;
+
+    for( l = 0; l < lanes; l++ )
+    {
+        uea2_iv( iv, msgs[l].count, msgs[l].bearer, msgs[l].dir );
+        snow3g_init( &one, msgs[l].key, iv );
+        for( i = 0; i < 16; i++ )
+            g.lfsr[i][l] = one.lfsr[( one.head + i ) & 15];
+        g.r1[l] = one.r1;
+        g.r2[l] = one.r2;
+        g.r3[l] = one.r3;
+        if( msgs[l].size < min )
+            min = msgs[l].size;
+    }
+    g.head = 0;
+
+    for( off = 0; off + 4 * SNOW3G_BLOCK_WORDS <= min;
+         off += 4 * SNOW3G_BLOCK_WORDS )
+    {
+        for( i = 0; i < SNOW3G_BLOCK_WORDS; i++ )
+            snow3g_lanes_clock( &g, lanes, 0, ks[i] );
+
+        for( l = 0; l < lanes; l++ )
+        {
+            for( i = 0; i < SNOW3G_BLOCK_WORDS; i++ )
+            {
+                GET_UINT32_BE( x, msgs[l].input, off + 4 * i );
+                x ^= ks[i][l];
+                PUT_UINT32_BE( x, msgs[l].output, off + 4 * i );
+            }
+        }
+    }
+
+    mbedtls_uea2_init( &ctx );
+    for( l = 0; l < lanes; l++ )
+    {
+        if( msgs[l].size == off )
+            continue;
+
+        for( i = 0; i < 16; i++ )
+            ctx.snow.lfsr[i] = SL( &g, i )[l];
+        ctx.snow.r1 = g.r1[l];
+        ctx.snow.r2 = g.r2[l];
+        ctx.snow.r3 = g.r3[l];
+        ctx.snow.head = 0;
+        ctx.ks_used = sizeof( ctx.ks );
+        ctx.state = SNOW3G_STATE_STARTED;
+        mbedtls_uea2_update( &ctx, msgs[l].size - off, msgs[l].input + off,
+                             msgs[l].output + off );
+    }
+
+    mbedtls_uea2_free( &ctx );
+    mbedtls_platform_zeroize( &one, sizeof( one ) );
+    mbedtls_platform_zeroize( &g, sizeof( g ) );
+    mbedtls_platform_zeroize( ks, sizeof( ks ) );
+}
+
+int mbedtls_uea2_crypt_multi( size_t n, const mbedtls_uea2_msg *msgs )
+{
+    size_t i, lanes;
+
+    if( n > 0 && msgs == NULL )
+        return( MBEDTLS_ERR_SNOW3G_BAD_INPUT_DATA );
+
+    for( i = 0; i < n; i++ )
+    {
+        if( msgs[i].key == NULL || msgs[i].bearer > 0x1f ||
+            msgs[i].dir > 1 || ( msgs[i].size > 0 &&
+            ( msgs[i].input == NULL || msgs[i].output == NULL ) ) )
+            return( MBEDTLS_ERR_SNOW3G_BAD_INPUT_DATA );
+    }
+
+    /* Groups of 8 then 4 lanes, the remaining messages one by one */
+    for( i = 0; i < n; i += lanes )
+    {
+        lanes = n - i >= 8 ? 8 : n - i >= 4 ? 4 : 1;
+        if( lanes > MBEDTLS_SNOW3G_MAX_LANES )
+            lanes = MBEDTLS_SNOW3G_MAX_LANES;
+
+        if( lanes == 1 )
+            mbedtls_uea2_crypt( msgs[i].key, msgs[i].count, msgs[i].bearer,
+                                msgs[i].dir, msgs[i].size, msgs[i].input,
+                                msgs[i].output );
+        else
+            uea2_lanes( msgs + i, lanes );
+    }
+
+    return( 0 );
+}
+
+/*
+ * UIA2
+ *
+ * The MAC evaluates the message, split in 64-bit blocks, as a polynomial
+ * in P over GF(2^64) = GF(2)[x] / (x^64 + x^4 + x^3 + x + 1). Four blocks
+ * are processed at once with P^4 .. P so that the multiplications are
+ * independent.
+ */
+#define UIA2_POLY   0x1bULL
+
+#if defined(SNOW3G_PMULL)
+static inline uint64_t uia2_clmul_lo( uint64_t a, uint64_t b, uint64_t *hi )
+{
+    uint64x2_t r = vreinterpretq_u64_p128( vmull_p64( (poly64_t) a,
+                                                      (poly64_t) b ) );
+
+    *hi = vgetq_lane_u64( r, 1 );
+    return( vgetq_lane_u64( r, 0 ) );
+}
+
+/* Reduces hi * x^64 + lo */
+static inline uint64_t uia2_reduce( uint64_t lo, uint64_t hi )
+{
+    uint64_t t_hi, t_lo;
+
+    t_lo = uia2_clmul_lo( hi, UIA2_POLY, &t_hi );
+    lo ^= t_lo;
+    /* t_hi has at most 4 bits */
+    t_lo = uia2_clmul_lo( t_hi, UIA2_POLY, &t_hi );
+    return( lo ^ t_lo );
+}
+
+static uint64_t uia2_mul( const mbedtls_uia2_context *ctx, uint64_t a,
+                          int k )
+{
+    uint64_t lo, hi;
+
+    lo = uia2_clmul_lo( a, ctx->p[k], &hi );
+    return( uia2_reduce( lo, hi ) );
+}
+
+static uint64_t uia2_mul_q( const mbedtls_uia2_context *ctx, uint64_t a )
+{
+    uint64_t lo, hi;
+
+    lo = uia2_clmul_lo( a, ctx->q, &hi );
+    return( uia2_reduce( lo, hi ) );
+}
+
+static void uia2_blocks4( mbedtls_uia2_context *ctx,
+                          const unsigned char *input, size_t n )
+{
+    uint64_t m[4], lo, hi, l, h;
+    int j;
+
+    for( ; n > 0; n--, input += 32 )
+    {
+        for( j = 0; j < 4; j++ )
+            m[j] = ( (uint64_t) ( (uint32_t) input[8 * j] << 24 |
+                                  (uint32_t) input[8 * j + 1] << 16 |
+                                  (uint32_t) input[8 * j + 2] << 8 |
+                                  input[8 * j + 3] ) << 32 ) |
+                   ( (uint32_t) input[8 * j + 4] << 24 |
+                     (uint32_t) input[8 * j + 5] << 16 |
+                     (uint32_t) input[8 * j + 6] << 8 |
+                     input[8 * j + 7] );
+        m[0] ^= ctx->eval;
+
+        /* Unreduced sum of the products, reduced once */
+        lo = uia2_clmul_lo( m[0], ctx->p[3], &hi );
+        for( j = 1; j < 4; j++ )
+        {
+            l = uia2_clmul_lo( m[j], ctx->p[3 - j], &h );
+            lo ^= l;
+            hi ^= h;
+        }
+        ctx->eval = uia2_reduce( lo, hi );
+    }
+}
+#else /* SNOW3G_PMULL */
+/*
+ * Portable multiplication: a is consumed 4 bits at a time from the most
+ * significant end, with the multiples of the other operand by the 16
+ * polynomials of degree < 4 from a table. The 4 bits shifted out of the
+ * product at each step are folded back with UIA2_RED.
+ */
+static const uint8_t UIA2_RED[16] =
+{
+    0x00, 0x1b, 0x36, 0x2d, 0x6c, 0x77, 0x5a, 0x41,
+    0xd8, 0xc3, 0xee, 0xf5, 0xb4, 0xaf, 0x82, 0x99,
+};
+
+static void uia2_table( uint64_t tab[16], uint64_t v )
+{
+    int i;
+
+    tab[0] = 0;
+    for( i = 1; i < 16; i <<= 1 )
+    {
+        tab[i] = v;
+        v = ( v << 1 ) ^ ( ( v >> 63 ) * UIA2_POLY );
+    }
+    for( i = 3; i < 16; i++ )
+    {
+        if( i & ( i - 1 ) )
+            tab[i] = tab[i & ( i - 1 )] ^ tab[i & -i];
+    }
+}
+
+static inline uint64_t uia2_mul_tab( const uint64_t tab[16], uint64_t a )
+{
+    uint64_t r = 0;
+    int i;
+
+    for( i = 60; i >= 0; i -= 4 )
+        r = ( r << 4 ) ^ UIA2_RED[r >> 60] ^ tab[( a >> i ) & 0xf];
+
+    return( r );
+}
+
+static uint64_t uia2_mul( const mbedtls_uia2_context *ctx, uint64_t a,
+                          int k )
+{
+    return( uia2_mul_tab( ctx->ptab[k], a ) );
+}
+
+static uint64_t uia2_mul_q( const mbedtls_uia2_context *ctx, uint64_t a )
+{
+    uint64_t tab[16];
+    uint64_t r;
+
+    uia2_table( tab, ctx->q );
+    r = uia2_mul_tab( tab, a );
+    mbedtls_platform_zeroize( tab, sizeof( tab ) );
+
+    return( r );
+}
+
+static void uia2_blocks4( mbedtls_uia2_context *ctx,
+                          const unsigned char *input, size_t n )
+{
+    uint64_t m[4], r;
+    int j;
+
+    for( ; n > 0; n--, input += 32 )
+    {
+        for( j = 0; j < 4; j++ )
+            m[j] = ( (uint64_t) ( (uint32_t) input[8 * j] << 24 |
+                                  (uint32_t) input[8 * j + 1] << 16 |
+                                  (uint32_t) input[8 * j + 2] << 8 |
+                                  input[8 * j + 3] ) << 32 ) |
+                   ( (uint32_t) input[8 * j + 4] << 24 |
+                     (uint32_t) input[8 * j + 5] << 16 |
+                     (uint32_t) input[8 * j + 6] << 8 |
+                     input[8 * j + 7] );
+        m[0] ^= ctx->eval;
+
+        r = uia2_mul_tab( ctx->ptab[3], m[0] );
+        for( j = 1; j < 4; j++ )
+            r ^= uia2_mul_tab( ctx->ptab[3 - j], m[j] );
+        ctx->eval = r;
+    }
+}
+#endif /* SNOW3G_PMULL */
+
+static uint64_t uia2_get64( const unsigned char *b )
+{
+    uint32_t hi, lo;
+
+    GET_UINT32_BE( hi, b, 0 );
+    GET_UINT32_BE( lo, b, 4 );
+    return( (uint64_t) hi << 32 | lo );
+}
+
+static void uia2_block( mbedtls_uia2_context *ctx, const unsigned char *b )
+{
+    ctx->eval = uia2_mul( ctx, ctx->eval ^ uia2_get64( b ), 0 );
+}
+
+void mbedtls_uia2_init( mbedtls_uia2_context *ctx )
+{
+    if( ctx == NULL )
+        return;
+
+    memset( ctx, 0, sizeof( mbedtls_uia2_context ) );
+}
+
+void mbedtls_uia2_free( mbedtls_uia2_context *ctx )
+{
+    if( ctx == NULL )
+        return;
+
+    mbedtls_platform_zeroize( ctx, sizeof( mbedtls_uia2_context ) );
+}
+
+int mbedtls_uia2_setkey( mbedtls_uia2_context *ctx,
+                         const unsigned char key[16] )
+{
+    if( ctx == NULL || key == NULL )
+        return( MBEDTLS_ERR_SNOW3G_BAD_INPUT_DATA );
+    if( ctx->state == SNOW3G_STATE_STARTED )
+        return( MBEDTLS_ERR_SNOW3G_HW_ACCEL_FAILED );
+
+    memcpy( ctx->key, key, sizeof( ctx->key ) );
+    ctx->state = SNOW3G_STATE_KEY;
+
+    return( 0 );
+}
+
+int mbedtls_uia2_setseckey( mbedtls_uia2_context *ctx,
+                            const mbedtls_klad_seckey_t *key )
+{
+    unsigned char k[16];
+    int ret;
+
+    if( ctx == NULL || key == NULL )
+        return( MBEDTLS_ERR_SNOW3G_BAD_INPUT_DATA );
+
+    ret = snow3g_unwrap_seckey( key, k );
+    if( ret == 0 )
+        ret = mbedtls_uia2_setkey( ctx, k );
+
+    mbedtls_platform_zeroize( k, sizeof( k ) );
+    return( ret );
+}
+
+int mbedtls_uia2_starts( mbedtls_uia2_context *ctx,
+                         uint32_t count, uint32_t fresh,
+                         uint32_t dir )
+{
+    mbedtls_snow3g_state g;
+    uint32_t iv[4], z[4];
+    int i;
+
+    if( ctx == NULL || dir > 1 )
+        return( MBEDTLS_ERR_SNOW3G_BAD_INPUT_DATA );
+    if( ctx->state == SNOW3G_STATE_INIT )
+        return( MBEDTLS_ERR_SNOW3G_HW_ACCEL_FAILED );
+
+    iv[0] = count;
+    iv[1] = fresh;
+    iv[2] = count ^ ( dir << 31 );
+    iv[3] = fresh ^ ( dir << 15 );
+    snow3g_init( &g, ctx->key, iv );
+    snow3g_keystream( &g, z, 4 );
+    ctx->z5 = snow3g_clock( &g, 0 );
+
+    ctx->p[0] = (uint64_t) z[0] << 32 | z[1];
+    ctx->q = (uint64_t) z[2] << 32 | z[3];
+#if !defined(SNOW3G_PMULL)
+    uia2_table( ctx->ptab[0], ctx->p[0] );
+#endif
+    for( i = 1; i < 4; i++ )
+    {
+        ctx->p[i] = uia2_mul( ctx, ctx->p[i - 1], 0 );
+#if !defined(SNOW3G_PMULL)
+        uia2_table( ctx->ptab[i], ctx->p[i] );
+#endif
+    }
+
+    ctx->eval = 0;
+    ctx->buf_len = 0;
+    ctx->bits = 0;
+    ctx->state = SNOW3G_STATE_STARTED;
+
+    mbedtls_platform_zeroize( &g, sizeof( g ) );
+    mbedtls_platform_zeroize( z, sizeof( z ) );
+
+    return( 0 );
+}
+
+int mbedtls_uia2_update( mbedtls_uia2_context *ctx,
+                         size_t size, const unsigned char *input )
+{
+    size_t n;
+
+    if( ctx == NULL || ( size > 0 && input == NULL ) )
+        return( MBEDTLS_ERR_SNOW3G_BAD_INPUT_DATA );
+    if( ctx->state != SNOW3G_STATE_STARTED )
+        return( MBEDTLS_ERR_SNOW3G_HW_ACCEL_FAILED );
+
+    ctx->bits += 8 * size;
+
+    if( ctx->buf_len > 0 )
+    {
+        n = sizeof( ctx->buf ) - ctx->buf_len;
+        if( n > size )
+            n = size;
+        memcpy( ctx->buf + ctx->buf_len, input, n );
+        ctx->buf_len += n;
+        input += n;
+        size -= n;
+        if( ctx->buf_len < sizeof( ctx->buf ) )
+            return( 0 );
+        uia2_block( ctx, ctx->buf );
+        ctx->buf_len = 0;
+    }
+
+    n = size / 32;
+    uia2_blocks4( ctx, input, n );
+    input += 32 * n;
+    size -= 32 * n;
+
+    for( ; size >= 8; size -= 8, input += 8 )
+        uia2_block( ctx, input );
+
+    memcpy( ctx->buf, input, size );
+    ctx->buf_len = size;
+
+    return( 0 );
+}
+
+int mbedtls_uia2_finish( mbedtls_uia2_context *ctx,
+                         unsigned char output[4] )
+{
+    uint32_t mac;
+
+    if( ctx == NULL || output == NULL )
+        return( MBEDTLS_ERR_SNOW3G_BAD_INPUT_DATA );
+    if( ctx->state != SNOW3G_STATE_STARTED )
+        return( MBEDTLS_ERR_SNOW3G_HW_ACCEL_FAILED );
+
+    /* The last block is padded with zeros */
+    if( ctx->buf_len > 0 )
+    {
+        memset( ctx->buf + ctx->buf_len, 0,
+                sizeof( ctx->buf ) - ctx->buf_len );
+        uia2_block( ctx, ctx->buf );
+    }
+
+    ctx->eval = uia2_mul_q( ctx, ctx->eval ^ (uint64_t) ctx->bits );
+    mac = (uint32_t) ( ctx->eval >> 32 ) ^ ctx->z5;
+    PUT_UINT32_BE( mac, output, 0 );
+
+    mbedtls_platform_zeroize( ctx->p, sizeof( ctx->p ) );
+    mbedtls_platform_zeroize( &ctx->q, sizeof( ctx->q ) );
+    mbedtls_platform_zeroize( ctx->ptab, sizeof( ctx->ptab ) );
+    mbedtls_platform_zeroize( ctx->buf, sizeof( ctx->buf ) );
+    ctx->z5 = 0;
+    ctx->eval = 0;
+    ctx->state = SNOW3G_STATE_KEY;
+
+    return( 0 );
+}
+
+int mbedtls_uia2_mac( const unsigned char key[16],
+                      uint32_t count, uint32_t fresh, uint32_t dir,
+                      size_t size, const unsigned char *input,
+                      unsigned char output[4] )
+{
+    mbedtls_uia2_context ctx;
+    int ret;
+
+    mbedtls_uia2_init( &ctx );
+
+    ret = mbedtls_uia2_setkey( &ctx, key );
+    if( ret != 0 )
+        goto cleanup;
+
+    ret = mbedtls_uia2_starts( &ctx, count, fresh, dir );
+    if( ret != 0 )
+        goto cleanup;
+
+    ret = mbedtls_uia2_update( &ctx, size, input );
+    if( ret != 0 )
+        goto cleanup;
+
+    ret = mbedtls_uia2_finish( &ctx, output );
+
+cleanup:
+    mbedtls_uia2_free( &ctx );
+    return( ret );
+}
+
+int mbedtls_uia2_mac_seckey( const mbedtls_klad_seckey_t *key,
+                             uint32_t count, uint32_t fresh, uint32_t dir,
+                             size_t size, const unsigned char *input,
+                             unsigned char output[4] )
+{
+    unsigned char k[16];
+    int ret;
+
+    if( key == NULL )
+        return( MBEDTLS_ERR_SNOW3G_BAD_INPUT_DATA );
+
+    ret = snow3g_unwrap_seckey( key, k );
+    if( ret == 0 )
+        ret = mbedtls_uia2_mac( k, count, fresh, dir, size, input, output );
+
+    mbedtls_platform_zeroize( k, sizeof( k ) );
+    return( ret );
+}
+
+#if defined(MBEDTLS_SELF_TEST)
+
+/*
+ * Keystream test data from the design conformance test data, key and IV
+ * words in the order of the document, k0 and IV0 first
+ */
+static const uint32_t ks_test_key[4][4] =
+{
+    { 0x2bd6459f, 0x82c5b300, 0x952c4910, 0x4881ff48 },
+    { 0x8ce33e2c, 0xc3c0b5fc, 0x1f3de8a6, 0xdc66b1f3 },
+    { 0x4035c668, 0x0af8c6d1, 0xa8ff8667, 0xb1714013 },
+    { 0x0ded7263, 0x109cf92e, 0x3352255a, 0x140e0f76 },
+};
+
+static const uint32_t ks_test_iv[4][4] =
+{
+    { 0xea024714, 0xad5c4d84, 0xdf1f9b25, 0x1c0bf45f },
+    { 0xd3c5d592, 0x327fb11c, 0xde551988, 0xceb2f9b7 },
+    { 0x62a54098, 0x1ba6f9b7, 0x4592b0e7, 0x8690f71b },
+    { 0x6b68079a, 0x41a7c4c9, 0x1befd79f, 0x7fdcc233 },
+};
+
+/* z1, z2 and, for the last set, z2500 */
+static const uint32_t ks_test_z[4][3] =
+{
+    { 0xabee9704, 0x7ac31373, 0 },
+    { 0xeff8a342, 0xf751480f, 0 },
+    { 0xa8c874a9, 0x7ae7c4f8, 0 },
+    { 0xd712c05c, 0xa937c2a6, 0x9c0db3aa },
+};
+
+typedef struct
+{
+    unsigned char key[16];
+    uint32_t count;
+    uint32_t bearer;            /* fresh for UIA2 */
+    uint32_t dir;
+    size_t bits;
+    const unsigned char *in;
+    const unsigned char *out;
+} snow3g_test_vector;
+
+/*
+ * UEA2 and UIA2 test data from the implementors' test data
+ */
+static const unsigned char uea2_pt1[] =
+{
+    0x98, 0x1b, 0xa6, 0x82, 0x4c, 0x1b, 0xfb, 0x1a,
+    0xb4, 0x85, 0x47, 0x20, 0x29, 0xb7, 0x1d, 0x80,
+    0x8c, 0xe3, 0x3e, 0x2c, 0xc3, 0xc0, 0xb5, 0xfc,
+    0x1f, 0x3d, 0xe8, 0xa6, 0xdc, 0x66, 0xb1, 0xf0,
+};
+
+static const unsigned char uea2_ct1[] =
+{
+    0x5d, 0x5b, 0xfe, 0x75, 0xeb, 0x04, 0xf6, 0x8c,
+    0xe0, 0xa1, 0x23, 0x77, 0xea, 0x00, 0xb3, 0x7d,
+    0x47, 0xc6, 0xa0, 0xba, 0x06, 0x30, 0x91, 0x55,
+    0x08, 0x6a, 0x85, 0x9c, 0x43, 0x41, 0xb3, 0x78,
+};
+
+static const unsigned char uea2_pt2[] =
+{
+    0xad, 0x9c, 0x44, 0x1f, 0x89, 0x0b, 0x38, 0xc4,
+    0x57, 0xa4, 0x9d, 0x42, 0x14, 0x07, 0xe8,
+};
+
+static const unsigned char uea2_ct2[] =
+{
+    0xba, 0x0f, 0x31, 0x30, 0x03, 0x34, 0xc5, 0x6b,
+    0x52, 0xa7, 0x49, 0x7c, 0xba, 0xc0, 0x46,
+};
+
+static const snow3g_test_vector uea2_tests[2] =
+{
+    {
+        { 0xd3, 0xc5, 0xd5, 0x92, 0x32, 0x7f, 0xb1, 0x1c,
+          0x40, 0x35, 0xc6, 0x68, 0x0a, 0xf8, 0xc6, 0xd1 },
+        0x398a59b4, 0x15, 1, 253, uea2_pt1, uea2_ct1
+    },
+    {
+        { 0x5a, 0xcb, 0x1d, 0x64, 0x4c, 0x0d, 0x51, 0x20,
+          0x4e, 0xa5, 0xf1, 0x45, 0x10, 0x10, 0xd8, 0x52 },
+        0xfa556b26, 0x03, 1, 120, uea2_pt2, uea2_ct2
+    },
+};
+
+static const unsigned char uia2_msg1[] =
+{
+    0x6b, 0x22, 0x77, 0x37, 0x29, 0x6f, 0x39, 0x3c,
+    0x80, 0x79, 0x35, 0x3e, 0xdc, 0x87, 0xe2, 0xe8,
+    0x05, 0xd2, 0xec, 0x49, 0xa4, 0xf2, 0xd8, 0xe0,
+};
+
+static const unsigned char uia2_mac1[4] = { 0x2b, 0xce, 0x18, 0x20 };
+
+static const snow3g_test_vector uia2_test =
+{
+    { 0x2b, 0xd6, 0x45, 0x9f, 0x82, 0xc5, 0xb3, 0x00,
+      0x95, 0x2c, 0x49, 0x10, 0x48, 0x81, 0xff, 0x48 },
+    0x38a6f056, 0x05d2ec49, 0, 189, uia2_msg1, uia2_mac1
+};
+
+/* Compares @bits bits, the unused bits of the last byte being ignored */
+static int snow3g_test_cmp( const unsigned char *a, const unsigned char *b,
+                            size_t bits )
+{
+    size_t n = bits / 8;
+    unsigned char mask = (unsigned char) ( 0xff00 >> ( bits % 8 ) );
+
+    if( memcmp( a, b, n ) != 0 )
+        return( 1 );
+    return( bits % 8 != 0 && ( ( a[n] ^ b[n] ) & mask ) != 0 );
+}
+
+/*
+ * The MAC of a message that does not fill its last byte: the unused bits
+ * are cleared, then the length of the padded message corrected
+ */
+static int snow3g_test_uia2( const snow3g_test_vector *v, size_t step,
+                             unsigned char mac[4] )
+{
+    mbedtls_uia2_context ctx;
+    unsigned char msg[sizeof( uia2_msg1 )];
+    size_t len = ( v->bits + 7 ) / 8;
+    size_t i, n;
+    int ret;
+
+    memcpy( msg, v->in, len );
+    if( v->bits % 8 != 0 )
+        msg[len - 1] &= (unsigned char) ( 0xff00 >> ( v->bits % 8 ) );
+
+    mbedtls_uia2_init( &ctx );
+    ret = mbedtls_uia2_setkey( &ctx, v->key );
+    if( ret == 0 )
+        ret = mbedtls_uia2_starts( &ctx, v->count, v->bearer, v->dir );
+    for( i = 0; ret == 0 && i < len; i += n )
+    {
+        n = len - i < step ? len - i : step;
+        ret = mbedtls_uia2_update( &ctx, n, msg + i );
+    }
+    if( ret == 0 )
+    {
+        ctx.bits = v->bits;
+        ret = mbedtls_uia2_finish( &ctx, mac );
+    }
+    mbedtls_uia2_free( &ctx );
+
+    return( ret );
+}
+
+#define SNOW3G_TEST_MSGS    13
+#define SNOW3G_TEST_LEN     150
+
+/*
+ * Checkup routine
+ */
+int mbedtls_snow3g_self_test( int verbose )
+{
+    mbedtls_snow3g_state g;
+    mbedtls_uea2_context ctx;
+    mbedtls_uea2_msg msgs[SNOW3G_TEST_MSGS];
+    unsigned char buf[SNOW3G_TEST_MSGS][SNOW3G_TEST_LEN];
+    unsigned char ref[SNOW3G_TEST_LEN];
+    unsigned char key[16];
+    unsigned char mac[4];
+    const snow3g_test_vector *v;
+    uint32_t iv[4], ks[2];
+    size_t i, j, len;
+    int ret = 0;
+
+    for( i = 0; i < 4; i++ )
+    {
+        if( verbose != 0 )
+            mbedtls_printf( "  SNOW 3G keystream test #%u: ",
+                            (unsigned) i + 1 );
+
+        for( j = 0; j < 4; j++ )
+        {
+            PUT_UINT32_BE( ks_test_key[i][3 - j], key, 4 * j );
+            iv[j] = ks_test_iv[i][3 - j];
+        }
+        snow3g_init( &g, key, iv );
+        snow3g_keystream( &g, ks, 2 );
+        if( ks[0] != ks_test_z[i][0] || ks[1] != ks_test_z[i][1] )
+            goto fail;
+        if( ks_test_z[i][2] != 0 )
+        {
+            for( j = 2; j < 2500; j++ )
+                ks[0] = snow3g_clock( &g, 0 );
+            if( ks[0] != ks_test_z[i][2] )
+                goto fail;
+        }
+
+        if( verbose != 0 )
+            mbedtls_printf( "passed\n" );
+    }
+
+    for( i = 0; i < 2; i++ )
+    {
+        v = uea2_tests + i;
+        len = ( v->bits + 7 ) / 8;
+
+        if( verbose != 0 )
+            mbedtls_printf( "  UEA2 test #%u: ", (unsigned) i + 1 );
+
+        if( mbedtls_uea2_crypt( v->key, v->count, v->bearer, v->dir, len,
+                                v->in, buf[0] ) != 0 ||
+            snow3g_test_cmp( buf[0], v->out, v->bits ) != 0 )
+            goto fail;
+
+        /* Piecewise, across keystream word boundaries */
+        mbedtls_uea2_init( &ctx );
+        if( mbedtls_uea2_setkey( &ctx, v->key ) != 0 ||
+            mbedtls_uea2_starts( &ctx, v->count, v->bearer, v->dir ) != 0 )
+            goto fail_ctx;
+        for( j = 0; j < len; j += ( j % 7 ) + 1 )
+        {
+            if( mbedtls_uea2_update( &ctx, len - j < ( j % 7 ) + 1 ?
+                                     len - j : ( j % 7 ) + 1,
+                                     v->in + j, buf[0] + j ) != 0 )
+                goto fail_ctx;
+        }
+        if( mbedtls_uea2_finish( &ctx ) != 0 ||
+            snow3g_test_cmp( buf[0], v->out, v->bits ) != 0 )
+            goto fail_ctx;
+        mbedtls_uea2_free( &ctx );
+
+        if( verbose != 0 )
+            mbedtls_printf( "passed\n" );
+    }
+
+    /*
+     * 8 + 4 lanes and a single message, of different lengths and long
+     * enough for the parallel loop, against the single stream generator
+     */
+    if( verbose != 0 )
+        mbedtls_printf( "  UEA2 multi-lane test: " );
+
+    memset( ref, 0x5a, sizeof( ref ) );
+    for( i = 0; i < SNOW3G_TEST_MSGS; i++ )
+    {
+        v = uea2_tests + i % 2;
+        msgs[i].key = v->key;
+        msgs[i].count = v->count + (uint32_t) i;
+        msgs[i].bearer = v->bearer;
+        msgs[i].dir = v->dir;
+        msgs[i].size = SNOW3G_TEST_LEN - i;
+        msgs[i].input = ref;
+        msgs[i].output = buf[i];
+    }
+    if( mbedtls_uea2_crypt_multi( SNOW3G_TEST_MSGS, msgs ) != 0 )
+        goto fail;
+    for( i = 0; i < SNOW3G_TEST_MSGS; i++ )
+    {
+        if( mbedtls_uea2_crypt( msgs[i].key, msgs[i].count, msgs[i].bearer,
+                                msgs[i].dir, msgs[i].size, buf[i],
+                                buf[i] ) != 0 )
+            goto fail;
+        if( memcmp( buf[i], ref, msgs[i].size ) != 0 )
+            goto fail;
+    }
+
+    if( verbose != 0 )
+        mbedtls_printf( "passed\n" );
+
+    /* In one call, then in pieces not aligned on 64-bit blocks */
+    for( i = 0; i < 2; i++ )
+    {
+        if( verbose != 0 )
+            mbedtls_printf( "  UIA2 test #%u: ", (unsigned) i + 1 );
+
+        if( snow3g_test_uia2( &uia2_test, i == 0 ? SIZE_MAX : 3,
+                              mac ) != 0 ||
+            memcmp( mac, uia2_test.out, 4 ) != 0 )
+            goto fail;
+
+        if( verbose != 0 )
+            mbedtls_printf( "passed\n" );
+    }
+
+    if( verbose != 0 )
+        mbedtls_printf( "\n" );
+
+    goto exit;
+
+fail_ctx:
+    mbedtls_uea2_free( &ctx );
+fail:
+    if( verbose != 0 )
+        mbedtls_printf( "failed\n" );
+    ret = 1;
+
+exit:
+    mbedtls_platform_zeroize( &g, sizeof( g ) );
+    mbedtls_platform_zeroize( key, sizeof( key ) );
+    return( ret );
+}
+
+#endif /* MBEDTLS_SELF_TEST */
+
+#endif /* !MBEDTLS_SNOW3G_ALT */
+
+#endif /* MBEDTLS_SNOW3G_C */
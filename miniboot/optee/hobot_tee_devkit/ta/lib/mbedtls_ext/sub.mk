@@ -0,0 +1,42 @@
+# Software implementations of the algorithms include/mbedtls declares but
+# the libmbedtls of the TA dev kit leaves to the trust engine. The
+# contexts are defined in the headers when MBEDTLS_<ALG>_ALT is not set.
+srcs-y += zuc.c
+srcs-y += snow3g.c
+srcs-y += sm4.c
+srcs-y += sm3_mb.c
+srcs-y += aesce.c
+srcs-y += sha2ce.c
+srcs-y += ecp256.c
+srcs-y += bn_mont.c
+srcs-y += chachapoly_neon.c
+srcs-y += klad_cache.c
+
+# The multi-lane keystream and hash loops, the multi-block SM4, AES and
+# ChaCha20 rounds and the four-way Poly1305 are written to be vectorized,
+# the ECP256 field arithmetic and the Montgomery multiplication of
+# bn_mont.c to be unrolled
+cflags-zuc.c-y += -O3
+cflags-snow3g.c-y += -O3
+cflags-sm4.c-y += -O3
+cflags-sm3_mb.c-y += -O3
+cflags-aesce.c-y += -O3
+cflags-sha2ce.c-y += -O3
+cflags-ecp256.c-y += -O3
+cflags-bn_mont.c-y += -O3
+cflags-chachapoly_neon.c-y += -O3
+
+# UIA2 uses PMULL when the TAs may assume the Armv8 Cryptographic
+# Extension
+cflags-snow3g.c-$(CFG_TA_CRYPTO_WITH_CE) += -march=armv8-a+crypto
+
+# SM4 evaluates its S-box with AESE instead of table lookups
+cflags-sm4.c-$(CFG_TA_CRYPTO_WITH_CE) += -march=armv8-a+crypto
+
+# AES-CE uses AESE/AESD and PMULL throughout. With CFG_TA_CRYPTO_CE_DETECT
+# instead, only the functions using them target the extension.
+cflags-aesce.c-$(CFG_TA_CRYPTO_WITH_CE) += -march=armv8-a+crypto
+
+# SHA-2-CE uses SHA256H and friends. The SHA512 instructions are Armv8.2
+# and optional, they are only used when probed with CFG_TA_CRYPTO_CE_DETECT.
+cflags-sha2ce.c-$(CFG_TA_CRYPTO_WITH_CE) += -march=armv8-a+crypto
@@ -0,0 +1,1228 @@
+/*
+ *  ZUC stream cipher and the 3GPP 128-EEA3 / 128-EIA3 algorithms
+ *
+ *  Copyright (c) 2026, D-Robotics
+ *  SPDX-License-Identifier: BSD-2-Clause
+ */
+/*
+ *  ETSI/SAGE Specification of the 3GPP Confidentiality and Integrity
+ *  Algorithms 128-EEA3 & 128-EIA3:
+ *
+ *  Document 1: 128-EEA3 and 128-EIA3 Specification
+ *  Document 2: ZUC Specification
+ *  Document 3: Implementor's Test Data, see mbedtls_zuc_self_test()
+ */
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#if defined(MBEDTLS_ZUC_C)
+
+#include "mbedtls/zuc.h"
+#include "mbedtls/platform_util.h"
+#if defined(MBEDTLS_KLAD_CACHE_C)
+#include "mbedtls/klad_cache.h"
+#endif
+
+#include <string.h>
+
+#if defined(MBEDTLS_SELF_TEST)
+#if defined(MBEDTLS_PLATFORM_C)
+#include "mbedtls/platform.h"
+#else
+#include <stdio.h>
+#define mbedtls_printf printf
+#endif /* MBEDTLS_PLATFORM_C */
+#endif /* MBEDTLS_SELF_TEST */
+
+#if !defined(MBEDTLS_ZUC_ALT)
+
+/*
+ * 32-bit integer manipulation macros (big endian)
+ */
+#ifndef GET_UINT32_BE
+#define GET_UINT32_BE(n,b,i)                            \
+do {                                                    \
+    (n) = ( (uint32_t) (b)[(i)    ] << 24 )             \
+        | ( (uint32_t) (b)[(i) + 1] << 16 )             \
+        | ( (uint32_t) (b)[(i) + 2] <<  8 )             \
+        | ( (uint32_t) (b)[(i) + 3]       );            \
+} while( 0 )
+#endif
+
+#ifndef PUT_UINT32_BE
+#define PUT_UINT32_BE(n,b,i)                            \
+do {                                                    \
+    (b)[(i)    ] = (unsigned char) ( (n) >> 24 );       \
+    (b)[(i) + 1] = (unsigned char) ( (n) >> 16 );       \
+    (b)[(i) + 2] = (unsigned char) ( (n) >>  8 );       \
+    (b)[(i) + 3] = (unsigned char) ( (n)       );       \
+} while( 0 )
+#endif
+
+#define ZUC_STATE_INIT      0   /* Context initialized */
+#define ZUC_STATE_KEY       1   /* Key set */
+#define ZUC_STATE_STARTED   2   /* Count, bearer and direction set */
+
+#define ZUC_P               0x7fffffffU     /* 2^31 - 1 */
+
+/* Keystream words generated at once by the bulk loops */
+#define ZUC_BLOCK_WORDS     16
+
+#define ROTL32( x, n )      ( ( (x) << (n) ) | ( (x) >> ( 32 - (n) ) ) )
+
+/*
+ * S-boxes S0 and S1 of the nonlinear function F
+ */
+static const unsigned char S0[256] =
+{
+    0x3e, 0x72, 0x5b, 0x47, 0xca, 0xe0, 0x00, 0x33, 0x04, 0xd1, 0x54, 0x98,
+    0x09, 0xb9, 0x6d, 0xcb, 0x7b, 0x1b, 0xf9, 0x32, 0xaf, 0x9d, 0x6a, 0xa5,
+    0xb8, 0x2d, 0xfc, 0x1d, 0x08, 0x53, 0x03, 0x90, 0x4d, 0x4e, 0x84, 0x99,
+    0xe4, 0xce, 0xd9, 0x91, 0xdd, 0xb6, 0x85, 0x48, 0x8b, 0x29, 0x6e, 0xac,
+    0xcd, 0xc1, 0xf8, 0x1e, 0x73, 0x43, 0x69, 0xc6, 0xb5, 0xbd, 0xfd, 0x39,
+    0x63, 0x20, 0xd4, 0x38, 0x76, 0x7d, 0xb2, 0xa7, 0xcf, 0xed, 0x57, 0xc5,
+    0xf3, 0x2c, 0xbb, 0x14, 0x21, 0x06, 0x55, 0x9b, 0xe3, 0xef, 0x5e, 0x31,
+    0x4f, 0x7f, 0x5a, 0xa4, 0x0d, 0x82, 0x51, 0x49, 0x5f, 0xba, 0x58, 0x1c,
+    0x4a, 0x16, 0xd5, 0x17, 0xa8, 0x92, 0x24, 0x1f, 0x8c, 0xff, 0xd8, 0xae,
+    0x2e, 0x01, 0xd3, 0xad, 0x3b, 0x4b, 0xda, 0x46, 0xeb, 0xc9, 0xde, 0x9a,
+    0x8f, 0x87, 0xd7, 0x3a, 0x80, 0x6f, 0x2f, 0xc8, 0xb1, 0xb4, 0x37, 0xf7,
+    0x0a, 0x22, 0x13, 0x28, 0x7c, 0xcc, 0x3c, 0x89, 0xc7, 0xc3, 0x96, 0x56,
+    0x07, 0xbf, 0x7e, 0xf0, 0x0b, 0x2b, 0x97, 0x52, 0x35, 0x41, 0x79, 0x61,
+    0xa6, 0x4c, 0x10, 0xfe, 0xbc, 0x26, 0x95, 0x88, 0x8a, 0xb0, 0xa3, 0xfb,
+    0xc0, 0x18, 0x94, 0xf2, 0xe1, 0xe5, 0xe9, 0x5d, 0xd0, 0xdc, 0x11, 0x66,
+    0x64, 0x5c, 0xec, 0x59, 0x42, 0x75, 0x12, 0xf5, 0x74, 0x9c, 0xaa, 0x23,
+    0x0e, 0x86, 0xab, 0xbe, 0x2a, 0x02, 0xe7, 0x67, 0xe6, 0x44, 0xa2, 0x6c,
+    0xc2, 0x93, 0x9f, 0xf1, 0xf6, 0xfa, 0x36, 0xd2, 0x50, 0x68, 0x9e, 0x62,
+    0x71, 0x15, 0x3d, 0xd6, 0x40, 0xc4, 0xe2, 0x0f, 0x8e, 0x83, 0x77, 0x6b,
+    0x25, 0x05, 0x3f, 0x0c, 0x30, 0xea, 0x70, 0xb7, 0xa1, 0xe8, 0xa9, 0x65,
+    0x8d, 0x27, 0x1a, 0xdb, 0x81, 0xb3, 0xa0, 0xf4, 0x45, 0x7a, 0x19, 0xdf,
+    0xee, 0x78, 0x34, 0x60,
+};
+
+static const unsigned char S1[256] =
+{
+    0x55, 0xc2, 0x63, 0x71, 0x3b, 0xc8, 0x47, 0x86, 0x9f, 0x3c, 0xda, 0x5b,
+    0x29, 0xaa, 0xfd, 0x77, 0x8c, 0xc5, 0x94, 0x0c, 0xa6, 0x1a, 0x13, 0x00,
+    0xe3, 0xa8, 0x16, 0x72, 0x40, 0xf9, 0xf8, 0x42, 0x44, 0x26, 0x68, 0x96,
+    0x81, 0xd9, 0x45, 0x3e, 0x10, 0x76, 0xc6, 0xa7, 0x8b, 0x39, 0x43, 0xe1,
+    0x3a, 0xb5, 0x56, 0x2a, 0xc0, 0x6d, 0xb3, 0x05, 0x22, 0x66, 0xbf, 0xdc,
+    0x0b, 0xfa, 0x62, 0x48, 0xdd, 0x20, 0x11, 0x06, 0x36, 0xc9, 0xc1, 0xcf,
+    0xf6, 0x27, 0x52, 0xbb, 0x69, 0xf5, 0xd4, 0x87, 0x7f, 0x84, 0x4c, 0xd2,
+    0x9c, 0x57, 0xa4, 0xbc, 0x4f, 0x9a, 0xdf, 0xfe, 0xd6, 0x8d, 0x7a, 0xeb,
+    0x2b, 0x53, 0xd8, 0x5c, 0xa1, 0x14, 0x17, 0xfb, 0x23, 0xd5, 0x7d, 0x30,
+    0x67, 0x73, 0x08, 0x09, 0xee, 0xb7, 0x70, 0x3f, 0x61, 0xb2, 0x19, 0x8e,
+    0x4e, 0xe5, 0x4b, 0x93, 0x8f, 0x5d, 0xdb, 0xa9, 0xad, 0xf1, 0xae, 0x2e,
+    0xcb, 0x0d, 0xfc, 0xf4, 0x2d, 0x46, 0x6e, 0x1d, 0x97, 0xe8, 0xd1, 0xe9,
+    0x4d, 0x37, 0xa5, 0x75, 0x5e, 0x83, 0x9e, 0xab, 0x82, 0x9d, 0xb9, 0x1c,
+    0xe0, 0xcd, 0x49, 0x89, 0x01, 0xb6, 0xbd, 0x58, 0x24, 0xa2, 0x5f, 0x38,
+    0x78, 0x99, 0x15, 0x90, 0x50, 0xb8, 0x95, 0xe4, 0xd0, 0x91, 0xc7, 0xce,
+    0xed, 0x0f, 0xb4, 0x6f, 0xa0, 0xcc, 0xf0, 0x02, 0x4a, 0x79, 0xc3, 0xde,
+    0xa3, 0xef, 0xea, 0x51, 0xe6, 0x6b, 0x18, 0xec, 0x1b, 0x2c, 0x80, 0xf7,
+    0x74, 0xe7, 0xff, 0x21, 0x5a, 0x6a, 0x54, 0x1e, 0x41, 0x31, 0x92, 0x35,
+    0xc4, 0x33, 0x07, 0x0a, 0xba, 0x7e, 0x0e, 0x34, 0x88, 0xb1, 0x98, 0x7c,
+    0xf3, 0x3d, 0x60, 0x6c, 0x7b, 0xca, 0xd3, 0x1f, 0x32, 0x65, 0x04, 0x28,
+    0x64, 0xbe, 0x85, 0x9b, 0x2f, 0x59, 0x8a, 0xd7, 0xb0, 0x25, 0xac, 0xaf,
+    0x12, 0x03, 0xe2, 0xf2,
+};
+
+/*
+ * Constants d_i loaded in the LFSR with the key and the IV
+ */
+static const uint16_t EK_D[16] =
+{
+    0x44d7, 0x26bc, 0x626b, 0x135e, 0x5789, 0x35e2, 0x7135, 0x09af,
+    0x4d78, 0x2f13, 0x6bc4, 0x1af1, 0x5e26, 0x3c4d, 0x789a, 0x47ac,
+};
+
+/*
+ * Addition modulo 2^31 - 1 of two 31-bit values. Zero is represented as
+ * 2^31 - 1, which is what the LFSR needs since its cells never are 0.
+ */
+static inline uint32_t add31( uint32_t a, uint32_t b )
+{
+    uint32_t c = a + b;
+
+    return( ( c & ZUC_P ) + ( c >> 31 ) );
+}
+
+/*
+ * Multiplication by 2^k modulo 2^31 - 1, a 31-bit rotation
+ */
+static inline uint32_t rot31( uint32_t a, unsigned int k )
+{
+    return( ( ( a << k ) | ( a >> ( 31 - k ) ) ) & ZUC_P );
+}
+
+/*
+ * Linear transforms L1 and L2
+ */
+static inline uint32_t zuc_l1( uint32_t x )
+{
+    return( x ^ ROTL32( x, 2 ) ^ ROTL32( x, 10 ) ^ ROTL32( x, 18 ) ^
+            ROTL32( x, 24 ) );
+}
+
+static inline uint32_t zuc_l2( uint32_t x )
+{
+    return( x ^ ROTL32( x, 8 ) ^ ROTL32( x, 14 ) ^ ROTL32( x, 22 ) ^
+            ROTL32( x, 30 ) );
+}
+
+static inline uint32_t zuc_sbox( uint32_t x )
+{
+    return( ( (uint32_t) S0[x >> 24] << 24 ) |
+            ( (uint32_t) S1[( x >> 16 ) & 0xff] << 16 ) |
+            ( (uint32_t) S0[( x >> 8 ) & 0xff] << 8 ) |
+            ( (uint32_t) S1[x & 0xff] ) );
+}
+
+/*
+ * LFSR feedback 2^15 s15 + 2^17 s13 + 2^21 s10 + 2^20 s4 + (1 + 2^8) s0,
+ * plus u in initialization mode
+ */
+static inline uint32_t zuc_feedback( uint32_t s0, uint32_t s4, uint32_t s10,
+                                     uint32_t s13, uint32_t s15, uint32_t u )
+{
+    uint32_t v = s0;
+
+    v = add31( v, rot31( s0, 8 ) );
+    v = add31( v, rot31( s4, 20 ) );
+    v = add31( v, rot31( s10, 21 ) );
+    v = add31( v, rot31( s13, 17 ) );
+    v = add31( v, rot31( s15, 15 ) );
+    return( add31( v, u ) );
+}
+
+static inline uint32_t zuc_load( unsigned char k, uint16_t d,
+                                 unsigned char iv )
+{
+    return( ( (uint32_t) k << 23 ) | ( (uint32_t) d << 8 ) | iv );
+}
+
+/*
+ * One clock of the generator on the cells s0 to s15: bit reorganization,
+ * F and the LFSR feedback, returned in s16. Returns W ^ X3, the keystream
+ * word in working mode, the LFSR input being u = W >> 1 in initialization
+ * mode.
+ */
+static inline uint32_t zuc_round( const uint32_t *s, uint32_t *r1,
+                                  uint32_t *r2, int init, uint32_t *s16 )
+{
+    uint32_t x0, x1, x2, x3, w, w1, w2;
+
+    x0 = ( ( s[15] & 0x7fff8000 ) << 1 ) | ( s[14] & 0xffff );
+    x1 = ( s[11] << 16 ) | ( s[9] >> 15 );
+    x2 = ( s[7] << 16 ) | ( s[5] >> 15 );
+    x3 = ( s[2] << 16 ) | ( s[0] >> 15 );
+
+    w = ( x0 ^ *r1 ) + *r2;
+    w1 = *r1 + x1;
+    w2 = *r2 ^ x2;
+    *r1 = zuc_sbox( zuc_l1( ( w1 << 16 ) | ( w2 >> 16 ) ) );
+    *r2 = zuc_sbox( zuc_l2( ( w2 << 16 ) | ( w1 >> 16 ) ) );
+
+    *s16 = zuc_feedback( s[0], s[4], s[10], s[13], s[15],
+                         init ? w >> 1 : 0 );
+
+    return( w ^ x3 );
+}
+
+/*
+ * The LFSR of the context is a circular buffer, shifting it is moving its
+ * head. The bulk loop works on a linear copy instead, which the compiler
+ * can address without wrapping.
+ */
+static void zuc_unwrap( const mbedtls_zuc_state *z, uint32_t *s )
+{
+    unsigned int i;
+
+    for( i = 0; i < 16; i++ )
+        s[i] = z->lfsr[( z->head + i ) & 15];
+}
+
+static uint32_t zuc_clock( mbedtls_zuc_state *z, int init )
+{
+    uint32_t s[16], ks;
+
+    zuc_unwrap( z, s );
+    ks = zuc_round( s, &z->r1, &z->r2, init, &z->lfsr[z->head] );
+    z->head = ( z->head + 1 ) & 15;
+
+    return( ks );
+}
+
+static void zuc_init( mbedtls_zuc_state *z, const unsigned char key[16],
+                      const unsigned char iv[16] )
+{
+    int i;
+
+    for( i = 0; i < 16; i++ )
+        z->lfsr[i] = zuc_load( key[i], EK_D[i], iv[i] );
+    z->r1 = 0;
+    z->r2 = 0;
+    z->head = 0;
+
+    for( i = 0; i < 32; i++ )
+        zuc_clock( z, 1 );
+
+    /* The first word of working mode is discarded */
+    zuc_clock( z, 0 );
+}
+
+static void zuc_keystream( mbedtls_zuc_state *z, uint32_t *ks, size_t n )
+{
+    uint32_t s[16 + ZUC_BLOCK_WORDS];
+    size_t i, m;
+
+    while( n > 0 )
+    {
+        m = n < ZUC_BLOCK_WORDS ? n : ZUC_BLOCK_WORDS;
+        zuc_unwrap( z, s );
+        for( i = 0; i < m; i++ )
+            ks[i] = zuc_round( s + i, &z->r1, &z->r2, 0, s + 16 + i );
+        memcpy( z->lfsr, s + m, sizeof( z->lfsr ) );
+        z->head = 0;
+        ks += m;
+        n -= m;
+    }
+
+    mbedtls_platform_zeroize( s, sizeof( s ) );
+}
+
+/*
+ * XORs the keystream with whole words of input
+ */
+static void zuc_xor_words( mbedtls_zuc_state *z, size_t words,
+                           const unsigned char *input, unsigned char *output )
+{
+    uint32_t ks[ZUC_BLOCK_WORDS];
+    uint32_t x;
+    size_t i, n;
+
+    while( words > 0 )
+    {
+        n = words < ZUC_BLOCK_WORDS ? words : ZUC_BLOCK_WORDS;
+        zuc_keystream( z, ks, n );
+        for( i = 0; i < n; i++ )
+        {
+            GET_UINT32_BE( x, input, 4 * i );
+            x ^= ks[i];
+            PUT_UINT32_BE( x, output, 4 * i );
+        }
+        input += 4 * n;
+        output += 4 * n;
+        words -= n;
+    }
+
+    mbedtls_platform_zeroize( ks, sizeof( ks ) );
+}
+
+static void eea3_iv( unsigned char iv[16], uint32_t count, uint32_t bearer,
+                     uint32_t dir )
+{
+    PUT_UINT32_BE( count, iv, 0 );
+    iv[4] = (unsigned char) ( ( bearer << 3 ) | ( dir << 2 ) );
+    iv[5] = 0;
+    iv[6] = 0;
+    iv[7] = 0;
+    memcpy( iv + 8, iv, 8 );
+}
+
+static void eia3_iv( unsigned char iv[16], uint32_t count, uint32_t bearer,
+                     uint32_t dir )
+{
+    PUT_UINT32_BE( count, iv, 0 );
+    iv[4] = (unsigned char) ( bearer << 3 );
+    iv[5] = 0;
+    iv[6] = 0;
+    iv[7] = 0;
+    memcpy( iv + 8, iv, 8 );
+    iv[8] ^= (unsigned char) ( dir << 7 );
+    iv[14] ^= (unsigned char) ( dir << 7 );
+}
+
+/*
+ * 128-EEA3
+ */
+void mbedtls_eea3_init( mbedtls_eea3_context *ctx )
+{
+    if( ctx == NULL )
+        return;
+
+    memset( ctx, 0, sizeof( mbedtls_eea3_context ) );
+}
+
+void mbedtls_eea3_free( mbedtls_eea3_context *ctx )
+{
+    if( ctx == NULL )
+        return;
+
+    mbedtls_platform_zeroize( ctx, sizeof( mbedtls_eea3_context ) );
+}
+
+int mbedtls_eea3_setkey( mbedtls_eea3_context *ctx,
+                         const unsigned char key[16] )
+{
+    if( ctx == NULL || key == NULL )
+        return( MBEDTLS_ERR_ZUC_BAD_INPUT_DATA );
+    if( ctx->state == ZUC_STATE_STARTED )
+        return( MBEDTLS_ERR_ZUC_HW_ACCEL_FAILED );
+
+    memcpy( ctx->key, key, sizeof( ctx->key ) );
+    ctx->state = ZUC_STATE_KEY;
+
+    return( 0 );
+}
+
+/*
+ * Secure keys are unwrapped by the key ladder of the session, see
+ * mbedtls_klad_cache_set_default(), once per key
+ */
+static int zuc_unwrap_seckey( const mbedtls_klad_seckey_t *key,
+                              unsigned char k[16] )
+{
+#if defined(MBEDTLS_KLAD_CACHE_C)
+    size_t len;
+
+    if( key->ek3bits != 128 )
+        return( MBEDTLS_ERR_ZUC_INVALID_KEY_LENGTH );
+
+    if( mbedtls_klad_cache_unwrap( NULL, key, k, &len ) != 0 )
+        return( MBEDTLS_ERR_ZUC_HW_ACCEL_FAILED );
+
+    return( 0 );
+#else
+    (void) key;
+    (void) k;
+
+    /* Secure keys are only usable through the trust engine key ladder */
+    return( MBEDTLS_ERR_ZUC_HW_ACCEL_FAILED );
+#endif /* MBEDTLS_KLAD_CACHE_C */
+}
+
+int mbedtls_eea3_setseckey( mbedtls_eea3_context *ctx,
+                            const mbedtls_klad_seckey_t *key )
+{
+    unsigned char k[16];
+    int ret;
+
+    if( ctx == NULL || key == NULL )
+        return( MBEDTLS_ERR_ZUC_BAD_INPUT_DATA );
+
+    ret = zuc_unwrap_seckey( key, k );
+    if( ret == 0 )
+        ret = mbedtls_eea3_setkey( ctx, k );
+
+    mbedtls_platform_zeroize( k, sizeof( k ) );
+    return( ret );
+}
+
+int mbedtls_eea3_starts( mbedtls_eea3_context *ctx,
+                         uint32_t count, uint32_t bearer, uint32_t dir )
+{
+    unsigned char iv[16];
+
+    if( ctx == NULL || bearer > 0x1f || dir > 1 )
+        return( MBEDTLS_ERR_ZUC_BAD_INPUT_DATA );
+    if( ctx->state == ZUC_STATE_INIT )
+        return( MBEDTLS_ERR_ZUC_HW_ACCEL_FAILED );
+
+    eea3_iv( iv, count, bearer, dir );
+    zuc_init( &ctx->zuc, ctx->key, iv );
+    ctx->ks_used = sizeof( ctx->ks );
+    ctx->state = ZUC_STATE_STARTED;
+
+    return( 0 );
+}
+
+int mbedtls_eea3_update( mbedtls_eea3_context *ctx,
+                         size_t size, const unsigned char *input,
+                         unsigned char *output )
+{
+    uint32_t w;
+    size_t words;
+
+    if( ctx == NULL || ( size > 0 && ( input == NULL || output == NULL ) ) )
+        return( MBEDTLS_ERR_ZUC_BAD_INPUT_DATA );
+    if( ctx->state != ZUC_STATE_STARTED )
+        return( MBEDTLS_ERR_ZUC_HW_ACCEL_FAILED );
+
+    /* Rest of the keystream word of the previous call */
+    while( size > 0 && ctx->ks_used < sizeof( ctx->ks ) )
+    {
+        *output++ = *input++ ^ ctx->ks[ctx->ks_used++];
+        size--;
+    }
+
+    words = size / 4;
+    zuc_xor_words( &ctx->zuc, words, input, output );
+    input += 4 * words;
+    output += 4 * words;
+    size -= 4 * words;
+
+    if( size > 0 )
+    {
+        w = zuc_clock( &ctx->zuc, 0 );
+        PUT_UINT32_BE( w, ctx->ks, 0 );
+        for( ctx->ks_used = 0; ctx->ks_used < size; ctx->ks_used++ )
+            output[ctx->ks_used] = input[ctx->ks_used] ^
+                                   ctx->ks[ctx->ks_used];
+    }
+
+    return( 0 );
+}
+
+int mbedtls_eea3_finish( mbedtls_eea3_context *ctx )
+{
+    if( ctx == NULL )
+        return( MBEDTLS_ERR_ZUC_BAD_INPUT_DATA );
+    if( ctx->state != ZUC_STATE_STARTED )
+        return( MBEDTLS_ERR_ZUC_HW_ACCEL_FAILED );
+
+    mbedtls_platform_zeroize( &ctx->zuc, sizeof( ctx->zuc ) );
+    mbedtls_platform_zeroize( ctx->ks, sizeof( ctx->ks ) );
+    ctx->state = ZUC_STATE_KEY;
+
+    return( 0 );
+}
+
+int mbedtls_eea3_crypt( const unsigned char key[16],
+                        uint32_t count, uint32_t bearer, uint32_t dir,
+                        size_t size, const unsigned char *input,
+                        unsigned char *output )
+{
+    mbedtls_eea3_context ctx;
+    int ret;
+
+    mbedtls_eea3_init( &ctx );
+
+    ret = mbedtls_eea3_setkey( &ctx, key );
+    if( ret != 0 )
+        goto cleanup;
+
+    ret = mbedtls_eea3_starts( &ctx, count, bearer, dir );
+    if( ret != 0 )
+        goto cleanup;
+
+    ret = mbedtls_eea3_update( &ctx, size, input, output );
+    if( ret != 0 )
+        goto cleanup;
+
+    ret = mbedtls_eea3_finish( &ctx );
+
+cleanup:
+    mbedtls_eea3_free( &ctx );
+    return( ret );
+}
+
+int mbedtls_eea3_crypt_seckey( const mbedtls_klad_seckey_t *key,
+                               uint32_t count, uint32_t bearer,
+                               uint32_t dir, size_t size,
+                               const unsigned char *input,
+                               unsigned char *output )
+{
+    unsigned char k[16];
+    int ret;
+
+    if( key == NULL )
+        return( MBEDTLS_ERR_ZUC_BAD_INPUT_DATA );
+
+    ret = zuc_unwrap_seckey( key, k );
+    if( ret == 0 )
+        ret = mbedtls_eea3_crypt( k, count, bearer, dir, size, input, output );
+
+    mbedtls_platform_zeroize( k, sizeof( k ) );
+    return( ret );
+}
+
+/*
+ * Multi-lane keystream generator: the state of each cell is stored lane
+ * by lane so that every operation of a clock is a loop over the lanes the
+ * compiler turns into vector instructions. Only the S-box lookups remain
+ * scalar.
+ */
+typedef struct
+{
+    uint32_t lfsr[16][MBEDTLS_ZUC_MAX_LANES];
+    uint32_t r1[MBEDTLS_ZUC_MAX_LANES];
+    uint32_t r2[MBEDTLS_ZUC_MAX_LANES];
+    unsigned int head;
+} zuc_lanes;
+
+#define SL( z, i )  ( (z)->lfsr[( (z)->head + (i) ) & 15] )
+
+static inline void zuc_lanes_clock( zuc_lanes *z, size_t lanes, int init,
+                                    uint32_t *ks )
+{
+    uint32_t *s0 = SL( z, 0 );
+    const uint32_t *s2 = SL( z, 2 ), *s4 = SL( z, 4 ), *s5 = SL( z, 5 );
+    const uint32_t *s7 = SL( z, 7 ), *s9 = SL( z, 9 ), *s10 = SL( z, 10 );
+    const uint32_t *s11 = SL( z, 11 ), *s13 = SL( z, 13 );
+    const uint32_t *s14 = SL( z, 14 ), *s15 = SL( z, 15 );
+    uint32_t u1[MBEDTLS_ZUC_MAX_LANES], u2[MBEDTLS_ZUC_MAX_LANES];
+    uint32_t x0, x1, x2, x3, w, w1, w2;
+    size_t l;
+
+    for( l = 0; l < lanes; l++ )
+    {
+        x0 = ( ( s15[l] & 0x7fff8000 ) << 1 ) | ( s14[l] & 0xffff );
+        x1 = ( s11[l] << 16 ) | ( s9[l] >> 15 );
+        x2 = ( s7[l] << 16 ) | ( s5[l] >> 15 );
+        x3 = ( s2[l] << 16 ) | ( s0[l] >> 15 );
+
+        w = ( x0 ^ z->r1[l] ) + z->r2[l];
+        w1 = z->r1[l] + x1;
+        w2 = z->r2[l] ^ x2;
+        u1[l] = zuc_l1( ( w1 << 16 ) | ( w2 >> 16 ) );
+        u2[l] = zuc_l2( ( w2 << 16 ) | ( w1 >> 16 ) );
+        ks[l] = w ^ x3;
+
+        s0[l] = zuc_feedback( s0[l], s4[l], s10[l], s13[l], s15[l],
+                              init ? w >> 1 : 0 );
+    }
+
+    for( l = 0; l < lanes; l++ )
+    {
+        z->r1[l] = zuc_sbox( u1[l] );
+        z->r2[l] = zuc_sbox( u2[l] );
+    }
+
+    z->head = ( z->head + 1 ) & 15;
+}
+
+/*
+ * Encrypts @lanes messages of msgs: the common length in parallel, then
+ * the rest of each message with its own single stream generator.
+ */
+static void eea3_lanes( const mbedtls_eea3_msg *msgs, size_t lanes )
+{
+    zuc_lanes z;
+    mbedtls_eea3_context ctx;
+    uint32_t ks[ZUC_BLOCK_WORDS][MBEDTLS_ZUC_MAX_LANES];
+    unsigned char iv[16];
+    size_t min = msgs[0].size;
+    size_t off, i, l;
+    uint32_t x;
+
+    for( l = 0; l < lanes; l++ )
+    {
+        eea3_iv( iv, msgs[l].count, msgs[l].bearer, msgs[l].dir );
+        for( i = 0; i < 16; i++ )
+            z.lfsr[i][l] = zuc_load( msgs[l].key[i], EK_D[i], iv[i] );
+        z.r1[l] = 0;
+        z.r2[l] = 0;
+        if( msgs[l].size < min )
+            min = msgs[l].size;
+    }
+    z.head = 0;
+
+    for( i = 0; i < 32; i++ )
+        zuc_lanes_clock( &z, lanes, 1, ks[0] );
+    zuc_lanes_clock( &z, lanes, 0, ks[0] );
+
+    for( off = 0; off + 4 * ZUC_BLOCK_WORDS <= min;
+         off += 4 * ZUC_BLOCK_WORDS )
+    {
+        for( i = 0; i < ZUC_BLOCK_WORDS; i++ )
+            zuc_lanes_clock( &z, lanes, 0, ks[i] );
+
+        for( l = 0; l < lanes; l++ )
+        {
+            for( i = 0; i < ZUC_BLOCK_WORDS; i++ )
+            {
+                GET_UINT32_BE( x, msgs[l].input, off + 4 * i );
+                x ^= ks[i][l];
+                PUT_UINT32_BE( x, msgs[l].output, off + 4 * i );
+            }
+        }
+    }
+
+    mbedtls_eea3_init( &ctx );
+    for( l = 0; l < lanes; l++ )
+    {
+        if( msgs[l].size == off )
+            continue;
+
+        for( i = 0; i < 16; i++ )
+            ctx.zuc.lfsr[i] = SL( &z, i )[l];
+        ctx.zuc.r1 = z.r1[l];
+        ctx.zuc.r2 = z.r2[l];
+        ctx.zuc.head = 0;
+        ctx.ks_used = sizeof( ctx.ks );
+        ctx.state = ZUC_STATE_STARTED;
+        mbedtls_eea3_update( &ctx, msgs[l].size - off, msgs[l].input + off,
+                             msgs[l].output + off );
+    }
+
+    mbedtls_eea3_free( &ctx );
+    mbedtls_platform_zeroize( &z, sizeof( z ) );
+    mbedtls_platform_zeroize( ks, sizeof( ks ) );
+}
+
+int mbedtls_eea3_crypt_multi( size_t n, const mbedtls_eea3_msg *msgs )
+{
+    size_t i, lanes;
+
+    if( n > 0 && msgs == NULL )
+        return( MBEDTLS_ERR_ZUC_BAD_INPUT_DATA );
+
+    for( i = 0; i < n; i++ )
+    {
+        if( msgs[i].key == NULL || msgs[i].bearer > 0x1f ||
+            msgs[i].dir > 1 || ( msgs[i].size > 0 &&
+            ( msgs[i].input == NULL || msgs[i].output == NULL ) ) )
+            return( MBEDTLS_ERR_ZUC_BAD_INPUT_DATA );
+    }
+
+    /* Groups of 8 then 4 lanes, the remaining messages one by one */
+    for( i = 0; i < n; i += lanes )
+    {
+        lanes = n - i >= 8 ? 8 : n - i >= 4 ? 4 : 1;
+        if( lanes > MBEDTLS_ZUC_MAX_LANES )
+            lanes = MBEDTLS_ZUC_MAX_LANES;
+
+        if( lanes == 1 )
+            mbedtls_eea3_crypt( msgs[i].key, msgs[i].count, msgs[i].bearer,
+                                msgs[i].dir, msgs[i].size, msgs[i].input,
+                                msgs[i].output );
+        else
+            eea3_lanes( msgs + i, lanes );
+    }
+
+    return( 0 );
+}
+
+/*
+ * 128-EIA3
+ *
+ * Message bit i is authenticated with the keystream bits i to i + 31, the
+ * 64-bit window always holds at least these.
+ */
+static void eia3_refill( mbedtls_eia3_context *ctx )
+{
+    if( ctx->win_bits <= 32 )
+    {
+        ctx->win |= (uint64_t) zuc_clock( &ctx->zuc, 0 ) <<
+                    ( 32 - ctx->win_bits );
+        ctx->win_bits += 32;
+        ctx->words++;
+    }
+}
+
+/*
+ * Feeds the @bits most significant bits of @b
+ */
+static void eia3_bits( mbedtls_eia3_context *ctx, unsigned char b,
+                       unsigned int bits )
+{
+    uint64_t win;
+    uint32_t t;
+    unsigned int j;
+
+    eia3_refill( ctx );
+    win = ctx->win;
+    t = ctx->t;
+    for( j = 0; j < bits; j++ )
+        t ^= (uint32_t) ( win >> ( 32 - j ) ) &
+             ( 0U - ( ( b >> ( 7 - j ) ) & 1 ) );
+    ctx->t = t;
+    ctx->win = win << bits;
+    ctx->win_bits -= bits;
+    ctx->bits += bits;
+}
+
+void mbedtls_eia3_init( mbedtls_eia3_context *ctx )
+{
+    if( ctx == NULL )
+        return;
+
+    memset( ctx, 0, sizeof( mbedtls_eia3_context ) );
+}
+
+void mbedtls_eia3_free( mbedtls_eia3_context *ctx )
+{
+    if( ctx == NULL )
+        return;
+
+    mbedtls_platform_zeroize( ctx, sizeof( mbedtls_eia3_context ) );
+}
+
+int mbedtls_eia3_setkey( mbedtls_eia3_context *ctx,
+                         const unsigned char key[16] )
+{
+    if( ctx == NULL || key == NULL )
+        return( MBEDTLS_ERR_ZUC_BAD_INPUT_DATA );
+    if( ctx->state == ZUC_STATE_STARTED )
+        return( MBEDTLS_ERR_ZUC_HW_ACCEL_FAILED );
+
+    memcpy( ctx->key, key, sizeof( ctx->key ) );
+    ctx->state = ZUC_STATE_KEY;
+
+    return( 0 );
+}
+
+int mbedtls_eia3_setseckey( mbedtls_eia3_context *ctx,
+                            const mbedtls_klad_seckey_t *key )
+{
+    unsigned char k[16];
+    int ret;
+
+    if( ctx == NULL || key == NULL )
+        return( MBEDTLS_ERR_ZUC_BAD_INPUT_DATA );
+
+    ret = zuc_unwrap_seckey( key, k );
+    if( ret == 0 )
+        ret = mbedtls_eia3_setkey( ctx, k );
+
+    mbedtls_platform_zeroize( k, sizeof( k ) );
+    return( ret );
+}
+
+int mbedtls_eia3_starts( mbedtls_eia3_context *ctx,
+                         uint32_t count, uint32_t bearer, uint32_t dir )
+{
+    unsigned char iv[16];
+
+    if( ctx == NULL || bearer > 0x1f || dir > 1 )
+        return( MBEDTLS_ERR_ZUC_BAD_INPUT_DATA );
+    if( ctx->state == ZUC_STATE_INIT )
+        return( MBEDTLS_ERR_ZUC_HW_ACCEL_FAILED );
+
+    eia3_iv( iv, count, bearer, dir );
+    zuc_init( &ctx->zuc, ctx->key, iv );
+    ctx->win = (uint64_t) zuc_clock( &ctx->zuc, 0 ) << 32;
+    ctx->win |= zuc_clock( &ctx->zuc, 0 );
+    ctx->win_bits = 64;
+    ctx->words = 2;
+    ctx->t = 0;
+    ctx->bits = 0;
+    ctx->state = ZUC_STATE_STARTED;
+
+    return( 0 );
+}
+
+int mbedtls_eia3_update( mbedtls_eia3_context *ctx,
+                         size_t size, const unsigned char *input )
+{
+    size_t i;
+
+    if( ctx == NULL || ( size > 0 && input == NULL ) )
+        return( MBEDTLS_ERR_ZUC_BAD_INPUT_DATA );
+    if( ctx->state != ZUC_STATE_STARTED || ctx->bits % 8 != 0 )
+        return( MBEDTLS_ERR_ZUC_HW_ACCEL_FAILED );
+
+    for( i = 0; i < size; i++ )
+        eia3_bits( ctx, input[i], 8 );
+
+    return( 0 );
+}
+
+int mbedtls_eia3_finish( mbedtls_eia3_context *ctx,
+                         unsigned char output[4] )
+{
+    uint32_t t, z = 0;
+    size_t k;
+
+    if( ctx == NULL || output == NULL )
+        return( MBEDTLS_ERR_ZUC_BAD_INPUT_DATA );
+    if( ctx->state != ZUC_STATE_STARTED )
+        return( MBEDTLS_ERR_ZUC_HW_ACCEL_FAILED );
+
+    /* T ^= z_LENGTH, then MAC = T ^ z_(32 * (L - 1)) with L = ceil(LENGTH
+     * / 32) + 2, that is keystream word ceil(LENGTH / 32) + 1 */
+    t = ctx->t ^ (uint32_t) ( ctx->win >> 32 );
+    k = ( ctx->bits + 31 ) / 32 + 1;
+    if( k < ctx->words )
+        z = (uint32_t) ( ctx->win >> ( 64 - ctx->win_bits ) );
+    while( ctx->words <= k )
+    {
+        z = zuc_clock( &ctx->zuc, 0 );
+        ctx->words++;
+    }
+    t ^= z;
+    PUT_UINT32_BE( t, output, 0 );
+
+    mbedtls_platform_zeroize( &ctx->zuc, sizeof( ctx->zuc ) );
+    ctx->win = 0;
+    ctx->t = 0;
+    ctx->state = ZUC_STATE_KEY;
+
+    return( 0 );
+}
+
+int mbedtls_eia3_mac( const unsigned char key[16],
+                      uint32_t count, uint32_t bearer, uint32_t dir,
+                      size_t size, const unsigned char *input,
+                      unsigned char output[4] )
+{
+    mbedtls_eia3_context ctx;
+    int ret;
+
+    mbedtls_eia3_init( &ctx );
+
+    ret = mbedtls_eia3_setkey( &ctx, key );
+    if( ret != 0 )
+        goto cleanup;
+
+    ret = mbedtls_eia3_starts( &ctx, count, bearer, dir );
+    if( ret != 0 )
+        goto cleanup;
+
+    ret = mbedtls_eia3_update( &ctx, size, input );
+    if( ret != 0 )
+        goto cleanup;
+
+    ret = mbedtls_eia3_finish( &ctx, output );
+
+cleanup:
+    mbedtls_eia3_free( &ctx );
+    return( ret );
+}
+
+int mbedtls_eia3_mac_seckey( const mbedtls_klad_seckey_t *key,
+                             uint32_t count, uint32_t bearer, uint32_t dir,
+                             size_t size, const unsigned char *input,
+                             unsigned char output[4] )
+{
+    unsigned char k[16];
+    int ret;
+
+    if( key == NULL )
+        return( MBEDTLS_ERR_ZUC_BAD_INPUT_DATA );
+
+    ret = zuc_unwrap_seckey( key, k );
+    if( ret == 0 )
+        ret = mbedtls_eia3_mac( k, count, bearer, dir, size, input, output );
+
+    mbedtls_platform_zeroize( k, sizeof( k ) );
+    return( ret );
+}
+
+#if defined(MBEDTLS_SELF_TEST)
+
+/*
+ * Test data from document 3 of the 128-EEA3 & 128-EIA3 specification
+ */
+static const unsigned char ks_test_key[4][16] =
+{
+    { 0x00 },
+    { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff },
+    { 0x3d, 0x4c, 0x4b, 0xe9, 0x6a, 0x82, 0xfd, 0xae,
+      0xb5, 0x8f, 0x64, 0x1d, 0xb1, 0x7b, 0x45, 0x5b },
+    { 0x4d, 0x32, 0x0b, 0xfa, 0xd4, 0xc2, 0x85, 0xbf,
+      0xd6, 0xb8, 0xbd, 0x00, 0xf3, 0x9d, 0x8b, 0x41 },
+};
+
+static const unsigned char ks_test_iv[4][16] =
+{
+    { 0x00 },
+    { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff },
+    { 0x84, 0x31, 0x9a, 0xa8, 0xde, 0x69, 0x15, 0xca,
+      0x1f, 0x6b, 0xda, 0x6b, 0xfb, 0xd8, 0xc7, 0x66 },
+    { 0x52, 0x95, 0x9d, 0xab, 0xa0, 0xbf, 0x17, 0x6e,
+      0xce, 0x2d, 0xc3, 0x15, 0x04, 0x9e, 0xb5, 0x74 },
+};
+
+/* z1, z2 and, for the last set, z2000 */
+static const uint32_t ks_test_z[4][3] =
+{
+    { 0x27bede74, 0x018082da, 0 },
+    { 0x0657cfa0, 0x7096398b, 0 },
+    { 0x14f1c272, 0x3279c419, 0 },
+    { 0xed4400e7, 0x0633e5c5, 0x7a574cdb },
+};
+
+typedef struct
+{
+    unsigned char key[16];
+    uint32_t count;
+    uint32_t bearer;
+    uint32_t dir;
+    size_t bits;
+    const unsigned char *in;
+    const unsigned char *out;
+} zuc_test_vector;
+
+static const unsigned char eea3_pt1[] =
+{
+    0x6c, 0xf6, 0x53, 0x40, 0x73, 0x55, 0x52, 0xab,
+    0x0c, 0x97, 0x52, 0xfa, 0x6f, 0x90, 0x25, 0xfe,
+    0x0b, 0xd6, 0x75, 0xd9, 0x00, 0x58, 0x75, 0xb2,
+    0x00,
+};
+
+static const unsigned char eea3_ct1[] =
+{
+    0xa6, 0xc8, 0x5f, 0xc6, 0x6a, 0xfb, 0x85, 0x33,
+    0xaa, 0xfc, 0x25, 0x18, 0xdf, 0xe7, 0x84, 0x94,
+    0x0e, 0xe1, 0xe4, 0xb0, 0x30, 0x23, 0x8c, 0xc8,
+    0x00,
+};
+
+static const unsigned char eea3_pt2[] =
+{
+    0x14, 0xa8, 0xef, 0x69, 0x3d, 0x67, 0x85, 0x07,
+    0xbb, 0xe7, 0x27, 0x0a, 0x7f, 0x67, 0xff, 0x50,
+    0x06, 0xc3, 0x52, 0x5b, 0x98, 0x07, 0xe4, 0x67,
+    0xc4, 0xe5, 0x60, 0x00, 0xba, 0x33, 0x8f, 0x5d,
+    0x42, 0x95, 0x59, 0x03, 0x67, 0x51, 0x82, 0x22,
+    0x46, 0xc8, 0x0d, 0x3b, 0x38, 0xf0, 0x7f, 0x4b,
+    0xe2, 0xd8, 0xff, 0x58, 0x05, 0xf5, 0x13, 0x22,
+    0x29, 0xbd, 0xe9, 0x3b, 0xbb, 0xdc, 0xaf, 0x38,
+    0x2b, 0xf1, 0xee, 0x97, 0x2f, 0xbf, 0x99, 0x77,
+    0xba, 0xda, 0x89, 0x45, 0x84, 0x7a, 0x2a, 0x6c,
+    0x9a, 0xd3, 0x4a, 0x66, 0x75, 0x54, 0xe0, 0x4d,
+    0x1f, 0x7f, 0xa2, 0xc3, 0x32, 0x41, 0xbd, 0x8f,
+    0x01, 0xba, 0x22, 0x0d,
+};
+
+static const unsigned char eea3_ct2[] =
+{
+    0x13, 0x1d, 0x43, 0xe0, 0xde, 0xa1, 0xbe, 0x5c,
+    0x5a, 0x1b, 0xfd, 0x97, 0x1d, 0x85, 0x2c, 0xbf,
+    0x71, 0x2d, 0x7b, 0x4f, 0x57, 0x96, 0x1f, 0xea,
+    0x32, 0x08, 0xaf, 0xa8, 0xbc, 0xa4, 0x33, 0xf4,
+    0x56, 0xad, 0x09, 0xc7, 0x41, 0x7e, 0x58, 0xbc,
+    0x69, 0xcf, 0x88, 0x66, 0xd1, 0x35, 0x3f, 0x74,
+    0x86, 0x5e, 0x80, 0x78, 0x1d, 0x20, 0x2d, 0xfb,
+    0x3e, 0xcf, 0xf7, 0xfc, 0xbc, 0x3b, 0x19, 0x0f,
+    0xe8, 0x2a, 0x20, 0x4e, 0xd0, 0xe3, 0x50, 0xfc,
+    0x0f, 0x6f, 0x26, 0x13, 0xb2, 0xf2, 0xbc, 0xa6,
+    0xdf, 0x5a, 0x47, 0x3a, 0x57, 0xa4, 0xa0, 0x0d,
+    0x98, 0x5e, 0xba, 0xd8, 0x80, 0xd6, 0xf2, 0x38,
+    0x64, 0xa0, 0x7b, 0x01,
+};
+
+static const zuc_test_vector eea3_tests[2] =
+{
+    {
+        { 0x17, 0x3d, 0x14, 0xba, 0x50, 0x03, 0x73, 0x1d,
+          0x7a, 0x60, 0x04, 0x94, 0x70, 0xf0, 0x0a, 0x29 },
+        0x66035492, 0x0f, 0, 193, eea3_pt1, eea3_ct1
+    },
+    {
+        { 0xe5, 0xbd, 0x3e, 0xa0, 0xeb, 0x55, 0xad, 0xe8,
+          0x66, 0xc6, 0xac, 0x58, 0xbd, 0x54, 0x30, 0x2a },
+        0x00056823, 0x18, 1, 800, eea3_pt2, eea3_ct2
+    },
+};
+
+static const unsigned char eia3_msg1[] = { 0x00 };
+
+static const unsigned char eia3_msg2[12] = { 0x00 };
+
+static const unsigned char eia3_msg3[] =
+{
+    0x98, 0x3b, 0x41, 0xd4, 0x7d, 0x78, 0x0c, 0x9e,
+    0x1a, 0xd1, 0x1d, 0x7e, 0xb7, 0x03, 0x91, 0xb1,
+    0xde, 0x0b, 0x35, 0xda, 0x2d, 0xc6, 0x2f, 0x83,
+    0xe7, 0xb7, 0x8d, 0x63, 0x06, 0xca, 0x0e, 0xa0,
+    0x7e, 0x94, 0x1b, 0x7b, 0xe9, 0x13, 0x48, 0xf9,
+    0xfc, 0xb1, 0x70, 0xe2, 0x21, 0x7f, 0xec, 0xd9,
+    0x7f, 0x9f, 0x68, 0xad, 0xb1, 0x6e, 0x5d, 0x7d,
+    0x21, 0xe5, 0x69, 0xd2, 0x80, 0xed, 0x77, 0x5c,
+    0xeb, 0xde, 0x3f, 0x40, 0x93, 0xc5, 0x38, 0x81,
+    0x00,
+};
+
+static const unsigned char eia3_mac1[4] = { 0xc8, 0xa9, 0x59, 0x5e };
+static const unsigned char eia3_mac2[4] = { 0x67, 0x19, 0xa0, 0x88 };
+static const unsigned char eia3_mac3[4] = { 0xfa, 0xe8, 0xff, 0x0b };
+
+static const zuc_test_vector eia3_tests[3] =
+{
+    {
+        { 0x00 },
+        0, 0, 0, 1, eia3_msg1, eia3_mac1
+    },
+    {
+        { 0x47, 0x05, 0x41, 0x25, 0x56, 0x1e, 0xb2, 0xdd,
+          0xa9, 0x40, 0x59, 0xda, 0x05, 0x09, 0x78, 0x50 },
+        0x561eb2dd, 0x14, 0, 90, eia3_msg2, eia3_mac2
+    },
+    {
+        { 0xc9, 0xe6, 0xce, 0xc4, 0x60, 0x7c, 0x72, 0xdb,
+          0x00, 0x0a, 0xef, 0xa8, 0x83, 0x85, 0xab, 0x0a },
+        0xa94059da, 0x0a, 1, 577, eia3_msg3, eia3_mac3
+    },
+};
+
+/* Compares @bits bits, the unused bits of the last byte being ignored */
+static int zuc_test_cmp( const unsigned char *a, const unsigned char *b,
+                         size_t bits )
+{
+    size_t n = bits / 8;
+    unsigned char mask = (unsigned char) ( 0xff00 >> ( bits % 8 ) );
+
+    if( memcmp( a, b, n ) != 0 )
+        return( 1 );
+    return( bits % 8 != 0 && ( ( a[n] ^ b[n] ) & mask ) != 0 );
+}
+
+/* The message bits that do not fill a byte take the bit level path */
+static int zuc_test_eia3( const zuc_test_vector *v, unsigned char mac[4] )
+{
+    mbedtls_eia3_context ctx;
+    int ret;
+
+    mbedtls_eia3_init( &ctx );
+    ret = mbedtls_eia3_setkey( &ctx, v->key );
+    if( ret == 0 )
+        ret = mbedtls_eia3_starts( &ctx, v->count, v->bearer, v->dir );
+    if( ret == 0 )
+        ret = mbedtls_eia3_update( &ctx, v->bits / 8, v->in );
+    if( ret == 0 )
+    {
+        if( v->bits % 8 != 0 )
+            eia3_bits( &ctx, v->in[v->bits / 8], v->bits % 8 );
+        ret = mbedtls_eia3_finish( &ctx, mac );
+    }
+    mbedtls_eia3_free( &ctx );
+
+    return( ret );
+}
+
+#define ZUC_TEST_MSGS   13
+
+/* Only the second vector is long enough for the parallel loop */
+#define ZUC_TEST_VEC( i )   ( eea3_tests + ( (i) < 8 || (i) % 2 != 0 ) )
+
+/*
+ * Checkup routine
+ */
+int mbedtls_zuc_self_test( int verbose )
+{
+    mbedtls_zuc_state z;
+    mbedtls_eea3_context ctx;
+    mbedtls_eea3_msg msgs[ZUC_TEST_MSGS];
+    unsigned char buf[ZUC_TEST_MSGS][sizeof( eea3_ct2 )];
+    unsigned char mac[4];
+    const zuc_test_vector *v;
+    uint32_t ks[2];
+    size_t i, j, len;
+    int ret = 0;
+
+    for( i = 0; i < 4; i++ )
+    {
+        if( verbose != 0 )
+            mbedtls_printf( "  ZUC keystream test #%u: ", (unsigned) i + 1 );
+
+        zuc_init( &z, ks_test_key[i], ks_test_iv[i] );
+        zuc_keystream( &z, ks, 2 );
+        if( ks[0] != ks_test_z[i][0] || ks[1] != ks_test_z[i][1] )
+            goto fail;
+        if( ks_test_z[i][2] != 0 )
+        {
+            for( j = 2; j < 2000; j++ )
+                ks[0] = zuc_clock( &z, 0 );
+            if( ks[0] != ks_test_z[i][2] )
+                goto fail;
+        }
+
+        if( verbose != 0 )
+            mbedtls_printf( "passed\n" );
+    }
+
+    for( i = 0; i < 2; i++ )
+    {
+        v = eea3_tests + i;
+        len = ( v->bits + 7 ) / 8;
+
+        if( verbose != 0 )
+            mbedtls_printf( "  EEA3 test #%u: ", (unsigned) i + 1 );
+
+        if( mbedtls_eea3_crypt( v->key, v->count, v->bearer, v->dir, len,
+                                v->in, buf[0] ) != 0 ||
+            zuc_test_cmp( buf[0], v->out, v->bits ) != 0 )
+            goto fail;
+
+        /* Piecewise, across keystream word boundaries */
+        mbedtls_eea3_init( &ctx );
+        if( mbedtls_eea3_setkey( &ctx, v->key ) != 0 ||
+            mbedtls_eea3_starts( &ctx, v->count, v->bearer, v->dir ) != 0 )
+            goto fail_ctx;
+        for( j = 0; j < len; j += ( j % 7 ) + 1 )
+        {
+            if( mbedtls_eea3_update( &ctx, len - j < ( j % 7 ) + 1 ?
+                                     len - j : ( j % 7 ) + 1,
+                                     v->in + j, buf[0] + j ) != 0 )
+                goto fail_ctx;
+        }
+        if( mbedtls_eea3_finish( &ctx ) != 0 ||
+            zuc_test_cmp( buf[0], v->out, v->bits ) != 0 )
+            goto fail_ctx;
+        mbedtls_eea3_free( &ctx );
+
+        if( verbose != 0 )
+            mbedtls_printf( "passed\n" );
+    }
+
+    /* 8 + 4 lanes and a single message, of different lengths */
+    if( verbose != 0 )
+        mbedtls_printf( "  EEA3 multi-lane test: " );
+
+    for( i = 0; i < ZUC_TEST_MSGS; i++ )
+    {
+        v = ZUC_TEST_VEC( i );
+        msgs[i].key = v->key;
+        msgs[i].count = v->count;
+        msgs[i].bearer = v->bearer;
+        msgs[i].dir = v->dir;
+        msgs[i].size = ( v->bits + 7 ) / 8;
+        msgs[i].input = v->in;
+        msgs[i].output = buf[i];
+    }
+    if( mbedtls_eea3_crypt_multi( ZUC_TEST_MSGS, msgs ) != 0 )
+        goto fail;
+    for( i = 0; i < ZUC_TEST_MSGS; i++ )
+    {
+        v = ZUC_TEST_VEC( i );
+        if( zuc_test_cmp( buf[i], v->out, v->bits ) != 0 )
+            goto fail;
+    }
+
+    if( verbose != 0 )
+        mbedtls_printf( "passed\n" );
+
+    for( i = 0; i < 3; i++ )
+    {
+        v = eia3_tests + i;
+
+        if( verbose != 0 )
+            mbedtls_printf( "  EIA3 test #%u: ", (unsigned) i + 1 );
+
+        if( zuc_test_eia3( v, mac ) != 0 || memcmp( mac, v->out, 4 ) != 0 )
+            goto fail;
+
+        if( verbose != 0 )
+            mbedtls_printf( "passed\n" );
+    }
+
+    if( verbose != 0 )
+        mbedtls_printf( "\n" );
+
+    goto exit;
+
+fail_ctx:
+    mbedtls_eea3_free( &ctx );
+fail:
+    if( verbose != 0 )
+        mbedtls_printf( "failed\n" );
+    ret = 1;
+
+exit:
+    mbedtls_platform_zeroize( &z, sizeof( z ) );
+    return( ret );
+}
+
+#endif /* MBEDTLS_SELF_TEST */
+
+#endif /* !MBEDTLS_ZUC_ALT */
+
+#endif /* MBEDTLS_ZUC_C */
@@ -0,0 +1,259 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2026, D-Robotics
+ */
+
+#include <arm_user_sysreg.h>
+#include <binlog.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <tee_internal_api.h>
+#include <user_ta_header.h>
+#include <utee_syscalls.h>
+#include <util.h>
+
+/* Bytes of a batch per line of the console, 64 once base64 encoded */
+#define LINE_BYTES	48
+/* Text handed to each _utee_log() */
+#define FLUSH_TEXT	4096
+
+/* With CFG_TA_BINLOG=y the TA is linked with --wrap=TEE_Panic */
+void __real_TEE_Panic(TEE_Result panicCode) __noreturn;
+void __wrap_TEE_Panic(TEE_Result panicCode) __noreturn;
+
+/* See user_ta_header.c, the first bytes of the TA ELF */
+extern const struct ta_head ta_head;
+
+/* A struct binlog_hdr, filled in when flushed, then the records */
+static uint8_t log_buf[sizeof(struct binlog_hdr) + CFG_TA_BINLOG_SIZE]
+	__aligned(8);
+static size_t log_used;
+static uint32_t lost;
+/* Set by binlog_drain(), records that do not fit are then dropped */
+static bool drained;
+
+static char flush_text[FLUSH_TEXT];
+static char line_tag[sizeof(BINLOG_CONSOLE_TAG) + 38];
+
+static uint8_t *records(void)
+{
+	return log_buf + sizeof(struct binlog_hdr);
+}
+
+static void put_hdr(void *dst, size_t size)
+{
+	struct binlog_hdr hdr = {
+		.magic = BINLOG_MAGIC,
+		.version = BINLOG_VERSION,
+		.hdr_size = sizeof(hdr),
+		.freq = read_cntfrq(),
+		.size = size,
+		.lost = lost,
+	};
+
+	memcpy(dst, &hdr, sizeof(hdr));
+	lost = 0;
+}
+
+static size_t base64(char *dst, const uint8_t *src, size_t len)
+{
+	static const char chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+				    "abcdefghijklmnopqrstuvwxyz0123456789+/";
+	uint32_t v = 0;
+	size_t n = 0;
+	size_t i = 0;
+
+	for (i = 0; i < len; i += 3) {
+		v = src[i] << 16;
+		if (i + 1 < len)
+			v |= src[i + 1] << 8;
+		if (i + 2 < len)
+			v |= src[i + 2];
+		dst[n++] = chars[(v >> 18) & 0x3f];
+		dst[n++] = chars[(v >> 12) & 0x3f];
+		dst[n++] = i + 1 < len ? chars[(v >> 6) & 0x3f] : '=';
+		dst[n++] = i + 2 < len ? chars[v & 0x3f] : '=';
+	}
+
+	return n;
+}
+
+static const char *tag(void)
+{
+	const TEE_UUID *u = &ta_head.uuid;
+
+	if (!line_tag[0])
+		snprintf(line_tag, sizeof(line_tag),
+			 BINLOG_CONSOLE_TAG " %08x-%04x-%04x-%02x%02x-"
+			 "%02x%02x%02x%02x%02x%02x ", u->timeLow, u->timeMid,
+			 u->timeHiAndVersion, u->clockSeqAndNode[0],
+			 u->clockSeqAndNode[1], u->clockSeqAndNode[2],
+			 u->clockSeqAndNode[3], u->clockSeqAndNode[4],
+			 u->clockSeqAndNode[5], u->clockSeqAndNode[6],
+			 u->clockSeqAndNode[7]);
+
+	return line_tag;
+}
+
+TEE_Result binlog_flush(void)
+{
+	size_t tag_len = strlen(tag());
+	size_t line_len = tag_len + LINE_BYTES / 3 * 4 + 1;
+	size_t total = 0;
+	size_t text = 0;
+	size_t offs = 0;
+	size_t n = 0;
+
+	if (!log_used && !lost)
+		return TEE_SUCCESS;
+
+	put_hdr(log_buf, log_used);
+	total = sizeof(struct binlog_hdr) + log_used;
+
+	for (offs = 0; offs < total; offs += n) {
+		if (text + line_len > sizeof(flush_text)) {
+			_utee_log(flush_text, text);
+			text = 0;
+		}
+		n = MIN(total - offs, (size_t)LINE_BYTES);
+		memcpy(flush_text + text, line_tag, tag_len);
+		text += tag_len;
+		text += base64(flush_text + text, log_buf + offs, n);
+		flush_text[text++] = '\n';
+	}
+	_utee_log(flush_text, text);
+
+	log_used = 0;
+	return TEE_SUCCESS;
+}
+
+/* Room for a record of @size bytes, flushing the others if needed */
+static struct binlog_rec *reserve(size_t size)
+{
+	struct binlog_rec *rec = NULL;
+
+	if (log_used + size > CFG_TA_BINLOG_SIZE) {
+		if (!drained)
+			binlog_flush();
+		if (drained || size > CFG_TA_BINLOG_SIZE) {
+			lost++;
+			return NULL;
+		}
+	}
+
+	rec = (struct binlog_rec *)(records() + log_used);
+	log_used += size;
+	return rec;
+}
+
+static void record(const char *site, unsigned int nargs, unsigned int strs,
+		   const uint64_t *args, const void *const *data,
+		   const size_t *lens)
+{
+	struct binlog_rec *rec = NULL;
+	size_t size = sizeof(*rec) + nargs * sizeof(uint64_t);
+	uint64_t *vals = NULL;
+	uint8_t *p = NULL;
+	unsigned int n = 0;
+
+	for (n = 0; n < nargs; n++)
+		if (strs & BIT(n))
+			size += lens[n];
+	size = ROUNDUP(size, 8);
+
+	rec = reserve(size);
+	if (!rec)
+		return;
+
+	rec->time = read_cntvct();
+	rec->site = (uintptr_t)site - (uintptr_t)&ta_head;
+	rec->size = size;
+	rec->nargs = nargs;
+	rec->strs = strs;
+
+	vals = (uint64_t *)(rec + 1);
+	p = (uint8_t *)(vals + nargs);
+	for (n = 0; n < nargs; n++) {
+		if (!(strs & BIT(n))) {
+			vals[n] = args[n];
+			continue;
+		}
+		vals[n] = lens[n];
+		memcpy(p, data[n], lens[n]);
+		p += lens[n];
+	}
+	memset(p, 0, (uint8_t *)rec + size - p);
+}
+
+void binlog_write(const char *site, int level, unsigned int nargs,
+		  unsigned int strs, const uint64_t *args)
+{
+	const void *data[BINLOG_MAX_ARGS] = { };
+	size_t lens[BINLOG_MAX_ARGS] = { };
+	unsigned int n = 0;
+
+	if (level > trace_level || nargs > BINLOG_MAX_ARGS)
+		return;
+
+	for (n = 0; n < nargs; n++) {
+		if (!(strs & BIT(n)))
+			continue;
+		data[n] = (const char *)(uintptr_t)args[n];
+		if (!data[n])
+			data[n] = "(null)";
+		lens[n] = strnlen(data[n], BINLOG_MAX_STR);
+	}
+
+	record(site, nargs, strs, args, data, lens);
+}
+
+void binlog_hexdump(const char *site, int level, const void *buf, int len)
+{
+	size_t n = len > 0 ? MIN((size_t)len, (size_t)BINLOG_MAX_DATA) : 0;
+	uint64_t arg = 0;
+
+	if (level > trace_level)
+		return;
+
+	record(site, 1, 1, &arg, &buf, &n);
+}
+
+TEE_Result binlog_drain(void *buf, size_t *len)
+{
+	struct binlog_rec *rec = NULL;
+	size_t size = 0;
+
+	drained = true;
+
+	while (size < log_used) {
+		rec = (struct binlog_rec *)(records() + size);
+		if (sizeof(struct binlog_hdr) + size + rec->size > *len)
+			break;
+		size += rec->size;
+	}
+
+	if (!size && log_used) {
+		*len = sizeof(struct binlog_hdr) +
+		       ((struct binlog_rec *)records())->size;
+		return TEE_ERROR_SHORT_BUFFER;
+	}
+	if (*len < sizeof(struct binlog_hdr)) {
+		*len = sizeof(struct binlog_hdr);
+		return TEE_ERROR_SHORT_BUFFER;
+	}
+
+	put_hdr(buf, size);
+	memcpy((uint8_t *)buf + sizeof(struct binlog_hdr), records(), size);
+	memmove(records(), records() + size, log_used - size);
+	log_used -= size;
+	*len = sizeof(struct binlog_hdr) + size;
+
+	return TEE_SUCCESS;
+}
+
+void __wrap_TEE_Panic(TEE_Result panicCode)
+{
+	binlog_flush();
+	__real_TEE_Panic(panicCode);
+}
@@ -0,0 +1,349 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2026, D-Robotics
+ */
+
+#include <arm_user_sysreg.h>
+#include <heap_prof.h>
+#include <stdbool.h>
+#include <string.h>
+#include <tee_internal_api.h>
+#include <user_ta_header.h>
+#include <util.h>
+
+/*
+ * With CFG_TA_HEAP_PROF=y the TA is linked with --wrap=malloc and so on,
+ * see ta_lib.mk, and __real_malloc() is the malloc() of libutils. The
+ * sources of the TA built with ENABLE_MDBG call the mdbg_*() hooks below
+ * instead, libutils has none.
+ */
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t nmemb, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void *__real_memalign(size_t alignment, size_t size);
+void __real_free(void *ptr);
+
+void *__wrap_malloc(size_t size);
+void *__wrap_calloc(size_t nmemb, size_t size);
+void *__wrap_realloc(void *ptr, size_t size);
+void *__wrap_memalign(size_t alignment, size_t size);
+void __wrap_free(void *ptr);
+
+void *mdbg_malloc(const char *fname, int lineno, size_t size);
+void *mdbg_calloc(const char *fname, int lineno, size_t nmemb, size_t size);
+void *mdbg_realloc(const char *fname, int lineno, void *ptr, size_t size);
+void *mdbg_memalign(const char *fname, int lineno, size_t alignment,
+		    size_t size);
+void *mdbg_aligned_alloc(const char *fname, int lineno, size_t alignment,
+			 size_t size);
+/* A macro without ENABLE_MDBG */
+void (mdbg_check)(int bufdump);
+
+/* See user_ta_header.c, the first bytes of the TA ELF */
+extern const struct ta_head ta_head;
+extern uint8_t ta_heap[];
+extern const size_t ta_heap_size;
+
+struct site {
+	const char *file;
+	uint32_t line;
+	uintptr_t addr;
+};
+
+/* Slot n holds site n + 1, site 0 stands for those that did not fit */
+static struct site sites[HEAP_PROF_MAX_SITES];
+static size_t nsites;
+
+static struct heap_prof_event events[CFG_TA_HEAP_PROF_EVENTS];
+static uint32_t ev_head;	/* Events recorded */
+static uint32_t ev_tail;	/* Events drained */
+static uint64_t tail_time;	/* Counter value of the event at ev_tail */
+static uint64_t head_time;	/* Counter value of the last event recorded */
+static struct heap_prof_event *lost_ev;	/* Marker still counting */
+static uint32_t lost;
+
+static uint16_t site_id(const char *file, uint32_t line, uintptr_t addr)
+{
+	uint32_t h = ((uintptr_t)file ^ addr ^ line * 0x9E3779B1U) *
+		     0x85EBCA6BU;
+	size_t n = 0;
+	size_t i = 0;
+
+	for (n = 0; n < HEAP_PROF_MAX_SITES; n++) {
+		i = (h + n) % HEAP_PROF_MAX_SITES;
+		if (sites[i].file == file && sites[i].line == line &&
+		    sites[i].addr == addr)
+			return i + 1;
+		if (!sites[i].file && !sites[i].addr)
+			break;
+	}
+
+	/* Keep a slot free so that lookups terminate */
+	if (n == HEAP_PROF_MAX_SITES || nsites == HEAP_PROF_MAX_SITES - 1)
+		return 0;
+
+	sites[i].file = file;
+	sites[i].line = line;
+	sites[i].addr = addr;
+	nsites++;
+
+	return i + 1;
+}
+
+static uint16_t caller_site(void *ra)
+{
+	/* The call is the instruction before the return address */
+	return site_id(NULL, 0, (uintptr_t)ra - 4 - (uintptr_t)&ta_head);
+}
+
+static uint16_t file_site(const char *fname, int lineno)
+{
+	return site_id(fname, lineno, 0);
+}
+
+static struct heap_prof_event *push(uint8_t type, uint32_t offset,
+				    uint32_t size, uint16_t site, uint64_t now)
+{
+	struct heap_prof_event *ev = events + ev_head % CFG_TA_HEAP_PROF_EVENTS;
+
+	if (ev_head == ev_tail)
+		tail_time = now;
+
+	ev->time = now;
+	ev->offset = offset;
+	ev->size = size;
+	ev->site = site;
+	ev->type = type;
+	ev->reserved = 0;
+	ev_head++;
+	head_time = now;
+	lost_ev = NULL;
+
+	return ev;
+}
+
+static void record(uint8_t type, void *ptr, size_t size, uint16_t site)
+{
+	uintptr_t offs = (uintptr_t)ptr - (uintptr_t)ta_heap;
+	uint64_t now = read_cntvct();
+	uint32_t room = CFG_TA_HEAP_PROF_EVENTS - (ev_head - ev_tail);
+	bool resync = ev_head && now - head_time > UINT32_MAX;
+
+	/* Events leave a slot free, the marker is the only one to take it */
+	if (room < 2U + resync) {
+		if (!lost_ev)
+			lost_ev = push(HEAP_PROF_EV_LOST, 0, now >> 32, 0, now);
+		lost_ev->offset++;
+		lost++;
+		return;
+	}
+
+	if (resync)
+		push(HEAP_PROF_EV_TIME, HEAP_PROF_OFFSET_NONE, now >> 32, 0,
+		     now);
+	push(type, offs < ta_heap_size ? offs : HEAP_PROF_OFFSET_NONE,
+	     MIN(size, (size_t)UINT32_MAX), site, now);
+}
+
+static void *prof_realloc(void *ptr, size_t size, uint16_t site)
+{
+	void *p = __real_realloc(ptr, size);
+
+	if (p) {
+		if (ptr)
+			record(HEAP_PROF_EV_REALLOC_FREE, ptr, 0, site);
+		record(ptr ? HEAP_PROF_EV_REALLOC_ALLOC : HEAP_PROF_EV_ALLOC,
+		       p, size, site);
+	}
+
+	return p;
+}
+
+void *__wrap_malloc(size_t size)
+{
+	void *p = __real_malloc(size);
+
+	if (p)
+		record(HEAP_PROF_EV_ALLOC, p, size,
+		       caller_site(__builtin_return_address(0)));
+	return p;
+}
+
+void *__wrap_calloc(size_t nmemb, size_t size)
+{
+	void *p = __real_calloc(nmemb, size);
+
+	if (p)
+		record(HEAP_PROF_EV_ALLOC, p, nmemb * size,
+		       caller_site(__builtin_return_address(0)));
+	return p;
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+	return prof_realloc(ptr, size,
+			    caller_site(__builtin_return_address(0)));
+}
+
+void *__wrap_memalign(size_t alignment, size_t size)
+{
+	void *p = __real_memalign(alignment, size);
+
+	if (p)
+		record(HEAP_PROF_EV_ALLOC, p, size,
+		       caller_site(__builtin_return_address(0)));
+	return p;
+}
+
+void __wrap_free(void *ptr)
+{
+	if (ptr)
+		record(HEAP_PROF_EV_FREE, ptr, 0,
+		       caller_site(__builtin_return_address(0)));
+	__real_free(ptr);
+}
+
+void *mdbg_malloc(const char *fname, int lineno, size_t size)
+{
+	void *p = __real_malloc(size);
+
+	if (p)
+		record(HEAP_PROF_EV_ALLOC, p, size, file_site(fname, lineno));
+	return p;
+}
+
+void *mdbg_calloc(const char *fname, int lineno, size_t nmemb, size_t size)
+{
+	void *p = __real_calloc(nmemb, size);
+
+	if (p)
+		record(HEAP_PROF_EV_ALLOC, p, nmemb * size,
+		       file_site(fname, lineno));
+	return p;
+}
+
+void *mdbg_realloc(const char *fname, int lineno, void *ptr, size_t size)
+{
+	return prof_realloc(ptr, size, file_site(fname, lineno));
+}
+
+void *mdbg_memalign(const char *fname, int lineno, size_t alignment,
+		    size_t size)
+{
+	void *p = __real_memalign(alignment, size);
+
+	if (p)
+		record(HEAP_PROF_EV_ALLOC, p, size, file_site(fname, lineno));
+	return p;
+}
+
+void *mdbg_aligned_alloc(const char *fname, int lineno, size_t alignment,
+			 size_t size)
+{
+	return mdbg_memalign(fname, lineno, alignment, size);
+}
+
+void (mdbg_check)(int bufdump)
+{
+	size_t i = 0;
+
+	IMSG("heap_prof: %"PRIu32" events pending, %"PRIu32" lost, %zu sites",
+	     ev_head - ev_tail, lost, nsites);
+	if (!bufdump)
+		return;
+
+	for (i = 0; i < HEAP_PROF_MAX_SITES; i++) {
+		if (sites[i].file)
+			IMSG("site %zu: %s:%"PRIu32, i + 1, sites[i].file,
+			     sites[i].line);
+		else if (sites[i].addr)
+			IMSG("site %zu: 0x%" PRIxPTR, i + 1, sites[i].addr);
+	}
+}
+
+/* @prev is the counter value of the event before @ev */
+static uint64_t event_time(const struct heap_prof_event *ev, uint64_t prev)
+{
+	if (ev->type == HEAP_PROF_EV_TIME || ev->type == HEAP_PROF_EV_LOST)
+		return (uint64_t)ev->size << 32 | ev->time;
+	return prev + (uint32_t)(ev->time - (uint32_t)prev);
+}
+
+static size_t site_name_len(struct site *s)
+{
+	return s->file ? MIN(strlen(s->file), (size_t)UINT16_MAX) : 0;
+}
+
+static size_t site_rec_size(struct site *s)
+{
+	return ROUNDUP(sizeof(struct heap_prof_site) + site_name_len(s), 8);
+}
+
+TEE_Result heap_prof_drain(void *buf, size_t *len)
+{
+	struct heap_prof_hdr hdr = { };
+	struct heap_prof_site rec = { };
+	struct heap_prof_event *ev = NULL;
+	uint8_t *p = buf;
+	size_t pending = ev_head - ev_tail;
+	size_t fixed = sizeof(hdr);
+	size_t n = 0;
+	size_t i = 0;
+
+	for (i = 0; i < HEAP_PROF_MAX_SITES; i++)
+		if (sites[i].file || sites[i].addr)
+			fixed += site_rec_size(sites + i);
+
+	if (*len < fixed) {
+		*len = fixed + pending * sizeof(*ev);
+		return TEE_ERROR_SHORT_BUFFER;
+	}
+	n = MIN(pending, (*len - fixed) / sizeof(*ev));
+
+	hdr.magic = HEAP_PROF_MAGIC;
+	hdr.version = HEAP_PROF_VERSION;
+	hdr.hdr_size = sizeof(hdr);
+	hdr.freq = read_cntfrq();
+	hdr.heap_size = ta_heap_size;
+	hdr.nsites = nsites;
+	hdr.nevents = n;
+	hdr.lost = lost;
+	hdr.time = tail_time;
+	memcpy(p, &hdr, sizeof(hdr));
+	p += sizeof(hdr);
+
+	for (i = 0; i < HEAP_PROF_MAX_SITES; i++) {
+		if (!sites[i].file && !sites[i].addr)
+			continue;
+		rec.id = i + 1;
+		rec.name_len = site_name_len(sites + i);
+		rec.line = sites[i].line;
+		rec.addr = sites[i].addr;
+		memset(p, 0, site_rec_size(sites + i));
+		memcpy(p, &rec, sizeof(rec));
+		if (rec.name_len)
+			memcpy(p + sizeof(rec), sites[i].file, rec.name_len);
+		p += site_rec_size(sites + i);
+	}
+
+	for (i = 0; i < n; i++) {
+		ev = events + ev_tail % CFG_TA_HEAP_PROF_EVENTS;
+		memcpy(p, ev, sizeof(*ev));
+		p += sizeof(*ev);
+		/* Carry the full counter value to the next event */
+		tail_time = event_time(ev, tail_time);
+		/* Drops from now on are counted by a new marker */
+		if (ev == lost_ev)
+			lost_ev = NULL;
+		ev_tail++;
+	}
+	if (ev_head != ev_tail) {
+		ev = events + ev_tail % CFG_TA_HEAP_PROF_EVENTS;
+		tail_time = event_time(ev, tail_time);
+	}
+
+	lost = 0;
+	*len = p - (uint8_t *)buf;
+
+	return TEE_SUCCESS;
+}
@@ -0,0 +1,244 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Copyright (c) 2026, D-Robotics
+ */
+
+#ifndef __BINLOG_H
+#define __BINLOG_H
+
+#ifndef __ASSEMBLER__
+#include <compiler.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <tee_api_types.h>
+#include <trace.h>
+
+/*
+ * Binary trace log of a TA
+ *
+ * The MSG(), EMSG(), IMSG(), DMSG(), FMSG() and DHEXDUMP() of trace.h
+ * format their message and hand it to _utee_log(), a syscall, each time.
+ * The sources of a TA that links with ta_ext and is built with
+ * CFG_TA_BINLOG=y, see ta_lib.mk, include this file first instead. In
+ * C sources the macros then only store the counter, a site and the
+ * values of the arguments in a buffer of the TA:
+ *
+ * - The site is the format string with its level, file and line, put in
+ *   .rodata.binlog at build time. A record refers to it by its offset in
+ *   the TA ELF, scripts/binlog_decode.py reads the format from there.
+ * - Integer and pointer arguments are stored as 64-bit values, char *
+ *   arguments as the string they point to, up to BINLOG_MAX_STR bytes,
+ *   so a char * printed with %p has to be cast to void *. Floating-point
+ *   arguments are rejected at build time, use trace_printf() for those.
+ *   A message with more than BINLOG_MAX_ARGS arguments still goes
+ *   through trace_printf(). Formats have to be string literals, they are
+ *   checked against the arguments as for printf().
+ * - DHEXDUMP() stores up to BINLOG_MAX_DATA bytes of the buffer.
+ *
+ * The buffer holds CFG_TA_BINLOG_SIZE bytes. It is flushed to the secure
+ * console, base64 encoded with as few _utee_log() as possible, when a
+ * record does not fit, when binlog_flush() is called and before
+ * TEE_Panic(), the TA is linked with --wrap=TEE_Panic. The TA can also
+ * return the records to the normal world with binlog_drain(), see
+ * TA_OS_TEST_CMD_BINLOG of os_test. Once it has, a record that does not
+ * fit is dropped and counted in @lost of the next batch instead of
+ * flushing the others to the console.
+ *
+ * Messages below the runtime trace_level are not recorded. The messages
+ * of libutee and of the other prebuilt libraries still go through
+ * _utee_log().
+ */
+
+#ifndef CFG_TA_BINLOG_SIZE
+#define CFG_TA_BINLOG_SIZE	16384
+#endif
+#define BINLOG_MAX_ARGS		8
+#define BINLOG_MAX_STR		64
+#define BINLOG_MAX_DATA		256
+
+#define BINLOG_MAGIC		0x474c4e42	/* "BNLG" */
+#define BINLOG_VERSION		1
+
+/* Prefix of the lines of the console, followed by the TA UUID */
+#define BINLOG_CONSOLE_TAG	"binlog"
+
+/*
+ * A flushed or drained batch is a struct binlog_hdr followed by @size
+ * bytes of records, in the byte order of the TA
+ */
+struct binlog_hdr {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t hdr_size;
+	uint32_t freq;		/* Counter frequency in Hz */
+	uint32_t size;
+	uint32_t lost;		/* Records dropped since the previous batch */
+	uint32_t reserved;
+};
+
+/*
+ * A record is a struct binlog_rec, @nargs 64-bit argument values, then
+ * the bytes of the string arguments one after the other, then padding
+ * to 8 bytes. The value of a string argument, bit n of @strs, is the
+ * number of its bytes stored, without a NUL.
+ */
+struct binlog_rec {
+	uint64_t time;		/* Counter value */
+	uint32_t site;		/* Offset in the TA ELF */
+	uint16_t size;		/* Of the whole record */
+	uint8_t nargs;
+	uint8_t strs;
+};
+
+/*
+ * A site is "<kind><level>\0<file>\0<line>\0<format>\0", <kind> being 'm'
+ * for a message, 'r' for one without file and line prefix (the *_RAW
+ * macros) and 'x' for a hex dump, which has a single string argument
+ */
+#define __BINLOG_STR(x)		__BINLOG_STR_(x)
+#define __BINLOG_STR_(x)	#x
+#define __BINLOG_SITE(kind, level, fmt) \
+	kind __BINLOG_STR(level) "\0" __FILE__ "\0" __BINLOG_STR(__LINE__) \
+	"\0" fmt
+
+void binlog_write(const char *site, int level, unsigned int nargs,
+		  unsigned int strs, const uint64_t *args);
+void binlog_hexdump(const char *site, int level, const void *buf, int len);
+
+/*
+ * binlog_flush() - Write the records to the secure console
+ *
+ * Returns TEE_SUCCESS, there is no way to tell if the console got them.
+ */
+TEE_Result binlog_flush(void);
+
+/*
+ * binlog_drain() - Move the records to a buffer
+ * @buf:	Buffer to write a struct binlog_hdr and the records to
+ * @len:	[in] size of @buf, [out] size written
+ *
+ * As many records as fit are moved, the others remain. Returns
+ * TEE_SUCCESS, or TEE_ERROR_SHORT_BUFFER with @len set to the size
+ * needed for the first record if not even that fits.
+ */
+TEE_Result binlog_drain(void *buf, size_t *len);
+
+#define __BINLOG_IS_STR(x) \
+	_Generic((x), char *: 1, const char *: 1, default: 0)
+#define __BINLOG_IS_FP(x) \
+	_Generic((x), float: 1, double: 1, long double: 1, default: 0)
+#define __BINLOG_ARG(x)		((uint64_t)(uintptr_t)(x))
+
+#define __BINLOG_ARGS_0()
+#define __BINLOG_ARGS_1(x) __BINLOG_ARG(x)
+#define __BINLOG_ARGS_2(x, ...) __BINLOG_ARG(x), __BINLOG_ARGS_1(__VA_ARGS__)
+#define __BINLOG_ARGS_3(x, ...) __BINLOG_ARG(x), __BINLOG_ARGS_2(__VA_ARGS__)
+#define __BINLOG_ARGS_4(x, ...) __BINLOG_ARG(x), __BINLOG_ARGS_3(__VA_ARGS__)
+#define __BINLOG_ARGS_5(x, ...) __BINLOG_ARG(x), __BINLOG_ARGS_4(__VA_ARGS__)
+#define __BINLOG_ARGS_6(x, ...) __BINLOG_ARG(x), __BINLOG_ARGS_5(__VA_ARGS__)
+#define __BINLOG_ARGS_7(x, ...) __BINLOG_ARG(x), __BINLOG_ARGS_6(__VA_ARGS__)
+#define __BINLOG_ARGS_8(x, ...) __BINLOG_ARG(x), __BINLOG_ARGS_7(__VA_ARGS__)
+
+/* Bit n set if @is(argument n) */
+#define __BINLOG_MASK_1(is, x) is(x)
+#define __BINLOG_MASK_2(is, x, ...) \
+	(is(x) | __BINLOG_MASK_1(is, __VA_ARGS__) << 1)
+#define __BINLOG_MASK_3(is, x, ...) \
+	(is(x) | __BINLOG_MASK_2(is, __VA_ARGS__) << 1)
+#define __BINLOG_MASK_4(is, x, ...) \
+	(is(x) | __BINLOG_MASK_3(is, __VA_ARGS__) << 1)
+#define __BINLOG_MASK_5(is, x, ...) \
+	(is(x) | __BINLOG_MASK_4(is, __VA_ARGS__) << 1)
+#define __BINLOG_MASK_6(is, x, ...) \
+	(is(x) | __BINLOG_MASK_5(is, __VA_ARGS__) << 1)
+#define __BINLOG_MASK_7(is, x, ...) \
+	(is(x) | __BINLOG_MASK_6(is, __VA_ARGS__) << 1)
+#define __BINLOG_MASK_8(is, x, ...) \
+	(is(x) | __BINLOG_MASK_7(is, __VA_ARGS__) << 1)
+
+/* Never called, only there for -Wformat to see the arguments */
+static inline void __printf(1, 2) __binlog_fmt_check(const char *fmt __unused,
+						      ...)
+{
+}
+
+#define __BINLOG_NARGS(...) \
+	__BINLOG_NARGS_(_, ##__VA_ARGS__, X, X, X, X, X, X, X, X, \
+			8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define __BINLOG_NARGS_(_, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, \
+			a12, a13, a14, a15, a16, n, ...) n
+
+#define __BINLOG_CAT(a, b)	__BINLOG_CAT_(a, b)
+#define __BINLOG_CAT_(a, b)	a##b
+
+#define __BINLOG_MSG(kind, func, line, level, fmt, ...) \
+	__BINLOG_CAT(__BINLOG_MSG_, __BINLOG_NARGS(__VA_ARGS__)) \
+		(kind, func, line, level, fmt, ##__VA_ARGS__)
+
+#define __BINLOG_MSG_0(kind, func, line, level, fmt) ({ \
+	static const char __binlog_site[] __section(".rodata.binlog") = \
+		__BINLOG_SITE(kind, level, fmt); \
+	if (0) \
+		__binlog_fmt_check(fmt); \
+	binlog_write(__binlog_site, (level), 0, 0, NULL); \
+})
+
+#define __BINLOG_MSG_N(n, kind, level, fmt, ...) ({ \
+	static const char __binlog_site[] __section(".rodata.binlog") = \
+		__BINLOG_SITE(kind, level, fmt); \
+	_Static_assert(!__BINLOG_MASK_##n(__BINLOG_IS_FP, __VA_ARGS__), \
+		       "floating-point arguments are not recorded, " \
+		       "use trace_printf()"); \
+	const uint64_t __binlog_args[] = { \
+		__BINLOG_ARGS_##n(__VA_ARGS__) \
+	}; \
+	if (0) \
+		__binlog_fmt_check(fmt, __VA_ARGS__); \
+	binlog_write(__binlog_site, (level), n, \
+		     __BINLOG_MASK_##n(__BINLOG_IS_STR, __VA_ARGS__), \
+		     __binlog_args); \
+})
+
+#define __BINLOG_MSG_1(kind, func, line, level, fmt, ...) \
+	__BINLOG_MSG_N(1, kind, level, fmt, __VA_ARGS__)
+#define __BINLOG_MSG_2(kind, func, line, level, fmt, ...) \
+	__BINLOG_MSG_N(2, kind, level, fmt, __VA_ARGS__)
+#define __BINLOG_MSG_3(kind, func, line, level, fmt, ...) \
+	__BINLOG_MSG_N(3, kind, level, fmt, __VA_ARGS__)
+#define __BINLOG_MSG_4(kind, func, line, level, fmt, ...) \
+	__BINLOG_MSG_N(4, kind, level, fmt, __VA_ARGS__)
+#define __BINLOG_MSG_5(kind, func, line, level, fmt, ...) \
+	__BINLOG_MSG_N(5, kind, level, fmt, __VA_ARGS__)
+#define __BINLOG_MSG_6(kind, func, line, level, fmt, ...) \
+	__BINLOG_MSG_N(6, kind, level, fmt, __VA_ARGS__)
+#define __BINLOG_MSG_7(kind, func, line, level, fmt, ...) \
+	__BINLOG_MSG_N(7, kind, level, fmt, __VA_ARGS__)
+#define __BINLOG_MSG_8(kind, func, line, level, fmt, ...) \
+	__BINLOG_MSG_N(8, kind, level, fmt, __VA_ARGS__)
+/* Too many arguments to record */
+#define __BINLOG_MSG_X(kind, func, line, level, fmt, ...) \
+	trace_printf(func, line, (level), true, fmt, __VA_ARGS__)
+
+/* C++ sources keep trace_printf(), _Generic is C only */
+#if defined(CFG_TA_BINLOG) && !defined(__cplusplus)
+/* The macros of trace.h expand to these where they are used */
+#undef trace_printf_helper
+#define trace_printf_helper(level, level_ok, ...) \
+	__BINLOG_MSG("m", __func__, __LINE__, level, __VA_ARGS__)
+
+#undef trace_printf_helper_raw
+#define trace_printf_helper_raw(level, level_ok, ...) \
+	__BINLOG_MSG("r", NULL, 0, level, __VA_ARGS__)
+
+#if (TRACE_LEVEL >= TRACE_DEBUG)
+#undef DHEXDUMP
+#define DHEXDUMP(buf, len) ({ \
+	static const char __binlog_site[] __section(".rodata.binlog") = \
+		__BINLOG_SITE("x", TRACE_DEBUG, ""); \
+	binlog_hexdump(__binlog_site, TRACE_DEBUG, (buf), (len)); \
+})
+#endif
+#endif /*CFG_TA_BINLOG*/
+#endif /*__ASSEMBLER__*/
+
+#endif /*__BINLOG_H*/
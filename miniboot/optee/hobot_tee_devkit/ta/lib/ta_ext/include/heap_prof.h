@@ -0,0 +1,113 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Copyright (c) 2026, D-Robotics
+ */
+
+#ifndef __HEAP_PROF_H
+#define __HEAP_PROF_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <tee_api_types.h>
+
+/*
+ * Heap profiler of a TA
+ *
+ * TAs that link with ta_ext and are built with CFG_TA_HEAP_PROF=y, see
+ * ta_lib.mk, have every malloc(), calloc(), realloc(), memalign() and
+ * free() recorded in a ring of events, including the calls made from
+ * libutee and libmbedtls. The site of an event is the address it was
+ * called from or, for the sources of the TA built with ENABLE_MDBG, the
+ * file and line the mdbg_*() hooks of malloc.h pass.
+ *
+ * heap_prof_drain() moves the recorded events to a buffer the TA returns
+ * to the normal world, see TA_OS_TEST_CMD_HEAP_PROF of os_test.
+ * scripts/heap_prof.py reads the drained buffers of a run, in order, and
+ * reconstructs the heap usage over time, the peak usage per site and the
+ * fragmentation of ta_heap at the peak.
+ *
+ * Events that do not fit in the ring are dropped and counted, the last
+ * slot of the ring is kept for a HEAP_PROF_EV_LOST marker where they would
+ * have been. The ring is meant to be drained often enough for that not to
+ * happen: a dropped free leaves its block live in the replay, which can
+ * overstate the peak after the marker.
+ */
+
+#ifndef CFG_TA_HEAP_PROF_EVENTS
+#define CFG_TA_HEAP_PROF_EVENTS		4096
+#endif
+#define HEAP_PROF_MAX_SITES		512
+
+#define HEAP_PROF_MAGIC			0x46525048	/* "HPRF" */
+#define HEAP_PROF_VERSION		2
+
+#define HEAP_PROF_EV_ALLOC		1
+#define HEAP_PROF_EV_FREE		2
+/* The two events of a successful realloc(), the free comes first */
+#define HEAP_PROF_EV_REALLOC_FREE	3
+#define HEAP_PROF_EV_REALLOC_ALLOC	4
+/*
+ * Events carrying the full counter value, the high 32 bits in @size. A
+ * HEAP_PROF_EV_TIME precedes an event recorded 2^32 ticks or more after
+ * the previous one. A HEAP_PROF_EV_LOST stands for the events dropped from
+ * its time on, @offset of them.
+ */
+#define HEAP_PROF_EV_TIME		5
+#define HEAP_PROF_EV_LOST		6
+
+/* @offset of a block outside of ta_heap */
+#define HEAP_PROF_OFFSET_NONE		UINT32_MAX
+
+/*
+ * A drained buffer is a struct heap_prof_hdr, @nsites site records and
+ * @nevents struct heap_prof_event, all in the byte order of the TA.
+ */
+struct heap_prof_hdr {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t hdr_size;
+	uint32_t freq;		/* Counter frequency in Hz */
+	uint32_t heap_size;	/* Size of ta_heap */
+	uint32_t nsites;
+	uint32_t nevents;
+	uint32_t lost;		/* Events dropped since the previous drain */
+	uint32_t reserved;
+	uint64_t time;		/* Counter value of the first event */
+};
+
+/*
+ * A site record is a struct heap_prof_site followed by @name_len bytes of
+ * file name, not NUL terminated, then padding to 8 bytes. A site without a
+ * file name is a return address, @addr is then relative to the start of
+ * the TA ELF so that addr2line can resolve it. All sites are in every
+ * drained buffer.
+ */
+struct heap_prof_site {
+	uint16_t id;
+	uint16_t name_len;
+	uint32_t line;
+	uint64_t addr;
+};
+
+struct heap_prof_event {
+	uint32_t time;		/* Low 32 bits of the counter */
+	uint32_t offset;	/* Of the block in ta_heap */
+	uint32_t size;		/* Size requested, 0 for a free */
+	uint16_t site;
+	uint8_t type;		/* HEAP_PROF_EV_* */
+	uint8_t reserved;
+};
+
+/*
+ * heap_prof_drain() - Move the recorded events to a buffer
+ * @buf:	Buffer to write to
+ * @len:	[in] size of @buf, [out] size written or needed
+ *
+ * As many events as fit in @buf are moved, the others remain in the ring.
+ * Returns TEE_SUCCESS, or TEE_ERROR_SHORT_BUFFER if @buf cannot hold the
+ * header and the sites, @len then tells the size needed to move all the
+ * events.
+ */
+TEE_Result heap_prof_drain(void *buf, size_t *len);
+
+#endif /*__HEAP_PROF_H*/
@@ -0,0 +1,152 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Copyright (c) 2026, D-Robotics
+ */
+
+#ifndef __MEMPOOL_ARENA_H
+#define __MEMPOOL_ARENA_H
+
+#include <mempool.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Arena on a memory pool, for the allocations that all die together at the
+ * end of a command
+ *
+ * An arena takes chunks of at least @chunk_size bytes from a struct
+ * mempool and hands out memory from them by moving a pointer forward.
+ * Nothing is freed item by item: a mark taken with mempool_arena_mark()
+ * gives back everything allocated since then, mempool_arena_reset()
+ * everything allocated so far. Both keep the chunks for the next
+ * allocations and take constant time. mempool_arena_release() gives the
+ * chunks back to the pool.
+ *
+ * Typical use in a TA, with the arena set up in TA_OpenSessionEntryPoint():
+ *
+ * TEE_Result TA_InvokeCommandEntryPoint(void *sess, uint32_t cmd, ...)
+ * {
+ *	struct session *s = sess;
+ *	TEE_Result res = TEE_SUCCESS;
+ *
+ *	mempool_arena_set_current(&s->arena);
+ *	res = handle(s, cmd, ...);
+ *	mempool_arena_set_current(NULL);
+ *	mempool_arena_reset(&s->arena);
+ *
+ *	return res;
+ * }
+ *
+ * An arena is not thread safe, TAs are single threaded.
+ */
+
+/* Alignment of mempool_arena_calloc() and the mbedtls adapter, as malloc() */
+#define MEMPOOL_ARENA_ALIGN	16
+
+struct mempool_arena_chunk;
+
+struct mempool_arena {
+	struct mempool *pool;
+	size_t chunk_size;
+	struct mempool_arena_chunk *first;	/* Chunks in allocation order */
+	struct mempool_arena_chunk *cur;	/* Chunk allocated from */
+	uint8_t *ptr;				/* Next free byte of @cur */
+	uint8_t *end;				/* End of @cur */
+	uint8_t *last;				/* Last allocation, or NULL */
+	size_t nchunks;
+	size_t fallbacks;	/* mbedtls adapter allocations from calloc() */
+};
+
+struct mempool_arena_mark {
+	struct mempool_arena_chunk *chunk;
+	uint8_t *ptr;
+};
+
+/*
+ * mempool_arena_init() - Set up an arena
+ * @arena:	Arena to set up
+ * @pool:	Memory pool the chunks are taken from
+ * @chunk_size:	Minimum size of a chunk, larger allocations take a chunk of
+ *		their own
+ *
+ * No memory is taken from @pool before the first allocation.
+ */
+void mempool_arena_init(struct mempool_arena *arena, struct mempool *pool,
+			size_t chunk_size);
+
+/*
+ * mempool_arena_release() - Give all the chunks back to the pool
+ *
+ * The arena remains set up, the next allocation takes a new chunk.
+ */
+void mempool_arena_release(struct mempool_arena *arena);
+
+/*
+ * mempool_arena_alloc() - Allocate from an arena
+ * @arena:	Arena set up with mempool_arena_init()
+ * @size:	Size in bytes
+ * @align:	Alignment, a power of two
+ *
+ * Returns a pointer on success or NULL if no chunk could be taken from the
+ * pool.
+ */
+void *mempool_arena_alloc(struct mempool_arena *arena, size_t size,
+			  size_t align);
+
+/*
+ * mempool_arena_calloc() - Allocate a zero initialized array from an arena,
+ * aligned to MEMPOOL_ARENA_ALIGN
+ */
+void *mempool_arena_calloc(struct mempool_arena *arena, size_t nmemb,
+			   size_t size);
+
+/* Returns true if @ptr points into a chunk of @arena */
+bool mempool_arena_owns(struct mempool_arena *arena, const void *ptr);
+
+/*
+ * mempool_arena_mark() - Take a mark to roll back to
+ *
+ * A mark is valid until the arena is reset, released or rolled back to an
+ * earlier mark.
+ */
+struct mempool_arena_mark mempool_arena_mark(struct mempool_arena *arena);
+
+/*
+ * mempool_arena_rollback() - Free everything allocated since @mark was
+ * taken
+ */
+void mempool_arena_rollback(struct mempool_arena *arena,
+			    struct mempool_arena_mark mark);
+
+/* mempool_arena_reset() - Free everything allocated from the arena */
+void mempool_arena_reset(struct mempool_arena *arena);
+
+/*
+ * The arena the mbedtls adapter allocates from, NULL for none. Objects
+ * allocated from an arena through the adapter must be freed before the
+ * current arena changes.
+ */
+void mempool_arena_set_current(struct mempool_arena *arena);
+struct mempool_arena *mempool_arena_get_current(void);
+
+/*
+ * The mbedtls adapter
+ *
+ * mempool_arena_mbedtls_calloc() allocates from the current arena, and
+ * from calloc() if there is none or if the arena has no room left.
+ * mempool_arena_mbedtls_free() only gives the memory back if it is the
+ * last allocation of the current arena, the rest goes with the next
+ * reset, and passes memory of calloc() to free().
+ *
+ * The libmbedtls of the dev kit is built without MBEDTLS_PLATFORM_MEMORY,
+ * its mbedtls_calloc() and mbedtls_free() are calloc() and free() and
+ * cannot be redirected at run time. TAs that link with ta_ext and are
+ * built with CFG_TA_MEMPOOL_ARENA_MBEDTLS=y, see ta_lib.mk, are instead
+ * linked with a copy of libmbedtls where those calls are renamed to the
+ * adapter. The rest of the TA still calls calloc() and free().
+ */
+void *mempool_arena_mbedtls_calloc(size_t nmemb, size_t size);
+void mempool_arena_mbedtls_free(void *ptr);
+
+#endif /*__MEMPOOL_ARENA_H*/
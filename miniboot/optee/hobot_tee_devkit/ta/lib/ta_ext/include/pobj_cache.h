@@ -0,0 +1,143 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Copyright (c) 2026, D-Robotics
+ */
+
+#ifndef __POBJ_CACHE_H
+#define __POBJ_CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <tee_api_types.h>
+
+/*
+ * Write-back block cache in front of the data stream of a persistent object
+ *
+ * Each TEE_WriteObjectData() on an object of the REE FS rewrites the
+ * blocks it touches, then the hash tree nodes above them and the head of
+ * the file, each with an RPC of its own (tee_fs_htree_sync_to_storage()),
+ * however few bytes were written. A TA that updates records of a few
+ * bytes at random places pays all of that for each of them.
+ *
+ * pobj_cache keeps blocks of the object in memory and tracks which bytes
+ * of each are dirty. pobj_cache_sync() sorts the dirty blocks and writes
+ * each run of contiguous dirty bytes with a single TEE_WriteObjectData(),
+ * so that the hash tree is synced once per run instead of once per write.
+ *
+ * Each TEE_ReadObjectData() is a syscall that reads and decrypts the
+ * blocks it covers. A read that misses the block right after the ones
+ * last loaded doubles the read-ahead window, up to @io_blocks blocks
+ * fetched with one call, any other miss brings it back to one block.
+ * Reads of whole blocks, two or more, go straight into the buffer of the
+ * caller with one call, the dirty bytes cached are copied over them.
+ *
+ * While a cache is attached, the object is only to be read, written and
+ * truncated through it. Its data position is not the one of the cache.
+ * Nothing is written before pobj_cache_sync(), a dirty block being
+ * evicted, or pobj_cache_fini().
+ */
+
+#define POBJ_CACHE_BLOCK_SIZE	4096	/* That of the REE FS */
+
+struct pobj_cache_slot {
+	uint32_t block;		/* POBJ_CACHE_NO_BLOCK when unused */
+	uint32_t lo;		/* Dirty bytes [lo, hi), lo == hi if clean */
+	uint32_t hi;
+	uint32_t stamp;		/* Of the last use, for LRU eviction */
+	bool valid;		/* All bytes are loaded, not only the dirty */
+};
+
+#define POBJ_CACHE_NO_BLOCK	UINT32_MAX
+
+struct pobj_cache_stats {
+	uint32_t reads;		/* TEE_ReadObjectData() calls */
+	uint32_t writes;	/* TEE_WriteObjectData() calls */
+	uint32_t hits;		/* Blocks served from the cache */
+	uint32_t misses;
+	uint32_t prefetched;	/* Blocks read ahead of a miss */
+	uint32_t bypassed;	/* Blocks read past the cache */
+};
+
+struct pobj_cache {
+	TEE_ObjectHandle obj;
+	uint32_t block_size;
+	uint32_t nblocks;
+	uint32_t io_blocks;
+	uint8_t *mem;		/* @nblocks blocks */
+	uint8_t *io;		/* @io_blocks blocks to coalesce I/O in */
+	struct pobj_cache_slot *slots;
+	struct pobj_cache_slot **order;
+	uint32_t size;		/* Size of the object, writes included */
+	uint32_t stored;	/* Size of the object in storage */
+	uint32_t pos;
+	uint32_t clock;
+	uint32_t ra_next;	/* Block after the last ones read */
+	uint32_t ra_blocks;	/* Read-ahead window, in blocks */
+	struct pobj_cache_stats stats;
+};
+
+/*
+ * pobj_cache_init() - Attach a cache to a persistent object
+ * @cache:	Cache to initialize
+ * @obj:	Object opened with TEE_DATA_FLAG_ACCESS_READ, and
+ *		TEE_DATA_FLAG_ACCESS_WRITE to write through the cache
+ * @block_size:	Size of the blocks, a power of 2, 0 for
+ *		POBJ_CACHE_BLOCK_SIZE
+ * @nblocks:	Number of blocks cached
+ * @io_blocks:	Maximum number of blocks read or written at once
+ *
+ * The data position of the cache starts at 0.
+ */
+TEE_Result pobj_cache_init(struct pobj_cache *cache, TEE_ObjectHandle obj,
+			   uint32_t block_size, uint32_t nblocks,
+			   uint32_t io_blocks);
+
+/*
+ * pobj_cache_fini() - Write the dirty blocks and free the cache
+ *
+ * The cache is freed even if the writes fail.
+ */
+TEE_Result pobj_cache_fini(struct pobj_cache *cache);
+
+/* Like TEE_SeekObjectData() */
+TEE_Result pobj_cache_seek(struct pobj_cache *cache, int32_t offset,
+			   TEE_Whence whence);
+
+/* Like TEE_ReadObjectData() */
+TEE_Result pobj_cache_read(struct pobj_cache *cache, void *buf,
+			   uint32_t size, uint32_t *count);
+
+/* Like TEE_WriteObjectData(), extending the object with zeroes if needed */
+TEE_Result pobj_cache_write(struct pobj_cache *cache, const void *buf,
+			    uint32_t size);
+
+/* Like TEE_TruncateObjectData(), after writing the dirty blocks */
+TEE_Result pobj_cache_truncate(struct pobj_cache *cache, uint32_t size);
+
+/* pobj_cache_sync() - Write the dirty blocks, coalesced into runs */
+TEE_Result pobj_cache_sync(struct pobj_cache *cache);
+
+/*
+ * pobj_map_read() - Read a range of a persistent object into new memory
+ * @obj:	Object opened with TEE_DATA_FLAG_ACCESS_READ, without a cache
+ *		attached or after pobj_cache_sync()
+ * @offset:	Offset of the range in the object
+ * @size:	Size of the range
+ * @buf:	Updated with memory mapped with tee_map_zi(), to release
+ *		with pobj_unmap() whatever @count
+ * @count:	Updated with the number of bytes read, less than @size at the
+ *		end of the object
+ *
+ * The range is read with a single TEE_ReadObjectData(), which decrypts it
+ * straight into the mapping, for models and certificate bundles that
+ * would not fit in the heap of the TA or that are too large to copy once
+ * more. The data position of @obj is left after the bytes read.
+ */
+TEE_Result pobj_map_read(TEE_ObjectHandle obj, uint32_t offset, uint32_t size,
+			 void **buf, uint32_t *count);
+
+/* pobj_unmap() - Release memory from pobj_map_read() of @size bytes */
+void pobj_unmap(void *buf, uint32_t size);
+
+#endif /*__POBJ_CACHE_H*/
@@ -0,0 +1,119 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Copyright (c) 2026, D-Robotics
+ */
+
+#ifndef __SHM_RING_H
+#define __SHM_RING_H
+
+#include <shm_ring_abi.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <tee_api_types.h>
+
+/*
+ * Zero-copy ring between a client application and a TA
+ *
+ * The client allocates or registers shared memory once, lays out a
+ * struct shm_ring_hdr in it, see shm_ring_abi.h, and passes the whole of
+ * it as a memref of each doorbell command. The TA attaches to the memref
+ * with shm_ring_attach() for the duration of that command, since memrefs
+ * are only mapped during an invoke, and reads the records in place until
+ * the ring is empty:
+ *
+ *	res = shm_ring_attach(&ring, buf, size);
+ *	if (res)
+ *		return res;
+ *	do {
+ *		while (!(res = shm_ring_peek(&ring, &data, &len, &tag))) {
+ *			process(data, len, tag);
+ *			shm_ring_consume(&ring);
+ *		}
+ *	} while (res == TEE_ERROR_NO_DATA && !shm_ring_idle(&ring));
+ *
+ * The producer keeps adding records while the command runs, and only
+ * invokes the next doorbell after shm_ring_idle() has let the consumer
+ * go idle. The records are in memory the client can write at any time:
+ * a consumer that has to trust their contents copies them first.
+ *
+ * A TA can also be the producer of a ring the client consumes, with
+ * shm_ring_reserve(), shm_ring_produce() and shm_ring_commit(). Since the
+ * TA cannot signal the client, the client is then woken by the return of
+ * the command the TA produces from.
+ *
+ * With SHM_RING_F_NONCOHERENT the data of the records is cleaned and
+ * invalidated with TEE_CacheClean() and TEE_CacheInvalidate(), for data
+ * written by devices such as DMA engines that do not snoop the caches.
+ * Each is a system call, records written through the CPU do not need
+ * them. The indices are always accessed through coherent mappings.
+ */
+
+struct shm_ring {
+	struct shm_ring_hdr *hdr;
+	uint8_t *data;
+	uint32_t size;
+	uint32_t flags;
+	uint32_t head;		/* Producer: next record, consumer: last seen */
+	uint32_t tail;		/* Consumer: next record, producer: last seen */
+	uint32_t next;		/* End of the record peeked or reserved */
+};
+
+/*
+ * shm_ring_attach() - Attach to a ring in shared memory
+ * @ring:	Ring to initialize
+ * @buf:	Memref holding the ring
+ * @len:	Size of @buf
+ *
+ * Returns TEE_ERROR_BAD_PARAMETERS if @buf does not hold a valid ring.
+ */
+TEE_Result shm_ring_attach(struct shm_ring *ring, void *buf, size_t len);
+
+/*
+ * shm_ring_peek() - Get the next record
+ * @ring:	Ring
+ * @data:	[out] Data of the record, in the ring
+ * @len:	[out] Length of @data
+ * @tag:	[out] Tag of the record, may be NULL
+ *
+ * Returns TEE_ERROR_NO_DATA if the ring is empty, or
+ * TEE_ERROR_CORRUPT_OBJECT if the next record does not fit in the part of
+ * the ring the producer has published.
+ */
+TEE_Result shm_ring_peek(struct shm_ring *ring, const void **data,
+			 size_t *len, uint32_t *tag);
+
+/* shm_ring_consume() - Give the record peeked last back to the producer */
+void shm_ring_consume(struct shm_ring *ring);
+
+/*
+ * shm_ring_idle() - Mark the consumer idle
+ * @ring:	Ring, which the consumer found empty
+ *
+ * Returns false if the producer added records in the meantime and the
+ * consumer has to go on, true if it may return from the doorbell.
+ */
+bool shm_ring_idle(struct shm_ring *ring);
+
+/*
+ * shm_ring_reserve() - Reserve room for a record
+ * @ring:	Ring
+ * @len:	Length of the data of the record
+ * @tag:	Tag of the record
+ *
+ * Returns where to write the data, or NULL if the ring is full.
+ */
+void *shm_ring_reserve(struct shm_ring *ring, size_t len, uint32_t tag);
+
+/* shm_ring_produce() - Add the record reserved last, not yet visible */
+void shm_ring_produce(struct shm_ring *ring);
+
+/*
+ * shm_ring_commit() - Make the records produced visible to the consumer
+ * @ring:	Ring
+ *
+ * Returns true if the consumer was idle and has to be woken up.
+ */
+bool shm_ring_commit(struct shm_ring *ring);
+
+#endif /*__SHM_RING_H*/
@@ -0,0 +1,66 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Copyright (c) 2026, D-Robotics
+ */
+
+#ifndef __SHM_RING_ABI_H
+#define __SHM_RING_ABI_H
+
+#include <stdint.h>
+
+/*
+ * Layout of a single-producer/single-consumer ring in shared memory, the
+ * same for the TA, see shm_ring.h, and for the client application that
+ * registered the memory
+ *
+ * The memory starts with a struct shm_ring_hdr, the data area follows at
+ * @data_offs. Each record in the data area is a struct shm_ring_rec then
+ * @len bytes, padded to SHM_RING_ALIGN bytes. A record is never split at
+ * the end of the data area: a record of length SHM_RING_REC_WRAP fills
+ * the space left there instead and the next record starts at offset 0.
+ *
+ * @head and @tail are free running byte counts, their difference is the
+ * number of bytes used, and each is only written by one side: @head by
+ * the producer once the records before it are written, @tail by the
+ * consumer once the records before it are read.
+ *
+ * The consumer runs when the producer rings a doorbell, e.g. invokes a
+ * command of the TA, and sets @consumer to SHM_RING_CONSUMER_IDLE when it
+ * has emptied the ring. The producer rings only when it finds the
+ * consumer idle after publishing new records, and moves it back to
+ * SHM_RING_CONSUMER_RUNNING with a compare-and-swap, so that exactly one
+ * doorbell follows each transition from empty to non-empty.
+ */
+
+#define SHM_RING_MAGIC			0x474e4952	/* "RING" */
+#define SHM_RING_ALIGN			8
+#define SHM_RING_LINE			64
+
+/* The data of the records is written by non-coherent devices */
+#define SHM_RING_F_NONCOHERENT		0x1
+
+#define SHM_RING_CONSUMER_RUNNING	0
+#define SHM_RING_CONSUMER_IDLE		1
+
+#define SHM_RING_REC_WRAP		UINT32_MAX
+
+/* The fields of each side in cache lines of their own */
+struct shm_ring_hdr {
+	uint32_t magic;
+	uint32_t flags;		/* SHM_RING_F_* */
+	uint32_t data_offs;	/* From the start of the header */
+	uint32_t size;		/* Of the data area, a power of 2 */
+	uint8_t pad0[SHM_RING_LINE - 16];
+	uint32_t head;
+	uint8_t pad1[SHM_RING_LINE - 4];
+	uint32_t tail;
+	uint32_t consumer;	/* SHM_RING_CONSUMER_* */
+	uint8_t pad2[SHM_RING_LINE - 8];
+};
+
+struct shm_ring_rec {
+	uint32_t len;		/* Of the data, or SHM_RING_REC_WRAP */
+	uint32_t tag;		/* Free for the users of the ring */
+};
+
+#endif /*__SHM_RING_ABI_H*/
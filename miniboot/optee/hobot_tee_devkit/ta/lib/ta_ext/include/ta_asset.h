@@ -0,0 +1,69 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Copyright (c) 2026, D-Robotics
+ */
+
+#ifndef __TA_ASSET_H
+#define __TA_ASSET_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Read-only data embedded in a TA with
+ * scripts/file_to_c.py --format incbin [--compress lz4]
+ *
+ * The generated assembly file defines one struct ta_asset named after
+ * --name, the payload itself is pulled in with .incbin so it never goes
+ * through the C compiler. A compressed payload is only decompressed on the
+ * first call to ta_asset_get(), into memory mapped with tee_map_zi().
+ *
+ * Typical sub.mk usage:
+ *
+ * gensrcs-y += model
+ * produce-model = model_asset.S
+ * depends-model = $(sub-dir)/model.bin
+ * recipe-model = $(PYTHON3) $(TA_DEV_KIT_DIR)/../scripts/file_to_c.py \
+ *		  --format incbin --compress lz4 --name model \
+ *		  --inf $(sub-dir)/model.bin --out $(sub-dir-out)/model_asset.S
+ *
+ * and in the TA:
+ *
+ * extern struct ta_asset model;
+ * const void *p = ta_asset_get(&model, &size);
+ */
+
+#define TA_ASSET_COMPRESS_NONE	0
+#define TA_ASSET_COMPRESS_LZ4	1
+
+/* Layout shared with the assembly emitted by file_to_c.py */
+struct ta_asset {
+	const uint8_t *data;	/* Payload as embedded in the TA image */
+	size_t size;		/* Size of the embedded payload */
+	size_t orig_size;	/* Size once decompressed */
+	uint32_t compress;	/* TA_ASSET_COMPRESS_* */
+	uint32_t reserved;
+	uint8_t *buf;		/* Decompressed data, NULL until first use */
+};
+
+/*
+ * ta_asset_get() - Get a pointer to the content of an asset
+ * @asset:	Asset defined by a file_to_c.py generated file
+ * @size:	If not NULL, updated with the size of the content
+ *
+ * Returns a pointer to the content or NULL if it could not be
+ * decompressed, either because memory could not be mapped or because the
+ * payload is corrupt.
+ */
+const void *ta_asset_get(struct ta_asset *asset, size_t *size);
+
+/*
+ * ta_asset_release() - Unmap the decompressed copy of an asset
+ * @asset:	Asset previously passed to ta_asset_get()
+ *
+ * Pointers returned by ta_asset_get() for a compressed asset must not be
+ * used after this call. Does nothing for uncompressed assets.
+ */
+void ta_asset_release(struct ta_asset *asset);
+
+#endif /*__TA_ASSET_H*/
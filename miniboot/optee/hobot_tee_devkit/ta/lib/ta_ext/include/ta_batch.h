@@ -0,0 +1,126 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Copyright (c) 2026, D-Robotics
+ */
+
+#ifndef __TA_BATCH_H
+#define __TA_BATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <tee_internal_api.h>
+#include <util.h>
+
+/*
+ * Vectored TA-to-TA invoke
+ *
+ * Each TEE_InvokeTACommand() is a system call that marshals the
+ * parameters and maps the memrefs of the caller into the called TA.
+ * ta_batch_invoke() instead packs an array of commands, with their
+ * parameters and the contents of their memrefs, into one buffer and
+ * submits it as a single TA_BATCH_CMD_INVOKE. The called TA runs the
+ * commands in order with ta_batch_dispatch(), which records the result of
+ * each, and the caller gets the values and the memref contents back the
+ * same way it would from separate invokes.
+ *
+ * The called TA opts in by forwarding TA_BATCH_CMD_INVOKE from its
+ * TA_InvokeCommandEntryPoint():
+ *
+ *	case TA_BATCH_CMD_INVOKE:
+ *		return ta_batch_dispatch(sess_ctx, param_types, params,
+ *					 TA_InvokeCommandEntryPoint);
+ *
+ * The memrefs of a batch are copies. A command does not see the writes
+ * of the caller made after ta_batch_invoke(), and two memrefs only alias
+ * when they are the same memref of the same entry.
+ */
+
+/* Command ID reserved in the TAs that dispatch batches, "BATC" */
+#define TA_BATCH_CMD_INVOKE		0x42415443
+
+#define TA_BATCH_MAGIC			0x48435442	/* "BTCH" */
+#define TA_BATCH_MAX_ENTRIES		256
+
+/* Run all the entries, even after one has failed */
+#define TA_BATCH_FLAG_NO_STOP		BIT32(0)
+
+/* Offset of a NULL memref */
+#define TA_BATCH_NULL_OFFS		UINT32_MAX
+
+/*
+ * The single memref of TA_BATCH_CMD_INVOKE is a struct ta_batch_hdr,
+ * @count struct ta_batch_wire then the data of the memrefs, each at an
+ * offset aligned to 8 bytes from the start of the header.
+ */
+struct ta_batch_hdr {
+	uint32_t magic;
+	uint32_t count;
+	uint32_t flags;		/* TA_BATCH_FLAG_* */
+	uint32_t done;		/* [out] Number of entries that ran */
+};
+
+struct ta_batch_wire {
+	uint32_t cmd;
+	uint32_t param_types;
+	uint32_t res;		/* [out] */
+	uint32_t reserved;
+	/*
+	 * Values as they are, memrefs as the offset of their data (a) and
+	 * their size (b), which is updated as the called TA sets it
+	 */
+	struct {
+		uint32_t a;
+		uint32_t b;
+	} params[TEE_NUM_PARAMS];
+};
+
+struct ta_batch_entry {
+	uint32_t cmd;
+	uint32_t param_types;
+	TEE_Param params[TEE_NUM_PARAMS];
+	TEE_Result res;		/* [out] */
+};
+
+/*
+ * ta_batch_invoke() - Invoke several commands in one round trip
+ * @sess:	Session to a TA that dispatches TA_BATCH_CMD_INVOKE
+ * @timeout:	Timeout of the whole batch
+ * @entries:	Commands to invoke, in order
+ * @count:	Number of @entries
+ * @flags:	TA_BATCH_FLAG_*
+ * @done:	[out] Number of entries that ran, may be NULL
+ * @ret_origin:	[out] Origin of the result, may be NULL
+ *
+ * The @res of each entry that ran is set, as well as its output values
+ * and memrefs. Unless TA_BATCH_FLAG_NO_STOP is set, the batch stops at
+ * the first entry that fails. Returns TEE_SUCCESS if all the entries
+ * succeeded, the result of the first that failed with @ret_origin
+ * TEE_ORIGIN_TRUSTED_APP, or the error of the invoke itself, in which
+ * case no entry is updated.
+ */
+TEE_Result ta_batch_invoke(TEE_TASessionHandle sess, uint32_t timeout,
+			   struct ta_batch_entry *entries, size_t count,
+			   uint32_t flags, size_t *done,
+			   uint32_t *ret_origin);
+
+typedef TEE_Result (*ta_batch_cmd_fn)(void *sess_ctx, uint32_t cmd,
+				      uint32_t param_types,
+				      TEE_Param params[TEE_NUM_PARAMS]);
+
+/*
+ * ta_batch_dispatch() - Run the commands of a TA_BATCH_CMD_INVOKE
+ * @sess_ctx:		Session context passed on to @fn
+ * @param_types:	Parameter types of TA_BATCH_CMD_INVOKE
+ * @params:		Parameters of TA_BATCH_CMD_INVOKE
+ * @fn:			Command handler, usually TA_InvokeCommandEntryPoint
+ *
+ * Entries of TA_BATCH_CMD_INVOKE itself are not run and fail with
+ * TEE_ERROR_NOT_SUPPORTED. Returns TEE_ERROR_BAD_PARAMETERS if the batch
+ * is malformed and TEE_SUCCESS otherwise, whatever the results of the
+ * entries are, so that they reach the caller.
+ */
+TEE_Result ta_batch_dispatch(void *sess_ctx, uint32_t param_types,
+			     TEE_Param params[TEE_NUM_PARAMS],
+			     ta_batch_cmd_fn fn);
+
+#endif /*__TA_BATCH_H*/
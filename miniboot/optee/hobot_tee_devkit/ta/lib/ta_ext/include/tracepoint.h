@@ -0,0 +1,144 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Copyright (c) 2026, D-Robotics
+ */
+
+#ifndef __TRACEPOINT_H
+#define __TRACEPOINT_H
+
+#include <arm_user_sysreg.h>
+#include <compiler.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <tee_api_types.h>
+#include <tracepoint_abi.h>
+
+/*
+ * Static tracepoints for the hot paths of a TA
+ *
+ * TRACEPOINT(), TRACE_BEGIN() and TRACE_END() store the virtual counter,
+ * a 16-bit ID and two values, @a truncated to 32 bits, in the ring of the
+ * current session. That is a counter read without isb and a few stores,
+ * there is no syscall as with TEE_GetSystemTime() and, unlike
+ * CFG_FTRACE_SUPPORT, only the places of interest are instrumented. The
+ * macros expand to nothing unless the TA is built with
+ * CFG_TA_TRACEPOINT=y, see ta_lib.mk.
+ *
+ * The TA gives each session a ring and makes it the current one at the
+ * start of each command:
+ *
+ *	TA_OpenSessionEntryPoint():
+ *		sess->tp = tp_ring_alloc(1024);
+ *	TA_InvokeCommandEntryPoint():
+ *		tp_ring_select(sess->tp);
+ *	TA_CloseSessionEntryPoint():
+ *		tp_ring_free(sess->tp);
+ *
+ * A ring has a single producer, the macros, and a single consumer,
+ * tp_ring_drain(). @head is only written by the former and @tail by the
+ * latter, so neither takes a lock. Records that do not fit are dropped
+ * and counted, the ring is meant to be drained often enough, for instance
+ * by a command the client invokes after each run, see
+ * TA_STREAM_PERF_CMD_TRACE of stream_perf.
+ *
+ * scripts/tp_trace.py turns the drained buffers into a Chrome trace JSON
+ * file, which Perfetto and chrome://tracing open, with a track per
+ * session, and prints the latency histogram of each span. It names the
+ * IDs after the "#define <prefix>TP_<name> <id>" of the headers it is
+ * given.
+ */
+
+struct tp_ring {
+	uint32_t head;		/* Records written */
+	uint32_t tail;		/* Records drained */
+	uint32_t mask;		/* Number of records - 1 */
+	uint32_t lost;		/* Records dropped, written by the producer */
+	uint32_t lost_seen;	/* @lost at the previous drain */
+	uint32_t session;	/* Random, tells the sessions apart */
+	struct tp_rec recs[];
+};
+
+#if defined(CFG_TA_TRACEPOINT)
+/* Ring of the session running, NULL if none */
+extern struct tp_ring *tp_cur;
+
+static inline void tp_record(unsigned int type, unsigned int id, uint32_t a,
+			     uint64_t b)
+{
+	struct tp_ring *ring = tp_cur;
+	struct tp_rec *rec = NULL;
+	uint32_t head = 0;
+
+	if (!ring)
+		return;
+
+	head = ring->head;
+	if (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) >
+	    ring->mask) {
+		ring->lost++;
+		return;
+	}
+
+	rec = ring->recs + (head & ring->mask);
+	rec->time = read_cntvct();
+	rec->id = id;
+	rec->type = type;
+	rec->a = a;
+	rec->b = b;
+	__atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+}
+
+#define TRACEPOINT(id, a, b)	tp_record(TP_INSTANT, (id), (a), (b))
+#define TRACE_BEGIN(id, a, b)	tp_record(TP_BEGIN, (id), (a), (b))
+#define TRACE_END(id, a, b)	tp_record(TP_END, (id), (a), (b))
+
+/*
+ * tp_ring_alloc() - Allocate a ring
+ * @nrecs:	Number of records, a power of 2
+ *
+ * Returns NULL if out of memory, tracing is then off for the session.
+ */
+struct tp_ring *tp_ring_alloc(size_t nrecs);
+void tp_ring_free(struct tp_ring *ring);
+
+/* Record to @ring from now on, NULL to stop recording */
+void tp_ring_select(struct tp_ring *ring);
+
+/*
+ * tp_ring_drain() - Move the records of a ring to a buffer
+ * @ring:	Ring to drain
+ * @buf:	Buffer to write a struct tp_hdr and the records to
+ * @len:	[in] size of @buf, [out] size written
+ *
+ * As many records as fit are moved, the others remain. Returns
+ * TEE_SUCCESS, TEE_ERROR_SHORT_BUFFER with @len set to the size of the
+ * header if not even that fits, or TEE_ERROR_BAD_STATE if @ring is NULL.
+ */
+TEE_Result tp_ring_drain(struct tp_ring *ring, void *buf, size_t *len);
+#else
+#define TRACEPOINT(id, a, b)	do { } while (0)
+#define TRACE_BEGIN(id, a, b)	do { } while (0)
+#define TRACE_END(id, a, b)	do { } while (0)
+
+static inline struct tp_ring *tp_ring_alloc(size_t nrecs __unused)
+{
+	return NULL;
+}
+
+static inline void tp_ring_free(struct tp_ring *ring __unused)
+{
+}
+
+static inline void tp_ring_select(struct tp_ring *ring __unused)
+{
+}
+
+static inline TEE_Result tp_ring_drain(struct tp_ring *ring __unused,
+				       void *buf __unused,
+				       size_t *len __unused)
+{
+	return TEE_ERROR_NOT_SUPPORTED;
+}
+#endif /*CFG_TA_TRACEPOINT*/
+
+#endif /*__TRACEPOINT_H*/
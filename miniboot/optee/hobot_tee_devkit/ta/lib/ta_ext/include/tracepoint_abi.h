@@ -0,0 +1,45 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Copyright (c) 2026, D-Robotics
+ */
+
+#ifndef __TRACEPOINT_ABI_H
+#define __TRACEPOINT_ABI_H
+
+#include <stdint.h>
+
+/*
+ * Layout of the buffers tp_ring_drain() fills, see tracepoint.h, for the
+ * client application that saves them and for scripts/tp_trace.py
+ *
+ * A drained buffer is a struct tp_hdr followed by @nrecs struct tp_rec,
+ * oldest first, in the byte order of the TA.
+ */
+
+#define TP_MAGIC		0x45434154	/* "TACE" */
+#define TP_VERSION		1
+
+/* @type of a record */
+#define TP_INSTANT		0
+#define TP_BEGIN		1
+#define TP_END			2
+
+struct tp_hdr {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t hdr_size;
+	uint32_t freq;		/* Counter frequency in Hz */
+	uint32_t session;	/* Random ID of the ring of the session */
+	uint32_t nrecs;
+	uint32_t lost;		/* Records dropped since the previous drain */
+};
+
+struct tp_rec {
+	uint64_t time;		/* Virtual counter */
+	uint16_t id;
+	uint16_t type;		/* TP_INSTANT, TP_BEGIN or TP_END */
+	uint32_t a;
+	uint64_t b;
+};
+
+#endif /*__TRACEPOINT_ABI_H*/
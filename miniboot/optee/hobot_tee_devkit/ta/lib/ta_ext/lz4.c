@@ -0,0 +1,90 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2026, D-Robotics
+ */
+
+#include <string.h>
+
+#include "lz4.h"
+
+/*
+ * Every length is checked against the remaining input and output before
+ * being used, a malformed block can never read or write out of bounds.
+ */
+static int read_length(const uint8_t **src, const uint8_t *src_end,
+		       size_t *len)
+{
+	uint8_t b = 0;
+
+	do {
+		if (*src >= src_end)
+			return -1;
+		b = *(*src)++;
+		if (*len + b < *len)
+			return -1;
+		*len += b;
+	} while (b == 255);
+
+	return 0;
+}
+
+int lz4_decompress(const uint8_t *src, size_t src_len, uint8_t *dst,
+		   size_t dst_len)
+{
+	const uint8_t *src_end = src + src_len;
+	uint8_t *dst_start = dst;
+	uint8_t *dst_end = dst + dst_len;
+	size_t offs = 0;
+	size_t len = 0;
+	uint8_t token = 0;
+
+	while (src < src_end) {
+		token = *src++;
+
+		/* Literals */
+		len = token >> 4;
+		if (len == 15 && read_length(&src, src_end, &len))
+			return -1;
+		if (len > (size_t)(src_end - src) ||
+		    len > (size_t)(dst_end - dst))
+			return -1;
+		memcpy(dst, src, len);
+		src += len;
+		dst += len;
+
+		/* The last sequence has no match part */
+		if (src == src_end)
+			break;
+
+		/* Match */
+		if (src_end - src < 2)
+			return -1;
+		offs = src[0] | (src[1] << 8);
+		src += 2;
+		if (!offs || offs > (size_t)(dst - dst_start))
+			return -1;
+
+		len = token & 0xf;
+		if (len == 15 && read_length(&src, src_end, &len))
+			return -1;
+		len += 4;
+		if (len > (size_t)(dst_end - dst))
+			return -1;
+
+		if (offs >= len) {
+			memcpy(dst, dst - offs, len);
+			dst += len;
+		} else {
+			/* Overlapping copy replicates the last offs bytes */
+			while (len--) {
+				*dst = *(dst - offs);
+				dst++;
+			}
+		}
+	}
+
+	if (dst != dst_end)
+		return -1;
+
+	return 0;
+}
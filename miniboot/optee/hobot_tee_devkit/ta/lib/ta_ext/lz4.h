@@ -0,0 +1,25 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Copyright (c) 2026, D-Robotics
+ */
+
+#ifndef __LZ4_H
+#define __LZ4_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * lz4_decompress() - Decompress an LZ4 block (no frame header)
+ * @src:	Compressed block
+ * @src_len:	Size of the compressed block
+ * @dst:	Output buffer
+ * @dst_len:	Size of the output buffer, must be the exact decompressed size
+ *
+ * Returns 0 on success or -1 if the block is malformed or does not
+ * decompress to exactly @dst_len bytes.
+ */
+int lz4_decompress(const uint8_t *src, size_t src_len, uint8_t *dst,
+		   size_t dst_len);
+
+#endif /*__LZ4_H*/
@@ -0,0 +1,221 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2026, D-Robotics
+ */
+
+#include <mempool_arena.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct mempool_arena_chunk {
+	struct mempool_arena_chunk *next;
+	size_t size;			/* Bytes following the header */
+};
+
+#define CHUNK_HDR_SIZE	((sizeof(struct mempool_arena_chunk) + \
+			  MEMPOOL_ARENA_ALIGN - 1) & \
+			 ~(size_t)(MEMPOOL_ARENA_ALIGN - 1))
+
+static struct mempool_arena *current_arena;
+
+static uint8_t *chunk_data(struct mempool_arena_chunk *chunk)
+{
+	return (uint8_t *)chunk + CHUNK_HDR_SIZE;
+}
+
+static void use_chunk(struct mempool_arena *arena,
+		      struct mempool_arena_chunk *chunk, uint8_t *ptr)
+{
+	arena->cur = chunk;
+	arena->ptr = chunk ? ptr : NULL;
+	arena->end = chunk ? chunk_data(chunk) + chunk->size : NULL;
+	arena->last = NULL;
+}
+
+void mempool_arena_init(struct mempool_arena *arena, struct mempool *pool,
+			size_t chunk_size)
+{
+	memset(arena, 0, sizeof(*arena));
+	arena->pool = pool;
+	arena->chunk_size = chunk_size;
+}
+
+void mempool_arena_release(struct mempool_arena *arena)
+{
+	struct mempool_arena_chunk *chunk = arena->first;
+	struct mempool_arena_chunk *next = NULL;
+
+	for (; chunk; chunk = next) {
+		next = chunk->next;
+		mempool_free(arena->pool, chunk);
+	}
+
+	arena->first = NULL;
+	arena->nchunks = 0;
+	use_chunk(arena, NULL, NULL);
+}
+
+/* Aligns @ptr, returns NULL if @size bytes do not fit before @end */
+static uint8_t *fit(uint8_t *ptr, uint8_t *end, size_t size, size_t align)
+{
+	uintptr_t p = ((uintptr_t)ptr + align - 1) & ~(uintptr_t)(align - 1);
+
+	if (!ptr || p > (uintptr_t)end || size > (uintptr_t)end - p)
+		return NULL;
+
+	return (uint8_t *)p;
+}
+
+/*
+ * Moves to the chunk after the current one, or to a new chunk put there if
+ * that one is too small for @size bytes aligned to @align
+ */
+static bool next_chunk(struct mempool_arena *arena, size_t size,
+		       size_t align)
+{
+	struct mempool_arena_chunk *next = NULL;
+	struct mempool_arena_chunk *chunk = NULL;
+	size_t len = 0;
+
+	next = arena->cur ? arena->cur->next : arena->first;
+	if (next && fit(chunk_data(next), chunk_data(next) + next->size, size,
+			align)) {
+		use_chunk(arena, next, chunk_data(next));
+		return true;
+	}
+
+	if (size > SIZE_MAX - CHUNK_HDR_SIZE - align)
+		return false;
+	len = size + align - 1;
+	if (len < arena->chunk_size)
+		len = arena->chunk_size;
+
+	chunk = mempool_alloc(arena->pool, CHUNK_HDR_SIZE + len);
+	if (!chunk)
+		return false;
+
+	chunk->size = len;
+	chunk->next = next;
+	if (arena->cur)
+		arena->cur->next = chunk;
+	else
+		arena->first = chunk;
+	arena->nchunks++;
+	use_chunk(arena, chunk, chunk_data(chunk));
+
+	return true;
+}
+
+void *mempool_arena_alloc(struct mempool_arena *arena, size_t size,
+			  size_t align)
+{
+	uint8_t *p = fit(arena->ptr, arena->end, size, align);
+
+	if (!p) {
+		if (!next_chunk(arena, size, align))
+			return NULL;
+		p = fit(arena->ptr, arena->end, size, align);
+	}
+
+	arena->ptr = p + size;
+	arena->last = p;
+
+	return p;
+}
+
+void *mempool_arena_calloc(struct mempool_arena *arena, size_t nmemb,
+			   size_t size)
+{
+	void *p = NULL;
+
+	if (nmemb && size > SIZE_MAX / nmemb)
+		return NULL;
+
+	p = mempool_arena_alloc(arena, nmemb * size, MEMPOOL_ARENA_ALIGN);
+	if (p)
+		memset(p, 0, nmemb * size);
+
+	return p;
+}
+
+bool mempool_arena_owns(struct mempool_arena *arena, const void *ptr)
+{
+	struct mempool_arena_chunk *chunk = NULL;
+	const uint8_t *p = ptr;
+
+	for (chunk = arena->first; chunk; chunk = chunk->next)
+		if (p >= chunk_data(chunk) &&
+		    p < chunk_data(chunk) + chunk->size)
+			return true;
+
+	return false;
+}
+
+struct mempool_arena_mark mempool_arena_mark(struct mempool_arena *arena)
+{
+	struct mempool_arena_mark mark = {
+		.chunk = arena->cur,
+		.ptr = arena->ptr,
+	};
+
+	return mark;
+}
+
+void mempool_arena_rollback(struct mempool_arena *arena,
+			    struct mempool_arena_mark mark)
+{
+	if (!mark.chunk) {
+		mempool_arena_reset(arena);
+		return;
+	}
+
+	use_chunk(arena, mark.chunk, mark.ptr);
+}
+
+void mempool_arena_reset(struct mempool_arena *arena)
+{
+	use_chunk(arena, arena->first,
+		  arena->first ? chunk_data(arena->first) : NULL);
+}
+
+void mempool_arena_set_current(struct mempool_arena *arena)
+{
+	current_arena = arena;
+}
+
+struct mempool_arena *mempool_arena_get_current(void)
+{
+	return current_arena;
+}
+
+void *mempool_arena_mbedtls_calloc(size_t nmemb, size_t size)
+{
+	void *p = NULL;
+
+	if (!current_arena)
+		return calloc(nmemb, size);
+
+	p = mempool_arena_calloc(current_arena, nmemb, size);
+	if (p)
+		return p;
+
+	current_arena->fallbacks++;
+	return calloc(nmemb, size);
+}
+
+void mempool_arena_mbedtls_free(void *ptr)
+{
+	if (!ptr)
+		return;
+
+	if (!current_arena || !mempool_arena_owns(current_arena, ptr)) {
+		free(ptr);
+		return;
+	}
+
+	/* Temporaries are often freed right after they were allocated */
+	if (ptr == current_arena->last) {
+		current_arena->ptr = current_arena->last;
+		current_arena->last = NULL;
+	}
+}
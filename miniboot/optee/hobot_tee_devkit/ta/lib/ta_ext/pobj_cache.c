@@ -0,0 +1,568 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2026, D-Robotics
+ */
+
+#include <pobj_cache.h>
+#include <string.h>
+#include <tee_internal_api.h>
+#include <tee_internal_api_extensions.h>
+#include <util.h>
+
+/* The data position of a persistent object is set with an int32_t */
+#define MAX_POS		((uint32_t)INT32_MAX)
+
+static uint8_t *slot_data(struct pobj_cache *cache,
+			  struct pobj_cache_slot *slot)
+{
+	return cache->mem + (slot - cache->slots) * cache->block_size;
+}
+
+static bool is_dirty(struct pobj_cache_slot *slot)
+{
+	return slot->lo != slot->hi;
+}
+
+static struct pobj_cache_slot *lookup(struct pobj_cache *cache,
+				      uint32_t block)
+{
+	uint32_t n = 0;
+
+	for (n = 0; n < cache->nblocks; n++)
+		if (cache->slots[n].block == block)
+			return cache->slots + n;
+
+	return NULL;
+}
+
+/* An unused slot, or else the least recently used */
+static struct pobj_cache_slot *victim(struct pobj_cache *cache)
+{
+	struct pobj_cache_slot *v = cache->slots;
+	uint32_t n = 0;
+
+	for (n = 0; n < cache->nblocks; n++) {
+		struct pobj_cache_slot *s = cache->slots + n;
+
+		if (s->block == POBJ_CACHE_NO_BLOCK)
+			return s;
+		if (cache->clock - s->stamp > cache->clock - v->stamp)
+			v = s;
+	}
+
+	return v;
+}
+
+/*
+ * Finds or allocates the slot of @block. A dirty victim is written with
+ * all the other dirty blocks if @may_flush, or else no slot is returned.
+ */
+static TEE_Result get_slot(struct pobj_cache *cache, uint32_t block,
+			   bool may_flush, struct pobj_cache_slot **slot)
+{
+	TEE_Result res = TEE_ERROR_GENERIC;
+	struct pobj_cache_slot *s = lookup(cache, block);
+
+	if (!s) {
+		s = victim(cache);
+		if (s->block != POBJ_CACHE_NO_BLOCK && is_dirty(s)) {
+			if (!may_flush)
+				return TEE_ERROR_BUSY;
+			res = pobj_cache_sync(cache);
+			if (res)
+				return res;
+		}
+		s->block = block;
+		s->lo = 0;
+		s->hi = 0;
+		s->valid = false;
+	}
+
+	s->stamp = ++cache->clock;
+	*slot = s;
+	return TEE_SUCCESS;
+}
+
+static TEE_Result backing_seek(struct pobj_cache *cache, uint32_t offs)
+{
+	return TEE_SeekObjectData(cache->obj, offs, TEE_DATA_SEEK_SET);
+}
+
+/*
+ * Copies the @avail bytes of @src that lie outside the dirty bytes of
+ * @slot into the block, zeroes the rest
+ */
+static void merge(struct pobj_cache *cache, struct pobj_cache_slot *slot,
+		  const uint8_t *src, uint32_t avail)
+{
+	uint8_t *dst = slot_data(cache, slot);
+	uint32_t bs = cache->block_size;
+	uint32_t lo = is_dirty(slot) ? slot->lo : bs;
+	uint32_t hi = is_dirty(slot) ? slot->hi : bs;
+	uint32_t n = MIN(avail, lo);
+
+	if (n)
+		memcpy(dst, src, n);
+	memset(dst + n, 0, lo - n);
+	if (hi < bs) {
+		n = avail > hi ? avail - hi : 0;
+		if (n)
+			memcpy(dst + hi, src + hi, n);
+		memset(dst + hi + n, 0, bs - hi - n);
+	}
+
+	slot->valid = true;
+}
+
+/*
+ * Size of the read-ahead window for a miss on @block: twice the last one
+ * if the miss follows the blocks last read, one block otherwise
+ */
+static uint32_t readahead(struct pobj_cache *cache, uint32_t block)
+{
+	uint32_t max = MIN(cache->io_blocks, cache->nblocks);
+	uint32_t n = 1;
+
+	if (block == cache->ra_next) {
+		n = MAX(cache->ra_blocks * 2, 2U);
+		n = MIN(n, max);
+	}
+	cache->ra_blocks = n;
+
+	return cache->ra_blocks;
+}
+
+/*
+ * Loads the block of @slot, keeping its dirty bytes. With @prefetch, the
+ * blocks after it in the read-ahead window are loaded with it.
+ */
+static TEE_Result fill(struct pobj_cache *cache, struct pobj_cache_slot *slot,
+		       bool prefetch)
+{
+	struct pobj_cache_slot *s = NULL;
+	TEE_Result res = TEE_ERROR_GENERIC;
+	uint32_t bs = cache->block_size;
+	uint32_t start = slot->block * bs;
+	uint32_t count = 0;
+	uint32_t max = 1;
+	uint32_t nb = 1;
+	uint32_t n = 0;
+
+	if (start >= cache->stored) {
+		merge(cache, slot, NULL, 0);
+		return TEE_SUCCESS;
+	}
+
+	if (prefetch)
+		max = readahead(cache, slot->block);
+	while (nb < max && start + nb * bs < cache->stored &&
+	       !lookup(cache, slot->block + nb))
+		nb++;
+
+	res = backing_seek(cache, start);
+	if (res)
+		return res;
+	res = TEE_ReadObjectData(cache->obj, cache->io,
+				 MIN(nb * bs, cache->stored - start), &count);
+	cache->stats.reads++;
+	if (res)
+		return res;
+
+	merge(cache, slot, cache->io, MIN(count, bs));
+
+	for (n = 1; n < nb && n * bs < count; n++) {
+		/* Read ahead only into clean slots */
+		if (get_slot(cache, slot->block + n, false, &s))
+			break;
+		merge(cache, s, cache->io + n * bs, MIN(count - n * bs, bs));
+		cache->stats.prefetched++;
+	}
+
+	if (prefetch)
+		cache->ra_next = slot->block + n;
+
+	return TEE_SUCCESS;
+}
+
+/*
+ * Reads the @nb whole blocks at the data position into @dst without
+ * caching them, then copies the dirty bytes of those that are cached
+ */
+static TEE_Result read_blocks(struct pobj_cache *cache, uint8_t *dst,
+			      uint32_t nb)
+{
+	struct pobj_cache_slot *s = NULL;
+	TEE_Result res = TEE_ERROR_GENERIC;
+	uint32_t bs = cache->block_size;
+	uint32_t first = cache->pos / bs;
+	uint32_t len = nb * bs;
+	uint32_t count = 0;
+	uint32_t n = 0;
+
+	if (cache->pos < cache->stored) {
+		res = backing_seek(cache, cache->pos);
+		if (res)
+			return res;
+		res = TEE_ReadObjectData(cache->obj, dst,
+					 MIN(len, cache->stored - cache->pos),
+					 &count);
+		cache->stats.reads++;
+		if (res)
+			return res;
+	}
+	memset(dst + count, 0, len - count);
+
+	for (n = 0; n < cache->nblocks; n++) {
+		s = cache->slots + n;
+		if (s->block != POBJ_CACHE_NO_BLOCK && s->block >= first &&
+		    s->block - first < nb && is_dirty(s))
+			memcpy(dst + (s->block - first) * bs + s->lo,
+			       slot_data(cache, s) + s->lo, s->hi - s->lo);
+	}
+
+	cache->stats.bypassed += nb;
+	cache->ra_next = first + nb;
+	cache->ra_blocks = MIN(cache->io_blocks, cache->nblocks);
+
+	return TEE_SUCCESS;
+}
+
+TEE_Result pobj_cache_init(struct pobj_cache *cache, TEE_ObjectHandle obj,
+			   uint32_t block_size, uint32_t nblocks,
+			   uint32_t io_blocks)
+{
+	TEE_ObjectInfo info = { };
+	TEE_Result res = TEE_ERROR_GENERIC;
+	size_t mem_size = 0;
+	size_t io_size = 0;
+	uint32_t n = 0;
+
+	memset(cache, 0, sizeof(*cache));
+
+	if (!block_size)
+		block_size = POBJ_CACHE_BLOCK_SIZE;
+	if (!IS_POWER_OF_TWO(block_size) || !nblocks || !io_blocks ||
+	    MUL_OVERFLOW(block_size, nblocks, &mem_size) ||
+	    MUL_OVERFLOW(block_size, io_blocks, &io_size) ||
+	    mem_size > MAX_POS || io_size > MAX_POS)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	res = TEE_GetObjectInfo1(obj, &info);
+	if (res)
+		return res;
+
+	cache->obj = obj;
+	cache->block_size = block_size;
+	cache->nblocks = nblocks;
+	cache->io_blocks = io_blocks;
+	cache->size = info.dataSize;
+	cache->stored = info.dataSize;
+
+	cache->mem = TEE_Malloc(mem_size, TEE_MALLOC_FILL_ZERO);
+	cache->io = TEE_Malloc(io_size, TEE_MALLOC_FILL_ZERO);
+	cache->slots = TEE_Malloc(nblocks * sizeof(*cache->slots),
+				  TEE_MALLOC_FILL_ZERO);
+	cache->order = TEE_Malloc(nblocks * sizeof(*cache->order),
+				  TEE_MALLOC_FILL_ZERO);
+	if (!cache->mem || !cache->io || !cache->slots || !cache->order) {
+		pobj_cache_fini(cache);
+		return TEE_ERROR_OUT_OF_MEMORY;
+	}
+
+	for (n = 0; n < nblocks; n++)
+		cache->slots[n].block = POBJ_CACHE_NO_BLOCK;
+
+	return TEE_SUCCESS;
+}
+
+TEE_Result pobj_cache_fini(struct pobj_cache *cache)
+{
+	TEE_Result res = TEE_SUCCESS;
+
+	if (cache->slots)
+		res = pobj_cache_sync(cache);
+
+	TEE_Free(cache->mem);
+	TEE_Free(cache->io);
+	TEE_Free(cache->slots);
+	TEE_Free(cache->order);
+	memset(cache, 0, sizeof(*cache));
+
+	return res;
+}
+
+TEE_Result pobj_cache_seek(struct pobj_cache *cache, int32_t offset,
+			   TEE_Whence whence)
+{
+	int64_t pos = offset;
+
+	switch (whence) {
+	case TEE_DATA_SEEK_SET:
+		break;
+	case TEE_DATA_SEEK_CUR:
+		pos += cache->pos;
+		break;
+	case TEE_DATA_SEEK_END:
+		pos += cache->size;
+		break;
+	default:
+		return TEE_ERROR_BAD_PARAMETERS;
+	}
+
+	if (pos < 0)
+		pos = 0;
+	if (pos > MAX_POS)
+		return TEE_ERROR_OVERFLOW;
+
+	cache->pos = pos;
+	return TEE_SUCCESS;
+}
+
+TEE_Result pobj_cache_read(struct pobj_cache *cache, void *buf,
+			   uint32_t size, uint32_t *count)
+{
+	struct pobj_cache_slot *s = NULL;
+	TEE_Result res = TEE_SUCCESS;
+	uint32_t bs = cache->block_size;
+	uint8_t *dst = buf;
+	uint32_t off = 0;
+	uint32_t n = 0;
+
+	*count = 0;
+	if (cache->pos >= cache->size)
+		return TEE_SUCCESS;
+	size = MIN(size, cache->size - cache->pos);
+
+	while (size) {
+		off = cache->pos & (bs - 1);
+		n = MIN(size, bs - off);
+
+		if (!off && size / bs > 1) {
+			n = size & ~(bs - 1);
+			res = read_blocks(cache, dst, n / bs);
+			if (res)
+				return res;
+			goto next;
+		}
+
+		s = lookup(cache, cache->pos / bs);
+		if (s && (s->valid || (off >= s->lo && off + n <= s->hi))) {
+			s->stamp = ++cache->clock;
+			cache->stats.hits++;
+		} else {
+			cache->stats.misses++;
+			res = get_slot(cache, cache->pos / bs, true, &s);
+			if (!res)
+				res = fill(cache, s, true);
+			if (res)
+				return res;
+		}
+
+		memcpy(dst, slot_data(cache, s) + off, n);
+next:
+		dst += n;
+		size -= n;
+		*count += n;
+		cache->pos += n;
+	}
+
+	return TEE_SUCCESS;
+}
+
+TEE_Result pobj_cache_write(struct pobj_cache *cache, const void *buf,
+			    uint32_t size)
+{
+	struct pobj_cache_slot *s = NULL;
+	TEE_Result res = TEE_SUCCESS;
+	uint32_t bs = cache->block_size;
+	const uint8_t *src = buf;
+	uint32_t start = 0;
+	uint32_t end = 0;
+	uint32_t off = 0;
+	uint32_t n = 0;
+
+	/* Like the REE FS, a write of nothing does not extend the object */
+	if (!size)
+		return TEE_SUCCESS;
+
+	if (ADD_OVERFLOW(cache->pos, size, &end) || end > MAX_POS)
+		return TEE_ERROR_OVERFLOW;
+
+	while (size) {
+		off = cache->pos & (bs - 1);
+		n = MIN(size, bs - off);
+		start = cache->pos - off;
+
+		res = get_slot(cache, cache->pos / bs, true, &s);
+		if (res)
+			return res;
+
+		/*
+		 * Without the rest of the block, only bytes next to the
+		 * dirty ones can be added, so that they stay one range
+		 */
+		if (!s->valid && n != bs && is_dirty(s) &&
+		    (off > s->hi || off + n < s->lo)) {
+			res = fill(cache, s, false);
+			if (res)
+				return res;
+		} else if (!s->valid && start >= cache->stored) {
+			merge(cache, s, NULL, 0);
+		}
+
+		memcpy(slot_data(cache, s) + off, src, n);
+		if (is_dirty(s)) {
+			s->lo = MIN(s->lo, off);
+			s->hi = MAX(s->hi, off + n);
+		} else {
+			s->lo = off;
+			s->hi = off + n;
+		}
+		if (n == bs)
+			s->valid = true;
+
+		src += n;
+		size -= n;
+		cache->pos += n;
+	}
+
+	cache->size = MAX(cache->size, cache->pos);
+	return TEE_SUCCESS;
+}
+
+TEE_Result pobj_cache_truncate(struct pobj_cache *cache, uint32_t size)
+{
+	struct pobj_cache_slot *s = NULL;
+	TEE_Result res = TEE_ERROR_GENERIC;
+	uint32_t bs = cache->block_size;
+	uint32_t start = 0;
+	uint32_t n = 0;
+
+	res = pobj_cache_sync(cache);
+	if (res)
+		return res;
+
+	res = TEE_TruncateObjectData(cache->obj, size);
+	if (res)
+		return res;
+
+	for (n = 0; n < cache->nblocks; n++) {
+		s = cache->slots + n;
+		if (s->block == POBJ_CACHE_NO_BLOCK)
+			continue;
+
+		start = s->block * bs;
+		if (start >= size)
+			s->block = POBJ_CACHE_NO_BLOCK;
+		else if (size - start < bs)
+			memset(slot_data(cache, s) + size - start, 0,
+			       bs - (size - start));
+	}
+
+	cache->size = size;
+	cache->stored = size;
+	return TEE_SUCCESS;
+}
+
+static void sort_dirty(struct pobj_cache *cache, uint32_t *count)
+{
+	struct pobj_cache_slot *s = NULL;
+	uint32_t n = 0;
+	uint32_t i = 0;
+
+	*count = 0;
+	for (n = 0; n < cache->nblocks; n++) {
+		s = cache->slots + n;
+		if (s->block == POBJ_CACHE_NO_BLOCK || !is_dirty(s))
+			continue;
+
+		for (i = *count; i && cache->order[i - 1]->block > s->block;
+		     i--)
+			cache->order[i] = cache->order[i - 1];
+		cache->order[i] = s;
+		(*count)++;
+	}
+}
+
+TEE_Result pobj_cache_sync(struct pobj_cache *cache)
+{
+	struct pobj_cache_slot **order = cache->order;
+	struct pobj_cache_slot *prev = NULL;
+	TEE_Result res = TEE_ERROR_GENERIC;
+	uint32_t bs = cache->block_size;
+	uint32_t max = cache->io_blocks * bs;
+	uint32_t count = 0;
+	uint32_t offs = 0;
+	uint32_t len = 0;
+	uint32_t n = 0;
+	uint32_t i = 0;
+
+	sort_dirty(cache, &count);
+
+	while (n < count) {
+		prev = order[n];
+		offs = prev->block * bs + prev->lo;
+		len = prev->hi - prev->lo;
+		memcpy(cache->io, slot_data(cache, prev) + prev->lo, len);
+
+		/* Extend the run while the dirty bytes are contiguous */
+		for (i = n + 1; i < count; i++) {
+			if (order[i]->block != prev->block + 1 ||
+			    prev->hi != bs || order[i]->lo ||
+			    len + order[i]->hi > max)
+				break;
+			memcpy(cache->io + len, slot_data(cache, order[i]),
+			       order[i]->hi);
+			len += order[i]->hi;
+			prev = order[i];
+		}
+
+		res = backing_seek(cache, offs);
+		if (!res)
+			res = TEE_WriteObjectData(cache->obj, cache->io, len);
+		cache->stats.writes++;
+		if (res)
+			return res;
+
+		for (; n < i; n++) {
+			order[n]->lo = 0;
+			order[n]->hi = 0;
+		}
+		cache->stored = MAX(cache->stored, offs + len);
+	}
+
+	return TEE_SUCCESS;
+}
+
+/* tee_map_zi() always maps at least one byte */
+static size_t map_size(uint32_t size)
+{
+	return MAX(size, 1U);
+}
+
+TEE_Result pobj_map_read(TEE_ObjectHandle obj, uint32_t offset, uint32_t size,
+			 void **buf, uint32_t *count)
+{
+	TEE_Result res = TEE_ERROR_GENERIC;
+
+	*buf = NULL;
+	*count = 0;
+	if (offset > MAX_POS)
+		return TEE_ERROR_OVERFLOW;
+
+	*buf = tee_map_zi(map_size(size), 0);
+	if (!*buf)
+		return TEE_ERROR_OUT_OF_MEMORY;
+
+	res = TEE_SeekObjectData(obj, offset, TEE_DATA_SEEK_SET);
+	if (!res)
+		res = TEE_ReadObjectData(obj, *buf, size, count);
+
+	return res;
+}
+
+void pobj_unmap(void *buf, uint32_t size)
+{
+	if (buf && tee_unmap(buf, map_size(size)))
+		EMSG("Cannot unmap %"PRIu32" bytes", size);
+}
@@ -0,0 +1,214 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2026, D-Robotics
+ */
+
+#include <shm_ring.h>
+#include <string.h>
+#include <tee_internal_api.h>
+#include <tee_internal_api_extensions.h>
+#include <util.h>
+
+#define REC_SIZE	sizeof(struct shm_ring_rec)
+
+static uint32_t load_acquire(uint32_t *p)
+{
+	return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static void store_release(uint32_t *p, uint32_t v)
+{
+	__atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+
+/*
+ * Applies @op to the data of the ring between the free running offsets
+ * @from and @to, in two parts when they wrap
+ */
+static void cache_op(struct shm_ring *ring,
+		     TEE_Result (*op)(char *buf, size_t len),
+		     uint32_t from, uint32_t to)
+{
+	uint32_t pos = from & (ring->size - 1);
+	uint32_t len = to - from;
+	uint32_t first = MIN(len, ring->size - pos);
+
+	if (!(ring->flags & SHM_RING_F_NONCOHERENT) || !len)
+		return;
+
+	op((char *)ring->data + pos, first);
+	if (len > first)
+		op((char *)ring->data, len - first);
+}
+
+TEE_Result shm_ring_attach(struct shm_ring *ring, void *buf, size_t len)
+{
+	struct shm_ring_hdr *hdr = buf;
+	uint32_t data_offs = 0;
+	uint32_t size = 0;
+	size_t end = 0;
+
+	memset(ring, 0, sizeof(*ring));
+
+	if (!buf || len < sizeof(*hdr) ||
+	    !IS_ALIGNED_WITH_TYPE(buf, struct shm_ring_hdr) ||
+	    hdr->magic != SHM_RING_MAGIC)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	/* Only the copies are used, the client may change the header */
+	data_offs = hdr->data_offs;
+	size = hdr->size;
+	if (data_offs < sizeof(*hdr) || !IS_ALIGNED(data_offs, SHM_RING_ALIGN) ||
+	    size < 2 * REC_SIZE || !IS_POWER_OF_TWO(size) ||
+	    size > BIT32(31) || ADD_OVERFLOW(data_offs, size, &end) ||
+	    end > len)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	ring->hdr = hdr;
+	ring->data = (uint8_t *)buf + data_offs;
+	ring->size = size;
+	ring->flags = hdr->flags;
+	ring->head = load_acquire(&hdr->head);
+	ring->tail = load_acquire(&hdr->tail);
+	ring->next = ring->tail;
+
+	return TEE_SUCCESS;
+}
+
+TEE_Result shm_ring_peek(struct shm_ring *ring, const void **data,
+			 size_t *len, uint32_t *tag)
+{
+	struct shm_ring_rec rec = { };
+	uint32_t used = 0;
+	uint32_t room = 0;
+	uint32_t need = 0;
+	uint32_t pos = 0;
+
+	while (true) {
+		if (ring->tail == ring->head) {
+			ring->head = load_acquire(&ring->hdr->head);
+			if (ring->tail == ring->head)
+				return TEE_ERROR_NO_DATA;
+			cache_op(ring, TEE_CacheInvalidate, ring->tail,
+				 ring->head);
+		}
+
+		used = ring->head - ring->tail;
+		pos = ring->tail & (ring->size - 1);
+		room = ring->size - pos;
+		if (used > ring->size || used < REC_SIZE)
+			return TEE_ERROR_CORRUPT_OBJECT;
+
+		memcpy(&rec, ring->data + pos, sizeof(rec));
+		if (rec.len != SHM_RING_REC_WRAP)
+			break;
+
+		if (room > used)
+			return TEE_ERROR_CORRUPT_OBJECT;
+		ring->tail += room;
+	}
+
+	if (rec.len > ring->size - REC_SIZE)
+		return TEE_ERROR_CORRUPT_OBJECT;
+	need = ROUNDUP(REC_SIZE + rec.len, SHM_RING_ALIGN);
+	if (need > room || need > used)
+		return TEE_ERROR_CORRUPT_OBJECT;
+
+	ring->next = ring->tail + need;
+	*data = ring->data + pos + REC_SIZE;
+	*len = rec.len;
+	if (tag)
+		*tag = rec.tag;
+
+	return TEE_SUCCESS;
+}
+
+void shm_ring_consume(struct shm_ring *ring)
+{
+	ring->tail = ring->next;
+	store_release(&ring->hdr->tail, ring->tail);
+}
+
+bool shm_ring_idle(struct shm_ring *ring)
+{
+	uint32_t state = SHM_RING_CONSUMER_IDLE;
+
+	/* Records skipped by a wrap are given back as well */
+	store_release(&ring->hdr->tail, ring->tail);
+
+	__atomic_store_n(&ring->hdr->consumer, SHM_RING_CONSUMER_IDLE,
+			 __ATOMIC_SEQ_CST);
+	ring->head = __atomic_load_n(&ring->hdr->head, __ATOMIC_SEQ_CST);
+	if (ring->head == ring->tail)
+		return true;
+
+	/*
+	 * Records came in before the consumer was seen idle. Go on with
+	 * them, unless the producer saw it idle first, in which case its
+	 * doorbell follows.
+	 */
+	if (!__atomic_compare_exchange_n(&ring->hdr->consumer, &state,
+					 SHM_RING_CONSUMER_RUNNING, false,
+					 __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+		return true;
+
+	cache_op(ring, TEE_CacheInvalidate, ring->tail, ring->head);
+	return false;
+}
+
+void *shm_ring_reserve(struct shm_ring *ring, size_t len, uint32_t tag)
+{
+	struct shm_ring_rec rec = { .len = len, .tag = tag };
+	uint32_t pos = ring->head & (ring->size - 1);
+	uint32_t room = ring->size - pos;
+	uint32_t need = 0;
+	uint32_t total = 0;
+	uint32_t used = 0;
+
+	if (len > ring->size - REC_SIZE)
+		return NULL;
+	need = ROUNDUP(REC_SIZE + len, SHM_RING_ALIGN);
+	total = need > room ? room + need : need;
+
+	used = ring->head - ring->tail;
+	if (used > ring->size || total > ring->size - used) {
+		ring->tail = load_acquire(&ring->hdr->tail);
+		used = ring->head - ring->tail;
+		if (used > ring->size || total > ring->size - used)
+			return NULL;
+	}
+
+	if (need > room) {
+		struct shm_ring_rec wrap = { .len = SHM_RING_REC_WRAP };
+
+		memcpy(ring->data + pos, &wrap, sizeof(wrap));
+		cache_op(ring, TEE_CacheClean, ring->head, ring->head + REC_SIZE);
+		ring->head += room;
+		pos = 0;
+	}
+
+	memcpy(ring->data + pos, &rec, sizeof(rec));
+	ring->next = ring->head + need;
+
+	return ring->data + pos + REC_SIZE;
+}
+
+void shm_ring_produce(struct shm_ring *ring)
+{
+	cache_op(ring, TEE_CacheClean, ring->head, ring->next);
+	ring->head = ring->next;
+}
+
+bool shm_ring_commit(struct shm_ring *ring)
+{
+	uint32_t state = SHM_RING_CONSUMER_IDLE;
+
+	__atomic_store_n(&ring->hdr->head, ring->head, __ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&ring->hdr->consumer, __ATOMIC_SEQ_CST) !=
+	    SHM_RING_CONSUMER_IDLE)
+		return false;
+
+	return __atomic_compare_exchange_n(&ring->hdr->consumer, &state,
+					   SHM_RING_CONSUMER_RUNNING, false,
+					   __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
@@ -0,0 +1,420 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2026, D-Robotics
+ */
+
+#include <slab_malloc.h>
+#include <stdio.h>
+#include <string.h>
+
+/*
+ * A page starts with its header, the objects follow. Objects are handed out
+ * from the free list of the page first, then in address order from the
+ * part of the page never used so far, so a new page costs no more than its
+ * header.
+ */
+struct slab_obj {
+	struct slab_obj *next;
+};
+
+struct slab_page {
+	struct slab_page *next;		/* In the partial list of the class */
+	struct slab_page *prev;
+	struct slab_obj *free;		/* Objects freed */
+	uint8_t *fresh;			/* First object never allocated */
+	uint16_t inuse;
+	uint16_t capacity;
+	uint16_t cls;
+};
+
+#define SLAB_HDR_SIZE	((sizeof(struct slab_page) + 15) & ~(size_t)15)
+
+static const uint16_t class_size[SLAB_NUM_CLASSES] = {
+	16, 32, 48, 64, 80, 96, 128, 160, 192, 256, 320, 384, 512, 640, 768
+};
+
+/* Class of each size, rounded up to 16 bytes */
+static const uint8_t size_class[SLAB_MAX_SIZE / 16 + 1] = {
+	0, 0, 1, 2, 3, 4, 5, 6, 6, 7, 7, 8, 8, 9, 9, 9, 9,
+	10, 10, 10, 10, 11, 11, 11, 11, 12, 12, 12, 12, 12, 12, 12, 12,
+	13, 13, 13, 13, 13, 13, 13, 13, 14, 14, 14, 14, 14, 14, 14, 14
+};
+
+static size_t page_size(unsigned int c)
+{
+	if (class_size[c] <= SLAB_SMALL_MAX)
+		return SLAB_SMALL_PAGE_SIZE;
+	return SLAB_PAGE_SIZE;
+}
+
+static struct slab_page *page_of(const void *ptr, unsigned int c)
+{
+	return (struct slab_page *)((uintptr_t)ptr &
+				    ~(uintptr_t)(page_size(c) - 1));
+}
+
+static uint8_t *page_objs(struct slab_page *pg)
+{
+	return (uint8_t *)pg + SLAB_HDR_SIZE;
+}
+
+static size_t page_index(struct slab_heap *heap, const void *ptr)
+{
+	return ((uintptr_t)ptr - heap->base) / SLAB_SMALL_PAGE_SIZE;
+}
+
+bool slab_heap_owns(struct slab_heap *heap, const void *ptr)
+{
+	return (uintptr_t)ptr >= heap->base &&
+	       page_index(heap, ptr) < heap->npages &&
+	       heap->map[page_index(heap, ptr)];
+}
+
+static void partial_add(struct slab_class *sc, struct slab_page *pg)
+{
+	pg->prev = NULL;
+	pg->next = sc->partial;
+	if (sc->partial)
+		sc->partial->prev = pg;
+	sc->partial = pg;
+}
+
+static void partial_del(struct slab_class *sc, struct slab_page *pg)
+{
+	if (pg->prev)
+		pg->prev->next = pg->next;
+	else
+		sc->partial = pg->next;
+	if (pg->next)
+		pg->next->prev = pg->prev;
+}
+
+static struct slab_page *page_alloc(struct slab_heap *heap, unsigned int c)
+{
+	size_t size = page_size(c);
+	struct slab_page *pg = NULL;
+
+	pg = heap->ops->memalign(size, size);
+	if (!pg)
+		return NULL;
+
+	/* Outside of the page map, for instance in a pool added later */
+	if ((uintptr_t)pg < heap->base ||
+	    page_index(heap, (uint8_t *)pg + size - 1) >= heap->npages) {
+		heap->ops->free(pg);
+		return NULL;
+	}
+
+	pg->free = NULL;
+	pg->fresh = page_objs(pg);
+	pg->inuse = 0;
+	pg->capacity = (size - SLAB_HDR_SIZE) / class_size[c];
+	pg->cls = c;
+	memset(heap->map + page_index(heap, pg), c + 1,
+	       size / SLAB_SMALL_PAGE_SIZE);
+	heap->cls[c].pages++;
+	heap->refills++;
+	partial_add(heap->cls + c, pg);
+
+	return pg;
+}
+
+static void page_release(struct slab_heap *heap, struct slab_page *pg)
+{
+	struct slab_class *sc = heap->cls + pg->cls;
+
+	partial_del(sc, pg);
+	memset(heap->map + page_index(heap, pg), 0,
+	       page_size(pg->cls) / SLAB_SMALL_PAGE_SIZE);
+	sc->pages--;
+	heap->releases++;
+	heap->ops->free(pg);
+}
+
+int slab_heap_init(struct slab_heap *heap, const struct slab_pool_ops *ops,
+		   void *base, size_t len)
+{
+	uintptr_t start = (uintptr_t)base &
+			  ~(uintptr_t)(SLAB_SMALL_PAGE_SIZE - 1);
+	uintptr_t end = (uintptr_t)base + len;
+
+	memset(heap, 0, sizeof(*heap));
+	heap->ops = ops;
+	heap->base = start;
+	heap->npages = (end - start + SLAB_SMALL_PAGE_SIZE - 1) /
+		       SLAB_SMALL_PAGE_SIZE;
+	heap->map = ops->calloc(heap->npages, 1);
+	if (!heap->map) {
+		heap->npages = 0;
+		return -1;
+	}
+
+	return 0;
+}
+
+void *slab_heap_malloc(struct slab_heap *heap, size_t size)
+{
+	struct slab_class *sc = NULL;
+	struct slab_page *pg = NULL;
+	struct slab_obj *obj = NULL;
+	unsigned int c = 0;
+
+	if (size > SLAB_MAX_SIZE || !heap->npages)
+		return heap->ops->malloc(size);
+
+	c = size_class[(size + 15) / 16];
+	sc = heap->cls + c;
+	sc->inuse++;
+	if (sc->nmag)
+		return sc->mag[--sc->nmag];
+
+	pg = sc->partial;
+	if (!pg) {
+		pg = page_alloc(heap, c);
+		if (!pg) {
+			sc->inuse--;
+			heap->passthrough++;
+			return heap->ops->malloc(size);
+		}
+	}
+
+	obj = pg->free;
+	if (obj) {
+		pg->free = obj->next;
+	} else {
+		obj = (struct slab_obj *)pg->fresh;
+		pg->fresh += class_size[c];
+	}
+
+	if (++pg->inuse == pg->capacity)
+		partial_del(sc, pg);
+
+	return obj;
+}
+
+void *slab_heap_calloc(struct slab_heap *heap, size_t nmemb, size_t size)
+{
+	void *ptr = NULL;
+
+	if (nmemb && size > SIZE_MAX / nmemb)
+		return NULL;
+	if (nmemb * size > SLAB_MAX_SIZE)
+		return heap->ops->calloc(nmemb, size);
+
+	ptr = slab_heap_malloc(heap, nmemb * size);
+	if (ptr)
+		memset(ptr, 0, nmemb * size);
+
+	return ptr;
+}
+
+/* Gives an object back to its page */
+static void obj_free(struct slab_heap *heap, struct slab_class *sc, void *ptr)
+{
+	struct slab_page *pg = page_of(ptr, sc - heap->cls);
+	struct slab_obj *obj = ptr;
+
+	obj->next = pg->free;
+	pg->free = obj;
+
+	if (pg->inuse-- == pg->capacity)
+		partial_add(sc, pg);
+	if (!pg->inuse)
+		page_release(heap, pg);
+}
+
+/* Gives the @n objects at the bottom of the magazine back to their pages */
+static void mag_flush(struct slab_heap *heap, struct slab_class *sc,
+		      unsigned int n)
+{
+	unsigned int i = 0;
+
+	for (i = 0; i < n; i++)
+		obj_free(heap, sc, sc->mag[i]);
+	sc->nmag -= n;
+	memmove(sc->mag, sc->mag + n, sc->nmag * sizeof(sc->mag[0]));
+}
+
+void slab_heap_free(struct slab_heap *heap, void *ptr)
+{
+	struct slab_class *sc = NULL;
+
+	if (!ptr)
+		return;
+
+	if (!slab_heap_owns(heap, ptr)) {
+		heap->ops->free(ptr);
+		return;
+	}
+
+	sc = heap->cls + heap->map[page_index(heap, ptr)] - 1;
+	sc->inuse--;
+	if (sc->nmag == SLAB_MAG_SIZE)
+		mag_flush(heap, sc, SLAB_MAG_SIZE / 2);
+	sc->mag[sc->nmag++] = ptr;
+}
+
+void slab_heap_trim(struct slab_heap *heap)
+{
+	unsigned int c = 0;
+
+	for (c = 0; c < SLAB_NUM_CLASSES; c++)
+		mag_flush(heap, heap->cls + c, heap->cls[c].nmag);
+}
+
+void *slab_heap_realloc(struct slab_heap *heap, void *ptr, size_t size)
+{
+	size_t old_size = 0;
+	void *p = NULL;
+
+	if (!ptr)
+		return slab_heap_malloc(heap, size);
+	if (!slab_heap_owns(heap, ptr))
+		return heap->ops->realloc(ptr, size);
+
+	old_size = class_size[heap->map[page_index(heap, ptr)] - 1];
+	if (size <= old_size)
+		return ptr;
+
+	p = slab_heap_malloc(heap, size);
+	if (!p)
+		return NULL;
+	memcpy(p, ptr, old_size);
+	slab_heap_free(heap, ptr);
+
+	return p;
+}
+
+void slab_heap_get_stats(struct slab_heap *heap, struct slab_stats *stats)
+{
+	struct slab_class_stats *cs = NULL;
+	unsigned int c = 0;
+
+	memset(stats, 0, sizeof(*stats));
+
+	for (c = 0; c < SLAB_NUM_CLASSES; c++) {
+		cs = stats->cls + c;
+		cs->size = class_size[c];
+		cs->pages = heap->cls[c].pages;
+		cs->inuse = heap->cls[c].inuse;
+		cs->capacity = cs->pages *
+			       ((page_size(c) - SLAB_HDR_SIZE) / cs->size);
+		stats->pages += cs->pages;
+		stats->page_bytes += cs->pages * page_size(c);
+		stats->allocated += cs->inuse * cs->size;
+	}
+
+	stats->refills = heap->refills;
+	stats->releases = heap->releases;
+	stats->passthrough = heap->passthrough;
+}
+
+/* Checks one page, returns the number of objects allocated or -1 */
+static int check_page(struct slab_page *pg, unsigned int c)
+{
+	size_t size = class_size[c];
+	uint8_t *objs = page_objs(pg);
+	uint8_t *end = NULL;
+	struct slab_obj *obj = NULL;
+	size_t nfree = 0;
+
+	if (pg->cls != c ||
+	    pg->capacity != (page_size(c) - SLAB_HDR_SIZE) / size ||
+	    pg->inuse > pg->capacity)
+		return -1;
+
+	end = objs + pg->capacity * size;
+	if (pg->fresh < objs || pg->fresh > end ||
+	    (size_t)(pg->fresh - objs) % size)
+		return -1;
+
+	for (obj = pg->free; obj; obj = obj->next) {
+		if ((uint8_t *)obj < objs || (uint8_t *)obj >= pg->fresh ||
+		    (size_t)((uint8_t *)obj - objs) % size ||
+		    ++nfree > pg->capacity)
+			return -1;
+	}
+
+	if (nfree + pg->inuse + (end - pg->fresh) / size != pg->capacity)
+		return -1;
+
+	return pg->inuse;
+}
+
+int slab_heap_check(struct slab_heap *heap, int bufdump)
+{
+	uint32_t pages[SLAB_NUM_CLASSES] = { };
+	uint32_t partial[SLAB_NUM_CLASSES] = { };
+	uint32_t inuse[SLAB_NUM_CLASSES] = { };
+	struct slab_page *pg = NULL;
+	unsigned int c = 0;
+	size_t units = 0;
+	size_t idx = 0;
+	size_t i = 0;
+	int ret = 0;
+	int n = 0;
+
+	for (idx = 0; idx < heap->npages; idx += units ? units : 1) {
+		units = 0;
+		if (!heap->map[idx])
+			continue;
+
+		pg = (struct slab_page *)(heap->base +
+					  idx * SLAB_SMALL_PAGE_SIZE);
+		c = heap->map[idx] - 1;
+		if (c >= SLAB_NUM_CLASSES || page_of(pg, c) != pg) {
+			printf("slab map %zu: bad entry %u\n", idx,
+			       heap->map[idx]);
+			ret = -1;
+			continue;
+		}
+
+		/* A page covers several entries of the map */
+		units = page_size(c) / SLAB_SMALL_PAGE_SIZE;
+		for (i = 1; i < units; i++)
+			if (idx + i >= heap->npages ||
+			    heap->map[idx + i] != c + 1)
+				break;
+		if (i < units) {
+			printf("slab page %p: map entries do not match\n",
+			       (void *)pg);
+			ret = -1;
+			continue;
+		}
+
+		n = check_page(pg, c);
+		if (bufdump || n < 0)
+			printf("slab page %p size %u inuse %u/%u%s\n",
+			       (void *)pg, class_size[c], pg->inuse,
+			       pg->capacity, n < 0 ? " corrupt" : "");
+		if (n < 0) {
+			ret = -1;
+			continue;
+		}
+
+		pages[c]++;
+		inuse[c] += n;
+		if (pg->inuse < pg->capacity)
+			partial[c]++;
+	}
+
+	for (c = 0; c < SLAB_NUM_CLASSES; c++) {
+		n = 0;
+		for (pg = heap->cls[c].partial; pg; pg = pg->next) {
+			if (page_index(heap, pg) >= heap->npages ||
+			    heap->map[page_index(heap, pg)] != c + 1 ||
+			    pg->inuse == pg->capacity ||
+			    (uint32_t)++n > partial[c])
+				break;
+		}
+		if (pg || (uint32_t)n != partial[c] ||
+		    pages[c] != heap->cls[c].pages ||
+		    inuse[c] != heap->cls[c].inuse + heap->cls[c].nmag) {
+			printf("slab class %u: inconsistent page lists\n",
+			       class_size[c]);
+			ret = -1;
+		}
+	}
+
+	return ret;
+}
@@ -0,0 +1,136 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2026, D-Robotics
+ */
+
+#include <malloc.h>
+#include <slab_malloc.h>
+#include <stdint.h>
+
+/*
+ * With CFG_TA_SLAB_MALLOC=y the TA is linked with --wrap=malloc and so on,
+ * see ta_lib.mk: every call to malloc() lands in __wrap_malloc() and
+ * __real_malloc() is the malloc() of libutils.
+ */
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t nmemb, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+
+void *__wrap_malloc(size_t size);
+void *__wrap_calloc(size_t nmemb, size_t size);
+void *__wrap_realloc(void *ptr, size_t size);
+void __wrap_free(void *ptr);
+
+/* The heap of the TA, see user_ta_header.c */
+extern uint8_t ta_heap[];
+extern const size_t ta_heap_size;
+
+/* With ENABLE_MDBG the pages are recorded as allocated here */
+static void *pool_memalign(size_t alignment, size_t size)
+{
+	return memalign(alignment, size);
+}
+
+static const struct slab_pool_ops ta_pool_ops = {
+	.malloc = __real_malloc,
+	.calloc = __real_calloc,
+	.realloc = __real_realloc,
+	.memalign = pool_memalign,
+	.free = __real_free,
+};
+
+static struct slab_heap ta_slab_heap;
+
+/* 0 until the first allocation, 1 once set up, -1 if it failed */
+static int ta_slab_state;
+
+static struct slab_heap *ta_slab(void)
+{
+	if (!ta_slab_state)
+		ta_slab_state = slab_heap_init(&ta_slab_heap, &ta_pool_ops,
+					       ta_heap, ta_heap_size) ? -1 : 1;
+
+	if (ta_slab_state < 0)
+		return NULL;
+
+	return &ta_slab_heap;
+}
+
+struct slab_heap *slab_malloc_heap(void)
+{
+	return ta_slab();
+}
+
+void *__wrap_malloc(size_t size)
+{
+	struct slab_heap *heap = ta_slab();
+
+	if (!heap)
+		return __real_malloc(size);
+
+	return slab_heap_malloc(heap, size);
+}
+
+void *__wrap_calloc(size_t nmemb, size_t size)
+{
+	struct slab_heap *heap = ta_slab();
+
+	if (!heap)
+		return __real_calloc(nmemb, size);
+
+	return slab_heap_calloc(heap, nmemb, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+	struct slab_heap *heap = ta_slab();
+
+	if (!heap)
+		return __real_realloc(ptr, size);
+
+	return slab_heap_realloc(heap, ptr, size);
+}
+
+void __wrap_free(void *ptr)
+{
+	/* Nothing comes from the slab pages before they are set up */
+	if (ta_slab_state <= 0) {
+		__real_free(ptr);
+		return;
+	}
+
+	slab_heap_free(&ta_slab_heap, ptr);
+}
+
+void slab_malloc_check(int bufdump)
+{
+	if (ta_slab_state > 0)
+		slab_heap_check(&ta_slab_heap, bufdump);
+
+	mdbg_check(bufdump);
+}
+
+#ifdef CFG_WITH_STATS
+void slab_malloc_get_stats(struct malloc_stats *stats)
+{
+	struct slab_stats slab = { };
+
+	malloc_get_stats(stats);
+	if (ta_slab_state <= 0)
+		return;
+
+	slab_heap_get_stats(&ta_slab_heap, &slab);
+	stats->allocated -= slab.page_bytes - slab.allocated;
+}
+
+void slab_malloc_reset_stats(void)
+{
+	malloc_reset_stats();
+	if (ta_slab_state > 0) {
+		ta_slab_heap.refills = 0;
+		ta_slab_heap.releases = 0;
+		ta_slab_heap.passthrough = 0;
+	}
+}
+#endif /*CFG_WITH_STATS*/
@@ -0,0 +1,12 @@
+global-incdirs-y += include
+srcs-y += ta_asset.c
+srcs-y += lz4.c
+srcs-$(CFG_TA_HEAP_PROF) += heap_prof.c
+srcs-$(CFG_TA_BINLOG) += binlog.c
+srcs-$(CFG_TA_TRACEPOINT) += tracepoint.c
+srcs-y += mempool_arena.c
+srcs-y += slab_heap.c
+srcs-$(CFG_TA_SLAB_MALLOC) += slab_malloc.c
+srcs-y += ta_batch.c
+srcs-y += shm_ring.c
+srcs-y += pobj_cache.c
@@ -0,0 +1,63 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2026, D-Robotics
+ */
+
+#include <ta_asset.h>
+#include <tee_internal_api.h>
+#include <tee_internal_api_extensions.h>
+#include <util.h>
+
+#include "lz4.h"
+
+static size_t map_size(struct ta_asset *asset)
+{
+	/* tee_map_zi() always maps at least one byte */
+	return MAX(asset->orig_size, (size_t)1);
+}
+
+const void *ta_asset_get(struct ta_asset *asset, size_t *size)
+{
+	uint8_t *buf = NULL;
+
+	if (size)
+		*size = asset->orig_size;
+
+	switch (asset->compress) {
+	case TA_ASSET_COMPRESS_NONE:
+		return asset->data;
+	case TA_ASSET_COMPRESS_LZ4:
+		break;
+	default:
+		EMSG("Unknown asset compression %"PRIu32, asset->compress);
+		return NULL;
+	}
+
+	if (asset->buf)
+		return asset->buf;
+
+	buf = tee_map_zi(map_size(asset), 0);
+	if (!buf) {
+		EMSG("Cannot map %zu bytes for asset", asset->orig_size);
+		return NULL;
+	}
+
+	if (lz4_decompress(asset->data, asset->size, buf, asset->orig_size)) {
+		EMSG("Corrupt asset payload");
+		tee_unmap(buf, map_size(asset));
+		return NULL;
+	}
+
+	asset->buf = buf;
+	return buf;
+}
+
+void ta_asset_release(struct ta_asset *asset)
+{
+	if (!asset->buf)
+		return;
+
+	if (tee_unmap(asset->buf, map_size(asset)))
+		EMSG("Cannot unmap asset");
+	asset->buf = NULL;
+}
@@ -0,0 +1,361 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2026, D-Robotics
+ */
+
+#include <string.h>
+#include <ta_batch.h>
+#include <tee_internal_api.h>
+#include <tee_internal_api_extensions.h>
+#include <util.h>
+
+#define DATA_ALIGN	8
+
+static bool is_memref(uint32_t type)
+{
+	return type == TEE_PARAM_TYPE_MEMREF_INPUT ||
+	       type == TEE_PARAM_TYPE_MEMREF_OUTPUT ||
+	       type == TEE_PARAM_TYPE_MEMREF_INOUT;
+}
+
+static bool is_value(uint32_t type)
+{
+	return type == TEE_PARAM_TYPE_VALUE_INPUT ||
+	       type == TEE_PARAM_TYPE_VALUE_OUTPUT ||
+	       type == TEE_PARAM_TYPE_VALUE_INOUT;
+}
+
+/* Output and inout parameters are copied back to the caller */
+static bool is_output(uint32_t type)
+{
+	return type == TEE_PARAM_TYPE_VALUE_OUTPUT ||
+	       type == TEE_PARAM_TYPE_VALUE_INOUT ||
+	       type == TEE_PARAM_TYPE_MEMREF_OUTPUT ||
+	       type == TEE_PARAM_TYPE_MEMREF_INOUT;
+}
+
+static bool wires_size(size_t count, size_t *size)
+{
+	size_t sz = 0;
+
+	if (MUL_OVERFLOW(count, sizeof(struct ta_batch_wire), &sz) ||
+	    ADD_OVERFLOW(sz, sizeof(struct ta_batch_hdr), size))
+		return false;
+
+	return true;
+}
+
+/*
+ * Lays out the memrefs of @entries after the wire entries, returns the
+ * size of the whole buffer in @size or false if it does not fit 32 bits
+ */
+static bool layout(const struct ta_batch_entry *entries, size_t count,
+		   size_t *size)
+{
+	size_t len = 0;
+	size_t n = 0;
+	size_t i = 0;
+
+	if (!wires_size(count, &len))
+		return false;
+
+	for (n = 0; n < count; n++) {
+		for (i = 0; i < TEE_NUM_PARAMS; i++) {
+			uint32_t t = TEE_PARAM_TYPE_GET(entries[n].param_types,
+							i);
+			const TEE_Param *p = entries[n].params + i;
+
+			if (!is_memref(t) || !p->memref.buffer)
+				continue;
+			if (ROUNDUP_OVERFLOW(len, DATA_ALIGN, &len) ||
+			    ADD_OVERFLOW(len, p->memref.size, &len))
+				return false;
+		}
+	}
+
+	if (len >= TA_BATCH_NULL_OFFS)
+		return false;
+
+	*size = len;
+	return true;
+}
+
+static void pack(uint8_t *buf, const struct ta_batch_entry *entries,
+		 size_t count, uint32_t flags)
+{
+	struct ta_batch_hdr *hdr = (struct ta_batch_hdr *)buf;
+	struct ta_batch_wire *wire = (struct ta_batch_wire *)(hdr + 1);
+	size_t offs = 0;
+	size_t n = 0;
+	size_t i = 0;
+
+	hdr->magic = TA_BATCH_MAGIC;
+	hdr->count = count;
+	hdr->flags = flags;
+	hdr->done = 0;
+
+	wires_size(count, &offs);
+
+	for (n = 0; n < count; n++, wire++) {
+		wire->cmd = entries[n].cmd;
+		wire->param_types = entries[n].param_types;
+		wire->res = TEE_ERROR_GENERIC;
+
+		for (i = 0; i < TEE_NUM_PARAMS; i++) {
+			uint32_t t = TEE_PARAM_TYPE_GET(wire->param_types, i);
+			const TEE_Param *p = entries[n].params + i;
+
+			if (is_value(t)) {
+				wire->params[i].a = p->value.a;
+				wire->params[i].b = p->value.b;
+				continue;
+			}
+			if (!is_memref(t))
+				continue;
+
+			wire->params[i].b = p->memref.size;
+			if (!p->memref.buffer) {
+				wire->params[i].a = TA_BATCH_NULL_OFFS;
+				continue;
+			}
+
+			offs = ROUNDUP(offs, DATA_ALIGN);
+			wire->params[i].a = offs;
+			if (t != TEE_PARAM_TYPE_MEMREF_OUTPUT)
+				memcpy(buf + offs, p->memref.buffer,
+				       p->memref.size);
+			offs += p->memref.size;
+		}
+	}
+}
+
+/*
+ * Copies the outputs of @wire to @entry. @offs is the offset of the data
+ * of the first memref of @entry as pack() laid it out, the called TA
+ * cannot move it.
+ */
+static void unpack_entry(const uint8_t *buf, const struct ta_batch_wire *wire,
+			 struct ta_batch_entry *entry, size_t *offs)
+{
+	size_t i = 0;
+
+	entry->res = wire->res;
+
+	for (i = 0; i < TEE_NUM_PARAMS; i++) {
+		uint32_t t = TEE_PARAM_TYPE_GET(entry->param_types, i);
+		TEE_Param *p = entry->params + i;
+		size_t data = 0;
+
+		if (is_memref(t) && p->memref.buffer) {
+			*offs = ROUNDUP(*offs, DATA_ALIGN);
+			data = *offs;
+			*offs += p->memref.size;
+		}
+
+		if (!is_output(t))
+			continue;
+
+		if (is_value(t)) {
+			p->value.a = wire->params[i].a;
+			p->value.b = wire->params[i].b;
+			continue;
+		}
+
+		/* A larger size tells the size needed, there is no data */
+		if (p->memref.buffer && wire->params[i].b <= p->memref.size)
+			memcpy(p->memref.buffer, buf + data,
+			       wire->params[i].b);
+		p->memref.size = wire->params[i].b;
+	}
+}
+
+TEE_Result ta_batch_invoke(TEE_TASessionHandle sess, uint32_t timeout,
+			   struct ta_batch_entry *entries, size_t count,
+			   uint32_t flags, size_t *done,
+			   uint32_t *ret_origin)
+{
+	TEE_Result res = TEE_ERROR_GENERIC;
+	const struct ta_batch_hdr *hdr = NULL;
+	const struct ta_batch_wire *wire = NULL;
+	TEE_Param params[TEE_NUM_PARAMS] = { };
+	uint32_t origin = TEE_ORIGIN_API;
+	uint8_t *buf = NULL;
+	size_t size = 0;
+	size_t offs = 0;
+	size_t n = 0;
+
+	if (done)
+		*done = 0;
+
+	if ((!entries && count) || count > TA_BATCH_MAX_ENTRIES ||
+	    !layout(entries, count, &size)) {
+		res = TEE_ERROR_BAD_PARAMETERS;
+		goto out;
+	}
+
+	buf = TEE_Malloc(size, TEE_MALLOC_FILL_ZERO);
+	if (!buf) {
+		res = TEE_ERROR_OUT_OF_MEMORY;
+		goto out;
+	}
+
+	pack(buf, entries, count, flags);
+
+	params[0].memref.buffer = buf;
+	params[0].memref.size = size;
+	res = TEE_InvokeTACommand(sess, timeout, TA_BATCH_CMD_INVOKE,
+				  TEE_PARAM_TYPES(TEE_PARAM_TYPE_MEMREF_INOUT,
+						  TEE_PARAM_TYPE_NONE,
+						  TEE_PARAM_TYPE_NONE,
+						  TEE_PARAM_TYPE_NONE),
+				  params, &origin);
+	if (res)
+		goto out;
+
+	hdr = (const struct ta_batch_hdr *)buf;
+	if (hdr->done > count) {
+		res = TEE_ERROR_COMMUNICATION;
+		origin = TEE_ORIGIN_TRUSTED_APP;
+		goto out;
+	}
+
+	wire = (const struct ta_batch_wire *)(hdr + 1);
+	wires_size(count, &offs);
+	for (n = 0; n < hdr->done; n++) {
+		unpack_entry(buf, wire + n, entries + n, &offs);
+		if (entries[n].res && !res) {
+			res = entries[n].res;
+			origin = TEE_ORIGIN_TRUSTED_APP;
+		}
+	}
+
+	if (done)
+		*done = hdr->done;
+out:
+	TEE_Free(buf);
+	if (ret_origin)
+		*ret_origin = origin;
+	return res;
+}
+
+/*
+ * Sets @p from @wire, returns false if a memref is not within the @size
+ * bytes of the data that follow the @data_offs first bytes of the batch
+ */
+static bool get_param(uint8_t *buf, size_t size, size_t data_offs,
+		      uint32_t type, uint32_t a, uint32_t b, TEE_Param *p)
+{
+	size_t end = 0;
+
+	if (is_value(type)) {
+		p->value.a = a;
+		p->value.b = b;
+		return true;
+	}
+	if (!is_memref(type))
+		return type == TEE_PARAM_TYPE_NONE;
+
+	p->memref.size = b;
+	if (a == TA_BATCH_NULL_OFFS) {
+		p->memref.buffer = NULL;
+		return true;
+	}
+
+	if (a < data_offs || ADD_OVERFLOW(a, b, &end) || end > size)
+		return false;
+
+	p->memref.buffer = buf + a;
+	return true;
+}
+
+static TEE_Result run_entry(void *sess_ctx, uint8_t *buf, size_t size,
+			    size_t data_offs, struct ta_batch_wire *wire,
+			    ta_batch_cmd_fn fn)
+{
+	TEE_Param params[TEE_NUM_PARAMS] = { };
+	TEE_Result res = TEE_ERROR_GENERIC;
+	uint32_t sizes[TEE_NUM_PARAMS] = { };
+	uint32_t t = 0;
+	size_t i = 0;
+
+	if (wire->cmd == TA_BATCH_CMD_INVOKE)
+		return TEE_ERROR_NOT_SUPPORTED;
+
+	for (i = 0; i < TEE_NUM_PARAMS; i++) {
+		t = TEE_PARAM_TYPE_GET(wire->param_types, i);
+		if (!get_param(buf, size, data_offs, t, wire->params[i].a,
+			       wire->params[i].b, params + i))
+			return TEE_ERROR_BAD_PARAMETERS;
+		sizes[i] = wire->params[i].b;
+	}
+
+	res = fn(sess_ctx, wire->cmd, wire->param_types, params);
+
+	for (i = 0; i < TEE_NUM_PARAMS; i++) {
+		t = TEE_PARAM_TYPE_GET(wire->param_types, i);
+		if (!is_output(t))
+			continue;
+
+		if (is_value(t)) {
+			wire->params[i].a = params[i].value.a;
+			wire->params[i].b = params[i].value.b;
+		} else if (params[i].memref.size <= UINT32_MAX) {
+			wire->params[i].b = params[i].memref.size;
+		} else {
+			wire->params[i].b = sizes[i];
+		}
+	}
+
+	return res;
+}
+
+TEE_Result ta_batch_dispatch(void *sess_ctx, uint32_t param_types,
+			     TEE_Param params[TEE_NUM_PARAMS],
+			     ta_batch_cmd_fn fn)
+{
+	struct ta_batch_wire *wires = NULL;
+	struct ta_batch_wire wire = { };
+	struct ta_batch_hdr hdr = { };
+	size_t data_offs = 0;
+	uint8_t *buf = NULL;
+	size_t size = 0;
+	size_t n = 0;
+
+	if (param_types != TEE_PARAM_TYPES(TEE_PARAM_TYPE_MEMREF_INOUT,
+					   TEE_PARAM_TYPE_NONE,
+					   TEE_PARAM_TYPE_NONE,
+					   TEE_PARAM_TYPE_NONE))
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	buf = params[0].memref.buffer;
+	size = params[0].memref.size;
+	if (!buf || size < sizeof(hdr) ||
+	    !IS_ALIGNED_WITH_TYPE(buf, struct ta_batch_hdr))
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	/* The caller may still write to the buffer, work on copies */
+	memcpy(&hdr, buf, sizeof(hdr));
+	if (hdr.magic != TA_BATCH_MAGIC ||
+	    hdr.count > TA_BATCH_MAX_ENTRIES ||
+	    !wires_size(hdr.count, &data_offs) || data_offs > size)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	wires = (struct ta_batch_wire *)(buf + sizeof(hdr));
+	for (n = 0; n < hdr.count; n++) {
+		memcpy(&wire, wires + n, sizeof(wire));
+		wire.res = run_entry(sess_ctx, buf, size, data_offs, &wire,
+				     fn);
+		memcpy(wires + n, &wire, sizeof(wire));
+
+		if (wire.res && !(hdr.flags & TA_BATCH_FLAG_NO_STOP)) {
+			n++;
+			break;
+		}
+	}
+
+	hdr.done = n;
+	memcpy(buf, &hdr, sizeof(hdr));
+	params[0].memref.size = size;
+
+	return TEE_SUCCESS;
+}
@@ -0,0 +1,94 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2026, D-Robotics
+ */
+
+#include <arm_user_sysreg.h>
+#include <string.h>
+#include <tee_internal_api.h>
+#include <tracepoint.h>
+#include <util.h>
+
+struct tp_ring *tp_cur;
+
+struct tp_ring *tp_ring_alloc(size_t nrecs)
+{
+	struct tp_ring *ring = NULL;
+
+	if (!nrecs || nrecs & (nrecs - 1) || nrecs > UINT32_MAX ||
+	    nrecs > (SIZE_MAX - sizeof(*ring)) / sizeof(struct tp_rec))
+		return NULL;
+
+	ring = TEE_Malloc(sizeof(*ring) + nrecs * sizeof(struct tp_rec),
+			  TEE_MALLOC_FILL_ZERO);
+	if (!ring)
+		return NULL;
+
+	ring->mask = nrecs - 1;
+	/*
+	 * Sessions of a TA without TA_FLAG_MULTI_SESSION each have their own
+	 * instance, a counter would number them all 1
+	 */
+	do {
+		TEE_GenerateRandom(&ring->session, sizeof(ring->session));
+	} while (!ring->session);
+
+	return ring;
+}
+
+void tp_ring_free(struct tp_ring *ring)
+{
+	if (ring && tp_cur == ring)
+		tp_cur = NULL;
+	TEE_Free(ring);
+}
+
+void tp_ring_select(struct tp_ring *ring)
+{
+	tp_cur = ring;
+}
+
+TEE_Result tp_ring_drain(struct tp_ring *ring, void *buf, size_t *len)
+{
+	struct tp_hdr hdr = {
+		.magic = TP_MAGIC,
+		.version = TP_VERSION,
+		.hdr_size = sizeof(hdr),
+	};
+	uint8_t *dst = NULL;
+	uint32_t head = 0;
+	uint32_t tail = 0;
+	uint32_t lost = 0;
+	size_t n = 0;
+
+	if (!ring)
+		return TEE_ERROR_BAD_STATE;
+	if (*len < sizeof(hdr)) {
+		*len = sizeof(hdr);
+		return TEE_ERROR_SHORT_BUFFER;
+	}
+
+	head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+	tail = ring->tail;
+	lost = __atomic_load_n(&ring->lost, __ATOMIC_RELAXED);
+
+	hdr.freq = read_cntfrq();
+	hdr.session = ring->session;
+	hdr.nrecs = MIN((size_t)(head - tail),
+			(*len - sizeof(hdr)) / sizeof(struct tp_rec));
+	hdr.lost = lost - ring->lost_seen;
+	ring->lost_seen = lost;
+
+	/* @buf may be shared memory, which is not aligned for the records */
+	memcpy(buf, &hdr, sizeof(hdr));
+	dst = (uint8_t *)buf + sizeof(hdr);
+	for (n = 0; n < hdr.nrecs; n++)
+		memcpy(dst + n * sizeof(struct tp_rec),
+		       ring->recs + ((tail + n) & ring->mask),
+		       sizeof(struct tp_rec));
+
+	__atomic_store_n(&ring->tail, tail + hdr.nrecs, __ATOMIC_RELEASE);
+	*len = sizeof(hdr) + hdr.nrecs * sizeof(struct tp_rec);
+
+	return TEE_SUCCESS;
+}
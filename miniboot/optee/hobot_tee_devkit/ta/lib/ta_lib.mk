@@ -0,0 +1,61 @@
+# Makefile fragment for TAs that link with the static libraries in ta/lib.
+#
+# Set TA_LIBS to the libraries to link with (for instance TA_LIBS := ta_ext)
+# and include this file from the TA Makefile before ta_dev_kit.mk. The
+# libraries are expected in $(O)/../../lib/<lib>, which is where ta/Makefile
+# builds them when the TA itself is built in $(O) = <out>/ta/<ta-name>.
+
+ta-lib-dir := $(patsubst %/,%,$(abspath $(dir $(lastword $(MAKEFILE_LIST)))))
+TA_LIB_OUT_DIR ?= $(abspath $(O)/../../lib)
+
+CPPFLAGS += $(foreach l,$(TA_LIBS),-I$(ta-lib-dir)/$(l)/include)
+LDADD += $(foreach l,$(TA_LIBS),-L$(TA_LIB_OUT_DIR)/$(l) -l$(l))
+# Relink the TA when one of the libraries is rebuilt
+libdeps += $(foreach l,$(TA_LIBS),$(TA_LIB_OUT_DIR)/$(l)/lib$(l).a)
+
+# CFG_TA_SLAB_MALLOC=y puts the slab heap of ta_ext in front of malloc(),
+# calloc(), realloc() and free(), for the calls made by the TA as well as
+# those made by libutee and libmbedtls, see slab_malloc.h. libta_ext comes
+# before the libraries of the dev kit on the link line, so the wrappers are
+# pulled in with -u even if the objects of the TA never call malloc().
+ifeq ($(CFG_TA_SLAB_MALLOC)-$(filter ta_ext,$(TA_LIBS)),y-ta_ext)
+LDADD += --wrap=malloc --wrap=calloc --wrap=realloc --wrap=free
+LDADD += -u __wrap_malloc -u __wrap_calloc -u __wrap_realloc -u __wrap_free
+endif
+
+# CFG_TA_HEAP_PROF=y records the heap events of the TA, see heap_prof.h. As
+# for CFG_TA_SLAB_MALLOC, -u pulls in the wrappers.
+ifeq ($(CFG_TA_HEAP_PROF)-$(filter ta_ext,$(TA_LIBS)),y-ta_ext)
+ifeq ($(CFG_TA_SLAB_MALLOC),y)
+$(error CFG_TA_HEAP_PROF and CFG_TA_SLAB_MALLOC both wrap malloc())
+endif
+CPPFLAGS += -DCFG_TA_HEAP_PROF=1
+LDADD += --wrap=malloc --wrap=calloc --wrap=realloc --wrap=memalign \
+	 --wrap=free
+LDADD += -u __wrap_malloc -u __wrap_calloc -u __wrap_realloc \
+	 -u __wrap_memalign -u __wrap_free
+endif
+
+# CFG_TA_MEMPOOL_ARENA_MBEDTLS=y links the TA with the copy of libmbedtls
+# ta_ext builds with its calloc() and free() calls renamed to the mbedtls
+# adapter of mempool_arena.h. LDADD comes before the library directory of
+# the dev kit, so -lmbedtls finds the copy first, and -u pulls in the
+# adapter as for CFG_TA_SLAB_MALLOC.
+ifeq ($(CFG_TA_MEMPOOL_ARENA_MBEDTLS)-$(filter ta_ext,$(TA_LIBS)),y-ta_ext)
+LDADD += -L$(TA_LIB_OUT_DIR)/ta_ext/mbedtls_arena
+LDADD += -u mempool_arena_mbedtls_calloc -u mempool_arena_mbedtls_free
+libdeps += $(TA_LIB_OUT_DIR)/ta_ext/mbedtls_arena/libmbedtls.a
+endif
+
+# CFG_TA_BINLOG=y records the trace messages of the TA in binary instead of
+# formatting them for _utee_log(), see binlog.h. -u pulls in the wrapper of
+# TEE_Panic() even if the TA itself records nothing.
+ifeq ($(CFG_TA_BINLOG)-$(filter ta_ext,$(TA_LIBS)),y-ta_ext)
+CPPFLAGS += -DCFG_TA_BINLOG=1 -include $(ta-lib-dir)/ta_ext/include/binlog.h
+LDADD += --wrap=TEE_Panic -u __wrap_TEE_Panic
+endif
+
+# CFG_TA_TRACEPOINT=y turns on the TRACEPOINT() macros of tracepoint.h
+ifeq ($(CFG_TA_TRACEPOINT)-$(filter ta_ext,$(TA_LIBS)),y-ta_ext)
+CPPFLAGS += -DCFG_TA_TRACEPOINT=1
+endif